@@ -277,7 +277,7 @@ cci_flush_all_wsids(struct cci_PIPsession *psess)
          PVERBOSE("Done Freeing PWS with id 0x%llx.\n",pwsid_to_wsidHandle(wsidp));
       }
 
-      kosal_list_del_init(&wsidp->m_list);
+      aalsess_del_ws(wsidp);
 
       ccidrv_freewsid(wsidp);
    } // end list_for_each_entry
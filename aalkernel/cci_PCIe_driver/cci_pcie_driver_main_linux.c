@@ -110,12 +110,15 @@ MODULE_LICENSE    (DRV_LICENSE);
 //       Value: Number of VFs to enable (can't exceed number of PORTs)
 //      sriov_vf: Ignore VF driver binding (to enable VF enumeration on VM)
 //       Value: 1 to ignore VF, 0 to bind VF device to driver(default)
+//      sim_wsidtest: Measure WSID lookup cost at load (simulation only)
+//       Value: Largest number of WSIDs to allocate
 //
 // Typical usage:
 //    sudo insmod ccidrv           # Normal load. PCIe enumeration enabled
 //    sudo insmod ccidrv sim=4     # Instantiate 4 simulated AFUs
 //    sudo insmod ccidrv sriov=1   # Activate SR-IOV with 1 VF
 //    sudo insmod ccidrv sriov_vf=1   # bind VF driver in sriov mode
+//    sudo insmod ccidrv sim=1 sim_wsidtest=4096   # Time WSID lookups with up to 4096 WSIDs
 
 unsigned long  sim = 0;
 MODULE_PARM_DESC(sim, "Simulation: #=Number of simulated AFUs to instantiate");
@@ -129,6 +132,10 @@ int            sriov_vf = 0;
 MODULE_PARM_DESC(sriov_vf, "SR-IOV with VF driver binding: 1 to enable VF driver with PF");
 module_param    (sriov_vf, int, S_IRUGO);
 
+unsigned long  sim_wsidtest = 0;
+MODULE_PARM_DESC(sim_wsidtest, "Simulation: #=Largest WSID count to measure lookup cost with");
+module_param    (sim_wsidtest, ulong, S_IRUGO);
+
 ////////////////////////////////////////////////////////////////////////////////
 
 //=============================================================================
@@ -1448,6 +1455,12 @@ ccidrv_init(void)
       ret = ccidrv_initUMAPI();
    }
 
+   // The WSID index is set up by ccidrv_initUMAPI().
+   if( ( 0 == ret ) && ( 0 != sim ) && ( 0 != sim_wsidtest ) ){
+      // Informational only; a failure does not prevent the driver loading.
+      cci_sim_wsid_lookup_test((unsigned)sim_wsidtest);
+   }
+
    PTRACEOUT_INT(ret);
    return ret;
 }
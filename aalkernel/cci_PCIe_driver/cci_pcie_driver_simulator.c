@@ -421,3 +421,78 @@ ERR:
    return NULL;
 }
 
+
+#if defined( __AAL_LINUX__ )
+//=============================================================================
+// Name: cci_sim_wsid_lookup_test
+// Description: Measures the cost of validating a WSID handle as the number of
+//              allocated WSIDs grows.
+// Inputs: maxwsids - Largest number of WSIDs to allocate. Counts of 16, 256,
+//                    4096, ... up to maxwsids are measured.
+// Outputs: 0 - success.
+// Comments: Runs in simulation mode only. The WSIDs are not backed by any
+//           workspace and are freed before returning.
+//=============================================================================
+int cci_sim_wsid_lookup_test(unsigned maxwsids)
+{
+   const unsigned      rounds  = 16;
+   struct aal_wsid   **wsids   = NULL;
+   unsigned            count   = 16;
+   unsigned            nalloc  = 0;
+   unsigned            i, r;
+   int                 res     = 0;
+
+   wsids = (struct aal_wsid **)kosal_kzmalloc(maxwsids * sizeof(struct aal_wsid *));
+   if ( NULL == wsids ) {
+      PERR("Unable to allocate WSID test table\n");
+      return -ENOMEM;
+   }
+
+   while ( count <= maxwsids ) {
+      ktime_t  start;
+      s64      nsecs;
+
+      for ( ; nalloc < count ; ++nalloc ) {
+         wsids[nalloc] = ccidrv_getwsid(NULL, (unsigned long long)nalloc);
+         if ( NULL == wsids[nalloc] ) {
+            PERR("Unable to allocate WSID %u\n", nalloc);
+            res = -ENOMEM;
+            goto DONE;
+         }
+      }
+
+      start = ktime_get();
+      for ( r = 0 ; r < rounds ; ++r ) {
+         for ( i = 0 ; i < count ; ++i ) {
+            if ( wsids[i] != ccidrv_valwsid(pwsid_to_wsidHandle(wsids[i])) ) {
+               PERR("WSID handle %llx did not validate\n", pwsid_to_wsidHandle(wsids[i]));
+               res = -EINVAL;
+               goto DONE;
+            }
+         }
+      }
+      nsecs = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+      PINFO("WSID lookup: %5u WSIDs allocated, %llu ns per ccidrv_valwsid()\n",
+            count, (unsigned long long)div_u64((u64)nsecs, count * rounds));
+
+      count <<= 4;
+   }
+
+DONE:
+   while ( nalloc-- ) {
+      btWSID handle = pwsid_to_wsidHandle(wsids[nalloc]);
+
+      ccidrv_freewsid(wsids[nalloc]);
+
+      // A freed handle must no longer validate.
+      if ( NULL != ccidrv_valwsid(handle) ) {
+         PERR("Freed WSID handle %llx still validates\n", handle);
+         res = -EINVAL;
+      }
+   }
+
+   kosal_kfree(wsids, maxwsids * sizeof(struct aal_wsid *));
+   return res;
+}
+#endif // __AAL_LINUX__
@@ -97,6 +97,10 @@
 int cci_sim_discover_devices(unsigned  numdevices,
                              kosal_list_head *g_device_list);
 
+#if defined( __AAL_LINUX__ )
+int cci_sim_wsid_lookup_test(unsigned maxwsids);
+#endif // __AAL_LINUX__
+
 
 
 #endif /* CCI_PCIE_DRIVER_SIMULATOR_H_ */
@@ -84,6 +84,13 @@
 // TODO THESE NEED PROPER DEFINITION IN IDS
 #define  AALUI_DRV_INTC          (0x0000000000002000)
 #endif
+
+// Allocated WSIDs are indexed by handle in a fixed-size hash table. Handles are
+//  sequential (shifted on Linux), so a multiplicative hash spreads them evenly.
+#define CCIDRV_WSID_HASH_BITS    12
+#define CCIDRV_WSID_HASH_BUCKETS (1 << CCIDRV_WSID_HASH_BITS)
+#define ccidrv_wsid_hash(h)      ((btUnsigned32bitInt)(((btUnsigned64bitInt)(h) * 0x9E3779B97F4A7C15ULL) >> (64 - CCIDRV_WSID_HASH_BITS)))
+
 //=============================================================================
 // Name: um_APIdriver
 // Description: CCI User Mode API Class
@@ -98,9 +105,9 @@ struct um_driver {
    // Private semaphore
    kosal_semaphore          m_sem;
 
-   /* list of allocated wsids */
+   /* allocated wsids, hashed by handle and chained through aal_wsid->m_alloc_list */
    kosal_semaphore          wsid_list_sem;
-   kosal_list_head          wsid_list_head;
+   kosal_list_head          wsid_hash[CCIDRV_WSID_HASH_BUCKETS];
 };
 
 //=============================================================================
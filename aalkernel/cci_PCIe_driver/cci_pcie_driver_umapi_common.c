@@ -361,6 +361,75 @@ ccidrv_messageHandler( struct ccidrv_session  *psess,
       } break; // case  AALUID_IOCTL_GETMSG:
 
 
+      // Get as many queued messages as fit in the response payload
+      //  in one call. Each is marshalled as for AALUID_IOCTL_GETMSG.
+      //----------------------------------------------------------
+      UIDRV_IOCTL_CASE(AALUID_IOCTL_GETMSGS) {
+         struct ccipui_msgbatch *pbatch = (struct ccipui_msgbatch *)presp->payload;
+         btWSSize                used   = sizeof(struct ccipui_msgbatch);
+
+         if ( OutbufSize < sizeof(struct ccipui_msgbatch) ) {
+            PERR("Message batch buffer too small\n");
+            PTRACEOUT_INT(-EINVAL);
+            return -EINVAL;
+         }
+
+         // Make sure there is a message to be had
+         if ( _aal_q_empty(&psess->m_eventq) ) {
+            PTRACEOUT_INT(-EAGAIN);
+            return -EAGAIN;
+         }
+
+         pbatch->count  = 0;
+         pbatch->needed = 0;
+
+         while ( !_aal_q_empty(&psess->m_eventq) ) {
+            struct ccipui_ioctlreq *prec;
+            btWSSize                recsize;
+            btWSSize                payloadsize;
+            btInt                   ret;
+
+            pqitem = _aal_q_peek(&psess->m_eventq);
+            if ( NULL == pqitem ) {
+               PERR("Corrupt event queue\n");
+               break;
+            }
+
+            recsize = ccipui_msgrec_size(QI_LEN(pqitem));
+            if ( used + recsize > OutbufSize ) {
+               if ( 0 == pbatch->count ) {
+                  // Leave the message queued and tell the caller how big a buffer it needs.
+                  pbatch->needed = sizeof(struct ccipui_msgbatch) + recsize;
+               }
+               break;
+            }
+
+            pqitem = _aal_q_dequeue(&psess->m_eventq);
+
+            prec        = (struct ccipui_ioctlreq *)((btByte *)presp->payload + used);
+            payloadsize = recsize - sizeof(struct ccipui_ioctlreq);
+            ret = ccidrv_marshal_upstream_message(preq, pqitem, prec, &payloadsize);
+            if ( 0 != ret ) {
+               if ( 0 == pbatch->count ) {
+                  PTRACEOUT_INT(ret);
+                  return ret;
+               }
+               // Those already dequeued are in the buffer, hand them back.
+               PERR("Failed to marshal message %u of batch\n", pbatch->count);
+               break;
+            }
+
+            used += recsize;
+            pbatch->count++;
+         }
+
+         PVERBOSE("Returning %u messages in %" PRIu64 " bytes\n", pbatch->count, used);
+
+         *pOutbufSize = presp->size = used;
+         PTRACEOUT_INT(0);
+      } return 0; // case AALUID_IOCTL_GETMSGS:
+
+
       // Send the message to the device or PIP (SW driver)
       //-------------------------------------------------
       UIDRV_IOCTL_CASE(AALUID_IOCTL_SENDMSG) {
@@ -951,13 +1020,14 @@ struct aal_wsid* ccidrv_getwsid(struct aal_device *pdev,
    pwsid->m_device = pdev;
    pwsid->m_handle = wsid_to_wsidHandle(nextWSID);
    pwsid->m_id = id;
+   pwsid->m_UIHandle = NULL;
    kosal_list_init(&pwsid->m_list);
    kosal_list_init(&pwsid->m_alloc_list);
 
    PDEBUG(": Created WSID %llu [Handle %llx] for device id %llx \n", nextWSID, pwsid->m_handle, id);
 
    /* add to allocated list */
-   kosal_list_add_head(&pwsid->m_alloc_list, &umDriver.wsid_list_head);
+   kosal_list_add_head(&pwsid->m_alloc_list, &umDriver.wsid_hash[ccidrv_wsid_hash(pwsid->m_handle)]);
 
    nextWSID++;
 
@@ -1044,8 +1114,8 @@ int ccidrv_flush_eventqueue(  struct ccidrv_session *psess)
 // Name: ccidrv_valwsid
 /** @brief check if a provided wsid is on the list of known allocated wsids
  * @param[in] wsidHandle handle to workspace to validate
- * @return zero on success
- * grab the list lock, walk the list, and compare pointers. */
+ * @return the wsid on success, NULL if it is not allocated
+ * grab the list lock, walk the handle's hash chain, and compare handles. */
 //=============================================================================
 struct aal_wsid *ccidrv_valwsid(btWSID wsidHandle)
 {
@@ -1064,7 +1134,7 @@ struct aal_wsid *ccidrv_valwsid(btWSID wsidHandle)
       return NULL;
    }
 
-   kosal_list_for_each_entry(listwsid_p, &umDriver.wsid_list_head, m_alloc_list, struct aal_wsid) {
+   kosal_list_for_each_entry(listwsid_p, &umDriver.wsid_hash[ccidrv_wsid_hash(wsidHandle)], m_alloc_list, struct aal_wsid) {
       if (listwsid_p->m_handle == wsidHandle) {
          kosal_sem_put(&umDriver.wsid_list_sem);
          return listwsid_p;
@@ -1092,14 +1162,13 @@ struct aal_wsid *ccidrv_valwsid(btWSID wsidHandle)
 struct aal_wsid *find_wsid( const struct ccidrv_session *ccidrv_sess_p,
                             btWSID wsidHandle)
 {
-   const struct aaldev_owner *owner_p;
-   const struct aaldev_ownerSession *ownersess_p;
    struct aal_wsid *cur_wsid_p = NULL;
 
    PDEBUG("Looking for WSID Handle %llx\n", wsidHandle);
 
    /* start by checking if the passed wsid is even valid */
-   if (NULL == ccidrv_valwsid(wsidHandle)) {
+   cur_wsid_p = ccidrv_valwsid(wsidHandle);
+   if (NULL == cur_wsid_p) {
       PERR("WSID Invalid\n");
       return NULL;
    }
@@ -1107,28 +1176,21 @@ struct aal_wsid *find_wsid( const struct ccidrv_session *ccidrv_sess_p,
    /* if this session is not associated with a device, don't bother checking
     * ownership of the wsid, since there may not be any.  */
    if (kosal_list_is_empty(&ccidrv_sess_p->m_devicelist)) {
-      return ccidrv_valwsid(wsidHandle);
+      return cur_wsid_p;
    }
 
    /* if this session is associated with a device, (IE m_devicelist is not
     * empty,) then any wsid we handle needs to be on one of our device's
     * ownership lists, otherwise we shouldn't be touching it.
     *
-    * struct ccidrv_session contains list head of
-    *   struct aaldev_owner which contains
-    *     struct aaldev_ownerSession which contains the list head of
-    *       struct aal_wsid */
-  PVERBOSE("looking at list head %p for wsid %llx\n", &(ccidrv_sess_p->m_devicelist), wsidHandle );
-   kosal_list_for_each_entry(owner_p, &(ccidrv_sess_p->m_devicelist), m_devicelist, struct aaldev_owner) {
-      PVERBOSE("examining owner_p %p\n", owner_p);
-      ownersess_p = &(owner_p->m_sess);
-
-      kosal_list_for_each_entry(cur_wsid_p, &(ownersess_p->m_wshead), m_list, struct aal_wsid) {
-         if (cur_wsid_p->m_handle == wsidHandle) {
-            PVERBOSE("  wsid ID %lld at %p found\n",cur_wsid_p->m_handle, cur_wsid_p);
-            return cur_wsid_p;
-         }
-      }
+    * aalsess_add_ws() tags the wsid with the UI session of the owner session
+    * whose list it joins, so the ownership check does not need to walk
+    *   struct ccidrv_session -> struct aaldev_owner -> struct aaldev_ownerSession
+    * looking for it. */
+   if ( !kosal_list_is_empty(&cur_wsid_p->m_list) &&
+        ( cur_wsid_p->m_UIHandle == (btObjectType)ccidrv_sess_p ) ) {
+      PVERBOSE("  wsid ID %lld at %p found\n",cur_wsid_p->m_handle, cur_wsid_p);
+      return cur_wsid_p;
    }
 
    PVERBOSE("wsid %llu NOT found on any owner lists\n", wsidHandle);
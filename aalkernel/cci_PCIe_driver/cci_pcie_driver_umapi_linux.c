@@ -183,6 +183,7 @@ int
 ccidrv_initUMAPI(void)
 {
    int res                 = 0;
+   int i;
 
    char * devname          = "uidrv";
 
@@ -195,7 +196,9 @@ ccidrv_initUMAPI(void)
    kosal_mutex_init(&umDriver.m_sem);
 
    kosal_mutex_init(&umDriver.wsid_list_sem);
-   kosal_list_init(&umDriver.wsid_list_head);
+   for ( i = 0 ; i < CCIDRV_WSID_HASH_BUCKETS ; i++ ) {
+      kosal_list_init(&umDriver.wsid_hash[i]);
+   }
 
    PDEBUG("Allocating major number for \"%s\"\n",devname);
 
@@ -325,7 +328,10 @@ int ccidrv_ioctl(struct inode *inode,
    }
 
    // If there is a payload then allocate a bige enough buffer and copy it in.
-   if ( FullRequestSize > sizeof(struct ccipui_ioctlreq) ) {
+   //  The message fetch requests only supply a buffer for the response, so skip the copy.
+   if ( ( FullRequestSize > sizeof(struct ccipui_ioctlreq) ) &&
+        ( AALUID_IOCTL_GETMSG  != cmd ) &&
+        ( AALUID_IOCTL_GETMSGS != cmd ) ) {
 
       PINFO("UIDRV is reading message with payload of size %" PRIu64 "\n", aalui_ioctlPayloadSize(&req));
       pfullrequest = (struct ccipui_ioctlreq *) kosal_kzmalloc(FullRequestSize);
@@ -379,6 +385,9 @@ int ccidrv_ioctl(struct inode *inode,
       PINFO("UIDRV is writing %" PRIu64 "-byte response message with payload of size %" PRIu64 " bytes with %llx\n", FullResponseSize, pfullresponse->size, (btWSID)(*pfullresponse->payload));
       ret = copy_to_user((void*)arg, pfullresponse, FullResponseSize);
 
+   } else if ( -EAGAIN == ret ) {
+      // No message queued. Let the caller tell this apart from a failure.
+      PVERBOSE("ccidrv_messageHandler: no message\n");
    } else {
       PDEBUG("ccidrv_messageHandler failed\n");
       ret = -EINVAL;
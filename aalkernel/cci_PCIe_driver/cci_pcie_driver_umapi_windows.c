@@ -105,6 +105,7 @@ ccidrv_initUMAPI( WDFDEVICE hDevice )
    NTSTATUS                        status        = STATUS_DEVICE_CONFIGURATION_ERROR;
    WDF_IO_QUEUE_CONFIG             queueConfig;
    WDFQUEUE                        queue;
+   int                             i;
 
 
 
@@ -181,7 +182,9 @@ ccidrv_initUMAPI( WDFDEVICE hDevice )
    kosal_mutex_init( &umDriver.m_sem );
 
    kosal_mutex_init( &umDriver.wsid_list_sem );
-   kosal_list_init( &umDriver.wsid_list_head );
+   for ( i = 0 ; i < CCIDRV_WSID_HASH_BUCKETS ; i++ ) {
+      kosal_list_init( &umDriver.wsid_hash[i] );
+   }
 
    return status;
 }
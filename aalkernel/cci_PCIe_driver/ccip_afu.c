@@ -391,7 +391,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          Message->m_errcode = uid_errnumOK;
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         aalsess_add_ws(pownerSess, wsidp);
 
       } break;
 
@@ -434,7 +434,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          PDEBUG("Creating Physical WSID %p.\n", wsidp);
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         aalsess_add_ws(pownerSess, wsidp);
 
          PINFO("CCI WS alloc wsid=0x%" PRIx64 " phys=0x%" PRIxPHYS_ADDR  " kvp=0x%" PRIx64 " size=%" PRIu64 " success!\n",
                   preq->ahmreq.u.wksp.m_wsid,
@@ -506,7 +506,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          }
 
          // remove the wsid from the device and destroy
-         kosal_list_del_init(&wsidp->m_list);
+         aalsess_del_ws(wsidp);
          ccidrv_freewsid(wsidp);
 
          PVERBOSE("Sending the WKSP Free event.\n");
@@ -654,7 +654,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          PDEBUG("Creating uMSG WSID %p.\n", wsidp);
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         aalsess_add_ws(pownerSess, wsidp);
 
          PINFO("CCI uMSG wsid=0x%" PRIx64 " phys=0x%" PRIxPHYS_ADDR  " kvp=0x%" PRIx64 " size=%" PRIu64 " success!\n",
                   preq->ahmreq.u.wksp.m_wsid,
@@ -381,7 +381,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          Message->m_errcode = uid_errnumOK;
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         aalsess_add_ws(pownerSess, wsidp);
 
       } break;
 
@@ -84,6 +84,9 @@
 
 #include "cci_pcie_driver_PIPsession.h"
 
+#include <linux/highmem.h>
+#include <linux/vmalloc.h>
+
 #define BS_WRITE_CSR_LEN  4
 
 extern btUnsigned32bitInt sim;
@@ -161,6 +164,182 @@ inline void Set64CSR(btUnsigned64bitInt *ptr, bt64bitCSR *csrval)
    volatile bt64bitCSR *p64 = (bt64bitCSR *)ptr;
    *p64 = *csrval;
 }
+
+///============================================================================
+/// Name: pr_pin_user_buffer
+/// @brief Pins the caller's pages holding the bitstream, so that the PR worker
+///        can push directly from them without a kernel copy.
+///
+/// @param[in] ppr_program_ctx - pr program context
+/// @param[in] uptr - user address of the bitstream, 4-byte aligned
+/// @param[in] len - bitstream length in bytes
+/// @return    0 on success, or a negative errno
+///============================================================================
+static int pr_pin_user_buffer(struct pr_program_context *ppr_program_ctx,
+                              btVirtAddr uptr,
+                              btWSSize len)
+{
+   unsigned long first  = ((unsigned long)uptr) >> PAGE_SHIFT;
+   unsigned long last   = (((unsigned long)uptr) + len - 1) >> PAGE_SHIFT;
+   btUnsignedInt npages = (btUnsignedInt)(last - first + 1);
+   struct page **pages  = NULL;
+   int pinned           = 0;
+
+   pages = vmalloc(npages * sizeof(struct page *));
+   if ( NULL == pages ) {
+      return -ENOMEM;
+   }
+
+   pinned = get_user_pages_fast(first << PAGE_SHIFT, npages, 0, pages);
+   if ( pinned != (int)npages ) {
+      PERR("Pinned %d of %u bitstream pages\n", pinned, npages);
+      while ( pinned > 0 ) {
+         put_page(pages[--pinned]);
+      }
+      vfree(pages);
+      return -EFAULT;
+   }
+
+   ppr_program_ctx->m_pages    = pages;
+   ppr_program_ctx->m_npages   = npages;
+   ppr_program_ctx->m_pgoffset = (btUnsignedInt)(((unsigned long)uptr) & ~PAGE_MASK);
+   ppr_program_ctx->m_bufferlen = len;
+   return 0;
+}
+
+///============================================================================
+/// Name: pr_release_bitstream
+/// @brief Frees the kernel copy of the bitstream, or unpins the caller's pages.
+///
+/// @param[in] ppr_program_ctx - pr program context
+/// @return    void
+///============================================================================
+static void pr_release_bitstream(struct pr_program_context *ppr_program_ctx)
+{
+   if ( NULL != ppr_program_ctx->m_kbufferptr ) {
+      kosal_free_user_buffer(ppr_program_ctx->m_kbufferptr, ppr_program_ctx->m_bufferlen);
+      ppr_program_ctx->m_kbufferptr = NULL;
+   }
+
+   if ( NULL != ppr_program_ctx->m_pages ) {
+      while ( ppr_program_ctx->m_npages > 0 ) {
+         put_page(ppr_program_ctx->m_pages[--ppr_program_ctx->m_npages]);
+      }
+      vfree(ppr_program_ctx->m_pages);
+      ppr_program_ctx->m_pages = NULL;
+   }
+}
+
+///============================================================================
+/// Name: pr_push_words
+/// @brief Pushes bitstream words to FME_PR_DATA in credit-sized bursts.
+///
+/// Each burst uses every credit but one, as reported by FME_PR_STATUS[8:0],
+///    and is written with a single repeated-write to the data port.
+///
+/// @param[in] pr_dev - PR feature
+/// @param[in] pwords - words to push
+/// @param[in] nwords - number of words
+/// @param[in,out] pcredits - credits known to be available
+/// @return    uid_errnumOK, or uid_errnumPRTimeout if the credits run dry
+///============================================================================
+static uid_errnum_e pr_push_words(struct CCIP_FME_DFL_PR   *pr_dev,
+                                  const btUnsigned32bitInt *pwords,
+                                  btWSSize                  nwords,
+                                  btUnsigned64bitInt       *pcredits)
+{
+   struct CCIP_FME_PR_STATUS pr_status_local;
+   btUnsigned64bitInt counter = 0;
+   btWSSize burst             = 0;
+
+   while ( nwords > 0 ) {
+
+      while ( *pcredits <= 1 ) {
+         Get64CSR(&pr_dev->ccip_fme_pr_status.csr,&pr_status_local.csr);
+         *pcredits = pr_status_local.pr_credit;
+
+         // if counter value is more then PR_COUNTER_MAX_TRY,returns Timeout error.
+         if ( ++counter > PR_COUNTER_MAX_TRY ) {
+            PERR("PR FIFI Credits Timeout Error \n");
+            return uid_errnumPRTimeout;
+         }
+      }
+      counter = 0;
+
+      burst = (btWSSize)(*pcredits - 1);
+      if ( burst > nwords ) {
+         burst = nwords;
+      }
+
+      iowrite32_rep((void __iomem *)&pr_dev->ccip_fme_pr_data.csr, pwords, (unsigned long)burst);
+
+      *pcredits -= burst;
+      pwords    += burst;
+      nwords    -= burst;
+   }
+
+   return uid_errnumOK;
+}
+
+///============================================================================
+/// Name: pr_push_bitstream
+/// @brief Pushes len bytes of the bitstream, starting skip bytes in, from the
+///        kernel copy or page by page from the pinned caller pages.
+///
+/// @param[in] ppr_program_ctx - pr program context
+/// @param[in] pr_dev - PR feature
+/// @param[in] skip - bytes to skip at the start of the bitstream
+/// @param[in] len - bytes to push, a multiple of 4
+/// @return    uid_errnumOK, or the push error
+///============================================================================
+static uid_errnum_e pr_push_bitstream(struct pr_program_context *ppr_program_ctx,
+                                      struct CCIP_FME_DFL_PR    *pr_dev,
+                                      btWSSize                   skip,
+                                      btWSSize                   len)
+{
+   struct CCIP_FME_PR_STATUS pr_status_local;
+   btUnsigned64bitInt credits = 0;
+   uid_errnum_e errnum        = uid_errnumOK;
+   btWSSize offset            = 0;
+   btWSSize chunk             = 0;
+   btUnsignedInt pg           = 0;
+   btVirtAddr kaddr           = NULL;
+
+   Get64CSR(&pr_dev->ccip_fme_pr_status.csr,&pr_status_local.csr);
+   credits = pr_status_local.pr_credit;
+
+   if ( NULL == ppr_program_ctx->m_pages ) {
+      return pr_push_words(pr_dev,
+                           (const btUnsigned32bitInt *)(ppr_program_ctx->m_kbufferptr + skip),
+                           len >> 2,
+                           &credits);
+   }
+
+   offset = ppr_program_ctx->m_pgoffset + skip;
+   pg     = (btUnsignedInt)(offset >> PAGE_SHIFT);
+   offset &= ~PAGE_MASK;
+
+   while ( len > 0 ) {
+      chunk = PAGE_SIZE - offset;
+      if ( chunk > len ) {
+         chunk = len;
+      }
+
+      kaddr  = (btVirtAddr)kmap(ppr_program_ctx->m_pages[pg]);
+      errnum = pr_push_words(pr_dev, (const btUnsigned32bitInt *)(kaddr + offset), chunk >> 2, &credits);
+      kunmap(ppr_program_ctx->m_pages[pg]);
+
+      if ( uid_errnumOK != errnum ) {
+         return errnum;
+      }
+
+      len   -= chunk;
+      offset = 0;
+      ++pg;
+   }
+
+   return uid_errnumOK;
+}
 //=============================================================================
 // Name: program_afu
 // Description:
@@ -454,20 +633,21 @@ void ccipdrv_event_afu_aysnc_pr_release_send(struct pr_program_context *ppr_prog
    }
 #endif
 
+   // Configure responses carry the PR phase timings
    pafuws_evt = ccipdrv_event_afu_aysnc_pr_release_create( ppr_program_ctx->m_respID,
                                                            ppr_program_ctx->m_pownerSess->m_device,
                                                            ppr_program_ctx->m_pownerSess->m_ownerContext,
-                                                           eno);
+                                                           eno,
+                                                           (ppr_program_ctx->m_cmd == ccipdrv_configureAFU) ?
+                                                              &ppr_program_ctx->m_timings : NULL);
 
    ccidrv_sendevent(ppr_program_ctx->m_pownerSess,
                     AALQIP(pafuws_evt));
 
  
-   if((ppr_program_ctx->m_cmd == ccipdrv_configureAFU) &&
-        (NULL != ppr_program_ctx->m_kbufferptr)) {
-        kosal_free_user_buffer(ppr_program_ctx->m_kbufferptr, ppr_program_ctx->m_bufferlen);
-        ppr_program_ctx->m_kbufferptr = NULL;
-     }
+   if(ppr_program_ctx->m_cmd == ccipdrv_configureAFU) {
+      pr_release_bitstream(ppr_program_ctx);
+   }
 
 
    kosal_sem_put(cci_dev_pr_sem(ppr_program_ctx->m_pPR_dev));
@@ -526,9 +706,7 @@ void ccipdrv_event_reconfig_event_create_send( struct pr_program_context *ppr_pr
                     AALQIP(pafuws_evt));
 
 
-   if(NULL!= ppr_program_ctx->m_kbufferptr ) {
-      kosal_free_user_buffer(ppr_program_ctx->m_kbufferptr, ppr_program_ctx->m_bufferlen);
-   }
+   pr_release_bitstream(ppr_program_ctx);
 
    kosal_sem_put(cci_dev_pr_sem(ppr_program_ctx->m_pPR_dev));
    PDEBUG("UN-LOCK RECONF \n");
@@ -555,9 +733,7 @@ void prprogram_ctx_free( struct pr_program_context *ppr_program_ctx)
       return ;
    }
 
-   if(NULL!= ppr_program_ctx->m_kbufferptr ) {
-      kosal_free_user_buffer(ppr_program_ctx->m_kbufferptr, ppr_program_ctx->m_bufferlen);
-   }
+   pr_release_bitstream(ppr_program_ctx);
 
    kosal_sem_put(cci_dev_pr_sem(ppr_program_ctx->m_pPR_dev));
    PDEBUG("UN-LOCK RECONF \n");
@@ -624,12 +800,9 @@ void  ccipdrv_event_activationchange_event_create_send( struct pr_program_contex
 ///============================================================================
 void program_afu_callback(struct kosal_work_object * pwork)
 {
-   btVirtAddr   kptr                         = NULL;
+   btWSSize   skip                            = 0;
    btWSSize   len                             = 0;
-   btUnsigned64bitInt   PR_FIFO_credits       = 0;
-   btUnsigned32bitInt   *byteRead             = NULL;
    uid_errnum_e   errnum                      = uid_errnumOK;
-   btUnsigned64bitInt   counter               = 0;
    struct fme_device   *pfme_dev              = NULL;
    struct CCIP_FME_DFL_PR   *pr_dev           = NULL;
    struct pr_program_context *ppr_program_ctx = NULL;
@@ -638,6 +811,7 @@ void program_afu_callback(struct kosal_work_object * pwork)
    struct CCIP_FME_PR_STATUS  pr_status_local;
    struct CCIP_FME_PR_ERROR  pr_err_local;
    ktime_t timeout;
+   ktime_t phase_start;
 
 
    PTRACEIN;
@@ -652,16 +826,16 @@ void program_afu_callback(struct kosal_work_object * pwork)
    pfme_dev = cci_aaldev_pfme(ppr_program_ctx->m_pPR_dev);
    pr_dev   = ccip_fme_pr(pfme_dev);
 
-   kptr = ppr_program_ctx->m_kbufferptr;
    len  = ppr_program_ctx->m_bufferlen;
 
 #ifdef PWRMGR
     // Check Boundrys of bitstrem buffer TBD
-    kptr = kptr + sizeof(struct CCIP_GBS_HEADER);
+    skip = sizeof(struct CCIP_GBS_HEADER);
     len  = len - sizeof(struct CCIP_GBS_HEADER);
 #endif
 
-   PDEBUG("kptr =%p", kptr);
+   PDEBUG("kptr =%p", ppr_program_ctx->m_kbufferptr);
+   PDEBUG("pinned pages =%u", ppr_program_ctx->m_npages);
    PDEBUG("len =%d\n", (unsigned)len);
    PDEBUG("prregion_id =%d\n",ppr_program_ctx->m_prregion_id);
 
@@ -686,6 +860,13 @@ void program_afu_callback(struct kosal_work_object * pwork)
     goto ERR;
    }
 
+   // FME_PR_DATA takes whole 32-bit words
+   if (0 != (len & 0x3)) {
+      PERR(" Wrong Bitstream Size \n");
+      errnum = uid_errnumPROperation;
+      goto ERR;
+   }
+
    // Program the AFU
    // Reset PR Engine CSR_FME_PR_CONTROL[0] = 0x1 before Initiating PR
    // ---------------------------------------------------------------------------
@@ -828,46 +1009,16 @@ void program_afu_callback(struct kosal_work_object * pwork)
    // For instance,
    // if FME_PR_STATUS[8:0] read yields 511, SW can perform 511 32-bit writes from rbf file to FME_PR_DATA[31:0] and check credits again
 
-   Get64CSR(&pr_dev->ccip_fme_pr_status.csr,&pr_status_local.csr);
-   PR_FIFO_credits = pr_status_local.pr_credit;
-   byteRead = (btUnsigned32bitInt  *)kptr;
    PDEBUG("Pushing Data from rbf to HW \n");
+   phase_start = ktime_get();
 
+   errnum = pr_push_bitstream(ppr_program_ctx, pr_dev, skip, len);
+   if ( uid_errnumOK != errnum ) {
+      goto ERR;
+   }
 
-   while(len >0) {
-
-      if (PR_FIFO_credits <= 1)  {
-         do {
-
-             Get64CSR(&pr_dev->ccip_fme_pr_status.csr,&pr_status_local.csr);
-             PR_FIFO_credits = pr_status_local.pr_credit;
-
-             // counter increment
-             counter ++;
-
-             // if counter value is more then PR_COUNTER_MAX_TRY,returns Timeout error.
-             if (counter > PR_COUNTER_MAX_TRY)   {
-                PERR("PR FIFI Credits Timeout Error \n");
-                errnum=uid_errnumPRTimeout;
-                goto ERR;
-             }
-
-          } while (PR_FIFO_credits <=1);
-      }
-      counter =0;
-      // set 4 bytes bitstream
-      if(len >=4) {
-         SetCSR(&pr_dev->ccip_fme_pr_data.csr, byteRead);
-         PR_FIFO_credits --;
-         byteRead++;
-         len -= 4;
-      }else {
-         // set remaining bits
-         PERR(" Wrong Bitstream Size \n");
-         errnum = uid_errnumPROperation;
-         goto ERR;
-      }
-   } // end while
+   ppr_program_ctx->m_timings.push_ns = ktime_to_ns(ktime_sub(ktime_get(), phase_start));
+   ppr_program_ctx->m_timings.bytes   = len;
 
    // Step 7 - Notify the HW that bitstream push is complete
    // ------------------------------------------------------
@@ -892,7 +1043,8 @@ void program_afu_callback(struct kosal_work_object * pwork)
 
    PVERBOSE("Waiting for HW to release PR resource \n");
 
-   timeout = ktime_add_us(ktime_get(), PR_OUTSTADREQ_TIMEOUT);
+   phase_start = ktime_get();
+   timeout = ktime_add_us(phase_start, PR_OUTSTADREQ_TIMEOUT);
 
    do {
       // Sleep
@@ -908,6 +1060,8 @@ void program_afu_callback(struct kosal_work_object * pwork)
 
    } while(0x0 != pr_control_local.pr_start_req);
 
+   ppr_program_ctx->m_timings.wait_ns = ktime_to_ns(ktime_sub(ktime_get(), phase_start));
+
    PVERBOSE("PR operation complete, checking Status \n");
 
 
@@ -2116,6 +2270,8 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          btUnsigned64bitInt       reconfAction      = 0;
          btBool                   leaveDeactivated  = 0;
          btVirtAddr               kptr              = NULL;
+         btBool                   stream            = 0;
+         ktime_t                  load_start;
          struct aal_device        *psigtapdev       = NULL;
          struct pr_program_context* ppr_program_ctx = NULL;
 
@@ -2127,9 +2283,18 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          reconfAction      = RECONF_ACTION_HONOR_PARAMETER(preq->ahmreq.u.pr_config.reconfAction);
          leaveDeactivated  = RECONF_ACTION_ACTIVATE_PARAMETER(preq->ahmreq.u.pr_config.reconfAction);
 
+         // Streaming pushes whole words straight from the caller's pages.
+         // The power manager reads the GBS header from the kernel copy.
+         stream            = RECONF_ACTION_STREAM_PARAMETER(preq->ahmreq.u.pr_config.reconfAction) &&
+                             (0 == (((unsigned long)uptr) & 0x3));
+#ifdef PWRMGR
+         stream            = 0;
+#endif
+
          PVERBOSE( "ccipdrv_configureAFU  \n");
          PDEBUG("reconfTimeout=%lld\n",reconfTimeout);
          PDEBUG("reconfAction=%lld\n" ,reconfAction);
+         PDEBUG("stream=%d\n" ,stream);
 
          //pportdev = cci_aaldev_pport(pdev);
          pportdev = getport_device(pdev,0);
@@ -2151,13 +2316,17 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
             goto ERROR;
          }
 
-         kptr = kosal_get_user_buffer(uptr, buflen);
+         load_start = ktime_get();
+
+         if(!stream){
+            kptr = kosal_get_user_buffer(uptr, buflen);
+         }
 
          // Case 2 - if kernel memory allocation for bitstream fails.
          // sends no memory error event.
          // --------------------------------------------------------------------
          // Allocation Fails send No Memory error to application
-         if(NULL == kptr ){
+         if(!stream && (NULL == kptr)){
             PERR("kosal_get_user_buffer returned NULL");
             pafuws_evt = ccipdrv_event_reconfig_event_create(uid_afurespConfigureComplete,
                                                              pownerSess->m_device,
@@ -2191,6 +2360,26 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
             goto ERROR;
          }
 
+         // Case 3a - if the caller's bitstream pages cannot be pinned.
+         // sends no memory error event.
+         // --------------------------------------------------------------------
+         if(stream && (0 != pr_pin_user_buffer(ppr_program_ctx, uptr, buflen))){
+
+            PERR("Unable to pin bitstream buffer\n");
+            kosal_kfree(ppr_program_ctx, sizeof(struct pr_program_context));
+
+            pafuws_evt = ccipdrv_event_reconfig_event_create(uid_afurespConfigureComplete,
+                                                            pownerSess->m_device,
+                                                            &Message->m_tranID,
+                                                            Message->m_context,
+                                                            uid_errnumNoMem);
+            ccidrv_sendevent(pownerSess,
+                            AALQIP(pafuws_evt));
+            goto ERROR;
+         }
+
+         ppr_program_ctx->m_timings.load_ns   = ktime_to_ns(ktime_sub(ktime_get(), load_start));
+
          // Assign PR context
          ppr_program_ctx->m_cmd               = ccipdrv_configureAFU;
          ppr_program_ctx->m_pPR_dev           = pdev;
@@ -2408,7 +2597,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          Message->m_errcode = uid_errnumOK;
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         aalsess_add_ws(pownerSess, wsidp);
 
          goto CLEANUP;
       } break;
@@ -2456,7 +2645,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          PDEBUG("Creating Physical WSID %p.\n", wsidp);
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         aalsess_add_ws(pownerSess, wsidp);
 
          PINFO("CCI WS alloc wsid=0x%" PRIx64 " phys=0x%" PRIxPHYS_ADDR  " kvp=0x%" PRIx64 " size=%" PRIu64 " success!\n",
                   preq->ahmreq.u.wksp.m_wsid,
@@ -2550,7 +2739,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          kosal_free_contiguous_mem(krnl_virt, wsidp->m_size);
 
          // remove the wsid from the device and destroy
-         kosal_list_del_init(&wsidp->m_list);
+         aalsess_del_ws(wsidp);
          ccidrv_freewsid(wsidp);
 
          // Create the  event
@@ -135,6 +135,10 @@ struct pr_program_context
    struct aaldev_ownerSession      *m_pownerSess;
    btVirtAddr                       m_kbufferptr;
    btWSSize                         m_bufferlen;
+   struct page                    **m_pages;         // Pinned caller pages when streaming, else NULL
+   btUnsignedInt                    m_npages;
+   btUnsignedInt                    m_pgoffset;      // Offset of the bitstream in m_pages[0]
+   struct aalui_PRTimings           m_timings;
    int                              m_prregion_id ;
    btTime                           m_reconfTimeout;
    btUnsigned64bitInt               m_reconfAction;
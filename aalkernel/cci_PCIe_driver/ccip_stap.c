@@ -326,7 +326,7 @@ CommandHandler(struct aaldev_ownerSession *pownerSess,
          retval = 0;
 
          // Add the new wsid onto the session
-         aalsess_add_ws(pownerSess, wsidp->m_list);
+         aalsess_add_ws(pownerSess, wsidp);
 
       } break;
 
@@ -456,18 +456,21 @@ ccipdrv_event_afu_aysnc_pr_request_release_create(uid_afurespID_e    respID,
 /// @param[in] devhandle -aal device handle.
 /// @param[in] context - applicator context.
 /// @param[in] eno - error id.
+/// @param[in] ptimings - PR phase timings to carry as payload, or NULL.
 /// @return    afu Response event
 ///============================================================================
 static inline
 struct ccipdrv_event_afu_response_event *
-ccipdrv_event_afu_aysnc_pr_release_create(uid_afurespID_e    respID,
-                                          btObjectType       devhandle,
-                                          btObjectType       context,
-                                          uid_errnum_e       eno)
+ccipdrv_event_afu_aysnc_pr_release_create(uid_afurespID_e               respID,
+                                          btObjectType                  devhandle,
+                                          btObjectType                  context,
+                                          uid_errnum_e                  eno,
+                                          const struct aalui_PRTimings *ptimings)
 {
    struct aalui_AFUResponse *response = NULL;
+   btUnsignedInt payloadsize = (NULL == ptimings) ? 0 : sizeof(struct aalui_PRTimings);
    struct ccipdrv_event_afu_response_event *This =
-      (struct ccipdrv_event_afu_response_event *)kosal_kzmalloc( sizeof(struct ccipdrv_event_afu_response_event) + sizeof(struct aalui_AFUResponse));
+      (struct ccipdrv_event_afu_response_event *)kosal_kzmalloc( sizeof(struct ccipdrv_event_afu_response_event) + sizeof(struct aalui_AFUResponse) + payloadsize);
 
    if ( NULL == This ) {
       return NULL;
@@ -482,10 +485,14 @@ ccipdrv_event_afu_aysnc_pr_release_create(uid_afurespID_e    respID,
 
    response->respID      = respID;
    response->evtData     = 0;
-   response->payloadsize = 0;
+   response->payloadsize = payloadsize;
+
+   if ( NULL != ptimings ) {
+      *(struct aalui_PRTimings *)aalui_AFURespPayload(response) = *ptimings;
+   }
 
    AALQ_QID(This)  = rspid_AFU_Response;
-   AALQ_QLEN(This) = sizeof(struct aalui_AFUResponse );
+   AALQ_QLEN(This) = sizeof(struct aalui_AFUResponse ) + payloadsize;
 
    // Initialize the queue item
    kosal_list_init(&AALQ_QUEUE(This));
@@ -86,7 +86,7 @@ using namespace AAL;
 /// Command Line
 BEGIN_C_DECLS
 
-#define GETOPT_STRING ":hb:t:a:d:f:B:D:F:"
+#define GETOPT_STRING ":hb:t:a:d:sf:B:D:F:"
 
 struct option longopts[] = {
       {"help",                no_argument,       NULL, 'h'},
@@ -94,6 +94,7 @@ struct option longopts[] = {
       {"reconftimeout",       required_argument, NULL, 't'},
       {"reconfaction",        required_argument, NULL, 'a'},
       {"reactivateDisabled",  required_argument, NULL, 'd'},
+      {"stream",              no_argument,       NULL, 's'},
       {"bus",                 required_argument, NULL, 'B'},
       {"device",              required_argument, NULL, 'D'},
       {"function",            required_argument, NULL, 'F'},
@@ -115,24 +116,27 @@ struct  ALIConfigCommandLine
    int     reconftimeout;
    int     reconfAction;
    bool    reactivateDisabled;
+   bool    stream;
    int     bus;
    int     device;
    int     function;
 
 };
-struct ALIConfigCommandLine configCmdLine = { 0,"",1,0,0,0,0,0 };
+struct ALIConfigCommandLine configCmdLine = { 0,"",1,0,0,0,0,0,0 };
 
 void AliConfigShowHelp()
 {
    cout << "Usage:\n";
    cout << "   aliconfafu [<BITSTREAM>] [<RECONF-TIMEOUT>] [<RECONF-ACTION>]";
-   cout << " [<REACTIVATE-DISABLED>] [<BUS>] [<DEVICE>] [<FUNCTION>] \n\n";
+   cout << " [<REACTIVATE-DISABLED>] [<STREAM>] [<BUS>] [<DEVICE>] [<FUNCTION>] \n\n";
    cout << "<BITSTREAM>           --bitstream=<FILENAME>       OR  -b=<FILENAME>\n";
    cout << "<RECONF-TIMEOUT>      --reconftimeout=<SECONDS>    OR  -t=<SECONDS>\n";
    cout << "<RECONF-ACTION>       --reconfaction=A             OR  -a=A                ";
    cout << "where A = <ACTION_HONOR_REQUEST or ACTION_HONOR_OWNER >\n";
    cout << "<REACTIVATE-DISABLED> --reactivateDisabled=C       OR  -d=C                ";
    cout << "where C = <TRUE or FALSE>\n";
+   cout << "<STREAM>              --stream                     OR  -s                  ";
+   cout << "map the bitstream and push it from the mapping\n";
    cout << "<BUS>                 --bus=<BUS_NUMBER>           OR  -B=<BUS_NUMBER>\n";
    cout << "<DEVICE>              --device=<DEVICE_NUMBER>     OR  -D=<DEVICE_NUMBER>\n";
    cout << "<FUNCTION>            --function=<FUNCTION_NUMBER> OR  -F=<FUNCTION_NUMBER>\n";
@@ -201,6 +205,10 @@ int ParseCmds(struct ALIConfigCommandLine *pconfigcmd, int argc, char *argv[])
             }
             break;
 
+         case 's':    /* stream option */
+            pconfigcmd->stream = true;
+            break;
+
          case 'B':    /* bus option */
             ASSERT(NULL != tmp_optarg);
             if (NULL == tmp_optarg) break;
@@ -573,6 +581,11 @@ btInt ALIConfAFUApp::run()
       //reconfnvs.Add(AALCONF_FILENAMEKEY,"/home/lab/pr/bitstream.rbf");
       reconfnvs.Add(AALCONF_FILENAMEKEY,configCmdLine.bitstream_file);
 
+      // Streaming PR
+      if(configCmdLine.stream) {
+         reconfnvs.Add(AALCONF_STREAM_BITSTREAM,true);
+      }
+
       /*// Deactivate AFU Resource
       m_pALIReconfService->reconfDeactivate(TransactionID(), reconfnvs);
       m_Sem.Wait();
@@ -589,6 +602,17 @@ btInt ALIConfAFUApp::run()
          goto done_1;
       }
 
+      NamedValueSet timings;
+      if(m_pALIReconfService->reconfGetTimings(timings)) {
+         btUnsigned64bitInt load = 0, push = 0, wait = 0, bytes = 0;
+         timings.Get(AALCONF_TIMING_LOAD_NS, &load);
+         timings.Get(AALCONF_TIMING_PUSH_NS, &push);
+         timings.Get(AALCONF_TIMING_WAIT_NS, &wait);
+         timings.Get(AALCONF_TIMING_BYTES,   &bytes);
+         MSG("PR of " << bytes << " bytes: load " << load / 1000 << " us, push "
+             << push / 1000 << " us, wait " << wait / 1000 << " us");
+      }
+
       // reactivate AFU Resource
       if(configCmdLine.reactivateDisabled) {
          m_pALIReconfService->reconfActivate(TransactionID(), NamedValueSet());
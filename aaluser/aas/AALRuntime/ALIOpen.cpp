@@ -0,0 +1,430 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file ALIOpen.cpp
+/// @brief Implementation of ALIOpen() and ALIDevice.
+/// @ingroup IALIAFU
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+///    Synchronous bring-up of an ALI AFU on top of the asynchronous Runtime
+///    and Service allocation protocol.@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include "aalsdk/AALTypes.h"
+#include "aalsdk/AASystem.h"
+#include "aalsdk/INTCDefs.h"
+#include "aalsdk/CAALEvent.h"
+#include "aalsdk/osal/Timer.h"
+#include "aalsdk/service/ALIOpen.h"
+
+BEGIN_NAMESPACE(AAL)
+
+//=============================================================================
+// Name: ALIOpenRuntime
+// Description: The Runtime shared by the ALIDevice's opened without one.
+// Comments: Started by the first ALIOpen() and stopped by the last ALIClose().
+//           All of its devices target either hardware or simulation (ASE or
+//           the software model), as chosen by the first.
+//=============================================================================
+class ALIOpenRuntime : public  CAASBase,
+                       public  IRuntimeClient,
+                       private CUnCopyable
+{
+public:
+   ALIOpenRuntime() :
+      m_pRuntime(NULL),
+      m_Refs(0),
+      m_Flags(0),
+      m_bStarted(false)
+   {
+      m_Sem.Create(0, 1);
+   }
+
+   IRuntime * Acquire(btUnsigned32bitInt Flags, btUnsigned64bitInt &StartUs);
+   void       Release();
+
+   // <IRuntimeClient>
+   virtual void   runtimeCreateOrGetProxyFailed(IEvent const &rEvent) { PrintExceptionDescription(rEvent);                 }
+   virtual void                  runtimeStarted(IRuntime * ,
+                                                const NamedValueSet & ) { m_bStarted = true;  m_Sem.Post(1);                }
+   virtual void                  runtimeStopped(IRuntime * )            { m_bStarted = false; m_Sem.Post(1);                }
+   virtual void              runtimeStartFailed(const IEvent &rEvent)   { PrintExceptionDescription(rEvent); m_Sem.Post(1); }
+   virtual void               runtimeStopFailed(const IEvent &rEvent)   { PrintExceptionDescription(rEvent); m_Sem.Post(1); }
+   virtual void    runtimeAllocateServiceFailed(IEvent const & )        {}
+   virtual void runtimeAllocateServiceSucceeded(IBase * ,
+                                                TransactionID const & ) {}
+   virtual void                    runtimeEvent(const IEvent & )        {}
+   // </IRuntimeClient>
+
+protected:
+   Runtime            *m_pRuntime;
+   btUnsignedInt       m_Refs;
+   btUnsigned32bitInt  m_Flags;
+   volatile btBool     m_bStarted;
+   CSemaphore          m_Sem;
+};
+
+static ALIOpenRuntime & SharedRuntime()
+{
+   static ALIOpenRuntime rt;
+   return rt;
+}
+
+//=============================================================================
+// Name: Acquire
+// Description: Take a reference on the shared Runtime, starting it if needed.
+// Interface: public
+// Inputs: Flags - ALIOPEN_FLAG_* of the caller.
+// Outputs: StartUs - time spent starting the Runtime, in microseconds.
+//          Returns the Runtime, or NULL on failure.
+//=============================================================================
+IRuntime * ALIOpenRuntime::Acquire(btUnsigned32bitInt Flags, btUnsigned64bitInt &StartUs)
+{
+   AutoLock(this);
+
+   StartUs = 0;
+
+   if ( m_Refs > 0 ) {
+      if ( ( 0 == flag_is_set(m_Flags, ALIOPEN_FLAG_ASE | ALIOPEN_FLAG_SWSIM) ) !=
+           ( 0 == flag_is_set(Flags,   ALIOPEN_FLAG_ASE | ALIOPEN_FLAG_SWSIM) ) ) {
+         AAL_ERR(LM_AAS, "ALIOpen(): cannot mix simulated and hardware AFUs in the shared Runtime" << std::endl);
+         return NULL;
+      }
+      ++m_Refs;
+      return m_pRuntime;
+   }
+
+   Timer start;
+
+   m_pRuntime = new(std::nothrow) Runtime(this);
+   if ( ( NULL == m_pRuntime ) || !m_pRuntime->IsOK() ) {
+      AAL_ERR(LM_AAS, "ALIOpen(): failed to create the Runtime. Pass the application's Runtime to ALIOpen() instead." << std::endl);
+      delete m_pRuntime;
+      m_pRuntime = NULL;
+      return NULL;
+   }
+
+   NamedValueSet args;
+   NamedValueSet ConfigRecord;
+
+   if ( flag_is_set(Flags, ALIOPEN_FLAG_ASE | ALIOPEN_FLAG_SWSIM) ) {
+      btcString Preload[] = { "libALI" };
+
+      args.Add(SYSINIT_KEY_SYSTEM_NOKERNEL, true);
+      if ( !flag_is_set(Flags, ALIOPEN_FLAG_NO_PRELOAD) ) {
+         ConfigRecord.Add(AALRUNTIME_CONFIG_PRELOAD_SERVICES, const_cast<btStringArray>(Preload), 1);
+      }
+   } else {
+      // librrmbroker itself is loaded by the Runtime as the broker; the RRM broker preloads the rest.
+      btcString Preload[] = { "libALI", "libaia" };
+
+      ConfigRecord.Add(AALRUNTIME_CONFIG_BROKER_SERVICE, "librrmbroker");
+      if ( !flag_is_set(Flags, ALIOPEN_FLAG_NO_PRELOAD) ) {
+         ConfigRecord.Add(AALRUNTIME_CONFIG_PRELOAD_SERVICES, const_cast<btStringArray>(Preload), 2);
+      }
+   }
+   args.Add(AALRUNTIME_CONFIG_RECORD, &ConfigRecord);
+
+   // start() delivers either runtimeStarted() or runtimeStartFailed().
+   m_pRuntime->start(args);
+   m_Sem.Wait();
+
+   if ( !m_bStarted ) {
+      delete m_pRuntime;
+      m_pRuntime = NULL;
+      return NULL;
+   }
+
+   (Timer() - start).AsMicroSeconds(StartUs);
+
+   m_Flags = Flags;
+   m_Refs  = 1;
+   return m_pRuntime;
+}
+
+//=============================================================================
+// Name: Release
+// Description: Drop a reference on the shared Runtime, stopping it with the last.
+// Interface: public
+//=============================================================================
+void ALIOpenRuntime::Release()
+{
+   AutoLock(this);
+
+   ASSERT(m_Refs > 0);
+   if ( ( 0 == m_Refs ) || ( --m_Refs > 0 ) ) {
+      return;
+   }
+
+   m_pRuntime->stop();
+   m_Sem.Wait();
+
+   delete m_pRuntime;
+   m_pRuntime = NULL;
+}
+
+//=============================================================================
+// Name: ALIDevice
+// Description: Constructor
+//=============================================================================
+ALIDevice::ALIDevice(btUnsigned32bitInt Flags) :
+   m_Flags(Flags),
+   m_pRuntime(NULL),
+   m_bOwnRuntime(false),
+   m_pService(NULL),
+   m_pMMIO(NULL),
+   m_pBuffer(NULL),
+   m_pUMsg(NULL),
+   m_pReset(NULL),
+   m_MMIOBase(NULL),
+   m_MMIOLength(0),
+   m_DFH(0),
+   m_bResult(false)
+{
+   memset(&m_Times, 0, sizeof(m_Times));
+   m_Sem.Create(0, 1);
+
+   if ( EObjOK != SetInterface(iidServiceClient, dynamic_cast<IServiceClient *>(this)) ) {
+      m_bIsOK = false;
+   }
+}
+
+//=============================================================================
+// Name: ~ALIDevice
+// Description: Destructor
+//=============================================================================
+ALIDevice::~ALIDevice()
+{
+   Close();
+}
+
+//=============================================================================
+// Name: Open
+// Description: Allocate the ALI Service and resolve its interfaces.
+// Interface: protected
+// Inputs: AFUId - AFU ID string.
+//         BusDevFn - ALIOPEN_BDF() or ALIOPEN_ANY_BDF.
+//         pRuntime - a started Runtime, or NULL to use the shared one.
+// Outputs: true on success. On failure everything acquired is released.
+//=============================================================================
+btBool ALIDevice::Open(btcString AFUId, btUnsigned32bitInt BusDevFn, IRuntime *pRuntime)
+{
+   Timer t0;
+
+   if ( NULL == pRuntime ) {
+      pRuntime = SharedRuntime().Acquire(m_Flags, m_Times.RuntimeStart);
+      if ( NULL == pRuntime ) {
+         return false;
+      }
+      m_bOwnRuntime = true;
+   }
+   m_pRuntime = pRuntime;
+
+   NamedValueSet Manifest;
+   NamedValueSet ConfigRecord;
+
+   ConfigRecord.Add(AAL_FACTORY_CREATE_CONFIGRECORD_FULL_SERVICE_NAME, "libALI");
+
+   if ( flag_is_set(m_Flags, ALIOPEN_FLAG_ASE) ) {
+      ConfigRecord.Add(AAL_FACTORY_CREATE_SOFTWARE_SERVICE, true);
+      Manifest.Add(keyRegHandle, 20);
+      Manifest.Add(ALIAFU_NVS_KEY_TARGET, ali_afu_ase);
+   } else if ( flag_is_set(m_Flags, ALIOPEN_FLAG_SWSIM) ) {
+      ConfigRecord.Add(AAL_FACTORY_CREATE_SOFTWARE_SERVICE, true);
+      Manifest.Add(ALIAFU_NVS_KEY_TARGET, ali_afu_swswim);
+      if ( NULL != AFUId ) {
+         ConfigRecord.Add(keyRegAFU_ID, AFUId);
+      }
+   } else {
+      if ( NULL == AFUId ) {
+         AAL_ERR(LM_AAS, "ALIOpen(): no AFU ID" << std::endl);
+         Close();
+         return false;
+      }
+      ConfigRecord.Add(AAL_FACTORY_CREATE_CONFIGRECORD_FULL_AIA_NAME, "libAASUAIA");
+      ConfigRecord.Add(keyRegAFU_ID, AFUId);
+      Manifest.Add(keyRegAFU_ID, AFUId);
+
+      if ( ALIOPEN_ANY_BDF != BusDevFn ) {
+         ConfigRecord.Add(keyRegBusNumber,      (btUnsigned32bitInt)( ( BusDevFn >> 8 ) & 0xff ));
+         ConfigRecord.Add(keyRegDeviceNumber,   (btUnsigned32bitInt)( ( BusDevFn >> 3 ) & 0x1f ));
+         ConfigRecord.Add(keyRegFunctionNumber, (btUnsigned32bitInt)( BusDevFn & 0x7 ));
+      }
+   }
+
+   Manifest.Add(AAL_FACTORY_CREATE_CONFIGRECORD_INCLUDED, &ConfigRecord);
+   Manifest.Add(AAL_FACTORY_CREATE_SERVICENAME, "ALIOpen");
+
+   Timer t1;
+
+   m_pRuntime->allocService(dynamic_cast<IBase *>(this), Manifest);
+   m_Sem.Wait(); // serviceAllocated() or serviceAllocateFailed()
+
+   Timer t2;
+   (t2 - t1).AsMicroSeconds(m_Times.Allocate);
+
+   if ( !m_bResult ) {
+      Close();
+      return false;
+   }
+
+   m_pMMIO   = dynamic_ptr<IALIMMIO>(iidALI_MMIO_Service, m_pService);
+   m_pBuffer = dynamic_ptr<IALIBuffer>(iidALI_BUFF_Service, m_pService);
+   m_pUMsg   = dynamic_ptr<IALIUMsg>(iidALI_UMSG_Service, m_pService);
+   m_pReset  = dynamic_ptr<IALIReset>(iidALI_RSET_Service, m_pService);
+
+   if ( ( NULL == m_pMMIO ) || ( NULL == m_pBuffer ) ) {
+      AAL_ERR(LM_AAS, "ALIOpen(): the allocated Service has no IALIMMIO or IALIBuffer" << std::endl);
+      Close();
+      return false;
+   }
+
+   m_MMIOBase   = m_pMMIO->mmioGetAddress();
+   m_MMIOLength = m_pMMIO->mmioGetLength();
+
+   Timer t3;
+   (t3 - t2).AsMicroSeconds(m_Times.Interfaces);
+
+   if ( !flag_is_set(m_Flags, ALIOPEN_FLAG_NO_MMIO_READ) ) {
+      if ( !m_pMMIO->mmioRead64(0, &m_DFH) ) {
+         AAL_ERR(LM_AAS, "ALIOpen(): the first MMIO read failed" << std::endl);
+         Close();
+         return false;
+      }
+   }
+
+   Timer t4;
+   (t4 - t3).AsMicroSeconds(m_Times.FirstMMIO);
+   (t4 - t0).AsMicroSeconds(m_Times.Total);
+
+   return true;
+}
+
+//=============================================================================
+// Name: Close
+// Description: Release the ALI Service and the shared Runtime reference.
+// Interface: protected
+//=============================================================================
+void ALIDevice::Close()
+{
+   if ( NULL != m_pService ) {
+      IAALService *pService = dynamic_ptr<IAALService>(iidService, m_pService);
+
+      m_pMMIO    = NULL;
+      m_pBuffer  = NULL;
+      m_pUMsg    = NULL;
+      m_pReset   = NULL;
+      m_pService = NULL;
+
+      if ( ( NULL != pService ) && pService->Release(TransactionID()) ) {
+         m_Sem.Wait(); // serviceReleased() or serviceReleaseFailed()
+      }
+   }
+
+   if ( m_bOwnRuntime ) {
+      m_bOwnRuntime = false;
+      SharedRuntime().Release();
+   }
+   m_pRuntime = NULL;
+}
+
+//=============================================================================
+// Name: IServiceClient
+// Description: Each reply records its outcome and wakes the waiting caller.
+//=============================================================================
+void ALIDevice::serviceAllocated(IBase *pServiceBase, TransactionID const & )
+{
+   m_pService = pServiceBase;
+   m_bResult  = ( NULL != pServiceBase );
+   m_Sem.Post(1);
+}
+
+void ALIDevice::serviceAllocateFailed(const IEvent &rEvent)
+{
+   PrintExceptionDescription(rEvent);
+   m_bResult = false;
+   m_Sem.Post(1);
+}
+
+void ALIDevice::serviceReleased(TransactionID const & )
+{
+   m_bResult = true;
+   m_Sem.Post(1);
+}
+
+void ALIDevice::serviceReleaseFailed(const IEvent &rEvent)
+{
+   PrintExceptionDescription(rEvent);
+   m_bResult = false;
+   m_Sem.Post(1);
+}
+
+void ALIDevice::serviceReleaseRequest(IBase * , const IEvent & )
+{
+   AAL_WARNING(LM_AAS, "ALIDevice: the ALI Service requested release. Call ALIClose()." << std::endl);
+}
+
+void ALIDevice::serviceEvent(const IEvent & ) {}
+
+//=============================================================================
+// Name: ALIOpen
+// Description: Open an ALI AFU synchronously.
+//=============================================================================
+ALIDevice * ALIOpen(btcString          AFUId,
+                    btUnsigned32bitInt BusDevFn,
+                    btUnsigned32bitInt Flags,
+                    IRuntime          *pRuntime)
+{
+   ALIDevice *pDevice = new(std::nothrow) ALIDevice(Flags);
+
+   if ( ( NULL == pDevice ) || !pDevice->IsOK() ) {
+      delete pDevice;
+      return NULL;
+   }
+
+   if ( !pDevice->Open(AFUId, BusDevFn, pRuntime) ) {
+      delete pDevice;
+      return NULL;
+   }
+
+   return pDevice;
+}
+
+//=============================================================================
+// Name: ALIClose
+// Description: Release an AFU opened by ALIOpen().
+//=============================================================================
+void ALIClose(ALIDevice *pDevice)
+{
+   delete pDevice;
+}
+
+END_NAMESPACE(AAL)
+
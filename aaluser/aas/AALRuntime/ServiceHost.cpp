@@ -46,6 +46,7 @@
 #include "aalsdk/AALDefs.h"
 #include "aalsdk/aas/ServiceHost.h"
 #include <aalsdk/Runtime.h>
+#include "aalsdk/AALLoggerExtern.h"              // AAL Logger
 
 BEGIN_NAMESPACE(AAL)
 
@@ -179,5 +180,56 @@ btBool ServiceHost::InstantiateService(IRuntime            *pRuntime,
    return m_pProvider->Construct(pRuntime, pClientBase, rTranID, rManifest);
 }
 
+//=============================================================================
+// Name: GetPreloadServices
+// Description: List the Service libraries to preload
+// Interface: public
+// Inputs: optArgs - may carry AALRUNTIME_CONFIG_RECORD.
+// Outputs: Names - the names from AALRUNTIME_CONFIG_PRELOAD_SERVICES.
+// Comments: Shared by the default and RRM Service Brokers.
+//=============================================================================
+btBool GetPreloadServices(NamedValueSet const &optArgs, std::list<std::string> &Names)
+{
+   INamedValueSet const *pConfigRecord = NULL;
+   eBasicTypes           Type;
+
+   Names.clear();
+
+   if ( ENamedValuesOK != optArgs.Get(AALRUNTIME_CONFIG_RECORD, &pConfigRecord) ) {
+      return false;
+   }
+
+   if ( ENamedValuesOK != pConfigRecord->Type(AALRUNTIME_CONFIG_PRELOAD_SERVICES, &Type) ) {
+      return false;
+   }
+
+   switch ( Type ) {
+      case btString_t : {
+         btcString sName = NULL;
+         if ( ENamedValuesOK == pConfigRecord->Get(AALRUNTIME_CONFIG_PRELOAD_SERVICES, &sName) ) {
+            Names.push_back(std::string(sName));
+         }
+      } break;
+
+      case btStringArray_t : {
+         btStringArray pNames = NULL;
+         btWSSize      Count  = 0;
+         btWSSize      i;
+         if ( ( ENamedValuesOK == pConfigRecord->Get(AALRUNTIME_CONFIG_PRELOAD_SERVICES, &pNames) ) &&
+              ( ENamedValuesOK == pConfigRecord->GetSize(AALRUNTIME_CONFIG_PRELOAD_SERVICES, &Count) ) ) {
+            for ( i = 0 ; i < Count ; ++i ) {
+               Names.push_back(std::string(pNames[i]));
+            }
+         }
+      } break;
+
+      default : {
+         AAL_ERR(LM_AAS, AALRUNTIME_CONFIG_PRELOAD_SERVICES << " must be a btString or btStringArray" << std::endl);
+      } break;
+   }
+
+   return !Names.empty();
+}
+
 END_NAMESPACE(AAL)
 
@@ -48,6 +48,7 @@
 #include "aalsdk/AALDefs.h"
 #include "aalsdk/aas/AALRuntimeModule.h"
 #include "aalsdk/osal/OSServiceModule.h"
+#include "aalsdk/osal/Sleep.h"
 #include "aalsdk/aas/AALInProcServiceFactory.h"  // Defines InProc Service Factory
 #include "aalsdk/aas/Dispatchables.h"
 #include "_MessageDelivery.h"
@@ -64,63 +65,227 @@ BEGIN_NAMESPACE(AAL)
 /// @{
 
 _MessageDelivery::_MessageDelivery() :
-   m_Dispatcher() // Default is a simple single threaded scheduler.
+   m_pDispatcher(new(std::nothrow) OSLThreadGroup()), // Default is a simple single threaded scheduler.
+   m_Ordering(AALRUNTIME_MDS_ORDER_GLOBAL)
 {
+   if ( ( NULL == m_pDispatcher ) || !m_pDispatcher->IsOK() ) {
+      m_bIsOK = false;
+      return;
+   }
+
    if ( EObjOK != SetInterface(iidMDS,
                                dynamic_cast<IMessageDeliveryService *>(this)) ) {
       m_bIsOK = false;
    }
 }
 
+_MessageDelivery::~_MessageDelivery()
+{
+   if ( NULL != m_pDispatcher ) {
+      StopMessageDelivery();
+      delete m_pDispatcher;
+   }
+}
+
+void _MessageDelivery::StartMessageDelivery()
+{
+   AutoLock(this);
+   m_pDispatcher->Start();
+}
+
+void _MessageDelivery::StopMessageDelivery()
+{
+   {
+      AutoLock(this);
+      m_pDispatcher->Drain();
+   }
+
+   // Drain() does not wait for a Strand that is already running. It delivers the rest of
+   //  its target's messages before it retires, and those may schedule more, so wait for it
+   //  without holding our lock. When called from a callback, the caller's own Strand cannot
+   //  retire until we return, and the other running Strands may need locks the caller holds,
+   //  so don't wait at all.
+   if ( !InStrand() ) {
+      for ( ; ; ) {
+         {
+            AutoLock(&m_StrandLock);
+            if ( m_Strands.empty() ) {
+               break;
+            }
+         }
+         SleepZero();
+      }
+   }
+
+   AutoLock(this);
+   m_pDispatcher->Drain();
+   m_pDispatcher->Stop();
+}
+
+btBool _MessageDelivery::scheduleMessage(IDispatchable *pDispatchable)
+{
+   AutoLock(this);
+
+   if ( AALRUNTIME_MDS_ORDER_TARGET == m_Ordering ) {
+      return scheduleOrdered(pDispatchable);
+   }
+
+   return m_pDispatcher->Add(pDispatchable);
+}
+
 //=============================================================================
-// Name: ~_MessageDelivery
-// Description: Retrieve the IEventDispatcher interface.
+// Name: Configure
+// Description: Replace the dispatcher
 // Interface: public
-// Comments:
+// Inputs: Threads - number of dispatcher threads (0 = 1).
+//         CpuMask - CPU affinity of the dispatcher threads (0 = any CPU).
+//         Ordering - AALRUNTIME_MDS_ORDER_*.
+// Outputs: true on success. On failure the current dispatcher is kept.
+// Comments: The old dispatcher is drained without holding our lock, so that
+//           callbacks still running on it may schedule new messages. Those go
+//           to the new dispatcher, except for targets whose Strand is still
+//           pending, which the old dispatcher delivers in order.
 //=============================================================================
-_MessageDelivery::~_MessageDelivery()
+btBool _MessageDelivery::Configure(btUnsignedInt      Threads,
+                                   btUnsigned64bitInt CpuMask,
+                                   btUnsigned32bitInt Ordering)
 {
-   StopMessageDelivery();
+   if ( 0 == Threads ) {
+      Threads = 1;
+   }
+
+   if ( Ordering > AALRUNTIME_MDS_ORDER_NONE ) {
+      AAL_ERR(LM_AAS, "Invalid message delivery ordering " << Ordering << std::endl);
+      return false;
+   }
+
+   if ( 1 == Threads ) {
+      // A single thread delivers everything in order anyway.
+      Ordering = AALRUNTIME_MDS_ORDER_GLOBAL;
+   } else if ( AALRUNTIME_MDS_ORDER_GLOBAL == Ordering ) {
+      // Several workers take messages from one queue concurrently, so they may complete out of order.
+      AAL_ERR(LM_AAS, "Message delivery ordering AALRUNTIME_MDS_ORDER_GLOBAL requires a single thread, not " << Threads << std::endl);
+      return false;
+   }
+
+   OSLThreadGroup *pNew = new(std::nothrow) OSLThreadGroup(Threads, Threads);
+   if ( NULL == pNew ) {
+      return false;
+   }
+   if ( !pNew->IsOK() ) {
+      delete pNew;
+      return false;
+   }
+
+   if ( ( 0 != CpuMask ) && !pNew->SetAffinity(CpuMask) ) {
+      AAL_WARNING(LM_AAS, "Unable to set message delivery CPU affinity 0x" << std::hex << CpuMask << std::dec << std::endl);
+   }
+
+   OSLThreadGroup *pOld;
+   {
+      AutoLock(this);
+      pOld          = m_pDispatcher;
+      m_pDispatcher = pNew;
+      m_Ordering    = Ordering;
+   }
+
+   pOld->Drain();
+   delete pOld;
+
+   return true;
 }
 
 //=============================================================================
-// Name: StartMessageDelivery
-// Description: Start the service
-// Interface: public
-// Comments:
+// Name: scheduleOrdered
+// Description: Schedule a message for per-target ordered delivery
+// Interface: protected
+// Comments: Queues the message behind any pending messages for the same target.
+//           Only the first message of a burst costs a dispatcher Add().
 //=============================================================================
-void _MessageDelivery::StartMessageDelivery()
+btBool _MessageDelivery::scheduleOrdered(IDispatchable *pDispatchable)
 {
-   AutoLock(this);
-   m_Dispatcher.Start();
+   const btObjectType Target = pDispatchable->Target();
+
+   AutoLock(&m_StrandLock);
+
+   strand_map_iter iter = m_Strands.find(Target);
+   if ( m_Strands.end() != iter ) {
+      // The Strand is queued or running, and will deliver this before it retires.
+      iter->second->m_Queue.push_back(pDispatchable);
+      return true;
+   }
+
+   Strand *pStrand = new(std::nothrow) Strand(this, Target);
+   if ( NULL == pStrand ) {
+      return false;
+   }
+
+   pStrand->m_Queue.push_back(pDispatchable);
+
+   if ( !m_pDispatcher->Add(pStrand) ) {
+      delete pStrand;
+      return false;
+   }
+
+   m_Strands[Target] = pStrand;
+
+   return true;
 }
 
 //=============================================================================
-// Name: StopMessageDelivery
-// Description: Stop the service
-// Interface: public
-// Comments: Brute force method
+// Name: InStrand
+// Description: Whether the calling thread is delivering a Strand's message
+// Interface: protected
 //=============================================================================
-void _MessageDelivery::StopMessageDelivery()
+btBool _MessageDelivery::InStrand()
 {
-   AutoLock(this);
-   m_Dispatcher.Drain();
-   m_Dispatcher.Stop();
+   const btTID Self = GetThreadID();
+
+   AutoLock(&m_StrandLock);
+
+   strand_map_iter iter;
+   for ( iter = m_Strands.begin() ; m_Strands.end() != iter ; ++iter ) {
+      if ( iter->second->m_bRunning && ThreadIDEqual(Self, iter->second->m_tid) ) {
+         return true;
+      }
+   }
+
+   return false;
 }
 
 //=============================================================================
-// Name: ~scheduleMessage
-// Description: Schedule a message for processing
+// Name: Strand::operator()
+// Description: Deliver the target's messages in order
 // Interface: public
-// Comments:
+// Comments: The lock is not held while a message is delivered. The Strand
+//           retires when it finds its queue empty.
 //=============================================================================
-btBool _MessageDelivery::scheduleMessage(IDispatchable *pDispatchable)
+void _MessageDelivery::Strand::operator() ()
 {
-   AutoLock(this);
-   return m_Dispatcher.Add(pDispatchable);
+   for ( ; ; ) {
+      IDispatchable *pDisp;
+
+      {
+         AutoLock(&m_pMDS->m_StrandLock);
+
+         m_tid      = GetThreadID();
+         m_bRunning = true;
+
+         if ( m_Queue.empty() ) {
+            m_pMDS->m_Strands.erase(m_Target);
+            break;
+         }
+
+         pDisp = m_Queue.front();
+         m_Queue.pop_front();
+      }
+
+      pDisp->operator() ();
+   }
+
+   delete this;
 }
 
-/// @}
 
 END_NAMESPACE(AAL)
 
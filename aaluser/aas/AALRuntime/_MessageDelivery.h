@@ -47,6 +47,10 @@
 #include <aalsdk/AALIDDefs.h>
 #include <aalsdk/eds/AASEventDeliveryService.h>
 #include <aalsdk/osal/ThreadGroup.h>
+#include <aalsdk/Runtime.h>
+
+#include <deque>
+#include <map>
 
 /// @addtogroup MDS
 /// @{
@@ -73,8 +77,46 @@ public:
    virtual btBool    scheduleMessage(IDispatchable * );
    // </IMessageDeliveryService>
 
+   // Replace the dispatcher with one of Threads workers restricted to CpuMask (0 = any CPU),
+   //  delivering with the given AALRUNTIME_MDS_ORDER_* guarantee. Messages already scheduled
+   //  are delivered by the old dispatcher. Intended to be called before message traffic starts.
+   //  AALRUNTIME_MDS_ORDER_GLOBAL with more than one thread is rejected.
+   btBool Configure(btUnsignedInt      Threads,
+                    btUnsigned64bitInt CpuMask,
+                    btUnsigned32bitInt Ordering);
+
 protected:
-   OSLThreadGroup m_Dispatcher;
+   // The FIFO of messages for one target. While it holds messages, exactly one Strand
+   //  is queued or running on the dispatcher, so a target's messages never run concurrently.
+   class Strand : public IDispatchable
+   {
+   public:
+      Strand(_MessageDelivery *pMDS, btObjectType Target) :
+         m_pMDS(pMDS),
+         m_Target(Target),
+         m_tid(),
+         m_bRunning(false)
+      {}
+
+      virtual void operator() ();
+
+      _MessageDelivery           *m_pMDS;
+      btObjectType                m_Target;
+      std::deque<IDispatchable *> m_Queue;
+      btTID                       m_tid;       // Thread delivering the Strand, once m_bRunning.
+      btBool                      m_bRunning;
+   };
+
+   typedef std::map<btObjectType, Strand *> strand_map_t;
+   typedef strand_map_t::iterator           strand_map_iter;
+
+   btBool scheduleOrdered(IDispatchable * );
+   btBool InStrand();
+
+   OSLThreadGroup    *m_pDispatcher;
+   btUnsigned32bitInt m_Ordering;
+   CriticalSection    m_StrandLock;  // Guards m_Strands and each Strand's queue.
+   strand_map_t       m_Strands;     // Strands with messages pending, by target.
 };
 
 END_NAMESPACE(AAL)
@@ -263,8 +263,20 @@ btBool _runtime::start(Runtime             *pProxy,
 
    }
 
+   // Size the message delivery dispatcher before any Service callbacks are scheduled.
+   if ( !ConfigureMDS(rConfigParms) ) {
+      pDisp = new RuntimeStartFailed(m_pOwnerClient,
+                                     new CExceptionTransactionEvent(pProxy,
+                                                                    exttranevtSystemStart,
+                                                                    TransactionID(),
+                                                                    errSysSystemStarted,
+                                                                    reasInitError,
+                                                                    "Unable to configure message delivery"));
+      goto _DISP;
+   }
+
    // InstallDefaults() will wait for a notification. Don't wait while locked..
-   if ( !InstallDefaults() ) {
+   if ( !InstallDefaults(rConfigParms) ) {
       // Fire the event and wait for it to be dispatched.
       pDisp = new RuntimeStartFailed(m_pOwnerClient,
                                      new CExceptionTransactionEvent(pProxy,
@@ -679,19 +691,29 @@ _runtime::~_runtime()
 // Name: InstallDefaults
 // Description: Install Default Services
 // Interface: public
+// Inputs: rConfigParms - Config parms. Only the AALRUNTIME_CONFIG_RECORD is
+//                        passed to the Service Broker, which preloads
+//                        AALRUNTIME_CONFIG_PRELOAD_SERVICES unless another
+//                        broker is named.
 // Outputs: return false ONLY if and event was NOT generated internally.
 // Comments: If something fails during installation of defaults but we are sane
 //           enough to generate a meaningful event return true. Only return
 //           false if no event was generated. Returning false will result in
 //           caller generating a failure event which is redundant.
 //=============================================================================
-btBool _runtime::InstallDefaults()
+btBool _runtime::InstallDefaults(const NamedValueSet &rConfigParms)
 {
    // Message Delivery Service
 
    // Service Broker. The m_Proxy is _runtime's Proxy which has a pointer to _runtime's IRuntimeClient
+   NamedValueSet         BrokerArgs;
+   INamedValueSet const *pConfigRecord = NULL;
+   if ( ENamedValuesOK == rConfigParms.Get(AALRUNTIME_CONFIG_RECORD, &pConfigRecord) ) {
+      BrokerArgs.Add(AALRUNTIME_CONFIG_RECORD, pConfigRecord);
+   }
+
    m_pBrokerSvcHost = new ServiceHost(AAL_SVC_MOD_ENTRY_POINT(localServiceBroker));
-   if(!m_pBrokerSvcHost->InstantiateService(m_pProxy, dynamic_cast<IBase *>(this), NamedValueSet(), TransactionID(Broker))){
+   if(!m_pBrokerSvcHost->InstantiateService(m_pProxy, dynamic_cast<IBase *>(this), BrokerArgs, TransactionID(Broker))){
       return false;
    }
 
@@ -764,6 +786,54 @@ btBool _runtime::ProcessConfigParms(const NamedValueSet &rConfigParms)
    return true;
 }
 
+//=============================================================================
+// Name: ConfigureMDS
+// Description: Configure the message delivery dispatcher
+// Interface: public
+// Inputs: rConfigParms - Config parms
+// Outputs: false if the configuration is invalid.
+// Comments: Reads AALRUNTIME_CONFIG_MDS_* from the Runtime configuration
+//           record. Without any of them the default single-threaded,
+//           globally ordered dispatcher is kept.
+//=============================================================================
+btBool _runtime::ConfigureMDS(const NamedValueSet &rConfigParms)
+{
+   INamedValueSet const *pConfigRecord = NULL;
+   btUnsigned32bitInt    Threads       = 1;
+   btUnsigned64bitInt    CpuMask       = 0;
+   btUnsigned32bitInt    Ordering      = AALRUNTIME_MDS_ORDER_TARGET;
+
+   if ( ENamedValuesOK != rConfigParms.Get(AALRUNTIME_CONFIG_RECORD, &pConfigRecord) ) {
+      return true;
+   }
+
+   if ( !pConfigRecord->Has(AALRUNTIME_CONFIG_MDS_THREADS)  &&
+        !pConfigRecord->Has(AALRUNTIME_CONFIG_MDS_AFFINITY) &&
+        !pConfigRecord->Has(AALRUNTIME_CONFIG_MDS_ORDERING) ) {
+      return true;
+   }
+
+   if ( pConfigRecord->Has(AALRUNTIME_CONFIG_MDS_THREADS) &&
+        ( ENamedValuesOK != pConfigRecord->Get(AALRUNTIME_CONFIG_MDS_THREADS, &Threads) ) ) {
+      AAL_ERR(LM_AAS, AALRUNTIME_CONFIG_MDS_THREADS << " must be a btUnsigned32bitInt" << std::endl);
+      return false;
+   }
+
+   if ( pConfigRecord->Has(AALRUNTIME_CONFIG_MDS_AFFINITY) &&
+        ( ENamedValuesOK != pConfigRecord->Get(AALRUNTIME_CONFIG_MDS_AFFINITY, &CpuMask) ) ) {
+      AAL_ERR(LM_AAS, AALRUNTIME_CONFIG_MDS_AFFINITY << " must be a btUnsigned64bitInt" << std::endl);
+      return false;
+   }
+
+   if ( pConfigRecord->Has(AALRUNTIME_CONFIG_MDS_ORDERING) &&
+        ( ENamedValuesOK != pConfigRecord->Get(AALRUNTIME_CONFIG_MDS_ORDERING, &Ordering) ) ) {
+      AAL_ERR(LM_AAS, AALRUNTIME_CONFIG_MDS_ORDERING << " must be a btUnsigned32bitInt" << std::endl);
+      return false;
+   }
+
+   return m_MDS.Configure(Threads, CpuMask, Ordering);
+}
+
 //
 // IServiceClient Interface
 //-------------------------
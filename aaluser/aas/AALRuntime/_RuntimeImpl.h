@@ -145,8 +145,9 @@ private:
 
    ~_runtime();
 
-   btBool    InstallDefaults();
+   btBool    InstallDefaults(const NamedValueSet &rConfigParms);
    btBool ProcessConfigParms(const NamedValueSet &rConfigParms);
+   btBool   ConfigureMDS(const NamedValueSet &rConfigParms);
 
    // <IServiceClient>
    virtual void       serviceAllocated(IBase               *pServiceBase,
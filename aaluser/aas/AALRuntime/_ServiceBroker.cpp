@@ -45,9 +45,13 @@
 #include "aalsdk/aas/AALInProcServiceFactory.h"  // Defines InProc Service Factory
 #include "aalsdk/aas/Dispatchables.h"
 #include "aalsdk/aas/ServiceHost.h"
+#include "aalsdk/osal/Env.h"
 #include "aalsdk/AALLoggerExtern.h"              // AAL Logger
 #include "_ServiceBroker.h"
 #include "aalsdk/aas/AALRuntimeModule.h"
+#include "aalsdk/Runtime.h"
+
+#include <list>
 
 
 #define SERVICE_FACTORY AAL::InProcSvcsFact< AAL::_ServiceBroker >
@@ -73,7 +77,8 @@ BEGIN_NAMESPACE(AAL)
 // Name: init
 // Description: Initialize the object
 // Interface: public
-// Inputs: rtid - reference to a transaction ID
+// Inputs: optArgs - may carry the Runtime configuration record.
+//         rtid - reference to a transaction ID
 // Comments:
 //   This is called via the base class construction chain.  Since this class is
 //   derived from ServiceBase it can assume that all of the base members have
@@ -83,9 +88,52 @@ btBool _ServiceBroker::init(IBase               *pclientBase,
                             NamedValueSet const &optArgs,
                             TransactionID const &rtid)
 {
+   PreloadServices(optArgs);
    return initComplete(rtid);
 }
 
+//=============================================================================
+// Name: PreloadServices
+// Description: Load the Service libraries named by AALRUNTIME_CONFIG_PRELOAD_SERVICES
+// Interface: protected
+// Inputs: optArgs - may carry AALRUNTIME_CONFIG_RECORD.
+// Comments: Runs during Runtime start, so the first allocService() of each
+//           named Service finds its ServiceHost already in m_ServiceMap.
+//           A name that fails to load is only logged; allocating it later
+//           reports the failure to the client as before.
+//           When AALRUNTIME_CONFIG_BROKER_SERVICE names another broker, that
+//           broker loads the Services and preloads them itself. Loading them
+//           here too would give each library a second ServiceHost sharing
+//           the module's provider, which both would then destroy.
+//=============================================================================
+void _ServiceBroker::PreloadServices(NamedValueSet const &optArgs)
+{
+   INamedValueSet const *pConfigRecord = NULL;
+   std::string           strSname;
+
+   if ( Environment::GetObj()->Get("AALRUNTIME_CONFIG_BROKER_SERVICE", strSname) ) {
+      return;
+   }
+   if ( ( ENamedValuesOK == optArgs.Get(AALRUNTIME_CONFIG_RECORD, &pConfigRecord) ) &&
+        pConfigRecord->Has(AALRUNTIME_CONFIG_BROKER_SERVICE) ) {
+      return;
+   }
+
+   std::list<std::string> Names;
+   if ( !GetPreloadServices(optArgs, Names) ) {
+      return;
+   }
+
+   std::list<std::string>::const_iterator iter;
+   for ( iter = Names.begin() ; Names.end() != iter ; ++iter ) {
+      if ( NULL == loadServiceHost(iter->c_str()) ) {
+         AAL_WARNING(LM_AAS, "Failed to preload Service " << *iter << std::endl);
+      } else {
+         AAL_DEBUG(LM_AAS, "Preloaded Service " << *iter << std::endl);
+      }
+   }
+}
+
 //=============================================================================
 // Name: allocService
 // Description: Allocates a Service
@@ -146,17 +194,11 @@ void _ServiceBroker::allocService(IRuntime            *pProxy,
    {
       AutoLock(this);
 
-      if ( NULL == (SvcHost = findServiceHost(sName)) ) {
-         // Load the Service Library and set the Runtime Proxy and Runtime Service Providers
-         SvcHost = new(std::nothrow) ServiceHost(sName);
-      }
-
-      if ( ( NULL == SvcHost ) || !SvcHost->IsOK() ) {
-
-         if ( NULL != SvcHost ) {
-            delete SvcHost;
-         }
+      btBool bLoaded = false;
 
+      // Load the Service Library unless it was loaded by an earlier allocation or preloaded.
+      //  The ServiceHost is saved now, before the Service generates the serviceAllocated.
+      if ( NULL == (SvcHost = loadServiceHost(sName, &bLoaded)) ) {
          pDisp = new ServiceAllocateFailed(pServiceClient,
                                            pRuntimeClient,
                                            new CExceptionTransactionEvent(NULL,
@@ -169,16 +211,16 @@ void _ServiceBroker::allocService(IRuntime            *pProxy,
 
       // Allocate the service
 
-      // Save the ServiceHost.  Do it now before the Service generates the serviceAllocated.
-      //  If it fails remove it
-      m_ServiceMap[std::string(sName)] = SvcHost;
-
       if ( SvcHost->InstantiateService(pProxy, pServiceClientBase, rManifest, rTranID) ) {
          // success
          return;
       }
 
-      m_ServiceMap.erase(std::string(sName));
+      // If this call loaded the library, remove it. A host that already served
+      //  other allocations stays.
+      if ( bLoaded ) {
+         m_ServiceMap.erase(sName);
+      }
 //      delete SvcHost;  // TODO CAN'T DELETE SvcHost as it will unload library.  Ref count??
 
       pDisp = new ServiceAllocateFailed(pServiceClient,
@@ -201,11 +243,13 @@ _DISP:
 
 //=============================================================================
 // Name: findServiceHost
-// Description: Release the service
-// Interface: public
+// Description: Find the ServiceHost of a loaded Service library
+// Interface: protected
+// Inputs: sName - Service library name.
+// Outputs: The ServiceHost, or NULL if the library is not loaded.
 // Comments:
 //=============================================================================
-ServiceHost *_ServiceBroker::findServiceHost(std::string const &sName)
+ServiceHost *_ServiceBroker::findServiceHost(btcString sName)
 {
    AutoLock(this);
    Servicemap_itr itr = m_ServiceMap.find(sName);
@@ -215,6 +259,46 @@ ServiceHost *_ServiceBroker::findServiceHost(std::string const &sName)
    return itr->second;
 }
 
+//=============================================================================
+// Name: loadServiceHost
+// Description: Find the ServiceHost of a Service library, loading it if needed
+// Interface: protected
+// Inputs: sName - Service library name.
+// Outputs: The ServiceHost, or NULL if the library failed to load.
+//          pLoaded - if not NULL, set to true when this call loaded the library.
+// Comments: A newly loaded ServiceHost is added to m_ServiceMap.
+//=============================================================================
+ServiceHost *_ServiceBroker::loadServiceHost(btcString sName, btBool *pLoaded)
+{
+   AutoLock(this);
+
+   if ( NULL != pLoaded ) {
+      *pLoaded = false;
+   }
+
+   ServiceHost *SvcHost = findServiceHost(sName);
+   if ( NULL != SvcHost ) {
+      return SvcHost;
+   }
+
+   // Load the Service Library and get its Service factory
+   SvcHost = new(std::nothrow) ServiceHost(sName);
+
+   if ( ( NULL == SvcHost ) || !SvcHost->IsOK() ) {
+      if ( NULL != SvcHost ) {
+         delete SvcHost;
+      }
+      return NULL;
+   }
+
+   m_ServiceMap[SvcHost->getName().c_str()] = SvcHost;
+
+   if ( NULL != pLoaded ) {
+      *pLoaded = true;
+   }
+   return SvcHost;
+}
+
 //=============================================================================
 //
 // Service Broker Shutdown is a complex process that involves shutting down
@@ -340,11 +424,23 @@ struct shutdown_handler_thread_parms
 btBool _ServiceBroker::DoShutdown(TransactionID const &rTranID,
                                     btTime               timeout)
 {
-   CSemaphore     srvcCount;
-   Servicemap_itr itr;
-   btBool         ret = false;
+   CSemaphore                         srvcCount;
+   std::list<ServiceHost *>           Hosts;
+   std::list<ServiceHost *>::iterator itr;
+   btBool                             ret = false;
 
-   btUnsigned32bitInt size = m_servicecount = static_cast<btUnsigned32bitInt>(m_ServiceMap.size());
+   // The map is keyed by the ServiceHosts' names, so take the hosts out of it
+   //  before the handlers start deleting them.
+   {
+      AutoLock(this);
+      Servicemap_itr mitr;
+      for ( mitr = m_ServiceMap.begin() ; m_ServiceMap.end() != mitr ; ++mitr ) {
+         Hosts.push_back((*mitr).second);
+      }
+      m_ServiceMap.clear();
+   }
+
+   btUnsigned32bitInt size = m_servicecount = static_cast<btUnsigned32bitInt>(Hosts.size());
    if ( 0 == size ) {
       timeout = 0;
    }
@@ -360,10 +456,10 @@ btBool _ServiceBroker::DoShutdown(TransactionID const &rTranID,
    // after issuing a shutdown on each wait for the
    // services to complete
    //-------------------------------------------------
-   for ( itr = m_ServiceMap.begin() ; size > 0 ; size--, itr++ ) {
+   for ( itr = Hosts.begin() ; size > 0 ; size--, itr++ ) {
 
       // If the IServiceModule is present
-      if ( NULL != (*itr).second->getProvider() ) {
+      if ( NULL != (*itr)->getProvider() ) {
 
          // Shutdown done in parallel so each gets same max-time
          //   assume 0 time start so no timeout adjust performed
@@ -371,7 +467,7 @@ btBool _ServiceBroker::DoShutdown(TransactionID const &rTranID,
          // Technically should join on these threads
          new OSLThread(_ServiceBroker::ShutdownHandlerThread,
                        OSLThread::THREADPRIORITY_NORMAL,
-                       new shutdown_handler_thread_parms(this, (*itr).second, &srvcCount, timeout));
+                       new shutdown_handler_thread_parms(this, *itr, &srvcCount, timeout));
 
       }
    }
@@ -396,9 +492,6 @@ btBool _ServiceBroker::DoShutdown(TransactionID const &rTranID,
          getRuntime()->schedDispatchable(new ServiceReleased(getServiceClient(),
                                                              this,
                                                              rTranID));
-
-         // Clear the map now
-         m_ServiceMap.clear();
          return true;
       }
    }
@@ -41,6 +41,8 @@
 #include <aalsdk/aas/AALService.h>
 #include <aalsdk/osal/OSServiceModule.h>
 
+#include <cstring>
+
 //=============================================================================
 // Name: AAL_DECLARE_SVC_MOD
 // Description: Declares a module entry point.
@@ -89,10 +91,17 @@ public:
    // </IServiceBroker>
 
 protected:
-   typedef std::map<std::string, ServiceHost *> ServiceMap;
-   typedef ServiceMap::iterator                 Servicemap_itr;
-
-   ServiceHost * findServiceHost(std::string const &sName);
+   // Keyed by the ServiceHost's own copy of its name, so lookups need no std::string.
+   struct ServiceNameLess
+   {
+      bool operator()(btcString a, btcString b) const { return strcmp(a, b) < 0; }
+   };
+   typedef std::map<btcString, ServiceHost *, ServiceNameLess> ServiceMap;
+   typedef ServiceMap::iterator                                Servicemap_itr;
+
+   ServiceHost * findServiceHost(btcString sName);
+   ServiceHost * loadServiceHost(btcString sName, btBool *pLoaded=NULL);
+   void          PreloadServices(NamedValueSet const &optArgs);
 
    // Used by Release
    static void ShutdownThread(OSLThread           *pThread, void  *pContext);
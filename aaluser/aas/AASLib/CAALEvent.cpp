@@ -93,10 +93,10 @@ CAALEvent::CAALEvent(IBase *pObject) :
    m_pServiceClient(NULL),
    m_pRuntimeClient(NULL),
    m_pEventHandler(NULL),
-   m_SubClassID(0)
+   m_SubClassID(0),
+   m_NumInterfaces(0),
+   m_pMoreInterfaces(NULL)
 {
-   AutoLock(this);
-
    if ( SetInterface(iidCEvent, dynamic_cast<CAALEvent *>(this)) != EObjOK ) {
       return;
    }
@@ -123,10 +123,10 @@ CAALEvent::CAALEvent(IBase *pObject, btIID SubClassID) :
    m_pServiceClient(NULL),
    m_pRuntimeClient(NULL),
    m_pEventHandler(NULL),
-   m_SubClassID(0)
+   m_SubClassID(0),
+   m_NumInterfaces(0),
+   m_pMoreInterfaces(NULL)
 {
-   AutoLock(this);
-
    if ( SetInterface(iidCEvent, dynamic_cast<CAALEvent *>(this)) != EObjOK ) {
       return;
    }
@@ -156,14 +156,21 @@ CAALEvent::CAALEvent(IBase *pObject, btIID SubClassID) :
 //=============================================================================
 btGenericInterface CAALEvent::Interface(btIID ID) const
 {
-   AutoLock(this);
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_NumInterfaces ; ++i ) {
+      if ( ID == m_Interfaces[i].m_ID ) {
+         return m_Interfaces[i].m_pInterface;
+      }
+   }
 
-   IIDINTERFACE_CITR itr = m_InterfaceMap.find(ID);
-   if ( m_InterfaceMap.end() == itr ) { // not found
-      return NULL;
+   if ( NULL != m_pMoreInterfaces ) {
+      IIDINTERFACE_CITR itr = m_pMoreInterfaces->find(ID);
+      if ( m_pMoreInterfaces->end() != itr ) {
+         return (*itr).second;
+      }
    }
 
-   return (*itr).second;
+   return NULL; // not found
 }
 
 //=============================================================================
@@ -176,13 +183,18 @@ btGenericInterface CAALEvent::Interface(btIID ID) const
 //=============================================================================
 btBool CAALEvent::Has(btIID ID) const
 {
-   AutoLock(this);
-   return m_InterfaceMap.end() != m_InterfaceMap.find(ID);
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_NumInterfaces ; ++i ) {
+      if ( ID == m_Interfaces[i].m_ID ) {
+         return true;
+      }
+   }
+
+   return ( NULL != m_pMoreInterfaces ) && ( m_pMoreInterfaces->end() != m_pMoreInterfaces->find(ID) );
 }
 
 btIID CAALEvent::SubClassID() const
 {
-   AutoLock(this);
    return m_SubClassID;
 }
 
@@ -219,34 +231,39 @@ btBool CAALEvent::operator != (const IEvent &rOther) const
 //=============================================================================
 btBool CAALEvent::operator == (const IEvent &rOther) const
 {
-   AutoLock(this);
-
    CAALEvent *pOther = reinterpret_cast<CAALEvent *>(rOther.Interface(iidCEvent));
    if ( NULL == pOther ) {
       // 1) fails
       return false;
    }
 
-   {
-      AutoLock(pOther);
+   if ( SubClassID() != pOther->SubClassID() ) {
+      // 2) fails
+      return false;
+   }
 
-      if ( SubClassID() != pOther->SubClassID() ) {
-         // 2) fails
-         return false;
-      }
+   const btUnsignedInt NumMore      = ( NULL == m_pMoreInterfaces )         ? 0 : (btUnsignedInt)m_pMoreInterfaces->size();
+   const btUnsignedInt OtherNumMore = ( NULL == pOther->m_pMoreInterfaces ) ? 0 : (btUnsignedInt)pOther->m_pMoreInterfaces->size();
 
-      if ( m_InterfaceMap.size() != pOther->m_InterfaceMap.size() ) {
-         // 3a) fails
+   if ( m_NumInterfaces + NumMore != pOther->m_NumInterfaces + OtherNumMore ) {
+      // 3a) fails
+      return false;
+   }
+
+   // Interface ids are unique within an event, so with equal counts it is enough that
+   //  each of ours is also one of theirs.
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_NumInterfaces ; ++i ) {
+      if ( !pOther->Has(m_Interfaces[i].m_ID) ) {
+         // 3b) fails
          return false;
       }
+   }
 
-      IIDINTERFACE_CITR l;
-      IIDINTERFACE_CITR r;
-
-      for ( l = m_InterfaceMap.begin(), r = pOther->m_InterfaceMap.begin() ;
-               l != m_InterfaceMap.end() ;
-                  ++l, ++r ) {
-         if ( (*l).first != (*r).first ) {
+   if ( NULL != m_pMoreInterfaces ) {
+      IIDINTERFACE_CITR itr;
+      for ( itr = m_pMoreInterfaces->begin() ; m_pMoreInterfaces->end() != itr ; ++itr ) {
+         if ( !pOther->Has((*itr).first) ) {
             // 3b) fails
             return false;
          }
@@ -257,13 +274,12 @@ btBool CAALEvent::operator == (const IEvent &rOther) const
    return true;
 }
 
-IBase &               CAALEvent::Object() const { AutoLock(this); return *m_pObject; }
-IBase *              CAALEvent::pObject() const { AutoLock(this); return  m_pObject; }
-btBool                  CAALEvent::IsOK() const { AutoLock(this); return  m_bIsOK;   }
+IBase &               CAALEvent::Object() const { return *m_pObject; }
+IBase *              CAALEvent::pObject() const { return  m_pObject; }
+btBool                  CAALEvent::IsOK() const { return  m_bIsOK;   }
 
 void CAALEvent::setHandler(IServiceClient *pHandler)
 {
-   AutoLock(this);
    m_pServiceClient = pHandler;
    m_pRuntimeClient = NULL;
    m_pEventHandler  = NULL;
@@ -271,7 +287,6 @@ void CAALEvent::setHandler(IServiceClient *pHandler)
 
 void CAALEvent::setHandler(IRuntimeClient *pHandler)
 {
-   AutoLock(this);
    m_pServiceClient = NULL;
    m_pRuntimeClient = pHandler;
    m_pEventHandler  = NULL;
@@ -279,7 +294,6 @@ void CAALEvent::setHandler(IRuntimeClient *pHandler)
 
 void CAALEvent::setHandler(btEventHandler pHandler)
 {
-   AutoLock(this);
    m_pServiceClient = NULL;
    m_pRuntimeClient = NULL;
    m_pEventHandler  = pHandler;
@@ -305,8 +319,6 @@ EOBJECT CAALEvent::SetSubClassInterface(btIID              InterfaceID,
 {
    EOBJECT result;
 
-   AutoLock(this);
-
    if ( (result = SetInterface(InterfaceID,
                                pInterface)) != EObjOK ) {
       return result;
@@ -329,7 +341,6 @@ EOBJECT CAALEvent::SetSubClassInterface(btIID              InterfaceID,
 //=============================================================================
 void CAALEvent::SetObject(IBase *pObject)
 {
-   AutoLock(this);
    m_pObject = pObject;
 }
 
@@ -397,15 +408,25 @@ EOBJECT CAALEvent::SetInterface(btIID              Interface,
       return EObjBadObject;
    }
 
-   AutoLock(this);
-
    // Make sure there is not an implementation already.
    if ( Has(Interface) ) {
       return EObjDuplicateName;
    }
 
    // Add the interface
-   m_InterfaceMap[Interface] = pInterface;
+   if ( m_NumInterfaces < InlineInterfaces ) {
+      m_Interfaces[m_NumInterfaces].m_ID         = Interface;
+      m_Interfaces[m_NumInterfaces].m_pInterface = pInterface;
+      ++m_NumInterfaces;
+   } else {
+      if ( NULL == m_pMoreInterfaces ) {
+         m_pMoreInterfaces = new(std::nothrow) iidInterfaceMap_t();
+         if ( NULL == m_pMoreInterfaces ) {
+            return EObjBadObject;
+         }
+      }
+      (*m_pMoreInterfaces)[Interface] = pInterface;
+   }
 
    return EObjOK;
 }
@@ -418,8 +439,87 @@ EOBJECT CAALEvent::SetInterface(btIID              Interface,
 //=============================================================================
 btBool CAALEvent::ProcessEventTranID() {/* no TransactionID override in regular events */ return false; }
 
-CAALEvent::CAALEvent() {/*empty*/}
-CAALEvent::~CAALEvent() {/*empty*/}
+//=============================================================================
+// Name: CAALEvent
+// Description: Copy constructor
+//=============================================================================
+CAALEvent::CAALEvent(const CAALEvent &other) :
+   CCountedObject(),
+   IDispatchable(),
+   IEvent(),
+   m_pObject(other.m_pObject),
+   m_bIsOK(other.m_bIsOK),
+   m_pServiceClient(other.m_pServiceClient),
+   m_pRuntimeClient(other.m_pRuntimeClient),
+   m_pEventHandler(other.m_pEventHandler),
+   m_SubClassID(other.m_SubClassID),
+   m_NumInterfaces(other.m_NumInterfaces),
+   m_pMoreInterfaces(NULL)
+{
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_NumInterfaces ; ++i ) {
+      m_Interfaces[i] = other.m_Interfaces[i];
+   }
+
+   if ( NULL != other.m_pMoreInterfaces ) {
+      m_pMoreInterfaces = new(std::nothrow) iidInterfaceMap_t(*other.m_pMoreInterfaces);
+      if ( NULL == m_pMoreInterfaces ) {
+         m_bIsOK = false;
+      }
+   }
+}
+
+CAALEvent::CAALEvent() :
+   m_NumInterfaces(0),
+   m_pMoreInterfaces(NULL)
+{/*empty*/}
+
+CAALEvent::~CAALEvent()
+{
+   if ( NULL != m_pMoreInterfaces ) {
+      delete m_pMoreInterfaces;
+   }
+}
+
+//=============================================================================
+// Name: CAALEvent::EventPool
+// Description: The pool that events are allocated from.
+// Comments: Created on first use and never destroyed, so that events deleted
+//           during static destruction still have a pool to return to.
+//=============================================================================
+CObjectPool & CAALEvent::EventPool()
+{
+   static CObjectPool *pPool = new CObjectPool();
+   return *pPool;
+}
+
+//=============================================================================
+// Name: CAALEvent::operator new / operator delete
+// Description: Allocate CAALEvent's and subclasses from EventPool().
+//=============================================================================
+void * CAALEvent::operator new(std::size_t Size)
+{
+   void *p = EventPool().Allocate(Size);
+   if ( NULL == p ) {
+      throw std::bad_alloc();
+   }
+   return p;
+}
+
+void * CAALEvent::operator new(std::size_t Size, const std::nothrow_t & ) throw()
+{
+   return EventPool().Allocate(Size);
+}
+
+void CAALEvent::operator delete(void *p)
+{
+   EventPool().Free(p);
+}
+
+void CAALEvent::operator delete(void *p, const std::nothrow_t & ) throw()
+{
+   EventPool().Free(p);
+}
 
 //=============================================================================
 // Name: CTransactionEvent
@@ -432,8 +532,6 @@ CTransactionEvent::CTransactionEvent(IBase               *pObject,
    CAALEvent(pObject),
    m_TranID(TranID)
 {
-   AutoLock(this);
-
    // ITransactionEvent is the default native subclass interface unless overridden by a subclass.
    if ( SetSubClassInterface(iidTranEvent, dynamic_cast<ITransactionEvent *>(this)) != EObjOK ) {
       m_bIsOK = false;
@@ -453,8 +551,6 @@ CTransactionEvent::CTransactionEvent(IBase               *pObject,
    CAALEvent(pObject),
    m_TranID(TranID)
 {
-   AutoLock(this);
-
    // ITransactionEvent is the default native subclass interface unless overridden by a subclass.
    if ( SetInterface(iidTranEvent, dynamic_cast<ITransactionEvent *>(this)) != EObjOK ) {
       m_bIsOK = false;
@@ -470,8 +566,6 @@ CTransactionEvent::CTransactionEvent(IBase               *pObject,
 
 btBool CTransactionEvent::operator == (const IEvent &rhs) const
 {
-   AutoLock(this);
-
    if ( CAALEvent::operator==(rhs) ) {
 
       ITransactionEvent *pIOther = reinterpret_cast<ITransactionEvent *>(rhs.Interface(iidTranEvent));
@@ -481,13 +575,9 @@ btBool CTransactionEvent::operator == (const IEvent &rhs) const
          return false;
       }
 
-      {
-         AutoLock(pCOther);
-
-         if ( m_TranID == pCOther->m_TranID ) {
-            // objects are equal
-            return true;
-         }
+      if ( m_TranID == pCOther->m_TranID ) {
+         // objects are equal
+         return true;
       }
 
    }
@@ -501,13 +591,11 @@ IEvent * CTransactionEvent::Clone() const
 
 TransactionID CTransactionEvent::TranID() const
 {
-   AutoLock(this);
    return m_TranID;
 }
 
 void CTransactionEvent::SetTranID(TransactionID const &TranID)
 {
-   AutoLock(this);
    m_TranID = TranID;
 }
 
@@ -544,8 +632,6 @@ CExceptionEvent::CExceptionEvent(IBase    *pObject,
    m_strDescription(Description)
 
 {
-   AutoLock(this);
-
    // default native subclass interface unless overridden by a subclass.
    if ( SetSubClassInterface(iidExEvent, dynamic_cast<IExceptionEvent *>(this)) != EObjOK ) {
       m_bIsOK = false;
@@ -569,8 +655,6 @@ CExceptionEvent::CExceptionEvent(IBase    *pObject,
    m_Reason(Reason),
    m_strDescription(Description)
 {
-   AutoLock(this);
-
    // iidExEvent is the default native subclass interface unless overriden by a subclass
    if ( SetInterface(iidExEvent, dynamic_cast<IExceptionEvent *>(this)) != EObjOK ) {
       m_bIsOK = false;
@@ -586,8 +670,6 @@ CExceptionEvent::CExceptionEvent(IBase    *pObject,
 
 btBool CExceptionEvent::operator == (const IEvent &rhs) const
 {
-   AutoLock(this);
-
    if ( CAALEvent::operator==(rhs) ) {
 
       IExceptionEvent *pIOther = reinterpret_cast<IExceptionEvent *>(rhs.Interface(iidExEvent));
@@ -597,15 +679,11 @@ btBool CExceptionEvent::operator == (const IEvent &rhs) const
          return false;
       }
 
-      {
-         AutoLock(pCOther);
-
-         if ( m_ExceptionNumber == pCOther->m_ExceptionNumber &&
-              m_Reason          == pCOther->m_Reason          &&
-              0 == m_strDescription.compare(pCOther->m_strDescription) ) {
-            // objects are equal
-            return true;
-         }
+      if ( m_ExceptionNumber == pCOther->m_ExceptionNumber &&
+           m_Reason          == pCOther->m_Reason          &&
+           0 == m_strDescription.compare(pCOther->m_strDescription) ) {
+         // objects are equal
+         return true;
       }
 
    }
@@ -617,12 +695,11 @@ IEvent * CExceptionEvent::Clone() const
    return new(std::nothrow) CExceptionEvent(*this);
 }
 
-btID CExceptionEvent::ExceptionNumber() const { AutoLock(this); return m_ExceptionNumber; }
-btID          CExceptionEvent::Reason() const { AutoLock(this); return m_Reason;          }
+btID CExceptionEvent::ExceptionNumber() const { return m_ExceptionNumber; }
+btID          CExceptionEvent::Reason() const { return m_Reason;          }
 
 btString CExceptionEvent::Description() const
 {
-   AutoLock(this);
    return (btString)(char *)m_strDescription.c_str();
 }
 
@@ -645,8 +722,6 @@ CExceptionTransactionEvent::CExceptionTransactionEvent(IBase               *pObj
    m_Reason(Reason),
    m_strDescription(Description)
 {
-   AutoLock(this);
-
    if ( SetInterface(iidTranEvent, dynamic_cast<ITransactionEvent *>(this)) != EObjOK ) {
       m_bIsOK = false;
       return;
@@ -677,8 +752,6 @@ CExceptionTransactionEvent::CExceptionTransactionEvent(IBase               *pObj
    m_Reason(Reason),
    m_strDescription(Description)
 {
-   AutoLock(this);
-
    if ( SetInterface(iidTranEvent, dynamic_cast<ITransactionEvent *>(this)) != EObjOK ) {
       m_bIsOK = false;
       return;
@@ -698,8 +771,6 @@ CExceptionTransactionEvent::CExceptionTransactionEvent(IBase               *pObj
 
 btBool CExceptionTransactionEvent::operator == (const IEvent &rhs) const
 {
-   AutoLock(this);
-
    if ( CAALEvent::operator==(rhs) ) {
 
       IExceptionTransactionEvent *pIOther = reinterpret_cast<IExceptionTransactionEvent *>(rhs.Interface(iidExTranEvent));
@@ -709,16 +780,12 @@ btBool CExceptionTransactionEvent::operator == (const IEvent &rhs) const
          return false;
       }
 
-      {
-         AutoLock(pCOther);
-
-         if ( m_TranID          == pCOther->m_TranID          &&
-              m_ExceptionNumber == pCOther->m_ExceptionNumber &&
-              m_Reason          == pCOther->m_Reason          &&
-              0 == m_strDescription.compare(pCOther->m_strDescription) ) {
-            // objects are equal
-            return true;
-         }
+      if ( m_TranID          == pCOther->m_TranID          &&
+           m_ExceptionNumber == pCOther->m_ExceptionNumber &&
+           m_Reason          == pCOther->m_Reason          &&
+           0 == m_strDescription.compare(pCOther->m_strDescription) ) {
+         // objects are equal
+         return true;
       }
 
    }
@@ -730,20 +797,18 @@ IEvent * CExceptionTransactionEvent::Clone() const
    return new(std::nothrow) CExceptionTransactionEvent(*this);
 }
 
-btID CExceptionTransactionEvent::ExceptionNumber() const { AutoLock(this); return m_ExceptionNumber; }
-btID          CExceptionTransactionEvent::Reason() const { AutoLock(this); return m_Reason;          }
+btID CExceptionTransactionEvent::ExceptionNumber() const { return m_ExceptionNumber; }
+btID          CExceptionTransactionEvent::Reason() const { return m_Reason;          }
 
 btString CExceptionTransactionEvent::Description() const
 {
-   AutoLock(this);
    return (btString)(char *)m_strDescription.c_str();
 }
 
-TransactionID CExceptionTransactionEvent::TranID() const { AutoLock(this); return m_TranID; }
+TransactionID CExceptionTransactionEvent::TranID() const { return m_TranID; }
 
 void CExceptionTransactionEvent::SetTranID(TransactionID const &TranID)
 {
-   AutoLock(this);
    m_TranID = TranID;
 }
 
@@ -781,8 +846,6 @@ CReleaseRequestEvent::CReleaseRequestEvent(IBase               *pObject,
    m_Reason(Reason),
    m_strDescription(Description)
 {
-   AutoLock(this);
-
    if ( SetSubClassInterface(iidReleaseRequestEvent, dynamic_cast<IReleaseRequestEvent *>(this)) != EObjOK ) {
       m_bIsOK = false;
       return;
@@ -805,9 +868,6 @@ CReleaseRequestEvent::CReleaseRequestEvent(IBase               *pObject,
    m_Reason(Reason),
    m_strDescription(Description)
 {
-   AutoLock(this);
-
-
    if ( SetInterface(iidReleaseRequestEvent, dynamic_cast<IReleaseRequestEvent *>(this)) != EObjOK ) {
       m_bIsOK = false;
       return;
@@ -823,19 +883,16 @@ CReleaseRequestEvent::CReleaseRequestEvent(IBase               *pObject,
 
 btID CReleaseRequestEvent::Timeout() const {
 
-   AutoLock(this);
    return m_Timeout;
 }
 
 IReleaseRequestEvent::ReleaseReason_e CReleaseRequestEvent::Reason() const {
 
-   AutoLock(this);
    return m_Reason;
 }
 
 btString CReleaseRequestEvent::Description() const {
 
-   AutoLock(this);
    return (btString)(char *)m_strDescription.c_str();
 }
 
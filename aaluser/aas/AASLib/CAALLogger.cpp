@@ -79,6 +79,9 @@
 
 #include "aalsdk/utils/Utilities.h"    // NUM_ELEMENTS()
 #include "aalsdk/OSAL.h"               // GetThreadID(), FindLowestBitSet64()
+#include "aalsdk/AALLogRecord.h"
+
+#include <cstring>
 
 
 BEGIN_NAMESPACE(AAL)
@@ -96,6 +99,128 @@ ILogger * ILoggerFactory()
 
 ILogger::~ILogger() {}
 
+// Ring memory ordering for the asynchronous logger.
+static inline void LogFullBarrier()
+{
+#if   defined( __AAL_WINDOWS__ )
+   ::MemoryBarrier();
+#elif defined( __AAL_LINUX__ )
+   __sync_synchronize();
+#endif // OS
+}
+
+//=============================================================================
+// Name:          CLogger::LogRing
+// Description:   Byte ring of aal_log_record's, written by one thread and read
+//                   by whichever thread holds the CLogger lock.
+// Comments:      m_Head and m_Tail count bytes and wrap naturally. A record
+//                   never wraps around the end of the ring: the producer pads
+//                   to the end first, with an AAL_LOG_REC_PAD record when there
+//                   is room for a header.
+//=============================================================================
+class CLogger::LogRing
+{
+public:
+   enum { Size = 256 * 1024 };
+
+   LogRing() :
+      m_Head(0),
+      m_Tail(0),
+      m_bOrphaned(false)
+   {}
+
+   btUnsignedInt Used() const { return (btUnsignedInt)(m_Head - m_Tail); }
+
+   // Producer. Returns false if there is no room.
+   btBool Put(const struct aal_log_record &rRec, const char *pPayload)
+   {
+      const btUnsignedInt need = (btUnsignedInt)AAL_LOG_REC_SIZE(rRec.len);
+      const btUnsignedInt head = m_Head;
+      const btUnsignedInt off  = head & (Size - 1);
+      const btUnsignedInt pad  = ( off + need > (btUnsignedInt)Size ) ? Size - off : 0;
+
+      if ( (btUnsignedInt)Size - (btUnsignedInt)(head - m_Tail) < pad + need ) {
+         return false;
+      }
+      // Don't write the space until the consumer is done reading it.
+      LogFullBarrier();
+
+      btByte *p = m_Buf + off;
+      if ( pad >= sizeof(struct aal_log_record) ) {
+         struct aal_log_record *pPad = reinterpret_cast<struct aal_log_record *>(p);
+         memset(pPad, 0, sizeof(struct aal_log_record));
+         pPad->type = AAL_LOG_REC_PAD;
+      }
+      if ( pad > 0 ) {
+         p = m_Buf;
+      }
+
+      memcpy(p, &rRec, sizeof(struct aal_log_record));
+      memcpy(p + sizeof(struct aal_log_record), pPayload, rRec.len);
+
+      LogFullBarrier();
+      m_Head = head + pad + need;
+      return true;
+   }
+
+   // Consumer. Returns the oldest record, or NULL if the ring is empty.
+   const struct aal_log_record * Peek()
+   {
+      for ( ; ; ) {
+         const btUnsignedInt tail = m_Tail;
+         if ( tail == m_Head ) {
+            return NULL;
+         }
+         LogFullBarrier();
+
+         const btUnsignedInt off = tail & (Size - 1);
+         const btUnsignedInt rem = Size - off;
+         if ( rem >= sizeof(struct aal_log_record) ) {
+            const struct aal_log_record *pRec = reinterpret_cast<const struct aal_log_record *>(m_Buf + off);
+            if ( AAL_LOG_REC_PAD != pRec->type ) {
+               return pRec;
+            }
+         }
+         // Padding to the end of the ring.
+         m_Tail = tail + rem;
+      }
+   }
+
+   void Pop(const struct aal_log_record *pRec)
+   {
+      const btUnsignedInt tail = m_Tail;
+      LogFullBarrier();
+      m_Tail = tail + (btUnsignedInt)AAL_LOG_REC_SIZE(pRec->len);
+   }
+
+   volatile btUnsignedInt m_Head;
+   volatile btUnsignedInt m_Tail;
+   volatile btBool        m_bOrphaned;   // The owning thread has exited.
+
+protected:
+   btByte                 m_Buf[Size];
+};
+
+//=============================================================================
+// Name:          CLogger::ThreadState
+// Description:   Per-thread logging state
+//=============================================================================
+struct CLogger::ThreadState
+{
+   ThreadState(CLogger *pLogger) :
+      m_pLogger(pLogger),
+      m_pRing(NULL)
+   {
+      m_szTemp[0] = 0;
+   }
+
+   CLogger                                 *m_pLogger;
+   std::ostringstream                       m_oss;
+   char                                     m_szTemp[TempStringLength];
+   LogRing                                 *m_pRing;     // Created on first asynchronous use.
+   std::map<btcString, btUnsignedInt>       m_FileIds;   // __FILE__ pointer to id, without locking.
+};
+
 //=============================================================================
 // Name:          ossRec::ossRec
 // Description:   Default Constructor
@@ -266,11 +391,16 @@ CLogger::CLogger() :
    m_bFlush(false),
    m_ofstream(),
    m_sPrepend(),
-   m_PIDossMap(),
    m_oss(),
 #ifdef __AAL_LINUX__
    m_tvZero(),
 #endif // __AAL_LINUX__
+   m_bAsync(false),
+   m_FilesWritten(0),
+   m_ConfigGen(0),
+   m_ConfigWritten(0),
+   m_pDrainThread(NULL),
+   m_bExitDrainThread(false),
    m_pFlushThread(NULL),
    m_bExitFlushThread(false),
    m_bFlushThreadIsExiting(false),
@@ -287,6 +417,15 @@ CLogger::CLogger() :
    for ( var = 0 ; var < m_numElementsInLogLevel ; ++var ) {
       m_rgLogLevel[var] = LOG_WARNING;
    }
+
+#if   defined( __AAL_WINDOWS__ )
+   // No destructor callback: a thread's state is released with the logger.
+   m_TLSIndex = TlsAlloc();
+#elif defined( __AAL_LINUX__ )
+   pthread_key_create(&m_TLSKey, CLogger::ReleaseThreadState);
+#endif // OS
+
+   m_drainEvent.Create(0, 1);
 //   memset(m_rgLogLevel, LOG_WARNING, sizeof(m_rgLogLevel));
 } // CLogger::CLogger
 
@@ -298,16 +437,43 @@ CLogger::CLogger() :
 //=============================================================================
 CLogger::~CLogger()
 {
+   m_bAsync = false;
+   StopDrainThread();
+
    AutoLock(this);
 
    StopFlushThread();
 
-   if ( FILE == m_eDest ) {
+#if   defined( __AAL_WINDOWS__ )
+   TlsFree(m_TLSIndex);
+#elif defined( __AAL_LINUX__ )
+   pthread_key_delete(m_TLSKey);
+#endif // OS
+
+   {
+      AutoLock(&m_RingLock);
+
+      std::list<ThreadState *>::iterator st;
+      for ( st = m_ThreadStates.begin() ; m_ThreadStates.end() != st ; ++st ) {
+         delete *st;
+      }
+      m_ThreadStates.clear();
+
+      std::list<LogRing *>::iterator r;
+      for ( r = m_Rings.begin() ; m_Rings.end() != r ; ++r ) {
+         delete *r;
+      }
+      m_Rings.clear();
+   }
+
+   if ( ( FILE == m_eDest ) || ( BINFILE == m_eDest ) ) {
       m_ofstream.flush();
       m_ofstream.close();
       m_sFile.clear();
    }
 
+   m_drainEvent.Destroy();
+
    if ( SYSLOG == m_eDest ) {
 #ifdef __AAL_LINUX__
       closelog();
@@ -342,13 +508,18 @@ btBool CLogger::IfLog(LogMask_t mask, int errlevel) const
 //=============================================================================
 std::ostringstream & CLogger::GetOss(int errLevel)
 {
-   AutoLock(this);                     // manipulating the map
-   std::ostringstream *poss = m_PIDossMap.GetOss((int)GetThreadID());
-   if ( NULL == poss ) {
+   ThreadState        *pState = GetThreadState();
+   std::ostringstream *poss;
+
+   if ( NULL != pState ) {
+      poss = &pState->m_oss;
+   } else {
       poss = &m_oss;                   // backup string if something goes wrong
    }
 
-   PreloadOss(poss, errLevel);         // Preload standard stuff into the stream
+   if ( !m_bAsync ) {
+      PreloadOss(poss, errLevel);      // Preload standard stuff into the stream
+   }                                   // Asynchronous records are decorated when written.
 
    return *poss;
 } // CLogger::GetOss
@@ -362,14 +533,70 @@ std::ostringstream & CLogger::GetOss(int errLevel)
 //=============================================================================
 char * CLogger::Getpsz()
 {
-   AutoLock(this);                     // manipulating the map
-   char *psz = m_PIDossMap.Getpsz((int)GetThreadID());
-   if ( NULL == psz ) {
-      psz = m_szTemp;                 // backup string if something goes wrong
+   ThreadState *pState = GetThreadState();
+   if ( NULL == pState ) {
+      return m_szTemp;                // backup string if something goes wrong
    }
-   return psz;
+   return pState->m_szTemp;
 } // CLogger::Getpsz
 
+//=============================================================================
+// Name:          CLogger::GetThreadState
+// Description:   Return the calling thread's state, creating it on first use
+// Comment:       Lock-free after the first call from each thread.
+//=============================================================================
+CLogger::ThreadState * CLogger::GetThreadState()
+{
+#if   defined( __AAL_WINDOWS__ )
+   ThreadState *pState = reinterpret_cast<ThreadState *>(TlsGetValue(m_TLSIndex));
+#elif defined( __AAL_LINUX__ )
+   ThreadState *pState = reinterpret_cast<ThreadState *>(pthread_getspecific(m_TLSKey));
+#endif // OS
+
+   if ( NULL != pState ) {
+      return pState;
+   }
+
+   pState = new(std::nothrow) ThreadState(this);
+   if ( NULL == pState ) {
+      return NULL;
+   }
+
+   {
+      AutoLock(&m_RingLock);
+      m_ThreadStates.push_back(pState);
+   }
+
+#if   defined( __AAL_WINDOWS__ )
+   TlsSetValue(m_TLSIndex, pState);
+#elif defined( __AAL_LINUX__ )
+   pthread_setspecific(m_TLSKey, pState);
+#endif // OS
+
+   return pState;
+} // CLogger::GetThreadState
+
+//=============================================================================
+// Name:          CLogger::ReleaseThreadState
+// Description:   Thread exit callback for the thread state key
+// Comment:       The thread's ring is left for the drain thread to empty and
+//                   free.
+//=============================================================================
+void CLogger::ReleaseThreadState(void *p)
+{
+   ThreadState *pState  = reinterpret_cast<ThreadState *>(p);
+   CLogger     *pLogger = pState->m_pLogger;
+
+   AutoLock(&pLogger->m_RingLock);
+
+   if ( NULL != pState->m_pRing ) {
+      pState->m_pRing->m_bOrphaned = true;
+   }
+
+   pLogger->m_ThreadStates.remove(pState);
+   delete pState;
+} // CLogger::ReleaseThreadState
+
 //=============================================================================
 // Name:          CLogger::GetErrorString
 // Description:   Return a char* for the client to write upon
@@ -387,11 +614,36 @@ char * CLogger::GetErrorString(int errNum)
 #endif // OS
 } // CLogger::GetErrorString
 
+//=============================================================================
+// Name:          CLogger::ElapsedUsec
+// Description:   Microseconds since the logger was constructed
+//=============================================================================
+btUnsigned64bitInt CLogger::ElapsedUsec() const
+{
+#ifdef __AAL_LINUX__
+   struct timeval tv;
+   gettimeofday(&tv, NULL);
+   return ( (btUnsigned64bitInt)(tv.tv_sec - m_tvZero.tv_sec) * 1000000 ) + tv.tv_usec - m_tvZero.tv_usec;
+#else
+   return 0;
+#endif // __AAL_LINUX__
+} // CLogger::ElapsedUsec
+
 //=============================================================================
 // Name:          CLogger::PreloadOss
-// Description:   Preload an ostringstream with decorations
+// Description:   Preload an ostringstream with decorations for the calling
+//                   thread and the current time
 //=============================================================================
 void CLogger::PreloadOss(std::ostringstream *poss, int errLevel)
+{
+   DecorateOss(poss, errLevel, (btUnsigned64bitInt)GetThreadID(), ElapsedUsec());
+} // CLogger::PreloadOss
+
+//=============================================================================
+// Name:          CLogger::DecorateOss
+// Description:   Preload an ostringstream with decorations
+//=============================================================================
+void CLogger::DecorateOss(std::ostringstream *poss, int errLevel, btUnsigned64bitInt tid, btUnsigned64bitInt usec)
 {
    // should not need to lock, called internally
 
@@ -505,25 +757,21 @@ void CLogger::PreloadOss(std::ostringstream *poss, int errLevel)
       poss->fill('0');
       poss->flags(PIDFlags);
       *poss << "[" << GetProcessID() << ":" << std::hex << std::setw(10)
-            << GetThreadID() << "] ";
+            << tid << "] ";
    }
 
    if (m_bTimeStamp) {
-      struct timeval tv;
-      gettimeofday( &tv, NULL);
       poss->fill('0');
       poss->flags(TSFlags);
-      *poss << std::setw(4) << (tv.tv_sec - m_tvZero.tv_sec) << ":"
-            << std::setw(6) << ((tv.tv_usec >= m_tvZero.tv_usec) ?
-                                                                (tv.tv_usec - m_tvZero.tv_usec) :
-                                                                (1000000 - m_tvZero.tv_usec + tv.tv_usec) ) << " ";
+      *poss << std::setw(4) << (usec / 1000000) << ":"
+            << std::setw(6) << (usec % 1000000) << " ";
    }
 #endif // __AAL_LINUX__
    // reset flag state
    poss->flags(defaultFlags);
    poss->fill(defaultFillChar);
 
-} // CLogger::PreloadOss
+} // CLogger::DecorateOss
 
 //=============================================================================
 // Name:          CLogger::Log(int errLevel, const char* psz)
@@ -532,6 +780,11 @@ void CLogger::PreloadOss(std::ostringstream *poss, int errLevel)
 //=============================================================================
 void CLogger::Log(int errLevel, const char* psz)
 {
+   if ( m_bAsync ) {
+      Push(errLevel, 0, NULL, 0, psz, strlen(psz));
+      return;
+   }
+
    AutoLock(this);
 
    std::ostringstream oss;
@@ -549,12 +802,56 @@ void CLogger::Log(int errLevel, const char* psz)
 //=============================================================================
 void CLogger::Log(int errLevel, std::ostringstream& ross)
 {
+   if ( m_bAsync ) {
+      const std::string str = ross.str();
+      Push(errLevel, 0, NULL, 0, str.c_str(), str.length());
+      ross.str("");
+      return;
+   }
+
    AutoLock(this);
 
+   Write(errLevel, ross.str());
+
+   ross.str("");
+} // CLogger::Log (int errlevel, std::ostringstream& oss)
+
+void CLogger::Log(int errlevel, std::basic_ostream<char, std::char_traits<char> > &rbos)
+{
+   Log(errlevel, static_cast<std::ostringstream &>(rbos));
+}
+
+//=============================================================================
+// Name:          CLogger::Log (int errlevel, LogMask_t mask, ...)
+// Description:   Log from an AAL_LOG() statement
+// Comment:       The mask and source location go into asynchronous records.
+//=============================================================================
+void CLogger::Log(int errlevel, LogMask_t mask, btcString file, btInt line,
+                  std::basic_ostream<char, std::char_traits<char> > &rbos)
+{
+   std::ostringstream &ross = static_cast<std::ostringstream &>(rbos);
+
+   if ( m_bAsync ) {
+      const std::string str = ross.str();
+      Push(errlevel, mask, file, line, str.c_str(), str.length());
+      ross.str("");
+      return;
+   }
+
+   Log(errlevel, ross);
+}
+
+//=============================================================================
+// Name:          CLogger::Write
+// Description:   Write a formatted message to the destination
+// Comment:       Callers hold the lock.
+//=============================================================================
+void CLogger::Write(int errLevel, const std::string &str)
+{
    switch ( m_eDest ) {
 
       case FILE : {
-         m_ofstream << ross.str();
+         m_ofstream << str;
          //if ( m_bFlush || (errLevel <= LOG_ERR) )
          if ( m_bFlush ) {
             m_ofstream.flush();
@@ -564,11 +861,11 @@ void CLogger::Log(int errLevel, std::ostringstream& ross)
       } break;
 
       case CERR : {
-         std::cerr << ross.str();
+         std::cerr << str;
       } break;
 
       case COUT : {
-         std::cout << ross.str();
+         std::cout << str;
          if ( m_bFlush || (errLevel <= LOG_ERR) ) {
             std::cout.flush();
          }
@@ -576,19 +873,328 @@ void CLogger::Log(int errLevel, std::ostringstream& ross)
 
       case SYSLOG : {
 #ifdef __AAL_LINUX__
-         syslog( std::min( errLevel, LOG_DEBUG), "%s", ross.str().c_str());
+         syslog( std::min( errLevel, LOG_DEBUG), "%s", str.c_str());
 #endif // __AAL_LINUX__
       } break;
+
+      case BINFILE : // Only written by Drain().
+      default      : break;
    }
+} // CLogger::Write
 
-   ross.str("");
-} // CLogger::Log (int errlevel, std::ostringstream& oss)
+//=============================================================================
+// Name:          CLogger::FileId
+// Description:   Map a source file name to its record id
+// Comment:       Each thread caches the id of every __FILE__ pointer it has
+//                   seen, so the shared table is locked once per file per
+//                   thread.
+//=============================================================================
+btUnsigned32bitInt CLogger::FileId(ThreadState *pState, btcString file)
+{
+   if ( NULL == file ) {
+      return 0;
+   }
 
-void CLogger::Log(int errlevel, std::basic_ostream<char, std::char_traits<char> > &rbos)
+   std::map<btcString, btUnsignedInt>::const_iterator iter = pState->m_FileIds.find(file);
+   if ( pState->m_FileIds.end() != iter ) {
+      return iter->second;
+   }
+
+   btUnsigned32bitInt id;
+   {
+      AutoLock(&m_RingLock);
+
+      std::map<std::string, btUnsigned32bitInt>::const_iterator fiter = m_FileIds.find(file);
+      if ( m_FileIds.end() != fiter ) {
+         id = fiter->second;
+      } else {
+         m_FileNames.push_back(file);
+         id = (btUnsigned32bitInt)m_FileNames.size();
+         m_FileIds[file] = id;
+      }
+   }
+
+   pState->m_FileIds[file] = id;
+   return id;
+} // CLogger::FileId
+
+//=============================================================================
+// Name:          CLogger::Push
+// Description:   Copy a message into the calling thread's ring
+// Comment:       Takes no lock unless the ring is full, in which case the
+//                   caller drains every ring itself.
+//=============================================================================
+void CLogger::Push(int errLevel, LogMask_t mask, btcString file, btInt line, const char *psz, size_t len)
 {
-   Log(errlevel, static_cast<std::ostringstream &>(rbos));
+   ThreadState *pState = GetThreadState();
+   if ( NULL == pState ) {
+      return;
+   }
+
+   if ( NULL == pState->m_pRing ) {
+      LogRing *pRing = new(std::nothrow) LogRing();
+      if ( NULL == pRing ) {
+         return;
+      }
+      AutoLock(&m_RingLock);
+      m_Rings.push_back(pRing);
+      pState->m_pRing = pRing;
+   }
+
+   LogRing *pRing = pState->m_pRing;
+
+   struct aal_log_record rec;
+   rec.type    = AAL_LOG_REC_MESSAGE;
+   rec.len     = (btUnsigned16bitInt)std::min(len, (size_t)AAL_LOG_MAX_TEXT);
+   rec.level   = (btUnsigned16bitInt)errLevel;
+   rec.maskbit = (0 == mask) ? 0 : (btUnsigned16bitInt)FindLowestBitSet64(mask);
+   rec.fileid  = FileId(pState, file);
+   rec.line    = (btUnsigned32bitInt)line;
+   rec.tid     = (btUnsigned64bitInt)GetThreadID();
+   rec.usec    = ElapsedUsec();
+
+   const btUnsignedInt before = pRing->Used();
+
+   while ( !pRing->Put(rec, psz) ) {
+      Drain();
+   }
+
+   // Wake the drain thread for errors, when flushing every message, and once as the ring passes half full.
+   if ( ( errLevel <= LOG_ERR ) || m_bFlush ||
+        ( ( before < LogRing::Size / 2 ) && ( pRing->Used() >= LogRing::Size / 2 ) ) ) {
+      m_drainEvent.Post(1);
+   }
+} // CLogger::Push
+
+//=============================================================================
+// Name:          CLogger::Drain
+// Description:   Write the records in every ring to the destination
+// Comment:       Merges the rings by timestamp. A pass is bounded so that busy
+//                   producers cannot keep it running forever.
+//=============================================================================
+void CLogger::Drain()
+{
+   AutoLock(this);
+
+   std::vector<LogRing *> rings;
+   {
+      AutoLock(&m_RingLock);
+      rings.assign(m_Rings.begin(), m_Rings.end());
+   }
+
+   btUnsignedInt n;
+   for ( n = 0 ; n < 65536 ; ++n ) {
+      LogRing                     *pOldest = NULL;
+      const struct aal_log_record *pRec    = NULL;
+
+      std::vector<LogRing *>::iterator iter;
+      for ( iter = rings.begin() ; rings.end() != iter ; ++iter ) {
+         const struct aal_log_record *p = (*iter)->Peek();
+         if ( ( NULL != p ) && ( ( NULL == pRec ) || ( p->usec < pRec->usec ) ) ) {
+            pOldest = *iter;
+            pRec    = p;
+         }
+      }
+
+      if ( NULL == pRec ) {
+         break;
+      }
+
+      WriteRecord(pRec);
+      pOldest->Pop(pRec);
+   }
+
+   if ( n > 0 ) {
+      if ( ( FILE == m_eDest ) || ( BINFILE == m_eDest ) ) {
+         m_ofstream.flush();
+      } else if ( COUT == m_eDest ) {
+         std::cout.flush();
+      }
+   }
+
+   // Free the rings of exited threads once they are empty.
+   {
+      AutoLock(&m_RingLock);
+      std::list<LogRing *>::iterator r = m_Rings.begin();
+      while ( m_Rings.end() != r ) {
+         if ( (*r)->m_bOrphaned && ( 0 == (*r)->Used() ) ) {
+            delete *r;
+            r = m_Rings.erase(r);
+         } else {
+            ++r;
+         }
+      }
+   }
+} // CLogger::Drain
+
+//=============================================================================
+// Name:          CLogger::WriteRecord
+// Description:   Write one asynchronous record to the destination
+// Comment:       Text destinations get the same decorations as synchronous
+//                   logging. BINFILE gets the record itself, preceded by any
+//                   file id and decoration settings it has not seen yet.
+//=============================================================================
+void CLogger::WriteRecord(const struct aal_log_record *pRec)
+{
+   const char *pText = reinterpret_cast<const char *>(pRec + 1);
+
+   if ( BINFILE != m_eDest ) {
+      m_DrainOss.str("");
+      DecorateOss(&m_DrainOss, pRec->level, pRec->tid, pRec->usec);
+      m_DrainOss.write(pText, pRec->len);
+      Write(pRec->level, m_DrainOss.str());
+      return;
+   }
+
+   static const char zeros[AAL_LOG_REC_ALIGN] = { 0 };
+   struct aal_log_record hdr;
+
+   if ( m_ConfigWritten != m_ConfigGen ) {
+      memset(&hdr, 0, sizeof(hdr));
+      hdr.type  = AAL_LOG_REC_CONFIG;
+      hdr.len   = (btUnsigned16bitInt)std::min(m_sPrepend.length(), (size_t)AAL_LOG_MAX_TEXT);
+      hdr.level = ( m_bLogPID     ? AAL_LOG_CFG_PID       : 0 ) |
+                  ( m_bTimeStamp  ? AAL_LOG_CFG_TIMESTAMP : 0 ) |
+                  ( m_bErrorLevel ? AAL_LOG_CFG_LEVEL     : 0 );
+      hdr.usec  = pRec->usec;
+      m_ofstream.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+      m_ofstream.write(m_sPrepend.c_str(), hdr.len);
+      m_ofstream.write(zeros, AAL_LOG_REC_SIZE(hdr.len) - sizeof(hdr) - hdr.len);
+      m_ConfigWritten = m_ConfigGen;
+   }
+
+   while ( pRec->fileid > m_FilesWritten ) {
+      std::string name;
+      {
+         AutoLock(&m_RingLock);
+         name = m_FileNames[m_FilesWritten];
+      }
+      ++m_FilesWritten;
+
+      memset(&hdr, 0, sizeof(hdr));
+      hdr.type   = AAL_LOG_REC_FILE;
+      hdr.len    = (btUnsigned16bitInt)std::min(name.length(), (size_t)AAL_LOG_MAX_TEXT);
+      hdr.fileid = m_FilesWritten;
+      m_ofstream.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+      m_ofstream.write(name.c_str(), hdr.len);
+      m_ofstream.write(zeros, AAL_LOG_REC_SIZE(hdr.len) - sizeof(hdr) - hdr.len);
+   }
+
+   m_ofstream.write(reinterpret_cast<const char *>(pRec), AAL_LOG_REC_SIZE(pRec->len));
+} // CLogger::WriteRecord
+
+//=============================================================================
+// Name:          CLogger::StartDrainThread
+// Description:   Start the thread that writes asynchronous records
+//=============================================================================
+void CLogger::StartDrainThread()
+{
+   AutoLock(this);
+   if ( NULL != m_pDrainThread ) {
+      return;
+   }
+
+   m_bExitDrainThread = false;
+
+   m_pDrainThread = new(std::nothrow) OSLThread(CLogger::DrainThread, OSLThread::THREADPRIORITY_NORMAL, this);
+   if ( ( NULL == m_pDrainThread ) || !m_pDrainThread->IsOK() ) {
+      std::cerr << __AAL_FUNC__ <<
+               "(): create drain thread failed. Using synchronous logging." << std::endl;
+      delete m_pDrainThread;
+      m_pDrainThread = NULL;
+      m_bAsync       = false;
+   }
+} // CLogger::StartDrainThread
+
+//=============================================================================
+// Name:          CLogger::StopDrainThread
+// Description:   Stop the drain thread and write whatever it left behind
+// Comment:       Must not be called with the lock held, as the drain thread
+//                   takes it.
+//=============================================================================
+void CLogger::StopDrainThread()
+{
+   OSLThread *pThread;
+   {
+      AutoLock(this);
+      pThread            = m_pDrainThread;
+      m_pDrainThread     = NULL;
+      m_bExitDrainThread = true;
+   }
+
+   if ( NULL != pThread ) {
+      m_drainEvent.Post(1);
+      pThread->Join();
+      delete pThread;
+   }
+
+   Drain();
+} // CLogger::StopDrainThread
+
+//=============================================================================
+// Name:          CLogger::DrainThread
+// Description:   Drain thread body
+// Comment:       Wakes when a ring passes half full or an error is logged, and
+//                   otherwise every few milliseconds.
+//=============================================================================
+void CLogger::DrainThread(OSLThread *pThread, void *pContext)
+{
+   CLogger *This = static_cast<CLogger *>(pContext);
+
+   ASSERT(NULL != This);
+   if (NULL == This) return;
+
+   while ( !This->m_bExitDrainThread ) {
+      This->m_drainEvent.Wait(10);
+      This->Drain();
+   }
+}
+
+//=============================================================================
+// Name:          CLogger::SetAsync
+// Description:   Mutator: Set whether messages are written by the drain thread
+// Comment:       Turning asynchronous mode off writes every pending message
+//                   before returning.
+//=============================================================================
+void CLogger::SetAsync(btBool fAsync)
+{
+   if ( fAsync ) {
+      m_bAsync = true;
+      LogFullBarrier();
+      StartDrainThread();
+   } else {
+      m_bAsync = false;
+      LogFullBarrier();
+      StopDrainThread();
+   }
+} // CLogger::SetAsync
+
+//=============================================================================
+// Name:          CLogger::GetAsync
+// Description:   Accessor
+//=============================================================================
+btBool CLogger::GetAsync() const
+{
+   return m_bAsync;
 }
 
+//=============================================================================
+// Name:          CLogger::Flush
+// Description:   Write every message logged so far
+//=============================================================================
+void CLogger::Flush()
+{
+   AutoLock(this);
+
+   Drain();
+
+   if ( ( FILE == m_eDest ) || ( BINFILE == m_eDest ) ) {
+      m_ofstream.flush();
+   } else if ( COUT == m_eDest ) {
+      std::cout.flush();
+   }
+} // CLogger::Flush
+
 //=============================================================================
 // Name:          CLogger::SetDestination
 // Description:   Mutator: Set destination type and filename
@@ -597,6 +1203,10 @@ void CLogger::Log(int errlevel, std::basic_ostream<char, std::char_traits<char>
 void CLogger::SetDestination(eLogTo eDest, std::string sFile)
 {
    AutoLock(this);
+
+   // Pending records belong to the old destination.
+   Drain();
+
 #ifdef __AAL_LINUX__
    // if currently in syslog, close it
    if ( SYSLOG == m_eDest ) {
@@ -607,6 +1217,8 @@ void CLogger::SetDestination(eLogTo eDest, std::string sFile)
    if ( FILE == m_eDest ) {
       StopFlushThread();
       m_ofstream.close();
+   } else if ( BINFILE == m_eDest ) {
+      m_ofstream.close();
    }
 
    // clear the earlier filename, if any
@@ -653,6 +1265,40 @@ void CLogger::SetDestination(eLogTo eDest, std::string sFile)
 
       } break;
 
+      case BINFILE : {
+
+         m_ofstream.open(sFile.c_str(), std::ios_base::app | std::ios_base::out | std::ios_base::binary);
+
+         if ( m_ofstream.good() ) {
+            m_sFile = sFile;
+
+            struct aal_log_file_header hdr;
+            memset(&hdr, 0, sizeof(hdr));
+            hdr.magic      = AAL_LOG_FILE_MAGIC;
+            hdr.version    = AAL_LOG_FILE_VERSION;
+            hdr.pid        = (btUnsigned64bitInt)GetProcessID();
+#ifdef __AAL_LINUX__
+            hdr.start_sec  = (btUnsigned64bitInt)m_tvZero.tv_sec;
+            hdr.start_usec = (btUnsigned64bitInt)m_tvZero.tv_usec;
+#endif // __AAL_LINUX__
+            m_ofstream.write(reinterpret_cast<const char *>(&hdr), sizeof(hdr));
+
+            // File ids and decorations are defined again in each new file.
+            m_FilesWritten  = 0;
+            m_ConfigWritten = m_ConfigGen - 1;
+
+            // Records are only ever written by the drain thread.
+            m_bAsync = true;
+            StartDrainThread();
+
+         } else {
+            std::cerr << "CLogger::SetDestination could not open " << sFile
+                      << "using cerr instead\n";
+            m_eDest = CERR;
+         }
+
+      } break;
+
    }  // switch
 
    if ( IfLog(m_LogMask, LOG_INFO) ) {
@@ -759,7 +1405,9 @@ int CLogger::GetLevel(LogMask_t mask) const
 void CLogger::SetLogPID(btBool fLogPID)
 {
    AutoLock(this);
+   Drain();                   // Queued messages keep the old decorations.
    m_bLogPID = fLogPID;
+   ++m_ConfigGen;
 } // CLogger::SetLogPID
 
 //=============================================================================
@@ -779,7 +1427,9 @@ btBool CLogger::GetLogPID() const
 void CLogger::SetLogTimeStamp(btBool fLogTimeStamp)
 {
    AutoLock(this);
+   Drain();                   // Queued messages keep the old decorations.
    m_bTimeStamp = fLogTimeStamp;
+   ++m_ConfigGen;
 } // CLogger::SetLogTimeStamp
 
 //=============================================================================
@@ -799,7 +1449,9 @@ btBool CLogger::GetLogTimeStamp() const
 void CLogger::SetLogPrepend (std::string sPrepend)
 {
    AutoLock(this);
+   Drain();                   // Queued messages keep the old decorations.
    m_sPrepend = sPrepend;
+   ++m_ConfigGen;
    //m_bPrepend = !sPrepend.empty();
 }
 
@@ -820,7 +1472,9 @@ std::string CLogger::GetLogPrepend() const
 void CLogger::SetLogErrorLevelPrepend(btBool errLevel)
 {
    AutoLock(this);
+   Drain();                   // Queued messages keep the old decorations.
    m_bErrorLevel = errLevel;
+   ++m_ConfigGen;
 }
 
 //=============================================================================
@@ -105,6 +105,9 @@
 #define NVSFileIO          /* for the time being, leave it in */
 #include "aalsdk/INamedValueSet.h"
 
+#include <set>
+#include <vector>
+
 
 #define MAX_VALID_NVS_ARRAY_ENTRIES (1024 * 1024)
 
@@ -322,6 +325,28 @@ CValue & CValue::operator = (const CValue &rOther)
    return *this;
 }
 
+//=============================================================================
+// Name: Swap
+// Description: Exchanges the contents of two CValue's.
+// Comments: Ownership of any allocated array, string or NVS moves with the
+//           value, so nothing is copied. Used by the NVS containers to
+//           relocate entries.
+//=============================================================================
+void CValue::Swap(CValue &rOther)
+{
+   btUnsigned32bitInt Size = m_Size;
+   eBasicTypes        Type = m_Type;
+   Val_t              Val  = m_Val;
+
+   m_Size = rOther.m_Size;
+   m_Type = rOther.m_Type;
+   m_Val  = rOther.m_Val;
+
+   rOther.m_Size = Size;
+   rOther.m_Type = Type;
+   rOther.m_Val  = Val;
+}
+
 void CValue::Put(btBool val)             { m_Type = btBool_t;             m_Val._1b   = val; m_Size = 1; }
 void CValue::Put(btByte val)             { m_Type = btByte_t;             m_Val._8b   = val; m_Size = 1; }
 void CValue::Put(bt32bitInt val)         { m_Type = bt32bitInt_t;         m_Val._32b  = val; m_Size = 1; }
@@ -610,12 +635,408 @@ ENamedValues CValue::Get(btObjectArray *pval) const
 /*@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@*/
 /*@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@*/
 
+//=============================================================================
+// Name: NVSKeyPool
+// Description: Process-wide pool of interned string keys.
+// Comments: Each distinct string key is stored once, and every TNamedValueSet
+//           that holds it refers to the same btStringKey. Copying an entry
+//           then copies a pointer rather than a string. Each key is counted:
+//           the pool lends a reference per entry that holds it, and the key
+//           leaves the pool with the last such entry, so keys that arrive in
+//           messages do not accumulate. The pool is split into shards by
+//           key hash, each with its own lock; Retain() takes no lock at all.
+//           The pool is never destroyed, so NVS's may be used from static
+//           destructors.
+//=============================================================================
+class NVSKeyPool
+{
+public:
+   // Returns the pooled copy of Name, holding one reference on it.
+   static btStringKey Intern(btStringKey Name)
+   {
+      const btUnsignedInt Index  = Hash(Name) % NumShards;
+      Shard              &rShard = Instance().m_Shards[Index];
+
+      AutoLock(&rShard);
+
+      KeySet::iterator iter = rShard.m_Keys.find(Name);
+      if ( rShard.m_Keys.end() != iter ) {
+         AtomicAdd(&HeaderOf(*iter)->m_Refs, 1);
+         return *iter;
+      }
+
+      const size_t len    = strlen(Name);
+      char        *pBlock = new char[sizeof(Header) + len + 1];
+      Header      *pHdr   = reinterpret_cast<Header *>(pBlock);
+
+      pHdr->m_Refs  = 1;
+      pHdr->m_Shard = Index;
+      memcpy(pBlock + sizeof(Header), Name, len + 1);
+
+      return *rShard.m_Keys.insert(pBlock + sizeof(Header)).first;
+   }
+
+   // Takes another reference on a key returned by Intern().
+   static btStringKey Retain(btStringKey Key)
+   {
+      AtomicAdd(&HeaderOf(Key)->m_Refs, 1);
+      return Key;
+   }
+
+   // Drops a reference on a key returned by Intern(). The last one frees it.
+   static void Release(btStringKey Key)
+   {
+      Header *pHdr   = HeaderOf(Key);
+      Shard  &rShard = Instance().m_Shards[pHdr->m_Shard];
+
+      AutoLock(&rShard);
+
+      if ( 0 == AtomicAdd(&pHdr->m_Refs, -1) ) {
+         rShard.m_Keys.erase(Key);
+         delete[] reinterpret_cast<char *>(pHdr);
+      }
+   }
+
+private:
+   enum { NumShards = 16 };
+
+   // Precedes the characters of each pooled key.
+   struct Header
+   {
+      volatile btInt m_Refs;
+      btUnsignedInt  m_Shard;
+   };
+
+   struct KeyLess
+   {
+      bool operator() (btStringKey a, btStringKey b) const { return strcmp(a, b) < 0; }
+   };
+
+   typedef std::set<btStringKey, KeyLess> KeySet;
+
+   class Shard : public CriticalSection
+   {
+   public:
+      KeySet m_Keys;
+   };
+
+   static NVSKeyPool & Instance()
+   {
+      static NVSKeyPool *pPool = new(std::nothrow) NVSKeyPool();
+      ASSERT(NULL != pPool);
+      return *pPool;
+   }
+
+   static Header * HeaderOf(btStringKey Key)
+   {
+      return reinterpret_cast<Header *>(const_cast<char *>(Key) - sizeof(Header));
+   }
+
+   // FNV-1a.
+   static btUnsignedInt Hash(btStringKey Name)
+   {
+      btUnsigned32bitInt h = 2166136261U;
+      while ( '\0' != *Name ) {
+         h = (h ^ static_cast<unsigned char>(*Name++)) * 16777619U;
+      }
+      return h;
+   }
+
+   // Returns the new value.
+   static btInt AtomicAdd(volatile btInt *p, btInt n)
+   {
+#if   defined( __AAL_WINDOWS__ )
+      return (btInt)InterlockedExchangeAdd((volatile LONG *)p, (LONG)n) + n;
+#elif defined( __AAL_LINUX__ )
+      return __sync_add_and_fetch(p, n);
+#endif // OS
+   }
+
+   Shard m_Shards[NumShards];
+};
+
+//=============================================================================
+// Name: NVSKeyTraits
+// Description: Ordering and storage of the key types of TNamedValueSet.
+// Comments: String keys compare by content, in the same order std::string
+//           uses, so serialized NVS's keep their ordering. Only keys that
+//           are stored are interned; lookups compare in place. Each stored
+//           string key holds a reference in NVSKeyPool, dropped by Release().
+//=============================================================================
+template<typename Kt>
+struct NVSKeyTraits
+{
+   static btBool      Less(Kt a, Kt b) { return a < b; }
+   static Kt         Store(Kt Name)    { return Name;  }
+   static Kt        Retain(Kt Name)    { return Name;  }
+   static void     Release(Kt )        {}
+};
+
+template<>
+struct NVSKeyTraits<btStringKey>
+{
+   static btBool      Less(btStringKey a, btStringKey b) { return (a != b) && (strcmp(a, b) < 0); }
+   static btStringKey Store(btStringKey Name)            { return NVSKeyPool::Intern(Name);      }
+   static btStringKey Retain(btStringKey Key)            { return NVSKeyPool::Retain(Key);       }
+   static void      Release(btStringKey Key)             { NVSKeyPool::Release(Key);             }
+};
+
+//=============================================================================
+// Name: TNVSFlatMap
+// Description: Sorted, contiguous map from key to CValue.
+// Comments: Replaces std::map in TNamedValueSet. Entries live in a single
+//           array ordered by key: lookup is a binary search, access by index
+//           is O(1), and insert / erase relocate entries with CValue::Swap(),
+//           so no value is deep-copied and no per-entry node is allocated.
+//           Provides the subset of the std::map interface that
+//           TNamedValueSet uses.
+//=============================================================================
+template<typename Kt>
+class TNVSFlatMap
+{
+public:
+   struct value_type
+   {
+      value_type() : first(), second() {}
+      Kt     first;
+      CValue second;
+   };
+
+   typedef value_type       * iterator;
+   typedef value_type const * const_iterator;
+   typedef size_t             size_type;
+
+   TNVSFlatMap() :
+      m_pEntries(NULL),
+      m_Size(0),
+      m_Capacity(0)
+   {}
+
+   TNVSFlatMap(const TNVSFlatMap &rOther) :
+      m_pEntries(NULL),
+      m_Size(0),
+      m_Capacity(0)
+   {
+      *this = rOther;
+   }
+
+   ~TNVSFlatMap()
+   {
+      clear();
+      delete[] m_pEntries;
+   }
+
+   TNVSFlatMap & operator = (const TNVSFlatMap &rOther)
+   {
+      if ( &rOther == this ) {
+         return *this;
+      }
+
+      clear();
+      reserve(rOther.m_Size);
+
+      size_type i;
+      for ( i = 0 ; i < rOther.m_Size ; ++i ) {
+         m_pEntries[i].first  = NVSKeyTraits<Kt>::Retain(rOther.m_pEntries[i].first);
+         m_pEntries[i].second = rOther.m_pEntries[i].second;
+      }
+      m_Size = rOther.m_Size;
+
+      return *this;
+   }
+
+   iterator             begin()       { return m_pEntries;          }
+   const_iterator       begin() const { return m_pEntries;          }
+   iterator               end()       { return m_pEntries + m_Size; }
+   const_iterator         end() const { return m_pEntries + m_Size; }
+   size_type             size() const { return m_Size;              }
+
+   iterator find(Kt Name)
+   {
+      size_type pos = lower_bound(Name);
+      return Found(pos, Name) ? m_pEntries + pos : end();
+   }
+
+   const_iterator find(Kt Name) const
+   {
+      size_type pos = lower_bound(Name);
+      return Found(pos, Name) ? m_pEntries + pos : end();
+   }
+
+   // Find or insert.
+   CValue & operator [] (Kt Name)
+   {
+      size_type pos = lower_bound(Name);
+      if ( Found(pos, Name) ) {
+         return m_pEntries[pos].second;
+      }
+      return insert_at(pos, NVSKeyTraits<Kt>::Store(Name)).second;
+   }
+
+   void erase(Kt Name)
+   {
+      size_type pos = lower_bound(Name);
+      if ( !Found(pos, Name) ) {
+         return;
+      }
+
+      const Kt Erased = m_pEntries[pos].first;
+
+      // Shift the following entries down; the erased value ends up last.
+      for ( ; pos + 1 < m_Size ; ++pos ) {
+         m_pEntries[pos].first = m_pEntries[pos + 1].first;
+         m_pEntries[pos].second.Swap(m_pEntries[pos + 1].second);
+      }
+      --m_Size;
+      Reset(m_pEntries[m_Size]);
+      NVSKeyTraits<Kt>::Release(Erased);
+   }
+
+   // Frees the values but keeps the storage for reuse.
+   void clear()
+   {
+      while ( m_Size > 0 ) {
+         --m_Size;
+         NVSKeyTraits<Kt>::Release(m_pEntries[m_Size].first);
+         Reset(m_pEntries[m_Size]);
+      }
+   }
+
+   void reserve(size_type Count)
+   {
+      if ( Count <= m_Capacity ) {
+         return;
+      }
+
+      value_type *pEntries = new value_type[Count];
+      size_type   i;
+      for ( i = 0 ; i < m_Size ; ++i ) {
+         pEntries[i].first = m_pEntries[i].first;
+         pEntries[i].second.Swap(m_pEntries[i].second);
+      }
+
+      delete[] m_pEntries;
+      m_pEntries = pEntries;
+      m_Capacity = Count;
+   }
+
+   // Moves in rValue under Name, unless Name is already present.
+   btBool adopt(Kt Name, CValue &rValue)
+   {
+      size_type pos = lower_bound(Name);
+      if ( Found(pos, Name) ) {
+         return false;
+      }
+      insert_at(pos, NVSKeyTraits<Kt>::Store(Name)).second.Swap(rValue);
+      return true;
+   }
+
+   // Adds a copy of each of rOther's entries whose key is not already present.
+   // Both maps are sorted, so this is a single linear pass.
+   void merge(const TNVSFlatMap &rOther)
+   {
+      if ( ( &rOther == this ) || ( 0 == rOther.m_Size ) ) {
+         return;
+      }
+
+      const size_type Count    = m_Size + rOther.m_Size;
+      value_type     *pEntries = new value_type[Count];
+      size_type       i = 0;
+      size_type       j = 0;
+      size_type       k = 0;
+
+      while ( ( i < m_Size ) || ( j < rOther.m_Size ) ) {
+         if ( ( j >= rOther.m_Size ) ||
+              ( ( i < m_Size ) && !NVSKeyTraits<Kt>::Less(rOther.m_pEntries[j].first, m_pEntries[i].first) ) ) {
+            // Ours comes first, or both have the key: ours takes precedence.
+            if ( ( j < rOther.m_Size ) && !NVSKeyTraits<Kt>::Less(m_pEntries[i].first, rOther.m_pEntries[j].first) ) {
+               ++j;
+            }
+            pEntries[k].first = m_pEntries[i].first;
+            pEntries[k].second.Swap(m_pEntries[i].second);
+            ++i;
+         } else {
+            pEntries[k].first  = NVSKeyTraits<Kt>::Retain(rOther.m_pEntries[j].first);
+            pEntries[k].second = rOther.m_pEntries[j].second;
+            ++j;
+         }
+         ++k;
+      }
+
+      delete[] m_pEntries;
+      m_pEntries = pEntries;
+      m_Size     = k;
+      m_Capacity = Count;
+   }
+
+private:
+   size_type lower_bound(Kt Name) const
+   {
+      size_type lo = 0;
+      size_type hi = m_Size;
+      while ( lo < hi ) {
+         size_type mid = lo + (hi - lo) / 2;
+         if ( NVSKeyTraits<Kt>::Less(m_pEntries[mid].first, Name) ) {
+            lo = mid + 1;
+         } else {
+            hi = mid;
+         }
+      }
+      return lo;
+   }
+
+   btBool Found(size_type pos, Kt Name) const
+   {
+      return ( pos < m_Size ) && !NVSKeyTraits<Kt>::Less(Name, m_pEntries[pos].first);
+   }
+
+   value_type & insert_at(size_type pos, Kt Name)
+   {
+      if ( m_Size == m_Capacity ) {
+         reserve(( 0 == m_Capacity ) ? 8 : 2 * m_Capacity);
+      }
+
+      // Shift the following entries up; the empty value at m_Size ends up at pos.
+      size_type i;
+      for ( i = m_Size ; i > pos ; --i ) {
+         m_pEntries[i].first = m_pEntries[i - 1].first;
+         m_pEntries[i].second.Swap(m_pEntries[i - 1].second);
+      }
+      m_pEntries[pos].first = Name;
+      ++m_Size;
+
+      return m_pEntries[pos];
+   }
+
+   static void Reset(value_type &rEntry)
+   {
+      CValue Empty;
+      rEntry.second.Swap(Empty);
+      rEntry.first = Kt();
+   }
+
+   value_type *m_pEntries;
+   size_type   m_Size;
+   size_type   m_Capacity;
+};
+
+// Binary serialization of keys and values, used by TNamedValueSet::WriteBinary()
+// and TNamedValueSet::ReadBinary(). See CNamedValueSet::WriteBinary() for the format.
+static void         NVSBinaryPut(std::string & , btUnsigned32bitInt );
+static void         NVSBinaryPut(std::string & , btNumberKey );
+static void         NVSBinaryPut(std::string & , btStringKey );
+static void         NVSBinaryPut(std::string & , const CValue & );
+static btBool       NVSBinaryGet(const char *& , const char * , btUnsigned32bitInt * );
+static btBool       NVSBinaryGet(const char *& , const char * , btNumberKey * );
+static btBool       NVSBinaryGet(const char *& , const char * , btStringKey * );
+static ENamedValues NVSBinaryGet(const char *& , const char * , CValue & , btUnsignedInt );
+
 //=============================================================================
 //=============================================================================
 //   This template is used to construct a NVS class specific to a particular
 //   key data type. It is used in the CNamevValueSet  container class to hold
 //   an NVS instance that is specific to a particular key type.
-//   Namely std::string and and btUnsignedInt.  We could have defined a class
+//   Namely btStringKey and btNumberKey.  We could have defined a class
 //   for each type but this allows us to easily create new NVS for any key
 //   type.
 //=============================================================================
@@ -629,8 +1050,8 @@ template<typename Kt>
 class TNamedValueSet
 {
 private:
-   typedef typename std::map<Kt, AAL::CValue> map_type;
-   typedef typename map_type::const_iterator  const_iterator;
+   typedef TNVSFlatMap<Kt>                   map_type;
+   typedef typename map_type::const_iterator const_iterator;
 
    map_type m_NVSet;
 
@@ -1506,25 +1927,11 @@ public:
    // Interface: public
    // Inputs: none.
    // Outputs: none.
-   // Comments: Iterate through list and free all named value sets.
+   // Comments: Frees all of the values.
    //=============================================================================
    ENamedValues Empty()
    {
-      btUnsignedInt NumNames;
-      Kt            CurrName;
-
-      GetNumNames(&NumNames);
-
-      while ( NumNames-- ) {
-         GetName(NumNames, &CurrName);
-         //Remove it
-         ENamedValues result;
-         result = Delete(CurrName);
-         if ( result != ENamedValuesOK ) {
-            return result;
-         }
-      }
-
+      m_NVSet.clear();
       return ENamedValuesOK;
    }
 
@@ -1603,44 +2010,13 @@ public:
    //=============================================================================
    ENamedValues     GetName(btUnsignedInt index, Kt *pName) const
    {
-      const_iterator itr;
-
       //Find the named value pair
-      if ( m_NVSet.size() < (typename map_type::size_type) index ) {
+      if ( m_NVSet.size() <= (typename map_type::size_type) index ) {
          return ENamedValuesNameNotFound;
       }
 
-      //Get the right entry
-      for ( itr = m_NVSet.begin() ; index != 0 ; index--, itr++ ) {/*empty*/ ; }
-
       //Return the name
-      *pName = (Kt)(*itr).first;
-
-      return ENamedValuesOK;
-   }
-
-   //=============================================================
-   // Specialized template function for std:string keys
-   // The default GetName implementation will not work for
-   // btcString keys. btcString keys are stored as std:strings in
-   // the map structure. So the normal return won't work.
-   // This specialized template function handles this one
-   // exception case.
-   //=============================================================
-   ENamedValues GetName(btUnsignedInt index, btStringKey *pName) const
-   {
-      std::map<std::string, CValue>::const_iterator itr = m_NVSet.end();
-
-      // Find the named value pair
-      if ( m_NVSet.size() < (std::map<std::string, CValue>::size_type) index ) {
-         return ENamedValuesNameNotFound;
-      }
-
-      // Get the right entry
-      for ( itr = m_NVSet.begin() ; index != 0 ; index--, itr++ ) {/*empty*/ ; }
-
-      // Return the name
-      *pName = const_cast<btStringKey>((*itr).first.c_str());
+      *pName = m_NVSet.begin()[index].first;
 
       return ENamedValuesOK;
    }
@@ -1659,6 +2035,83 @@ public:
       return m_NVSet.find(Name) != m_NVSet.end();
    }
 
+   //=============================================================================
+   // Name: Merge
+   // Description: Adds a copy of each of rOther's named values whose name is not
+   //              already present.
+   // Interface: public
+   // Inputs: rOther - NVS to merge from.
+   // Outputs: none.
+   // Comments: Existing values take precedence.
+   //=============================================================================
+   void Merge(const TNamedValueSet &rOther)
+   {
+      m_NVSet.merge(rOther.m_NVSet);
+   }
+
+   //=============================================================================
+   // Name: WriteBinary
+   // Description: Appends the binary form of the named values to rBuf.
+   // Interface: public
+   // Inputs: none.
+   // Outputs: rBuf - Buffer to append to.
+   // Comments: Entry count, then key and value of each entry, in key order.
+   //=============================================================================
+   void WriteBinary(std::string &rBuf) const
+   {
+      NVSBinaryPut(rBuf, static_cast<btUnsigned32bitInt>(m_NVSet.size()));
+
+      const_iterator itr;
+      for ( itr = m_NVSet.begin() ; m_NVSet.end() != itr ; ++itr ) {
+         NVSBinaryPut(rBuf, (*itr).first);
+         NVSBinaryPut(rBuf, (*itr).second);
+      }
+   }
+
+   //=============================================================================
+   // Name: ReadBinary
+   // Description: Adds the named values in the binary form written by
+   //              WriteBinary().
+   // Interface: public
+   // Inputs: rp - Start of the binary form; advanced past it on success.
+   //         end - End of the buffer.
+   //         Depth - Nesting depth of this set; see NVS_BINARY_MAX_DEPTH.
+   // Outputs: none.
+   // Comments: Names that are already present keep their current value.
+   //=============================================================================
+   ENamedValues ReadBinary(const char *&rp, const char *end, btUnsignedInt Depth)
+   {
+      btUnsigned32bitInt Count = 0;
+      if ( !NVSBinaryGet(rp, end, &Count) ) {
+         return ENamedValuesInternalError_UnexpectedEndOfFile;
+      }
+
+      // Every entry takes more than one byte.
+      if ( Count > static_cast<btUnsigned32bitInt>(end - rp) ) {
+         return ENamedValuesInternalError_UnexpectedEndOfFile;
+      }
+      m_NVSet.reserve(m_NVSet.size() + Count);
+
+      while ( Count-- ) {
+         Kt           Name;
+         CValue       Value;
+         ENamedValues res;
+
+         if ( !NVSBinaryGet(rp, end, &Name) ) {
+            return ENamedValuesInternalError_InvalidNameFormat;
+         }
+
+         res = NVSBinaryGet(rp, end, Value, Depth);
+         if ( ENamedValuesOK != res ) {
+            return res;
+         }
+
+         m_NVSet.adopt(Name, Value);
+      }
+
+      return ENamedValuesOK;
+   }
+
 }; // End of template<class Kt>  class TNamedValueSet : public CriticalSection
 
 //=============================================================================
@@ -1666,7 +2119,7 @@ public:
 //   This template is used to construct a NVS class specific to a particular
 //   key data type. It is used in the CNamevValueSet  container class to hold
 //   an NVS instance that is specific to a particular key type.
-//   Namely std::string and and btUnsignedInt.  We could have defined a class
+//   Namely btStringKey and btNumberKey.  We could have defined a class
 //   for each type but this allows us to easily create new NVS for any key
 //   type.
 //=============================================================================
@@ -1675,157 +2128,14 @@ public:
 template<typename Kt>
 TNamedValueSet<Kt> & TNamedValueSet<Kt>::operator = (const TNamedValueSet<Kt> &rOther)
 {
-   btUnsignedInt NumNames;
-   Kt CurrName;
-   eBasicTypes Type;
-
    //Ignore assigning self to self
    if ( &rOther == this ) {
       return *this;
    }
 
-   //Make sure the target is empty
-   Empty();
-
-   //Get the number of entries in source
-   rOther.GetNumNames(&NumNames);
+   // Keys are copied as-is and each CValue deep-copies itself.
+   m_NVSet = rOther.m_NVSet;
 
-   //Copy one at a time
-   for(btUnsignedInt count=0; count < NumNames; count++) {
-      rOther.GetName(count,&CurrName);
-      rOther.Type(CurrName,&Type);
-
-      switch(Type) {
-         case btBool_t: {
-            btBool val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btByte_t: {
-            btByte val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case bt32bitInt_t: {
-            bt32bitInt val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btUnsigned32bitInt_t: {
-            btUnsigned32bitInt val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case bt64bitInt_t: {
-            bt64bitInt val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btUnsigned64bitInt_t: {
-            btUnsigned64bitInt val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btFloat_t: {
-            btFloat val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btString_t: {
-            btcString val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btNamedValueSet_t: {
-            INamedValueSet const *pval = NULL;
-            rOther.Get(CurrName, &pval);
-            Add(CurrName, pval);
-         }
-         break;
-         case btByteArray_t: {
-            btByte  *val;
-            btWSSize Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case bt32bitIntArray_t: {
-            bt32bitInt *val;
-            btWSSize    Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case btUnsigned32bitIntArray_t: {
-            btUnsigned32bitInt *val;
-            btWSSize            Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case bt64bitIntArray_t: {
-            bt64bitInt *val;
-            btWSSize    Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case btUnsigned64bitIntArray_t: {
-            btUnsigned64bitInt *val;
-            btWSSize            Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case btObjectType_t: {
-            btObjectType val;
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val);
-         }
-         break;
-         case btFloatArray_t: {
-            btFloat *val;
-            btWSSize Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case btStringArray_t: {
-            btString *val;
-            btWSSize  Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         case btObjectArray_t: {
-            btObjectType *val;
-            btWSSize      Num = 0;
-            rOther.GetSize(CurrName,&Num);
-            rOther.Get(CurrName,&val);
-            Add(CurrName,val,Num);
-         }
-         break;
-         default: {
-            break;
-         }
-
-      };
-   }
    return( *this );
 }  // end of operator = (assignment)
 
@@ -2231,7 +2541,7 @@ class CNamedValueSet : public INamedValueSet,
 
 private:
    TNamedValueSet<btNumberKey> m_iNVS;
-   TNamedValueSet<std::string> m_sNVS;  // Note that the interface is btStringKey, which is const char*
+   TNamedValueSet<btStringKey> m_sNVS;  // Keys are interned; see NVSKeyPool.
 
 public:
    // CNamedValueSet Default Constructor.
@@ -2952,6 +3262,13 @@ public:
    virtual ENamedValues FromStr(void * , btWSSize );
    virtual std::string    ToStr() const;
 
+   virtual ENamedValues  WriteBinary(std::string & ) const;
+   virtual ENamedValues   ReadBinary(const void * , btWSSize );
+
+   // Binary form of the named values, without the header. Used for embedded NVS's.
+   void         WriteBinarySet(std::string & ) const;
+   ENamedValues  ReadBinarySet(const char *& , const char * , btUnsignedInt );
+
 protected:
 
    // Make this equal to the given INamedValueSet.
@@ -3155,10 +3472,22 @@ std::string CNamedValueSet::ToStr() const
 // Returns:       ENamedValuesOK for success, appropriate value otherwise
 // Comments:      If there are duplicate names, the original value in the
 //                   nvsOutput takes precedence and there is no error
+//                Entries are copied directly from one CNamedValueSet to the
+//                   other; other implementations go through the text form.
 //=============================================================================
 ENamedValues CNamedValueSet::Merge(const INamedValueSet &nvsInput)
 {
+   CNamedValueSet const *pCNamedValueSet = dynamic_cast<CNamedValueSet const *>(nvsInput.Concrete());
+
    AutoLock(this);
+
+   if ( NULL != pCNamedValueSet ) {
+      AutoLock(pCNamedValueSet);
+      m_iNVS.Merge(pCNamedValueSet->m_iNVS);
+      m_sNVS.Merge(pCNamedValueSet->m_sNVS);
+      return ENamedValuesOK;
+   }
+
    // Write nvsInput to a stringstream
    std::stringstream ss;
    ss << nvsInput;
@@ -3166,6 +3495,337 @@ ENamedValues CNamedValueSet::Merge(const INamedValueSet &nvsInput)
    return ENamedValuesOK;
 }  // NVSMerge
 
+/*@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@*/
+/*@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@*/
+/*@@@@@@@                                                            @@@@@@@@*/
+/*@@@@@@@                    B I N A R Y   I / O                     @@@@@@@@*/
+/*@@@@@@@                                                            @@@@@@@@*/
+/*@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@*/
+/*@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@*/
+
+#define NVS_BINARY_MAGIC   "NVSB"
+#define NVS_BINARY_VERSION 1
+// Deepest nesting of embedded NVS's that ReadBinary() accepts. Bounds the
+// recursion on a malformed or hostile buffer.
+#define NVS_BINARY_MAX_DEPTH 64
+
+//=============================================================================
+// Name:        WriteBinary
+// Description: Append the binary serialization of the NVS to a std::string
+// Interface:   public
+// Inputs:      none
+// Outputs:     rBuf has the binary form appended
+// Comments:    All values are in host byte order, unaligned.
+//
+//       Format is:
+//       Header:  "NVSB" u32 version
+//       Set:     u32 count, count * (u64 key, Value)          number keys
+//                u32 count, count * (String key, Value)       string keys
+//       String:  u32 length including the terminating NUL, characters, NUL
+//       Value:   u8 eBasicTypes, then
+//                   btBool, btByte                  1 byte
+//                   integers, btFloat, btObjectType their native size
+//                   btString                        String
+//                   btNamedValueSet                 Set
+//                   arrays                          u32 count, count * element size
+//                   btStringArray                   u32 count, count * String
+//=============================================================================
+ENamedValues CNamedValueSet::WriteBinary(std::string &rBuf) const
+{
+   AutoLock(this);
+
+   rBuf.append(NVS_BINARY_MAGIC, 4);
+   NVSBinaryPut(rBuf, static_cast<btUnsigned32bitInt>(NVS_BINARY_VERSION));
+
+   WriteBinarySet(rBuf);
+   return ENamedValuesOK;
+}
+
+//=============================================================================
+// Name:        ReadBinary
+// Description: Add the contents of an NVS serialized by WriteBinary()
+// Interface:   public
+// Inputs:      pv, len - the binary form
+// Outputs:     none
+// Comments:    ENamedValuesBadType if the buffer does not start with the
+//                 binary header, so callers can fall back to FromStr().
+//=============================================================================
+ENamedValues CNamedValueSet::ReadBinary(const void *pv, btWSSize len)
+{
+   ASSERT(NULL != pv);
+   if ( NULL == pv ) {
+      return ENamedValuesInvalidReadToNull;
+   }
+
+   const char        *p       = static_cast<const char *>(pv);
+   const char        *end     = p + len;
+   btUnsigned32bitInt Version = 0;
+
+   if ( ( len < 4 ) || ( 0 != memcmp(p, NVS_BINARY_MAGIC, 4) ) ) {
+      return ENamedValuesBadType;
+   }
+   p += 4;
+
+   if ( !NVSBinaryGet(p, end, &Version) ) {
+      return ENamedValuesInternalError_UnexpectedEndOfFile;
+   }
+   if ( NVS_BINARY_VERSION != Version ) {
+      return ENamedValuesNotSupported;
+   }
+
+   return ReadBinarySet(p, end, 0);
+}
+
+void CNamedValueSet::WriteBinarySet(std::string &rBuf) const
+{
+   AutoLock(this);
+   m_iNVS.WriteBinary(rBuf);
+   m_sNVS.WriteBinary(rBuf);
+}
+
+ENamedValues CNamedValueSet::ReadBinarySet(const char *&rp, const char *end, btUnsignedInt Depth)
+{
+   if ( Depth > NVS_BINARY_MAX_DEPTH ) {
+      return ENamedValuesNotSupported;
+   }
+
+   AutoLock(this);
+
+   ENamedValues res = m_iNVS.ReadBinary(rp, end, Depth);
+   if ( ENamedValuesOK != res ) {
+      return res;
+   }
+   return m_sNVS.ReadBinary(rp, end, Depth);
+}
+
+//=============================================================================
+// Binary helpers for keys and values
+//=============================================================================
+static inline void NVSBinaryPutRaw(std::string &rBuf, const void *p, size_t len)
+{
+   rBuf.append(static_cast<const char *>(p), len);
+}
+
+static inline btBool NVSBinaryGetRaw(const char *&rp, const char *end, void *p, size_t len)
+{
+   if ( static_cast<size_t>(end - rp) < len ) {
+      return false;
+   }
+   memcpy(p, rp, len);
+   rp += len;
+   return true;
+}
+
+static void NVSBinaryPutString(std::string &rBuf, btcString s)
+{
+   btUnsigned32bitInt len = static_cast<btUnsigned32bitInt>(strlen(s) + 1);
+   NVSBinaryPut(rBuf, len);
+   NVSBinaryPutRaw(rBuf, s, len);
+}
+
+// Returns a pointer to the NUL-terminated string in the buffer, or NULL.
+static btcString NVSBinaryGetString(const char *&rp, const char *end)
+{
+   btUnsigned32bitInt len = 0;
+   if ( !NVSBinaryGet(rp, end, &len) ||
+        ( 0 == len ) ||
+        ( static_cast<size_t>(end - rp) < len ) ||
+        ( '\0' != rp[len - 1] ) ) {
+      return NULL;
+   }
+   btcString s = rp;
+   rp += len;
+   return s;
+}
+
+static void NVSBinaryPut(std::string &rBuf, btUnsigned32bitInt u)
+{
+   NVSBinaryPutRaw(rBuf, &u, sizeof(u));
+}
+
+static void NVSBinaryPut(std::string &rBuf, btNumberKey Name)
+{
+   NVSBinaryPutRaw(rBuf, &Name, sizeof(Name));
+}
+
+static void NVSBinaryPut(std::string &rBuf, btStringKey Name)
+{
+   NVSBinaryPutString(rBuf, Name);
+}
+
+static btBool NVSBinaryGet(const char *&rp, const char *end, btUnsigned32bitInt *pu)
+{
+   return NVSBinaryGetRaw(rp, end, pu, sizeof(*pu));
+}
+
+static btBool NVSBinaryGet(const char *&rp, const char *end, btNumberKey *pName)
+{
+   return NVSBinaryGetRaw(rp, end, pName, sizeof(*pName));
+}
+
+static btBool NVSBinaryGet(const char *&rp, const char *end, btStringKey *pName)
+{
+   *pName = NVSBinaryGetString(rp, end);
+   return NULL != *pName;
+}
+
+static void NVSBinaryPut(std::string &rBuf, const CValue &rValue)
+{
+   const btUnsigned32bitInt Size = rValue.Size();
+
+   rBuf.push_back(static_cast<char>(rValue.Type()));
+
+#define NVSBINARYPUT_CASE(__t) case __t##_t : { \
+   __t __val;                                   \
+   rValue.Get(&__val);                          \
+   NVSBinaryPutRaw(rBuf, &__val, sizeof(__val));\
+} break
+
+#define NVSBINARYPUT_ARRAY_CASE(__t) case __t##_t : {  \
+   __t __val = NULL;                                   \
+   rValue.Get(&__val);                                 \
+   NVSBinaryPut(rBuf, Size);                           \
+   NVSBinaryPutRaw(rBuf, __val, Size * sizeof(*__val));\
+} break
+
+   switch ( rValue.Type() ) {
+      NVSBINARYPUT_CASE(btBool);
+      NVSBINARYPUT_CASE(btByte);
+      NVSBINARYPUT_CASE(bt32bitInt);
+      NVSBINARYPUT_CASE(btUnsigned32bitInt);
+      NVSBINARYPUT_CASE(bt64bitInt);
+      NVSBINARYPUT_CASE(btUnsigned64bitInt);
+      NVSBINARYPUT_CASE(btFloat);
+      NVSBINARYPUT_CASE(btObjectType);
+
+      NVSBINARYPUT_ARRAY_CASE(btByteArray);
+      NVSBINARYPUT_ARRAY_CASE(bt32bitIntArray);
+      NVSBINARYPUT_ARRAY_CASE(btUnsigned32bitIntArray);
+      NVSBINARYPUT_ARRAY_CASE(bt64bitIntArray);
+      NVSBINARYPUT_ARRAY_CASE(btUnsigned64bitIntArray);
+      NVSBINARYPUT_ARRAY_CASE(btFloatArray);
+      NVSBINARYPUT_ARRAY_CASE(btObjectArray);
+
+      case btString_t : {
+         btcString val = NULL;
+         rValue.Get(&val);
+         NVSBinaryPutString(rBuf, val);
+      } break;
+
+      case btStringArray_t : {
+         btStringArray val = NULL;
+         rValue.Get(&val);
+         NVSBinaryPut(rBuf, Size);
+         btUnsigned32bitInt i;
+         for ( i = 0 ; i < Size ; ++i ) {
+            NVSBinaryPutString(rBuf, val[i]);
+         }
+      } break;
+
+      case btNamedValueSet_t : {
+         INamedValueSet const *val = NULL;
+         rValue.Get(&val);
+         // CValue holds a Clone(), which is always a CNamedValueSet.
+         dynamic_cast<CNamedValueSet const *>(val)->WriteBinarySet(rBuf);
+      } break;
+
+      default : break;
+   }
+
+#undef NVSBINARYPUT_CASE
+#undef NVSBINARYPUT_ARRAY_CASE
+}
+
+static ENamedValues NVSBinaryGet(const char *&rp, const char *end, CValue &rValue, btUnsignedInt Depth)
+{
+   btByte             Type = 0;
+   btUnsigned32bitInt Size = 0;
+
+   if ( !NVSBinaryGetRaw(rp, end, &Type, sizeof(Type)) ) {
+      return ENamedValuesInternalError_UnexpectedEndOfFile;
+   }
+
+#define NVSBINARYGET_CASE(__t) case __t##_t : {            \
+   __t __val;                                              \
+   if ( !NVSBinaryGetRaw(rp, end, &__val, sizeof(__val)) ) {\
+      return ENamedValuesInternalError_UnexpectedEndOfFile;\
+   }                                                       \
+   rValue.Put(__val);                                      \
+} break
+
+#define NVSBINARYGET_ARRAY_CASE(__t) case __t##_t : {                          \
+   if ( !NVSBinaryGet(rp, end, &Size) ) {                                         \
+      return ENamedValuesInternalError_UnexpectedEndOfFile;                       \
+   }                                                                              \
+   const size_t __len = static_cast<size_t>(Size) * sizeof(*static_cast<__t>(NULL)); \
+   if ( static_cast<size_t>(end - rp) < __len ) {                                 \
+      return ENamedValuesInternalError_UnexpectedEndOfFile;                       \
+   }                                                                              \
+   rValue.Put(reinterpret_cast<__t>(const_cast<char *>(rp)), Size);               \
+   rp += __len;                                                                   \
+} break
+
+   switch ( Type ) {
+      NVSBINARYGET_CASE(btBool);
+      NVSBINARYGET_CASE(btByte);
+      NVSBINARYGET_CASE(bt32bitInt);
+      NVSBINARYGET_CASE(btUnsigned32bitInt);
+      NVSBINARYGET_CASE(bt64bitInt);
+      NVSBINARYGET_CASE(btUnsigned64bitInt);
+      NVSBINARYGET_CASE(btFloat);
+      NVSBINARYGET_CASE(btObjectType);
+
+      NVSBINARYGET_ARRAY_CASE(btByteArray);
+      NVSBINARYGET_ARRAY_CASE(bt32bitIntArray);
+      NVSBINARYGET_ARRAY_CASE(btUnsigned32bitIntArray);
+      NVSBINARYGET_ARRAY_CASE(bt64bitIntArray);
+      NVSBINARYGET_ARRAY_CASE(btUnsigned64bitIntArray);
+      NVSBINARYGET_ARRAY_CASE(btFloatArray);
+      NVSBINARYGET_ARRAY_CASE(btObjectArray);
+
+      case btString_t : {
+         btcString val = NVSBinaryGetString(rp, end);
+         if ( NULL == val ) {
+            return ENamedValuesInternalError_UnexpectedEndOfFile;
+         }
+         rValue.Put(val);
+      } break;
+
+      case btStringArray_t : {
+         // Every element takes at least 5 bytes.
+         if ( !NVSBinaryGet(rp, end, &Size) ||
+              ( Size > static_cast<size_t>(end - rp) / 5 ) ) {
+            return ENamedValuesInternalError_UnexpectedEndOfFile;
+         }
+         std::vector<btString> val(Size);
+         btUnsigned32bitInt    i;
+         for ( i = 0 ; i < Size ; ++i ) {
+            val[i] = const_cast<btString>(NVSBinaryGetString(rp, end));
+            if ( NULL == val[i] ) {
+               return ENamedValuesInternalError_UnexpectedEndOfFile;
+            }
+         }
+         rValue.Put(( 0 == Size ) ? NULL : &val[0], Size);
+      } break;
+
+      case btNamedValueSet_t : {
+         CNamedValueSet val;
+         ENamedValues   res = val.ReadBinarySet(rp, end, Depth + 1);
+         if ( ENamedValuesOK != res ) {
+            return res;
+         }
+         rValue.Put(&val);
+      } break;
+
+      default : return ENamedValuesBadType;
+   }
+
+#undef NVSBINARYGET_CASE
+#undef NVSBINARYGET_ARRAY_CASE
+
+   return ENamedValuesOK;
+}
+
 
 
 //=============================================================================
@@ -0,0 +1,249 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file CObjectPool.cpp
+/// @brief Implementation of class CObjectPool.
+/// @ingroup AASUtils
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+///    Per-size-class free lists behind the pooled operator new / operator
+///    delete of events and dispatchables.@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include "aalsdk/CObjectPool.h"
+#include "aalsdk/osal/Sleep.h"
+
+BEGIN_NAMESPACE(AAL)
+
+//=============================================================================
+// Name: CObjectPool
+// Description: Constructor
+//=============================================================================
+CObjectPool::CObjectPool(btUnsignedInt MaxPooled) :
+   m_MaxPooled(MaxPooled)
+{
+   btUnsignedInt i;
+   for ( i = 0 ; i <= Classes ; ++i ) {
+      m_Classes[i].m_Lock       = 0;
+      m_Classes[i].m_pHead      = NULL;
+      m_Classes[i].m_Pooled     = 0;
+      m_Classes[i].m_Live       = 0;
+      m_Classes[i].m_HeapAllocs = 0;
+      m_Classes[i].m_Reuses     = 0;
+   }
+}
+
+//=============================================================================
+// Name: ~CObjectPool
+// Description: Destructor
+//=============================================================================
+CObjectPool::~CObjectPool()
+{
+   Trim();
+}
+
+//=============================================================================
+// Name: Lock / Unlock
+// Description: Per size class spin lock.
+// Comments: Held only to link or unlink one block, so a waiter spins briefly
+//           before yielding the CPU to the holder.
+//=============================================================================
+void CObjectPool::Lock(SizeClass &c)
+{
+   btUnsignedInt spins = 0;
+
+   for ( ; ; ) {
+#if   defined( __AAL_WINDOWS__ )
+      if ( 0 == InterlockedExchange((volatile LONG *)&c.m_Lock, 1) ) {
+         return;
+      }
+#elif defined( __AAL_LINUX__ )
+      if ( 0 == __sync_lock_test_and_set(&c.m_Lock, 1) ) {
+         return;
+      }
+#endif // OS
+      while ( 0 != c.m_Lock ) {
+         if ( ++spins > 64 ) {
+            SleepZero();
+         }
+      }
+   }
+}
+
+void CObjectPool::Unlock(SizeClass &c)
+{
+#if   defined( __AAL_WINDOWS__ )
+   InterlockedExchange((volatile LONG *)&c.m_Lock, 0);
+#elif defined( __AAL_LINUX__ )
+   __sync_lock_release(&c.m_Lock);
+#endif // OS
+}
+
+//=============================================================================
+// Name: Allocate
+// Description: Allocate a block of at least Size bytes.
+// Interface: public
+// Inputs: Size - requested size in bytes.
+// Outputs: The block, or NULL if the heap is exhausted.
+// Comments: The block is preceded by a BlockHeader that records its size
+//           class, so Free() needs no size.
+//=============================================================================
+void * CObjectPool::Allocate(std::size_t Size) throw()
+{
+   btUnsignedInt cls = (btUnsignedInt)( ( Size + Granule - 1 ) / Granule );
+   if ( cls > 0 ) {
+      --cls;
+   }
+
+   BlockHeader *pBlock = NULL;
+
+   if ( cls < Classes ) {
+      SizeClass &c = m_Classes[cls];
+
+      Lock(c);
+      pBlock = c.m_pHead;
+      if ( NULL != pBlock ) {
+         c.m_pHead = pBlock->m_pNext;
+         --c.m_Pooled;
+         ++c.m_Reuses;
+         ++c.m_Live;
+      }
+      Unlock(c);
+
+      if ( NULL != pBlock ) {
+         pBlock->m_Class = cls;
+         return pBlock + 1;
+      }
+
+      Size = ( cls + 1 ) * Granule;
+   } else {
+      cls = Classes;
+   }
+
+   pBlock = reinterpret_cast<BlockHeader *>( ::operator new(sizeof(BlockHeader) + Size, std::nothrow) );
+   if ( NULL == pBlock ) {
+      return NULL;
+   }
+   pBlock->m_Class = cls;
+
+   SizeClass &c = m_Classes[cls];
+   Lock(c);
+   ++c.m_HeapAllocs;
+   ++c.m_Live;
+   Unlock(c);
+
+   return pBlock + 1;
+}
+
+//=============================================================================
+// Name: Free
+// Description: Return a block to its free list, or to the heap when the list
+//              is full or the block is too large to pool.
+// Interface: public
+// Inputs: p - block from Allocate(), or NULL.
+//=============================================================================
+void CObjectPool::Free(void *p) throw()
+{
+   if ( NULL == p ) {
+      return;
+   }
+
+   BlockHeader  *pBlock = reinterpret_cast<BlockHeader *>(p) - 1;
+   btUnsignedInt cls    = pBlock->m_Class;
+   SizeClass    &c      = m_Classes[cls];
+
+   Lock(c);
+   --c.m_Live;
+   if ( ( cls < Classes ) && ( c.m_Pooled < m_MaxPooled ) ) {
+      pBlock->m_pNext = c.m_pHead;
+      c.m_pHead       = pBlock;
+      ++c.m_Pooled;
+      pBlock = NULL;
+   }
+   Unlock(c);
+
+   if ( NULL != pBlock ) {
+      ::operator delete(pBlock);
+   }
+}
+
+//=============================================================================
+// Name: Trim
+// Description: Return all pooled blocks to the heap.
+// Interface: public
+//=============================================================================
+void CObjectPool::Trim()
+{
+   btUnsignedInt i;
+   for ( i = 0 ; i < Classes ; ++i ) {
+      SizeClass &c = m_Classes[i];
+
+      Lock(c);
+      BlockHeader *pBlock = c.m_pHead;
+      c.m_pHead  = NULL;
+      c.m_Pooled = 0;
+      Unlock(c);
+
+      while ( NULL != pBlock ) {
+         BlockHeader *pNext = pBlock->m_pNext;
+         ::operator delete(pBlock);
+         pBlock = pNext;
+      }
+   }
+}
+
+//=============================================================================
+// Name: GetStats
+// Description: Sum the counters of all size classes.
+// Interface: public
+// Outputs: rStats - the counters.
+//=============================================================================
+void CObjectPool::GetStats(Stats &rStats) const
+{
+   rStats.Live       = 0;
+   rStats.Pooled     = 0;
+   rStats.HeapAllocs = 0;
+   rStats.Reuses     = 0;
+
+   btUnsignedInt i;
+   for ( i = 0 ; i <= Classes ; ++i ) {
+      SizeClass &c = const_cast<SizeClass &>(m_Classes[i]);
+
+      Lock(c);
+      rStats.Live       += c.m_Live;
+      rStats.Pooled     += c.m_Pooled;
+      rStats.HeapAllocs += c.m_HeapAllocs;
+      rStats.Reuses     += c.m_Reuses;
+      Unlock(c);
+   }
+}
+
+END_NAMESPACE(AAL)
+
@@ -50,6 +50,39 @@
 
 BEGIN_NAMESPACE(AAL)
 
+// Created on first use and never destroyed, so that dispatchables deleted during
+//  static destruction still have a pool to return to.
+CObjectPool & PooledDispatchable::DispatchablePool()
+{
+   static CObjectPool *pPool = new CObjectPool();
+   return *pPool;
+}
+
+void * PooledDispatchable::operator new(std::size_t Size)
+{
+   void *p = DispatchablePool().Allocate(Size);
+   if ( NULL == p ) {
+      throw std::bad_alloc();
+   }
+   return p;
+}
+
+void * PooledDispatchable::operator new(std::size_t Size, const std::nothrow_t & ) throw()
+{
+   return DispatchablePool().Allocate(Size);
+}
+
+void PooledDispatchable::operator delete(void *p)
+{
+   DispatchablePool().Free(p);
+}
+
+void PooledDispatchable::operator delete(void *p, const std::nothrow_t & ) throw()
+{
+   DispatchablePool().Free(p);
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
 ServiceAllocated::ServiceAllocated(IServiceClient      *pSvcClient,
                                    IRuntimeClient      *pRTClient,
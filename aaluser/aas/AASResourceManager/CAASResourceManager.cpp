@@ -93,6 +93,7 @@
 #include "aalsdk/kernel/KernelStructs.h"   // various operator<<
 #include "aalsdk/utils/ResMgrUtilities.h"  // string, name, and GUID inter-conversion operators
 #include "aalsdk/rm/ResMgrService.h"
+#include "aalsdk/rm/AALResourceManagerProxy.h" // RM_MANIFEST_KEY_BINARY_REPLY
 
 BEGIN_NAMESPACE(AAL)
 
@@ -404,8 +405,15 @@ int CResMgr::DoRequestDevice(int fdServer, struct aalrm_ioctlreq *pIoctlReq)
    pIoctlReq->id = rspid_URMS_RequestDevice;
    if (pIoctlReq->size) {   // There is a payload, so retrieve the NVS and take appropriate action
 
-      // Get the Manifest from the IoctlReq
-      NamedValueSet nvsManifest(pIoctlReq->payload, pIoctlReq->size);
+      // Get the Manifest from the IoctlReq. Reply in binary to a client that sent
+      //    binary or asked for it; older clients read only the text form.
+      NamedValueSet nvsManifest;
+      btBool        bBinaryReply = ( ENamedValuesOK == nvsManifest.ReadBinary(pIoctlReq->payload, pIoctlReq->size) );
+      if ( !bBinaryReply ) {
+         nvsManifest  = NamedValueSet(pIoctlReq->payload, pIoctlReq->size);
+         bBinaryReply = nvsManifest.Has(RM_MANIFEST_KEY_BINARY_REPLY);
+         nvsManifest.Delete(RM_MANIFEST_KEY_BINARY_REPLY);
+      }
 
       // Compute the Goal Records, manifest in, list of goal records out
       nvsList listGoalRecords;
@@ -427,7 +435,7 @@ int CResMgr::DoRequestDevice(int fdServer, struct aalrm_ioctlreq *pIoctlReq)
             btNumberKey index;
             if ( (ENamedValuesOK == nvsGoal.Get( keyRegDeviceAddress, &index)) &&
                   (m_InstRecMap.Get( index, &pInstRec)) ) {
-               pInstRec->IncrementAllocations();               // The equivalent decrement is in DoUpdateConfig, devOwnerRemoved
+               m_InstRecMap.IncrementAllocations( index);      // The equivalent decrement is in DoUpdateConfig, devOwnerRemoved
                // and also in failure cases below.
             }
 
@@ -436,8 +444,14 @@ int CResMgr::DoRequestDevice(int fdServer, struct aalrm_ioctlreq *pIoctlReq)
             // Clean out the old payload, note that size > 0 or we would not be here
             delete[] pIoctlReq->payload;  // matches allocator in Get_AALRMS_Msg
 
-            // Write in the new payload, which is just a serialized copy of nvsGoal
-            std::string s(nvsGoal);
+            // Write in the new payload, which is just a serialized copy of nvsGoal,
+            //    in the form chosen above.
+            std::string s;
+            if ( bBinaryReply ) {
+               nvsGoal.WriteBinary(s);
+            } else {
+               s = std::string(nvsGoal);
+            }
             pIoctlReq->size = s.length();
             pIoctlReq->payload = reinterpret_cast<btVirtAddr>(new btByte[pIoctlReq->size]);
             BufFromString( pIoctlReq->payload, s);
@@ -449,7 +463,7 @@ int CResMgr::DoRequestDevice(int fdServer, struct aalrm_ioctlreq *pIoctlReq)
 
          // Show the returned Goal Record
          AAL_DEBUG(LM_ResMgr,"CResMgr::DoRequestDevice: Goal Record being returned:" <<
-               "\nAs a string:\n" << reinterpret_cast<btByte *>(pIoctlReq->payload) );
+               "\nAs a string:\n" << nvsGoal );
       }
       else {
          // Expecting that ComputeGoalRecords and/or GetPolicyResults will already have issued error messages
@@ -485,7 +499,7 @@ int CResMgr::DoRequestDevice(int fdServer, struct aalrm_ioctlreq *pIoctlReq)
    // If there was an error, need to decrement the number of allocations
    if (RealRetVal && pInstRec) {
       AAL_DEBUG(LM_ResMgr,"CResMgr::DoRequestDevice: Send_AALRMS_Message Error causes decrement of Allocation.\n");
-      pInstRec->DecrementAllocations();
+      m_InstRecMap.DecrementAllocations( pInstRec->InstanceIndex());
    }
 
    // Return the filtered return value from SendMessage
@@ -615,7 +629,7 @@ int CResMgr::DoConfigUpdate(int fdServer, struct aalrm_ioctlreq *pIoctlReq)
          if (m_InstRecMap.Get( instrecIndex, &pInstRecExisting)) {
 
             // Update the existing InstRec with the new information
-            if (pInstRecExisting->ReplaceStruct( pcfgUpDate)) {
+            if (m_InstRecMap.ReplaceStruct( instrecIndex, pcfgUpDate)) {
                // Successful replacement. Do nothing more, ready to continue to next steps
                // NOTE: Do NOT update numAllocations as the state machine needs to run
             }
@@ -709,7 +723,7 @@ int CResMgr::DoConfigUpdate(int fdServer, struct aalrm_ioctlreq *pIoctlReq)
          break;
       case krms_ccfgUpdate_DevOwnerRemoved: {
          // Decrement the Number of Allocations that the RM is tracking
-         if ( ! pInstRecExisting->DecrementAllocations()) {
+         if ( ! m_InstRecMap.DecrementAllocations( instrecIndex)) {
             AAL_ERR(LM_ResMgr, "CResMgr::DoConfigUpdate DevOwnerRemoved failed\n");
             return EPERM;
          }
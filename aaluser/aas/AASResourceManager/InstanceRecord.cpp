@@ -66,7 +66,10 @@ InstRec::InstRec(aalrms_configUpDateEvent *pConfigUpdate) :
    m_InstanceIndex(IntNameFromDeviceAddress( &pConfigUpdate->devattrs.devid.m_devaddr)),
    m_NumAllocations(pConfigUpdate->devattrs.numOwners),
    m_MaxAllocations(pConfigUpdate->devattrs.maxOwners),
-   m_fUnlimitedAllocations(MAFU_CONFIGURE_UNLIMTEDSHARES == pConfigUpdate->devattrs.maxOwners)
+   m_fUnlimitedAllocations(MAFU_CONFIGURE_UNLIMTEDSHARES == pConfigUpdate->devattrs.maxOwners),
+   m_AFU_ID(AFU_IDNameFromConfigStruct(*pConfigUpdate)),
+   m_nvsInstRec(),
+   m_fInstRecNVS(false)
 {}
 
 InstRec::InstRec() {/*empty*/}
@@ -138,6 +141,9 @@ btBool InstRec::ReplaceStruct(const aalrms_configUpDateEvent *pConfigUpdate)
 {
    if ( IntNameFromDeviceAddress(&pConfigUpdate->devattrs.devid.m_devaddr) == m_InstanceIndex ) {
       m_ConfigUpdate = *pConfigUpdate;
+      m_AFU_ID       = AFU_IDNameFromConfigStruct(*pConfigUpdate);
+      m_fInstRecNVS  = false;
+      m_nvsInstRec.Empty();
       return true;
    }
 
@@ -159,7 +165,11 @@ btBool InstRec::ReplaceStruct(const aalrms_configUpDateEvent *pConfigUpdate)
 // Description: Default constructor
 //=============================================================================
 InstRecMap::InstRecMap() :
-   m_Map()
+   m_Map(),
+   m_ByAFU_ID(),
+   m_ByPCIAddress(),
+   m_Allocatable(),
+   m_Empty()
 {}
 
 //=============================================================================
@@ -179,6 +189,9 @@ btBool InstRecMap::Add(const InstRec &instRec)
 {
    std::pair<InstRecMap_itr_t, btBool> ret =
       m_Map.insert( std::pair<btNumberKey, InstRec>(instRec.InstanceIndex(), instRec) );
+   if ( ret.second ) {
+      Index((*ret.first).second);
+   }
    return ret.second;
 }  // InstRecMap::Add
 
@@ -218,10 +231,153 @@ void InstRecMap::Delete(btNumberKey key)
    InstRecMap_itr_t itr=m_Map.find(key);
 
    if ( itr != m_Map.end() ) {
-      m_Map.erase(key);
+      Unindex((*itr).second);
+      m_Map.erase(itr);
    }
 }  // InstRecMap::Delete
 
+//=============================================================================
+// Name:        InstRecMap::ReplaceStruct
+// Description: Replace the ConfigUpdate event of a record and re-index it
+//=============================================================================
+btBool InstRecMap::ReplaceStruct(btNumberKey key, const aalrms_configUpDateEvent *pConfigUpdate)
+{
+   pInstRec_t pInstRec = NULL;
+   if ( !Get(key, &pInstRec) ) {
+      return false;
+   }
+
+   Unindex(*pInstRec);
+   btBool ret = pInstRec->ReplaceStruct(pConfigUpdate);
+   Index(*pInstRec);
+   return ret;
+}  // InstRecMap::ReplaceStruct
+
+//=============================================================================
+// Name:        InstRecMap::IncrementAllocations
+// Description: Increment the allocation count of a record and update its state
+//=============================================================================
+btBool InstRecMap::IncrementAllocations(btNumberKey key)
+{
+   pInstRec_t pInstRec = NULL;
+   if ( !Get(key, &pInstRec) ) {
+      return false;
+   }
+
+   btBool ret = pInstRec->IncrementAllocations();
+   IndexState(*pInstRec);
+   return ret;
+}  // InstRecMap::IncrementAllocations
+
+//=============================================================================
+// Name:        InstRecMap::DecrementAllocations
+// Description: Decrement the allocation count of a record and update its state
+//=============================================================================
+btBool InstRecMap::DecrementAllocations(btNumberKey key)
+{
+   pInstRec_t pInstRec = NULL;
+   if ( !Get(key, &pInstRec) ) {
+      return false;
+   }
+
+   btBool ret = pInstRec->DecrementAllocations();
+   IndexState(*pInstRec);
+   return ret;
+}  // InstRecMap::DecrementAllocations
+
+//=============================================================================
+// Name:        InstRecMap::ByAFU_ID
+// Description: Look up the keys of the records with an AFU_ID
+//=============================================================================
+const InstRecKeySet_t & InstRecMap::ByAFU_ID(const std::string &AFU_ID) const
+{
+   InstRecStrIndex_t::const_iterator itr = m_ByAFU_ID.find(AFU_ID);
+   return ( itr != m_ByAFU_ID.end() ) ? (*itr).second : m_Empty;
+}  // InstRecMap::ByAFU_ID
+
+//=============================================================================
+// Name:        InstRecMap::ByPCIAddress
+// Description: Look up the keys of the records at a bus/device/function
+//=============================================================================
+const InstRecKeySet_t & InstRecMap::ByPCIAddress(btUnsigned32bitInt Bus,
+                                                 btUnsigned32bitInt Device,
+                                                 btUnsigned32bitInt Function) const
+{
+   InstRecIntIndex_t::const_iterator itr = m_ByPCIAddress.find(PCIAddressKey(Bus, Device, Function));
+   return ( itr != m_ByPCIAddress.end() ) ? (*itr).second : m_Empty;
+}  // InstRecMap::ByPCIAddress
+
+//=============================================================================
+// Name:        InstRecMap::PCIAddressKey
+// Description: Index key of a bus/device/function
+// Comments:    Device and function are truncated to the 16 bits held in
+//                 aal_device_addr, so a lookup may return extra records,
+//                 never fewer. Callers test each record.
+//=============================================================================
+btUnsigned64bitInt InstRecMap::PCIAddressKey(btUnsigned32bitInt Bus,
+                                             btUnsigned32bitInt Device,
+                                             btUnsigned32bitInt Function)
+{
+   return ( static_cast<btUnsigned64bitInt>(Bus) << 32 ) |
+          ( static_cast<btUnsigned64bitInt>(Device & 0xffff) << 16 ) |
+            static_cast<btUnsigned64bitInt>(Function & 0xffff);
+}  // InstRecMap::PCIAddressKey
+
+//=============================================================================
+// Name:        InstRecMap::Index
+// Description: Add a record to the secondary indices
+//=============================================================================
+void InstRecMap::Index(const InstRec &instRec)
+{
+   const aal_device_addr &addr = instRec.ConfigStruct().devattrs.devid.m_devaddr;
+
+   m_ByAFU_ID[instRec.AFU_ID()].insert(instRec.InstanceIndex());
+   m_ByPCIAddress[PCIAddressKey(addr.m_busnum, addr.m_devicenum, addr.m_functnum)].insert(instRec.InstanceIndex());
+   IndexState(instRec);
+}  // InstRecMap::Index
+
+//=============================================================================
+// Name:        InstRecMap::Unindex
+// Description: Remove a record from the secondary indices
+//=============================================================================
+void InstRecMap::Unindex(const InstRec &instRec)
+{
+   const aal_device_addr &addr = instRec.ConfigStruct().devattrs.devid.m_devaddr;
+
+   InstRecStrIndex_t::iterator sitr = m_ByAFU_ID.find(instRec.AFU_ID());
+   if ( sitr != m_ByAFU_ID.end() ) {
+      (*sitr).second.erase(instRec.InstanceIndex());
+      if ( (*sitr).second.empty() ) {
+         m_ByAFU_ID.erase(sitr);
+      }
+   }
+
+   InstRecIntIndex_t::iterator iitr = m_ByPCIAddress.find(PCIAddressKey(addr.m_busnum, addr.m_devicenum, addr.m_functnum));
+   if ( iitr != m_ByPCIAddress.end() ) {
+      (*iitr).second.erase(instRec.InstanceIndex());
+      if ( (*iitr).second.empty() ) {
+         m_ByPCIAddress.erase(iitr);
+      }
+   }
+
+   m_Allocatable.erase(instRec.InstanceIndex());
+}  // InstRecMap::Unindex
+
+//=============================================================================
+// Name:        InstRecMap::IndexState
+// Description: Add a record to, or remove it from, the Allocatable() set
+//=============================================================================
+void InstRecMap::IndexState(const InstRec &instRec)
+{
+   aal_device_type_e type = instRec.ConfigStruct().devattrs.devid.m_devicetype;
+
+   if ( ( ( aal_devtypeAFU == type ) || ( aal_devtypeMgmtAFU == type ) ) && instRec.IsAvailable() ) {
+      m_Allocatable.insert(instRec.InstanceIndex());
+   } else {
+      m_Allocatable.erase(instRec.InstanceIndex());
+   }
+}  // InstRecMap::IndexState
+
 //=============================================================================
 // Name:        std::ostream& operator << of instRec
 // Description: writes a description of the object to the ostream
@@ -328,13 +328,33 @@ btBool CResMgr::ComputeBackdoorGoalRecords (const NamedValueSet& nvsManifest, nv
     */
    if ( testAFU_ID || testAHM_ID || testBusType || testBusNumber || testDeviceNumber || testFunctionNumber || testSubDeviceNumber || testInstanceNumber ) {
       ////////////////////////////////////////////////////////////////////////////
-      // Loop over the instance records
+      // Narrow the candidates with the most selective index that applies. Every
+      //    candidate is still put through all of the tests below, and each index
+      //    iterates in key order, so the goal list is the same as that of a scan
+      //    of the whole map.
       ////////////////////////////////////////////////////////////////////////////
 
-      for (InstRecMap_citr_t itr = m_InstRecMap.m_Map.begin(); itr != m_InstRecMap.m_Map.end(); ++itr)
+      const InstRecKeySet_t *pCandidates = &m_InstRecMap.Allocatable();
+
+      if ( testAFU_ID ) {
+         pCandidates = &m_InstRecMap.ByAFU_ID( sAFU_ID);
+      } else if ( testBusNumber && testDeviceNumber && testFunctionNumber ) {
+         pCandidates = &m_InstRecMap.ByPCIAddress( BusNumber, DeviceNumber, FunctionNumber);
+      }
+
+      ////////////////////////////////////////////////////////////////////////////
+      // Loop over the candidate instance records
+      ////////////////////////////////////////////////////////////////////////////
+
+      for (InstRecKeySet_citr_t kitr = pCandidates->begin(); kitr != pCandidates->end(); ++kitr)
       {
          // Get the Instance Record in the map
-         const InstRec &rInstRec = (*itr).second;
+         pInstRec_t pInstRec = NULL;
+         if ( !m_InstRecMap.Get( *kitr, &pInstRec) ) {
+            AAL_WARNING(LM_ResMgr, "CResMgr::ComputeBackdoorGoalRecords: Index holds a key that is not in the map.\n");
+            continue;
+         }
+         const InstRec &rInstRec = *pInstRec;
          AAL_VERBOSE(LM_ResMgr, "CResMgr::ComputeBackdoorGoalRecords: Instance Record being considered is:\n" << rInstRec);
 
          /////////////////////////////////////////////////////////////////////////
@@ -366,9 +386,9 @@ btBool CResMgr::ComputeBackdoorGoalRecords (const NamedValueSet& nvsManifest, nv
 
          // AFU_ID
          if ( ( testAFU_ID ) &&
-              ( sAFU_ID != AFU_IDNameFromConfigStruct( rInstRec.ConfigStruct()))) {
+              ( sAFU_ID != rInstRec.AFU_ID())) {
             AAL_VERBOSE(LM_ResMgr, "CResMgr::ComputeBackdoorGoalRecords: Instance Record being considered AFU_ID is " <<
-                  AFU_IDNameFromConfigStruct( rInstRec.ConfigStruct()) << " but desired AFU_ID is " << sAFU_ID << std::endl);
+                  rInstRec.AFU_ID() << " but desired AFU_ID is " << sAFU_ID << std::endl);
             continue;
          }
 
@@ -442,9 +462,12 @@ btBool CResMgr::ComputeBackdoorGoalRecords (const NamedValueSet& nvsManifest, nv
          // If here, then this is a valid record. Put it on the goal list.
          /////////////////////////////////////////////////////////////////////////
 
-         // Create the Instance Record as an NVS
-         NamedValueSet nvsInstRec;
-         NVSFromConfigUpdate( rInstRec.ConfigStruct(), nvsInstRec);
+         // Create the Instance Record as an NVS, once per ConfigUpdate event
+         if ( !rInstRec.HasInstRecNVS() ) {
+            NamedValueSet nvsInstRec;
+            NVSFromConfigUpdate( rInstRec.ConfigStruct(), nvsInstRec);
+            pInstRec->InstRecNVS( nvsInstRec);
+         }
 
          // Add it to the goal list
          AAL_VERBOSE(LM_ResMgr, "CResMgr::ComputeBackdoorGoalRecords: Found Instance Record:\n" << rInstRec.ConfigStruct());
@@ -456,7 +479,7 @@ btBool CResMgr::ComputeBackdoorGoalRecords (const NamedValueSet& nvsManifest, nv
          --nvsitr;                                                   // back up to get it
 
          // Pre-load the goal record with the Instance Record
-         (*nvsitr).m_nvs = nvsInstRec;
+         (*nvsitr).m_nvs = rInstRec.InstRecNVS();
 
          // Add the Manifest in as well
          (*nvsitr).m_nvs.Merge(nvsManifest);
@@ -41,6 +41,7 @@
 #define __AALSDK_AIASERVICE_AIA_INTERNAL_H__
 
 #include <aalsdk/aas/AALService.h>                 // ServiceBase
+#include <aalsdk/aas/Dispatchables.h>              // PooledDispatchable
 #include <aalsdk/uaia/IAFUProxy.h>                 // AFUProxy
 
 #include <aalsdk/INTCDefs.h>                       // AIA IDs
@@ -48,6 +49,10 @@
 #include "UIDriverInterfaceAdapter.h"              // UIDriverInterfaceAdapter
 #include "AIATransactions.h"
 
+#include <climits>
+#include <map>
+#include <vector>
+
 /// @todo Document uAIA and related.
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -63,10 +68,18 @@
 
 BEGIN_NAMESPACE(AAL)
 
+class UIDriverEvent;
+
+/// Default and maximum number of AIA completion delivery threads.
+#define AIA_PUMP_THREADS_DEFAULT 1
+#define AIA_PUMP_THREADS_MAX     16
+/// Events a delivery thread takes from one proxy's queue before letting other proxies' queues run.
+#define AIA_PUMP_BATCH           16
+
 //============================================================================
 // AAL Service Client
 //============================================================================
-class AFUProxyCallback : public IDispatchable
+class AFUProxyCallback : public PooledDispatchable
 {
 public:
 
@@ -81,16 +94,22 @@ public:
 
 
 void operator() ()
+{
+   Deliver(m_pClient, *m_pEvent);
+   delete m_pEvent;
+   delete this;
+}
+
+// Hand a UI driver event to its TransactionID handler if it has one, otherwise to the proxy.
+static void Deliver(IAFUProxyClient *pClient, AAL::IEvent const &rEvent)
 {
    // Process TransactionID
-   const TransactionID &msgTid = dynamic_cast<const IUIDriverEvent*>(evtUIDriverClientEvent, m_pEvent)->msgTranID(); // FIXME check for errors
+   const TransactionID &msgTid = dynamic_cast<const IUIDriverEvent*>(evtUIDriverClientEvent, &rEvent)->msgTranID(); // FIXME check for errors
    if (msgTid.Filter() && msgTid.Handler() != NULL) {
-      msgTid.Handler()(*m_pEvent);
+      msgTid.Handler()(rEvent);
    } else {
-      m_pClient->AFUEvent(*m_pEvent);
+      pClient->AFUEvent(rEvent);
    }
-   delete m_pEvent;
-   delete this;
 }
 
 virtual ~AFUProxyCallback() {}
@@ -115,6 +134,17 @@ class AIASERVICE_API AIAService : public AAL::ServiceBase, public AAL::IServiceC
          m_Semaphore(),
          m_pMDT(NULL),
          m_pShutdownThread(NULL),
+         m_PumpLock(),
+         m_PumpSem(),
+         m_PumpThreads(),
+         m_Queues(),
+         m_pReadyHead(NULL),
+         m_pReadyTail(NULL),
+         m_pFreeEvents(NULL),
+         m_bPumpStop(false),
+         m_pWaiters(NULL),
+         m_PollInline(0),
+         m_PollBlocked(0),
          m_state(Uninitialized)
       {
          if ( EObjOK != SetInterface(iidAIAService, dynamic_cast <AIAService *>(this)) ) {
@@ -124,6 +154,10 @@ class AIASERVICE_API AIAService : public AAL::ServiceBase, public AAL::IServiceC
          if ( !m_Semaphore.Create(1) ) {
             m_bIsOK = false;
          }
+
+         if ( !m_PumpSem.Create(0, INT_MAX) ) {
+            m_bIsOK = false;
+         }
       }
 
       virtual ~AIAService();
@@ -143,10 +177,13 @@ class AIASERVICE_API AIAService : public AAL::ServiceBase, public AAL::IServiceC
       void AFUProxyAdd(AAL::IBase *pAFUProxy);
 
       void SendMessage(AAL::btHANDLE devhandle, IAIATransaction *pMessage, IAFUProxyClient *pClient);
+      AAL::btBool SendPolledMessage(AAL::btHANDLE devhandle, IAIATransaction *pMessage, IAFUProxyClient *pClient, AAL::btUnsigned32bitInt SpinUsec);
 
       AAL::btBool MapWSID(AAL::btWSSize Size, AAL::btWSID wsid, AAL::btVirtAddr *pRet, AAL::NamedValueSet const &optArgs = AAL::NamedValueSet());
       void UnMapWSID(AAL::btVirtAddr ptr, AAL::btWSSize Size);
 
+      AAL::btBool GetSendStats(AAL::NamedValueSet &rStats);
+
 
    protected:
       void SemWait(void);
@@ -157,6 +194,21 @@ class AIASERVICE_API AIAService : public AAL::ServiceBase, public AAL::IServiceC
       static void MessageDeliveryThread(OSLThread *pThread,
                                         void *pContext);
 
+      // Completion delivery. The message delivery thread reads the driver and queues each
+      //  event on its proxy's CompletionQueue; pump threads drain the queues.
+      void StartPump(btUnsignedInt NumThreads);
+      void StopPump();
+      void Enqueue(UIDriverEvent *pEvent);
+      btBool DeliverReady();
+      void DeliverPolled(UIDriverEvent *pEvent, IAFUProxyClient *pClient);
+      void NotifyWaiters(UIDriverEvent *pEvent);
+
+      static void PumpThread(OSLThread *pThread,
+                             void *pContext);
+
+      UIDriverEvent * GetFreeEvent();
+      void PutFreeEvent(UIDriverEvent *pEvent);
+
       void WaitForShutdown(TransactionID const &rtid,
                            btTime timeout);
 
@@ -199,6 +251,62 @@ class AIASERVICE_API AIAService : public AAL::ServiceBase, public AAL::IServiceC
       OSLThread                 *m_pMDT;                                         // Message delivery thread
       OSLThread                 *m_pShutdownThread;                              // Shutdown thread
 
+      // Per-proxy completion queue. Its events are delivered in order, by one pump thread at a time.
+      struct CompletionQueue
+      {
+         CompletionQueue() :
+            m_pHead(NULL),
+            m_pTail(NULL),
+            m_pNextReady(NULL),
+            m_bScheduled(false),
+            m_bRetired(false)
+         {}
+
+         UIDriverEvent   *m_pHead;
+         UIDriverEvent   *m_pTail;
+         CompletionQueue *m_pNextReady;                                          // Link in the ready list
+         btBool           m_bScheduled;                                          // On the ready list or being drained
+         btBool           m_bRetired;                                            // Proxy gone, out of m_Queues. Deleted once drained
+      };
+
+      typedef std::map<IAFUProxyClient *, CompletionQueue *> CompletionQueueMap;
+      typedef std::vector<OSLThread *>                       PumpThreadList;
+
+      // A thread in SendPolledMessage(), waiting for the event completing its transaction.
+      struct CompletionWaiter
+      {
+         CompletionWaiter(IAFUProxyClient *pClient, stTransactionID_t const &rTranID) :
+            m_pClient(pClient),
+            m_TranID(rTranID),
+            m_bDone(false),
+            m_pNext(NULL)
+         {
+            m_Sem.Create(0, 1);
+         }
+
+         IAFUProxyClient   *m_pClient;
+         stTransactionID_t  m_TranID;
+         volatile btBool    m_bDone;                                             // Set, and m_Sem posted, once delivered
+         CSemaphore         m_Sem;
+         CompletionWaiter  *m_pNext;
+      };
+
+      CompletionQueue * QueueFor(IAFUProxyClient *pClient);
+      void           ScheduleQueue(CompletionQueue *pQueue);
+      void             RetireQueue(IAFUProxyClient *pClient);
+
+      CriticalSection            m_PumpLock;                                     // Protects the members below
+      CSemaphore                 m_PumpSem;                                      // One count per ready queue, plus one per pump thread at stop
+      PumpThreadList             m_PumpThreads;                                  // Completion delivery threads
+      CompletionQueueMap         m_Queues;                                       // Completion queue per proxy
+      CompletionQueue           *m_pReadyHead;                                   // Queues waiting for a pump thread
+      CompletionQueue           *m_pReadyTail;
+      UIDriverEvent             *m_pFreeEvents;                                  // Recycled events and their messages
+      btBool                     m_bPumpStop;
+      CompletionWaiter          *m_pWaiters;                                     // Threads in SendPolledMessage()
+      btUnsigned64bitInt         m_PollInline;                                   // Completions delivered by their polling thread
+      btUnsigned64bitInt         m_PollBlocked;                                  // Polls that outlasted their spin
+
       typedef std::list<IBase *>          AFUList;
       typedef AFUList::iterator           AFUList_itr;
       typedef AFUList::const_iterator     AFUList_citr;
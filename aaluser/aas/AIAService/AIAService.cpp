@@ -47,6 +47,7 @@
 #include "aalsdk/uaia/AIAService.h"
 #include "aalsdk/aas/AALInProcServiceFactory.h"
 #include "aalsdk/osal/ThreadGroup.h"
+#include "aalsdk/osal/Timer.h"
 
 #include "AIA-internal.h"
 #include "aalsdk/aas/Dispatchables.h"
@@ -98,6 +99,7 @@ class UIDriverEvent : public IUIDriverEvent,
 public:
    UIDriverEvent( IBase *pObject, uidrvMessage * pmessage)
    : CAALEvent(pObject),
+     m_pNext(NULL),
      m_pmessage(pmessage)
    {
       SetInterface( evtUIDriverClientEvent,
@@ -117,8 +119,12 @@ public:
    void                      ResultCode(uid_errnum_e e) { return m_pmessage->result_code(e); }
 
 
+   uidrvMessage *            Message()          { return m_pmessage; }
+
    virtual ~UIDriverEvent() { if(m_pmessage != NULL) delete m_pmessage; }
 
+   UIDriverEvent            *m_pNext;    // Link in a CompletionQueue or the AIA's free list
+
 protected:
    uidrvMessage *m_pmessage;
 
@@ -167,6 +173,13 @@ btBool AIAService::init( IBase *pclientBase,
 
       m_Semaphore.Reset(0);
 
+      // Start the completion delivery threads before anything can be read from the driver.
+      btUnsigned32bitInt NumPumpThreads = AIA_PUMP_THREADS_DEFAULT;
+      if ( optArgs.Has(AIA_NVS_KEY_PUMP_THREADS) ) {
+         optArgs.Get(AIA_NVS_KEY_PUMP_THREADS, &NumPumpThreads);
+      }
+      StartPump(NumPumpThreads);
+
       // Create the Message delivery thread
       m_pMDT = new OSLThread(AIAService::MessageDeliveryThread,
                              OSLThread::THREADPRIORITY_NORMAL,
@@ -276,8 +289,11 @@ void AIAService::AFUProxyGet( IBase *pServiceClient,
 //=============================================================================
 void AIAService::AFUProxyRelease(IBase *pAFUbase)
 {
-   AutoLock(this);
-   AFUListDel(pAFUbase);
+   {
+      AutoLock(this);
+      AFUListDel(pAFUbase);
+   }
+   RetireQueue(dynamic_cast<IAFUProxyClient *>(pAFUbase));
 }
 
 
@@ -374,6 +390,18 @@ void AIAService::UnMapWSID(AAL::btVirtAddr ptr, AAL::btWSSize Size)
    m_uida.UnMapWSID(ptr, Size);
 }
 
+AAL::btBool AIAService::GetSendStats(AAL::NamedValueSet &rStats)
+{
+   if ( !m_uida.GetSendStats(rStats) ) {
+      return false;
+   }
+
+   AutoLock(&m_PumpLock);
+   rStats.Add(AIA_STAT_POLL_INLINE,  m_PollInline);
+   rStats.Add(AIA_STAT_POLL_BLOCKED, m_PollBlocked);
+   return true;
+}
+
 
 
 
@@ -401,6 +429,9 @@ void AIAService::MessageDeliveryThread(OSLThread *pThread,
    // Run the message pump
    This->Process_Event();
 
+   // Nothing more will be queued. Deliver what is left and stop the pump threads.
+   This->StopPump();
+
    // Message pump exited, so AIAService shutting down. Signal that by setting flag.
    This->m_uida.IsOK(false);
 
@@ -427,11 +458,12 @@ void
 AIAService::Process_Event()
 {
 
-   uidrvMessage *pMessage = new uidrvMessage;
+   UIDriverEvent *pEvent = GetFreeEvent();
    AAL_INFO(LM_UAIA, "AIAService::Process_Event. in\n");
 
-   while(m_uida.GetMessage(pMessage) != false) {
+   while(m_uida.GetMessage(pEvent->Message()) != false) {
       AAL_DEBUG(LM_UAIA, "AIAService::Process_Event: GetMessage Returned\n");
+      uidrvMessage *pMessage = pEvent->Message();
       if (pMessage->result_code() != uid_errnumOK) {
          AAL_WARNING(LM_UAIA, "AIAService::Process_Event: pMessage->result_code() is not uid_errnumOK, but is " <<
                   pMessage->result_code() << std::endl);
@@ -439,26 +471,477 @@ AIAService::Process_Event()
 
       if (rspid_UID_Shutdown == pMessage->id()) { // Are we done?
          AAL_INFO(LM_UAIA, "AIAService::Process_Event: Shutdown Seen\n");
-         delete pMessage;
+         PutFreeEvent(pEvent);
          return;
       }else {
 
-         // Generate the event - No need to destroy message as it being passed to event and will be
-         // destroyed there.  TODO - Object should be Proxy not the AIA
-         AFUProxyCallback *pDisp = new AFUProxyCallback(static_cast<IAFUProxyClient *>(pMessage->context()),
-                                                        new UIDriverEvent(this,pMessage));
-         getRuntime()->schedDispatchable(pDisp);
+         // Queue the event to its proxy. It returns to the free list once delivered.
+         //  TODO - Object should be Proxy not the AIA
+         Enqueue(pEvent);
 
-         pMessage = new uidrvMessage;
+         pEvent = GetFreeEvent();
 
       }
    } // while()
 
    // catastrophic failure.  try to clean up after ourself.
-   delete pMessage;
+   PutFreeEvent(pEvent);
 
 } // AIAService::Process_Event
 
+//=============================================================================
+// Name: StartPump
+// Description: Start the completion delivery threads
+// Interface: protected
+// Inputs: NumThreads - number of threads, clamped to [1, AIA_PUMP_THREADS_MAX]
+// Outputs: none.
+//=============================================================================
+void AIAService::StartPump(btUnsignedInt NumThreads)
+{
+   if ( NumThreads < 1 ) {
+      NumThreads = 1;
+   } else if ( NumThreads > AIA_PUMP_THREADS_MAX ) {
+      NumThreads = AIA_PUMP_THREADS_MAX;
+   }
+
+   {
+      AutoLock(&m_PumpLock);
+      m_bPumpStop = false;
+   }
+   m_PumpSem.Reset(0);
+
+   while ( m_PumpThreads.size() < NumThreads ) {
+      m_PumpThreads.push_back(new OSLThread(AIAService::PumpThread,
+                                            OSLThread::THREADPRIORITY_NORMAL,
+                                            this));
+   }
+
+   AAL_INFO(LM_UAIA, "AIAService::StartPump: " << NumThreads << " delivery thread(s)\n");
+}
+
+//=============================================================================
+// Name: StopPump
+// Description: Deliver any queued events, stop the completion delivery threads
+//              and free the completion queues and recycled events.
+// Interface: protected
+// Outputs: none.
+// Comments: Called once the message delivery thread has stopped reading.
+//=============================================================================
+void AIAService::StopPump()
+{
+   {
+      AutoLock(&m_PumpLock);
+      m_bPumpStop = true;
+   }
+
+   // One wake-up per thread. A thread exits when it wakes to find no ready queue.
+   m_PumpSem.Post((btInt)m_PumpThreads.size());
+
+   PumpThreadList::iterator thr;
+   for ( thr = m_PumpThreads.begin() ; m_PumpThreads.end() != thr ; ++thr ) {
+      (*thr)->Join();
+      delete *thr;
+   }
+   m_PumpThreads.clear();
+
+   AutoLock(&m_PumpLock);
+
+   CompletionQueueMap::iterator q;
+   for ( q = m_Queues.begin() ; m_Queues.end() != q ; ++q ) {
+      ASSERT(NULL == (*q).second->m_pHead);
+      delete (*q).second;
+   }
+   m_Queues.clear();
+   m_pReadyHead = m_pReadyTail = NULL;
+
+   while ( NULL != m_pFreeEvents ) {
+      UIDriverEvent *pEvent = m_pFreeEvents;
+      m_pFreeEvents = pEvent->m_pNext;
+      delete pEvent;
+   }
+}
+
+//=============================================================================
+// Name: Enqueue
+// Description: Append an event to its proxy's completion queue, scheduling
+//              the queue on a pump thread if it is idle.
+// Interface: protected
+// Inputs: pEvent - event read from the driver
+// Outputs: none.
+//=============================================================================
+void AIAService::Enqueue(UIDriverEvent *pEvent)
+{
+   IAFUProxyClient *pClient = static_cast<IAFUProxyClient *>(pEvent->Context());
+   ASSERT(NULL != pClient);
+
+   pEvent->m_pNext = NULL;
+
+   {
+      AutoLock(&m_PumpLock);
+
+      CompletionQueue *pQueue = QueueFor(pClient);
+
+      if ( NULL == pQueue->m_pTail ) {
+         pQueue->m_pHead = pEvent;
+      } else {
+         pQueue->m_pTail->m_pNext = pEvent;
+      }
+      pQueue->m_pTail = pEvent;
+
+      if ( pQueue->m_bScheduled ) {
+         // A pump thread already owns this queue and will reach the new event.
+         return;
+      }
+
+      pQueue->m_bScheduled = true;
+      ScheduleQueue(pQueue);
+   }
+
+   m_PumpSem.Post(1);
+}
+
+//=============================================================================
+// Name: QueueFor
+// Description: The completion queue of a proxy client, created on first use.
+// Interface: protected
+// Comments: Called with m_PumpLock held.
+//=============================================================================
+AIAService::CompletionQueue * AIAService::QueueFor(IAFUProxyClient *pClient)
+{
+   CompletionQueueMap::iterator iter = m_Queues.find(pClient);
+   if ( m_Queues.end() != iter ) {
+      return (*iter).second;
+   }
+
+   CompletionQueue *pQueue = new CompletionQueue();
+   m_Queues[pClient] = pQueue;
+   return pQueue;
+}
+
+//=============================================================================
+// Name: RetireQueue
+// Description: Forget the completion queue of a proxy that has unbound, so
+//              that a proxy later created at the same address gets its own.
+// Interface: protected
+// Comments: A queue a thread is draining (the unbind is usually delivered
+//           from it) is deleted by that thread once it is empty.
+//=============================================================================
+void AIAService::RetireQueue(IAFUProxyClient *pClient)
+{
+   AutoLock(&m_PumpLock);
+
+   CompletionQueueMap::iterator iter = m_Queues.find(pClient);
+   if ( m_Queues.end() == iter ) {
+      return;
+   }
+
+   CompletionQueue *pQueue = (*iter).second;
+   m_Queues.erase(iter);
+
+   pQueue->m_bRetired = true;
+   if ( !pQueue->m_bScheduled ) {
+      ASSERT(NULL == pQueue->m_pHead);
+      delete pQueue;
+   }
+}
+
+//=============================================================================
+// Name: ScheduleQueue
+// Description: Append a queue to the ready list. The caller posts m_PumpSem.
+// Interface: protected
+// Comments: Called with m_PumpLock held.
+//=============================================================================
+void AIAService::ScheduleQueue(CompletionQueue *pQueue)
+{
+   pQueue->m_pNextReady = NULL;
+   if ( NULL == m_pReadyTail ) {
+      m_pReadyHead = pQueue;
+   } else {
+      m_pReadyTail->m_pNextReady = pQueue;
+   }
+   m_pReadyTail = pQueue;
+}
+
+//=============================================================================
+// Name: DeliverReady
+// Description: Wait for a ready completion queue and deliver up to
+//              AIA_PUMP_BATCH of its events directly to the proxy.
+// Interface: protected
+// Outputs: false when the pump is stopping and nothing is left to deliver.
+//=============================================================================
+btBool AIAService::DeliverReady()
+{
+   m_PumpSem.Wait();
+
+   CompletionQueue *pQueue;
+   {
+      AutoLock(&m_PumpLock);
+
+      pQueue = m_pReadyHead;
+      if ( NULL == pQueue ) {
+         return !m_bPumpStop;
+      }
+      m_pReadyHead = pQueue->m_pNextReady;
+      if ( NULL == m_pReadyHead ) {
+         m_pReadyTail = NULL;
+      }
+      pQueue->m_pNextReady = NULL;
+   }
+
+   btUnsignedInt n;
+   for ( n = 0 ; ; ++n ) {
+      UIDriverEvent *pEvent;
+      {
+         AutoLock(&m_PumpLock);
+
+         pEvent = pQueue->m_pHead;
+         if ( NULL == pEvent ) {
+            pQueue->m_bScheduled = false;
+            if ( pQueue->m_bRetired ) {
+               delete pQueue;
+            }
+            return true;
+         }
+
+         if ( AIA_PUMP_BATCH == n ) {
+            // Give the other proxies a turn; this queue goes to the back of the ready list.
+            ScheduleQueue(pQueue);
+            m_PumpSem.Post(1);
+            return true;
+         }
+
+         pQueue->m_pHead = pEvent->m_pNext;
+         if ( NULL == pQueue->m_pHead ) {
+            pQueue->m_pTail = NULL;
+         }
+      }
+
+      AFUProxyCallback::Deliver(static_cast<IAFUProxyClient *>(pEvent->Context()), *pEvent);
+      NotifyWaiters(pEvent);
+      PutFreeEvent(pEvent);
+   }
+}
+
+//=============================================================================
+// Name: SendPolledMessage
+// Description: Send a message, then have the calling thread read the driver
+//              and deliver the event that completes it.
+// Interface: public
+// Inputs: devHandle - device handle
+//         pMessage - transaction to send
+//         pClient - proxy client the completion is delivered to
+//         SpinUsec - how long to poll the driver before blocking
+// Outputs: true once the completion has been delivered. false if the send
+//          failed, in which case no completion is awaited.
+// Comments: Only pClient's events are delivered on this thread, and only
+//           when its queue is idle, so its events stay in order. Everything
+//           else read here is queued for the pump threads, which also
+//           deliver the completion if the spin runs out first.
+//=============================================================================
+btBool AIAService::SendPolledMessage(btHANDLE            devHandle,
+                                     IAIATransaction    *pMessage,
+                                     IAFUProxyClient    *pClient,
+                                     btUnsigned32bitInt  SpinUsec)
+{
+   CompletionWaiter waiter(pClient, pMessage->getTranID());
+
+   // Registered before sending, so a pump thread delivering the completion first still finds it.
+   {
+      AutoLock(&m_PumpLock);
+      waiter.m_pNext = m_pWaiters;
+      m_pWaiters     = &waiter;
+   }
+
+   btBool bSent = m_uida.SendMessage(devHandle, pMessage, pClient) &&
+                  ( uid_errnumOK == pMessage->getErrno() );
+
+   if ( bSent ) {
+      Timer              start;
+      btUnsigned64bitInt elapsed = 0;
+      UIDriverEvent     *pEvent  = NULL;
+
+      while ( !waiter.m_bDone ) {
+         if ( NULL == pEvent ) {
+            pEvent = GetFreeEvent();
+         }
+
+         if ( m_uida.TryGetMessage(pEvent->Message()) ) {
+            DeliverPolled(pEvent, pClient);
+            pEvent = NULL;
+            continue;
+         }
+
+         (Timer() - start).AsMicroSeconds(elapsed);
+         if ( elapsed >= SpinUsec ) {
+            break;
+         }
+      }
+
+      if ( NULL != pEvent ) {
+         PutFreeEvent(pEvent);
+      }
+
+      if ( !waiter.m_bDone ) {
+         {
+            AutoLock(&m_PumpLock);
+            ++m_PollBlocked;
+         }
+         waiter.m_Sem.Wait();
+      }
+   }
+
+   AutoLock(&m_PumpLock);
+
+   CompletionWaiter **ppWaiter = &m_pWaiters;
+   while ( &waiter != *ppWaiter ) {
+      ppWaiter = &(*ppWaiter)->m_pNext;
+   }
+   *ppWaiter = waiter.m_pNext;
+
+   return bSent;
+}
+
+//=============================================================================
+// Name: DeliverPolled
+// Description: Deliver an event read by a thread in SendPolledMessage().
+// Interface: protected
+// Inputs: pEvent - event read from the driver
+//         pClient - proxy client of the polling thread
+// Outputs: none.
+// Comments: The polling thread owns pClient's queue while delivering, as a
+//           pump thread would. Events queued meanwhile go to a pump thread.
+//=============================================================================
+void AIAService::DeliverPolled(UIDriverEvent *pEvent, IAFUProxyClient *pClient)
+{
+   if ( static_cast<IAFUProxyClient *>(pEvent->Context()) != pClient ) {
+      Enqueue(pEvent);
+      return;
+   }
+
+   CompletionQueue *pQueue;
+   {
+      AutoLock(&m_PumpLock);
+
+      pQueue = QueueFor(pClient);
+      if ( pQueue->m_bScheduled ) {
+         // A pump thread owns the queue. Keep the event behind the ones it holds.
+         pEvent->m_pNext = NULL;
+         if ( NULL == pQueue->m_pTail ) {
+            pQueue->m_pHead = pEvent;
+         } else {
+            pQueue->m_pTail->m_pNext = pEvent;
+         }
+         pQueue->m_pTail = pEvent;
+         return;
+      }
+      pQueue->m_bScheduled = true;
+      ++m_PollInline;
+   }
+
+   AFUProxyCallback::Deliver(pClient, *pEvent);
+   NotifyWaiters(pEvent);
+   PutFreeEvent(pEvent);
+
+   {
+      AutoLock(&m_PumpLock);
+
+      if ( NULL == pQueue->m_pHead ) {
+         pQueue->m_bScheduled = false;
+         if ( pQueue->m_bRetired ) {
+            delete pQueue;
+         }
+         return;
+      }
+      ScheduleQueue(pQueue);
+   }
+
+   m_PumpSem.Post(1);
+}
+
+//=============================================================================
+// Name: NotifyWaiters
+// Description: Wake the thread in SendPolledMessage() whose transaction the
+//              delivered event completes, if any.
+// Interface: protected
+// Inputs: pEvent - the event, after delivery
+// Outputs: none.
+//=============================================================================
+void AIAService::NotifyWaiters(UIDriverEvent *pEvent)
+{
+   // A waiter registers under m_PumpLock before its message is sent, and the event was
+   //  queued or owned under m_PumpLock since, so an unlocked NULL here means none waits.
+   if ( NULL == m_pWaiters ) {
+      return;
+   }
+
+   IAFUProxyClient         *pClient = static_cast<IAFUProxyClient *>(pEvent->Context());
+   stTransactionID_t const &rTranID = pEvent->msgTranID();
+
+   AutoLock(&m_PumpLock);
+
+   CompletionWaiter *pWaiter;
+   for ( pWaiter = m_pWaiters ; NULL != pWaiter ; pWaiter = pWaiter->m_pNext ) {
+      if ( !pWaiter->m_bDone                                     &&
+           ( pClient           == pWaiter->m_pClient )          &&
+           ( rTranID.m_intID   == pWaiter->m_TranID.m_intID )   &&
+           ( rTranID.m_Context == pWaiter->m_TranID.m_Context ) &&
+           ( rTranID.m_IBase   == pWaiter->m_TranID.m_IBase ) ) {
+         pWaiter->m_bDone = true;
+         pWaiter->m_Sem.Post(1);
+         return;
+      }
+   }
+}
+
+//=============================================================================
+// Name: PumpThread
+// Description: Completion delivery thread
+// Interface: protected
+// Inputs: pThread - thread object
+//         pContext - context
+// Outputs: none.
+//=============================================================================
+void AIAService::PumpThread(OSLThread *pThread,
+                            void *pContext)
+{
+   AIAService *This = (AIAService*)pContext;
+
+   while ( This->DeliverReady() ) {}
+}
+
+//=============================================================================
+// Name: GetFreeEvent
+// Description: Take an event and its message from the free list, or create one.
+// Interface: protected
+//=============================================================================
+UIDriverEvent * AIAService::GetFreeEvent()
+{
+   {
+      AutoLock(&m_PumpLock);
+
+      UIDriverEvent *pEvent = m_pFreeEvents;
+      if ( NULL != pEvent ) {
+         m_pFreeEvents   = pEvent->m_pNext;
+         pEvent->m_pNext = NULL;
+         return pEvent;
+      }
+   }
+
+   return new UIDriverEvent(this, new uidrvMessage);
+}
+
+//=============================================================================
+// Name: PutFreeEvent
+// Description: Return an event and its message to the free list.
+// Interface: protected
+//=============================================================================
+void AIAService::PutFreeEvent(UIDriverEvent *pEvent)
+{
+   AutoLock(&m_PumpLock);
+   pEvent->m_pNext = m_pFreeEvents;
+   m_pFreeEvents   = pEvent;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -118,11 +118,20 @@ btBool ALIAFUProxy::init( IBase *pclientBase,
                                                 "No device handle in Configuration Record!"));
       return true;
     }
+   if( optArgs.Has(AIA_NVS_KEY_POLL_SPIN_USEC) ) {
+      optArgs.Get(AIA_NVS_KEY_POLL_SPIN_USEC, &m_PollSpinUsec);
+   }
+
    // Bind to device and report when we get Bind complete AFU Event,
    //  The first argument to the bind transaction is the Owner (i.e., ProxyClient). This is where
    //  all HW messages will be sent by default.
    BindAFUDevice DeviceMessage(m_pClient, rtid);
-   m_pAIA->SendMessage(m_devHandle, &DeviceMessage, dynamic_cast<IAFUProxyClient*>(this) );
+   if ( 0 != m_PollSpinUsec ) {
+      // Bind complete is delivered, and initComplete() called, before this returns.
+      m_pAIA->SendPolledMessage(m_devHandle, &DeviceMessage, dynamic_cast<IAFUProxyClient*>(this), m_PollSpinUsec);
+   } else {
+      m_pAIA->SendMessage(m_devHandle, &DeviceMessage, dynamic_cast<IAFUProxyClient*>(this) );
+   }
 
    return true;
 }
@@ -141,6 +150,23 @@ btBool ALIAFUProxy::SendTransaction(IAIATransaction *pAFUmessage)
    return true;  /// SendMessage is a void TDO cleanup
 }
 
+//=============================================================================
+// Name: SendPolledTransaction
+// Description: Send a message whose completion arrives as an AFU event, and
+//              deliver that event on this thread if polling is enabled.
+// Inputs: pAFUmessage - Transaction object
+// Outputs: true - the completion has been delivered
+// Comments: Without AIA_NVS_KEY_POLL_SPIN_USEC this is SendTransaction().
+//=============================================================================
+btBool ALIAFUProxy::SendPolledTransaction(IAIATransaction *pAFUmessage)
+{
+   if ( 0 == m_PollSpinUsec ) {
+      SendTransaction(pAFUmessage);
+      return false;
+   }
+   return m_pAIA->SendPolledMessage(m_devHandle, pAFUmessage, m_pClient, m_PollSpinUsec);
+}
+
 
 
 AAL::btBool ALIAFUProxy::MapWSID(AAL::btWSSize Size, AAL::btWSID wsid, AAL::btVirtAddr *pRet, AAL::NamedValueSet const &optArgs)
@@ -153,6 +179,11 @@ void ALIAFUProxy::UnMapWSID(AAL::btVirtAddr ptr, AAL::btWSSize Size)
    m_pAIA->UnMapWSID(ptr, Size);
 }
 
+AAL::btBool ALIAFUProxy::GetTransportStats(AAL::NamedValueSet &rStats)
+{
+   return m_pAIA->GetSendStats(rStats);
+}
+
 
 
 //=============================================================================
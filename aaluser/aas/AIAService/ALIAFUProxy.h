@@ -63,7 +63,8 @@ public:
       m_pClient(NULL),
       m_pAIABase(NULL),
       m_pAIA(NULL),
-      m_devHandle(NULL)
+      m_devHandle(NULL),
+      m_PollSpinUsec(0)
    {
       if ( EObjOK != SetInterface(iidAFUProxy, dynamic_cast<IAFUProxy *>(this)) ) {
          m_bIsOK = false;         // CAASBase set it to true
@@ -82,6 +83,7 @@ public:
 
    // Send a message to the device
    AAL::btBool SendTransaction( IAIATransaction *pAFUmessage);
+   AAL::btBool SendPolledTransaction( IAIATransaction *pAFUmessage);
 
    // Map/Unmap Workspace IDs to virtual memory addresses
    AAL::btBool MapWSID(AAL::btWSSize             Size,
@@ -90,6 +92,8 @@ public:
                        AAL::NamedValueSet const &optArgs = AAL::NamedValueSet());
    void UnMapWSID(AAL::btVirtAddr ptr, AAL::btWSSize Size);
 
+   AAL::btBool GetTransportStats(AAL::NamedValueSet &rStats);
+
 
 protected:
    void AFUEvent( AAL::IEvent const &theEvent);
@@ -100,6 +104,7 @@ protected:
    AAL::IBase            *m_pAIABase;
    AIAService            *m_pAIA;
    btHANDLE               m_devHandle;
+   btUnsigned32bitInt     m_PollSpinUsec;   // AIA_NVS_KEY_POLL_SPIN_USEC. 0 when not polling.
 };
 
 END_NAMESPACE(AAL)
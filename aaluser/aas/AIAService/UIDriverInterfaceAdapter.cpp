@@ -45,8 +45,14 @@
 #include "aalsdk/AALLoggerExtern.h"
 #include "aalsdk/kernel/ccipdriver.h"
 
+#include "aalsdk/osal/Timer.h"
+
 #include "UIDriverInterfaceAdapter.h"
 
+#if defined( __AAL_LINUX__ )
+# include <sys/eventfd.h>
+#endif // __AAL_LINUX__
+
 BEGIN_NAMESPACE(AAL)
 
 btBool UIDriverInterfaceAdapter::MapWSID(btWSSize Size, btWSID wsid, btVirtAddr *pRet, AAL::NamedValueSet const &optArgs)
@@ -140,8 +146,18 @@ UIDriverInterfaceAdapter::UIDriverInterfaceAdapter() :
    m_hClient(INVALID_HANDLE_VALUE),
 #elif defined( __AAL_LINUX__ )
    m_fdClient(-1),
+   m_fdWake(-1),
+   m_pMsgBatch(NULL),
+   m_MsgBatchSize(0),
+   m_MsgBatchNext(0),
+   m_MsgBatchCount(0),
 #endif // OS
-   m_bIsOK(false)
+   m_bIsOK(false),
+   m_pSendBuf(NULL),
+   m_SendBufSize(0),
+   m_SendCount(0),
+   m_SendNsecTotal(0),
+   m_SendNsecMax(0)
 {}
 
 //==========================================================================
@@ -158,8 +174,17 @@ UIDriverInterfaceAdapter::~UIDriverInterfaceAdapter()
    if ( m_fdClient >= 0 ) {
       Close();
    }
+   if ( NULL != m_pMsgBatch ) {
+      delete[] m_pMsgBatch;
+      m_pMsgBatch = NULL;
+   }
 #endif // OS
 
+   if ( NULL != m_pSendBuf ) {
+      delete[] m_pSendBuf;
+      m_pSendBuf = NULL;
+   }
+
    m_bIsOK = false;
 }
 
@@ -316,6 +341,14 @@ void UIDriverInterfaceAdapter::Open(const char *devName)
       return;
    }
 
+   m_fdWake = eventfd(0, EFD_NONBLOCK);
+   if ( -1 == m_fdWake ) {
+      close(m_fdClient);
+      m_fdClient = -1;
+      m_bIsOK    = false;
+      return;
+   }
+
 #endif // OS
 
    m_bIsOK = true;
@@ -341,6 +374,11 @@ void UIDriverInterfaceAdapter::Close() {
       m_fdClient = -1;
       m_bIsOK    = false;
    }
+   if ( m_fdWake >= 0 ) {
+      close(m_fdWake);
+      m_fdWake = -1;
+   }
+   m_MsgBatchCount = 0;
 
 #endif // OS
 }  // UIDriverInterfaceAdapter::Close
@@ -348,19 +386,18 @@ void UIDriverInterfaceAdapter::Close() {
 //==========================================================================
 // Name: GetMessage
 // Description: Polls for messages and returns when one is available
-// Comment:
+// Comment: On Linux a burst of queued messages is fetched with one
+//          AALUID_IOCTL_GETMSGS and handed out on subsequent calls.
 //==========================================================================
 btBool UIDriverInterfaceAdapter::GetMessage(uidrvMessage *uidrvMessagep)
 {
 
-   struct ccipui_ioctlreq ioctlMessage;
-
-
    if ( !IsOK() ) {
       return false;
    }
 
 #if   defined( __AAL_WINDOWS__ )
+   struct ccipui_ioctlreq ioctlMessage;
    btHANDLE     hEvent;
    DWORD      	bytes;
    OVERLAPPED 	overlappedIO;
@@ -368,10 +405,12 @@ btBool UIDriverInterfaceAdapter::GetMessage(uidrvMessage *uidrvMessagep)
 #elif defined( __AAL_LINUX__ )
 
    btInt         ret = 0;
-   struct pollfd pollfds[1];
+   struct pollfd pollfds[2];
 
    pollfds[0].fd     = m_fdClient;
    pollfds[0].events = POLLPRI;
+   pollfds[1].fd     = m_fdWake;
+   pollfds[1].events = POLLIN;
 
 #endif // OS
 
@@ -469,46 +508,155 @@ FAILED: // If got here then DeviceIoControl failed.
 
 #elif defined( __AAL_LINUX__ )
 
-   // Break out of the while with a return
-   do
-   {
+   for ( ; ; ) {
       {
          AutoLock(this);
 
-         // Check for messages first
-         memset(&ioctlMessage,0, sizeof(struct ccipui_ioctlreq));
-         if( ( ret = ioctl(m_fdClient, AALUID_IOCTL_GETMSG_DESC, &ioctlMessage) ) == 0 ) {
-
-            uidrvMessagep->size(ioctlMessage.size);
-
-            // Get the message -
-            if( ioctl(m_fdClient, AALUID_IOCTL_GETMSG, uidrvMessagep->GetReqp()) == -1 ) {
+         // Messages left over from the last fetch are returned first.
+         if ( 0 == m_MsgBatchCount ) {
+            ret = FetchMessages();
+            if ( ret < 0 ) {
                goto FAILED;
             }
+         }
 
+         if ( m_MsgBatchCount > 0 ) {
+            NextBatchedMessage(uidrvMessagep);
             return true;
          }
-
       }
 
       AAL_VERBOSE(LM_UAIA, "UIDriverInterfaceAdapter::GetMessage: About to wait" << std::endl);
 
-      ret = poll(pollfds, 1, -1);
-      if ( ret != 1 ) {   // expect a 1 here, generally
-         AAL_DEBUG(LM_UAIA, "UIDriverInterfaceAdapter::GetMessage: Returned value from poll() is not 1 as expected, but " << ret << std::endl);
+      ret = poll(pollfds, 2, -1);
+      if ( ( ret < 0 ) && ( EINTR != errno ) ) {
+         goto FAILED;
       }
 
-   // TODO: HM 20090605 Joe and I both think this logic is buggy. Revisit.
-   } while( ( 0 == ret ) || ( -EAGAIN != ret ) );
+      if ( ( ret > 0 ) && ( 0 != ( pollfds[1].revents & POLLIN ) ) ) {
+         eventfd_t count;
+         eventfd_read(m_fdWake, &count);
+      }
+   }
 
-FAILED: // If got here then the poll failed
-   perror("UIDriverInterfaceAdapter::GetMessage:poll");
+FAILED: // If got here then the fetch or the poll failed
+   perror("UIDriverInterfaceAdapter::GetMessage");
    return false;
 
 #endif // OS
 
 }  // UIDriverInterfaceAdapter::GetMessage
 
+//==========================================================================
+// Name: TryGetMessage
+// Description: Returns a message if one is queued, without waiting
+// Comment: Lets a thread waiting on its own completion read the driver
+//          alongside the message delivery thread. Messages left in the
+//          batch, including rspid_UID_Shutdown which is never returned
+//          here, wake GetMessage() to collect them.
+//==========================================================================
+btBool UIDriverInterfaceAdapter::TryGetMessage(uidrvMessage *uidrvMessagep)
+{
+   if ( !IsOK() ) {
+      return false;
+   }
+
+#if   defined( __AAL_WINDOWS__ )
+
+   // Completions are only read by the message delivery thread.
+   return false;
+
+#elif defined( __AAL_LINUX__ )
+
+   AutoLock(this);
+
+   if ( 0 == m_MsgBatchCount ) {
+      if ( FetchMessages() <= 0 ) {
+         return false;
+      }
+   }
+
+   struct ccipui_ioctlreq *prec = reinterpret_cast<struct ccipui_ioctlreq *>(m_pMsgBatch + m_MsgBatchNext);
+   if ( rspid_UID_Shutdown == prec->id ) {
+      eventfd_write(m_fdWake, 1);
+      return false;
+   }
+
+   NextBatchedMessage(uidrvMessagep);
+
+   if ( m_MsgBatchCount > 0 ) {
+      // The caller may stop taking messages before the rest are out.
+      eventfd_write(m_fdWake, 1);
+   }
+   return true;
+
+#endif // OS
+
+}  // UIDriverInterfaceAdapter::TryGetMessage
+
+#if defined( __AAL_LINUX__ )
+//==========================================================================
+// Name: FetchMessages
+// Description: Retrieves every queued message that fits in the batch buffer
+//              with a single AALUID_IOCTL_GETMSGS. Called with the lock held.
+//==========================================================================
+btInt UIDriverInterfaceAdapter::FetchMessages()
+{
+   if ( NULL == m_pMsgBatch ) {
+      m_MsgBatchSize = UIDRV_MSGBATCH_SIZE;
+      m_pMsgBatch    = new btByte[m_MsgBatchSize];
+   }
+
+   for ( ; ; ) {
+      struct ccipui_ioctlreq *preq   = reinterpret_cast<struct ccipui_ioctlreq *>(m_pMsgBatch);
+      struct ccipui_msgbatch *pbatch = reinterpret_cast<struct ccipui_msgbatch *>(preq->payload);
+
+      memset(preq, 0, sizeof(struct ccipui_ioctlreq) + sizeof(struct ccipui_msgbatch));
+      preq->size = m_MsgBatchSize - sizeof(struct ccipui_ioctlreq);
+
+      if ( -1 == ioctl(m_fdClient, AALUID_IOCTL_GETMSGS, preq) ) {
+         return ( EAGAIN == errno ) ? 0 : -1;
+      }
+
+      if ( pbatch->count > 0 ) {
+         m_MsgBatchNext  = sizeof(struct ccipui_ioctlreq) + sizeof(struct ccipui_msgbatch);
+         m_MsgBatchCount = pbatch->count;
+         return (btInt)m_MsgBatchCount;
+      }
+
+      if ( pbatch->needed <= preq->size ) {
+         // Nothing returned but nothing too large either.
+         return -1;
+      }
+
+      // The next message does not fit. Grow the buffer and try again.
+      AAL_DEBUG(LM_UAIA, "UIDriverInterfaceAdapter::FetchMessages: growing batch buffer to " <<
+                         sizeof(struct ccipui_ioctlreq) + pbatch->needed << " bytes" << std::endl);
+      m_MsgBatchSize = sizeof(struct ccipui_ioctlreq) + pbatch->needed;
+      delete[] m_pMsgBatch;
+      m_pMsgBatch = new btByte[m_MsgBatchSize];
+   }
+}
+
+//==========================================================================
+// Name: NextBatchedMessage
+// Description: Copies the next fetched message into uidrvMessagep.
+//              Called with the lock held.
+//==========================================================================
+void UIDriverInterfaceAdapter::NextBatchedMessage(uidrvMessage *uidrvMessagep)
+{
+   ASSERT(m_MsgBatchCount > 0);
+
+   struct ccipui_ioctlreq *prec = reinterpret_cast<struct ccipui_ioctlreq *>(m_pMsgBatch + m_MsgBatchNext);
+
+   uidrvMessagep->size(prec->size);
+   memcpy(uidrvMessagep->GetReqp(), prec, sizeof(struct ccipui_ioctlreq) + (size_t)prec->size);
+
+   m_MsgBatchNext += ccipui_msgrec_size(prec->size);
+   --m_MsgBatchCount;
+}
+#endif // __AAL_LINUX__
+
 
 //==========================================================================
 // Name: SendMessage
@@ -558,17 +706,34 @@ btBool UIDriverInterfaceAdapter::SendMessage(AAL::btHANDLE devHandle,
          break;
    }
 
-   // Build the low level message
-   struct ccipui_ioctlreq *reqp = reinterpret_cast<struct ccipui_ioctlreq *> (new char[ sizeof(struct ccipui_ioctlreq) + pMessage->getPayloadSize() ]);
+   Timer start;
+
+   // Send the transaction's own envelope if it has one. Otherwise build the
+   //  low level message in the reusable send buffer.
+   struct ccipui_ioctlreq *reqp = pMessage->getIoctlReq();
+   if ( NULL == reqp ) {
+      btWSSize ReqSize = sizeof(struct ccipui_ioctlreq) + pMessage->getPayloadSize();
+      if ( ReqSize > m_SendBufSize ) {
+         if ( NULL != m_pSendBuf ) {
+            delete[] m_pSendBuf;
+         }
+         m_pSendBuf    = new btByte[ReqSize];
+         m_SendBufSize = ReqSize;
+      }
+      reqp = reinterpret_cast<struct ccipui_ioctlreq *>(m_pSendBuf);
+
+      memcpy(aalui_ioctlPayload(reqp), pMessage->getPayloadPtr(), pMessage->getPayloadSize());
+   } else {
+      ASSERT(aalui_ioctlPayload(reqp) == pMessage->getPayloadPtr());
+   }
 
    reqp->id = pMessage->getMsgID();
    reqp->tranID = pMessage->getTranID();
    reqp->handle = devHandle;
    reqp->context = pProxyClient;
+   reqp->errcode = uid_errnumOK;
    reqp->size = pMessage->getPayloadSize();
 
-   memcpy(aalui_ioctlPayload(reqp), pMessage->getPayloadPtr(), pMessage->getPayloadSize());
-
 
 #if   defined( __AAL_WINDOWS__ )
    DWORD      bytes,bytes_to_send;
@@ -601,16 +766,38 @@ btBool UIDriverInterfaceAdapter::SendMessage(AAL::btHANDLE devHandle,
 
    pMessage->setErrno(reqp->errcode);
 
-   // Atomic operations return data in payload so if it's there copy back into the transaction
-   if(reqp->size != 0) {
+   // Atomic operations return data in payload so if it's there copy back into the transaction.
+   //  An in-place envelope already holds it.
+   if ( ( reqp->size != 0 ) && ( reqp != pMessage->getIoctlReq() ) ) {
       // Copy the response back into the transaction
       memcpy(pMessage->getPayloadPtr(), aalui_ioctlPayload(reqp),  pMessage->getPayloadSize());
    }
 #endif // OS
 
-   delete [] reqp;
+   btUnsigned64bitInt nsec = 0;
+   (Timer() - start).AsNanoSeconds(nsec);
+   ++m_SendCount;
+   m_SendNsecTotal += nsec;
+   if ( nsec > m_SendNsecMax ) {
+      m_SendNsecMax = nsec;
+   }
+
    return true;
 }  // UIDriverInterfaceAdapter::SendMessage
 
+//==========================================================================
+// Name: GetSendStats
+// Description: Reports the SendMessage() latency counters
+//==========================================================================
+btBool UIDriverInterfaceAdapter::GetSendStats(NamedValueSet &rStats)
+{
+   AutoLock(this);
+
+   rStats.Add(AIA_STAT_SEND_COUNT,      m_SendCount);
+   rStats.Add(AIA_STAT_SEND_NSEC_TOTAL, m_SendNsecTotal);
+   rStats.Add(AIA_STAT_SEND_NSEC_MAX,   m_SendNsecMax);
+   return true;
+}
+
 END_NAMESPACE(AAL)
 
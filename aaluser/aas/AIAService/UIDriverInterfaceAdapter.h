@@ -61,6 +61,11 @@
 #define ALI_MMAP_TARGET_VADDR "ALIMmapTargetVAddr"
 #endif
 
+/// Initial size of the buffer GetMessage() fetches driver messages into. Grown as needed.
+/// The driver allocates a zeroed response buffer of this size on every fetch, so keep it
+/// to one page: a larger one is a high-order allocation that can fail on a fragmented system.
+#define UIDRV_MSGBATCH_SIZE (4 * 1024)
+
 BEGIN_NAMESPACE(AAL)
 
 //==========================================================================
@@ -88,12 +93,18 @@ class AIASERVICE_API UIDriverInterfaceAdapter : private CriticalSection,
 
       // Polls for messages and returns when one is available
       AAL::btBool GetMessage(uidrvMessage *uidrvMessagep);
+      // Returns a queued message without waiting, or false if none is ready. Never
+      //  returns rspid_UID_Shutdown, which is left for GetMessage().
+      AAL::btBool TryGetMessage(uidrvMessage *uidrvMessagep);
 
       // Sends a message down the UIDriver channel
       AAL::btBool SendMessage( AAL::btHANDLE devHandle,
                                IAIATransaction *pMessage,
                                IAFUProxyClient *pProxyClient);
 
+      // Send latency counters, keyed by AIA_STAT_*
+      AAL::btBool GetSendStats(AAL::NamedValueSet &rStats);
+
 
 
 
@@ -102,10 +113,30 @@ class AIASERVICE_API UIDriverInterfaceAdapter : private CriticalSection,
       HANDLE m_hClient;
       #elif defined( __AAL_LINUX__ )
       AAL::btInt  m_fdClient;
+      AAL::btInt  m_fdWake;                            // eventfd waking GetMessage() for messages TryGetMessage() left behind
+
+      // Drain the driver's message queue into m_pMsgBatch with one AALUID_IOCTL_GETMSGS.
+      //  Returns the number of messages fetched, 0 if none are queued, -1 on error.
+      AAL::btInt FetchMessages();
+      // Copy the next fetched message out of m_pMsgBatch.
+      void NextBatchedMessage(uidrvMessage *uidrvMessagep);
+
+      AAL::btByte      *m_pMsgBatch;                   // ccipui_ioctlreq + ccipui_msgbatch
+      AAL::btWSSize     m_MsgBatchSize;
+      AAL::btWSSize     m_MsgBatchNext;                // Offset of the next message record
+      AAL::btUnsignedInt m_MsgBatchCount;              // Fetched messages not yet returned
       #endif // OS
 
       AAL::btBool m_bIsOK;
 
+      // Request envelope for transactions that do not provide their own. Reused under the lock.
+      AAL::btByte             *m_pSendBuf;
+      AAL::btWSSize            m_SendBufSize;
+
+      AAL::btUnsigned64bitInt  m_SendCount;
+      AAL::btUnsigned64bitInt  m_SendNsecTotal;
+      AAL::btUnsigned64bitInt  m_SendNsecMax;
+
 }; // class UIDriverInterfaceAdapter{}
 
 END_NAMESPACE(AAL)
@@ -51,24 +51,31 @@
 BEGIN_NAMESPACE(AAL)
 
 uidrvMessage::uidrvMessage() :
-   m_pmessage(NULL)
+   m_pmessage(NULL),
+   m_msgsize(0),
+   m_capacity(0)
 {}
 
 uidrvMessage::~uidrvMessage()
 {
    if ( NULL != m_pmessage ) {
-      delete m_pmessage;
+      delete[] reinterpret_cast<btByte *>(m_pmessage);
       m_pmessage = NULL;
    }
 }
 
 void uidrvMessage::size(btWSSize PayloadSize)
 {
-   if ( NULL != m_pmessage ) {
-      delete m_pmessage;
+   m_msgsize = (btUnsignedInt)PayloadSize + sizeof(ccipui_ioctlreq);
+
+   // Recycled messages keep their buffer unless it is too small.
+   if ( m_msgsize > m_capacity ) {
+      if ( NULL != m_pmessage ) {
+         delete[] reinterpret_cast<btByte *>(m_pmessage);
+      }
+      m_pmessage = (struct ccipui_ioctlreq*)new btByte[m_msgsize];
+      m_capacity = m_msgsize;
    }
-   m_msgsize  = (btUnsignedInt)PayloadSize + sizeof(ccipui_ioctlreq);
-   m_pmessage = (struct ccipui_ioctlreq*)new btByte[m_msgsize];
    memset(m_pmessage, 0, m_msgsize);
    m_pmessage->size = PayloadSize;
 }
@@ -61,7 +61,7 @@ public:
    uidrvMessage();
    virtual ~uidrvMessage();
 
-   // size mutator (allocates m_payload)
+   // size mutator (allocates m_payload, reusing the current buffer when it is large enough)
    void size(btWSSize PayloadSize);
    // result_code mutator
    void result_code(uid_errnum_e e) {ASSERT(NULL != m_pmessage); m_pmessage->errcode = e; }
@@ -82,6 +82,7 @@ public:
 protected:
    struct ccipui_ioctlreq *m_pmessage;
    btWSSize        m_msgsize;
+   btWSSize        m_capacity;
 
 }; // end of class uidrvMessage
 
@@ -47,8 +47,7 @@
 #endif // __AAL_UNKNOWN_OS__
 
 #if defined( __AAL_LINUX__ )
-# include <errno.h>
-# include <sys/time.h>
+# include "_SyncPrimitives.h"
 #endif // __AAL_LINUX__
 
 #ifdef DBG_BARRIER
@@ -62,6 +61,8 @@
 # define AutoLock5(__x) AutoLock(__x)
 # define AutoLock6(__x) AutoLock(__x)
 # define AutoLock7(__x) AutoLock(__x)
+# define FastPath6()
+# define FastPath7()
 # if   defined( __AAL_LINUX__ )
 #    define _PThreadCondWait0             _PThreadCondWait
 #    define _PThreadCondTimedWait1        _PThreadCondTimedWait
@@ -84,6 +85,7 @@ Barrier::Barrier() :
    m_UnlockCount(0),
    m_CurCount(0),
    m_UserDefined(NULL),
+   m_SpinCount(0),
    m_AutoResetManager(this)
 #if defined( __AAL_WINDOWS__ )
    , m_hEvent(NULL)
@@ -132,7 +134,7 @@ btBool Barrier::Create(btUnsignedInt UnlockCount, btBool bAutoReset)
    
 #elif defined( __AAL_LINUX__ )
    
-   if ( 0 != pthread_cond_init(&m_condition, NULL) ) {
+   if ( 0 != MonotonicCondInit(&m_condition) ) {
       return false;
    }
    
@@ -346,6 +348,11 @@ btBool Barrier::UnblockAll()
 
    flag_setf(m_Flags, BARRIER_FLAG_UNBLOCKING);
 
+#if defined( __AAL_LINUX__ )
+   // Wait() checks the flags, then the count, without the lock. Publish the flag first.
+   __sync_synchronize();
+#endif // __AAL_LINUX__
+
    m_CurCount = m_UnlockCount;
 
 #if   defined( __AAL_LINUX__ )
@@ -387,6 +394,18 @@ btObjectType Barrier::UserDefined() const
    return m_UserDefined;
 }
 
+void Barrier::SpinCount(btUnsignedInt nSpins)
+{
+   AutoLock(this);
+   m_SpinCount = nSpins;
+}
+
+btUnsignedInt Barrier::SpinCount() const
+{
+   AutoLock(this);
+   return m_SpinCount;
+}
+
 Barrier::AutoResetManager::AutoResetManager(Barrier *pBarrier) :
    m_pBarrier(pBarrier),
    m_NumWaiters(0),
@@ -423,10 +442,10 @@ void Barrier::AutoResetManager::Create()
 
    int res;
 
-   res = pthread_cond_init(&m_Rcondition, NULL);
+   res = MonotonicCondInit(&m_Rcondition);
    ASSERT(0 == res);
 
-   res = pthread_cond_init(&m_Zcondition, NULL);
+   res = MonotonicCondInit(&m_Zcondition);
    ASSERT(0 == res);
 
 #endif // OS
@@ -508,16 +527,8 @@ void Barrier::AutoResetManager::WaitForAutoResetCompletion(CriticalSection *pCS,
    }
 
 #if defined( __AAL_LINUX__ )
-   struct timeval tv;
-   gettimeofday(&tv, NULL);
-
    struct timespec ts;
-
-   ts.tv_sec  = tv.tv_sec;
-   ts.tv_nsec = (tv.tv_usec * 1000) + (Timeout * 1000000);
-
-   ts.tv_sec  += ts.tv_nsec / 1000000000;
-   ts.tv_nsec %= 1000000000;
+   MonotonicDeadline(&ts, Timeout);
 #endif // __AAL_LINUX__
 
    while ( flags_are_set(m_pBarrier->m_Flags, BARRIER_FLAG_AUTO_RESET|BARRIER_FLAG_RESETTING) ) {
@@ -677,19 +688,12 @@ void Barrier::AutoResetManager::WaitForAllWaitersToExit(CriticalSection *pCS)
 
 #if defined( __AAL_LINUX__ )
 
-   struct timeval  tv;
    struct timespec ts;
 
    while ( ( m_NumWaiters + m_NumPreWaiters ) > 0 ) {
       // Wait for the last waiter to call RemoveWaiter().
 
-      gettimeofday(&tv, NULL);
-
-      ts.tv_sec  = tv.tv_sec;
-      ts.tv_nsec = (tv.tv_usec * 1000) + (Timeout * 1000000);
-
-      ts.tv_sec  += ts.tv_nsec / 1000000000;
-      ts.tv_nsec %= 1000000000;
+      MonotonicDeadline(&ts, Timeout);
 
       {
          _PThreadCondTimedWait wait(pCS, &m_Zcondition, &ts);
@@ -713,6 +717,61 @@ void Barrier::AutoResetManager::WaitForAllWaitersToExit(CriticalSection *pCS)
 
 #if defined( __AAL_LINUX__ )
 
+//=============================================================================
+// Name: IsOpen
+// Description: Lock-free check for an unlocked manual-reset Barrier.
+// Interface: private
+// Inputs: none.
+// Returns: true if a Wait() call would return true without blocking.
+// Comments: An auto-reset Barrier must account for each waiter, so it always
+//           takes the locked path. UnblockAll() sets its flag before it raises
+//           the count, so the flags are checked on both sides of the count.
+//=============================================================================
+btBool Barrier::IsOpen() const
+{
+   if ( BARRIER_FLAG_INIT != SyncLoad(&m_Flags) ) {
+      return false;
+   }
+
+   if ( SyncLoad(&m_CurCount) < SyncLoad(&m_UnlockCount) ) {
+      return false;
+   }
+
+   return BARRIER_FLAG_INIT == SyncLoad(&m_Flags);
+}
+
+//=============================================================================
+// Name: TryWait
+// Description: Wait() fast path, taken before the internal lock.
+// Interface: private
+// Inputs: none.
+// Returns: true if the Barrier is open.
+// Comments: A locked manual-reset Barrier is polled up to m_SpinCount more
+//           times before giving up, when there is more than one CPU.
+//=============================================================================
+btBool Barrier::TryWait() const
+{
+   if ( IsOpen() ) {
+      return true;
+   }
+
+   if ( flag_is_set(SyncLoad(&m_Flags), BARRIER_FLAG_AUTO_RESET) ) {
+      return false;
+   }
+
+   btUnsignedInt       i;
+   const btUnsignedInt Spins = SyncSpinUseful() ? SyncLoad(&m_SpinCount) : 0;
+
+   for ( i = 0 ; i < Spins ; ++i ) {
+      SyncCpuRelax();
+      if ( IsOpen() ) {
+         return true;
+      }
+   }
+
+   return false;
+}
+
 //=============================================================================
 // Name: Wait
 // Description: Block infinitely until the current count becomes equal to the unlock count.
@@ -723,6 +782,11 @@ void Barrier::AutoResetManager::WaitForAllWaitersToExit(CriticalSection *pCS)
 //=============================================================================
 btBool Barrier::Wait()
 {
+   if ( TryWait() ) {
+      FastPath6();
+      return true;
+   }
+
    AutoLock6(this);
    
    if ( flag_is_clr(m_Flags, BARRIER_FLAG_INIT) ||
@@ -773,6 +837,14 @@ btBool Barrier::Wait(btTime Timeout) // milliseconds
       return Wait();
    }
 
+   struct timespec ts;
+   MonotonicDeadline(&ts, Timeout);
+
+   if ( TryWait() ) {
+      FastPath7();
+      return true;
+   }
+
    AutoLock7(this);
 
    if ( flag_is_clr(m_Flags, BARRIER_FLAG_INIT) ||
@@ -782,17 +854,6 @@ btBool Barrier::Wait(btTime Timeout) // milliseconds
       return false;
    }
 
-   struct timeval tv;
-   gettimeofday(&tv, NULL);
-
-   struct timespec ts;
-
-   ts.tv_sec  = tv.tv_sec;
-   ts.tv_nsec = (tv.tv_usec * 1000) + (Timeout * 1000000);
-
-   ts.tv_sec  += ts.tv_nsec / 1000000000;
-   ts.tv_nsec %= 1000000000;
-
    btBool res = true;
 
    m_AutoResetManager.AddWaiter(this);
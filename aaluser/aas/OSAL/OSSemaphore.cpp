@@ -64,8 +64,7 @@
 #endif // __AAL_UNKNOWN_OS__
 
 #if defined( __AAL_LINUX__ )
-# include <errno.h>
-# include <sys/time.h>
+# include "_SyncPrimitives.h"
 #endif // OS
 
 #ifdef DBG_CSEMAPHORE
@@ -79,6 +78,9 @@
 # define AutoLock5(__x) AutoLock(__x)
 # define AutoLock6(__x) AutoLock(__x)
 # define AutoLock7(__x) AutoLock(__x)
+# define FastPath4()
+# define FastPath6()
+# define FastPath7()
 #endif // DBG_CSEMAPHORE
 
 BEGIN_NAMESPACE(AAL)
@@ -94,9 +96,12 @@ CSemaphore::CSemaphore() :
    m_MaxCount(0),
    m_CurCount(0),
    m_WaitCount(0),
-   m_UserDefined(NULL)
+   m_UserDefined(NULL),
+   m_SpinCount(0)
 #if   defined( __AAL_WINDOWS__ )
    , m_hEvent(NULL)
+#elif defined( __AAL_LINUX__ )
+   , m_Seq(0)
 #endif // OS
 {}
 
@@ -119,8 +124,9 @@ CSemaphore::~CSemaphore()
 // Inputs: int nInitialCount - Initial count could be negative to count up
 //         unsigned int nMaxCount - Must be a positive number.
 // Outputs:
-// Comments: Uses Mutexs to implement semaphores to implement count up
-//           functionality
+// Comments: On Linux, the count is manipulated with atomic operations and
+//           blocked waiters sleep on a futex. Elsewhere, the count is
+//           protected by the internal lock.
 //=============================================================================
 btBool CSemaphore::Create(btInt nInitialCount, btUnsignedInt nMaxCount)
 {
@@ -132,7 +138,7 @@ btBool CSemaphore::Create(btInt nInitialCount, btUnsignedInt nMaxCount)
       return false;
    }
 
-#if   defined( __AAL_WINDOWS__ )
+#if defined( __AAL_WINDOWS__ )
    m_hEvent = CreateEvent(NULL,  // Default security attributes, no inheritance.
                           true,  // Manual reset event.
                           false, // Not signaled.
@@ -141,11 +147,7 @@ btBool CSemaphore::Create(btInt nInitialCount, btUnsignedInt nMaxCount)
    if ( NULL == m_hEvent ) {
       return false;
    }
-#elif defined( __AAL_LINUX__ )
-   if ( pthread_cond_init(&m_condition, NULL) ) {
-      return false;
-   }
-#endif // OS
+#endif // __AAL_WINDOWS__
 
    if ( nInitialCount < 0 ) {
       // count up sem
@@ -203,9 +205,6 @@ btBool CSemaphore::Destroy()
       res = ( 0 != CloseHandle(m_hEvent) );
 #elif defined( __AAL_LINUX__ )
       res = true;
-      if ( 0 != pthread_cond_destroy(&m_condition) ) {
-         res = false;
-      }
 #endif // OS
 
       // No longer initialized.
@@ -242,16 +241,17 @@ btBool CSemaphore::Reset(btInt nCount)
       return false;
    }
 
-   m_CurCount = nCount;
-
    // Increment the current count if it is negative
    //  so that nInitialCount Posts will make count == 1 (not zero)
    //  So if CurCount is -2 making it -1 will result in 2 Posts() bring the semaphore to
    //  a positive 1 and unblocking as we would expect.
-   if ( m_CurCount < 0 ) {
-      m_CurCount++;
+   // The count is stored once, because Post() and Wait() may read it without the lock.
+   if ( nCount < 0 ) {
+      nCount++;
    }
 
+   m_CurCount = nCount;
+
 #ifdef __AAL_WINDOWS__
    if ( m_CurCount <= 0 ) {
       // Cause new waiters to block. (manual reset event)
@@ -287,50 +287,78 @@ btBool CSemaphore::CurrCounts(btInt &rcurrCount, btInt &rmaxCount)
 }
 
 
+//=============================================================================
+// Name: NumWaiters
+// Description: Returns the current number of waiters.
+// NOTE: This is a snapshot and may change by the time the
+//       caller examines the value
+// Interface: public
+// Inputs: none.
+// Returns: Current number of waiters
+// Comments:
+//=============================================================================
+btUnsignedInt CSemaphore::NumWaiters()
+{
+   AutoLock(this);
+   return m_WaitCount;
+}
+
+
+#ifdef __AAL_LINUX__
+
+// The waiter count is read without the lock by Post(), so it is updated atomically.
+#define ADD_WAITER() SyncAdd(&m_WaitCount, (btUnsignedInt)1)
+#define DEL_WAITER()                                          \
+do                                                            \
+{                                                             \
+   if ( 0 == SyncAdd(&m_WaitCount, (btUnsignedInt)-1) ) {    \
+      flag_clrf(m_State, SEM_ST_UNBLOCKED);                   \
+   }                                                          \
+}while(0)
+
 //=============================================================================
 // Name: Post
 // Description:
 // Interface: public
 // Inputs: none.
 // Outputs:
-// Comments:
+// Comments: Lock-free. The count is updated with compare-and-swap, and the
+//           futex is touched only when a waiter is asleep on it.
 //=============================================================================
 btBool CSemaphore::Post(btInt nCount)
 {
-   AutoLock4(this);
+   FastPath4();
 
-   if ( flag_is_clr(m_State, SEM_ST_OK) ) {
+   if ( flag_is_clr(SyncLoad(&m_State), SEM_ST_OK) ) {
       // Not initialized.
       return false;
    }
 
-   // Can't post such that you exceed MaxCount
-   if ( ( m_CurCount + nCount ) > m_MaxCount ) {
-      return false;
-   }
-
-   // Calculate new count and determine if we need to signal.
-   m_CurCount += nCount;
-
-   if ( m_CurCount > 0 ) {
-
-#if   defined( __AAL_LINUX__ )
+   const btInt MaxCount = SyncLoad(&m_MaxCount);
+   btInt       Cur      = SyncLoad(&m_CurCount);
+   btInt       Prev;
 
-      if ( 1 == m_CurCount ) {
-         // Release 1 (or at least minimal) thread
-         pthread_cond_signal(&m_condition);      // Signal
-      } else {
-         // Release all waiting threads
-         pthread_cond_broadcast(&m_condition);      // Signal
+   for ( ;; ) {
+      // Can't post such that you exceed MaxCount
+      if ( ( Cur + nCount ) > MaxCount ) {
+         return false;
       }
 
-#elif defined( __AAL_WINDOWS__ )
-
-      // Resume waiters from sleep.
-      SetEvent(m_hEvent);
+      Prev = SyncCompareAndSwap(&m_CurCount, Cur, Cur + nCount);
+      if ( Prev == Cur ) {
+         break;
+      }
+      Cur = Prev;
+   }
 
-#endif
+   Cur += nCount;
 
+   // Waiters register in m_WaitCount before they sample m_Seq and re-check the count,
+   //  so either they see the new count or we see them here.
+   if ( ( Cur > 0 ) && ( SyncLoad(&m_WaitCount) > 0 ) ) {
+      SyncAdd(&m_Seq, (btUnsigned32bitInt)1);
+      // Release 1 (or at least minimal) thread, or all waiting threads.
+      FutexWake(&m_Seq, ( 1 == Cur ) ? 1 : INT_MAX);
    }
 
    return true;
@@ -357,124 +385,114 @@ btBool CSemaphore::UnblockAll()
       return false;
    }
 
-   btBool res = true;
-
    flag_setf(m_State, SEM_ST_UNBLOCKED);
-   m_CurCount = 0;
+   SyncStore(&m_CurCount, 0);
 
    // Check to see if there is anyone waiting
-   if ( m_WaitCount > 0 ) {
-
-#if   defined( __AAL_LINUX__ )
-
+   if ( SyncLoad(&m_WaitCount) > 0 ) {
       // Wake ALL threads
-      if ( 0 != pthread_cond_broadcast(&m_condition) ) {      // Signal
-         res = false;
-      }
-
-#elif defined( __AAL_WINDOWS__ )
-
-      // Resume waiters from sleep.
-      if ( !SetEvent(m_hEvent) ) {
-         res = false;
-      }
-
-#endif
-
+      SyncAdd(&m_Seq, (btUnsigned32bitInt)1);
+      FutexWake(&m_Seq, INT_MAX);
    }
 
-   return res;
+   return true;
 }
 
 //=============================================================================
-// Name: NumWaiters
-// Description: Returns the current number of waiters.
-// NOTE: This is a snapshot and may change by the time the
-//       caller examines the value
-// Interface: public
+// Name: TryDecrement
+// Description: Lock-free attempt to take one count.
+// Interface: private
 // Inputs: none.
-// Returns: Current number of waiters
+// Returns: true if the count was positive and was decremented.
 // Comments:
 //=============================================================================
-btUnsignedInt CSemaphore::NumWaiters()
+btBool CSemaphore::TryDecrement()
 {
-   AutoLock(this);
-   return m_WaitCount;
-}
+   btInt Cur = SyncLoad(&m_CurCount);
+   btInt Prev;
 
+   while ( Cur > 0 ) {
+      Prev = SyncCompareAndSwap(&m_CurCount, Cur, Cur - 1);
+      if ( Prev == Cur ) {
+         return true;
+      }
+      Cur = Prev;
+   }
 
-#define ADD_WAITER() ++m_WaitCount
-#define DEL_WAITER()                        \
-do                                          \
-{                                           \
-   --m_WaitCount;                           \
-   if ( 0 == m_WaitCount ) {                \
-      flag_clrf(m_State, SEM_ST_UNBLOCKED); \
-   }                                        \
-}while(0)
-
+   return false;
+}
 
-#ifdef __AAL_LINUX__
 //=============================================================================
-// Name: Wait
-// Description: Timed Wait
-// Interface: public
+// Name: TryWait
+// Description: Wait() fast path, taken before the internal lock.
+// Interface: private
 // Inputs: none.
-// Returns: False if the semaphore is bad or it times out waiting
-// Comments:
+// Returns: true if a count was taken.
+// Comments: Polls the count up to m_SpinCount more times before giving up,
+//           when there is more than one CPU to spin on.
 //=============================================================================
-btBool CSemaphore::Wait(btTime Timeout) // milliseconds
+btBool CSemaphore::TryWait()
 {
-   if ( AAL_INFINITE_WAIT == Timeout ) {
-      return Wait();
+   if ( flag_is_clr(SyncLoad(&m_State), SEM_ST_OK) ) {
+      return false;
    }
 
-   {
-      AutoLock(this);
-      if ( flag_is_clr(m_State, SEM_ST_OK) ) {
-         // Not initialized.
-         return false;
-      }
+   if ( TryDecrement() ) {
+      return true;
    }
 
-   // Unlock to allow other waits and posts..
+   btUnsignedInt       i;
+   const btUnsignedInt Spins = SyncSpinUseful() ? SyncLoad(&m_SpinCount) : 0;
 
-   struct timeval tv;
-   struct timezone tz;
-   gettimeofday(&tv, &tz);
-
-   struct timespec ts;
-
-   ts.tv_sec = tv.tv_sec;
-   ts.tv_nsec = (tv.tv_usec * 1000) + (Timeout * 1000000);
+   for ( i = 0 ; i < Spins ; ++i ) {
+      SyncCpuRelax();
+      if ( ( SyncLoad(&m_CurCount) > 0 ) && TryDecrement() ) {
+         return true;
+      }
+   }
 
-   ts.tv_sec += ts.tv_nsec / 1000000000;
-   ts.tv_nsec = ts.tv_nsec % 1000000000;
+   return false;
+}
 
-   // Protect the predicate check (locks the mutex used in wait)
-   AutoLock7(this);
+//=============================================================================
+// Name: SleepWait
+// Description: Wait() slow path. Sleep on the futex until a count can be taken,
+//              the Semaphore is unblocked, or the deadline passes.
+// Interface: private
+// Inputs: pDeadline - absolute CLOCK_MONOTONIC deadline, or NULL to wait forever.
+// Returns: true if a count was taken.
+// Comments: Called with the internal lock held. The lock is released while asleep.
+//=============================================================================
+btBool CSemaphore::SleepWait(const struct timespec *pDeadline)
+{
+   if ( flag_is_clr(m_State, SEM_ST_OK) ) {
+      // Not initialized.
+      return false;
+   }
 
    ADD_WAITER();
 
-   // Both the comparison of m_CurCount to 0 and the decrement of m_CurCount must occur atomically.
+   for ( ;; ) {
+      // Sample the futex word before checking the count. A Post() that lands after the
+      //  check advances m_Seq, so FutexWait() returns immediately instead of sleeping.
+      const btUnsigned32bitInt Seq = SyncLoad(&m_Seq);
 
-   while ( m_CurCount <= 0 ) {
-      // The pthread cond wait API's work as follows:
-      // * the mutex object guarding the counter predicate must be locked prior to the call.
-      // * when the wait call puts the caller to sleep, it releases the lock prior to doing so.
-      // * when the caller wakes, the lock is guaranteed to be held (locked) by the caller.
-      // In this way, the examination and mutation of the counter predicate occur atomically.
-
-      int WaitRes = EINVAL;
+      if ( TryDecrement() ) {
+         break;
+      }
 
-      {
-         _PThreadCondTimedWait wait(this, &m_condition, &ts);
-         WaitRes = wait.Result();
+      // The kernel would round an already-expired deadline up to its timer slack.
+      if ( ( NULL != pDeadline ) && MonotonicDeadlinePassed(pDeadline) ) {
+         DEL_WAITER();
+         return false;
       }
 
+      Unlock();
+      const int WaitRes = FutexWait(&m_Seq, Seq, pDeadline);
+      Lock();
+
       if ( ETIMEDOUT == WaitRes ) {
          DEL_WAITER();
-         // Unlock the mutex locked by the return from wait
          return false;
       }
 
@@ -485,17 +503,38 @@ btBool CSemaphore::Wait(btTime Timeout) // milliseconds
          return false;
       }
    }
-   // ASSERT(m_CurCount > 0);
-
-   // Decrement count. Note we are still protected by lock from return from wait()
-   m_CurCount--;
 
    DEL_WAITER();
 
    return true;
 }
 
+//=============================================================================
+// Name: Wait
+// Description: Timed Wait
+// Interface: public
+// Inputs: none.
+// Returns: False if the semaphore is bad or it times out waiting
+// Comments: The deadline is measured on CLOCK_MONOTONIC.
+//=============================================================================
+btBool CSemaphore::Wait(btTime Timeout) // milliseconds
+{
+   if ( AAL_INFINITE_WAIT == Timeout ) {
+      return Wait();
+   }
+
+   struct timespec ts;
+   MonotonicDeadline(&ts, Timeout);
 
+   if ( TryWait() ) {
+      FastPath7();
+      return true;
+   }
+
+   AutoLock7(this);
+
+   return SleepWait(&ts);
+}
 
 //=============================================================================
 // Name: Wait
@@ -507,45 +546,102 @@ btBool CSemaphore::Wait(btTime Timeout) // milliseconds
 //=============================================================================
 btBool CSemaphore::Wait()
 {
+   if ( TryWait() ) {
+      FastPath6();
+      return true;
+   }
+
    AutoLock6(this);
 
+   return SleepWait(NULL);
+}
+
+#elif defined(__AAL_WINDOWS__)
+
+#define ADD_WAITER() ++m_WaitCount
+#define DEL_WAITER()                        \
+do                                          \
+{                                           \
+   --m_WaitCount;                           \
+   if ( 0 == m_WaitCount ) {                \
+      flag_clrf(m_State, SEM_ST_UNBLOCKED); \
+   }                                        \
+}while(0)
+
+//=============================================================================
+// Name: Post
+// Description:
+// Interface: public
+// Inputs: none.
+// Outputs:
+// Comments:
+//=============================================================================
+btBool CSemaphore::Post(btInt nCount)
+{
+   AutoLock4(this);
+
    if ( flag_is_clr(m_State, SEM_ST_OK) ) {
       // Not initialized.
       return false;
    }
 
-   // Both the comparison of m_CurCount to 0 and the decrement of m_CurCount must occur atomically.
-   //  This is done by assuring that manipulation is always done within a lock()
-   // Protect the predicate check (locks the mutex used in wait)
+   // Can't post such that you exceed MaxCount
+   if ( ( m_CurCount + nCount ) > m_MaxCount ) {
+      return false;
+   }
 
-   ADD_WAITER();
+   // Calculate new count and determine if we need to signal.
+   m_CurCount += nCount;
 
-   while ( m_CurCount <= 0 ) {
-      // The pthread cond wait API's work as follows:
-      // * the mutex object guarding the counter predicate must be locked prior to the call.
-      // * when the wait call puts the caller to sleep, it releases the lock prior to doing so.
-      // * when the caller wakes, the lock is guaranteed to be held (locked) by the caller.
-      // In this way, the examination and mutation of the counter predicate occur atomically.
+   if ( m_CurCount > 0 ) {
 
-      {
-         _PThreadCondWait wait(this, &m_condition); // Infinite wait
-      }
+      // Resume waiters from sleep.
+      SetEvent(m_hEvent);
 
-      // If we are being unblocked, then immediately return false and do not
-      //   modify the predicate.
-      if ( flag_is_set(m_State, SEM_ST_UNBLOCKED) ) {
-         DEL_WAITER();
-         return false;
-      }
    }
 
-   m_CurCount--;
+   return true;
+}
 
-   DEL_WAITER();
+//=============================================================================
+// Name: UnblockAll
+// Description: Unblocks all waiting threads and resets currcount to 0. Unblocked
+//              threads will return false.
+// Interface: public
+// Inputs: none.
+// Returns: False if the semaphore isn't initialized
+// Comments: This function will cause all threads to wake but it is not
+//            guaranteed that all threads have unblocked when the call returns.
+//            There is nothing preventing threads from returning to wait()
+//            after unblocking.
+//=============================================================================
+btBool CSemaphore::UnblockAll()
+{
+   AutoLock5(this);
 
-   return true;
+   if ( flag_is_clr(m_State, SEM_ST_OK) ) {
+      // Not initialized.
+      return false;
+   }
+
+   btBool res = true;
+
+   flag_setf(m_State, SEM_ST_UNBLOCKED);
+   m_CurCount = 0;
+
+   // Check to see if there is anyone waiting
+   if ( m_WaitCount > 0 ) {
+
+      // Resume waiters from sleep.
+      if ( !SetEvent(m_hEvent) ) {
+         res = false;
+      }
+
+   }
+
+   return res;
 }
-#elif defined(__AAL_WINDOWS__)
+
 //=============================================================================
 // Name: Wait
 // Description: Timed Wait
@@ -714,5 +810,17 @@ btObjectType CSemaphore::UserDefined() const
    return m_UserDefined;
 }
 
+void CSemaphore::SpinCount(btUnsignedInt nSpins)
+{
+   AutoLock(this);
+   m_SpinCount = nSpins;
+}
+
+btUnsignedInt CSemaphore::SpinCount() const
+{
+   AutoLock(this);
+   return m_SpinCount;
+}
+
 END_NAMESPACE(AAL)
 
@@ -65,6 +65,7 @@
 # include <cstdlib>  // int rand_r(unsigned int *seed);
 # include <signal.h>
 # include <unistd.h>
+# include <sched.h>
 #endif // OS
 
 BEGIN_NAMESPACE(AAL)
@@ -516,6 +517,45 @@ btTID OSLThread::tid()
    return m_tid;
 }
 
+//=============================================================================
+// Name: SetAffinity
+// Description: Restrict the thread to a set of CPUs
+// Interface: public
+// Inputs: CpuMask - bit n set allows CPU n.
+// Outputs: true if the affinity was changed.
+// Comments:
+//=============================================================================
+btBool OSLThread::SetAffinity(btUnsigned64bitInt CpuMask)
+{
+   AutoLock(this);
+
+   if ( ( 0 == CpuMask ) ||
+        flag_is_clr(m_State, THR_ST_OK) ||
+        flag_is_set(m_State, THR_ST_JOINED) ) {
+      return false;
+   }
+
+#if   defined( __AAL_WINDOWS__ )
+
+   return 0 != ::SetThreadAffinityMask(m_hThread, (DWORD_PTR)CpuMask);
+
+#elif defined( __AAL_LINUX__ )
+
+   cpu_set_t     set;
+   btUnsignedInt cpu;
+
+   CPU_ZERO(&set);
+   for ( cpu = 0 ; cpu < 64 ; ++cpu ) {
+      if ( CpuMask & (((btUnsigned64bitInt)1) << cpu) ) {
+         CPU_SET(cpu, &set);
+      }
+   }
+
+   return 0 == ::pthread_setaffinity_np(m_Thread, sizeof(set), &set);
+
+#endif // OS
+}
+
 /*
 //=============================================================================
 // Name: SetThreadPriority
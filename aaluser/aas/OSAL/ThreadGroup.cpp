@@ -63,6 +63,35 @@
 
 BEGIN_NAMESPACE(AAL)
 
+// Atomic helpers for the WorkStealing idle flags.
+static inline btInt ThrGrpCompareAndSwap(volatile btInt *p, btInt Old, btInt New)
+{
+#if   defined( __AAL_WINDOWS__ )
+   return (btInt) InterlockedCompareExchange((volatile LONG *)p, (LONG)New, (LONG)Old);
+#elif defined( __AAL_LINUX__ )
+   return __sync_val_compare_and_swap(p, Old, New);
+#endif // OS
+}
+
+// returns the new value.
+static inline btInt ThrGrpAtomicAdd(volatile btInt *p, btInt n)
+{
+#if   defined( __AAL_WINDOWS__ )
+   return (btInt) InterlockedExchangeAdd((volatile LONG *)p, (LONG)n) + n;
+#elif defined( __AAL_LINUX__ )
+   return __sync_add_and_fetch(p, n);
+#endif // OS
+}
+
+static inline void ThrGrpFullBarrier()
+{
+#if   defined( __AAL_WINDOWS__ )
+   ::MemoryBarrier();
+#elif defined( __AAL_LINUX__ )
+   __sync_synchronize();
+#endif // OS
+}
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
@@ -74,6 +103,7 @@ BEGIN_NAMESPACE(AAL)
 // Inputs: uiMinThreads - Minimum number of threads to use (default = 0 = auto).
 //         uiMaxThreads - Maximum threads. (default = 0 = auto)
 //         nPriority - Thread priority
+//         ePolicy - Work queueing policy (default = SharedQueue)
 // Outputs: none.
 // Comments: Setting min == max != 0 results in a static thread pool.
 //           The algorithm summary:
@@ -97,11 +127,13 @@ BEGIN_NAMESPACE(AAL)
 /// @param[in]    uiMaxThreads - Maximum threads (default = 0 = auto).
 /// @param[in]    nPriority    - Thread priority (default = OSLThread::THREADPRIORITY_NORMAL).
 /// @param[in]    JoinTimeout  - Timeout waiting for thread to exit (default = AAL_INFINITE_WAIT).
+/// @param[in]    ePolicy      - Work queueing policy (default = SharedQueue).
 /// @return void
 OSLThreadGroup::OSLThreadGroup(btUnsignedInt             uiMinThreads,
                                btUnsignedInt             uiMaxThreads,
                                OSLThread::ThreadPriority nPriority,
-                               btTime                    JoinTimeout) :
+                               btTime                    JoinTimeout,
+                               Policy                    ePolicy) :
    m_bDestroyed(false),
    m_JoinTimeout(JoinTimeout),
    m_pState(NULL)
@@ -128,7 +160,7 @@ OSLThreadGroup::OSLThreadGroup(btUnsignedInt             uiMinThreads,
       //  have been deleted. By making the state and synchronization members outside
       //  the ThreadGroup, the Threads can safely access them even if the Group object
       //  is gone.
-      m_pState = new(std::nothrow) OSLThreadGroup::ThrGrpState(uiMinThreads);
+      m_pState = new(std::nothrow) OSLThreadGroup::ThrGrpState(uiMinThreads, ePolicy);
       if ( NULL == m_pState ) {
          m_bDestroyed = true;
          ASSERT(false);
@@ -215,7 +247,7 @@ void OSLThreadGroup::ExecProc(OSLThread *pThread, void *lpParms)
    }
 
    // Notify the constructor that we are up.
-   pState->WorkerHasStarted(pThread);
+   const btUnsignedInt slot = pState->WorkerHasStarted(pThread);
 
    OSLThreadGroup::ThrGrpState::eState state;
 
@@ -225,7 +257,7 @@ void OSLThreadGroup::ExecProc(OSLThread *pThread, void *lpParms)
    while ( bRunning ) {
 
       pWork = NULL;
-      state = pState->GetWorkItem(pWork);
+      state = pState->GetWorkItem(pWork, slot);
 
       switch ( state ) {
 
@@ -265,7 +297,8 @@ void OSLThreadGroup::ExecProc(OSLThread *pThread, void *lpParms)
 ////////////////////////////////////////////////////////////////////////////////
 // OSLThreadGroup::ThrGroupState
 
-OSLThreadGroup::ThrGrpState::ThrGrpState(btUnsignedInt NumThreads) :
+OSLThreadGroup::ThrGrpState::ThrGrpState(btUnsignedInt NumThreads, Policy ePolicy) :
+   m_ePolicy(ePolicy),
    m_eState(Running),
    m_Flags(THRGRPSTATE_FLAG_OK),
    m_WorkSemTimeout(AAL_INFINITE_WAIT),
@@ -278,6 +311,11 @@ OSLThreadGroup::ThrGrpState::ThrGrpState(btUnsignedInt NumThreads) :
    m_workqueue(),
    m_RunningThreads(),
    m_ExitedThreads(),
+   m_Slots(NULL),
+   m_NumSlots(0),
+   m_SlotsBound(0),
+   m_NextSlot(0),
+   m_Searching(0),
    m_DrainManager(this)
 {
    if ( !m_ThrStartBarrier.Create(NumThreads) ) {
@@ -295,6 +333,22 @@ OSLThreadGroup::ThrGrpState::ThrGrpState(btUnsignedInt NumThreads) :
    if ( !m_WorkSem.Create(0, INT_MAX) ) {
       flag_clrf(m_Flags, THRGRPSTATE_FLAG_OK);
    }
+
+   if ( WorkStealing == m_ePolicy ) {
+      m_Slots = new(std::nothrow) WorkerSlot[NumThreads];
+      if ( NULL == m_Slots ) {
+         flag_clrf(m_Flags, THRGRPSTATE_FLAG_OK);
+         return;
+      }
+      m_NumSlots = NumThreads;
+
+      btUnsignedInt i;
+      for ( i = 0 ; i < m_NumSlots ; ++i ) {
+         if ( !m_Slots[i].m_Wake.Create(0, INT_MAX) ) {
+            flag_clrf(m_Flags, THRGRPSTATE_FLAG_OK);
+         }
+      }
+   }
 }
 
 OSLThreadGroup::ThrGrpState::~ThrGrpState()
@@ -303,6 +357,7 @@ OSLThreadGroup::ThrGrpState::~ThrGrpState()
    ASSERT(m_workqueue.empty());
    ASSERT(m_RunningThreads.empty());
    ASSERT(m_ExitedThreads.empty());
+   ASSERT(0 == QueuedWorkItems());
    DestructMembers();
 }
 
@@ -318,6 +373,28 @@ btUnsignedInt OSLThreadGroup::ThrGrpState::GetNumThreads() const
    return (btUnsignedInt) m_RunningThreads.size();
 }
 
+//=============================================================================
+// Name: SetAffinity
+// Description: Set the CPU affinity of every running worker
+// Interface: public
+// Comments:
+//=============================================================================
+btBool OSLThreadGroup::ThrGrpState::SetAffinity(btUnsigned64bitInt CpuMask)
+{
+   AutoLock(this);
+
+   btBool        res = true;
+   thr_list_iter iter;
+
+   for ( iter = m_RunningThreads.begin() ; m_RunningThreads.end() != iter ; ++iter ) {
+      if ( !(*iter)->SetAffinity(CpuMask) ) {
+         res = false;
+      }
+   }
+
+   return res;
+}
+
 //=============================================================================
 // Name: GetNumWorkItems
 // Description: Get Number of workitems
@@ -327,7 +404,88 @@ btUnsignedInt OSLThreadGroup::ThrGrpState::GetNumThreads() const
 btUnsignedInt OSLThreadGroup::ThrGrpState::GetNumWorkItems() const
 {
    AutoLock(this);
-   return (btUnsignedInt) m_workqueue.size();
+   return QueuedWorkItems();
+}
+
+// Count the queued work items. WorkStealing locks each slot in turn.
+btUnsignedInt OSLThreadGroup::ThrGrpState::QueuedWorkItems() const
+{
+   if ( WorkStealing != m_ePolicy ) {
+      return (btUnsignedInt) m_workqueue.size();
+   }
+
+   btUnsignedInt items = 0;
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_NumSlots ; ++i ) {
+      AutoLock(&m_Slots[i]);
+      items += (btUnsignedInt) m_Slots[i].m_Work.size();
+   }
+   return items;
+}
+
+// Remove and return one queued work item, or NULL. Called with the lock held.
+IDispatchable * OSLThreadGroup::ThrGrpState::TakeAnyWorkItem()
+{
+   IDispatchable *pWork = NULL;
+
+   if ( WorkStealing != m_ePolicy ) {
+      if ( m_workqueue.size() > 0 ) {
+         pWork = m_workqueue.front();
+         m_workqueue.pop();
+      }
+      return pWork;
+   }
+
+   btUnsignedInt i;
+   for ( i = 0 ; ( NULL == pWork ) && ( i < m_NumSlots ) ; ++i ) {
+      AutoLock(&m_Slots[i]);
+      if ( m_Slots[i].m_Work.size() > 0 ) {
+         pWork = m_Slots[i].m_Work.front();
+         m_Slots[i].m_Work.pop_front();
+         --m_Slots[i].m_Queued;
+      }
+   }
+   return pWork;
+}
+
+// Remove and destroy all queued work items. Called with the lock held.
+void OSLThreadGroup::ThrGrpState::FlushWorkItems()
+{
+   IDispatchable *wi;
+   while ( NULL != ( wi = TakeAnyWorkItem() ) ) {
+      delete wi;
+   }
+}
+
+// Unblock every worker waiting for work.
+void OSLThreadGroup::ThrGrpState::WakeAllWorkers()
+{
+   if ( WorkStealing != m_ePolicy ) {
+      m_WorkSem.Post( (btInt) m_RunningThreads.size() );
+      return;
+   }
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_NumSlots ; ++i ) {
+      m_Slots[i].m_Wake.Post(1);
+   }
+}
+
+// Slots are always locked in ascending order, after the thread group lock.
+void OSLThreadGroup::ThrGrpState::LockAllSlots()
+{
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_NumSlots ; ++i ) {
+      m_Slots[i].Acquire();
+   }
+}
+
+void OSLThreadGroup::ThrGrpState::UnlockAllSlots()
+{
+   btUnsignedInt i = m_NumSlots;
+   while ( i-- > 0 ) {
+      m_Slots[i].Release();
+   }
 }
 
 void OSLThreadGroup::ThrGrpState::UserDefined(btObjectType User)
@@ -358,6 +516,10 @@ btBool OSLThreadGroup::ThrGrpState::Add(IDispatchable *pDisp)
       return false;
    }
 
+   if ( WorkStealing == m_ePolicy ) {
+      return AddStealing(pDisp);
+   }
+
    {
       AutoLock0(this);
 
@@ -402,11 +564,7 @@ void OSLThreadGroup::ThrGrpState::Stop()
    m_WorkSem.Reset(0);
 
    // If there is something on the queue then remove it and destroy it.
-   while ( m_workqueue.size() > 0 ) {
-      IDispatchable *wi = m_workqueue.front();
-      m_workqueue.pop();
-      delete wi;
-   }
+   FlushWorkItems();
 }
 
 //=============================================================================
@@ -420,6 +578,12 @@ btBool OSLThreadGroup::ThrGrpState::Start()
    AutoLock1(this);
 
    if ( Running == State(Running) ) {
+      if ( WorkStealing == m_ePolicy ) {
+         // Workers re-scan every deque when woken.
+         WakeAllWorkers();
+         return true;
+      }
+
       btInt s = (btInt) m_workqueue.size();
 
       btInt c = 0;
@@ -445,6 +609,9 @@ OSLThreadGroup::ThrGrpState::eState OSLThreadGroup::ThrGrpState::State(eState st
       return m_eState;
    }
 
+   // WorkStealing readers of m_eState hold only a slot lock.
+   LockAllSlots();
+
    switch ( m_eState ) {
       case Running : {
          switch ( st ) {
@@ -474,6 +641,8 @@ OSLThreadGroup::ThrGrpState::eState OSLThreadGroup::ThrGrpState::State(eState st
       } break;
    }
 
+   UnlockAllSlots();
+
    return m_eState;
 }
 
@@ -508,8 +677,12 @@ btBool OSLThreadGroup::ThrGrpState::CreateWorkerThread(ThreadProc
 // Interface: public
 // Comments:
 //=============================================================================
-OSLThreadGroup::ThrGrpState::eState OSLThreadGroup::ThrGrpState::GetWorkItem(IDispatchable * &pWork)
+OSLThreadGroup::ThrGrpState::eState OSLThreadGroup::ThrGrpState::GetWorkItem(IDispatchable * &pWork, btUnsignedInt slot)
 {
+   if ( WorkStealing == m_ePolicy ) {
+      return GetStealingWorkItem(pWork, slot);
+   }
+
    // Wait for work item
    m_WorkSem.Wait(m_WorkSemTimeout);
 
@@ -547,6 +720,179 @@ OSLThreadGroup::ThrGrpState::eState OSLThreadGroup::ThrGrpState::GetWorkItem(IDi
    return state;
 }
 
+//=============================================================================
+// Name: AddStealing
+// Description: Add() for the WorkStealing policy.
+// Interface: private
+// Comments: Takes only the target slot's lock. The item goes to the calling
+//           worker's own deque, or round-robin for external callers. An idle
+//           worker is woken only when no worker is already searching for work.
+//=============================================================================
+btBool OSLThreadGroup::ThrGrpState::AddStealing(IDispatchable *pDisp)
+{
+   // m_NextSlot only spreads the load; a lost update is harmless.
+   const btUnsignedInt start  = m_NextSlot++;
+   btInt               target = CallerSlot();
+   btBool              res;
+
+   if ( target < 0 ) {
+      target = (btInt)(start % m_NumSlots);
+   }
+
+   {
+      AutoLock(&m_Slots[target]);
+
+      const eState state = m_eState;
+
+      // We allow new work items when Running or Joining.
+      res = ( Stopped != state ) && ( Draining != state );
+      if ( res ) {
+         m_Slots[target].m_Work.push_back(pDisp);
+         ++m_Slots[target].m_Queued;
+      }
+   }
+
+   if ( res ) {
+      // A searching worker re-scans every deque after it stops searching and before it
+      //  blocks, so either it sees our item or we see it idle here.
+      ThrGrpFullBarrier();
+      if ( 0 == m_Searching ) {
+         WakeIdleWorker(start);
+      }
+   }
+
+   return res;
+}
+
+// Wake the first idle worker at or after start, if any.
+void OSLThreadGroup::ThrGrpState::WakeIdleWorker(btUnsignedInt start)
+{
+   const btInt s = ClaimIdleWorker(start);
+   if ( s >= 0 ) {
+      m_Slots[s].m_Wake.Post(1);
+   }
+}
+
+// Clear the idle flag of the first idle worker at or after start. returns its slot, or -1.
+btInt OSLThreadGroup::ThrGrpState::ClaimIdleWorker(btUnsignedInt start)
+{
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_NumSlots ; ++i ) {
+      const btUnsignedInt s = (start + i) % m_NumSlots;
+      if ( ( 0 != m_Slots[s].m_Idle ) && ( 1 == ThrGrpCompareAndSwap(&m_Slots[s].m_Idle, 1, 0) ) ) {
+         return (btInt)s;
+      }
+   }
+   return -1;
+}
+
+// The slot of the calling thread, if it is a worker in this group; otherwise -1.
+btInt OSLThreadGroup::ThrGrpState::CallerSlot() const
+{
+   const btTID   MyThrID = GetThreadID();
+   btUnsignedInt i;
+   for ( i = 0 ; i < m_SlotsBound ; ++i ) {
+      if ( ThreadIDEqual(MyThrID, m_Slots[i].m_tid) ) {
+         return (btInt)i;
+      }
+   }
+   return -1;
+}
+
+// Take one item from slot's own deque, or steal one from a peer's.
+OSLThreadGroup::ThrGrpState::eState OSLThreadGroup::ThrGrpState::TakeStealingWorkItem(IDispatchable * &pWork, btUnsignedInt slot)
+{
+   eState        state = m_eState;
+   btUnsignedInt i;
+
+   for ( i = 0 ; i < m_NumSlots ; ++i ) {
+      WorkerSlot &ws = m_Slots[(slot + i) % m_NumSlots];
+
+      if ( 0 == ws.m_Queued ) {
+         continue;
+      }
+
+      AutoLock(&ws);
+
+      state = m_eState;
+      if ( Stopped == state ) {
+         // don't dispatch any items
+         break;
+      }
+
+      if ( ws.m_Work.size() > 0 ) {
+         if ( 0 == i ) {
+            pWork = ws.m_Work.front();
+            ws.m_Work.pop_front();
+         } else {
+            pWork = ws.m_Work.back();
+            ws.m_Work.pop_back();
+         }
+         --ws.m_Queued;
+         break;
+      }
+   }
+
+   return state;
+}
+
+// TakeStealingWorkItem(), counted in m_Searching. The last searcher to find work wakes an idle
+//  peer if more work is queued, so that a burst of Add()'s fans out across the workers.
+OSLThreadGroup::ThrGrpState::eState OSLThreadGroup::ThrGrpState::SearchWorkItem(IDispatchable * &pWork, btUnsignedInt slot)
+{
+   ThrGrpAtomicAdd(&m_Searching, 1);
+
+   const eState state = TakeStealingWorkItem(pWork, slot);
+
+   if ( ( 0 == ThrGrpAtomicAdd(&m_Searching, -1) ) && ( NULL != pWork ) ) {
+      btUnsignedInt i;
+      for ( i = 0 ; i < m_NumSlots ; ++i ) {
+         if ( 0 != m_Slots[i].m_Queued ) {
+            WakeIdleWorker(slot + 1);
+            break;
+         }
+      }
+   }
+
+   return state;
+}
+
+//=============================================================================
+// Name: GetStealingWorkItem
+// Description: GetWorkItem() for the WorkStealing policy.
+// Interface: private
+// Comments: Blocks on the slot's own semaphore only after advertising itself
+//           as idle and finding every deque empty.
+//=============================================================================
+OSLThreadGroup::ThrGrpState::eState OSLThreadGroup::ThrGrpState::GetStealingWorkItem(IDispatchable * &pWork, btUnsignedInt slot)
+{
+   WorkerSlot &ws    = m_Slots[slot];
+   eState      state = SearchWorkItem(pWork, slot);
+
+   if ( ( NULL != pWork ) || ( Joining == state ) ) {
+      // Joining with no work left - the worker exits.
+      return state;
+   }
+
+   ws.m_Idle = 1;
+   ThrGrpFullBarrier();
+
+   state = TakeStealingWorkItem(pWork, slot);
+
+   if ( ( NULL == pWork ) && ( Joining != state ) ) {
+      ws.m_Wake.Wait(m_WorkSemTimeout);
+   }
+
+   // If an Add() claimed us in the meantime, its Post() only causes one spurious wake-up.
+   ThrGrpCompareAndSwap(&ws.m_Idle, 1, 0);
+
+   if ( NULL == pWork ) {
+      state = SearchWorkItem(pWork, slot);
+   }
+
+   return state;
+}
+
 OSLThread * OSLThreadGroup::ThrGrpState::ThreadRunningInThisGroup(btTID tid) const
 {
    const_thr_list_iter iter;
@@ -558,9 +904,20 @@ OSLThread * OSLThreadGroup::ThrGrpState::ThreadRunningInThisGroup(btTID tid) con
    return NULL;
 }
 
-void OSLThreadGroup::ThrGrpState::WorkerHasStarted(OSLThread *pThread)
+btUnsignedInt OSLThreadGroup::ThrGrpState::WorkerHasStarted(OSLThread *pThread)
 {
+   btUnsignedInt slot = 0;
+
+   if ( WorkStealing == m_ePolicy ) {
+      AutoLock(this);
+      ASSERT(m_SlotsBound < m_NumSlots);
+      slot = m_SlotsBound;
+      m_Slots[slot].m_tid = GetThreadID();
+      ++m_SlotsBound;
+   }
+
    m_ThrStartBarrier.Post(1);
+   return slot;
 }
 
 btBool OSLThreadGroup::ThrGrpState::WaitForAllWorkersToStart(btTime Timeout)
@@ -677,6 +1034,12 @@ void OSLThreadGroup::ThrGrpState::DestructMembers()
    m_ThrExitBarrier.Destroy();
    m_DrainManager.DestructMembers();
    m_ThrJoinBarrier.Destroy();
+
+   if ( NULL != m_Slots ) {
+      delete[] m_Slots;
+      m_Slots    = NULL;
+      m_NumSlots = 0;
+   }
 }
 
 OSLThreadGroup::ThrGrpState::DrainManager::DrainManager(ThrGrpState *pTGS) :
@@ -700,7 +1063,7 @@ Barrier * OSLThreadGroup::ThrGrpState::DrainManager::Begin(btTID tid, btUnsigned
 
    if ( 1 == m_DrainNestLevel ) {
       // Beginning a new series of (possibly nested) Drain() calls.
-      ASSERT((btUnsignedInt) m_pTGS->m_workqueue.size() == items);
+      ASSERT(m_pTGS->QueuedWorkItems() == items);
       ASSERT(0 == m_NestedWorkItems.size());
 
       m_DrainerDoneBarrier.Reset();
@@ -712,6 +1075,18 @@ Barrier * OSLThreadGroup::ThrGrpState::DrainManager::Begin(btTID tid, btUnsigned
       IDispatchable      *pWork;
       NestedBarrierPostD *pNested;
 
+      // WorkStealing: wrap each item in place. The caller holds every slot lock.
+      btUnsignedInt s;
+      for ( s = 0 ; s < m_pTGS->m_NumSlots ; ++s ) {
+         work_deque_t::iterator iter;
+         work_deque_t          &work = m_pTGS->m_Slots[s].m_Work;
+         for ( iter = work.begin() ; work.end() != iter ; ++iter ) {
+            pNested = new(std::nothrow) NestedBarrierPostD(*iter, this);
+            m_NestedWorkItems.push_back(pNested);
+            *iter = pNested;
+         }
+      }
+
       // Pull each item from the work queue, and wrap it in a NestedBarrierPostD() object.
       while ( m_pTGS->m_workqueue.size() > 0 ) {
          pWork = m_pTGS->m_workqueue.front();
@@ -878,29 +1253,35 @@ btBool OSLThreadGroup::ThrGrpState::Drain()
    {
       AutoLock3(this);
 
-      const btUnsignedInt items = (btUnsignedInt) m_workqueue.size();
+      // WorkStealing workers dequeue without the thread group lock. Hold every slot so that
+      //  the items counted here are the items wrapped by DrainManager::Begin().
+      LockAllSlots();
+
+      const btUnsignedInt items = QueuedWorkItems();
 
       // No need to drain if already empty.
       if ( 0 == items ) {
+         UnlockAllSlots();
          return true;
       }
 
       // Check for other state conflicts.
       if ( Draining != State(Draining) ) {
          // Can't drain now - state conflict.
+         UnlockAllSlots();
          return false;
       }
 
       pDrainBarrier = m_DrainManager.Begin(MyThrID, items);
 
+      UnlockAllSlots();
+
       if ( NULL == pDrainBarrier ) {
          // Self-referential Drain().
 
          // We need to continue to execute work.
          IDispatchable *pWork;
-         while ( m_workqueue.size() > 0 ) {
-            pWork = m_workqueue.front();
-            m_workqueue.pop();
+         while ( NULL != ( pWork = TakeAnyWorkItem() ) ) {
             _UnlockedDispatch uld(this, pWork);
          }
       }
@@ -967,7 +1348,7 @@ btBool OSLThreadGroup::ThrGrpState::Join(btTime Timeout)
       m_WorkSemTimeout = PollingInterval();
 
       // Wake any threads that happen to be blocked infinitely.
-      m_WorkSem.Post( (btInt) m_RunningThreads.size() );
+      WakeAllWorkers();
 
       // Claim the Join().
       ASSERT(flag_is_clr(m_Flags, THRGRPSTATE_FLAG_JOINING));
@@ -980,9 +1361,7 @@ btBool OSLThreadGroup::ThrGrpState::Join(btTime Timeout)
 
          // We need to continue to execute work.
          IDispatchable *pWork;
-         while ( m_workqueue.size() > 0 ) {
-            pWork = m_workqueue.front();
-            m_workqueue.pop();
+         while ( NULL != ( pWork = TakeAnyWorkItem() ) ) {
             _UnlockedDispatch uld(this, pWork);
          }
 
@@ -1031,7 +1410,7 @@ btBool OSLThreadGroup::ThrGrpState::Destroy(btTime Timeout)
       State(Joining);
 
       // Wake any threads that happen to be blocked infinitely.
-      m_WorkSem.Post( (btInt) m_RunningThreads.size() );
+      WakeAllWorkers();
 
       if ( Joining != st ) {
          // We weren't being joined before this call. Claim the join now.
@@ -1046,9 +1425,7 @@ btBool OSLThreadGroup::ThrGrpState::Destroy(btTime Timeout)
          flag_setf(m_Flags, THRGRPSTATE_FLAG_SELF_JOIN);
 
          IDispatchable *pWork;
-         while ( m_workqueue.size() > 0 ) {
-            pWork = m_workqueue.front();
-            m_workqueue.pop();
+         while ( NULL != ( pWork = TakeAnyWorkItem() ) ) {
             _UnlockedDispatch uld(this, pWork);
          }
 
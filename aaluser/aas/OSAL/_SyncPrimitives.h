@@ -0,0 +1,187 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file _SyncPrimitives.h
+/// @brief Linux building blocks shared by the OSAL synchronization objects.
+/// @ingroup OSAL
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// Atomic helpers, futex wait/wake and CLOCK_MONOTONIC deadlines used by
+/// CSemaphore and Barrier. Not part of the installed SDK headers.@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_OSAL_SYNCPRIMITIVES_H__
+#define __AALSDK_OSAL_SYNCPRIMITIVES_H__
+#include <aalsdk/AALTypes.h>
+
+#if defined( __AAL_LINUX__ )
+
+# include <errno.h>
+# include <limits.h>
+# include <pthread.h>
+# include <time.h>
+# include <unistd.h>
+# include <sys/syscall.h>
+# include <linux/futex.h>
+
+BEGIN_NAMESPACE(AAL)
+
+// Sequentially-consistent atomic read. Used for the lock-free fast paths, which
+//  read state that is otherwise only written with the object's lock held.
+template <typename T>
+static inline T SyncLoad(const volatile T *p)
+{
+#if defined( __ATOMIC_SEQ_CST )
+   return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+#else
+   __sync_synchronize();
+   T v = *p;
+   __sync_synchronize();
+   return v;
+#endif // __ATOMIC_SEQ_CST
+}
+
+// Sequentially-consistent atomic write.
+template <typename T>
+static inline void SyncStore(volatile T *p, T v)
+{
+#if defined( __ATOMIC_SEQ_CST )
+   __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+#else
+   __sync_synchronize();
+   *p = v;
+   __sync_synchronize();
+#endif // __ATOMIC_SEQ_CST
+}
+
+// Returns the value of *p before the swap; the swap happened if that equals Old.
+template <typename T>
+static inline T SyncCompareAndSwap(volatile T *p, T Old, T New)
+{
+   return __sync_val_compare_and_swap(p, Old, New);
+}
+
+// Returns the new value.
+template <typename T>
+static inline T SyncAdd(volatile T *p, T n)
+{
+   return __sync_add_and_fetch(p, n);
+}
+
+// Body of a bounded spin loop.
+static inline void SyncCpuRelax()
+{
+#if defined( __i386__ ) || defined( __x86_64__ )
+   __asm__ __volatile__ ("pause" ::: "memory");
+#else
+   __sync_synchronize();
+#endif // arch
+}
+
+// Spinning only helps when the thread that will release us can run at the same
+//  time. On a single CPU, a spin phase just delays the sleep.
+static inline btBool SyncSpinUseful()
+{
+   static const long CPUs = ::sysconf(_SC_NPROCESSORS_ONLN);
+   return CPUs > 1;
+}
+
+// The absolute CLOCK_MONOTONIC time Timeout milliseconds from now. Unlike
+//  gettimeofday(), the monotonic clock is not disturbed by wall clock changes.
+static inline void MonotonicDeadline(struct timespec *pTS, btTime Timeout)
+{
+   clock_gettime(CLOCK_MONOTONIC, pTS);
+
+   pTS->tv_sec  += (time_t)(Timeout / 1000);
+   pTS->tv_nsec += (long)((Timeout % 1000) * 1000000);
+
+   if ( pTS->tv_nsec >= 1000000000 ) {
+      pTS->tv_sec  += 1;
+      pTS->tv_nsec -= 1000000000;
+   }
+}
+
+// true if the CLOCK_MONOTONIC deadline pTS has passed.
+static inline btBool MonotonicDeadlinePassed(const struct timespec *pTS)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return ( now.tv_sec > pTS->tv_sec ) ||
+          ( ( now.tv_sec == pTS->tv_sec ) && ( now.tv_nsec >= pTS->tv_nsec ) );
+}
+
+// Initialize a condition variable whose timed waits take MonotonicDeadline() deadlines.
+static inline int MonotonicCondInit(pthread_cond_t *pCond)
+{
+   pthread_condattr_t attr;
+   int                res;
+
+   res = pthread_condattr_init(&attr);
+   if ( 0 != res ) {
+      return res;
+   }
+
+   res = pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+   if ( 0 == res ) {
+      res = pthread_cond_init(pCond, &attr);
+   }
+
+   pthread_condattr_destroy(&attr);
+   return res;
+}
+
+// Sleep while *pWord == Val, until woken by FutexWake() or until the absolute
+//  CLOCK_MONOTONIC deadline pDeadline (NULL waits forever).
+// Returns 0 when woken, EAGAIN if *pWord != Val on entry, ETIMEDOUT or EINTR.
+static inline int FutexWait(volatile btUnsigned32bitInt *pWord,
+                            btUnsigned32bitInt           Val,
+                            const struct timespec       *pDeadline)
+{
+   if ( 0 == ::syscall(SYS_futex,
+                       (btUnsigned32bitInt *)pWord,
+                       FUTEX_WAIT_BITSET_PRIVATE,
+                       Val,
+                       pDeadline,
+                       NULL,
+                       FUTEX_BITSET_MATCH_ANY) ) {
+      return 0;
+   }
+   return errno;
+}
+
+// Wake up to Count threads sleeping in FutexWait() on pWord.
+static inline void FutexWake(volatile btUnsigned32bitInt *pWord, btInt Count)
+{
+   ::syscall(SYS_futex, (btUnsigned32bitInt *)pWord, FUTEX_WAKE_PRIVATE, Count, NULL, NULL, 0);
+}
+
+END_NAMESPACE(AAL)
+
+#endif // __AAL_LINUX__
+
+#endif // __AALSDK_OSAL_SYNCPRIMITIVES_H__
+
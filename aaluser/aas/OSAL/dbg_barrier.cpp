@@ -51,6 +51,18 @@ if ( NULL != m_UserDefined ) {
    reinterpret_cast< ::AAL::Testing::IAfterBarrierAutoLock * >(m_UserDefined)->OnWait(Timeout); \
 }
 
+// The Linux Barrier::Wait() fast path does not acquire AutoLock(). It calls the hook directly.
+
+# define FastPath6()                                                                      \
+if ( NULL != m_UserDefined ) {                                                           \
+   reinterpret_cast< ::AAL::Testing::IAfterBarrierAutoLock * >(m_UserDefined)->OnWait(); \
+}
+
+# define FastPath7()                                                                             \
+if ( NULL != m_UserDefined ) {                                                                  \
+   reinterpret_cast< ::AAL::Testing::IAfterBarrierAutoLock * >(m_UserDefined)->OnWait(Timeout); \
+}
+
 # if   defined( __AAL_LINUX__ )
 
 #    define _PThreadCondWait0                                                             \
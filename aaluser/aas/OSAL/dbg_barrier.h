@@ -16,8 +16,8 @@ public:
    virtual void OnCurrCounts(AAL::btUnsignedInt & , AAL::btUnsignedInt & ) = 0; // [3] called when Barrier::CurrCounts(btUnsignedInt & , btUnsignedInt & ) acquires AutoLock()
    virtual void       OnPost(AAL::btUnsignedInt )                          = 0; // [4] called when Barrier::Post(btUnsignedInt ) acquires AutoLock()
    virtual void OnUnblockAll()                                             = 0; // [5] called when Barrier::UnblockAll() acquires AutoLock()
-   virtual void       OnWait()                                             = 0; // [6] called when Barrier::Wait() acquires AutoLock()
-   virtual void       OnWait(AAL::btTime )                                 = 0; // [7] called when Barrier::Wait(btTime ) acquires AutoLock()
+   virtual void       OnWait()                                             = 0; // [6] called when Barrier::Wait() acquires AutoLock(), or takes the fast path
+   virtual void       OnWait(AAL::btTime )                                 = 0; // [7] called when Barrier::Wait(btTime ) acquires AutoLock(), or takes the fast path
 
    virtual void      OnSleep()                                             = 0; // Called just prior to INFINITE wait on _UnlockedWaitForSingleObject / _PThreadCondWait
    virtual void      OnSleep(AAL::btTime )                                 = 0; // Called just prior to timed wait on _UnlockedWaitForSingleObject / _PThreadCondTimedWait
@@ -51,4 +51,22 @@ if ( NULL != m_UserDefined ) {
    reinterpret_cast< ::AAL::Testing::IAfterCSemaphoreAutoLock * >(m_UserDefined)->OnWait(Timeout); \
 }
 
+// The Linux CSemaphore::Post() and the Wait() fast paths do not acquire AutoLock().
+//  They call the hook directly, once per call.
+
+# define FastPath4()                                                                              \
+if ( NULL != m_UserDefined ) {                                                                    \
+   reinterpret_cast< ::AAL::Testing::IAfterCSemaphoreAutoLock * >(m_UserDefined)->OnPost(nCount); \
+}
+
+# define FastPath6()                                                                        \
+if ( NULL != m_UserDefined ) {                                                              \
+   reinterpret_cast< ::AAL::Testing::IAfterCSemaphoreAutoLock * >(m_UserDefined)->OnWait(); \
+}
+
+# define FastPath7()                                                                               \
+if ( NULL != m_UserDefined ) {                                                                     \
+   reinterpret_cast< ::AAL::Testing::IAfterCSemaphoreAutoLock * >(m_UserDefined)->OnWait(Timeout); \
+}
+
 #endif // DBG_CSEMAPHORE
@@ -14,10 +14,10 @@ public:
    virtual void    OnDestroy()                                 = 0; // [1] called when CSemaphore::Destroy() acquires AutoLock()
    virtual void      OnReset(AAL::btInt )                      = 0; // [2] called when CSemaphore::Reset(btInt ) acquires AutoLock()
    virtual void OnCurrCounts(AAL::btInt & , AAL::btInt & )     = 0; // [3] called when CSemaphore::CurrCounts(btInt & , btInt & ) acquires AutoLock()
-   virtual void       OnPost(AAL::btInt )                      = 0; // [4] called when CSempahore::Post(btInt )  acquires AutoLock()
+   virtual void       OnPost(AAL::btInt )                      = 0; // [4] called when CSempahore::Post(btInt )  acquires AutoLock() (on entry, Linux)
    virtual void OnUnblockAll()                                 = 0; // [5] called when CSempahore::UnblockAll()  acquires AutoLock()
-   virtual void       OnWait()                                 = 0; // [6] called when CSempahore::Wait()        acquires AutoLock()
-   virtual void       OnWait(AAL::btTime )                     = 0; // [7] called when CSempahore::Wait(btTime ) acquires AutoLock()
+   virtual void       OnWait()                                 = 0; // [6] called when CSempahore::Wait()        acquires AutoLock(), or takes the fast path
+   virtual void       OnWait(AAL::btTime )                     = 0; // [7] called when CSempahore::Wait(btTime ) acquires AutoLock(), or takes the fast path
 };
 
 class OSAL_API EmptyAfterCSemaphoreAutoLock : public AAL::Testing::IAfterCSemaphoreAutoLock
@@ -109,7 +109,8 @@ void rmMessage::setSize(btWSSize PayloadSize)
 //==========================================================================
 CResourceManagerProxy::CResourceManagerProxy() :
    m_fdRMClient(-1),
-   m_bIsOK(false)
+   m_bIsOK(false),
+   m_bRMBinary(false)
 {}
 
 //==========================================================================
@@ -252,10 +253,17 @@ btBool CResourceManagerProxy::GetMessage( NamedValueSet &nvs,
          }
 
          // Covert record into a Named Value for upstream processing
+         nvs = NamedValueSet();
          if( Message.size() >0){
-            nvs = NamedValueSet(Message.payload(), Message.size());
-         }else {
-            nvs = NamedValueSet();
+            if ( ENamedValuesOK == nvs.ReadBinary(Message.payload(), Message.size()) ) {
+               // This Resource Manager reads binary requests too.
+               AutoLock(this);
+               m_bRMBinary = true;
+            } else {
+               nvs = NamedValueSet(Message.payload(), Message.size());
+               // An older Resource Manager echoes the request manifest into its reply.
+               nvs.Delete(RM_MANIFEST_KEY_BINARY_REPLY);
+            }
          }
 
          nvs.Add(RM_MESSAGE_KEY_ID, MapEnumID(Message.id()));
@@ -295,29 +303,28 @@ btBool CResourceManagerProxy::SendRequest(NamedValueSet const   &nvsManifest,
 
    memset(&req, 0, sizeof(req));
 
-   // Marshal the NVS into an ostringstream
-   std::string        temp(nvsManifest);
-   btUnsigned32bitInt len  = temp.length();
-
-   btVirtAddr buf = (btVirtAddr)new(std::nothrow) btByte[len];
-
-   if(NULL == buf){
-      m_bIsOK = false;
-      return IsOK();
+   // Marshal the NVS in its binary form, which the Resource Manager parses far
+   //  faster than the text form, once it has shown that it reads it. Until then
+   //  send text, asking for a binary reply; an older Resource Manager ignores that.
+   //  The driver copies the payload during the ioctl.
+   std::string temp;
+   if ( m_bRMBinary ) {
+      nvsManifest.WriteBinary(temp);
+   } else {
+      NamedValueSet nvsText(nvsManifest);
+      nvsText.Add(RM_MANIFEST_KEY_BINARY_REPLY, true);
+      temp = std::string(nvsText);
    }
 
-   BufFromString(buf, temp);
-
    req.id      = reqid_URMS_RequestDevice;
-   req.size    = len;
-   req.payload = buf;
+   req.size    = temp.length();
+   req.payload = (btVirtAddr)temp.data();
    req.tranID  = (stTransactionID_t const&)tid;
 
    if ( -1 == ioctl(m_fdRMClient, AALRM_IOCTL_SENDMSG, &req) ) {
       perror("CResourceManagerProxy::Send");
       m_bIsOK = false;
    }
-   delete[] buf;
    return IsOK();
 }
 
@@ -148,6 +148,7 @@ private:
 
    int    m_fdRMClient;
    btBool m_bIsOK;
+   btBool m_bRMBinary;   // The Resource Manager has replied in binary, so it reads binary requests.
 }; // class CResourceManagerProxy
 
 
@@ -43,6 +43,7 @@
 #include "aalsdk/aas/ServiceHost.h"
 #include "aalsdk/CAALEvent.h"
 #include "aalsdk/AALLoggerExtern.h"              // AAL Logger
+#include "aalsdk/Runtime.h"                      // AALRUNTIME_CONFIG_PRELOAD_SERVICES
 
 #include "ServiceBroker.h"
 #include "aalsdk/osal/Sleep.h"
@@ -119,10 +120,46 @@ btBool ServiceBroker::init(IBase *pclientBase,
                                                   "Could not allocate ResourceManager.  Possible bad argument or missing client interface.") );
       return false;
    }
+
+   PreloadServices(optArgs);
    return true;
 
 }
 
+//=============================================================================
+// Name: PreloadServices
+// Description: Load the Service libraries named by AALRUNTIME_CONFIG_PRELOAD_SERVICES
+// Interface: protected
+// Inputs: optArgs - may carry AALRUNTIME_CONFIG_RECORD.
+// Comments: Services brokered here are loaded by resourceAllocated(), so
+//           preloading their ServiceHosts keeps dlopen() and the Service
+//           module init off the first allocation. Failures are only logged.
+//           This broker's own library is skipped: the default broker already
+//           holds its ServiceHost.
+//=============================================================================
+void ServiceBroker::PreloadServices(NamedValueSet const &optArgs)
+{
+   std::list<std::string> Names;
+   if ( !GetPreloadServices(optArgs, Names) ) {
+      return;
+   }
+
+   std::list<std::string>::const_iterator iter;
+   for ( iter = Names.begin() ; Names.end() != iter ; ++iter ) {
+      if ( ( 0 == iter->compare("librrmbroker") ) || ( NULL != findServiceHost(*iter) ) ) {
+         continue;
+      }
+
+      ServiceHost *SvcHost = new ServiceHost(iter->c_str());
+      if ( !SvcHost->IsOK() ) {
+         AAL_WARNING(LM_AAS, "Failed to preload Service " << *iter << std::endl);
+         delete SvcHost;
+         continue;
+      }
+      m_ServiceMap[*iter] = SvcHost;
+   }
+}
+
 //=============================================================================
 // Name: ~ServiceBroker
 // Description: IDestructor
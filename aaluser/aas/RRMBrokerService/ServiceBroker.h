@@ -124,6 +124,7 @@ public:
                      TransactionID const    &rTranID);
 protected:
    ServiceHost *findServiceHost(std::string const &sName);
+   void         PreloadServices(NamedValueSet const &optArgs);
 
    // Internal IServiceClient used to allocate Resource Manager
    void serviceAllocated(IBase *pServiceBase,
@@ -39,6 +39,26 @@
 // Lock
 pthread_mutex_t mmio_port_lock;
 
+// MMIO scoreboard lock and wakeups (never wait for credit holding mmio_port_lock)
+// - mmio_rsp_cond[slot] is broadcast when a read response for that slot is in
+// - mmio_credit_cond is broadcast when slots are handed back
+pthread_mutex_t mmio_table_lock  = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t  mmio_rsp_cond[MMIO_MAX_OUTSTANDING];
+pthread_cond_t  mmio_credit_cond = PTHREAD_COND_INITIALIZER;
+
+// Console trace of MMIO traffic
+// Turned off by env(ASE_APP_TRACE)=0 or ase_app_trace(0)
+volatile int app_trace_enable = 1;
+#define APP_TRACE(...)                          \
+  do {                                          \
+    if (app_trace_enable)                       \
+      {                                         \
+        BEGIN_YELLOW_FONTCOLOR;                 \
+        printf(__VA_ARGS__);                    \
+        END_YELLOW_FONTCOLOR;                   \
+      }                                         \
+  } while(0)
+
 /*
  * Existance status
  */
@@ -65,13 +85,21 @@ int userbuf_index_count = 0;   // User count/index
 char *tstamp_string;
 
 // MMIO Scoreboard (used in APP-side only)
+// A slot is a TID credit: taken before the request is sent, returned as
+// soon as its response is in. Read data goes to the caller's mmio_read_t.
 struct mmio_scoreboard_line_t
 {
   int tid;
   uint64_t data;
+  uint32_t addr;
+  int width;
   bool tx_flag;
   bool rx_flag;
+  struct mmio_read_t *rd;
 };
+
+// TID of a slot reserved but not yet sent, never matches a response
+#define MMIO_TID_RESERVED          (-1)
 volatile struct mmio_scoreboard_line_t mmio_table[MMIO_MAX_OUTSTANDING];
 
 // Debug logs
@@ -99,6 +127,9 @@ mmio_t *mmio_rsp_pkt;
 // UMsg Watch TID
 pthread_t umsg_watch_tid;
 
+// Both watchers were started, and are not yet joined
+volatile int watchers_running = 0;
+
 // UMsg byte offset
 const int umsg_byteindex_arr[] =
   {
@@ -108,9 +139,15 @@ const int umsg_byteindex_arr[] =
 // UMsg address array
 char* umsg_addr_array[NUM_UMSG_PER_AFU];
 
+// Last line the watcher sent for each UMsg
+char umsg_sent_data[NUM_UMSG_PER_AFU][CL_BYTE_WIDTH];
+
 // UMAS initialized flag
 volatile int umas_init_flag;
 
+// Watcher passes without sleeping after a UMsg is seen
+#define UMSG_WATCH_BUSY_PASSES     1024
+
 // Time taken calc
 struct timespec start_time_snapshot, end_time_snapshot;
 unsigned long long runtime_nsec;
@@ -118,22 +155,14 @@ unsigned long long runtime_nsec;
 
 /*
  * MMIO Generate TID
- * - Creation of TID must be atomic
+ * - Creation of TID must be atomic (call with mmio_port_lock held)
+ * - The caller must already hold a slot from mmio_reserve_slots()
  */
 uint32_t generate_mmio_tid()
 {
   // Return value
   uint32_t ret_mmio_tid;
 
-  // *FIXME*: TID credit must not overrun, no more than 64 outstanding MMIO Requests
-  while ( count_mmio_tid_used() == MMIO_MAX_OUTSTANDING )
-    {
-#ifdef ASE_DEBUG
-      printf("  [APP]  MMIO TIDs have run out --- waiting !\n");
-#endif
-      usleep(10000);
-    }
-
   // Increment and mask
   ret_mmio_tid = glbl_mmio_tid & MMIO_TID_BITMASK;
   glbl_mmio_tid++;
@@ -154,6 +183,7 @@ void *mmio_response_watcher()
   mmio_rsp_pkt = (struct mmio_t *)ase_malloc( sizeof(struct mmio_t) );
   int ret;
   int slot_idx;
+  int cancel_state;
 
 #ifdef ASE_DEBUG
   char mmio_type[3];
@@ -189,6 +219,10 @@ void *mmio_response_watcher()
           END_YELLOW_FONTCOLOR;
 #endif
 
+          // Not cancellable while holding scoreboard lock
+          pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancel_state);
+          pthread_mutex_lock (&mmio_table_lock);
+
           // Find scoreboard slot number to update
           slot_idx = get_scoreboard_slot_by_tid(mmio_rsp_pkt->tid);
 
@@ -203,19 +237,23 @@ void *mmio_response_watcher()
           else
             //#endif
             {
-              // MMIO Read response (for credit count only)
+              // MMIO Read response, data handed to the reader
               if (mmio_rsp_pkt->write_en == MMIO_READ_REQ)
                 {
-                  mmio_table[slot_idx].tid = mmio_rsp_pkt->tid;
-                  mmio_table[slot_idx].data = mmio_rsp_pkt->qword[0];
-                  mmio_table[slot_idx].tx_flag = true;
-                  mmio_table[slot_idx].rx_flag = true;
+                  mmio_table[slot_idx].rd->data = mmio_rsp_pkt->qword[0];
+                  mmio_table[slot_idx].rd->done = 1;
+                  mmio_table[slot_idx].rd = NULL;
+                  mmio_table[slot_idx].tx_flag = false;
+                  mmio_table[slot_idx].rx_flag = false;
+                  pthread_cond_broadcast (&mmio_rsp_cond[slot_idx]);
+                  pthread_cond_broadcast (&mmio_credit_cond);
                 }
               // MMIO Write response (for credit count only)
               else if (mmio_rsp_pkt->write_en == MMIO_WRITE_REQ)
                 {
                   mmio_table[slot_idx].tx_flag = false;
                   mmio_table[slot_idx].rx_flag = false;
+                  pthread_cond_broadcast (&mmio_credit_cond);
                 }
               /* #ifdef ASE_DEBUG */
               /*          else */
@@ -226,6 +264,9 @@ void *mmio_response_watcher()
               /*            } */
               /* #endif */
             }
+
+          pthread_mutex_unlock (&mmio_table_lock);
+          pthread_setcancelstate(cancel_state, NULL);
         }
     }
 
@@ -250,10 +291,15 @@ void send_swreset()
   BEGIN_YELLOW_FONTCOLOR;
   printf("\n  [APP]  Issuing Soft Reset... \n");
   END_YELLOW_FONTCOLOR;
+  // Wait for outstanding MMIO to drain
+  pthread_mutex_lock (&mmio_table_lock);
   while ( count_mmio_tid_used() != 0 )
     {
-      sleep(1);
+      pthread_cond_wait (&mmio_credit_cond, &mmio_table_lock);
     }
+  pthread_mutex_unlock (&mmio_table_lock);
+
+  ase_trace_swreset();
 
   // Sending reset trigger
   char ase_reset_msg[ASE_MQ_MSGSIZE];
@@ -267,6 +313,37 @@ void send_swreset()
 }
 
 
+/*
+ * Stop watcher threads, before the rings and regions they read go away
+ * - UMsg watcher is asked to stop, and finishes its current pass
+ * - MMIO watcher may be asleep on the response ring, so it is
+ *   cancelled (it is not cancellable while holding the scoreboard lock)
+ * Both are joined: one still running would read unmapped memory
+ */
+static void stop_watchers()
+{
+  if (!watchers_running)
+    {
+      return;
+    }
+  watchers_running = 0;
+
+  // A signal may land on a watcher, it cannot wait for itself
+  umas_exist_status = NOT_ESTABLISHED;
+  if (!pthread_equal(pthread_self(), umsg_watch_tid))
+    {
+      pthread_join (umsg_watch_tid, NULL);
+    }
+
+  mmio_exist_status = NOT_ESTABLISHED;
+  if (!pthread_equal(pthread_self(), mmio_watch_tid))
+    {
+      pthread_cancel (mmio_watch_tid);
+      pthread_join (mmio_watch_tid, NULL);
+    }
+}
+
+
 /*
  * Send SIMKILL
  */
@@ -282,6 +359,10 @@ void send_simkill()
   printf("  [APP]  CTRL-C was seen... SW application will exit\n");
   END_YELLOW_FONTCOLOR;
 
+  // Hand simulator back to pipes
+  stop_watchers();
+  ase_ring_detach();
+
   // MQ close
   mqueue_close(app2sim_mmioreq_tx);
   mqueue_close(sim2app_mmiorsp_rx);
@@ -306,6 +387,8 @@ void session_init()
 {
   FUNC_CALL_ENTRY;
 
+  int sim_pid;
+
   // Start clock
   // start_time_snapshot = clock();
   clock_gettime(CLOCK_MONOTONIC, &start_time_snapshot);
@@ -326,6 +409,20 @@ void session_init()
           exit (EXIT_FAILURE);
         }
 
+      // MMIO response wakeups, one per scoreboard slot
+      int slot;
+      for (slot = 0; slot < MMIO_MAX_OUTSTANDING; slot++)
+        {
+          pthread_cond_init(&mmio_rsp_cond[slot], NULL);
+        }
+
+      // Console trace switch
+      char *trace_env = getenv("ASE_APP_TRACE");
+      if ((trace_env != NULL) && (strcmp(trace_env, "0") == 0))
+        {
+          app_trace_enable = 0;
+        }
+
       // Initialize ase_workdir_path
       BEGIN_YELLOW_FONTCOLOR;
       printf("  [APP]  ASE Session Directory located at =>\n");
@@ -333,7 +430,7 @@ void session_init()
       END_YELLOW_FONTCOLOR;
 
       // Read ready file and check sanity
-      ase_read_lock_file(ase_workdir_path);
+      sim_pid = ase_read_lock_file(ase_workdir_path);
 
       // Register kill signals to issue simkill
       signal(SIGTERM, send_simkill);
@@ -364,6 +461,24 @@ void session_init()
       sim2app_portctrl_rsp_rx = mqueue_open( mq_array[8].name, mq_array[8].perm_flag );
       sim2app_intr_request_rx = mqueue_open( mq_array[9].name, mq_array[9].perm_flag );
 
+      // Negotiate shared memory rings, pipes stay open as fallback
+      if (ase_ring_attach(sim_pid))
+        {
+          ase_ring_bind(app2sim_alloc_tx,        0);
+          ase_ring_bind(app2sim_mmioreq_tx,      1);
+          ase_ring_bind(app2sim_umsg_tx,         2);
+          ase_ring_bind(sim2app_alloc_rx,        3);
+          ase_ring_bind(sim2app_mmiorsp_rx,      4);
+          ase_ring_bind(app2sim_portctrl_req_tx, 5);
+          ase_ring_bind(app2sim_dealloc_tx,      6);
+          ase_ring_bind(sim2app_dealloc_rx,      7);
+          ase_ring_bind(sim2app_portctrl_rsp_rx, 8);
+          ase_ring_bind(sim2app_intr_request_rx, 9);
+          BEGIN_YELLOW_FONTCOLOR;
+          printf("  [APP]  Messaging over shared memory rings\n");
+          END_YELLOW_FONTCOLOR;
+        }
+
       // Message queues have been established
       mq_exist_status = ESTABLISHED;
 
@@ -498,6 +613,7 @@ void session_init()
           END_YELLOW_FONTCOLOR;
         }
       while(umas_init_flag != 1);
+      watchers_running = 1;
 
       // MMIO Scoreboard setup
       int ii;
@@ -507,8 +623,12 @@ void session_init()
           mmio_table[ii].data = 0;
           mmio_table[ii].tx_flag = false;
           mmio_table[ii].rx_flag = false;
+          mmio_table[ii].rd = NULL;
         }
 
+      // Record traffic from here on, if asked to
+      ase_trace_open();
+
       // Session status
       session_exist_status = ESTABLISHED;
 
@@ -542,14 +662,17 @@ void session_deinit()
       // Mark session as destroyed
       session_exist_status = NOT_ESTABLISHED;
 
+      // Stop recording
+      ase_trace_close();
+
       // Unmap UMAS region
       if (umas_exist_status == ESTABLISHED)
         {
           BEGIN_YELLOW_FONTCOLOR;
           printf("  [APP]  Closing Watcher threads\n");
           END_YELLOW_FONTCOLOR;
-          // Close UMsg thread
-          pthread_cancel (umsg_watch_tid);
+          // Close UMsg and MMIO Response tracker threads
+          stop_watchers();
 
           // Deallocate the region
           BEGIN_YELLOW_FONTCOLOR;
@@ -588,8 +711,9 @@ void session_deinit()
       fclose(fp_mmioaccess_log);
 #endif
 
-      // Close MMIO Response tracker thread
-      pthread_cancel (mmio_watch_tid);
+      // Hand simulator back to pipes
+      stop_watchers();
+      ase_ring_detach();
 
       // close message queue
       mqueue_close(app2sim_mmioreq_tx);
@@ -686,52 +810,87 @@ int count_mmio_tid_used()
 
 
 /*
- * MMIO Request call
- * - Return index value
+ * Reserve MMIO scoreboard slots (count <= MMIO_MAX_OUTSTANDING)
+ * - Waits until count slots are free and takes them all at once, so
+ *   two callers never hold part of what the other waits for
+ * - Must not be called with mmio_port_lock held. Slots come back as
+ *   responses arrive, which does not depend on any application thread
  */
-int mmio_request_put(struct mmio_t *pkt)
+void mmio_reserve_slots(int *slot_idx, int count)
 {
-  FUNC_CALL_ENTRY;
+  int ii;
 
+  pthread_mutex_lock (&mmio_table_lock);
+  while ( (MMIO_MAX_OUTSTANDING - count_mmio_tid_used()) < count )
+    {
 #ifdef ASE_DEBUG
-  print_mmiopkt(fp_mmioaccess_log, "Sent", pkt);
+      printf("  [APP]  MMIO TIDs have run out --- waiting !\n");
 #endif
+      pthread_cond_wait (&mmio_credit_cond, &mmio_table_lock);
+    }
 
-  // Update scoreboard
-  int mmiotable_idx;
-  mmiotable_idx = find_empty_mmio_scoreboard_slot();
-  if (mmiotable_idx != 0xFFFF)
+  for (ii = 0; ii < count; ii = ii + 1)
     {
-      mmio_table[mmiotable_idx].tx_flag = true;
-      mmio_table[mmiotable_idx].rx_flag = false;
-      mmio_table[mmiotable_idx].tid = pkt->tid;
-      mmio_table[mmiotable_idx].data = pkt->qword[0];
+      slot_idx[ii] = find_empty_mmio_scoreboard_slot();
+      mmio_table[slot_idx[ii]].tx_flag = true;
+      mmio_table[slot_idx[ii]].rx_flag = false;
+      mmio_table[slot_idx[ii]].tid = MMIO_TID_RESERVED;
+      mmio_table[slot_idx[ii]].rd = NULL;
     }
-  /* #ifdef ASE_DEBUG */
-  else
+  pthread_mutex_unlock (&mmio_table_lock);
+}
+
+
+/*
+ * Fill a reserved scoreboard slot (before its request is sent)
+ */
+static void mmio_slot_fill(int slot_idx, struct mmio_t *pkt, struct mmio_read_t *rd)
+{
+  pthread_mutex_lock (&mmio_table_lock);
+  mmio_table[slot_idx].tid = pkt->tid;
+  mmio_table[slot_idx].data = pkt->qword[0];
+  mmio_table[slot_idx].addr = pkt->addr;
+  mmio_table[slot_idx].width = pkt->width;
+  mmio_table[slot_idx].rd = rd;
+  if (rd != NULL)
     {
-      BEGIN_RED_FONTCOLOR;
-      printf("  [APP] ASE Error generating MMIO TID, simulation cannot proceed !\n");
-      END_RED_FONTCOLOR;
-      raise(SIGABRT);
+      rd->slot  = slot_idx;
+      rd->tid   = pkt->tid;
+      rd->addr  = pkt->addr;
+      rd->width = pkt->width;
+      rd->done  = 0;
     }
-  /* #endif */
+  pthread_mutex_unlock (&mmio_table_lock);
+}
 
-  // Send packet
-  mqueue_send( app2sim_mmioreq_tx, (char*)pkt, sizeof(mmio_t) );
 
-  FUNC_CALL_EXIT;
+/*
+ * MMIO Request call
+ * - slot_idx was reserved by mmio_reserve_slots()
+ * - rd receives the data of a read, NULL for a write
+ * - Call with mmio_port_lock held, after generate_mmio_tid()
+ */
+void mmio_request_put(struct mmio_t *pkt, int slot_idx, struct mmio_read_t *rd)
+{
+  FUNC_CALL_ENTRY;
 
 #ifdef ASE_DEBUG
-  if (pkt->write_en == MMIO_READ_REQ)
+  print_mmiopkt(fp_mmioaccess_log, "Sent", pkt);
+#endif
+
+  // Update scoreboard
+  mmio_slot_fill(slot_idx, pkt, rd);
+
+  // Send packet
+  mqueue_send( app2sim_mmioreq_tx, (char*)pkt, sizeof(mmio_t) );
+
+  // Writes are recorded here, reads once their data is back
+  if (pkt->write_en == MMIO_WRITE_REQ)
     {
-      BEGIN_YELLOW_FONTCOLOR;
-      printf("  [DEBUG]  mmiotable_idx = %d\n", mmiotable_idx);
-      END_YELLOW_FONTCOLOR;
+      ase_trace_mmio(MMIO_WRITE_REQ, pkt->width, pkt->addr, (pkt->width == MMIO_WIDTH_32) ? (uint32_t)pkt->qword[0] : pkt->qword[0]);
     }
-#endif
 
-  return mmiotable_idx;
+  FUNC_CALL_EXIT;
 }
 
 
@@ -742,9 +901,7 @@ void mmio_write32 (int offset, uint32_t data)
 {
   FUNC_CALL_ENTRY;
 
-#ifdef ASE_DEBUG
   int slot_idx;
-#endif
 
   if (offset < 0)
     {
@@ -756,25 +913,24 @@ void mmio_write32 (int offset, uint32_t data)
     }
   else
     {
-      mmio_t *mmio_pkt;
-      mmio_pkt = (struct mmio_t *)ase_malloc( sizeof(struct mmio_t) );
+      mmio_t mmio_pkt;
+      memset(&mmio_pkt, 0, sizeof(mmio_t));
 
-      mmio_pkt->write_en = MMIO_WRITE_REQ;
-      mmio_pkt->width    = MMIO_WIDTH_32;
-      mmio_pkt->addr     = offset;
-      memcpy(mmio_pkt->qword, &data, sizeof(uint32_t));
-      mmio_pkt->resp_en  = 0;
+      mmio_pkt.write_en = MMIO_WRITE_REQ;
+      mmio_pkt.width    = MMIO_WIDTH_32;
+      mmio_pkt.addr     = offset;
+      memcpy(mmio_pkt.qword, &data, sizeof(uint32_t));
+      mmio_pkt.resp_en  = 0;
+
+      // Credit first, then the port
+      mmio_reserve_slots(&slot_idx, 1);
 
       // Critical Section
       {
         pthread_mutex_lock (&mmio_port_lock);
 
-        mmio_pkt->tid = generate_mmio_tid();
-#ifdef ASE_DEBUG
-        slot_idx = mmio_request_put(mmio_pkt);
-#else
-        mmio_request_put(mmio_pkt);
-#endif
+        mmio_pkt.tid = generate_mmio_tid();
+        mmio_request_put(&mmio_pkt, slot_idx, NULL);
 
         pthread_mutex_unlock (&mmio_port_lock);
       }
@@ -785,10 +941,7 @@ void mmio_write32 (int offset, uint32_t data)
       memcpy(mmio_vaddr, (char*)&data, sizeof(uint32_t));
 
       // Display
-      BEGIN_YELLOW_FONTCOLOR;
-      printf("  [APP]  MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%08x\n", mmio_pkt->tid, mmio_pkt->addr, data);
-      END_YELLOW_FONTCOLOR;
-      free(mmio_pkt);
+      APP_TRACE("  [APP]  MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%08x\n", mmio_pkt.tid, mmio_pkt.addr, data);
     }
 
   FUNC_CALL_EXIT;
@@ -802,9 +955,7 @@ void mmio_write64 (int offset, uint64_t data)
 {
   FUNC_CALL_ENTRY;
 
-#ifdef ASE_DEBUG
   int slot_idx;
-#endif
 
   if (offset < 0)
     {
@@ -816,25 +967,24 @@ void mmio_write64 (int offset, uint64_t data)
     }
   else
     {
-      mmio_t *mmio_pkt;
-      mmio_pkt = (struct mmio_t *)ase_malloc( sizeof(struct mmio_t) );
+      mmio_t mmio_pkt;
+      memset(&mmio_pkt, 0, sizeof(mmio_t));
 
-      mmio_pkt->write_en = MMIO_WRITE_REQ;
-      mmio_pkt->width = MMIO_WIDTH_64;
-      mmio_pkt->addr = offset;
-      memcpy(mmio_pkt->qword, &data, sizeof(uint64_t));
-      mmio_pkt->resp_en = 0;
+      mmio_pkt.write_en = MMIO_WRITE_REQ;
+      mmio_pkt.width = MMIO_WIDTH_64;
+      mmio_pkt.addr = offset;
+      memcpy(mmio_pkt.qword, &data, sizeof(uint64_t));
+      mmio_pkt.resp_en = 0;
+
+      // Credit first, then the port
+      mmio_reserve_slots(&slot_idx, 1);
 
       // Critical section
       {
         pthread_mutex_lock (&mmio_port_lock);
 
-        mmio_pkt->tid= generate_mmio_tid();
-#ifdef ASE_DEBUG
-        slot_idx = mmio_request_put(mmio_pkt);
-#else
-        mmio_request_put(mmio_pkt);
-#endif
+        mmio_pkt.tid= generate_mmio_tid();
+        mmio_request_put(&mmio_pkt, slot_idx, NULL);
 
         pthread_mutex_unlock (&mmio_port_lock);
       }
@@ -844,11 +994,7 @@ void mmio_write64 (int offset, uint64_t data)
       mmio_vaddr = (uint64_t*)((uint64_t)mmio_afu_vbase + offset);
       *mmio_vaddr = data;
 
-      BEGIN_YELLOW_FONTCOLOR;
-      printf("  [APP]  MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%llx\n", mmio_pkt->tid, mmio_pkt->addr, (unsigned long long)data);
-      END_YELLOW_FONTCOLOR;
-
-      free(mmio_pkt);
+      APP_TRACE("  [APP]  MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%llx\n", mmio_pkt.tid, mmio_pkt.addr, (unsigned long long)data);
     }
 
   FUNC_CALL_EXIT;
@@ -870,72 +1016,100 @@ void mmio_write64 (int offset, uint64_t data)
  * | MMIO_READ_RSP | MMIO_WIDTH | Data |
  * -------------------------------------
  *
+ * Reads are split in two phases. mmio_read_post() issues a read and
+ * returns without waiting, so one thread may keep several reads in
+ * flight. The response watcher copies the data into the caller's
+ * mmio_read_t and returns the TID credit as soon as the response is
+ * in, so reads posted but not yet collected hold no credit and cannot
+ * starve other threads. mmio_read_wait() sleeps until the data is in.
+ *
  */
 /*
- * MMIO Read 32-bit
+ * MMIO Read post
  */
-void mmio_read32(int offset, uint32_t *data32)
+void mmio_read_post(int offset, int width, struct mmio_read_t *rd)
 {
   FUNC_CALL_ENTRY;
   int slot_idx;
 
-  if (offset < 0)
-    {
-      BEGIN_RED_FONTCOLOR;
-      printf("  [APP]  Requested offset is not in AFU MMIO region\n");
-      printf("         MMIO Read Error\n");
-      END_RED_FONTCOLOR;
-      raise(SIGABRT);
-    }
-  else
-    {
-      mmio_t *mmio_pkt;
-      mmio_pkt = (struct mmio_t *)ase_malloc( sizeof(struct mmio_t) );
+  mmio_t mmio_pkt;
+  memset(&mmio_pkt, 0, sizeof(mmio_t));
 
-      mmio_pkt->write_en = MMIO_READ_REQ;
-      mmio_pkt->width    = MMIO_WIDTH_32;
-      mmio_pkt->addr     = offset;
-      mmio_pkt->resp_en  = 0;
+  mmio_pkt.write_en = MMIO_READ_REQ;
+  mmio_pkt.width    = width;
+  mmio_pkt.addr     = offset;
+  mmio_pkt.resp_en  = 0;
 
-      // Critical section
-      {
-        pthread_mutex_lock (&mmio_port_lock);
+  // Credit first, then the port
+  mmio_reserve_slots(&slot_idx, 1);
 
-        mmio_pkt->tid      = generate_mmio_tid();
-        slot_idx = mmio_request_put(mmio_pkt);
+  // Critical section
+  {
+    pthread_mutex_lock (&mmio_port_lock);
 
-        pthread_mutex_unlock (&mmio_port_lock);
-      }
+    mmio_pkt.tid      = generate_mmio_tid();
+    mmio_request_put(&mmio_pkt, slot_idx, rd);
 
-      BEGIN_YELLOW_FONTCOLOR;
-      printf("  [APP]  MMIO Read      : tid = 0x%03x, offset = 0x%x\n", mmio_pkt->tid, mmio_pkt->addr);
-      END_YELLOW_FONTCOLOR;
+    pthread_mutex_unlock (&mmio_port_lock);
+  }
+
+  APP_TRACE("  [APP]  MMIO Read      : tid = 0x%03x, offset = 0x%x\n", mmio_pkt.tid, mmio_pkt.addr);
 
 #ifdef ASE_DEBUG
-      BEGIN_YELLOW_FONTCOLOR;
-      printf("  [DEBUG]  slot_idx = %d\n", slot_idx);
-      END_YELLOW_FONTCOLOR;
+  BEGIN_YELLOW_FONTCOLOR;
+  printf("  [DEBUG]  slot_idx = %d\n", slot_idx);
+  END_YELLOW_FONTCOLOR;
 #endif
 
-      // Wait until correct response found
-      while (mmio_table[slot_idx].rx_flag != true)
-        {
-          usleep(1);
-        }
+  FUNC_CALL_EXIT;
+}
 
-      // Write data
-      *data32 = (uint32_t)mmio_table[slot_idx].data;
 
-      // Display
-      BEGIN_YELLOW_FONTCOLOR;
-      printf("  [APP]  MMIO Read Resp : tid = 0x%03x, %08x\n", mmio_table[slot_idx].tid, (uint32_t)*data32);
-      END_YELLOW_FONTCOLOR;
+/*
+ * MMIO Read wait
+ */
+uint64_t mmio_read_wait(struct mmio_read_t *rd)
+{
+  FUNC_CALL_ENTRY;
 
-      // Reset scoreboard flags
-      mmio_table[slot_idx].tx_flag = false;
-      mmio_table[slot_idx].rx_flag = false;
+  // Wait until the response is in. The slot may have been reused by
+  // then, its wakeup is broadcast and each waiter checks its own record
+  pthread_mutex_lock (&mmio_table_lock);
+  while (rd->done == 0)
+    {
+      pthread_cond_wait (&mmio_rsp_cond[rd->slot], &mmio_table_lock);
+    }
+  pthread_mutex_unlock (&mmio_table_lock);
+
+  // Display
+  APP_TRACE("  [APP]  MMIO Read Resp : tid = 0x%03x, data = %llx\n", rd->tid, (unsigned long long)rd->data);
+  ase_trace_mmio(MMIO_READ_REQ, rd->width, rd->addr, (rd->width == MMIO_WIDTH_32) ? (uint32_t)rd->data : rd->data);
+
+  FUNC_CALL_EXIT;
+  return rd->data;
+}
 
-      free(mmio_pkt);
+
+/*
+ * MMIO Read 32-bit
+ */
+void mmio_read32(int offset, uint32_t *data32)
+{
+  FUNC_CALL_ENTRY;
+
+  if (offset < 0)
+    {
+      BEGIN_RED_FONTCOLOR;
+      printf("  [APP]  Requested offset is not in AFU MMIO region\n");
+      printf("         MMIO Read Error\n");
+      END_RED_FONTCOLOR;
+      raise(SIGABRT);
+    }
+  else
+    {
+      mmio_read_t rd;
+      mmio_read_post(offset, MMIO_WIDTH_32, &rd);
+      *data32 = (uint32_t)mmio_read_wait(&rd);
     }
 
   FUNC_CALL_EXIT;
@@ -948,11 +1122,6 @@ void mmio_read32(int offset, uint32_t *data32)
 void mmio_read64(int offset, uint64_t *data64)
 {
   FUNC_CALL_ENTRY;
-  int slot_idx;
-
-#ifdef ASE_DEBUG
-  void *retptr;
-#endif
 
   if (offset < 0)
     {
@@ -964,54 +1133,116 @@ void mmio_read64(int offset, uint64_t *data64)
     }
   else
     {
-      mmio_t *mmio_pkt;
-      mmio_pkt = (struct mmio_t *)ase_malloc( sizeof(struct mmio_t) );
+      mmio_read_t rd;
+      mmio_read_post(offset, MMIO_WIDTH_64, &rd);
+      *data64 = mmio_read_wait(&rd);
+    }
 
-      mmio_pkt->write_en = MMIO_READ_REQ;
-      mmio_pkt->width    = MMIO_WIDTH_64;
-      mmio_pkt->addr     = offset;
-      mmio_pkt->resp_en  = 0;
+  FUNC_CALL_EXIT;
+}
 
-      // Critical section
-      {
-        pthread_mutex_lock (&mmio_port_lock);
 
-        mmio_pkt->tid      = generate_mmio_tid();
-        slot_idx = mmio_request_put(mmio_pkt);
+/*
+ * Console trace switch
+ */
+void ase_app_trace(int enable)
+{
+  app_trace_enable = enable;
+}
 
-        pthread_mutex_unlock (&mmio_port_lock);
-      }
 
-      BEGIN_YELLOW_FONTCOLOR;
-      printf("  [APP]  MMIO Read      : tid = 0x%03x, offset = 0x%x\n", mmio_pkt->tid, mmio_pkt->addr);
-      END_RED_FONTCOLOR;
+/* *********************************************************************
+ * MMIO Batch
+ * *********************************************************************
+ *
+ * Up to MMIO_MAX_BATCH request packets are written to the request pipe
+ * with a single write. The simulator side drains them one at a time,
+ * exactly as if they had been sent individually, so ordering is kept.
+ *
+ */
+/*
+ * MMIO batch request (count <= MMIO_MAX_BATCH)
+ * - Reserve a scoreboard slot per access, take a TID for each, send all
+ *   packets at once, then collect read responses in order
+ */
+void mmio_request_batch(int write_en, struct mmio_access_t *acc, int count)
+{
+  FUNC_CALL_ENTRY;
 
-#ifdef ASE_DEBUG
-      BEGIN_YELLOW_FONTCOLOR;
-      printf("  [DEBUG]  slot_idx = %d\n", slot_idx);
-      END_YELLOW_FONTCOLOR;
-#endif
+  mmio_t pkt[MMIO_MAX_BATCH];
+  mmio_read_t rd[MMIO_MAX_BATCH];
+  int slot_idx[MMIO_MAX_BATCH];
+  int ii;
 
-      // Wait for correct response to be back
-      while(mmio_table[slot_idx].rx_flag != true)
+  memset(pkt, 0, count*sizeof(mmio_t));
+  for (ii = 0; ii < count; ii = ii + 1)
+    {
+      pkt[ii].write_en = write_en;
+      pkt[ii].width    = acc[ii].width;
+      pkt[ii].addr     = acc[ii].offset;
+      pkt[ii].resp_en  = 0;
+      if (write_en == MMIO_WRITE_REQ)
         {
-          usleep(1);
-        };
+          if (acc[ii].width == MMIO_WIDTH_32)
+            {
+              uint32_t data32 = (uint32_t)acc[ii].data;
+              memcpy(pkt[ii].qword, &data32, sizeof(uint32_t));
+            }
+          else
+            {
+              memcpy(pkt[ii].qword, &acc[ii].data, sizeof(uint64_t));
+            }
+        }
+    }
 
-      // Write data
-      *data64 = mmio_table[slot_idx].data;
+  // Credit for the whole batch first, then the port
+  mmio_reserve_slots(slot_idx, count);
 
-      // Display
-      BEGIN_YELLOW_FONTCOLOR;
+  // Critical section
+  {
+    pthread_mutex_lock (&mmio_port_lock);
 
-      printf("  [APP]  MMIO Read Resp : tid = 0x%03x, data = %llx\n", mmio_table[slot_idx].tid, (unsigned long long)*data64);
-      END_YELLOW_FONTCOLOR;
+    for (ii = 0; ii < count; ii = ii + 1)
+      {
+        pkt[ii].tid  = generate_mmio_tid();
+        mmio_slot_fill(slot_idx[ii], &pkt[ii], (write_en == MMIO_READ_REQ) ? &rd[ii] : NULL);
+#ifdef ASE_DEBUG
+        print_mmiopkt(fp_mmioaccess_log, "Sent", &pkt[ii]);
+#endif
+      }
+
+    // Send all packets in one message
+    mqueue_send( app2sim_mmioreq_tx, (char*)pkt, count*sizeof(mmio_t) );
 
-      // Reset scoreboard flags
-      mmio_table[slot_idx].tx_flag = false;
-      mmio_table[slot_idx].rx_flag = false;
+    pthread_mutex_unlock (&mmio_port_lock);
+  }
 
-      free(mmio_pkt);
+  for (ii = 0; ii < count; ii = ii + 1)
+    {
+      if (write_en == MMIO_WRITE_REQ)
+        {
+          // Write to MMIO map
+          if (acc[ii].width == MMIO_WIDTH_32)
+            {
+              uint32_t data32 = (uint32_t)acc[ii].data;
+              memcpy((char*)((uint64_t)mmio_afu_vbase + acc[ii].offset), &data32, sizeof(uint32_t));
+            }
+          else
+            {
+              *(uint64_t*)((uint64_t)mmio_afu_vbase + acc[ii].offset) = acc[ii].data;
+            }
+
+          APP_TRACE("  [APP]  MMIO Write     : tid = 0x%03x, offset = 0x%x, data = 0x%llx\n", pkt[ii].tid, pkt[ii].addr, (unsigned long long)acc[ii].data);
+          ase_trace_mmio(MMIO_WRITE_REQ, acc[ii].width, acc[ii].offset, (acc[ii].width == MMIO_WIDTH_32) ? (uint32_t)acc[ii].data : acc[ii].data);
+        }
+      else
+        {
+          // Wait until correct response found
+          if (acc[ii].width == MMIO_WIDTH_32)
+            acc[ii].data = (uint32_t)mmio_read_wait(&rd[ii]);
+          else
+            acc[ii].data = mmio_read_wait(&rd[ii]);
+        }
     }
 
   FUNC_CALL_EXIT;
@@ -1154,6 +1385,9 @@ void allocate_buffer(struct buffer_t *mem, uint64_t *suggested_vaddr)
   ws->buf_structaddr = (uint64_t*)mem;
   append_wsmeta(ws);
 
+  // Record user buffers
+  ase_trace_alloc(mem);
+
 #ifdef ASE_DEBUG
   if (fp_pagetable_log != NULL)
     {
@@ -1196,6 +1430,8 @@ void deallocate_buffer(struct buffer_t *mem)
   printf("  [APP]  Deallocating memory %s ...", mem->memname);
   END_YELLOW_FONTCOLOR;
 
+  ase_trace_dealloc(mem->index);
+
   // Send buffer with metadata = HDR_MEM_DEALLOC_REQ
   // mem->metadata = HDR_MEM_DEALLOC_REQ;
 
@@ -1355,12 +1591,28 @@ void umsg_set_attribute(uint32_t hint_mask)
 
   // Send transaction
   ase_portctrl(umsg_attrib_cmd);
+  ase_trace_umsg_mode(hint_mask);
 
   // Free memory
   ase_free_buffer(umsg_attrib_cmd);
 }
 
 
+/*
+ * umsg_wait_sent : Wait until the watcher has sent line as UMsg umsg_id
+ * - UMsgs are found by comparing UMAS against the last line sent, so a
+ *   line overwritten before the watcher saw it is never sent
+ */
+void umsg_wait_sent(int umsg_id, const char *line)
+{
+  while ( (umas_exist_status == ESTABLISHED) &&
+          (memcmp(umsg_sent_data[umsg_id], line, CL_BYTE_WIDTH) != 0) )
+    {
+      usleep(1);
+    }
+}
+
+
 /*
  * Umsg watcher thread
  * Setup UMSG tracker addresses, and watch for activity
@@ -1373,8 +1625,8 @@ void *umsg_watcher()
   // Generic index
   int cl_index;
 
-  // UMsg old data
-  char umsg_old_data[NUM_UMSG_PER_AFU][CL_BYTE_WIDTH];
+  // Passes left before sleeping again, reloaded whenever a UMsg is sent
+  int busy_passes = 0;
 
   // Declare and Allocate umsgcmd_t packet
   umsgcmd_t *umsg_pkt;
@@ -1384,7 +1636,7 @@ void *umsg_watcher()
   for(cl_index = 0; cl_index < NUM_UMSG_PER_AFU; cl_index++)
     {
       // Original copy
-      memcpy( (char*)umsg_old_data[cl_index],
+      memcpy( (char*)umsg_sent_data[cl_index],
               (char*)((uint64_t)umas_region->vbase + umsg_byteindex_arr[cl_index]),
               CL_BYTE_WIDTH
               );
@@ -1407,7 +1659,7 @@ void *umsg_watcher()
       // Walk through each line
       for(cl_index = 0; cl_index < NUM_UMSG_PER_AFU ; cl_index++)
         {
-          if ( memcmp(umsg_addr_array[cl_index], umsg_old_data[cl_index], CL_BYTE_WIDTH) != 0)
+          if ( memcmp(umsg_addr_array[cl_index], umsg_sent_data[cl_index], CL_BYTE_WIDTH) != 0)
             {
               // Construct UMsg packet
               umsg_pkt->id = cl_index;
@@ -1415,12 +1667,26 @@ void *umsg_watcher()
 
               // Send UMsg
               mqueue_send(app2sim_umsg_tx, (char*)umsg_pkt, sizeof(struct umsgcmd_t));
+              ase_trace_umsg(cl_index, (char*)umsg_pkt->qword);
 
               // Update local mirror
-              memcpy( (char*)umsg_old_data[cl_index], (char*)umsg_pkt->qword, CL_BYTE_WIDTH );
+              memcpy( (char*)umsg_sent_data[cl_index], (char*)umsg_pkt->qword, CL_BYTE_WIDTH );
+
+              busy_passes = UMSG_WATCH_BUSY_PASSES;
             }
         }
-      usleep(1);
+
+      // UMsgs are plain stores to UMAS, so there is nothing to wait on.
+      // They tend to come in bursts: rescan straight away for a while
+      // after one is seen, and sleep between passes only when idle
+      if (busy_passes > 0)
+        {
+          busy_passes--;
+        }
+      else
+        {
+          usleep(1);
+        }
     }
 
   // Free memory
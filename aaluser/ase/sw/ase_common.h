@@ -115,6 +115,11 @@
 #define MMIO_TID_BITMASK           (uint32_t)(pow((uint32_t)2, MMIO_TID_BITWIDTH)-1)
 #define MMIO_MAX_OUTSTANDING       64
 
+// Largest MMIO batch sent as one IPC message. Must not exceed
+// MMIO_MAX_OUTSTANDING, and MMIO_MAX_BATCH * sizeof(mmio_t) must fit
+// in PIPE_BUF so that the write to the request pipe is atomic.
+#define MMIO_MAX_BATCH             32
+
 // Number of UMsgs per AFU
 #define NUM_UMSG_PER_AFU           8
 
@@ -272,6 +277,30 @@ typedef struct mmio_t {
 } mmio_t;
 
 
+/*
+ * Batched MMIO access (see mmio_request_batch)
+ */
+typedef struct mmio_access_t {
+  int      offset;
+  int      width;
+  uint64_t data;
+} mmio_access_t;
+
+
+/*
+ * Posted MMIO read, filled in when its response is in
+ * (see mmio_read_post, mmio_read_wait)
+ */
+typedef struct mmio_read_t {
+  int          slot;
+  int          tid;
+  uint32_t     addr;
+  int          width;
+  uint64_t     data;
+  volatile int done;
+} mmio_read_t;
+
+
 /*
  * Umsg transaction packet
  */
@@ -343,7 +372,9 @@ void ll_traverse_print();
 void ll_append_buffer(struct buffer_t *);
 void ll_remove_buffer(struct buffer_t *);
 uint32_t check_if_physaddr_used(uint64_t);
+uint32_t check_if_physrange_used(uint64_t, uint64_t);
 struct buffer_t* ll_search_buffer(int);
+struct buffer_t* ll_search_physaddr(uint64_t);
 
 // Mem-ops functions
 int ase_recv_msg(struct buffer_t *);
@@ -388,6 +419,18 @@ void mqueue_destroy(char*);
 void mqueue_send(int, const char*, int);
 int mqueue_recv(int, char*, int);
 
+// Shared memory ring operations
+void ase_ring_bind(int, int);
+int ase_ring_tx(int, const char*, int);
+int ase_ring_rx(int, char*, int);
+#ifdef SIM_SIDE
+void ase_ring_create();
+void ase_ring_destroy();
+#else
+int ase_ring_attach(int);
+void ase_ring_detach();
+#endif
+
 // Timestamp functions
 void put_timestamp();
 // char* get_timestamp(int);
@@ -431,18 +474,25 @@ extern "C" {
   int get_scoreboard_slot_by_tid();
   int count_mmio_tid_used();
   uint32_t generate_mmio_tid();
-  int mmio_request_put(struct mmio_t *);
+  void mmio_reserve_slots(int *, int);
+  void mmio_request_put(struct mmio_t *, int, struct mmio_read_t *);
   void mmio_response_get(struct mmio_t *);
   void mmio_write32 (int , uint32_t  );
   void mmio_write64 (int , uint64_t  );
   void mmio_read32  (int , uint32_t* );
   void mmio_read64  (int , uint64_t* );
+  void mmio_read_post(int, int, struct mmio_read_t *);
+  uint64_t mmio_read_wait(struct mmio_read_t *);
+  void mmio_request_batch(int, struct mmio_access_t *, int);
   // UMSG functions
   uint64_t* umsg_get_address(int);
+  void umsg_wait_sent(int, const char *);
   void umsg_send (int , uint64_t *);
   void umsg_set_attribute(uint32_t);
   // Driver activity
   void ase_portctrl(const char *);
+  // Console trace on/off
+  void ase_app_trace(int);
   // Threaded watch processes
   void *mmio_response_watcher();
   // ASE-special malloc
@@ -486,6 +536,106 @@ struct ipc_t
 struct ipc_t mq_array[ASE_MQ_INSTANCES];
 //struct ipc_t *mq_array;
 
+/*
+ * Shared memory ring transport
+ * - Simulator creates one region with an SPSC byte ring per channel,
+ *   named after its PID (readable by application from ready file)
+ * - Application attaches in session_init(), otherwise both sides keep
+ *   using the named pipes above
+ * - Setting env(ASE_IPC_TRANSPORT)=fifo on either side disables rings
+ */
+#define ASE_RING_ENV        "ASE_IPC_TRANSPORT"
+#define ASE_RING_ENV_FIFO   "fifo"
+#define ASE_RING_MAGIC      0x41534552494E4731ULL   // "ASERING1"
+#define ASE_RING_VERSION    2
+#define ASE_RING_SIZE       (64*1024)               // Power of 2, bytes
+#define ASE_RING_SPIN_COUNT 2000                    // Polls before sleeping
+#define ASE_RING_WAIT_NSEC  100000000               // Doorbell wait slice
+
+struct ase_ring_t
+{
+  // Consumer owned
+  volatile uint64_t head __attribute__((aligned(CL_BYTE_WIDTH)));
+  // Producer owned
+  volatile uint64_t tail __attribute__((aligned(CL_BYTE_WIDTH)));
+  // Set by application on attach, consumer skips what is before it
+  volatile uint64_t start;
+  // Doorbell: producer bumps seq, consumer sleeps on it (futex)
+  volatile uint32_t seq  __attribute__((aligned(CL_BYTE_WIDTH)));
+  volatile uint32_t waiters;
+  char data[ASE_RING_SIZE] __attribute__((aligned(CL_BYTE_WIDTH)));
+};
+
+struct ase_ring_region_t
+{
+  uint64_t magic;
+  uint32_t version;
+  uint32_t num_rings;
+  uint32_t ring_size;
+  int32_t  sim_pid;
+  volatile int32_t attached;   // Application PID, 0 when pipes are in use
+  struct ase_ring_t ring[ASE_MQ_INSTANCES] __attribute__((aligned(CL_BYTE_WIDTH)));
+};
+
+
+/* ********************************************************************
+ *
+ * TRACE RECORD/REPLAY
+ * - Application side traffic (buffer alloc/dealloc, MMIO, UMsg, port
+ *   control) is recorded when env(ASE_RECORD_TRACE) names a file
+ * - ase_replay feeds a trace back into the simulator without the app
+ * - File: ase_trace_hdr_t, then ase_trace_rec_t records; ASE_TRACE_UMSG
+ *   records are followed by the CL_BYTE_WIDTH byte UMsg line
+ *
+ * ********************************************************************/
+#define ASE_TRACE_ENV          "ASE_RECORD_TRACE"
+#define ASE_TRACE_MAGIC        "ASETRC01"
+#define ASE_TRACE_VERSION      1
+
+// Record types
+#define ASE_TRACE_ALLOC        0x1    // index, addr = size, data = fake_paddr
+#define ASE_TRACE_DEALLOC      0x2    // index
+#define ASE_TRACE_MMIO_WRITE   0x3    // width, addr = offset, data
+#define ASE_TRACE_MMIO_READ    0x4    // width, addr = offset, data = value read
+#define ASE_TRACE_UMSG         0x5    // index = UMsg id, line follows
+#define ASE_TRACE_UMSG_MODE    0x6    // data = hint mask
+#define ASE_TRACE_SWRESET      0x7
+
+// MMIO write data is a buffer address, index = buffer, data = offset in it
+#define ASE_TRACE_FLAG_RELOC     0x1
+#define ASE_TRACE_FLAG_RELOC_CL  0x2  // ... as a cache line address (>> CL_ALIGN)
+
+struct ase_trace_hdr_t
+{
+  char     magic[8];
+  uint32_t version;
+  uint32_t rec_size;
+};
+
+struct ase_trace_rec_t
+{
+  uint8_t  type;
+  uint8_t  width;
+  uint16_t flags;
+  int32_t  index;
+  uint64_t delta_ns;              // Time since previous record
+  uint64_t addr;
+  uint64_t data;
+};
+
+#ifndef SIM_SIDE
+void ase_trace_open();
+void ase_trace_close();
+void ase_trace_alloc(struct buffer_t *);
+void ase_trace_dealloc(int);
+void ase_trace_mmio(int, int, uint32_t, uint64_t);
+void ase_trace_umsg(int, const char *);
+void ase_trace_umsg_mode(uint32_t);
+void ase_trace_swreset();
+int ase_trace_read_header(FILE *);
+int ase_trace_read(FILE *, struct ase_trace_rec_t *, char *);
+#endif
+
 
 /* ********************************************************************
  *
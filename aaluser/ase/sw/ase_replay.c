@@ -0,0 +1,282 @@
+// Copyright(c) 2014-2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: Replay a recorded application trace into ASE
+ * Language   : C/C++
+ * Owner      : Rahul R Sharma
+ *              rahul.r.sharma@intel.com
+ *              Intel Corporation
+ *
+ * Usage: ase_replay [-t] [-q] <trace file>
+ *   -t : keep recorded time between requests (default: full speed)
+ *   -q : no per-access console trace
+ *
+ * Record a trace by running the application with
+ * env(ASE_RECORD_TRACE)=<trace file>. Buffers are allocated afresh, and
+ * MMIO writes that carried a buffer address are rebased onto the new
+ * buffer. MMIO read results are compared against the recording; exit
+ * status is 1 if any differ.
+ */
+
+#include "ase_common.h"
+
+// Recorded buffer index to replayed buffer
+struct replay_buf_t
+{
+  int rec_index;
+  struct buffer_t *buf;
+};
+static struct replay_buf_t *replay_bufs = (struct replay_buf_t *)NULL;
+static int replay_buf_count = 0;
+static int replay_buf_size = 0;
+
+
+static struct buffer_t *replay_find_buffer(int rec_index)
+{
+  int ii;
+  for(ii = 0; ii < replay_buf_count; ii++)
+    {
+      if (replay_bufs[ii].rec_index == rec_index)
+        return replay_bufs[ii].buf;
+    }
+  return (struct buffer_t *)NULL;
+}
+
+
+static void replay_alloc(struct ase_trace_rec_t *rec)
+{
+  struct buffer_t *buf;
+
+  if (replay_buf_count == replay_buf_size)
+    {
+      replay_buf_size = (replay_buf_size == 0) ? 16 : 2*replay_buf_size;
+      replay_bufs = (struct replay_buf_t *)realloc(replay_bufs, replay_buf_size * sizeof(struct replay_buf_t));
+      if (replay_bufs == NULL)
+        {
+          printf("ase_replay: Out of memory\n");
+          exit(1);
+        }
+    }
+
+  buf = (struct buffer_t *) ase_malloc(sizeof(struct buffer_t));
+  buf->memsize = (uint32_t)rec->addr;
+  allocate_buffer(buf, NULL);
+  if (buf->valid != ASE_BUFFER_VALID)
+    {
+      printf("ase_replay: Buffer %d could not be allocated\n", rec->index);
+      exit(1);
+    }
+
+  replay_bufs[replay_buf_count].rec_index = rec->index;
+  replay_bufs[replay_buf_count].buf = buf;
+  replay_buf_count++;
+}
+
+
+static void replay_dealloc(struct ase_trace_rec_t *rec)
+{
+  int ii;
+
+  for(ii = 0; ii < replay_buf_count; ii++)
+    {
+      if (replay_bufs[ii].rec_index == rec->index)
+        {
+          deallocate_buffer_by_index(replay_bufs[ii].buf->index);
+          replay_bufs[ii] = replay_bufs[replay_buf_count-1];
+          replay_buf_count--;
+          return;
+        }
+    }
+}
+
+
+/*
+ * Rebase MMIO write data that was a buffer address when recorded
+ */
+static uint64_t replay_mmio_data(struct ase_trace_rec_t *rec)
+{
+  struct buffer_t *buf;
+  uint64_t paddr;
+
+  if ((rec->flags & ASE_TRACE_FLAG_RELOC) == 0)
+    {
+      return rec->data;
+    }
+
+  buf = replay_find_buffer(rec->index);
+  if (buf == NULL)
+    {
+      printf("ase_replay: MMIO write refers to unknown buffer %d, sent as recorded\n", rec->index);
+      return rec->data;
+    }
+
+  paddr = buf->fake_paddr + rec->data;
+  if (rec->flags & ASE_TRACE_FLAG_RELOC_CL)
+    {
+      paddr = paddr >> CL_ALIGN;
+    }
+  return paddr;
+}
+
+
+int main(int argc, char **argv)
+{
+  FILE *fp;
+  struct ase_trace_rec_t rec;
+  char line[CL_BYTE_WIDTH];
+  struct timespec gap;
+  uint64_t data;
+  uint32_t data32;
+  uint64_t *umsg_vaddr;
+  unsigned long long records = 0;
+  unsigned long long mismatches = 0;
+  int timed = 0;
+  int argi;
+
+  for(argi = 1; (argi < argc) && (argv[argi][0] == '-'); argi++)
+    {
+      if (strcmp(argv[argi], "-t") == 0)
+        timed = 1;
+      else if (strcmp(argv[argi], "-q") == 0)
+        ase_app_trace(0);
+      else
+        break;
+    }
+  if (argi != argc - 1)
+    {
+      printf("Usage: %s [-t] [-q] <trace file>\n", argv[0]);
+      return 2;
+    }
+
+  fp = fopen(argv[argi], "rb");
+  if (fp == NULL)
+    {
+      perror("fopen");
+      return 2;
+    }
+  if (ase_trace_read_header(fp) != OK)
+    {
+      printf("ase_replay: %s is not an ASE trace (version %d)\n", argv[argi], ASE_TRACE_VERSION);
+      fclose(fp);
+      return 2;
+    }
+
+  // Replaying must not record, least of all over the trace being read
+  unsetenv(ASE_TRACE_ENV);
+  session_init();
+
+  while (ase_trace_read(fp, &rec, line) == OK)
+    {
+      if (timed && (rec.delta_ns > 0))
+        {
+          gap.tv_sec  = rec.delta_ns / 1000000000ULL;
+          gap.tv_nsec = rec.delta_ns % 1000000000ULL;
+          nanosleep(&gap, NULL);
+        }
+
+      switch (rec.type)
+        {
+        case ASE_TRACE_ALLOC:
+          replay_alloc(&rec);
+          break;
+
+        case ASE_TRACE_DEALLOC:
+          replay_dealloc(&rec);
+          break;
+
+        case ASE_TRACE_MMIO_WRITE:
+          data = replay_mmio_data(&rec);
+          if (rec.width == MMIO_WIDTH_32)
+            mmio_write32((int)rec.addr, (uint32_t)data);
+          else
+            mmio_write64((int)rec.addr, data);
+          break;
+
+        case ASE_TRACE_MMIO_READ:
+          if (rec.width == MMIO_WIDTH_32)
+            {
+              mmio_read32((int)rec.addr, &data32);
+              data = data32;
+            }
+          else
+            {
+              mmio_read64((int)rec.addr, &data);
+            }
+          if (data != rec.data)
+            {
+              mismatches++;
+              BEGIN_RED_FONTCOLOR;
+              printf("ase_replay: MMIO read @ 0x%llx = 0x%llx, recorded 0x%llx\n",
+                     (unsigned long long)rec.addr, (unsigned long long)data, (unsigned long long)rec.data);
+              END_RED_FONTCOLOR;
+            }
+          break;
+
+        case ASE_TRACE_UMSG:
+          umsg_vaddr = umsg_get_address(rec.index);
+          if (umsg_vaddr != NULL)
+            {
+              memcpy((char*)umsg_vaddr, line, CL_BYTE_WIDTH);
+              // Else the next record to this UMsg may overwrite it unsent
+              umsg_wait_sent(rec.index, line);
+            }
+          break;
+
+        case ASE_TRACE_UMSG_MODE:
+          umsg_set_attribute((uint32_t)rec.data);
+          break;
+
+        case ASE_TRACE_SWRESET:
+          send_swreset();
+          break;
+
+        default:
+          printf("ase_replay: Unknown record type %d, stopping\n", rec.type);
+          fseek(fp, 0, SEEK_END);
+          break;
+        }
+      records++;
+    }
+
+  fclose(fp);
+
+  // Buffers the recording never freed
+  while (replay_buf_count > 0)
+    {
+      deallocate_buffer_by_index(replay_bufs[replay_buf_count-1].buf->index);
+      replay_buf_count--;
+    }
+  free(replay_bufs);
+
+  session_deinit();
+
+  BEGIN_YELLOW_FONTCOLOR;
+  printf("ase_replay: %llu records replayed, %llu MMIO read mismatches\n", records, mismatches);
+  END_YELLOW_FONTCOLOR;
+
+  return (mismatches == 0) ? 0 : 1;
+}
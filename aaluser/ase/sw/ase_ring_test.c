@@ -0,0 +1,585 @@
+// Copyright(c) 2014-2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: Shared memory ring transport checks
+ * Language   : C/C++
+ * Owner      : Rahul R Sharma
+ *              rahul.r.sharma@intel.com
+ *              Intel Corporation
+ *
+ * Runs both ends of shm_ring_ops.c without an RTL simulator. The
+ * application side comes from libASE; the simulator side is the same
+ * source compiled again here with SIM_SIDE set and its entry points
+ * renamed to sim_ring_*. Simulator and application are separate
+ * processes, as they are under VCS/Questa.
+ *
+ * Checks:
+ *   wraparound : messages that do not divide the ring size, echoed and
+ *                sent in bursts larger than the ring
+ *   resync     : a new application neither reads responses nor has its
+ *                predecessor's requests served after that one died
+ *                attached; ASE_IPC_TRANSPORT=fifo hands simulator back
+ *                to pipes
+ *   peer death : an application asleep on the doorbell returns when
+ *                the simulator is killed
+ *
+ * Exit status is 0 on success, 1 on failure, 77 if shared memory is
+ * not available.
+ */
+
+#include "ase_common.h"
+
+/*
+ * Simulator side of the transport
+ */
+#define SIM_SIDE 1
+#define ase_ring_bind     sim_ring_bind
+#define ase_ring_tx       sim_ring_tx
+#define ase_ring_rx       sim_ring_rx
+#define ase_ring_create   sim_ring_create
+#define ase_ring_destroy  sim_ring_destroy
+
+void sim_ring_bind(int, int);
+int sim_ring_tx(int, const char*, int);
+int sim_ring_rx(int, char*, int);
+void sim_ring_create();
+void sim_ring_destroy();
+
+FILE *local_ipc_fp;
+
+#include "shm_ring_ops.c"
+
+#undef ase_ring_bind
+#undef ase_ring_tx
+#undef ase_ring_rx
+#undef ase_ring_create
+#undef ase_ring_destroy
+#undef SIM_SIDE
+
+
+// Channels under test, as used for MMIO request/response
+#define TEST_REQ_RING       1
+#define TEST_RSP_RING       4
+
+// Channel fds are only binding keys here
+#define APP_REQ_FD          201
+#define APP_RSP_FD          204
+#define SIM_REQ_FD          101
+#define SIM_RSP_FD          104
+
+#define TEST_ECHO_COUNT     2000
+#define TEST_BURST_COUNT    200
+#define TEST_STALE_COUNT    5
+#define TEST_POLL_SEC       10
+#define TEST_TIMEOUT_SEC    120
+
+// Simulator dies this long after application starts waiting
+#define TEST_KILL_USEC      500000
+#define TEST_KILL_WAIT_SEC  5
+
+// Message boundaries drift around the ring, so messages straddle its end
+static const int msg_sizes[] =
+{
+  sizeof(struct mmio_t), 13, 4093, 1, 777, 30011, ASE_RING_SIZE - 1
+};
+#define MSG_SIZE(n)  msg_sizes[(n) % (sizeof(msg_sizes)/sizeof(msg_sizes[0]))]
+
+static char app_buf[ASE_RING_SIZE];
+static char sim_buf[ASE_RING_SIZE];
+
+
+/*
+ * IPC list is kept by ipc_mgmt_ops.c in the simulator
+ */
+void add_to_ipc_list(char *ipc_type, char *ipc_name)
+{
+}
+
+
+/*
+ * test_timeout : SIGALRM handler, a check is stuck
+ */
+static void test_timeout(int sig)
+{
+  const char msg[] = "  timed out\nFAILED\n";
+
+  if (write(STDOUT_FILENO, msg, sizeof(msg) - 1) == -1)
+    {
+      // Exit status says it all anyway
+    }
+  _exit(1);
+}
+
+
+/*
+ * Message contents are a function of sequence number
+ */
+static void msg_fill(char *buf, int size, int seq)
+{
+  int ii;
+
+  for(ii = 0; ii < size; ii++)
+    {
+      buf[ii] = (char)(seq * 131 + ii * 7 + (ii >> 8));
+    }
+}
+
+static int msg_check(const char *buf, int size, int seq)
+{
+  int ii;
+
+  for(ii = 0; ii < size; ii++)
+    {
+      if (buf[ii] != (char)(seq * 131 + ii * 7 + (ii >> 8)))
+        {
+          printf("  message %d: byte %d of %d differs\n", seq, ii, size);
+          return 0;
+        }
+    }
+  return 1;
+}
+
+
+/*
+ * sim_recv : Poll simulator side until a message arrives, as the
+ * simulator does every clock
+ */
+static int sim_recv(char *buf, int size)
+{
+  time_t deadline;
+
+  deadline = time(NULL) + TEST_POLL_SEC;
+  while (sim_ring_rx(SIM_REQ_FD, buf, size) != ASE_MSG_PRESENT)
+    {
+      if (time(NULL) > deadline)
+        {
+          printf("  simulator timed out waiting for a %d byte message\n", size);
+          return 0;
+        }
+      sched_yield();
+    }
+  return 1;
+}
+
+
+/*
+ * sim_setup : Fresh ring region with simulator side bound
+ */
+static int sim_setup()
+{
+  sim_ring_destroy();
+  sim_ring_create();
+  if (ring_region == NULL)
+    {
+      return 0;
+    }
+  sim_ring_bind(SIM_REQ_FD, TEST_REQ_RING);
+  sim_ring_bind(SIM_RSP_FD, TEST_RSP_RING);
+  return 1;
+}
+
+
+/*
+ * app_setup : Attach to simulator with application side bound
+ */
+static int app_setup(int sim_pid)
+{
+  if (!ase_ring_attach(sim_pid))
+    {
+      printf("  application could not attach to rings of PID %d\n", sim_pid);
+      return 0;
+    }
+  ase_ring_bind(APP_REQ_FD, TEST_REQ_RING);
+  ase_ring_bind(APP_RSP_FD, TEST_RSP_RING);
+  return 1;
+}
+
+
+/*
+ * app_send/app_recv : Application side, checked
+ */
+static int app_send(int seq, int size)
+{
+  msg_fill(app_buf, size, seq);
+  if (ase_ring_tx(APP_REQ_FD, app_buf, size) != 1)
+    {
+      printf("  application message %d not taken by ring\n", seq);
+      return 0;
+    }
+  return 1;
+}
+
+static int app_recv(int seq, int size)
+{
+  if (ase_ring_rx(APP_RSP_FD, app_buf, size) != ASE_MSG_PRESENT)
+    {
+      printf("  application did not receive message %d\n", seq);
+      return 0;
+    }
+  return msg_check(app_buf, size, seq);
+}
+
+
+/*
+ * sim_wait_app : Reap application process, 1 if it exited cleanly
+ */
+static int sim_wait_app(pid_t pid, int ok)
+{
+  int status;
+
+  if (!ok)
+    {
+      kill(pid, SIGKILL);
+    }
+  if (waitpid(pid, &status, 0) != pid)
+    {
+      return 0;
+    }
+  return ok && WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+}
+
+
+/*
+ * test_wraparound : Echo, then bursts in both directions
+ */
+static int test_wraparound()
+{
+  pid_t app_pid;
+  int sim_pid;
+  int ok = 1;
+  int n;
+  uint64_t bytes = 0;
+
+  if (!sim_setup())
+    {
+      return 0;
+    }
+  sim_pid = getpid();
+
+  app_pid = fork();
+  if (app_pid == 0)
+    {
+      if (!app_setup(sim_pid))
+        {
+          _exit(1);
+        }
+      for(n = 0; n < TEST_ECHO_COUNT; n++)
+        {
+          if (!app_send(n, MSG_SIZE(n)) || !app_recv(n + TEST_ECHO_COUNT, MSG_SIZE(n)))
+            {
+              _exit(1);
+            }
+        }
+      // Simulator holds off reading, so these wait for room
+      for(n = 0; n < TEST_BURST_COUNT; n++)
+        {
+          if (!app_send(n, MSG_SIZE(n)))
+            {
+              _exit(1);
+            }
+        }
+      for(n = 0; n < TEST_BURST_COUNT; n++)
+        {
+          if (!app_recv(n + TEST_BURST_COUNT, MSG_SIZE(n)))
+            {
+              _exit(1);
+            }
+        }
+      ase_ring_detach();
+      _exit(0);
+    }
+
+  for(n = 0; ok && (n < TEST_ECHO_COUNT); n++)
+    {
+      ok = sim_recv(sim_buf, MSG_SIZE(n)) && msg_check(sim_buf, MSG_SIZE(n), n);
+      if (ok)
+        {
+          msg_fill(sim_buf, MSG_SIZE(n), n + TEST_ECHO_COUNT);
+          ok = sim_ring_tx(SIM_RSP_FD, sim_buf, MSG_SIZE(n));
+          bytes += 2 * MSG_SIZE(n);
+        }
+    }
+
+  usleep(100000);
+  for(n = 0; ok && (n < TEST_BURST_COUNT); n++)
+    {
+      ok = sim_recv(sim_buf, MSG_SIZE(n)) && msg_check(sim_buf, MSG_SIZE(n), n);
+      bytes += MSG_SIZE(n);
+    }
+  // Application is not reading until every request is in, so these wait for room too
+  for(n = 0; ok && (n < TEST_BURST_COUNT); n++)
+    {
+      msg_fill(sim_buf, MSG_SIZE(n), n + TEST_BURST_COUNT);
+      ok = sim_ring_tx(SIM_RSP_FD, sim_buf, MSG_SIZE(n));
+      bytes += MSG_SIZE(n);
+    }
+
+  ok = sim_wait_app(app_pid, ok);
+  printf("  %llu bytes, %llu trips around each ring\n",
+         (unsigned long long)bytes, (unsigned long long)(bytes / 2 / ASE_RING_SIZE));
+  sim_ring_destroy();
+  return ok;
+}
+
+
+/*
+ * test_resync : Application dies attached with requests unserved and
+ * responses unread, then another one attaches
+ */
+static int test_resync()
+{
+  pid_t app_pid;
+  int sim_pid;
+  int ok = 1;
+  int n;
+
+  if (!sim_setup())
+    {
+      return 0;
+    }
+  sim_pid = getpid();
+
+  app_pid = fork();
+  if (app_pid == 0)
+    {
+      if (!app_setup(sim_pid))
+        {
+          _exit(1);
+        }
+      for(n = 0; n < TEST_STALE_COUNT; n++)
+        {
+          app_send(1000 + n, MSG_SIZE(n));
+        }
+      // No ase_ring_detach()
+      _exit(0);
+    }
+  ok = sim_wait_app(app_pid, ok);
+  if (__atomic_load_n(&ring_region->attached, __ATOMIC_ACQUIRE) != app_pid)
+    {
+      printf("  dead application is not left attached\n");
+      ok = 0;
+    }
+
+  // Responses the dead application never read
+  for(n = 0; ok && (n < TEST_STALE_COUNT); n++)
+    {
+      msg_fill(sim_buf, MSG_SIZE(n), 2000 + n);
+      ok = sim_ring_tx(SIM_RSP_FD, sim_buf, MSG_SIZE(n));
+    }
+  if (!ok)
+    {
+      sim_ring_destroy();
+      return 0;
+    }
+
+  app_pid = fork();
+  if (app_pid == 0)
+    {
+      if (!app_setup(sim_pid) || !app_send(3000, sizeof(struct mmio_t)) || !app_recv(4000, sizeof(struct mmio_t)))
+        {
+          _exit(1);
+        }
+      // Dies attached as well, for the fifo check below
+      _exit(0);
+    }
+
+  // Simulator is running all along; only look once the new application is in
+  while (__atomic_load_n(&ring_region->attached, __ATOMIC_ACQUIRE) != app_pid)
+    {
+      sched_yield();
+    }
+  ok = sim_recv(sim_buf, sizeof(struct mmio_t));
+  if (ok && !msg_check(sim_buf, sizeof(struct mmio_t), 3000))
+    {
+      printf("  simulator served a request from the dead application\n");
+      ok = 0;
+    }
+  if (ok)
+    {
+      msg_fill(sim_buf, sizeof(struct mmio_t), 4000);
+      ok = sim_ring_tx(SIM_RSP_FD, sim_buf, sizeof(struct mmio_t));
+    }
+  if (!sim_wait_app(app_pid, ok))
+    {
+      printf("  new application did not get its own response\n");
+      ok = 0;
+    }
+  if (ok && (sim_ring_rx(SIM_REQ_FD, sim_buf, 1) != ASE_MSG_ABSENT))
+    {
+      printf("  stale requests left in ring\n");
+      ok = 0;
+    }
+
+  // A pipe-only application must take the simulator off the rings
+  setenv(ASE_RING_ENV, ASE_RING_ENV_FIFO, 1);
+  if (ok && ase_ring_attach(sim_pid))
+    {
+      printf("  attach succeeded with %s=%s\n", ASE_RING_ENV, ASE_RING_ENV_FIFO);
+      ase_ring_detach();
+      ok = 0;
+    }
+  unsetenv(ASE_RING_ENV);
+  if (ok && (sim_ring_tx(SIM_RSP_FD, sim_buf, 1) != 0))
+    {
+      printf("  simulator still on rings after fifo application attached\n");
+      ok = 0;
+    }
+
+  sim_ring_destroy();
+  return ok;
+}
+
+
+/*
+ * test_peer_death : Simulator killed while application sleeps on doorbell
+ */
+static int test_peer_death()
+{
+  pid_t sim_pid;
+  int ready[2];
+  char c;
+  int ok = 1;
+  int ret;
+  struct timeval t0, t1;
+  long elapsed_usec;
+
+  // Dead simulator must not linger as a zombie, kill(pid, 0) would still see it
+  signal(SIGCHLD, SIG_IGN);
+  if (pipe(ready) == -1)
+    {
+      return 0;
+    }
+
+  sim_pid = fork();
+  if (sim_pid == 0)
+    {
+      close(ready[0]);
+      if (!sim_setup())
+        {
+          _exit(1);
+        }
+      c = 1;
+      if (write(ready[1], &c, 1) != 1)
+        {
+          _exit(1);
+        }
+      usleep(TEST_KILL_USEC);
+      // No ase_ring_destroy(), as when the simulator is killed
+      raise(SIGKILL);
+    }
+
+  close(ready[1]);
+  if (read(ready[0], &c, 1) != 1)
+    {
+      printf("  simulator did not come up\n");
+      ok = 0;
+    }
+  close(ready[0]);
+
+  if (ok)
+    {
+      ok = app_setup(sim_pid);
+    }
+  if (ok)
+    {
+      alarm(TEST_KILL_WAIT_SEC);
+      gettimeofday(&t0, NULL);
+      ret = ase_ring_rx(APP_RSP_FD, app_buf, sizeof(struct mmio_t));
+      gettimeofday(&t1, NULL);
+      alarm(TEST_TIMEOUT_SEC);
+      elapsed_usec = (t1.tv_sec - t0.tv_sec) * 1000000L + (t1.tv_usec - t0.tv_usec);
+      printf("  receive returned after %ld ms\n", elapsed_usec / 1000);
+      if (ret != ASE_MSG_ABSENT)
+        {
+          printf("  receive returned %d with no simulator\n", ret);
+          ok = 0;
+        }
+      else if (elapsed_usec < TEST_KILL_USEC / 2)
+        {
+          printf("  receive did not wait for simulator\n");
+          ok = 0;
+        }
+      ase_ring_detach();
+    }
+
+  if (!ok)
+    {
+      kill(sim_pid, SIGKILL);
+    }
+  snprintf(ring_region_name, ASE_FILENAME_LEN, "/ase_ring.%d", sim_pid);
+  shm_unlink(ring_region_name);
+  signal(SIGCHLD, SIG_DFL);
+  return ok;
+}
+
+
+int main(int argc, char **argv)
+{
+  int failed = 0;
+
+  setvbuf(stdout, NULL, _IONBF, 0);
+  unsetenv(ASE_RING_ENV);
+
+  // Channel directions as seen by application
+  mq_array[TEST_REQ_RING].perm_flag = O_WRONLY;
+  mq_array[TEST_RSP_RING].perm_flag = O_RDONLY;
+
+  // Nothing here should block for long
+  signal(SIGALRM, test_timeout);
+  alarm(TEST_TIMEOUT_SEC);
+
+  if (!sim_setup())
+    {
+      printf("Shared memory not available, skipping\n");
+      return 77;
+    }
+  sim_ring_destroy();
+
+  printf("wraparound\n");
+  if (!test_wraparound())
+    {
+      printf("wraparound FAILED\n");
+      failed++;
+    }
+
+  printf("resync\n");
+  if (!test_resync())
+    {
+      printf("resync FAILED\n");
+      failed++;
+    }
+
+  printf("peer death\n");
+  if (!test_peer_death())
+    {
+      printf("peer death FAILED\n");
+      failed++;
+    }
+
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+  return failed ? 1 : 0;
+}
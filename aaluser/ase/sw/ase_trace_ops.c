@@ -0,0 +1,393 @@
+// Copyright(c) 2014-2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: Record application side ASE traffic (APP_SIDE only)
+ * Language   : C/C++
+ * Owner      : Rahul R Sharma
+ *              rahul.r.sharma@intel.com
+ *              Intel Corporation
+ *
+ * Records are written at the app_backend.c API boundary, so a trace is
+ * what the application asked for, independent of transport. Buffer
+ * contents are not recorded, replay sees freshly allocated buffers.
+ */
+
+#include "ase_common.h"
+
+
+/*
+ * Recorder state, app threads record concurrently
+ */
+static FILE *trace_fp = (FILE *)NULL;
+static pthread_mutex_t trace_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct timespec trace_last_ts;
+
+/*
+ * Live user buffers, to recognize buffer addresses in MMIO write data
+ */
+struct trace_buf_t
+{
+  int index;
+  uint64_t paddr_lo;
+  uint64_t paddr_hi;
+};
+static struct trace_buf_t *trace_bufs = (struct trace_buf_t *)NULL;
+static int trace_buf_count = 0;
+static int trace_buf_size = 0;
+
+
+/*
+ * ase_trace_put : Stamp and write one record (trace_lock held)
+ */
+static void ase_trace_put(struct ase_trace_rec_t *rec, const char *payload, size_t payload_len)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  rec->delta_ns = (uint64_t)(now.tv_sec - trace_last_ts.tv_sec)*1000000000ULL + now.tv_nsec - trace_last_ts.tv_nsec;
+  trace_last_ts = now;
+
+  fwrite(rec, sizeof(struct ase_trace_rec_t), 1, trace_fp);
+  if (payload_len > 0)
+    {
+      fwrite(payload, payload_len, 1, trace_fp);
+    }
+}
+
+
+/*
+ * ase_trace_open : Start recording if env(ASE_RECORD_TRACE) is set
+ */
+void ase_trace_open()
+{
+  FUNC_CALL_ENTRY;
+
+  char *trace_path;
+  struct ase_trace_hdr_t hdr;
+
+  trace_path = getenv(ASE_TRACE_ENV);
+  if ((trace_path == NULL) || (trace_fp != NULL))
+    {
+      return;
+    }
+
+  trace_fp = fopen(trace_path, "wb");
+  if (trace_fp == NULL)
+    {
+      BEGIN_RED_FONTCOLOR;
+      printf("  [APP]  Trace file %s could not be opened, not recording\n", trace_path);
+      END_RED_FONTCOLOR;
+      return;
+    }
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, ASE_TRACE_MAGIC, sizeof(hdr.magic));
+  hdr.version  = ASE_TRACE_VERSION;
+  hdr.rec_size = sizeof(struct ase_trace_rec_t);
+  fwrite(&hdr, sizeof(hdr), 1, trace_fp);
+  clock_gettime(CLOCK_MONOTONIC, &trace_last_ts);
+
+  BEGIN_YELLOW_FONTCOLOR;
+  printf("  [APP]  Recording trace to %s\n", trace_path);
+  END_YELLOW_FONTCOLOR;
+
+  FUNC_CALL_EXIT;
+}
+
+
+/*
+ * ase_trace_close : Stop recording
+ */
+void ase_trace_close()
+{
+  FUNC_CALL_ENTRY;
+
+  pthread_mutex_lock(&trace_lock);
+  if (trace_fp != NULL)
+    {
+      fclose(trace_fp);
+      trace_fp = (FILE *)NULL;
+    }
+  free(trace_bufs);
+  trace_bufs = (struct trace_buf_t *)NULL;
+  trace_buf_count = 0;
+  trace_buf_size = 0;
+  pthread_mutex_unlock(&trace_lock);
+
+  FUNC_CALL_EXIT;
+}
+
+
+/*
+ * ase_trace_alloc : Record user buffer allocation
+ */
+void ase_trace_alloc(struct buffer_t *mem)
+{
+  struct ase_trace_rec_t rec;
+  struct trace_buf_t *grown;
+
+  if ((trace_fp == NULL) || (mem->is_mmiomap == 1) || (mem->is_umas == 1))
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&trace_lock);
+  if (trace_fp != NULL)
+    {
+      if (trace_buf_count == trace_buf_size)
+        {
+          trace_buf_size = (trace_buf_size == 0) ? 16 : 2*trace_buf_size;
+          grown = (struct trace_buf_t *)realloc(trace_bufs, trace_buf_size * sizeof(struct trace_buf_t));
+          if (grown != NULL)
+            {
+              trace_bufs = grown;
+            }
+          else
+            {
+              trace_buf_size = trace_buf_count;
+            }
+        }
+      if (trace_buf_count < trace_buf_size)
+        {
+          trace_bufs[trace_buf_count].index    = mem->index;
+          trace_bufs[trace_buf_count].paddr_lo = mem->fake_paddr;
+          trace_bufs[trace_buf_count].paddr_hi = mem->fake_paddr + mem->memsize;
+          trace_buf_count++;
+        }
+
+      memset(&rec, 0, sizeof(rec));
+      rec.type  = ASE_TRACE_ALLOC;
+      rec.index = mem->index;
+      rec.addr  = mem->memsize;
+      rec.data  = mem->fake_paddr;
+      ase_trace_put(&rec, NULL, 0);
+    }
+  pthread_mutex_unlock(&trace_lock);
+}
+
+
+/*
+ * ase_trace_dealloc : Record buffer deallocation
+ */
+void ase_trace_dealloc(int index)
+{
+  struct ase_trace_rec_t rec;
+  int ii;
+
+  if (trace_fp == NULL)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&trace_lock);
+  if (trace_fp != NULL)
+    {
+      for(ii = 0; ii < trace_buf_count; ii++)
+        {
+          if (trace_bufs[ii].index == index)
+            {
+              trace_bufs[ii] = trace_bufs[trace_buf_count-1];
+              trace_buf_count--;
+              break;
+            }
+        }
+
+      memset(&rec, 0, sizeof(rec));
+      rec.type  = ASE_TRACE_DEALLOC;
+      rec.index = index;
+      ase_trace_put(&rec, NULL, 0);
+    }
+  pthread_mutex_unlock(&trace_lock);
+}
+
+
+/*
+ * ase_trace_mmio : Record MMIO write, or MMIO read with its result
+ * - Write data pointing into a live buffer is tagged, so replay can
+ *   rebase it onto the buffer it allocates in its place
+ */
+void ase_trace_mmio(int write_en, int width, uint32_t offset, uint64_t data)
+{
+  struct ase_trace_rec_t rec;
+  uint64_t cl_addr;
+  int ii;
+
+  if (trace_fp == NULL)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&trace_lock);
+  if (trace_fp != NULL)
+    {
+      memset(&rec, 0, sizeof(rec));
+      rec.type  = (write_en == MMIO_WRITE_REQ) ? ASE_TRACE_MMIO_WRITE : ASE_TRACE_MMIO_READ;
+      rec.width = (uint8_t)width;
+      rec.addr  = offset;
+      rec.data  = data;
+
+      if ((write_en == MMIO_WRITE_REQ) && (data != 0))
+        {
+          cl_addr = data << CL_ALIGN;
+          for(ii = 0; ii < trace_buf_count; ii++)
+            {
+              if ((data >= trace_bufs[ii].paddr_lo) && (data < trace_bufs[ii].paddr_hi))
+                {
+                  rec.flags = ASE_TRACE_FLAG_RELOC;
+                  rec.index = trace_bufs[ii].index;
+                  rec.data  = data - trace_bufs[ii].paddr_lo;
+                  break;
+                }
+              if (((cl_addr >> CL_ALIGN) == data) && (cl_addr >= trace_bufs[ii].paddr_lo) && (cl_addr < trace_bufs[ii].paddr_hi))
+                {
+                  rec.flags = ASE_TRACE_FLAG_RELOC | ASE_TRACE_FLAG_RELOC_CL;
+                  rec.index = trace_bufs[ii].index;
+                  rec.data  = cl_addr - trace_bufs[ii].paddr_lo;
+                  break;
+                }
+            }
+        }
+
+      ase_trace_put(&rec, NULL, 0);
+    }
+  pthread_mutex_unlock(&trace_lock);
+}
+
+
+/*
+ * ase_trace_umsg : Record UMsg line as sent to simulator
+ */
+void ase_trace_umsg(int id, const char *line)
+{
+  struct ase_trace_rec_t rec;
+
+  if (trace_fp == NULL)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&trace_lock);
+  if (trace_fp != NULL)
+    {
+      memset(&rec, 0, sizeof(rec));
+      rec.type  = ASE_TRACE_UMSG;
+      rec.index = id;
+      ase_trace_put(&rec, line, CL_BYTE_WIDTH);
+    }
+  pthread_mutex_unlock(&trace_lock);
+}
+
+
+/*
+ * ase_trace_umsg_mode : Record UMsg hint mask setting
+ */
+void ase_trace_umsg_mode(uint32_t hint_mask)
+{
+  struct ase_trace_rec_t rec;
+
+  if (trace_fp == NULL)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&trace_lock);
+  if (trace_fp != NULL)
+    {
+      memset(&rec, 0, sizeof(rec));
+      rec.type = ASE_TRACE_UMSG_MODE;
+      rec.data = hint_mask;
+      ase_trace_put(&rec, NULL, 0);
+    }
+  pthread_mutex_unlock(&trace_lock);
+}
+
+
+/*
+ * ase_trace_swreset : Record AFU soft reset
+ */
+void ase_trace_swreset()
+{
+  struct ase_trace_rec_t rec;
+
+  if (trace_fp == NULL)
+    {
+      return;
+    }
+
+  pthread_mutex_lock(&trace_lock);
+  if (trace_fp != NULL)
+    {
+      memset(&rec, 0, sizeof(rec));
+      rec.type = ASE_TRACE_SWRESET;
+      ase_trace_put(&rec, NULL, 0);
+    }
+  pthread_mutex_unlock(&trace_lock);
+}
+
+
+/*
+ * ase_trace_read_header : Check trace file header
+ * RETURN OK, or NOT_OK if this is not a trace this build can read
+ */
+int ase_trace_read_header(FILE *fp)
+{
+  struct ase_trace_hdr_t hdr;
+
+  if (fread(&hdr, sizeof(hdr), 1, fp) != 1)
+    {
+      return NOT_OK;
+    }
+  if ( (memcmp(hdr.magic, ASE_TRACE_MAGIC, sizeof(hdr.magic)) != 0) ||
+       (hdr.version != ASE_TRACE_VERSION) ||
+       (hdr.rec_size != sizeof(struct ase_trace_rec_t)) )
+    {
+      return NOT_OK;
+    }
+  return OK;
+}
+
+
+/*
+ * ase_trace_read : Read next record, and its UMsg line into 'line'
+ * (CL_BYTE_WIDTH bytes) if there is one
+ * RETURN OK, or NOT_OK at end of trace
+ */
+int ase_trace_read(FILE *fp, struct ase_trace_rec_t *rec, char *line)
+{
+  if (fread(rec, sizeof(struct ase_trace_rec_t), 1, fp) != 1)
+    {
+      return NOT_OK;
+    }
+  if (rec->type == ASE_TRACE_UMSG)
+    {
+      if (fread(line, CL_BYTE_WIDTH, 1, fp) != 1)
+        {
+          return NOT_OK;
+        }
+    }
+  return OK;
+}
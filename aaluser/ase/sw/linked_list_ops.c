@@ -35,6 +35,108 @@
 
 #include "ase_common.h"
 
+
+/*
+ * Buffer lookup indices, kept alongside the linked list
+ * - Sorted arrays of buffer pointers, searched by bisection
+ * - paddr_index is keyed on fake_paddr; buffer ranges never overlap
+ *   (get_range_checked_physaddr checks whole ranges)
+ * - bufidx_index is keyed on buffer index
+ * - Last physical address hit is cached, as AFU reads/writes mostly
+ *   stream through one buffer
+ */
+struct ll_index_t
+{
+  struct buffer_t **buf;
+  int count;
+  int size;
+};
+static struct ll_index_t paddr_index  = { NULL, 0, 0 };
+static struct ll_index_t bufidx_index = { NULL, 0, 0 };
+static struct buffer_t *paddr_last_hit = (struct buffer_t *)NULL;
+
+static uint64_t ll_paddr_key(struct buffer_t *buf)
+{
+  return buf->fake_paddr;
+}
+
+static uint64_t ll_bufidx_key(struct buffer_t *buf)
+{
+  return (uint64_t)(int64_t)buf->index;
+}
+
+
+/*
+ * ll_index_upper: Position of first entry with key above 'key'
+ */
+static int ll_index_upper(struct ll_index_t *idx, uint64_t key, uint64_t (*keyof)(struct buffer_t *))
+{
+  int lo = 0;
+  int hi = idx->count;
+  int mid;
+
+  while (lo < hi)
+    {
+      mid = lo + (hi - lo)/2;
+      if (keyof(idx->buf[mid]) <= key)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+
+/*
+ * ll_index_insert: Insert buffer, keeping index sorted
+ */
+static void ll_index_insert(struct ll_index_t *idx, struct buffer_t *buf, uint64_t (*keyof)(struct buffer_t *))
+{
+  struct buffer_t **grown;
+  int pos;
+
+  if (idx->count == idx->size)
+    {
+      idx->size = (idx->size == 0) ? 64 : 2*idx->size;
+      grown = (struct buffer_t **)realloc(idx->buf, idx->size * sizeof(struct buffer_t *));
+      if (grown == NULL)
+        {
+          ase_error_report ("realloc", errno, ASE_OS_MALLOC_ERR);
+          printf("SIM-C : Buffer index could not be grown\n");
+          start_simkill_countdown();
+          return;
+        }
+      idx->buf = grown;
+    }
+
+  pos = ll_index_upper(idx, keyof(buf), keyof);
+  memmove(&idx->buf[pos+1], &idx->buf[pos], (idx->count - pos) * sizeof(struct buffer_t *));
+  idx->buf[pos] = buf;
+  idx->count++;
+}
+
+
+/*
+ * ll_index_remove: Remove buffer from index
+ */
+static void ll_index_remove(struct ll_index_t *idx, struct buffer_t *buf, uint64_t (*keyof)(struct buffer_t *))
+{
+  int pos;
+
+  // Walk back over entries with the same key to find this buffer
+  pos = ll_index_upper(idx, keyof(buf), keyof) - 1;
+  while ((pos >= 0) && (idx->buf[pos] != buf) && (keyof(idx->buf[pos]) == keyof(buf)))
+    {
+      pos--;
+    }
+
+  if ((pos >= 0) && (idx->buf[pos] == buf))
+    {
+      memmove(&idx->buf[pos], &idx->buf[pos+1], (idx->count - pos - 1) * sizeof(struct buffer_t *));
+      idx->count--;
+    }
+}
+
 /*
  * ll_print_info: Print linked list node info
  * Thu Oct  2 15:50:06 PDT 2014 : Modified for cleanliness
@@ -98,6 +200,10 @@ void ll_append_buffer(struct buffer_t *new)
   // Adjust end to point to last node
   end = new;
 
+  // Index for lookups
+  ll_index_insert(&paddr_index, new, ll_paddr_key);
+  ll_index_insert(&bufidx_index, new, ll_bufidx_key);
+
   FUNC_CALL_EXIT;
 }
 
@@ -118,6 +224,12 @@ void ll_remove_buffer(struct buffer_t *ptr)
   // Reset linked list traversal
   prev = head;
 
+  // Drop from indices
+  ll_index_remove(&paddr_index, ptr, ll_paddr_key);
+  ll_index_remove(&bufidx_index, ptr, ll_bufidx_key);
+  if (paddr_last_hit == ptr)
+    paddr_last_hit = (struct buffer_t *)NULL;
+
   // If first node is to be deleted
   if(temp == head)
     {
@@ -147,40 +259,57 @@ void ll_remove_buffer(struct buffer_t *ptr)
 
 // --------------------------------------------------------------------
 // search_buffer_ll : Search buffer by ID
-// Pass the head of the linked list along when calling
+// Looked up in buffer index, not by walking the list
 // --------------------------------------------------------------------
 struct buffer_t* ll_search_buffer(int search_index)
 {
   FUNC_CALL_ENTRY;
 
-  struct buffer_t* search_ptr;
+  int pos;
+  struct buffer_t *search_ptr = (struct buffer_t *)NULL;
+
+  pos = ll_index_upper(&bufidx_index, (uint64_t)(int64_t)search_index, ll_bufidx_key) - 1;
+  if ((pos >= 0) && (bufidx_index.buf[pos]->index == search_index))
+    {
+      // Prefer the oldest buffer with this index, as a list walk would
+      while ((pos > 0) && (bufidx_index.buf[pos-1]->index == search_index))
+        pos--;
+      search_ptr = bufidx_index.buf[pos];
+    }
+
+  FUNC_CALL_EXIT;
+  return search_ptr;
+}
 
-  // Start searching from the head
-  search_ptr = head;
 
-  // Traverse linked list starting from head
-  if (search_ptr != NULL)
+/*
+ * ll_search_physaddr: Find buffer containing a fake physical address
+ * RETURN buffer, NULL if address is not in any buffer
+ */
+struct buffer_t* ll_search_physaddr(uint64_t paddr)
+{
+  struct buffer_t *search_ptr;
+  int pos;
+
+  // Streaming accesses hit the same buffer again
+  search_ptr = paddr_last_hit;
+  if ( (search_ptr != NULL) && (paddr >= search_ptr->fake_paddr) && (paddr < search_ptr->fake_paddr_hi) )
     {
-      while(search_ptr->index != search_index)
-        {
-          search_ptr = search_ptr->next;
-          if(search_ptr == NULL)
-            break;
-        }
+      return search_ptr;
     }
 
-  // When found, return pointer to buffer
-  if (search_ptr != NULL)
+  pos = ll_index_upper(&paddr_index, paddr, ll_paddr_key) - 1;
+  if (pos >= 0)
     {
-      if (search_index == (int)search_ptr->index)
-        return search_ptr;
-      else
-        return (struct buffer_t *)NULL;
+      search_ptr = paddr_index.buf[pos];
+      if (paddr < search_ptr->fake_paddr_hi)
+        {
+          paddr_last_hit = search_ptr;
+          return search_ptr;
+        }
     }
-  else
-    return (struct buffer_t *)NULL;
 
-  FUNC_CALL_EXIT;
+  return (struct buffer_t *)NULL;
 }
 
 
@@ -190,21 +319,27 @@ struct buffer_t* ll_search_buffer(int search_index)
  */
 uint32_t check_if_physaddr_used(uint64_t paddr)
 {
-  struct buffer_t *search_ptr;
-  int flag = 0;
+  return (ll_search_physaddr(paddr) != NULL) ? 1 : 0;
+}
 
-  search_ptr = head;
-  while(search_ptr != NULL)
-    {
-      if ( (paddr >= search_ptr->fake_paddr) && (paddr < search_ptr->fake_paddr_hi) )
-        {
-          flag = 1;
-          break;
-        }
-      else
-        {
-          search_ptr = search_ptr->next;
-        }
-    }
-  return flag;
+
+/*
+ * Check if any part of a physical address range is used
+ * RETURN 0 if range is free, 1 if it overlaps a buffer
+ */
+uint32_t check_if_physrange_used(uint64_t paddr, uint64_t size)
+{
+  int pos;
+
+  // Last buffer starting at or below paddr must end before it
+  pos = ll_index_upper(&paddr_index, paddr, ll_paddr_key) - 1;
+  if ((pos >= 0) && (paddr < paddr_index.buf[pos]->fake_paddr_hi))
+    return 1;
+
+  // Next buffer must start at or after end of range
+  pos++;
+  if ((pos < paddr_index.count) && (paddr_index.buf[pos]->fake_paddr < (paddr + size)))
+    return 1;
+
+  return 0;
 }
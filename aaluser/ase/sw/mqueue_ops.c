@@ -338,6 +338,14 @@ void mqueue_send(int mq, const char* str, int size)
   FUNC_CALL_ENTRY;
 
   int ret_tx;
+
+  // Shared memory ring, if negotiated for this channel
+  if (ase_ring_tx(mq, str, size))
+    {
+      FUNC_CALL_EXIT;
+      return;
+    }
+
   ret_tx = write(mq, (void*)str, size);
 
   if ((ret_tx == 0) || (ret_tx != size))
@@ -362,6 +370,14 @@ int mqueue_recv(int mq, char* str, int size)
 
   int ret;
 
+  // Shared memory ring, if negotiated for this channel
+  ret = ase_ring_rx(mq, str, size);
+  if (ret != 0)
+    {
+      FUNC_CALL_EXIT;
+      return ret;
+    }
+
   ret = read(mq, str, size);
   FUNC_CALL_EXIT;
   if (ret > 0)
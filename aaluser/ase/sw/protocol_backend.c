@@ -903,6 +903,20 @@ int ase_init()
   sim2app_portctrl_rsp_tx = mqueue_open(mq_array[8].name,  mq_array[8].perm_flag);
   sim2app_intr_request_tx = mqueue_open(mq_array[9].name,  mq_array[9].perm_flag);
 
+  // Shared memory rings, used instead of the pipes above once an
+  // application attaches to them
+  ase_ring_create();
+  ase_ring_bind(app2sim_alloc_rx,        0);
+  ase_ring_bind(app2sim_mmioreq_rx,      1);
+  ase_ring_bind(app2sim_umsg_rx,         2);
+  ase_ring_bind(sim2app_alloc_tx,        3);
+  ase_ring_bind(sim2app_mmiorsp_tx,      4);
+  ase_ring_bind(app2sim_portctrl_req_rx, 5);
+  ase_ring_bind(app2sim_dealloc_rx,      6);
+  ase_ring_bind(sim2app_dealloc_tx,      7);
+  ase_ring_bind(sim2app_portctrl_rsp_tx, 8);
+  ase_ring_bind(sim2app_intr_request_tx, 9);
+
   // Calculate memory map regions
   printf("SIM-C : Calculating memory map...\n");
   calc_phys_memory_ranges();
@@ -1035,6 +1049,9 @@ void start_simkill_countdown()
   for(ipc_iter = 0; ipc_iter < ASE_MQ_INSTANCES; ipc_iter++)
     mqueue_destroy(mq_array[ipc_iter].name);
 
+  // Remove shared memory rings
+  ase_ring_destroy();
+
   // Destroy all open shared memory regions
   printf("SIM-C : Unlinking Shared memory regions.... \n");
   // ase_destroy();
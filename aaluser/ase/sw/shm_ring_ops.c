@@ -0,0 +1,534 @@
+// Copyright(c) 2014-2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// **************************************************************************
+/*
+ * Module Info: Shared memory ring transport for ASE messaging
+ * Language   : System{Verilog} | C/C++
+ * Owner      : Rahul R Sharma
+ *              rahul.r.sharma@intel.com
+ *              Intel Corporation
+ *
+ * Each messaging channel gets a single-producer/single-consumer byte
+ * ring in one shared memory region created by the simulator. Rings keep
+ * the byte-stream semantics of the named pipes, so mqueue_send() and
+ * mqueue_recv() divert to them transparently once a channel fd is bound.
+ *
+ * Doorbells are futexes on a shared sequence word. eventfd would need
+ * the descriptor passed between simulator and application, which are
+ * unrelated processes.
+ */
+
+#include "ase_common.h"
+#include <limits.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+
+/*
+ * Ring region, mapped by both simulator and application
+ */
+static struct ase_ring_region_t *ring_region = NULL;
+static char ring_region_name[ASE_FILENAME_LEN];
+
+/*
+ * Channel fd to ring bindings
+ */
+struct ase_ring_binding_t
+{
+  int fd;
+  struct ase_ring_t *ring;
+#ifndef SIM_SIDE
+  pthread_mutex_t tx_lock;   // Several APP threads may send on one channel
+#endif
+};
+static struct ase_ring_binding_t ring_binding[ASE_MQ_INSTANCES];
+static int ring_binding_count = 0;
+
+
+/*
+ * ase_ring_enabled : Check env(ASE_IPC_TRANSPORT) does not ask for pipes
+ */
+static int ase_ring_enabled()
+{
+  char *transport;
+
+  transport = getenv(ASE_RING_ENV);
+  if ((transport != NULL) && (strncmp(transport, ASE_RING_ENV_FIFO, strlen(ASE_RING_ENV_FIFO)+1) == 0))
+    {
+      return 0;
+    }
+  return 1;
+}
+
+
+/*
+ * ase_ring_name : Region name is derived from simulator PID
+ */
+static void ase_ring_name(int sim_pid)
+{
+  snprintf(ring_region_name, ASE_FILENAME_LEN, "/ase_ring.%d", sim_pid);
+}
+
+
+/*
+ * ase_ring_active : Rings carry traffic only while an application is attached
+ */
+static int ase_ring_active()
+{
+  if (ring_region == NULL)
+    {
+      return 0;
+    }
+  return (__atomic_load_n(&ring_region->attached, __ATOMIC_ACQUIRE) != 0);
+}
+
+
+/*
+ * ase_ring_peer_alive : Check the other side is still around
+ * - Blocked senders/receivers give up when it is gone, the way a pipe
+ *   returns EOF/EPIPE
+ */
+static int ase_ring_peer_alive()
+{
+  int peer_pid;
+
+#ifdef SIM_SIDE
+  peer_pid = __atomic_load_n(&ring_region->attached, __ATOMIC_ACQUIRE);
+#else
+  peer_pid = ring_region->sim_pid;
+#endif
+  if (peer_pid == 0)
+    {
+      return 0;
+    }
+  if ((kill(peer_pid, 0) == -1) && (errno == ESRCH))
+    {
+      return 0;
+    }
+  return 1;
+}
+
+
+/*
+ * Futex doorbell
+ */
+static void ase_ring_doorbell_wait(volatile uint32_t *seq, uint32_t val)
+{
+  struct timespec ts;
+
+  ts.tv_sec  = 0;
+  ts.tv_nsec = ASE_RING_WAIT_NSEC;
+  syscall(SYS_futex, seq, FUTEX_WAIT, val, &ts, NULL, 0);
+}
+
+static void ase_ring_doorbell_ring(volatile uint32_t *seq)
+{
+  syscall(SYS_futex, seq, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+
+/*
+ * ase_ring_lookup : Find binding for an fd, NULL if it is not carried by a ring
+ */
+static struct ase_ring_binding_t *ase_ring_lookup(int fd)
+{
+  int ii;
+
+  if (!ase_ring_active())
+    {
+      return NULL;
+    }
+
+  for(ii = 0; ii < ring_binding_count; ii++)
+    {
+      if (ring_binding[ii].fd == fd)
+        {
+          return &ring_binding[ii];
+        }
+    }
+  return NULL;
+}
+
+
+/*
+ * ase_ring_bind : Bind channel fd to ring carrying mq_array[index]
+ */
+void ase_ring_bind(int fd, int index)
+{
+  FUNC_CALL_ENTRY;
+
+  if ((ring_region != NULL) && (index >= 0) && (index < ASE_MQ_INSTANCES) && (ring_binding_count < ASE_MQ_INSTANCES))
+    {
+      ring_binding[ring_binding_count].fd   = fd;
+      ring_binding[ring_binding_count].ring = &ring_region->ring[index];
+#ifndef SIM_SIDE
+      pthread_mutex_init(&ring_binding[ring_binding_count].tx_lock, NULL);
+#endif
+      ring_binding_count++;
+    }
+
+  FUNC_CALL_EXIT;
+}
+
+
+/*
+ * ase_ring_put : Copy message into ring, waiting for room if required
+ */
+static void ase_ring_put(struct ase_ring_t *ring, const char *str, int size)
+{
+  uint64_t tail;
+  uint64_t offset;
+  uint64_t first;
+
+  tail = ring->tail;
+  while ( (tail - __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE)) > (uint64_t)(ASE_RING_SIZE - size) )
+    {
+      if (!ase_ring_peer_alive())
+        {
+          return;
+        }
+      sched_yield();
+    }
+
+  offset = tail & (ASE_RING_SIZE - 1);
+  first  = ASE_RING_SIZE - offset;
+  if (first >= (uint64_t)size)
+    {
+      memcpy(&ring->data[offset], str, size);
+    }
+  else
+    {
+      memcpy(&ring->data[offset], str, first);
+      memcpy(&ring->data[0], str + first, size - first);
+    }
+
+  // Publish, then ring doorbell if consumer is (about to be) asleep
+  __atomic_store_n(&ring->tail, tail + size, __ATOMIC_SEQ_CST);
+  __atomic_add_fetch(&ring->seq, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&ring->waiters, __ATOMIC_SEQ_CST) != 0)
+    {
+      ase_ring_doorbell_ring(&ring->seq);
+    }
+}
+
+
+/*
+ * ase_ring_get : Copy message out of ring
+ * - Simulator polls every clock, so it never blocks
+ * - Application spins for a while, then sleeps on doorbell
+ */
+static int ase_ring_get(struct ase_ring_t *ring, char *str, int size, int blocking)
+{
+  uint64_t head;
+  uint64_t offset;
+  uint64_t first;
+  uint64_t start;
+  uint32_t seq;
+  int spins = 0;
+
+  head = ring->head;
+
+  // Requests an earlier application sent but never saw served
+  start = __atomic_load_n(&ring->start, __ATOMIC_ACQUIRE);
+  if ((int64_t)(start - head) > 0)
+    {
+      head = start;
+      __atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+    }
+  while ( (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) - head) < (uint64_t)size )
+    {
+      if (!blocking)
+        {
+          return ASE_MSG_ABSENT;
+        }
+      if (spins < ASE_RING_SPIN_COUNT)
+        {
+          spins++;
+          continue;
+        }
+
+      seq = __atomic_load_n(&ring->seq, __ATOMIC_ACQUIRE);
+      __atomic_add_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+      if ( (__atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) - head) < (uint64_t)size )
+        {
+          ase_ring_doorbell_wait(&ring->seq, seq);
+        }
+      __atomic_sub_fetch(&ring->waiters, 1, __ATOMIC_SEQ_CST);
+
+      if (!ase_ring_peer_alive())
+        {
+          return ASE_MSG_ABSENT;
+        }
+    }
+
+  offset = head & (ASE_RING_SIZE - 1);
+  first  = ASE_RING_SIZE - offset;
+  if (first >= (uint64_t)size)
+    {
+      memcpy(str, &ring->data[offset], size);
+    }
+  else
+    {
+      memcpy(str, &ring->data[offset], first);
+      memcpy(str + first, &ring->data[0], size - first);
+    }
+
+  __atomic_store_n(&ring->head, head + size, __ATOMIC_RELEASE);
+  return ASE_MSG_PRESENT;
+}
+
+
+/*
+ * ase_ring_tx : Send on ring if fd is carried by one
+ * Returns 1 if the message was handled, 0 if caller must use the pipe
+ */
+int ase_ring_tx(int fd, const char *str, int size)
+{
+  struct ase_ring_binding_t *binding;
+
+  binding = ase_ring_lookup(fd);
+  if ((binding == NULL) || (size <= 0) || (size > ASE_RING_SIZE))
+    {
+      return 0;
+    }
+
+#ifndef SIM_SIDE
+  pthread_mutex_lock(&binding->tx_lock);
+#endif
+  ase_ring_put(binding->ring, str, size);
+#ifndef SIM_SIDE
+  pthread_mutex_unlock(&binding->tx_lock);
+#endif
+
+  return 1;
+}
+
+
+/*
+ * ase_ring_rx : Receive from ring if fd is carried by one
+ * Returns ASE_MSG_PRESENT/ABSENT if handled, 0 if caller must use the pipe
+ */
+int ase_ring_rx(int fd, char *str, int size)
+{
+  struct ase_ring_binding_t *binding;
+
+  binding = ase_ring_lookup(fd);
+  if ((binding == NULL) || (size <= 0) || (size > ASE_RING_SIZE))
+    {
+      return 0;
+    }
+
+#ifdef SIM_SIDE
+  return ase_ring_get(binding->ring, str, size, 0);
+#else
+  return ase_ring_get(binding->ring, str, size, 1);
+#endif
+}
+
+
+#ifdef SIM_SIDE
+/*
+ * ase_ring_create : Create ring region (SIM_SIDE)
+ * - Failure is not fatal, application then negotiates pipes
+ */
+void ase_ring_create()
+{
+  FUNC_CALL_ENTRY;
+
+  int fd;
+
+  if (!ase_ring_enabled())
+    {
+      printf("SIM-C : Shared memory rings disabled, using named pipes\n");
+      return;
+    }
+
+  ase_ring_name(getpid());
+  shm_unlink(ring_region_name);
+  fd = shm_open(ring_region_name, O_CREAT|O_RDWR, S_IRUSR|S_IWUSR);
+  if (fd == -1)
+    {
+      ase_error_report("shm_open", errno, ASE_OS_SHM_ERR);
+      return;
+    }
+
+  if (ftruncate(fd, (off_t)sizeof(struct ase_ring_region_t)) == -1)
+    {
+      ase_error_report("ftruncate", errno, ASE_OS_SHM_ERR);
+      close(fd);
+      shm_unlink(ring_region_name);
+      return;
+    }
+
+  ring_region = (struct ase_ring_region_t *) mmap(NULL, sizeof(struct ase_ring_region_t), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ring_region == (struct ase_ring_region_t *) MAP_FAILED)
+    {
+      ase_error_report("mmap", errno, ASE_OS_MEMMAP_ERR);
+      ring_region = NULL;
+      shm_unlink(ring_region_name);
+      return;
+    }
+
+  add_to_ipc_list("SHM", ring_region_name);
+  fflush(local_ipc_fp);
+
+  memset((void*)ring_region, 0, sizeof(struct ase_ring_region_t));
+  ring_region->version   = ASE_RING_VERSION;
+  ring_region->num_rings = ASE_MQ_INSTANCES;
+  ring_region->ring_size = ASE_RING_SIZE;
+  ring_region->sim_pid   = getpid();
+  ring_binding_count     = 0;
+
+  // Magic goes in last, application checks it before anything else
+  __atomic_store_n(&ring_region->magic, ASE_RING_MAGIC, __ATOMIC_RELEASE);
+
+  printf("SIM-C : Shared memory rings created at /dev/shm%s\n", ring_region_name);
+
+  FUNC_CALL_EXIT;
+}
+
+
+/*
+ * ase_ring_destroy : Unmap and unlink ring region (SIM_SIDE)
+ */
+void ase_ring_destroy()
+{
+  FUNC_CALL_ENTRY;
+
+  if (ring_region != NULL)
+    {
+      munmap((void*)ring_region, sizeof(struct ase_ring_region_t));
+      ring_region = NULL;
+      ring_binding_count = 0;
+      shm_unlink(ring_region_name);
+    }
+
+  FUNC_CALL_EXIT;
+}
+
+#else
+
+/*
+ * ase_ring_attach : Negotiate ring transport with simulator (APP_SIDE)
+ * Returns 1 if rings are in use, 0 if application must stay on pipes
+ */
+int ase_ring_attach(int sim_pid)
+{
+  FUNC_CALL_ENTRY;
+
+  int fd;
+  int ii;
+  struct ase_ring_region_t *region;
+
+  if (sim_pid <= 0)
+    {
+      return 0;
+    }
+
+  ase_ring_name(sim_pid);
+  fd = shm_open(ring_region_name, O_RDWR, S_IRUSR|S_IWUSR);
+  if (fd == -1)
+    {
+      // Simulator without ring support, or rings disabled there
+      return 0;
+    }
+
+  region = (struct ase_ring_region_t *) mmap(NULL, sizeof(struct ase_ring_region_t), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (region == (struct ase_ring_region_t *) MAP_FAILED)
+    {
+      return 0;
+    }
+
+  if ( (__atomic_load_n(&region->magic, __ATOMIC_ACQUIRE) != ASE_RING_MAGIC) ||
+       (region->version   != ASE_RING_VERSION) ||
+       (region->num_rings != ASE_MQ_INSTANCES) ||
+       (region->ring_size != ASE_RING_SIZE) )
+    {
+      munmap((void*)region, sizeof(struct ase_ring_region_t));
+      return 0;
+    }
+
+  if (!ase_ring_enabled())
+    {
+      // A previous application may have died attached, make simulator use pipes
+      __atomic_store_n(&region->attached, 0, __ATOMIC_RELEASE);
+      munmap((void*)region, sizeof(struct ase_ring_region_t));
+      return 0;
+    }
+
+  // Discard anything a previous application left unread, and have the
+  // simulator (which owns head there) drop what it left unserved. A dead
+  // application never publishes a partial message, so tail is a boundary
+  for(ii = 0; ii < ASE_MQ_INSTANCES; ii++)
+    {
+      if (mq_array[ii].perm_flag == O_RDONLY)
+        {
+          __atomic_store_n(&region->ring[ii].head,
+                           __atomic_load_n(&region->ring[ii].tail, __ATOMIC_ACQUIRE),
+                           __ATOMIC_RELEASE);
+        }
+      else
+        {
+          __atomic_store_n(&region->ring[ii].start, region->ring[ii].tail, __ATOMIC_RELEASE);
+        }
+    }
+
+  ring_region = region;
+  ring_binding_count = 0;
+  __atomic_store_n(&ring_region->attached, getpid(), __ATOMIC_RELEASE);
+
+  FUNC_CALL_EXIT;
+  return 1;
+}
+
+
+/*
+ * ase_ring_detach : Hand simulator back to pipes and unmap (APP_SIDE)
+ */
+void ase_ring_detach()
+{
+  FUNC_CALL_ENTRY;
+
+  int ii;
+
+  if (ring_region != NULL)
+    {
+      __atomic_store_n(&ring_region->attached, 0, __ATOMIC_RELEASE);
+      for(ii = 0; ii < ring_binding_count; ii++)
+        {
+          pthread_mutex_destroy(&ring_binding[ii].tx_lock);
+        }
+      ring_binding_count = 0;
+      munmap((void*)ring_region, sizeof(struct ase_ring_region_t));
+      ring_region = NULL;
+    }
+
+  FUNC_CALL_EXIT;
+}
+#endif
@@ -0,0 +1,92 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file AALLogRecord.h
+/// @brief Binary record format of the asynchronous logger.
+/// @ingroup Logger
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+///    Records are written to the per-thread rings of an asynchronous CLogger
+///    and, for the ILogger::BINFILE destination, straight to the log file. A
+///    binary log file is one aal_log_file_header followed by records. Each
+///    record is an aal_log_record followed by len bytes of payload, padded to
+///    a multiple of AAL_LOG_REC_ALIGN. utils/aallogdecode renders a binary log
+///    file as the text the logger would have written.
+///
+/// HISTORY:
+/// WHEN:          WHO:     WHAT:@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_AALLOGRECORD_H__
+#define __AALSDK_AALLOGRECORD_H__
+#include <aalsdk/AALTypes.h>
+
+BEGIN_NAMESPACE(AAL)
+
+#define AAL_LOG_FILE_MAGIC    0x474c4c41  /* "ALLG" */
+#define AAL_LOG_FILE_VERSION  1
+
+#define AAL_LOG_REC_ALIGN     8
+#define AAL_LOG_REC_SIZE(__len) ( ( sizeof(struct aal_log_record) + (__len) + AAL_LOG_REC_ALIGN - 1 ) & ~(AAL_LOG_REC_ALIGN - 1) )
+
+/// Longest message payload. Longer messages are truncated.
+#define AAL_LOG_MAX_TEXT      4096
+
+/// Record types.
+#define AAL_LOG_REC_PAD       0  ///< Filler to the end of a ring. Never written to a file.
+#define AAL_LOG_REC_MESSAGE   1  ///< A log message. Payload is the message text.
+#define AAL_LOG_REC_FILE      2  ///< Defines source file id fileid. Payload is the file name.
+#define AAL_LOG_REC_CONFIG    3  ///< Decoration settings from here on. Payload is the prepend string.
+
+/// Decoration flags of an AAL_LOG_REC_CONFIG record, carried in its level field.
+#define AAL_LOG_CFG_PID       0x0001
+#define AAL_LOG_CFG_TIMESTAMP 0x0002
+#define AAL_LOG_CFG_LEVEL     0x0004
+
+struct aal_log_file_header
+{
+   btUnsigned32bitInt magic;      ///< AAL_LOG_FILE_MAGIC
+   btUnsigned32bitInt version;    ///< AAL_LOG_FILE_VERSION
+   btUnsigned64bitInt pid;        ///< Logging process
+   btUnsigned64bitInt start_sec;  ///< Wall clock time of logger start, in seconds since the epoch.
+   btUnsigned64bitInt start_usec;
+};
+
+struct aal_log_record
+{
+   btUnsigned16bitInt type;       ///< AAL_LOG_REC_*
+   btUnsigned16bitInt len;        ///< Payload bytes, excluding padding.
+   btUnsigned16bitInt level;      ///< syslog level of a message, or AAL_LOG_CFG_* flags.
+   btUnsigned16bitInt maskbit;    ///< Lowest set bit (1-64) of the message's LogMask_t, or 0.
+   btUnsigned32bitInt fileid;     ///< Source file id, or 0 if unknown.
+   btUnsigned32bitInt line;       ///< Source line.
+   btUnsigned64bitInt tid;        ///< Logging thread.
+   btUnsigned64bitInt usec;       ///< Microseconds since logger start.
+};
+
+END_NAMESPACE(AAL)
+
+#endif // __AALSDK_AALLOGRECORD_H__
@@ -236,7 +236,7 @@
 #  define AAL_ANY_LOGP(LOGP,ERRLVL,MASK,...) do { \
       AAL::ILogger* __logptr=(LOGP); \
       if (__logptr->IfLog( (MASK), (ERRLVL))) { \
-         __logptr->Log( (ERRLVL), __logptr->GetOss((ERRLVL)) << __VA_ARGS__); \
+         __logptr->Log( (ERRLVL), (MASK), __FILE__, __LINE__, __logptr->GetOss((ERRLVL)) << __VA_ARGS__); \
       } } while (0)
 
 /* original version. new version caches the (LOGP). A bit faster.
@@ -383,7 +383,8 @@ BEGIN_NAMESPACE(AAL)
          COUT,
          CERR,
          SYSLOG,
-         FILE
+         FILE,
+         BINFILE   ///< Binary records (AALLogRecord.h), decoded offline by aallogdecode. Implies asynchronous logging.
       };
       /// @brief Ctor of implicit, Dtor of standard for abstract interface class
       virtual            ~ILogger();
@@ -402,6 +403,9 @@ BEGIN_NAMESPACE(AAL)
       virtual void        Log                (btInt errlevel, btcString psz) = 0;
       virtual void        Log                (btInt errlevel, std::ostringstream &ros) = 0;
       virtual void        Log                (btInt errlevel, std::basic_ostream<char, std::char_traits<char> >& ros) = 0;
+      /// @brief Log a string, with the selection mask and source location of the log statement
+      virtual void        Log                (btInt errlevel, LogMask_t /*mask*/, btcString /*file*/, btInt /*line*/,
+                                              std::basic_ostream<char, std::char_traits<char> >& ros) { Log(errlevel, ros); }
 
       /// @brief if eDest is FILE, there better be a no-null filename
       virtual void        SetDestination     (eLogTo eDest=COUT, std::string sFile="") = 0;
@@ -436,6 +440,14 @@ BEGIN_NAMESPACE(AAL)
       virtual void        SetFlush (btBool flush) = 0;
       virtual btBool      GetFlush () const = 0;
 
+      /// @brief Tells the Logger to hand messages to a background thread instead of writing them
+      ///    in the caller's thread. Messages are written in timestamp order.
+      virtual void        SetAsync (btBool /*fAsync*/) {}
+      virtual btBool      GetAsync () const { return false; }
+
+      /// @brief Waits until every message logged so far has been written.
+      virtual void        Flush () {}
+
    }; // class ILogger
 
    // AAL scope, get a heap-allocated instance of an object that implements ILogger
@@ -58,7 +58,7 @@ class NVSMarshaller : public IAALMarshaller
 public:
    NVSMarshaller() :
       m_NamedValueSet(),
-      m_tempbuf(NULL)
+      m_msg()
    {}
 
    ENamedValues   Empty() { return m_NamedValueSet.Empty(); }
@@ -109,24 +109,19 @@ public:
    ENamedValues Add(btStringKey Name, btStringArray value,           btUnsigned32bitInt NumElements) { return m_NamedValueSet.Add(Name, value, NumElements); }
    ENamedValues Add(btStringKey Name, btObjectArray value,           btUnsigned32bitInt NumElements) { return m_NamedValueSet.Add(Name, value, NumElements); }
 
-    // Extract a byte stream from marshaller
+   // Extract a byte stream from marshaller. The stream is the binary form of the
+   // NVS, and remains valid until the next call or until the marshaller is destroyed.
    btcString pmsgp(btWSSize *len)
    {
-      std::ostringstream oss;
-      oss << m_NamedValueSet << '\0';  // add a final, ensuring, terminating null
-      std::string s = oss.str();
-      if ( NULL != m_tempbuf ) {
-         delete[] m_tempbuf;
-      }
-      *len = (btWSSize)s.length();
-      m_tempbuf = new char[(size_t)*len];
-      BufFromString(m_tempbuf, s);
-      return m_tempbuf;
+      m_msg.clear();
+      m_NamedValueSet.WriteBinary(m_msg);
+      *len = (btWSSize)m_msg.length();
+      return m_msg.data();
    }
 
 protected:
    NamedValueSet m_NamedValueSet;
-   btString      m_tempbuf;
+   std::string   m_msg;
 };
 
 
@@ -188,11 +183,14 @@ public:
    ENamedValues Get(btStringKey Name, btStringArray *pValue)           const { return m_NamedValueSet.Get(Name, pValue); }
    ENamedValues Get(btStringKey Name, btObjectArray *pValue)           const { return m_NamedValueSet.Get(Name, pValue); }
 
-   // Import a byte stream to the marshaller
+   // Import a byte stream to the marshaller. Streams in the text form of the NVS,
+   // from senders that predate the binary form, are still accepted.
    void importmsg(char const * pmsg, btWSSize len)
    {
       m_NamedValueSet.Empty();
-      m_NamedValueSet.FromStr(const_cast<char *>(pmsg), len);
+      if ( ENamedValuesBadType == m_NamedValueSet.ReadBinary(pmsg, len) ) {
+         m_NamedValueSet.FromStr(const_cast<char *>(pmsg), len);
+      }
    }
 
 protected:
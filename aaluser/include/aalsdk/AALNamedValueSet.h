@@ -153,11 +153,14 @@ public:
       FromStr(rstr);
    }
 
-   /// NamedValueSet Construct from btcString, btWSSize
+   /// NamedValueSet Construct from a buffer holding either the binary form written
+   /// by WriteBinary() or the text form written by ToStr().
    NamedValueSet(void *p, btWSSize sz) :
       m_namedvalues(AAL::NewNVS())
    {
-      FromStr(p, sz);
+      if ( ENamedValuesBadType == ReadBinary(p, sz) ) {
+         FromStr(p, sz);
+      }
    }
 
    /// NamedValueSet type conversion to std::string
@@ -317,6 +320,9 @@ public:
    virtual ENamedValues FromStr(void *p, btWSSize sz)                        { return m_namedvalues->FromStr(p, sz);     }
    virtual std::string    ToStr() const                                      { return m_namedvalues->ToStr();            }
 
+   virtual ENamedValues WriteBinary(std::string &s)                    const { return m_namedvalues->WriteBinary(s);     }
+   virtual ENamedValues  ReadBinary(const void *p, btWSSize sz)              { return m_namedvalues->ReadBinary(p, sz);  }
+
 protected:
    virtual ENamedValues               Copy(const INamedValueSet &Other)      { return m_namedvalues->Copy(Other);        }
    virtual INamedValueSet *          Clone()                           const { return m_namedvalues->Clone();            }
@@ -69,6 +69,7 @@
 #include <aalsdk/osal/CriticalSection.h>
 #include <aalsdk/CAALBase.h>
 #include <aalsdk/CCountedObject.h>
+#include <aalsdk/CObjectPool.h>
 #include <aalsdk/CUnCopyable.h>
 #include <aalsdk/osal/IDispatchable.h>
 #include <aalsdk/IServiceClient.h>
@@ -105,10 +106,15 @@ BEGIN_NAMESPACE(AAL)
 ******************************************************************************/
 
 /// Concrete implementation of IEvent.
-class AASLIB_API CAALEvent : protected CriticalSection,
-                             public    CCountedObject,
-                             public    IDispatchable,
-                             public    IEvent
+///
+/// Events are allocated from EventPool() and recycled there when deleted.
+///
+/// An event is filled in by its creator before it is dispatched, and is read-only from then
+/// on, so it carries no lock. The setters (setHandler(), SetObject(), SetTranID(), ..) are for
+/// the event's current owner only.
+class AASLIB_API CAALEvent : public CCountedObject,
+                             public IDispatchable,
+                             public IEvent
 {
 public:
    /// CAALEvent construct from IBase *. Sub-class interface id is iidEvent.
@@ -153,9 +159,19 @@ public:
    /// @return void
    virtual void operator()();
 
-   /// Deletes this.
+   /// Deletes this, returning its memory to EventPool().
    virtual void Delete();
 
+   /// The pool that CAALEvent and its subclasses are allocated from.
+   ///
+   /// Its CObjectPool::GetStats() counts live and pooled events.
+   static CObjectPool & EventPool();
+
+   static void * operator new(std::size_t Size);
+   static void * operator new(std::size_t Size, const std::nothrow_t & ) throw();
+   static void   operator delete(void *p);
+   static void   operator delete(void *p, const std::nothrow_t & ) throw();
+
 protected:
 
    // Sets an interface pointer on the object.
@@ -175,15 +191,7 @@ protected:
    virtual ~CAALEvent();
 
    /// CAALEvent copy constructor.
-   CAALEvent(const CAALEvent &other) :
-      m_pObject(other.m_pObject),
-      m_bIsOK(other.m_bIsOK),
-      m_pServiceClient(other.m_pServiceClient),
-      m_pRuntimeClient(other.m_pRuntimeClient),
-      m_pEventHandler(other.m_pEventHandler),
-      m_SubClassID(other.m_SubClassID),
-      m_InterfaceMap(other.m_InterfaceMap)
-   {}
+   CAALEvent(const CAALEvent &other);
 
    IBase                *m_pObject;
    btBool                m_bIsOK;
@@ -192,14 +200,19 @@ protected:
    btEventHandler        m_pEventHandler;
    btIID                 m_SubClassID;
 
-#if defined( __AAL_WINDOWS__ )
-# pragma warning( push )
-# pragma warning( disable:4251 )  // Cannot export template definitions
-#endif
-   iidInterfaceMap_t     m_InterfaceMap;
-#if defined( __AAL_WINDOWS__ )
-# pragma warning( pop )
-#endif
+   // Interfaces are kept inline, in the order they were set. Events implement only a handful,
+   //  so the overflow map is rarely needed.
+   enum { InlineInterfaces = 8 };
+
+   struct InterfaceEntry
+   {
+      btIID              m_ID;
+      btGenericInterface m_pInterface;
+   };
+
+   InterfaceEntry        m_Interfaces[InlineInterfaces];
+   btUnsignedInt         m_NumInterfaces;
+   iidInterfaceMap_t    *m_pMoreInterfaces;
 };
 
 
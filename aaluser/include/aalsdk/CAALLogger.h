@@ -58,8 +58,13 @@
 #include <aalsdk/osal/Sleep.h>
 #include <aalsdk/AALDefs.h>
 
+#include <list>
+#include <vector>
+
 BEGIN_NAMESPACE(AAL)
 
+struct aal_log_record;
+
 
 enum LoggerConstants {
    TempStringLength = 128       // length for a buffer for strerror_r
@@ -167,7 +172,6 @@ private:
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif // _MSC_VER
-   PIDossMap            m_PIDossMap;	// map of ThreadID/PID to ostringstream
 #ifdef _MSC_VER
 # pragma warning(push)
 # pragma warning(disable:4251)
@@ -183,6 +187,61 @@ private:
 
    // Prepend the ostringstream with time-stamp and thread-id etc.
    void                 PreloadOss     (std::ostringstream* poss, int errLevel);
+   void                 DecorateOss    (std::ostringstream* poss, int errLevel,
+                                        btUnsigned64bitInt tid, btUnsigned64bitInt usec);
+   btUnsigned64bitInt   ElapsedUsec    () const;
+
+   // Write a fully formatted message to the destination.
+   void                 Write          (int errLevel, const std::string &s);
+
+   // Per-thread logging state, found without locking. Holds the thread's ostringstream,
+   //  scratch string, record ring and source file id cache.
+   struct ThreadState;
+   // Single producer / single consumer ring of aal_log_record's (AALLogRecord.h).
+   class  LogRing;
+
+   ThreadState *        GetThreadState ();
+   static void          ReleaseThreadState(void *pState);
+#if   defined( __AAL_WINDOWS__ )
+   DWORD                m_TLSIndex;
+#elif defined( __AAL_LINUX__ )
+   pthread_key_t        m_TLSKey;
+#endif // OS
+
+   //
+   // Asynchronous mode: callers copy records into their thread's LogRing, and the drain
+   //  thread merges the rings in timestamp order and writes them to the destination.
+   //
+   volatile btBool      m_bAsync;
+   CriticalSection      m_RingLock;       // Guards m_ThreadStates, m_Rings and the file id table.
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif // _MSC_VER
+   std::list<ThreadState *>                  m_ThreadStates;
+   std::list<LogRing *>                      m_Rings;
+   std::map<std::string, btUnsigned32bitInt> m_FileIds;    // Source file name to id (1-based).
+   std::vector<std::string>                  m_FileNames;  // Indexed by id - 1.
+   std::ostringstream                        m_DrainOss;   // Drain thread's formatting stream.
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif // _MSC_VER
+   btUnsigned32bitInt   m_FilesWritten;   // BINFILE: file ids defined in the file so far.
+   btUnsigned32bitInt   m_ConfigGen;      // Bumped by the decoration setters.
+   btUnsigned32bitInt   m_ConfigWritten;  // BINFILE: m_ConfigGen last written to the file.
+
+   OSLThread           *m_pDrainThread;
+   CSemaphore           m_drainEvent;
+   volatile btBool      m_bExitDrainThread;
+
+   btUnsigned32bitInt   FileId         (ThreadState *pState, btcString file);
+   void                 Push           (int errLevel, LogMask_t mask, btcString file, btInt line,
+                                        const char *psz, size_t len);
+   void                 Drain          ();
+   void                 WriteRecord    (const struct aal_log_record *pRec);
+   void                 StartDrainThread();
+   void                 StopDrainThread();
+   static void          DrainThread    (OSLThread *pThread, void *pContext);
 
   // Return a temporary thread-specific string based on index.
   // Will never fail. Return ptr will always be valid. Buffer Length is TempStringLength.
@@ -299,6 +358,8 @@ public:
    void        Log                  (int errlevel, const char* psz);
    void        Log                  (int errlevel, std::ostringstream& ros);
    void        Log                  (int errlevel, std::basic_ostream<char, std::char_traits<char> > &rbos);
+   void        Log                  (int errlevel, LogMask_t mask, btcString file, btInt line,
+                                     std::basic_ostream<char, std::char_traits<char> > &rbos);
 
    // if eDest is FILE, there better be a filename
    void        SetDestination       (eLogTo eDest=COUT, std::string sFile="");
@@ -334,6 +395,13 @@ public:
    void        SetFlush (btBool flush);
    btBool      GetFlush () const;
 
+   // Hand messages to a background thread instead of writing them in the caller's thread
+   void        SetAsync (btBool fAsync);
+   btBool      GetAsync () const;
+
+   // Wait until every message logged so far has been written
+   void        Flush ();
+
    void		   	SetAutoFlushTime( unsigned int seconds );
    unsigned int GetAutoFlushTime( void ) const;
 
@@ -0,0 +1,130 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file CObjectPool.h
+/// @brief Definition of class CObjectPool.
+/// @ingroup AASUtils
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+///    A recycling allocator for small objects that are created and destroyed
+///    at a high rate, such as events and dispatchables. Classes route their
+///    operator new / operator delete to a pool; freed blocks are kept on a
+///    free list per size class and handed out again by later allocations.@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_COBJECTPOOL_H__
+#define __AALSDK_COBJECTPOOL_H__
+#include <aalsdk/AALTypes.h>
+#include <aalsdk/CUnCopyable.h>
+
+#include <cstddef>
+#include <new>
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup AASUtils
+/// @{
+
+/// Thread-safe recycling allocator for small objects.
+///
+/// Requests are rounded up to a multiple of 16 bytes. Requests up to 512 bytes are served
+/// from a free list for their size, which keeps at most MaxPooled() blocks; larger requests
+/// always go to the heap. Each free list has its own spin lock, held only to link or unlink
+/// one block.
+class AASLIB_API CObjectPool : private CUnCopyable
+{
+public:
+   /// Allocation counters.
+   struct Stats
+   {
+      btUnsigned64bitInt Live;        ///< Blocks currently allocated from the pool.
+      btUnsigned64bitInt Pooled;      ///< Freed blocks waiting on a free list.
+      btUnsigned64bitInt HeapAllocs;  ///< Allocations that went to the heap.
+      btUnsigned64bitInt Reuses;      ///< Allocations served from a free list.
+   };
+
+   /// CObjectPool Constructor.
+   ///
+   /// @param[in]  MaxPooled  The most freed blocks kept per size class.
+   CObjectPool(btUnsignedInt MaxPooled=1024);
+   /// Returns the pooled blocks to the heap. Blocks that are still live must not be freed afterwards.
+   ~CObjectPool();
+
+   /// Allocate Size bytes, aligned for any type.
+   ///
+   /// @return The block, or NULL if the heap is exhausted.
+   void * Allocate(std::size_t Size) throw();
+   /// Return a block from Allocate() to the pool. NULL is ignored.
+   void   Free(void *p) throw();
+
+   /// Return all pooled blocks to the heap.
+   void   Trim();
+
+   /// The most freed blocks kept per size class.
+   btUnsignedInt MaxPooled() const            { return m_MaxPooled; }
+   /// Set the most freed blocks kept per size class. 0 disables recycling.
+   void          MaxPooled(btUnsignedInt Max) { m_MaxPooled = Max;  }
+
+   /// Read the allocation counters.
+   void GetStats(Stats &rStats) const;
+
+private:
+   enum {
+      Granule = 16,                          // Size class width and block alignment
+      Classes = 32                           // Pooled sizes: 16 .. Classes * Granule bytes
+   };
+
+   // Precedes each block handed out; its size keeps the block Granule-aligned.
+   union BlockHeader
+   {
+      btUnsignedInt  m_Class;                // Size class, or Classes for a heap-only block
+      BlockHeader   *m_pNext;                // Link on a free list
+      char           m_Align[Granule];
+   };
+
+   struct SizeClass
+   {
+      volatile btInt      m_Lock;
+      BlockHeader        *m_pHead;
+      btUnsignedInt       m_Pooled;
+      btUnsigned64bitInt  m_Live;
+      btUnsigned64bitInt  m_HeapAllocs;
+      btUnsigned64bitInt  m_Reuses;
+   };
+
+   static void   Lock(SizeClass &c);
+   static void Unlock(SizeClass &c);
+
+   volatile btUnsignedInt m_MaxPooled;
+   SizeClass              m_Classes[Classes + 1];  // The last one counts heap-only blocks
+};
+
+/// @}
+
+END_NAMESPACE(AAL)
+
+#endif // __AALSDK_COBJECTPOOL_H__
+
@@ -839,6 +839,28 @@ public:
    /// @return String containing the serialized NameValueSet.
    virtual std::string ToStr() const                                                 = 0;
 
+   /// @brief Appends the compact binary serialization of the NVS to a std::string.
+   ///
+   /// The binary form is written in host byte order, for exchange between processes
+   /// on the same machine. It is much cheaper to produce and parse than the text
+   /// form written by Write().
+   ///
+   /// <B>Parameters:</B> [out] String to which the binary form is appended.
+   /// @retval ENamedValuesOK   On success.
+   /// @retval Other ENamedValues value on failure.
+   virtual ENamedValues WriteBinary(std::string & ) const                            = 0;
+   /// @brief Adds the contents of an NVS serialized by WriteBinary().
+   ///
+   /// As with Read(), the NVS is not emptied first. Names already present keep
+   /// their current values.
+   ///
+   /// <B>Parameters:</B> [in]  Pointer to the binary form.\n
+   /// <B>Parameters:</B> [in]  Length of the binary form.
+   /// @retval ENamedValuesOK   On success.
+   /// @retval ENamedValuesBadType  The buffer does not hold the binary form.
+   /// @retval Other ENamedValues value on failure.
+   virtual ENamedValues ReadBinary(const void * , btWSSize )                         = 0;
+
 protected:
    // Make this equal to the given INamedValueSet.
    virtual ENamedValues               Copy(const INamedValueSet & )                  = 0;
@@ -922,6 +944,11 @@ public:
    //=======================================================================
    CValue & operator = (const CValue &rOther);
 
+   //=======================================================================
+   //Exchange contents with another CValue, without copying
+   //=======================================================================
+   void Swap(CValue &rOther);
+
    //=======================================================================
    //Type Accessors
    //=======================================================================
@@ -75,6 +75,32 @@ BEGIN_NAMESPACE(AAL)
 #define AALRUNTIME_CONFIG_RECORD          "AALRUNTIME_CONFIG_RECORD"
 #define AALRUNTIME_CONFIG_BROKER_SERVICE  "AALRUNTIME_CONFIG_BROKER_SERVICE"
 
+/// Service libraries to load during Runtime start, read from the AALRUNTIME_CONFIG_RECORD.
+///  A btStringArray (or a single btString) of names as given in
+///  AAL_FACTORY_CREATE_CONFIGRECORD_FULL_SERVICE_NAME, e.g. "libALI". Each library is loaded
+///  and its Service factory fetched before IRuntimeClient::runtimeStarted(), so the first
+///  allocation of the Service does not wait for them. Names that fail to load are logged
+///  and left to fail at allocation time.
+#define AALRUNTIME_CONFIG_PRELOAD_SERVICES "AALRUNTIME_CONFIG_PRELOAD_SERVICES"
+
+/// Message delivery (callback dispatcher) configuration, read from the AALRUNTIME_CONFIG_RECORD.
+/// Number of dispatcher threads (btUnsigned32bitInt). Default 1.
+#define AALRUNTIME_CONFIG_MDS_THREADS     "AALRUNTIME_CONFIG_MDS_THREADS"
+/// CPU mask for the dispatcher threads (btUnsigned64bitInt). Bit n allows CPU n. Default 0 (any CPU).
+#define AALRUNTIME_CONFIG_MDS_AFFINITY    "AALRUNTIME_CONFIG_MDS_AFFINITY"
+/// Ordering guarantee (btUnsigned32bitInt), one of AALRUNTIME_MDS_ORDER_*.
+///  Default AALRUNTIME_MDS_ORDER_GLOBAL with one thread, AALRUNTIME_MDS_ORDER_TARGET otherwise.
+///  AALRUNTIME_MDS_ORDER_GLOBAL with more than one thread fails Runtime start.
+#define AALRUNTIME_CONFIG_MDS_ORDERING    "AALRUNTIME_CONFIG_MDS_ORDERING"
+
+/// Every message is delivered in the order it was scheduled.
+#define AALRUNTIME_MDS_ORDER_GLOBAL       0
+/// Messages for the same target (IDispatchable::Target()) are delivered in order.
+///  Messages for different targets may be delivered concurrently.
+#define AALRUNTIME_MDS_ORDER_TARGET       1
+/// No ordering guarantee.
+#define AALRUNTIME_MDS_ORDER_NONE         2
+
 
 class IRuntime;
 
@@ -42,16 +42,35 @@
 #include <aalsdk/aas/IServiceRevoke.h>
 #include <aalsdk/Runtime.h>
 #include <aalsdk/aas/AALService.h>
+#include <aalsdk/CObjectPool.h>
 
 BEGIN_NAMESPACE(AAL)
 
+/// @brief Base class of the dispatchables below.
+///
+/// They are allocated from DispatchablePool() and return there when they delete themselves
+/// after running, so a notification costs no heap allocation once the pool is warm.
+class AASLIB_API PooledDispatchable : public IDispatchable
+{
+public:
+   /// @brief The pool that PooledDispatchable's are allocated from.
+   ///
+   /// Its CObjectPool::GetStats() counts live and pooled dispatchables.
+   static CObjectPool & DispatchablePool();
+
+   static void * operator new(std::size_t Size);
+   static void * operator new(std::size_t Size, const std::nothrow_t & ) throw();
+   static void   operator delete(void *p);
+   static void   operator delete(void *p, const std::nothrow_t & ) throw();
+};
+
 //============================================================================
 // AAL Service Client
 //============================================================================
 
 /// @brief Delivers IServiceClient::serviceAllocated(IBase               * ,
 ///                                                  TransactionID const & );
-class AASLIB_API ServiceAllocated : public IDispatchable
+class AASLIB_API ServiceAllocated : public PooledDispatchable
 {
 public:
    /// @brief ServiceAllocated constructor.
@@ -69,6 +88,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return ( NULL != m_pSvcClient ) ? dynamic_cast<btObjectType>(m_pSvcClient) : dynamic_cast<btObjectType>(m_pRTClient); }
 
 protected:
    IServiceClient      *m_pSvcClient;
@@ -78,7 +98,7 @@ protected:
 };
 
 /// @brief Delivers IServiceClient::serviceAllocateFailed(const IEvent & );
-class AASLIB_API ServiceAllocateFailed : public IDispatchable
+class AASLIB_API ServiceAllocateFailed : public PooledDispatchable
 {
 public:
    /// @brief ServiceAllocateFailed constructor.
@@ -95,6 +115,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return ( NULL != m_pSvcClient ) ? dynamic_cast<btObjectType>(m_pSvcClient) : dynamic_cast<btObjectType>(m_pRTClient); }
 protected:
    IServiceClient *m_pSvcClient;
    IRuntimeClient *m_pRTClient;
@@ -102,7 +123,7 @@ protected:
 };
 
 // @brief Causes a Service Object to be detrsoyed
-class AASLIB_API DestroyServiceObject : public IDispatchable
+class AASLIB_API DestroyServiceObject : public PooledDispatchable
 {
 public:
    /// @brief DestroyServiceObject constructor.
@@ -120,7 +141,7 @@ protected:
 };
 
 /// @brief Delivers IServiceClient::serviceReleased(TransactionID const & );
-class AASLIB_API ServiceReleased : public IDispatchable
+class AASLIB_API ServiceReleased : public PooledDispatchable
 {
 public:
    /// @brief ServiceReleased constructor.
@@ -133,6 +154,7 @@ public:
                    IBase               *pServiceBase,
                    TransactionID const &rTranID);
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcClient); }
 protected:
    IServiceClient      *m_pSvcClient;
    IBase               *m_pServiceBase;
@@ -140,7 +162,7 @@ protected:
 };
 
 /// @brief Delivers IServiceClient::serviceReleaseFailed(const IEvent & );
-class AASLIB_API ServiceReleaseFailed : public IDispatchable
+class AASLIB_API ServiceReleaseFailed : public PooledDispatchable
 {
 public:
    /// @brief ServiceReleaseFailed constructor.
@@ -155,13 +177,14 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcClient); }
 protected:
    IServiceClient *m_pSvcClient;
    const IEvent   *m_pEvent;
 };
 
 /// @brief Delivers IServiceClient::serviceEvent(const IEvent & );
-class AASLIB_API ServiceEvent : public IDispatchable
+class AASLIB_API ServiceEvent : public PooledDispatchable
 {
 public:
    /// @brief ServiceReleaseFailed constructor.
@@ -176,6 +199,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcClient); }
 protected:
    IServiceClient *m_pSvcClient;
    const IEvent   *m_pEvent;
@@ -186,7 +210,7 @@ protected:
 //============================================================================
 
 /// @brief Delivers IRuntimeClient::runtimeCreateOrGetProxyFailed(IEvent const & );
-class AASLIB_API RuntimeCreateOrGetProxyFailed : public IDispatchable
+class AASLIB_API RuntimeCreateOrGetProxyFailed : public PooledDispatchable
 {
 public:
    /// @brief RuntimeCreateOrGetProxyFailed constructor.
@@ -201,6 +225,7 @@ public:
    ///
    /// @returns void
    virtual void       operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pRTClient); }
 protected:
    IRuntimeClient *m_pRTClient;
    const IEvent   *m_pEvent;
@@ -208,7 +233,7 @@ protected:
 
 /// @brief Delivers IRuntimeClient::runtimeStarted(IRuntime            * ,
 ///                                                const NamedValueSet & );
-class AASLIB_API RuntimeStarted : public IDispatchable
+class AASLIB_API RuntimeStarted : public PooledDispatchable
 {
 public:
    /// @brief RuntimeStarted constructor.
@@ -224,6 +249,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pRTClient); }
 protected:
    IRuntimeClient      *m_pRTClient;
    IRuntime            *m_pRT;
@@ -231,7 +257,7 @@ protected:
 };
 
 /// @brief Delivers IRuntimeClient::runtimeStartFailed(const IEvent & );
-class AASLIB_API RuntimeStartFailed : public IDispatchable
+class AASLIB_API RuntimeStartFailed : public PooledDispatchable
 {
 public:
    /// @brief RuntimeStartFailed constructor.
@@ -246,13 +272,14 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pRTClient); }
 protected:
    IRuntimeClient *m_pRTClient;
    const IEvent   *m_pEvent;
 };
 
 /// @brief Delivers IRuntimeClient::runtimeStopped(IRuntime * );
-class AASLIB_API RuntimeStopped : public IDispatchable
+class AASLIB_API RuntimeStopped : public PooledDispatchable
 {
 public:
    /// @brief RuntimeStopped constructor.
@@ -266,13 +293,14 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pRTClient); }
 protected:
    IRuntimeClient *m_pRTClient;
    IRuntime       *m_pRT;
 };
 
 /// @brief Delivers IRuntimeClient::runtimeStopFailed(const IEvent & );
-class AASLIB_API RuntimeStopFailed : public IDispatchable
+class AASLIB_API RuntimeStopFailed : public PooledDispatchable
 {
 public:
    /// @brief RuntimeStopFailed constructor.
@@ -287,6 +315,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pRTClient); }
 protected:
    IRuntimeClient *m_pRTClient;
    const IEvent   *m_pEvent;
@@ -294,7 +323,7 @@ protected:
 
 /// @brief Delivers IRuntimeClient::runtimeAllocateServiceSucceeded(IBase * ,
 ///                                                                 TransactionID const & );
-class AASLIB_API RuntimeAllocateServiceSucceeded : public IDispatchable
+class AASLIB_API RuntimeAllocateServiceSucceeded : public PooledDispatchable
 {
 public:
    /// @brief RuntimeAllocateServiceSucceeded constructor.
@@ -310,6 +339,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pRTClient); }
 protected:
    IRuntimeClient      *m_pRTClient;
    IBase               *m_pServiceBase;
@@ -317,7 +347,7 @@ protected:
 };
 
 /// @brief Delivers IRuntimeClient::runtimeAllocateServiceFailed(const IEvent & );
-class AASLIB_API RuntimeAllocateServiceFailed : public IDispatchable
+class AASLIB_API RuntimeAllocateServiceFailed : public PooledDispatchable
 {
 public:
    /// @brief RuntimeAllocateServiceFailed constructor.
@@ -332,13 +362,14 @@ public:
    ///
    /// @returns void
    virtual void      operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pRTClient); }
 protected:
    IRuntimeClient *m_pRTClient;
    const IEvent   *m_pEvent;
 };
 
 /// @brief Delivers IRuntimeClient::runtimeEvent(const IEvent & );
-class AASLIB_API RuntimeEvent : public IDispatchable
+class AASLIB_API RuntimeEvent : public PooledDispatchable
 {
 public:
    /// @brief RuntimeEvent constructor.
@@ -361,6 +392,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pRTClient); }
 
    /// @brief assignment operator
    ///
@@ -373,7 +405,7 @@ protected:
 };
 
 /// @brief Delivers IServiceRevoke::serviceRevoked(const IEvent & );
-class AASLIB_API ServiceRevoke : public IDispatchable
+class AASLIB_API ServiceRevoke : public PooledDispatchable
 {
 public:
    ServiceRevoke(IServiceRevoke *pRevoke);
@@ -381,11 +413,12 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pRevoke); }
 protected:
    IServiceRevoke *m_pRevoke;
 };
 
-class AASLIB_API ReleaseServiceRequest : public IDispatchable
+class AASLIB_API ReleaseServiceRequest : public PooledDispatchable
 {
 public:
    ReleaseServiceRequest(IBase *, const IEvent   *);
@@ -394,6 +427,7 @@ public:
    ///
    /// @returns void
    virtual void operator() ();
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcBase); }
 protected:
    IBase          *m_pSvcBase;
    const IEvent   *m_pEvent;
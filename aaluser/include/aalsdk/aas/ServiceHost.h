@@ -39,6 +39,7 @@
 #include <aalsdk/osal/DynLinkLibrary.h>
 #include <aalsdk/osal/OSServiceModule.h>
 #include <aalsdk/aas/AALServiceModule.h>
+#include <list>
 
 BEGIN_NAMESPACE(AAL)
 
@@ -78,6 +79,11 @@ private:
    std::string       m_name;
 };
 
+/// Service libraries named by AALRUNTIME_CONFIG_PRELOAD_SERVICES in the AALRUNTIME_CONFIG_RECORD
+///  of optArgs, either a btString or a btStringArray. Returns false, leaving Names empty, when
+///  there are none. Only the broker that will allocate those Services should preload them.
+AALRUNTIME_API btBool GetPreloadServices(NamedValueSet const &optArgs, std::list<std::string> &Names);
+
 
 END_NAMESPACE(AAL)
 
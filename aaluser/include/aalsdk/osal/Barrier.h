@@ -147,6 +147,19 @@ public:
    /// @return NULL if no User-Defined data item has been associated with this Barrier instance.
    btObjectType UserDefined() const;
 
+   /// Set the number of times Wait() re-polls a locked manual-reset Barrier before it blocks.
+   ///
+   /// A short spin avoids a sleep and wake-up when the final Post() is expected soon, at
+   /// the cost of CPU time while spinning. The default, 0, blocks immediately. There is
+   /// no spin phase on a single-CPU system.
+   ///
+   /// @param[in]  nSpins  Maximum number of polls before blocking.
+   /// @return void
+   void SpinCount(btUnsignedInt nSpins);
+
+   /// Retrieve the number of times Wait() re-polls the Barrier before it blocks.
+   btUnsignedInt SpinCount() const;
+
 private:
    btUnsignedInt m_Flags;
 #define BARRIER_FLAG_INIT       0x00000001
@@ -157,6 +170,7 @@ private:
    btUnsignedInt m_UnlockCount;
    btUnsignedInt m_CurCount;
    btObjectType  m_UserDefined;
+   btUnsignedInt m_SpinCount;
 
    // We always reference m_AutoResetManager within the context of the Barrier
    //  locks, so there is no need to be concerned with locking within AutoResetManager.
@@ -203,6 +217,10 @@ private:
    HANDLE             m_hEvent;
 #elif defined( __AAL_LINUX__ )
    pthread_cond_t     m_condition;
+
+   // Wait() on an open manual-reset Barrier returns without taking the lock.
+   btBool IsOpen() const;
+   btBool TryWait() const;
 #endif // OS
 
    friend class AutoResetManager;
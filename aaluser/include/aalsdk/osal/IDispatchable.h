@@ -65,6 +65,15 @@ public:
    /// @returns void
    virtual void operator() () = 0;
 
+   /// @brief  The object this dispatchable delivers to.
+   ///
+   /// Dispatchers that keep per-target ordering run the items for one target in FIFO order,
+   /// and items for different targets concurrently. Return the most-derived address of the
+   /// target (dynamic_cast<btObjectType>) so that every interface of one object maps to one key.
+   ///
+   /// @returns The target object, or NULL if the item has no particular target.
+   virtual btObjectType Target() const { return NULL; }
+
    virtual ~IDispatchable() {}
 };
 
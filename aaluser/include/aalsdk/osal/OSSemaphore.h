@@ -194,6 +194,19 @@ public:
    /// @retval NULL if the User-Defined data item pointer was not set.
    btObjectType UserDefined() const;
 
+   /// Set the number of times Wait() re-polls the count before it blocks.
+   ///
+   /// A short spin avoids a sleep and wake-up when a Post() is expected soon, at the
+   /// cost of CPU time while spinning. The default, 0, blocks immediately. There is no
+   /// spin phase on a single-CPU system.
+   ///
+   /// @param[in]  nSpins  Maximum number of polls before blocking.
+   /// @return void
+   void SpinCount(btUnsignedInt nSpins);
+
+   /// Retrieve the number of times Wait() re-polls the count before it blocks.
+   btUnsignedInt SpinCount() const;
+
 private:
    // flags for m_State
 #define SEM_ST_OK        0x00000001
@@ -203,11 +216,19 @@ private:
    btInt           m_CurCount;
    btUnsignedInt   m_WaitCount;
    btObjectType    m_UserDefined;
+   btUnsignedInt   m_SpinCount;
 
 #if   defined( __AAL_WINDOWS__ )
    HANDLE          m_hEvent;
 #elif defined( __AAL_LINUX__ )
-   pthread_cond_t  m_condition;
+   // Futex word that blocked waiters sleep on. Advanced by each Post() that finds a
+   //  waiter and by UnblockAll(). The count itself is updated with atomic operations,
+   //  so uncontended Post() and Wait() calls take neither the lock nor a system call.
+   btUnsigned32bitInt m_Seq;
+
+   btBool TryDecrement();
+   btBool TryWait();
+   btBool SleepWait(const struct timespec * );
 #endif // OS
 };
 
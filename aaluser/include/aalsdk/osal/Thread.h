@@ -184,6 +184,11 @@ public:
    /// Retrieve this thread's identifier. Don't compare ID's outright. Use IsThisThread().
    /// @return This thread's ID.
    btTID                tid();
+   /// Restrict the thread to the given set of CPUs.
+   /// @param[in] CpuMask Bit n set allows the thread to run on CPU n. Must be non-zero.
+   /// @retval true  if the thread's affinity was changed.
+   /// @retval false otherwise.
+   btBool       SetAffinity(btUnsigned64bitInt CpuMask);
 
 
    static const btInt sm_PriorityTranslationTable[(btInt)THREADPRIORITY_COUNT];
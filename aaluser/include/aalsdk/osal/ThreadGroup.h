@@ -123,6 +123,17 @@ class OSAL_API OSLThreadGroup : public IThreadGroup,
                                 public CriticalSection
 {
 public:
+   /// @brief How work items are queued to the worker threads.
+   enum Policy {
+      /// One FIFO work queue and one counting semaphore shared by all workers.
+      SharedQueue = 0,
+      /// One work deque and one wake-up semaphore per worker. Add() places the item on
+      ///  an idle worker's deque (or the calling worker's own deque), and workers that run
+      ///  dry steal from their peers. Scales better than SharedQueue beyond a few workers,
+      ///  but dispatch order is FIFO only per worker.
+      WorkStealing
+   };
+
    ///  If uiMinThreads is the default 0, the Thread Group will determine the minimum
    ///  number of threads in the group.
    ///
@@ -130,7 +141,8 @@ public:
    OSLThreadGroup(btUnsignedInt             uiMinThreads=0,
                   btUnsignedInt             uiMaxThreads=0,
                   OSLThread::ThreadPriority nPriority=OSLThread::THREADPRIORITY_NORMAL,
-                  btTime                    JoinTimeout=AAL_INFINITE_WAIT);
+                  btTime                    JoinTimeout=AAL_INFINITE_WAIT,
+                  Policy                    ePolicy=SharedQueue);
 
    virtual ~OSLThreadGroup();
 
@@ -198,6 +210,12 @@ public:
    virtual btObjectType      UserDefined() const               { return m_pState->UserDefined();     }
    // </IThreadGroup>
 
+   /// @brief  Restrict every worker thread in the Thread Group to the given set of CPUs.
+   /// @param[in] CpuMask Bit n set allows the workers to run on CPU n.
+   /// @retval true   if the affinity of every running worker was changed.
+   /// @retval false  otherwise.
+   btBool                   SetAffinity(btUnsigned64bitInt CpuMask) { return m_pState->SetAffinity(CpuMask); }
+
 protected:
    virtual btBool CreateWorkerThread(ThreadProc fn, OSLThread::ThreadPriority pri, void *context)
    { return m_pState->CreateWorkerThread(fn, pri, context); }
@@ -218,7 +236,7 @@ private:
 #define THRGRPSTATE_FLAG_SELF_JOIN 0x00000002
 #define THRGRPSTATE_FLAG_JOINING   0x00000004
    public:
-      ThrGrpState(btUnsignedInt NumThreads);
+      ThrGrpState(btUnsignedInt NumThreads, Policy ePolicy);
       virtual ~ThrGrpState();
 
       // <IThreadGroup>
@@ -235,6 +253,8 @@ private:
       virtual btObjectType      UserDefined() const;
       // </IThreadGroup>
 
+      btBool                   SetAffinity(btUnsigned64bitInt CpuMask);
+
    protected:
       enum eState {
          Running = 0,
@@ -244,10 +264,44 @@ private:
       };
 
       typedef std::queue<IDispatchable *> work_queue_t;
+      typedef std::deque<IDispatchable *> work_deque_t;
       typedef std::list<OSLThread      *> thr_list_t;
       typedef thr_list_t::iterator        thr_list_iter;
       typedef thr_list_t::const_iterator  const_thr_list_iter;
 
+      // Per-worker state for the WorkStealing policy. The owning worker takes items from
+      //  the front of m_Work; thieves take from the back. m_eState changes only while every
+      //  slot is locked, so holding any one slot's lock gives a stable view of it. m_Queued
+      //  mirrors m_Work.size() so that empty slots can be skipped without locking them.
+      class WorkerSlot : public CriticalSection
+      {
+      public:
+         WorkerSlot() :
+            m_tid(),
+            m_Idle(0),
+            m_Queued(0),
+            m_Wake(),
+            m_Work()
+         {}
+
+         void Acquire() { Lock();   }
+         void Release() { Unlock(); }
+
+         btTID          m_tid;   // Worker bound to this slot.
+         volatile btInt m_Idle;  // 1 while the worker is, or is about to be, blocked on m_Wake.
+         volatile btInt m_Queued;
+         CSemaphore     m_Wake;
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable:4251)
+#endif // _MSC_VER
+         work_deque_t   m_Work;
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif // _MSC_VER
+      };
+
+      Policy        m_ePolicy;
       eState        m_eState;
       btUnsignedInt m_Flags;
       btTime        m_WorkSemTimeout;
@@ -269,6 +323,13 @@ private:
 # pragma warning(pop)
 #endif // _MSC_VER
 
+      // WorkStealing only.
+      WorkerSlot             *m_Slots;
+      btUnsignedInt           m_NumSlots;
+      btUnsignedInt           m_SlotsBound;
+      volatile btUnsignedInt  m_NextSlot;
+      volatile btInt          m_Searching;   // Workers scanning the deques for work.
+
       class DrainManager
       {
       public:
@@ -367,14 +428,30 @@ private:
       btBool               Quiesce(btTime );
       void         DestructMembers();
 
-      void        WorkerHasStarted(OSLThread * );
+      btUnsignedInt QueuedWorkItems() const;
+      IDispatchable *  TakeAnyWorkItem();
+      void           FlushWorkItems();
+      void          WakeAllWorkers();
+      void          LockAllSlots();
+      void        UnlockAllSlots();
+
+      btBool                  AddStealing(IDispatchable * );
+      eState        GetStealingWorkItem(IDispatchable * &pWork, btUnsignedInt slot);
+      eState          TakeStealingWorkItem(IDispatchable * &pWork, btUnsignedInt slot);
+      eState                SearchWorkItem(IDispatchable * &pWork, btUnsignedInt slot);
+      btInt              ClaimIdleWorker(btUnsignedInt start);
+      void                WakeIdleWorker(btUnsignedInt start);
+      btInt              CallerSlot() const;
+
+      /// returns the worker's slot index (WorkStealing).
+      btUnsignedInt WorkerHasStarted(OSLThread * );
       void         WorkerHasExited(OSLThread * );
       void WorkerIsSelfTerminating(OSLThread * );
 
       /// returns NULL if tid not in group.
       OSLThread * ThreadRunningInThisGroup(btTID ) const;
 
-      eState GetWorkItem(IDispatchable * &pWork);
+      eState GetWorkItem(IDispatchable * &pWork, btUnsignedInt slot);
       eState       State() const { return m_eState; }
       eState       State(eState );
 
@@ -105,6 +105,8 @@ public:
       delete this;
    }
 
+virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pobject); }
+
 virtual ~ResourceManagerClientMessage(){}
 
 protected:
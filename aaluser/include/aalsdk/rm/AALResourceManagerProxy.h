@@ -65,6 +65,10 @@ typedef enum
 #define RM_MESSAGE_KEY_REASONCODE        "rm_message_key_reasoncode"
 #define RM_MESSAGE_KEY_REASONSTRING      "rm_message_key_reasonstring"
 
+/// Added to a text request manifest by a client that reads a binary reply. A Resource
+/// Manager that sees it, or gets a binary request, replies in binary; otherwise in text.
+#define RM_MANIFEST_KEY_BINARY_REPLY     "rm_manifest_key_binary_reply"
+
 
 
 //==========================================================================
@@ -47,6 +47,10 @@
 #include <aalsdk/utils/ResMgrUtilities.h> // string, name, and GUID inter-conversion operators
                                           //    also pulls in <aas/kernel/aaldevice.h>
 #include <aalsdk/kernel/aalmafu.h>        // for MAFU_CONFIGURE_UNLIMTEDSHARES
+#include <aalsdk/AALNamedValueSet.h>      // NamedValueSet
+#include <map>
+#include <set>
+#include <string>
 
 
 /// @todo Document InstRec, InstRecMap, and related.
@@ -61,6 +65,9 @@ private:
    unsigned int             m_NumAllocations;
    unsigned int             m_MaxAllocations;
    btBool                   m_fUnlimitedAllocations;   // True if the number of allocations is unlimited
+   std::string              m_AFU_ID;                  // AFU_IDNameFromConfigStruct(m_ConfigUpdate)
+   NamedValueSet            m_nvsInstRec;              // Cached goal record base, valid if m_fInstRecNVS
+   btBool                   m_fInstRecNVS;
 public:
    /// @brief Constructor using event passed from RMS.
    /// @param[in] pConfigUpdate A pointer to an event detailing the
@@ -102,6 +109,15 @@ public:
    /// @retval True if unlimited allocations are allowed.
    /// @retval False if unlimited allocations are NOT allowed.
    btBool                  fUnlimitedAllocations() const { return m_fUnlimitedAllocations; }
+   /// @brief Access the AFU_ID of the ConfigUpdate event, as a string.
+   /// @return The AFU_ID, as returned by AFU_IDNameFromConfigStruct().
+   const std::string &                     AFU_ID() const { return m_AFU_ID;                }
+   /// @brief Check whether the Instance Record NVS has been cached with InstRecNVS().
+   /// @retval True if InstRecNVS() holds the NVS of the current ConfigUpdate event.
+   btBool                            HasInstRecNVS() const { return m_fInstRecNVS;           }
+   /// @brief Access the cached Instance Record NVS.
+   /// @return The NVS cached by InstRecNVS(const NamedValueSet &).
+   const NamedValueSet &                InstRecNVS() const { return m_nvsInstRec;            }
    // Mutators
    /// @brief Replace the ConfigUpdate event in the Instance Record
    /// @retval True if ConfigUpdate was replaced.
@@ -113,6 +129,9 @@ public:
    /// @brief Set the maximum number of allocations in the Instance Record
    /// @return The new maximum number of allocations.
    unsigned int                   MaxAllocations(int i)         { m_MaxAllocations = i; return i; }
+   /// @brief Cache the Instance Record NVS built from the ConfigUpdate event.
+   ///        ReplaceStruct() discards it.
+   void                               InstRecNVS(const NamedValueSet &nvs) { m_nvsInstRec = nvs; m_fInstRecNVS = true; }
 private:
    InstRec(); // Disallow default constructor
 }; // InstRec
@@ -125,6 +144,14 @@ typedef std::map<btNumberKey, InstRec> InstRecMap_t;
 typedef InstRecMap_t::iterator         InstRecMap_itr_t;
 typedef InstRecMap_t::const_iterator   InstRecMap_citr_t;
 
+typedef std::set<btNumberKey>                          InstRecKeySet_t;
+typedef InstRecKeySet_t::const_iterator                InstRecKeySet_citr_t;
+typedef std::map<std::string, InstRecKeySet_t>         InstRecStrIndex_t;
+typedef std::map<btUnsigned64bitInt, InstRecKeySet_t>  InstRecIntIndex_t;
+
+/// Instance Records by Instance Index, with secondary indices by AFU_ID, by PCI
+/// bus/device/function and by state. Modify records only through the InstRecMap
+/// mutators, so that the indices stay current.
 class InstRecMap
 {
 public:
@@ -152,6 +179,37 @@ virtual ~InstRecMap();
    /// <B>Parameters:</B> [in]  The IndexInstance of the Instance Record to delete.
    /// @return void
    void Delete(btNumberKey );
+   /// @brief InstRec::ReplaceStruct() on the record with the given key.
+   /// @retval True if the record was found and its ConfigUpdate event replaced.
+   btBool  ReplaceStruct(btNumberKey key, const aalrms_configUpDateEvent *pConfigUpdate);
+   /// @brief InstRec::IncrementAllocations() on the record with the given key.
+   /// @retval True if the record was found and its allocation count incremented.
+   btBool  IncrementAllocations(btNumberKey key);
+   /// @brief InstRec::DecrementAllocations() on the record with the given key.
+   /// @retval True if the record was found and its allocation count decremented.
+   btBool  DecrementAllocations(btNumberKey key);
+
+   /// @brief Keys of the records with the given AFU_ID string.
+   const InstRecKeySet_t & ByAFU_ID(const std::string &AFU_ID) const;
+   /// @brief Keys of the records at the given PCI bus, device and function.
+   const InstRecKeySet_t & ByPCIAddress(btUnsigned32bitInt Bus,
+                                        btUnsigned32bitInt Device,
+                                        btUnsigned32bitInt Function) const;
+   /// @brief Keys of the AFU and Management AFU records that can take another allocation.
+   const InstRecKeySet_t & Allocatable() const { return m_Allocatable; }
+
+private:
+   static btUnsigned64bitInt PCIAddressKey(btUnsigned32bitInt Bus,
+                                           btUnsigned32bitInt Device,
+                                           btUnsigned32bitInt Function);
+   void Index(const InstRec &instRec);
+   void Unindex(const InstRec &instRec);
+   void IndexState(const InstRec &instRec);
+
+   InstRecStrIndex_t m_ByAFU_ID;
+   InstRecIntIndex_t m_ByPCIAddress;
+   InstRecKeySet_t   m_Allocatable;
+   InstRecKeySet_t   m_Empty;
 };
 
 /// @brief InstanceRecord serializer.
@@ -0,0 +1,174 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file ALIMMIORegion.h
+/// @brief Inline, compile-time checked access to an ALI MMIO region.
+/// @ingroup IALIAFU
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// IALIMMIO::mmioRead64() and friends are virtual and range check every
+/// access. ALIMMIORegion<Layout> instead checks once, when it is attached to
+/// an IALIMMIO, that the region is at least sizeof(Layout) bytes long. After
+/// that, read<Offset, Width>() and write<Offset, Width>() are inline volatile
+/// loads and stores whose alignment and bounds are checked at compile time,
+/// so a loop polling a status CSR compiles down to a bare load.
+///
+/// Width is either btUnsigned32bitInt / btUnsigned64bitInt or any 4- or
+/// 8-byte register struct, such as those in aalsdk/kernel/ccip_defs.h.
+/// Layout is a struct describing the region (e.g. struct CCIP_AFU_Header), or
+/// ALIMMIOSpan<Bytes> when only the size is known.
+///
+/// Hardware only. On ASE and the software simulation the mapping is a local
+/// copy of the registers that the AFU never sees written, so Attach() refuses
+/// any IALIMMIO whose mmioIsDirect() is false. Use the IALIMMIO methods there.
+///
+/// @code
+///   ALIMMIORegion<struct CCIP_AFU_Header> afu(m_pALIMMIOService);
+///   if ( afu.IsOK() ) {
+///      struct CCIP_DFH dfh = afu.read<offsetof(struct CCIP_AFU_Header, ccip_dfh), struct CCIP_DFH>();
+///   }
+///
+///   ALIMMIORegion< ALIMMIOSpan<0x1000> > csrs(m_pALIMMIOService);
+///   csrs.write<CSR_CTL>((btUnsigned32bitInt)1);
+///   while ( 0 == csrs.read<CSR_STATUS, btUnsigned64bitInt>() ) { }
+/// @endcode@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_SERVICE_ALIMMIOREGION_H__
+#define __AALSDK_SERVICE_ALIMMIOREGION_H__
+#include <aalsdk/service/IALIAFU.h>
+
+#include <cstring>
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup IALIAFU
+/// @{
+
+#if defined( __GXX_EXPERIMENTAL_CXX0X__ ) || ( __cplusplus >= 201103L )
+# define ALI_MMIO_STATIC_ASSERT(__expr, __msg) static_assert(__expr, __msg)
+#else
+// Pre-C++11: instantiating the undefined ALIMMIOStaticAssert<false> fails to compile.
+template <bool > struct ALIMMIOStaticAssert;
+template <>      struct ALIMMIOStaticAssert<true> { enum { value = 1 }; };
+# define ALI_MMIO_STATIC_ASSERT(__expr, __msg) (void)sizeof(::AAL::ALIMMIOStaticAssert<(__expr)>)
+#endif // C++11
+
+/// Layout for an MMIO region whose structure is not described further.
+template <btCSROffset Bytes>
+struct ALIMMIOSpan
+{
+   btByte m_Bytes[Bytes];
+};
+
+/// The integer type used to access a register of a given size.
+template <btUnsignedInt Bytes> struct ALIMMIOWord;
+template <> struct ALIMMIOWord<4> { typedef btUnsigned32bitInt type; };
+template <> struct ALIMMIOWord<8> { typedef btUnsigned64bitInt type; };
+
+template <typename Layout>
+class ALIMMIORegion
+{
+public:
+   ALIMMIORegion() :
+      m_pBase(NULL)
+   {}
+
+   explicit ALIMMIORegion(IALIMMIO *pMMIO) :
+      m_pBase(NULL)
+   {
+      Attach(pMMIO);
+   }
+
+   /// @brief  Bind to the MMIO region of pMMIO.
+   /// @retval True if the region is mapped directly and at least sizeof(Layout) bytes long.
+   /// @retval False otherwise, including on ASE and the software simulation. The object
+   ///         is left unattached.
+   btBool Attach(IALIMMIO *pMMIO)
+   {
+      m_pBase = NULL;
+
+      if ( ( NULL == pMMIO ) || !pMMIO->mmioIsDirect() ) {
+         return false;
+      }
+
+      btVirtAddr pBase = pMMIO->mmioGetAddress();
+      if ( ( NULL == pBase ) || ( pMMIO->mmioGetLength() < sizeof(Layout) ) ) {
+         return false;
+      }
+
+      m_pBase = pBase;
+      return true;
+   }
+
+   btBool     IsOK()    const { return NULL != m_pBase; }
+   btVirtAddr Address() const { return m_pBase;         }
+
+   /// @brief  Read the Width-sized register at byte Offset. The region must be attached.
+   template <btCSROffset Offset, typename Width>
+   Width read() const
+   {
+      typedef typename ALIMMIOWord<sizeof(Width)>::type word_type;
+      Check<Offset, Width>();
+
+      word_type w = *reinterpret_cast<volatile word_type *>(m_pBase + Offset);
+      Width     v;
+      std::memcpy(&v, &w, sizeof(v));
+      return v;
+   }
+
+   /// @brief  Write the Width-sized register at byte Offset. The region must be attached.
+   template <btCSROffset Offset, typename Width>
+   void write(Width const &Value) const
+   {
+      typedef typename ALIMMIOWord<sizeof(Width)>::type word_type;
+      Check<Offset, Width>();
+
+      word_type w;
+      std::memcpy(&w, &Value, sizeof(w));
+      *reinterpret_cast<volatile word_type *>(m_pBase + Offset) = w;
+   }
+
+protected:
+   template <btCSROffset Offset, typename Width>
+   static void Check()
+   {
+      ALI_MMIO_STATIC_ASSERT(( 4 == sizeof(Width) ) || ( 8 == sizeof(Width) ),
+                             "MMIO access width must be 32 or 64 bits");
+      ALI_MMIO_STATIC_ASSERT(0 == ( Offset % sizeof(Width) ),
+                             "MMIO offset must be naturally aligned");
+      ALI_MMIO_STATIC_ASSERT(( sizeof(Width) <= sizeof(Layout) ) && ( Offset <= sizeof(Layout) - sizeof(Width) ),
+                             "MMIO access lies outside the region Layout");
+   }
+
+   btVirtAddr m_pBase;
+};
+
+/// @}
+
+END_NAMESPACE(AAL)
+
+#endif // __AALSDK_SERVICE_ALIMMIOREGION_H__
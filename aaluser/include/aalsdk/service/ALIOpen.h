@@ -0,0 +1,172 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file ALIOpen.h
+/// @brief Synchronous bring-up of an ALI AFU.
+/// @ingroup IALIAFU
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// ALIOpen() returns a ready-to-use AFU in one blocking call. It starts (or
+/// shares) the AAL Runtime with the ALI Service libraries preloaded, allocates
+/// the ALI Service for the requested AFU ID and PCIe address, waits for the
+/// allocation, looks up the IALIMMIO, IALIBuffer, IALIUMsg and IALIReset
+/// interfaces, and performs the first MMIO read. The same Resource Manager,
+/// AIA and driver path as an asynchronous allocService() is used; only the
+/// callbacks are absorbed. ALIDevice::Times() reports how long each stage took.
+///
+/// ALIOpen() and ALIClose() block on a semaphore posted from the Runtime's
+/// callbacks. Do not call them from a Runtime or Service callback: that thread
+/// is the one that would have to post it.
+///
+/// @code
+///   ALIDevice *pDev = ALIOpen("D8424DC4-A4A3-C413-F89E-433683F9040B", ALIOPEN_ANY_BDF);
+///   if ( NULL != pDev ) {
+///      pDev->MMIO()->mmioWrite32(CSR_CTL, 1);
+///      ALIClose(pDev);
+///   }
+/// @endcode@endverbatim
+//****************************************************************************
+#ifndef __AALSDK_SERVICE_ALIOPEN_H__
+#define __AALSDK_SERVICE_ALIOPEN_H__
+#include <aalsdk/Runtime.h>
+#include <aalsdk/service/IALIAFU.h>
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup IALIAFU
+/// @{
+
+/// Packs a PCIe bus, device and function into the BusDevFn argument of ALIOpen().
+#define ALIOPEN_BDF(bus, dev, fn)  ( ( ( (bus) & 0xff ) << 8 ) | ( ( (dev) & 0x1f ) << 3 ) | ( (fn) & 0x7 ) )
+/// BusDevFn that accepts the AFU at any PCIe address.
+#define ALIOPEN_ANY_BDF            0xffffffff
+
+/// ALIOpen() flag: open the AFU in ASE (RTL simulation) rather than on hardware.
+#define ALIOPEN_FLAG_ASE           0x00000001
+/// ALIOpen() flag: do not preload the ALI Service libraries when starting the Runtime.
+#define ALIOPEN_FLAG_NO_PRELOAD    0x00000002
+/// ALIOpen() flag: skip the first MMIO read.
+#define ALIOPEN_FLAG_NO_MMIO_READ  0x00000004
+/// ALIOpen() flag: open the AFU in the in-process software model rather than on hardware.
+#define ALIOPEN_FLAG_SWSIM         0x00000008
+
+/// Duration of each ALIOpen() stage, in microseconds.
+struct ALIOpenTimes
+{
+   btUnsigned64bitInt RuntimeStart;  ///< Runtime::start() to runtimeStarted(). 0 when the Runtime was already running.
+   btUnsigned64bitInt Allocate;      ///< allocService() to serviceAllocated(): Resource Manager, AIA and ALI init.
+   btUnsigned64bitInt Interfaces;    ///< Interface lookup and MMIO mapping.
+   btUnsigned64bitInt FirstMMIO;     ///< First mmioRead64() of the AFU header.
+   btUnsigned64bitInt Total;         ///< The whole of ALIOpen().
+};
+
+/// An ALI AFU opened by ALIOpen(). Close it with ALIClose().
+class AALRUNTIME_API ALIDevice : public  CAASBase,
+                                 public  IServiceClient,
+                                 private CUnCopyable
+{
+public:
+   /// The AFU's MMIO interface. Never NULL.
+   IALIMMIO   *      MMIO() const { return m_pMMIO;     }
+   /// The AFU's shared buffer interface. Never NULL.
+   IALIBuffer *    Buffer() const { return m_pBuffer;   }
+   /// The AFU's UMsg interface, or NULL if the AFU has none.
+   IALIUMsg   *      UMsg() const { return m_pUMsg;     }
+   /// The AFU's reset interface, or NULL if the AFU has none.
+   IALIReset  *     Reset() const { return m_pReset;    }
+   /// The ALI Service, for interfaces not listed above.
+   IBase      *   Service() const { return m_pService;  }
+   /// The base address of the AFU's MMIO space.
+   btVirtAddr    MMIOBase() const { return m_MMIOBase;  }
+   /// The length of the AFU's MMIO space.
+   btCSROffset MMIOLength() const { return m_MMIOLength; }
+   /// The first 64 bits of the AFU's MMIO space (its DFH), unless ALIOPEN_FLAG_NO_MMIO_READ.
+   btUnsigned64bitInt DFH() const { return m_DFH;       }
+   /// How long each stage of ALIOpen() took.
+   ALIOpenTimes const & Times() const { return m_Times; }
+
+   // <IServiceClient>
+   virtual void      serviceAllocated(IBase *pServiceBase, TransactionID const &rTranID);
+   virtual void serviceAllocateFailed(const IEvent &rEvent);
+   virtual void       serviceReleased(TransactionID const &rTranID);
+   virtual void serviceReleaseRequest(IBase *pServiceBase, const IEvent &rEvent);
+   virtual void  serviceReleaseFailed(const IEvent &rEvent);
+   virtual void          serviceEvent(const IEvent &rEvent);
+   // </IServiceClient>
+
+protected:
+   friend AALRUNTIME_API ALIDevice * ALIOpen(btcString, btUnsigned32bitInt, btUnsigned32bitInt, IRuntime *);
+   friend AALRUNTIME_API void        ALIClose(ALIDevice *);
+
+   ALIDevice(btUnsigned32bitInt Flags);
+   virtual ~ALIDevice();
+
+   btBool Open(btcString AFUId, btUnsigned32bitInt BusDevFn, IRuntime *pRuntime);
+   void  Close();
+
+   btUnsigned32bitInt  m_Flags;
+   IRuntime           *m_pRuntime;      // Runtime used for allocation
+   btBool              m_bOwnRuntime;   // Holds a reference on the shared Runtime
+   IBase              *m_pService;
+   IALIMMIO           *m_pMMIO;
+   IALIBuffer         *m_pBuffer;
+   IALIUMsg           *m_pUMsg;
+   IALIReset          *m_pReset;
+   btVirtAddr          m_MMIOBase;
+   btCSROffset         m_MMIOLength;
+   btUnsigned64bitInt  m_DFH;
+   btBool              m_bResult;       // Outcome of the last callback
+   CSemaphore          m_Sem;           // Posted by each callback
+   ALIOpenTimes        m_Times;
+};
+
+/// Open an ALI AFU synchronously.
+///
+/// @param[in]  AFUId     The AFU ID, e.g. "D8424DC4-A4A3-C413-F89E-433683F9040B". Ignored with ALIOPEN_FLAG_ASE.
+///                       Optional with ALIOPEN_FLAG_SWSIM, where it is the ID the model reports.
+/// @param[in]  BusDevFn  ALIOPEN_BDF(bus, dev, fn) of the AFU, or ALIOPEN_ANY_BDF. Ignored with ALIOPEN_FLAG_ASE and
+///                       ALIOPEN_FLAG_SWSIM.
+/// @param[in]  Flags     Zero or more ALIOPEN_FLAG_* values.
+/// @param[in]  pRuntime  A started Runtime to allocate from. With NULL, ALIOpen() starts a Runtime shared by
+///                       all ALIDevice's and stops it when the last is closed. An application that has its own
+///                       Runtime must pass it, as only one Runtime may exist per process.
+/// @return The opened AFU, or NULL on failure. The failure is logged.
+/// @note Blocks until the allocation completes. Must not be called from a Runtime or Service callback.
+AALRUNTIME_API ALIDevice * ALIOpen(btcString          AFUId,
+                                   btUnsigned32bitInt BusDevFn,
+                                   btUnsigned32bitInt Flags=0,
+                                   IRuntime          *pRuntime=NULL);
+
+/// Release an AFU opened by ALIOpen(), waiting for the release to complete. NULL is ignored.
+/// Like ALIOpen(), must not be called from a Runtime or Service callback.
+AALRUNTIME_API void ALIClose(ALIDevice *pDevice);
+
+/// @}
+
+END_NAMESPACE(AAL)
+
+#endif // __AALSDK_SERVICE_ALIOPEN_H__
@@ -40,11 +40,16 @@
 ///    IALIUMsg   Functions for sending UMessages
 ///    IALIBuffer Functions for allocating shared buffers between software
 ///               and the AFU
+///    IALIBufferPool
+///               Functions for fast sub-allocation of shared buffers from
+///               pooled, pinned regions
 ///    IALIPerf   Functions for accessing performance counters
 ///    IALIReset  Functions for enabling, disabling, quiescing, and resetting
 ///               the AFU
 ///    IALIReconfigure
 ///               Functions for partial reconfiguration
+///    IALIPRCache
+///               Functions for keeping validated PR images resident
 ///    IALISignalTap
 ///               Functions for remote debugging
 ///
@@ -64,6 +69,8 @@
 ///   iidALI_CONF_Service         __INTC_IID(INTC_sysAFULinkInterface,0x0007)
 ///   iidALI_CONF_Service_Client  __INTC_IID(INTC_sysAFULinkInterface,0x0008)
 ///   iidALI_STAP_Service         __INTC_IID(INTC_sysAFULinkInterface,0x0009)
+///   iidALI_BPOOL_Service        __INTC_IID(INTC_sysAFULinkInterface,0x0014)
+///   iidALI_PRCACHE_Service      __INTC_IID(INTC_sysAFULinkInterface,0x0015)
 /// <TODO: LIST INTERFACES HERE>
 ///
 /// If an ALI Service Client needs any particular Service Interface, then it must check at runtime
@@ -213,6 +220,8 @@ typedef enum
 #define iidALI_FMEERR_Service       __INTC_IID(INTC_sysAFULinkInterface,0x0011)
 #define iidALI_POWER_Service        __INTC_IID(INTC_sysAFULinkInterface,0x0012)
 #define iidALI_TEMP_Service         __INTC_IID(INTC_sysAFULinkInterface,0x0013)
+#define iidALI_BPOOL_Service        __INTC_IID(INTC_sysAFULinkInterface,0x0014)
+#define iidALI_PRCACHE_Service      __INTC_IID(INTC_sysAFULinkInterface,0x0015)
 
 
 // FME GUID
@@ -229,6 +238,19 @@ typedef enum
 # define ALIAFU_NVS_VAL_TARGET_FPGA  "ALIAFUTarget_FPGA"
 /// Key for selecting SWSimCCIAFU
 # define ALIAFU_NVS_VAL_TARGET_SWSIM "ALIAFUTarget_SWSim"
+/// Key for the number of threads delivering HW AFU completions (btUnsigned32bitInt, default 1).
+/// Takes effect for the first HW ALI allocated in the process.
+#define ALIAFU_NVS_KEY_AIA_PUMP_THREADS "ALIAFUAIAPumpThreads"
+/// Key for polled completion of a HW ALI's driver transactions (btUnsigned32bitInt microseconds, default 0 = off).
+/// When non-zero, the thread that starts a transaction completing through an AFU event (PR deactivate,
+/// configure and activate, and the ALI's own bind) reads the driver and delivers that event itself,
+/// spinning for up to this long before it blocks until the AIA's delivery threads have delivered it.
+/// Such calls return only once their completion has been delivered.
+#define ALIAFU_NVS_KEY_POLL_SPIN_USEC "ALIAFUPollSpinUsec"
+
+/// Key for PR images to preload into the IALIPRCache of a reconfigure ALI (NamedValueSet).
+/// Each key of the embedded NamedValueSet is an AFU ID and its value the bitstream file (btcString).
+#define ALIAFU_NVS_KEY_PRCACHE_IMAGES "ALIAFUPRCacheImages"
 
 
 //-----------------------------------------------------------------------------
@@ -243,6 +265,27 @@ typedef enum
 } ali_afu_target_e;
 
 
+//-----------------------------------------------------------------------------
+// MMIO access width, for batched MMIO accesses.
+//-----------------------------------------------------------------------------
+typedef enum
+{
+   ali_mmio_width32 = 32,     //32-bit access
+   ali_mmio_width64 = 64      //64-bit access
+
+} ali_mmio_width_e;
+
+//-----------------------------------------------------------------------------
+// One element of a batched MMIO access. See IALIMMIO::mmioWriteBatch().
+//-----------------------------------------------------------------------------
+typedef struct
+{
+   btCSROffset         offset;   ///< Byte offset into the MMIO region.
+   ali_mmio_width_e    width;    ///< Access width.
+   btUnsigned64bitInt  value;    ///< Value to write, or value read. 32-bit reads are zero-extended.
+
+} ali_mmio_access_t;
+
 //-----------------------------------------------------------------------------
 // IALIMMIO interface.
 //-----------------------------------------------------------------------------
@@ -266,6 +309,14 @@ public:
    /// @returns The length of the region.
    virtual btCSROffset  mmioGetLength( void ) = 0;
 
+   /// @brief Whether loads and stores through mmioGetAddress() reach the AFU.
+   ///
+   /// True on hardware. ASE and the software simulation return a local copy of
+   /// the registers there; the AFU only sees writes made with mmioWrite32(),
+   /// mmioWrite64() and mmioWriteBatch(), and reads through it may be stale.
+   /// @retval True if the mapping is the AFU's MMIO space itself.
+   virtual btBool       mmioIsDirect( void ) = 0;
+
    /// @brief      Read an MMIO address (or register) as a 32-bit value.
    ///
    /// Convenience function for those who organize an MMIO space as a set of Registers.
@@ -306,6 +357,29 @@ public:
    /// @retval     False if the write was not successful.
    virtual btBool  mmioWrite64( const btCSROffset Offset, const btUnsigned64bitInt Value) = 0;
 
+   /// @brief      Perform a sequence of MMIO writes.
+   ///
+   /// Equivalent to calling mmioWrite32() / mmioWrite64() for each element, in order,
+   /// but the whole batch is validated once up front and, for ASE, is sent to the
+   /// simulator as a single message.
+   /// @note       Synchronous function; no TransactionID.
+   /// @param[in]  pAccesses Array of Count (offset, width, value) tuples.
+   /// @param[in]  Count     Number of elements in pAccesses.
+   /// @retval     True if all of the writes were performed.
+   /// @retval     False if any element is invalid. No write is performed in that case.
+   virtual btBool  mmioWriteBatch( ali_mmio_access_t const *pAccesses, btUnsignedInt Count ) = 0;
+
+   /// @brief      Perform a sequence of MMIO reads.
+   ///
+   /// Equivalent to calling mmioRead32() / mmioRead64() for each element, in order,
+   /// storing each result in the element's value.
+   /// @note       Synchronous function; no TransactionID.
+   /// @param[in,out] pAccesses Array of Count (offset, width, value) tuples.
+   /// @param[in]  Count     Number of elements in pAccesses.
+   /// @retval     True if all of the reads were performed.
+   /// @retval     False if any element is invalid. No read is performed in that case.
+   virtual btBool  mmioReadBatch( ali_mmio_access_t *pAccesses, btUnsignedInt Count ) = 0;
+
    /// @brief      Request a pointer to a device feature header (DFH).
    ///
    /// Will deposit in *pFeatureAddr the base address of the device feature
@@ -527,6 +601,70 @@ public:
 }; // class IALIBuffer
 
 
+//-----------------------------------------------------------------------------
+// IALIBufferPool interface.
+//-----------------------------------------------------------------------------
+/// @brief  Pooled Buffer Allocation Service Interface of IALI.
+///
+/// Sub-allocates cache-line aligned chunks from large pinned regions that are
+///    obtained from IALIBuffer::bufferAllocate() once and then recycled, so that
+///    the driver round trip and mmap of a bufferAllocate() are not paid for
+///    each short-lived buffer. Requests are rounded up to a power-of-two size
+///    class. Requests larger than the largest size class are passed through to
+///    IALIBuffer::bufferAllocate().
+///
+/// @note   Chunks must be returned with bufferPoolFree(), never IALIBuffer::bufferFree().
+/// @note   IALIBuffer::bufferGetIOVA() also translates addresses within a chunk.
+/// @note   This service interface is obtained from an IBase via iidALI_BPOOL_Service.
+/// @code
+///         m_pALIBufferPoolService = dynamic_ptr<IALIBufferPool>(iidALI_BPOOL_Service, pServiceBase);
+/// @endcode
+class IALIBufferPool
+{
+public:
+   virtual ~IALIBufferPool() {}
+
+   #define ALI_BUFFPOOL_STAT_DATATYPE         btUnsigned64bitInt
+   #define ALI_BUFFPOOL_STAT_HITS             "BufferPool Hits"             ///< Allocations served without a driver call.
+   #define ALI_BUFFPOOL_STAT_MISSES           "BufferPool Misses"           ///< Allocations that required a bufferAllocate().
+   #define ALI_BUFFPOOL_STAT_BYTES_RESERVED   "BufferPool Bytes Reserved"   ///< Pinned bytes held by the pool.
+   #define ALI_BUFFPOOL_STAT_BYTES_INUSE      "BufferPool Bytes In Use"     ///< Bytes of live chunks, after rounding.
+   #define ALI_BUFFPOOL_STAT_ROUNDING_WASTE   "BufferPool Rounding Waste"   ///< Cumulative bytes lost to size-class rounding.
+   #define ALI_BUFFPOOL_STAT_FRAGMENTATION    "BufferPool Fragmentation"    ///< Percent of reserved bytes not in use.
+
+   /// @brief Allocate a chunk from the pool.
+   ///
+   /// @param[in]  Length      Requested length, in bytes.
+   /// @param[out] pBufferptr  Chunk pointer. Aligned to at least a cache line.
+   /// @param[out] pIOVA       If not NULL, receives the IOVA of the chunk.
+   ///
+   /// @return On success, ali_errnumOK.
+   /// @return On failure, ali_errnumBadParameter, ali_errnumNoMem or ali_errnumSystem.
+   virtual AAL::ali_errnum_e bufferPoolAllocate( btWSSize    Length,
+                                                 btVirtAddr *pBufferptr,
+                                                 btPhysAddr *pIOVA = NULL ) = 0;
+
+   /// @brief Return a chunk to the pool.
+   ///
+   /// The chunk is cached for reuse by the calling thread where possible. O(1) apart
+   ///    from a lock-free O(log n) search over the pool's pinned regions.
+   ///
+   /// @param[in]  Address  Chunk pointer acquired from bufferPoolAllocate().
+   ///
+   /// @return On success, ali_errnumOK.
+   /// @return On failure, ali_errnumBadParameter.
+   virtual AAL::ali_errnum_e bufferPoolFree( btVirtAddr Address ) = 0;
+
+   /// @brief Obtain the pool statistics.
+   ///
+   /// @param[out]  rResult  Receives the ALI_BUFFPOOL_STAT_* values, each of type
+   ///                          ALI_BUFFPOOL_STAT_DATATYPE.
+   /// @retval      True if the statistics were retrieved.
+   virtual btBool bufferPoolGetStats( INamedValueSet &rResult ) = 0;
+
+}; // class IALIBufferPool
+
+
 //-----------------------------------------------------------------------------
 // IALIPerf interface.
 //-----------------------------------------------------------------------------
@@ -755,6 +893,26 @@ public:
    //  a recongActivate() is called.
    #define AALCONF_REACTIVATE_DISABLED      "ReactivateState"
 
+   // Bool key.  If present and set to true the bitstream file is
+   //  mapped rather than read into a buffer, and the driver pushes
+   //  it to the PR engine straight from the mapped pages.
+   #define AALCONF_STREAM_BITSTREAM         "StreamBitstream"
+
+   // btUnsigned64bitInt keys of the NamedValueSet filled in by
+   //  reconfGetTimings(). Times are in nanoseconds.
+   #define AALCONF_TIMING_LOAD_NS           "PRLoadNs"
+   #define AALCONF_TIMING_PUSH_NS           "PRPushNs"
+   #define AALCONF_TIMING_WAIT_NS           "PRWaitNs"
+   #define AALCONF_TIMING_BYTES             "PRBytes"
+
+   // Select a PR image held by the IALIPRCache of this service
+   //  instead of AALCONF_FILENAMEKEY. The image is pushed from the
+   //  cache without reading the file or allocating a buffer.
+   //  AALCONF_AFUIDKEY is a btcString, AALCONF_CACHE_HANDLE a
+   //  btUnsigned64bitInt returned by IALIPRCache::prCacheLoad().
+   #define AALCONF_AFUIDKEY                 "AFUID"
+   #define AALCONF_CACHE_HANDLE             "PRCacheHandle"
+
 
    /// @brief Deactivate an AFU in preparation for it being reconfigured.
    ///
@@ -799,9 +957,78 @@ public:
    virtual void reconfActivate( TransactionID const &rTranID,
                                 NamedValueSet const &rInputArgs ) = 0;
 
+   /// @brief Per-phase timings of the most recent successful reconfConfigure().
+   ///
+   /// Load covers mapping or reading the bitstream file and bringing it into
+   ///    the driver, push covers writing it to the PR engine, and wait covers
+   ///    waiting for the PR engine to finish.
+   ///
+   /// @param[out] rTimings Receives the AALCONF_TIMING_* keys.
+   /// @return     false if no reconfConfigure() has completed yet.
+   virtual btBool reconfGetTimings( NamedValueSet &rTimings ) = 0;
+
 }; // class IALIReconfigure
 
 
+//-----------------------------------------------------------------------------
+// IALIPRCache interface.
+//-----------------------------------------------------------------------------
+/// @brief  Keeps validated PR images resident for IALIReconfigure (synchronous).
+///
+/// Each image is read from its bitstream file and validated once, then kept in
+///    locked memory under the AFU ID given by the caller. reconfConfigure() selects
+///    a cached image with AALCONF_AFUIDKEY or AALCONF_CACHE_HANDLE and pushes it
+///    with no file I/O and no allocation. A reconfConfigure() naming a cached file
+///    with AALCONF_FILENAMEKEY is also served from the cache.
+///
+/// @note   An image is a snapshot of its file. Reload it after the file changes.
+/// @note   This service interface is obtained from an IBase via iidALI_PRCACHE_Service.
+/// @code
+///         m_pALIPRCacheService = dynamic_ptr<IALIPRCache>(iidALI_PRCACHE_Service, pServiceBase);
+/// @endcode
+class IALIPRCache
+{
+public:
+   virtual ~IALIPRCache() {}
+
+   #define ALI_PRCACHE_STAT_DATATYPE          btUnsigned64bitInt
+   #define ALI_PRCACHE_STAT_HITS              "PRCache Hits"                ///< Configures served from the cache.
+   #define ALI_PRCACHE_STAT_MISSES            "PRCache Misses"              ///< Configures whose image was not cached.
+   #define ALI_PRCACHE_STAT_IMAGES            "PRCache Images"              ///< Images held.
+   #define ALI_PRCACHE_STAT_BYTES             "PRCache Bytes"               ///< Bytes held, including GBS headers.
+   #define ALI_PRCACHE_STAT_BYTES_LOCKED      "PRCache Bytes Locked"        ///< Bytes held in memory locked with mlock().
+
+   /// @brief Read, validate and cache a PR image.
+   ///
+   /// An image already cached under AFUId is replaced. A configure still pushing the
+   ///    old image completes from it.
+   ///
+   /// @param[in]  AFUId     AFU ID the image is cached under.
+   /// @param[in]  Filename  Bitstream (.gbs) file.
+   /// @param[out] pHandle   If not NULL, receives the handle of the image.
+   ///
+   /// @return On success, ali_errnumOK.
+   /// @return On failure, ali_errnumBadParameter (bad file or header) or ali_errnumNoMem.
+   virtual AAL::ali_errnum_e prCacheLoad( btcString           AFUId,
+                                          btcString           Filename,
+                                          btUnsigned64bitInt *pHandle = NULL ) = 0;
+
+   /// @brief Drop the image cached under AFUId.
+   ///
+   /// @return On success, ali_errnumOK.
+   /// @return On failure, ali_errnumBadParameter if no image is cached under AFUId.
+   virtual AAL::ali_errnum_e prCacheEvict( btcString AFUId ) = 0;
+
+   /// @brief Obtain the cache statistics.
+   ///
+   /// @param[out]  rResult  Receives the ALI_PRCACHE_STAT_* values, each of type
+   ///                          ALI_PRCACHE_STAT_DATATYPE.
+   /// @retval      True if the statistics were retrieved.
+   virtual btBool prCacheGetStats( INamedValueSet &rResult ) = 0;
+
+}; // class IALIPRCache
+
+
 //-----------------------------------------------------------------------------
 // IALIReconfigure_Client service client interface.
 //-----------------------------------------------------------------------------
@@ -44,6 +44,19 @@
 #include <aalsdk/CUnCopyable.h>
 #include <aalsdk/AALNamedValueSet.h>
 
+/// AIA manifest key: number of completion delivery threads (btUnsigned32bitInt, default 1).
+/// Read when the process's AIA is first initialized.
+#define AIA_NVS_KEY_PUMP_THREADS "AIAPumpThreads"
+/// AFU proxy manifest key: busy-poll budget of SendPolledTransaction(), in microseconds
+/// (btUnsigned32bitInt, default 0 = no polling). Set per proxy.
+#define AIA_NVS_KEY_POLL_SPIN_USEC "AIAPollSpinUsec"
+
+/// IAFUProxy::GetTransportStats() keys (btUnsigned64bitInt).
+#define AIA_STAT_SEND_COUNT      "AIASendCount"        ///< Messages sent to the driver.
+#define AIA_STAT_SEND_NSEC_TOTAL "AIASendNsecTotal"    ///< Total time spent sending, in nanoseconds.
+#define AIA_STAT_SEND_NSEC_MAX   "AIASendNsecMax"      ///< Longest single send, in nanoseconds.
+#define AIA_STAT_POLL_INLINE     "AIAPollInline"       ///< Events delivered by the thread polling for them.
+#define AIA_STAT_POLL_BLOCKED    "AIAPollBlocked"      ///< Polled transactions that outlasted their spin and blocked.
 
 //=============================================================================
 // Name: IAIATransaction
@@ -62,6 +75,10 @@ public:
    virtual  AAL::uid_errnum_e                getErrno()const               = 0;
    virtual  void                             setErrno(AAL::uid_errnum_e)   = 0;
 
+   // Transactions that build their payload in place, just after a ccipui_ioctlreq
+   //  header they own, return that header here so the transport can send it as is.
+   //  getPayloadPtr() must then return the header's payload.
+   virtual  struct AAL::ccipui_ioctlreq *    getIoctlReq()const            { return NULL; }
 };
 
 //==========================================================================
@@ -113,6 +130,12 @@ public:
    // Send a message to the device
    virtual AAL::btBool SendTransaction( IAIATransaction *pAFUmessage )       = 0;
 
+   // Send a message whose completion arrives later as an AFU event. If the proxy was allocated
+   //  with a non-zero AIA_NVS_KEY_POLL_SPIN_USEC, the calling thread then drives the message pump
+   //  until that event has been delivered, and true is returned. Otherwise, or if the send failed,
+   //  this behaves as SendTransaction() and returns false.
+   virtual AAL::btBool SendPolledTransaction( IAIATransaction *pAFUmessage ) = 0;
+
    // Map/Unmap Workspace IDs to virtual memory addresses
    virtual AAL::btBool MapWSID(AAL::btWSSize             Size,
                                AAL::btWSID               wsid,
@@ -120,6 +143,9 @@ public:
                                AAL::NamedValueSet const &optArgs = AAL::NamedValueSet()) = 0;
    virtual void UnMapWSID(AAL::btVirtAddr ptr, AAL::btWSSize Size)           = 0;
 
+   // Send path counters, keyed by AIA_STAT_*. Shared by all proxies in the process.
+   virtual AAL::btBool GetTransportStats(AAL::NamedValueSet &rStats)         = 0;
+
 #if 0
    // Accessors to memory mapped regions
    virtual AAL::btVirtAddr getCSRBase()                                       = 0;
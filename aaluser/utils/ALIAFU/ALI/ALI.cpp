@@ -52,6 +52,7 @@
 #include "HWALIReconf.h"
 #include "HWALISigTap.h"
 #include "ASEALIAFU.h"
+#include "SWSimALIAFU.h"
 
 #include "ALIBase.h"
 
@@ -123,6 +124,16 @@ btBool ALI::init(IBase               *pclientBase,
          return true;
 
       }
+
+      if ( targetType == ali_afu_swswim ) {
+
+         m_tidSaved = TranID;
+         if ( SWSimInit() ) {
+            initComplete(TranID);
+         }
+         return true;
+
+      }
    }
 
    // HW ALI Resource
@@ -148,6 +159,18 @@ btBool ALI::init(IBase               *pclientBase,
     }
    nvsManifest.Add(keyRegHandle, devHandle);
 
+   if( optArgs.Has(ALIAFU_NVS_KEY_AIA_PUMP_THREADS) ) {
+      btUnsigned32bitInt numPumpThreads;
+      optArgs.Get(ALIAFU_NVS_KEY_AIA_PUMP_THREADS, &numPumpThreads);
+      nvsManifest.Add(AIA_NVS_KEY_PUMP_THREADS, numPumpThreads);
+   }
+
+   if( optArgs.Has(ALIAFU_NVS_KEY_POLL_SPIN_USEC) ) {
+      btUnsigned32bitInt pollSpinUsec;
+      optArgs.Get(ALIAFU_NVS_KEY_POLL_SPIN_USEC, &pollSpinUsec);
+      nvsManifest.Add(AIA_NVS_KEY_POLL_SPIN_USEC, pollSpinUsec);
+   }
+
    // Set AIA Service Proxy interface
    if ( EObjOK != SetInterface(iidAFUProxyClient, dynamic_cast<IAFUProxyClient *>(this)) ){
       m_bIsOK = false;
@@ -183,6 +206,15 @@ btBool ALI::Release(TransactionID const &TranID, btTime timeout)
 
          return ServiceBase::Release(m_tidSaved, timeout);
       }
+
+      if ( targetType == ali_afu_swswim ) {
+         if ( m_pALIBase ) {
+            delete m_pALIBase;
+            m_pALIBase = NULL;
+         }
+
+         return ServiceBase::Release(TranID, timeout);
+      }
    }
 
    if ( m_pALIBase ) {
@@ -408,6 +440,10 @@ btBool ALI::setAFUInterfaces()
       goto FAIL;
    }
 
+   if( EObjOK != SetInterface(iidALI_BPOOL_Service, dynamic_cast<IALIBufferPool *>(m_pALIBase)) ){
+      goto FAIL;
+   }
+
    if( EObjOK != SetInterface(iidALI_RSET_Service, dynamic_cast<IALIReset *>(m_pALIBase)) ){
       goto FAIL;
    }
@@ -462,6 +498,27 @@ btBool ALI::setReconfInterfaces()
                                                 " Error: Could not register interface."));
       return false;
    }
+
+   CALIPRCache &cache = (dynamic_cast<CHWALIReconf *>(m_pALIBase))->PRCache();
+
+   if( EObjOK != SetInterface(iidALI_PRCACHE_Service, dynamic_cast<IALIPRCache *>(&cache)) ){
+      AAL_ERR( LM_ALI, "Could not register PR cache interface"<< std::endl);
+      initFailed(new CExceptionTransactionEvent( NULL,
+                                                 m_tidSaved,
+                                                 errCreationFailure,
+                                                 reasUnknown,
+                                                " Error: Could not register interface."));
+      return false;
+   }
+
+   // Preload PR images. An image that fails to load is logged and left out.
+   if( OptArgs().Has(ALIAFU_NVS_KEY_PRCACHE_IMAGES) ) {
+      INamedValueSet const *pImages = NULL;
+      OptArgs().Get(ALIAFU_NVS_KEY_PRCACHE_IMAGES, &pImages);
+      if( NULL != pImages ) {
+         cache.LoadAll(*pImages);
+      }
+   }
    return true;
 }
 
@@ -549,6 +606,10 @@ btBool ALI::ASEInit()
          goto FAIL;
       }
 
+      if( EObjOK != SetInterface(iidALI_BPOOL_Service, dynamic_cast<IALIBufferPool *>(m_pALIBase)) ){
+         goto FAIL;
+      }
+
       if( EObjOK != SetInterface(iidALI_RSET_Service, dynamic_cast<IALIReset *>(m_pALIBase)) ){
          goto FAIL;
       }
@@ -571,6 +632,70 @@ FAIL:
    return false;
 }
 
+//
+// SWSimInit. Sets software simulation AFU ALI Interfaces.
+//
+btBool ALI::SWSimInit()
+{
+   // The AFU ID, when given, selects the model and is what the model reports.
+   btcString pAFUID = NULL;
+   INamedValueSet const *pConfigRecord;
+   if ( ( ENamedValuesOK == OptArgs().Get(AAL_FACTORY_CREATE_CONFIGRECORD_INCLUDED, &pConfigRecord) ) &&
+        pConfigRecord->Has(keyRegAFU_ID) ) {
+      pConfigRecord->Get(keyRegAFU_ID, &pAFUID);
+   } else if ( OptArgs().Has(keyRegAFU_ID) ) {
+      OptArgs().Get(keyRegAFU_ID, &pAFUID);
+   }
+
+   if(m_pALIBase == NULL) {
+
+      m_pALIBase = new (std::nothrow)CSWSimALIAFU(m_pSvcClient,this,m_tidSaved);
+
+      if(m_pALIBase == NULL) {
+         AAL_ERR( LM_ALI, "No Memory to allocate SWSim AFU "<< std::endl);
+         initFailed(new CExceptionTransactionEvent( NULL,
+                                                    m_tidSaved,
+                                                    errMemory,
+                                                    reasUnknown,
+                                                    "Error: Failed to allocate SWSim ALI AFU."));
+
+         return false;
+      }
+
+      if( EObjOK != SetInterface(iidALI_UMSG_Service, dynamic_cast<IALIUMsg *>(m_pALIBase)) ){
+         goto FAIL;
+      }
+
+      if( EObjOK != SetInterface(iidALI_BUFF_Service, dynamic_cast<IALIBuffer *>(m_pALIBase)) ){
+         goto FAIL;
+      }
+
+      if( EObjOK != SetInterface(iidALI_BPOOL_Service, dynamic_cast<IALIBufferPool *>(m_pALIBase)) ){
+         goto FAIL;
+      }
+
+      if( EObjOK != SetInterface(iidALI_RSET_Service, dynamic_cast<IALIReset *>(m_pALIBase)) ){
+         goto FAIL;
+      }
+
+      if( EObjOK != SetInterface(iidALI_MMIO_Service, dynamic_cast<IALIMMIO *>(m_pALIBase)) ){
+          goto FAIL;
+      }
+   }
+
+   return  ((dynamic_cast<CSWSimALIAFU *>(m_pALIBase))->SWSimInit(pAFUID));
+
+FAIL:
+   m_bIsOK = false;
+   AAL_ERR( LM_ALI, "Could not register SWSim AFU interfaces"<< std::endl);
+   initFailed(new CExceptionTransactionEvent( NULL,
+                                              m_tidSaved,
+                                              errCreationFailure,
+                                              reasUnknown,
+                                              "Error: Could not register interface."));
+   return false;
+}
+
 void ALI::serviceReleaseRequest(IBase *pServiceBase, const IEvent &rEvent)
 {
    ERR("Recieved unhandled serviceReleaseRequest() from AFU PRoxy\n");
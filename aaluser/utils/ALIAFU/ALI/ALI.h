@@ -123,6 +123,9 @@ DECLARE_AAL_SERVICE_CONSTRUCTOR(ALI,ServiceBase),
    // Initialize ASE
    btBool ASEInit();
 
+   // Initialize the software simulation backend
+   btBool SWSimInit();
+
 protected:
 
    IAALService            *m_pAALService;
@@ -277,21 +277,16 @@ AFUQuiesceAndHalt::AFUQuiesceAndHalt() :
    m_payload(NULL),
    m_size(0),
    m_bufLength(0),
-   m_errno(uid_errnumOK)
+   m_errno(uid_errnumOK),
+   m_envelope()
 {
    // We need to send an ahm_req within an aalui_CCIdrvMessage packaged in an
    // GetMMIOBufferTransaction-AIATransaction.
    m_size = sizeof(struct aalui_CCIdrvMessage);
 
-   // Allocate structs
-   struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(new (std::nothrow) btByte[m_size]);
-
-   //check afumsg is non-NULL before using it
-   ASSERT(NULL != afumsg);
-   if (afumsg == NULL){
-      setErrno(uid_errnumNoMem);
-      return;
-   }
+   // Build in place in the embedded envelope
+   ASSERT(sizeof(struct ccipui_ioctlreq) + m_size <= sizeof(m_envelope));
+   struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(reinterpret_cast<struct ccipui_ioctlreq *>(m_envelope)->payload);
 
    // fill out aalui_CCIdrvMessage
    afumsg->cmd     = ccipdrv_afucmdPort_afuQuiesceAndHalt;
@@ -310,11 +305,8 @@ AAL::stTransactionID_t const   AFUQuiesceAndHalt::getTranID()const {return m_tid
 AAL::uid_msgIDs_e              AFUQuiesceAndHalt::getMsgID()const {return m_msgID;}
 AAL::uid_errnum_e              AFUQuiesceAndHalt::getErrno()const {return m_errno;};
 void                           AFUQuiesceAndHalt::setErrno(AAL::uid_errnum_e errnum){m_errno = errnum;}
-AFUQuiesceAndHalt::~AFUQuiesceAndHalt() {
-   // unpack payload and free memory
-   struct aalui_CCIdrvMessage *afumsg = (aalui_CCIdrvMessage *)m_payload;
-   delete afumsg;
-}
+struct ccipui_ioctlreq *       AFUQuiesceAndHalt::getIoctlReq()const {return m_bIsOK ? reinterpret_cast<struct ccipui_ioctlreq *>(const_cast<btUnsigned64bitInt *>(m_envelope)) : NULL;}
+AFUQuiesceAndHalt::~AFUQuiesceAndHalt() {}
 
 //=============================================================================
 // Name:          AFUEnable
@@ -329,21 +321,16 @@ AFUEnable::AFUEnable() :
    m_payload(NULL),
    m_size(0),
    m_bufLength(0),
-   m_errno(uid_errnumOK)
+   m_errno(uid_errnumOK),
+   m_envelope()
 {
    // We need to send an ahm_req within an aalui_CCIdrvMessage packaged in an
    // GetMMIOBufferTransaction-AIATransaction.
    m_size = sizeof(struct aalui_CCIdrvMessage);
 
-   // Allocate structs
-   struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(new (std::nothrow) btByte[m_size]);
-
-   //check afumsg is non-NULL before using it
-   ASSERT(NULL != afumsg);
-   if (afumsg == NULL){
-      setErrno(uid_errnumNoMem);
-      return;
-   }
+   // Build in place in the embedded envelope
+   ASSERT(sizeof(struct ccipui_ioctlreq) + m_size <= sizeof(m_envelope));
+   struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(reinterpret_cast<struct ccipui_ioctlreq *>(m_envelope)->payload);
 
    // fill out aalui_CCIdrvMessage
    afumsg->cmd     = ccipdrv_afucmdPort_afuEnable;
@@ -362,11 +349,8 @@ AAL::stTransactionID_t const   AFUEnable::getTranID()const {return m_tid_t;}
 AAL::uid_msgIDs_e              AFUEnable::getMsgID()const {return m_msgID;}
 AAL::uid_errnum_e              AFUEnable::getErrno()const {return m_errno;};
 void                           AFUEnable::setErrno(AAL::uid_errnum_e errnum){m_errno = errnum;}
-AFUEnable::~AFUEnable() {
-   // unpack payload and free memory
-   struct aalui_CCIdrvMessage *afumsg = (aalui_CCIdrvMessage *)m_payload;
-   delete afumsg;
-}
+struct ccipui_ioctlreq *       AFUEnable::getIoctlReq()const {return m_bIsOK ? reinterpret_cast<struct ccipui_ioctlreq *>(const_cast<btUnsigned64bitInt *>(m_envelope)) : NULL;}
+AFUEnable::~AFUEnable() {}
 
 //=============================================================================
 // Name:          UmsgGetNumber
@@ -380,21 +364,16 @@ UmsgGetNumber::UmsgGetNumber() :
    m_payload(NULL),
    m_size(0),
    m_bufLength(0),
-   m_errno(uid_errnumOK)
+   m_errno(uid_errnumOK),
+   m_envelope()
 {
    // We need to send an ahm_req within an aalui_CCIdrvMessage packaged in an
    // BufferAllocate-AIATransaction.
    m_size = sizeof(struct aalui_CCIdrvMessage) +  sizeof(struct ahm_req );
 
-   // Allocate structs
-   struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(new (std::nothrow) btByte[m_size]);
-
-   //check afumsg is non-NULL before using it
-   ASSERT(NULL != afumsg);
-   if (afumsg == NULL){
-     setErrno(uid_errnumNoMem);
-     return;
-   }
+   // Build in place in the embedded envelope
+   ASSERT(sizeof(struct ccipui_ioctlreq) + m_size <= sizeof(m_envelope));
+   struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(reinterpret_cast<struct ccipui_ioctlreq *>(m_envelope)->payload);
 
    // Point at payload
    struct ahm_req *req                 = reinterpret_cast<struct ahm_req *>(afumsg->payload);
@@ -420,12 +399,9 @@ AAL::uid_msgIDs_e              UmsgGetNumber::getMsgID()const {return m_msgID;}
 AAL::btUnsignedInt             UmsgGetNumber::getNumber() const {return (reinterpret_cast<struct ahm_req *>(m_payload)->u.mem_uv2id.mem_id);}
 AAL::uid_errnum_e              UmsgGetNumber::getErrno()const {return m_errno;};
 void                           UmsgGetNumber::setErrno(AAL::uid_errnum_e errnum){m_errno = errnum;}
+struct ccipui_ioctlreq *       UmsgGetNumber::getIoctlReq()const {return m_bIsOK ? reinterpret_cast<struct ccipui_ioctlreq *>(const_cast<btUnsigned64bitInt *>(m_envelope)) : NULL;}
 
-UmsgGetNumber::~UmsgGetNumber() {
-   // unpack payload and free memory
-   struct aalui_CCIdrvMessage *afumsg = (aalui_CCIdrvMessage *)m_payload;     // FIXME: use C++ style casts
-   delete afumsg;
-}
+UmsgGetNumber::~UmsgGetNumber() {}
 
 //=============================================================================
 // Name:          UmsgGetBaseAddress
@@ -439,7 +415,8 @@ UmsgGetBaseAddress::UmsgGetBaseAddress() :
    m_payload(NULL),
    m_size(0),
    m_bufLength(0),
-   m_errno(uid_errnumOK)
+   m_errno(uid_errnumOK),
+   m_envelope()
 {
 
    union msgpayload{
@@ -451,15 +428,9 @@ UmsgGetBaseAddress::UmsgGetBaseAddress() :
     // GetMMIOBufferTransaction-AIATransaction.
     m_size = sizeof(struct aalui_CCIdrvMessage) +  sizeof(union msgpayload );
 
-    // Allocate structs
-    struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(new (std::nothrow) btByte[m_size]);
-
-   //check afumsg is non-NULL before using it
-   ASSERT(NULL != afumsg);
-   if (afumsg == NULL){
-     setErrno(uid_errnumNoMem);
-     return;
-   }
+   // Build in place in the embedded envelope
+   ASSERT(sizeof(struct ccipui_ioctlreq) + m_size <= sizeof(m_envelope));
+   struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(reinterpret_cast<struct ccipui_ioctlreq *>(m_envelope)->payload);
 
    // Point at payload
    struct ahm_req *req                 = reinterpret_cast<struct ahm_req *>(afumsg->payload);
@@ -484,11 +455,8 @@ AAL::uid_msgIDs_e              UmsgGetBaseAddress::getMsgID()const {return m_msg
 struct AAL::aalui_WSMEvent     UmsgGetBaseAddress::getWSIDEvent() const {return *(reinterpret_cast<struct AAL::aalui_WSMEvent*>(m_payload));}
 AAL::uid_errnum_e              UmsgGetBaseAddress::getErrno()const {return m_errno;};
 void                           UmsgGetBaseAddress::setErrno(AAL::uid_errnum_e errnum){m_errno = errnum;}
-UmsgGetBaseAddress::~UmsgGetBaseAddress() {
-   // unpack payload and free memory
-   struct aalui_CCIdrvMessage *afumsg = (aalui_CCIdrvMessage *)m_payload;
-   delete afumsg;
-}
+struct ccipui_ioctlreq *       UmsgGetBaseAddress::getIoctlReq()const {return m_bIsOK ? reinterpret_cast<struct ccipui_ioctlreq *>(const_cast<btUnsigned64bitInt *>(m_envelope)) : NULL;}
+UmsgGetBaseAddress::~UmsgGetBaseAddress() {}
 
 
 //=============================================================================
@@ -503,7 +471,8 @@ UmsgSetAttributes::UmsgSetAttributes(AAL::NamedValueSet const &nvsArgs) :
    m_payload(NULL),
    m_size(0),
    m_bufLength(0),
-   m_errno(uid_errnumOK)
+   m_errno(uid_errnumOK),
+   m_envelope()
 {
 
    if( true != nvsArgs.Has(UMSG_HINT_MASK_KEY)){
@@ -532,15 +501,9 @@ UmsgSetAttributes::UmsgSetAttributes(AAL::NamedValueSet const &nvsArgs) :
    // GetMMIOBufferTransaction-AIATransaction.
    m_size = sizeof(struct aalui_CCIdrvMessage) +  sizeof(struct ahm_req );
 
-   // Allocate structs
-   struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(new (std::nothrow) btByte[m_size]);
-
-   //check afumsg is non-NULL before using it
-   ASSERT(NULL != afumsg);
-   if (afumsg == NULL){
-     setErrno(uid_errnumNoMem);
-     return;
-   }
+   // Build in place in the embedded envelope
+   ASSERT(sizeof(struct ccipui_ioctlreq) + m_size <= sizeof(m_envelope));
+   struct aalui_CCIdrvMessage *afumsg  = reinterpret_cast<struct aalui_CCIdrvMessage *>(reinterpret_cast<struct ccipui_ioctlreq *>(m_envelope)->payload);
 
    // Point at payload
    struct ahm_req *req                 = reinterpret_cast<struct ahm_req *>(afumsg->payload);
@@ -564,11 +527,8 @@ AAL::uid_msgIDs_e              UmsgSetAttributes::getMsgID()const {return m_msgI
 struct AAL::aalui_WSMEvent     UmsgSetAttributes::getWSIDEvent() const {return *(reinterpret_cast<struct AAL::aalui_WSMEvent*>(m_payload));}
 AAL::uid_errnum_e              UmsgSetAttributes::getErrno()const {return m_errno;};
 void                           UmsgSetAttributes::setErrno(AAL::uid_errnum_e errnum){m_errno = errnum;}
-UmsgSetAttributes::~UmsgSetAttributes() {
-   // unpack payload and free memory
-   struct aalui_CCIdrvMessage *afumsg = (aalui_CCIdrvMessage *)m_payload;
-   delete afumsg;
-}
+struct ccipui_ioctlreq *       UmsgSetAttributes::getIoctlReq()const {return m_bIsOK ? reinterpret_cast<struct ccipui_ioctlreq *>(const_cast<btUnsigned64bitInt *>(m_envelope)) : NULL;}
+UmsgSetAttributes::~UmsgSetAttributes() {}
 
 //=============================================================================
 // Name:          PerfCounterGet
@@ -782,7 +742,8 @@ AFUDeactivateTransaction::~AFUDeactivateTransaction() {
 AFUConfigureTransaction::AFUConfigureTransaction(AAL::btVirtAddr pBuf,
                                                  AAL::btWSSize len,
                                                  AAL::TransactionID const &rTranID,
-                                                 AAL::NamedValueSet const &rNVS) :
+                                                 AAL::NamedValueSet const &rNVS,
+                                                 AAL::btBool bStream) :
    m_msgID(reqid_UID_SendAFU),
    m_tid_t(rTranID),
    m_bIsOK(false),
@@ -842,6 +803,11 @@ AFUConfigureTransaction::AFUConfigureTransaction(AAL::btVirtAddr pBuf,
       }
    }
 
+   // Push straight from the caller's pages
+   if(bStream){
+      req->u.pr_config.reconfAction |= ReConf_Action_Stream;
+   }
+
    // fill out aalui_CCIdrvMessage
    afumsg->cmd     = ccipdrv_configureAFU;
    afumsg->size    = sizeof(struct ahm_req) ;
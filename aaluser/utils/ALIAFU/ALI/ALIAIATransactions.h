@@ -161,6 +161,14 @@ private:
 }; // class GetMMIOBufferTransaction
 
 
+// Size, in 64-bit words, of the ccipui_ioctlreq envelope embedded in the small,
+//  frequently sent transactions below. They build their aalui_CCIdrvMessage in
+//  place after the envelope's header, so sending them allocates and copies nothing.
+#define ALI_AIA_ENVELOPE_QWORDS ( ( sizeof(struct AAL::ccipui_ioctlreq)     + \
+                                    sizeof(struct AAL::aalui_CCIdrvMessage) + \
+                                    sizeof(struct AAL::ahm_req)             + \
+                                    sizeof(struct AAL::aalui_WSMEvent)      + 7 ) / 8 )
+
 //=============================================================================
 // Name:          AFUQuiesceAndHalt
 // Description:   Quisce the AFU and put it into a halted state
@@ -179,6 +187,7 @@ public:
    AAL::uid_msgIDs_e              getMsgID() const;
    AAL::uid_errnum_e              getErrno()const;
    void                           setErrno(AAL::uid_errnum_e);
+   struct AAL::ccipui_ioctlreq *  getIoctlReq() const;
 
 
    ~AFUQuiesceAndHalt();
@@ -191,6 +200,7 @@ private:
    AAL::btWSSize                 m_size;
    AAL::btWSSize                 m_bufLength;
    AAL::uid_errnum_e             m_errno;
+   AAL::btUnsigned64bitInt       m_envelope[ALI_AIA_ENVELOPE_QWORDS];
 
 }; // class AFUQuiesceAndHalt
 
@@ -212,6 +222,7 @@ public:
    AAL::uid_msgIDs_e              getMsgID() const;
    AAL::uid_errnum_e              getErrno()const;
    void                           setErrno(AAL::uid_errnum_e);
+   struct AAL::ccipui_ioctlreq *  getIoctlReq() const;
 
 
    ~AFUEnable();
@@ -224,6 +235,7 @@ private:
    AAL::btWSSize                 m_size;
    AAL::btWSSize                 m_bufLength;
    AAL::uid_errnum_e             m_errno;
+   AAL::btUnsigned64bitInt       m_envelope[ALI_AIA_ENVELOPE_QWORDS];
 
 }; // class AFUEnable
 
@@ -246,6 +258,7 @@ public:
    AAL::btUnsignedInt             getNumber() const;
    AAL::uid_errnum_e              getErrno()const;
    void                           setErrno(AAL::uid_errnum_e);
+   struct AAL::ccipui_ioctlreq *  getIoctlReq() const;
 
 
    ~UmsgGetNumber();
@@ -258,6 +271,7 @@ private:
    AAL::btWSSize                 m_size;
    AAL::btWSSize                 m_bufLength;
    AAL::uid_errnum_e             m_errno;
+   AAL::btUnsigned64bitInt       m_envelope[ALI_AIA_ENVELOPE_QWORDS];
 
 }; // class UmsgGetNumber
 
@@ -280,6 +294,7 @@ public:
    struct AAL::aalui_WSMEvent     getWSIDEvent() const;
    AAL::uid_errnum_e              getErrno()const;
    void                           setErrno(AAL::uid_errnum_e);
+   struct AAL::ccipui_ioctlreq *  getIoctlReq() const;
 
 
    ~UmsgGetBaseAddress();
@@ -292,6 +307,7 @@ private:
    AAL::btWSSize                 m_size;
    AAL::btWSSize                 m_bufLength;
    AAL::uid_errnum_e             m_errno;
+   AAL::btUnsigned64bitInt       m_envelope[ALI_AIA_ENVELOPE_QWORDS];
 
 }; // class UmsgGetBaseAddress
 
@@ -314,6 +330,7 @@ public:
    struct AAL::aalui_WSMEvent     getWSIDEvent() const;
    AAL::uid_errnum_e              getErrno()const;
    void                           setErrno(AAL::uid_errnum_e);
+   struct AAL::ccipui_ioctlreq *  getIoctlReq() const;
 
 
    ~UmsgSetAttributes();
@@ -326,6 +343,7 @@ private:
    AAL::btWSSize                 m_size;
    AAL::btWSSize                 m_bufLength;
    AAL::uid_errnum_e             m_errno;
+   AAL::btUnsigned64bitInt       m_envelope[ALI_AIA_ENVELOPE_QWORDS];
 
 }; // class umsgSetAttributes
 
@@ -444,10 +462,14 @@ private:
 class UAIA_API AFUConfigureTransaction : public IAIATransaction
 {
 public:
+   // bStream asks the driver to push from pBuf's pinned pages rather than a kernel copy.
+   // pBuf must then stay unmodified until the configure completes, as a read-only file
+   // mapping does.
    AFUConfigureTransaction(AAL::btVirtAddr pBuf,
                            AAL::btWSSize len,
                            AAL::TransactionID const &rTranID,
-                           AAL::NamedValueSet const &rNVS = AAL::NamedValueSet());
+                           AAL::NamedValueSet const &rNVS = AAL::NamedValueSet(),
+                           AAL::btBool bStream = false);
    AAL::btBool                      IsOK() const;
 
    AAL::btVirtAddr                  getPayloadPtr() const;
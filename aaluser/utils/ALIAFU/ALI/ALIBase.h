@@ -77,6 +77,35 @@ public :
 protected:
    IRuntime * getRuntime() { return m_pServiceBase->getRuntime(); }
 
+   // Check every element of an MMIO batch against an MMIO region of Length bytes.
+   static btBool mmioBatchIsValid( ali_mmio_access_t const *pAccesses,
+                                   btUnsignedInt            Count,
+                                   btCSROffset              Length )
+   {
+      if ( NULL == pAccesses ) {
+         return false;
+      }
+
+      btUnsignedInt i;
+      for ( i = 0 ; i < Count ; ++i ) {
+         btCSROffset bytes;
+
+         switch ( pAccesses[i].width ) {
+            case ali_mmio_width32 : bytes = sizeof(btUnsigned32bitInt); break;
+            case ali_mmio_width64 : bytes = sizeof(btUnsigned64bitInt); break;
+            default               : return false;
+         }
+
+         if ( ( Length < bytes ) ||
+              ( pAccesses[i].offset > Length - bytes ) ||
+              ( 0 != ( pAccesses[i].offset % bytes ) ) ) {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
    IBase                  *m_pSvcClient;
    IServiceBase           *m_pServiceBase;
    TransactionID           m_tidSaved;
@@ -0,0 +1,312 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file ALIBufferIndex.h
+/// @brief Address range index for ALI shared buffers (workspaces).
+/// @ingroup ALI
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// Keeps the workspaces owned by an ALI delegate sorted by virtual address so
+/// that a virtual address anywhere inside a buffer can be translated to its
+/// IOVA with a binary search.
+///
+/// Writers (buffer allocate / free) serialize on the index's CriticalSection
+/// and publish a new immutable table. Readers (bufferGetIOVA) take no lock:
+/// they announce themselves in the reader count of the current epoch, load
+/// the current table and search it. A writer that finds the other epoch's
+/// count at zero frees the tables replaced before the last epoch change and
+/// makes that epoch current, so reclamation keeps pace with a steady stream
+/// of readers; only readers that started before the change are waited on.@endverbatim
+//****************************************************************************
+#ifndef __ALIBUFFERINDEX_H__
+#define __ALIBUFFERINDEX_H__
+#include <aalsdk/AALTypes.h>
+#include <aalsdk/kernel/ccipdriver.h>
+#include <aalsdk/osal/CriticalSection.h>
+
+#include <algorithm>
+#include <vector>
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup ALI
+/// @{
+
+class CALIBufferIndex : public CriticalSection
+{
+public:
+   CALIBufferIndex() :
+      m_pTable(new Table()),
+      m_Epoch(0),
+      m_Retired(),
+      m_Waiting()
+   {
+      m_Readers[0] = 0;
+      m_Readers[1] = 0;
+   }
+
+   virtual ~CALIBufferIndex()
+   {
+      AutoLock(this);
+      Reclaim(true);
+      delete m_pTable;
+      m_pTable = NULL;
+   }
+
+   /// Record a workspace. Returns false if a workspace is already recorded at Parms.ptr.
+   btBool Add(struct aalui_WSMParms const &Parms)
+   {
+      AutoLock(this);
+
+      Table const *pOld = m_pTable;
+      Table::const_iterator pos = std::lower_bound(pOld->begin(), pOld->end(), Parms.ptr, PtrLess());
+
+      if ( ( pos != pOld->end() ) && ( (*pos).ptr == Parms.ptr ) ) {
+         return false;
+      }
+
+      Table *pNew = new Table();
+      pNew->reserve(pOld->size() + 1);
+      pNew->insert(pNew->end(), pOld->begin(), pos);
+      pNew->push_back(Parms);
+      pNew->insert(pNew->end(), pos, pOld->end());
+
+      Publish(pNew);
+      return true;
+   }
+
+   /// Forget the workspace recorded at exactly Address, optionally returning its parameters.
+   btBool Remove(btVirtAddr Address, struct aalui_WSMParms *pParms = NULL)
+   {
+      AutoLock(this);
+
+      Table const *pOld = m_pTable;
+      Table::const_iterator pos = std::lower_bound(pOld->begin(), pOld->end(), Address, PtrLess());
+
+      if ( ( pos == pOld->end() ) || ( (*pos).ptr != Address ) ) {
+         return false;
+      }
+
+      if ( NULL != pParms ) {
+         *pParms = *pos;
+      }
+
+      Table *pNew = new Table();
+      pNew->reserve(pOld->size() - 1);
+      pNew->insert(pNew->end(), pOld->begin(), pos);
+      pNew->insert(pNew->end(), pos + 1, pOld->end());
+
+      Publish(pNew);
+      return true;
+   }
+
+   /// Retrieve the parameters of the workspace recorded at exactly Address.
+   btBool Find(btVirtAddr Address, struct aalui_WSMParms *pParms) const
+   {
+      ReadGuard g(this);
+      Table::const_iterator pos = std::lower_bound(g->begin(), g->end(), Address, PtrLess());
+
+      if ( ( pos == g->end() ) || ( (*pos).ptr != Address ) ) {
+         return false;
+      }
+
+      if ( NULL != pParms ) {
+         *pParms = *pos;
+      }
+      return true;
+   }
+
+   /// Retrieve the parameters of the workspace containing Address.
+   /// Lock-free; safe to call concurrently with Add() and Remove().
+   btBool FindContaining(btVirtAddr Address, struct aalui_WSMParms *pParms) const
+   {
+      ReadGuard g(this);
+      Table::const_iterator pos = Containing(*g, Address);
+
+      if ( pos == g->end() ) {
+         return false;
+      }
+
+      if ( NULL != pParms ) {
+         *pParms = *pos;
+      }
+      return true;
+   }
+
+   /// Translate any virtual address within a recorded workspace to its IOVA.
+   /// Returns 0 when Address does not fall within a recorded workspace.
+   /// Lock-free; safe to call concurrently with Add() and Remove().
+   btPhysAddr GetIOVA(btVirtAddr Address) const
+   {
+      ReadGuard g(this);
+      Table::const_iterator pos = Containing(*g, Address);
+
+      if ( pos == g->end() ) {
+         return 0;
+      }
+      return (*pos).physptr + (Address - (*pos).ptr);
+   }
+
+   btUnsignedInt Size() const
+   {
+      ReadGuard g(this);
+      return (btUnsignedInt)g->size();
+   }
+
+   /// Copy out the parameters of every recorded workspace, in address order.
+   void Snapshot(std::vector<struct aalui_WSMParms> &rParms) const
+   {
+      ReadGuard g(this);
+      rParms.assign(g->begin(), g->end());
+   }
+
+protected:
+   typedef std::vector<struct aalui_WSMParms> Table;
+
+   struct PtrLess
+   {
+      bool operator() (struct aalui_WSMParms const &l, btVirtAddr r) const { return l.ptr < r;     }
+      bool operator() (btVirtAddr l, struct aalui_WSMParms const &r) const { return l     < r.ptr; }
+   };
+
+   static Table::const_iterator Containing(Table const &t, btVirtAddr Address)
+   {
+      // First workspace starting beyond Address; the candidate is the one before it.
+      Table::const_iterator pos = std::upper_bound(t.begin(), t.end(), Address, PtrLess());
+      if ( pos == t.begin() ) {
+         return t.end();
+      }
+      --pos;
+
+      if ( Address < (*pos).ptr + (*pos).size ) {
+         return pos;
+      }
+      return t.end();
+   }
+
+   // Brackets a lock-free read of the current table.
+   class ReadGuard
+   {
+   public:
+      ReadGuard(CALIBufferIndex const *pIndex) :
+         m_pIndex(const_cast<CALIBufferIndex *>(pIndex)),
+         m_Epoch(pIndex->m_Epoch)
+      {
+         // The full barrier implied by the increment orders it before the table load,
+         //  pairing with the barrier in Reclaim().
+         AtomicAdd(&m_pIndex->m_Readers[m_Epoch], 1);
+         m_pTable = m_pIndex->m_pTable;
+      }
+      ~ReadGuard() { AtomicAdd(&m_pIndex->m_Readers[m_Epoch], -1); }
+
+      Table const * operator -> () const { return  m_pTable; }
+      Table const & operator *  () const { return *m_pTable; }
+
+   private:
+      CALIBufferIndex *m_pIndex;
+      btInt            m_Epoch;
+      Table const     *m_pTable;
+   };
+
+   // Called with the lock held.
+   void Publish(Table *pNew)
+   {
+      m_Retired.push_back(const_cast<Table *>(m_pTable));
+      m_pTable = pNew;
+      Reclaim(false);
+   }
+
+   // Called with the lock held. Free replaced tables once no reader can still be using them.
+   //
+   // A reader counts itself in the epoch that was current when it started. Once the other
+   //  epoch's count drops to zero, every reader that could have loaded a table replaced
+   //  before the last epoch change is done: later readers only find newer tables. Those
+   //  tables are freed, and the other epoch becomes current, starting the next wait. Two
+   //  passes empty both lists when no reader is in flight.
+   void Reclaim(btBool bForce)
+   {
+      if ( bForce ) {
+         Free(m_Waiting);
+         Free(m_Retired);
+         return;
+      }
+
+      btInt pass;
+      for ( pass = 0 ; pass < 2 ; ++pass ) {
+         FullBarrier();
+         if ( m_Waiting.empty() && m_Retired.empty() ) {
+            break;
+         }
+         if ( 0 != m_Readers[m_Epoch ^ 1] ) {
+            break;
+         }
+         Free(m_Waiting);
+         m_Waiting.swap(m_Retired);
+         m_Epoch ^= 1;
+      }
+   }
+
+   static void Free(std::vector<Table *> &rTables)
+   {
+      std::vector<Table *>::iterator iter;
+      for ( iter = rTables.begin() ; rTables.end() != iter ; ++iter ) {
+         delete *iter;
+      }
+      rTables.clear();
+   }
+
+   static void AtomicAdd(volatile btInt *p, btInt n)
+   {
+#if   defined( __AAL_WINDOWS__ )
+      InterlockedExchangeAdd((volatile LONG *)p, (LONG)n);
+#elif defined( __AAL_LINUX__ )
+      __sync_fetch_and_add(p, n);
+#endif // OS
+   }
+
+   static void FullBarrier()
+   {
+#if   defined( __AAL_WINDOWS__ )
+      ::MemoryBarrier();
+#elif defined( __AAL_LINUX__ )
+      __sync_synchronize();
+#endif // OS
+   }
+
+   Table const * volatile m_pTable;
+   volatile btInt         m_Epoch;
+   volatile btInt         m_Readers[2];  // Readers in flight, by the epoch they started in
+   std::vector<Table *>   m_Retired;     // Replaced since the last epoch change
+   std::vector<Table *>   m_Waiting;     // Replaced before it; freed when the other epoch drains
+};
+
+/// @}
+
+END_NAMESPACE(AAL)
+
+#endif // __ALIBUFFERINDEX_H__
+
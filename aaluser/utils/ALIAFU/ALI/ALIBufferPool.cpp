@@ -0,0 +1,429 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file ALIBufferPool.cpp
+/// @brief Pooled sub-allocator for ALI shared buffers.
+/// @ingroup ALI
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// Lock ordering: a Shard lock may be held while taking the pool lock, never
+/// the reverse.@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include <aalsdk/AALLoggerExtern.h>
+#include <aalsdk/osal/Thread.h>
+#include "ALIBufferPool.h"
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup ALI
+/// @{
+
+CALIBufferPool::Shard::Shard() :
+   m_Hits(0),
+   m_BytesInUse(0),
+   m_RoundingWaste(0)
+{
+   memset(m_Free,  0, sizeof(m_Free));
+   memset(m_Count, 0, sizeof(m_Count));
+}
+
+CALIBufferPool::CALIBufferPool(IALIBuffer *pBackend) :
+   m_pBackend(pBackend),
+   m_Slabs(),
+   m_Misses(0),
+   m_BytesReserved(0),
+   m_BytesPassThru(0)
+{
+   ASSERT(NULL != m_pBackend);
+   memset(m_Free,     0, sizeof(m_Free));
+   memset(m_BumpNext, 0, sizeof(m_BumpNext));
+   memset(m_BumpEnd,  0, sizeof(m_BumpEnd));
+}
+
+CALIBufferPool::~CALIBufferPool()
+{
+   Release();
+}
+
+//
+// bufferPoolAllocate. Allocate a chunk, refilling from the pool list or a new slab as needed.
+//
+AAL::ali_errnum_e CALIBufferPool::bufferPoolAllocate( btWSSize    Length,
+                                                      btVirtAddr *pBufferptr,
+                                                      btPhysAddr *pIOVA )
+{
+   if ( ( NULL == pBufferptr ) || ( 0 == Length ) ) {
+      return ali_errnumBadParameter;
+   }
+   *pBufferptr = NULL;
+
+   btInt Class = SizeToClass(Length);
+
+   if ( Class < 0 ) {
+      // Too large to pool. Pass through to the backend, but remember it so that
+      //  bufferPoolFree() accepts it.
+      btVirtAddr            ptr = NULL;
+      AAL::ali_errnum_e     res = m_pBackend->bufferAllocate(Length, &ptr);
+      struct aalui_WSMParms parms;
+
+      if ( ali_errnumOK != res ) {
+         return res;
+      }
+
+      memset(&parms, 0, sizeof(parms));
+      parms.ptr     = ptr;
+      parms.physptr = m_pBackend->bufferGetIOVA(ptr);
+      parms.size    = Length;
+      m_Slabs.Add(parms);
+
+      {
+         AutoLock(this);
+         ++m_Misses;
+         m_BytesPassThru += Length;
+      }
+
+      *pBufferptr = ptr;
+      if ( NULL != pIOVA ) {
+         *pIOVA = parms.physptr;
+      }
+      return ali_errnumOK;
+   }
+
+   Shard     &shard  = MyShard();
+   FreeChunk *pChunk = NULL;
+   btBool     bMiss  = false;
+
+   {
+      AutoLock(&shard);
+
+      pChunk = shard.m_Free[Class];
+      if ( NULL != pChunk ) {
+         shard.m_Free[Class] = pChunk->m_pNext;
+         --shard.m_Count[Class];
+      } else {
+         pChunk = Refill(shard, Class, &bMiss);
+         if ( NULL == pChunk ) {
+            return ali_errnumNoMem;
+         }
+      }
+
+      pChunk->m_Tag = 0;
+
+      if ( !bMiss ) {
+         ++shard.m_Hits;
+      }
+      shard.m_BytesInUse    += ClassToSize(Class);
+      shard.m_RoundingWaste += ClassToSize(Class) - Length;
+   }
+
+   *pBufferptr = reinterpret_cast<btVirtAddr>(pChunk);
+
+   if ( NULL != pIOVA ) {
+      struct aalui_WSMParms parms;
+      if ( m_Slabs.FindContaining(*pBufferptr, &parms) ) {
+         *pIOVA = parms.physptr + (*pBufferptr - parms.ptr);
+      } else {
+         AAL_ERR(LM_ALI, "Buffer pool chunk outside of any slab" << std::endl);
+         *pIOVA = 0;
+      }
+   }
+
+   return ali_errnumOK;
+}
+
+//
+// bufferPoolFree. Return a chunk to the calling thread's shard.
+//
+AAL::ali_errnum_e CALIBufferPool::bufferPoolFree( btVirtAddr Address )
+{
+   struct aalui_WSMParms parms;
+
+   if ( !m_Slabs.FindContaining(Address, &parms) ) {
+      AAL_ERR(LM_ALI, "Tried to free a chunk not owned by the buffer pool" << std::endl);
+      return ali_errnumBadParameter;
+   }
+
+   if ( 0 == parms.wsid ) {
+      // Pass-through buffer.
+      if ( ( Address != parms.ptr ) || !m_Slabs.Remove(Address) ) {
+         return ali_errnumBadParameter;
+      }
+
+      {
+         AutoLock(this);
+         m_BytesPassThru -= parms.size;
+      }
+
+      return m_pBackend->bufferFree(Address);
+   }
+
+   if ( 0 != ( (btWSSize)(Address - parms.ptr) % parms.itemsize ) ) {
+      AAL_ERR(LM_ALI, "Tried to free a misaligned buffer pool chunk" << std::endl);
+      return ali_errnumBadParameter;
+   }
+
+   btInt      Class  = (btInt)parms.wsid - 1;
+   FreeChunk *pChunk = reinterpret_cast<FreeChunk *>(Address);
+
+   // The tag alone may be application data, so confirm against the free lists.
+   if ( ( FreeTag() == pChunk->m_Tag ) && IsFree(pChunk, Class) ) {
+      AAL_ERR(LM_ALI, "Tried to free a buffer pool chunk that is already free" << std::endl);
+      return ali_errnumBadParameter;
+   }
+
+   Shard &shard = MyShard();
+
+   AutoLock(&shard);
+
+   shard.m_BytesInUse -= (bt64bitInt)parms.itemsize;
+   pChunk->m_Tag       = FreeTag();
+
+   if ( shard.m_Count[Class] < ShardHighWater ) {
+      pChunk->m_pNext     = shard.m_Free[Class];
+      shard.m_Free[Class] = pChunk;
+      ++shard.m_Count[Class];
+   } else {
+      AutoLock(this);
+      pChunk->m_pNext = m_Free[Class];
+      m_Free[Class]   = pChunk;
+   }
+
+   return ali_errnumOK;
+}
+
+//
+// bufferPoolGetStats. Report hits, misses and fragmentation.
+//
+btBool CALIBufferPool::bufferPoolGetStats( INamedValueSet &rResult )
+{
+   btUnsigned64bitInt hits   = 0;
+   btUnsigned64bitInt waste  = 0;
+   bt64bitInt         inuse  = 0;
+   btUnsigned64bitInt misses;
+   btUnsigned64bitInt reserved;
+   btInt              i;
+
+   for ( i = 0 ; i < NumShards ; ++i ) {
+      AutoLock(&m_Shards[i]);
+      hits  += m_Shards[i].m_Hits;
+      waste += m_Shards[i].m_RoundingWaste;
+      inuse += m_Shards[i].m_BytesInUse;
+   }
+
+   {
+      AutoLock(this);
+      misses   = m_Misses;
+      reserved = m_BytesReserved + m_BytesPassThru;
+      inuse   += m_BytesPassThru;
+   }
+
+   if ( inuse < 0 ) {
+      inuse = 0; // Transient, while a free is being counted against another shard.
+   }
+
+   rResult.Add(ALI_BUFFPOOL_STAT_HITS,           (ALI_BUFFPOOL_STAT_DATATYPE)hits);
+   rResult.Add(ALI_BUFFPOOL_STAT_MISSES,         (ALI_BUFFPOOL_STAT_DATATYPE)misses);
+   rResult.Add(ALI_BUFFPOOL_STAT_BYTES_RESERVED, (ALI_BUFFPOOL_STAT_DATATYPE)reserved);
+   rResult.Add(ALI_BUFFPOOL_STAT_BYTES_INUSE,    (ALI_BUFFPOOL_STAT_DATATYPE)inuse);
+   rResult.Add(ALI_BUFFPOOL_STAT_ROUNDING_WASTE, (ALI_BUFFPOOL_STAT_DATATYPE)waste);
+   rResult.Add(ALI_BUFFPOOL_STAT_FRAGMENTATION,
+               (ALI_BUFFPOOL_STAT_DATATYPE)( ( reserved > (btUnsigned64bitInt)inuse ) ?
+                                             ( ( reserved - (btUnsigned64bitInt)inuse ) * 100 ) / reserved : 0 ));
+   return true;
+}
+
+//
+// Release. Hand every slab and pass-through buffer back to the backend.
+//
+void CALIBufferPool::Release()
+{
+   std::vector<struct aalui_WSMParms>           slabs;
+   std::vector<struct aalui_WSMParms>::iterator iter;
+   btInt                                        i;
+
+   for ( i = 0 ; i < NumShards ; ++i ) {
+      AutoLock(&m_Shards[i]);
+      memset(m_Shards[i].m_Free,  0, sizeof(m_Shards[i].m_Free));
+      memset(m_Shards[i].m_Count, 0, sizeof(m_Shards[i].m_Count));
+      m_Shards[i].m_BytesInUse = 0;
+   }
+
+   AutoLock(this);
+
+   m_Slabs.Snapshot(slabs);
+   for ( iter = slabs.begin() ; slabs.end() != iter ; ++iter ) {
+      m_Slabs.Remove((*iter).ptr);
+      m_pBackend->bufferFree((*iter).ptr);
+   }
+
+   memset(m_Free,     0, sizeof(m_Free));
+   memset(m_BumpNext, 0, sizeof(m_BumpNext));
+   memset(m_BumpEnd,  0, sizeof(m_BumpEnd));
+   m_BytesReserved = 0;
+   m_BytesPassThru = 0;
+}
+
+//
+// SizeToClass. Smallest class holding Length, or -1 if Length is larger than the largest class.
+//
+btInt CALIBufferPool::SizeToClass(btWSSize Length)
+{
+   btInt Class = 0;
+   while ( ClassToSize(Class) < Length ) {
+      if ( ++Class >= NumClasses ) {
+         return -1;
+      }
+   }
+   return Class;
+}
+
+//
+// IsFree. Whether pChunk is on a free list of Class. Called with no lock held.
+//
+btBool CALIBufferPool::IsFree(FreeChunk const *pChunk, btInt Class)
+{
+   FreeChunk const *p;
+   btInt            i;
+
+   for ( i = 0 ; i < NumShards ; ++i ) {
+      AutoLock(&m_Shards[i]);
+      for ( p = m_Shards[i].m_Free[Class] ; NULL != p ; p = p->m_pNext ) {
+         if ( pChunk == p ) {
+            return true;
+         }
+      }
+   }
+
+   AutoLock(this);
+   for ( p = m_Free[Class] ; NULL != p ; p = p->m_pNext ) {
+      if ( pChunk == p ) {
+         return true;
+      }
+   }
+   return false;
+}
+
+//
+// MyShard. Hash the calling thread to a shard.
+//
+CALIBufferPool::Shard & CALIBufferPool::MyShard()
+{
+   btUnsigned64bitInt h = (btUnsigned64bitInt)GetThreadID();
+   h ^= h >> 17;
+   h *= 0x9E3779B97F4A7C15ULL;
+   return m_Shards[(h >> 32) % NumShards];
+}
+
+//
+// Refill. Called with the shard lock held when the shard has no chunk of Class.
+//    Returns one chunk and moves up to RefillBatch - 1 more onto the shard's list.
+//
+CALIBufferPool::FreeChunk * CALIBufferPool::Refill(Shard &shard, btInt Class, btBool *pMiss)
+{
+   AutoLock(this);
+
+   FreeChunk *pChunk = m_Free[Class];
+
+   if ( NULL != pChunk ) {
+      m_Free[Class] = pChunk->m_pNext;
+
+      btInt n;
+      for ( n = 1 ; ( n < RefillBatch ) && ( NULL != m_Free[Class] ) ; ++n ) {
+         FreeChunk *p = m_Free[Class];
+         m_Free[Class] = p->m_pNext;
+         p->m_pNext = shard.m_Free[Class];
+         shard.m_Free[Class] = p;
+         ++shard.m_Count[Class];
+      }
+      return pChunk;
+   }
+
+   if ( m_BumpNext[Class] >= m_BumpEnd[Class] ) {
+      if ( !NewSlab(Class) ) {
+         return NULL;
+      }
+      *pMiss = true;
+      ++m_Misses;
+   }
+
+   // Carve from the current slab of this class.
+   btWSSize chunk = ClassToSize(Class);
+
+   pChunk = reinterpret_cast<FreeChunk *>(m_BumpNext[Class]);
+   m_BumpNext[Class] += chunk;
+
+   btInt n;
+   for ( n = 1 ; ( n < RefillBatch ) && ( m_BumpNext[Class] < m_BumpEnd[Class] ) ; ++n ) {
+      FreeChunk *p = reinterpret_cast<FreeChunk *>(m_BumpNext[Class]);
+      m_BumpNext[Class] += chunk;
+      p->m_Tag   = FreeTag();
+      p->m_pNext = shard.m_Free[Class];
+      shard.m_Free[Class] = p;
+      ++shard.m_Count[Class];
+   }
+
+   return pChunk;
+}
+
+//
+// NewSlab. Called with the pool lock held. Obtain a pinned slab for Class from the backend.
+//
+btBool CALIBufferPool::NewSlab(btInt Class)
+{
+   btWSSize              chunk = ClassToSize(Class);
+   btWSSize              size  = ( chunk > (((btWSSize)1) << SlabShift) ) ? chunk : (((btWSSize)1) << SlabShift);
+   btVirtAddr            ptr   = NULL;
+   struct aalui_WSMParms parms;
+
+   if ( ali_errnumOK != m_pBackend->bufferAllocate(size, &ptr) ) {
+      AAL_ERR(LM_ALI, "Buffer pool could not allocate a slab of " << size << " bytes" << std::endl);
+      return false;
+   }
+
+   memset(&parms, 0, sizeof(parms));
+   parms.wsid     = (btWSID)Class + 1;
+   parms.ptr      = ptr;
+   parms.physptr  = m_pBackend->bufferGetIOVA(ptr);
+   parms.size     = size;
+   parms.itemsize = chunk;
+   m_Slabs.Add(parms);
+
+   m_BumpNext[Class] = ptr;
+   m_BumpEnd[Class]  = ptr + size;
+   m_BytesReserved  += size;
+
+   return true;
+}
+
+/// @}
+
+END_NAMESPACE(AAL)
+
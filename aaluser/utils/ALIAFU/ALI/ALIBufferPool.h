@@ -0,0 +1,128 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file ALIBufferPool.h
+/// @brief Pooled sub-allocator for ALI shared buffers.
+/// @ingroup ALI
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// CALIBufferPool implements IALIBufferPool on top of an IALIBuffer. Pinned
+/// slabs are obtained from IALIBuffer::bufferAllocate() on demand and carved
+/// into power-of-two, cache-line aligned chunks, one size class per slab.
+///
+/// Free chunks are kept on intrusive singly-linked lists stored in the chunks
+/// themselves. Each thread is hashed to one of a small number of shards, each
+/// with its own lock and per-class free lists, so allocations and frees from
+/// different threads rarely contend. A shard whose list for a class grows past
+/// a high-water mark spills further frees to the pool-wide list.@endverbatim
+//****************************************************************************
+#ifndef __ALIBUFFERPOOL_H__
+#define __ALIBUFFERPOOL_H__
+#include <aalsdk/service/IALIAFU.h>
+#include "ALIBufferIndex.h"
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup ALI
+/// @{
+
+class CALIBufferPool : public CriticalSection,
+                       public IALIBufferPool
+{
+public:
+   enum {
+      MinClassShift  = 6,                                 ///< Smallest chunk is one cache line.
+      MaxClassShift  = 21,                                ///< Largest chunk is 2MB.
+      NumClasses     = MaxClassShift - MinClassShift + 1,
+      SlabShift      = 21,                                ///< Slabs are at least 2MB.
+      NumShards      = 8,
+      ShardHighWater = 64,                                ///< Per-shard, per-class free list limit.
+      RefillBatch    = 16                                 ///< Chunks moved from the pool list to a shard at once.
+   };
+
+   CALIBufferPool(IALIBuffer *pBackend);
+   virtual ~CALIBufferPool();
+
+   // <IALIBufferPool>
+   virtual AAL::ali_errnum_e bufferPoolAllocate( btWSSize    Length,
+                                                 btVirtAddr *pBufferptr,
+                                                 btPhysAddr *pIOVA = NULL );
+   virtual AAL::ali_errnum_e bufferPoolFree( btVirtAddr Address );
+   virtual btBool bufferPoolGetStats( INamedValueSet &rResult );
+   // </IALIBufferPool>
+
+   /// Return every slab to the backend. Outstanding chunks become invalid.
+   void Release();
+   /// Whether the pool holds no slab or pass-through buffer of the backend's.
+   btBool IsEmpty() const { return 0 == m_Slabs.Size(); }
+
+protected:
+   struct FreeChunk
+   {
+      FreeChunk          *m_pNext;
+      btUnsigned64bitInt  m_Tag;     ///< FreeTag() while on a free list, cleared when handed out.
+   };
+
+   struct Shard : public CriticalSection
+   {
+      Shard();
+
+      FreeChunk          *m_Free[NumClasses];
+      btUnsignedInt       m_Count[NumClasses];
+      btUnsigned64bitInt  m_Hits;
+      bt64bitInt          m_BytesInUse;     // May go negative when frees land on another shard.
+      btUnsigned64bitInt  m_RoundingWaste;
+   };
+
+   static btInt    SizeToClass(btWSSize Length);
+   static btWSSize ClassToSize(btInt Class) { return ((btWSSize)1) << (Class + MinClassShift); }
+
+   btUnsigned64bitInt FreeTag() const { return (btUnsigned64bitInt)this ^ 0xA11F5EEC0FFEE000ULL; }
+   btBool        IsFree(FreeChunk const *pChunk, btInt Class);
+   Shard &       MyShard();
+   FreeChunk *   Refill(Shard &shard, btInt Class, btBool *pMiss);
+   btBool        NewSlab(btInt Class);
+
+   IALIBuffer         *m_pBackend;
+   CALIBufferIndex     m_Slabs;         // wsid: size class + 1, or 0 for a pass-through buffer. itemsize: chunk size.
+   Shard               m_Shards[NumShards];
+
+   // Protected by the pool lock.
+   FreeChunk          *m_Free[NumClasses];
+   btVirtAddr          m_BumpNext[NumClasses];
+   btVirtAddr          m_BumpEnd[NumClasses];
+   btUnsigned64bitInt  m_Misses;
+   btUnsigned64bitInt  m_BytesReserved;
+   bt64bitInt          m_BytesPassThru;
+};
+
+/// @}
+
+END_NAMESPACE(AAL)
+
+#endif // __ALIBUFFERPOOL_H__
+
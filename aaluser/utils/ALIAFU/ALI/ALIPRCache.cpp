@@ -0,0 +1,377 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file ALIPRCache.cpp
+/// @brief Cache of validated PR images for the reconfigure ALI.
+/// @ingroup ALI
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// See ALIPRCache.h.@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include <aalsdk/AALLoggerExtern.h>
+#include "ALIPRCache.h"
+
+#include <fstream>
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup ALI
+/// @{
+
+CALIPRCache::CALIPRCache() :
+   m_Images(),
+   m_NextHandle(1),
+   m_Hits(0),
+   m_Misses(0)
+{}
+
+CALIPRCache::~CALIPRCache()
+{
+   std::vector<Image *>::iterator iter;
+   for ( iter = m_Images.begin() ; iter != m_Images.end() ; ++iter ) {
+      FreeImage(*iter);
+   }
+}
+
+//
+// IsBitstreamFile. Checks the file extension.
+//
+btBool CALIPRCache::IsBitstreamFile(btcString Filename)
+{
+   std::string name(Filename);
+   std::string::size_type dot = name.find_last_of(".");
+   return ( std::string::npos != dot ) && ( BITSTREAM_FILE_EXTENSION == name.substr(dot) );
+}
+
+//
+// ReadImage. Reads and validates a bitstream file into page-aligned, locked memory.
+//
+CALIPRCache::Image * CALIPRCache::ReadImage(btcString AFUId, btcString Filename)
+{
+   if ( !IsBitstreamFile(Filename) ) {
+      AAL_ERR(LM_ALI, "PR cache: wrong bitstream file extension " << Filename << std::endl);
+      return NULL;
+   }
+
+   std::ifstream bitfile(Filename, std::ios::binary);
+   if ( !bitfile.good() ) {
+      AAL_ERR(LM_ALI, "PR cache: wrong bitstream file path " << Filename << std::endl);
+      return NULL;
+   }
+
+   bitfile.seekg(0, std::ios::end);
+   btWSSize size = (btWSSize)bitfile.tellg();
+   bitfile.seekg(0, std::ios::beg);
+
+   // The driver pushes whole 32-bit words.
+   if ( ( size <= GBS_HEADER_LEN ) || ( 0 != ( ( size - GBS_HEADER_LEN ) & 3 ) ) ) {
+      AAL_ERR(LM_ALI, "PR cache: invalid bitstream size " << size << " in " << Filename << std::endl);
+      return NULL;
+   }
+
+   Image *pImage = new(std::nothrow) Image;
+   if ( NULL == pImage ) {
+      return NULL;
+   }
+
+   pImage->m_AFUId   = AFUId;
+   pImage->m_File    = Filename;
+   pImage->m_Handle  = 0;
+   pImage->m_pData   = NULL;
+   pImage->m_Size    = size;
+   pImage->m_MapSize = size;
+   pImage->m_IfIdL   = 0;
+   pImage->m_IfIdH   = 0;
+   pImage->m_bLocked = false;
+   pImage->m_Refs    = 1;
+
+#if defined( __AAL_LINUX__ )
+   // Anonymous pages, so that pages the driver still holds pinned are never
+   //  handed to another allocation after the image is freed.
+   btWSSize page = (btWSSize)sysconf(_SC_PAGESIZE);
+   pImage->m_MapSize = ( size + page - 1 ) & ~( page - 1 );
+
+   void *p = mmap(NULL, (size_t)pImage->m_MapSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+   if ( MAP_FAILED != p ) {
+      pImage->m_pData = reinterpret_cast<btByte *>(p);
+   }
+#else
+   pImage->m_pData = new(std::nothrow) btByte[size];
+#endif // __AAL_LINUX__
+
+   if ( NULL == pImage->m_pData ) {
+      AAL_ERR(LM_ALI, "PR cache: failed to allocate " << size << " bytes for " << Filename << std::endl);
+      delete pImage;
+      return NULL;
+   }
+
+   bitfile.read(reinterpret_cast<char *>(pImage->m_pData), size);
+
+   if ( ( (std::streamsize)size != bitfile.gcount() ) ||
+        ( GBS_HEADER_MAGIC != *reinterpret_cast<btUnsigned32bitInt *>(pImage->m_pData) ) ) {
+      AAL_ERR(LM_ALI, "PR cache: invalid green bitstream header in " << Filename << std::endl);
+      FreeImage(pImage);
+      return NULL;
+   }
+
+   memcpy(&pImage->m_IfIdL, pImage->m_pData + 4,  sizeof(btUnsigned64bitInt));
+   memcpy(&pImage->m_IfIdH, pImage->m_pData + 12, sizeof(btUnsigned64bitInt));
+
+#if defined( __AAL_LINUX__ )
+   // Best effort. RLIMIT_MEMLOCK is often smaller than a bitstream.
+   pImage->m_bLocked = ( 0 == mlock(pImage->m_pData, (size_t)pImage->m_MapSize) );
+   if ( !pImage->m_bLocked ) {
+      AAL_INFO(LM_ALI, "PR cache: could not lock " << Filename << " in memory" << std::endl);
+   }
+#endif // __AAL_LINUX__
+
+   return pImage;
+}
+
+//
+// FreeImage. Frees an image from ReadImage().
+//
+void CALIPRCache::FreeImage(Image *pImage)
+{
+   if ( NULL != pImage->m_pData ) {
+#if defined( __AAL_LINUX__ )
+      munmap(pImage->m_pData, (size_t)pImage->m_MapSize);
+#else
+      delete[] pImage->m_pData;
+#endif // __AAL_LINUX__
+   }
+   delete pImage;
+}
+
+//
+// Retire. Removes m_Images[i] from the cache. Call with the cache lock held.
+//
+CALIPRCache::Image * CALIPRCache::Retire(std::vector<Image *>::size_type i)
+{
+   Image *pImage = m_Images[i];
+   m_Images.erase(m_Images.begin() + i);
+   return ( 0 == --pImage->m_Refs ) ? pImage : NULL;
+}
+
+/// @brief Read, validate and cache a PR image.
+///
+/// The file is read without the cache lock held, so configures from the
+///    cache are not held up by a load.
+///
+AAL::ali_errnum_e CALIPRCache::prCacheLoad( btcString           AFUId,
+                                            btcString           Filename,
+                                            btUnsigned64bitInt *pHandle )
+{
+   if ( ( NULL == AFUId ) || ( NULL == Filename ) ) {
+      return ali_errnumBadParameter;
+   }
+
+   Image *pImage = ReadImage(AFUId, Filename);
+   if ( NULL == pImage ) {
+      return ali_errnumBadParameter;
+   }
+
+   Image *pOld = NULL;
+   {
+      AutoLock(this);
+
+      std::vector<Image *>::size_type i;
+      for ( i = 0 ; i < m_Images.size() ; ++i ) {
+         if ( m_Images[i]->m_AFUId == AFUId ) {
+            pOld = Retire(i);
+            break;
+         }
+      }
+
+      pImage->m_Handle = m_NextHandle++;
+      m_Images.push_back(pImage);
+
+      if ( NULL != pHandle ) {
+         *pHandle = pImage->m_Handle;
+      }
+   }
+
+   if ( NULL != pOld ) {
+      FreeImage(pOld);
+   }
+
+   AAL_INFO(LM_ALI, "PR cache: " << AFUId << " <- " << Filename << " (" << pImage->m_Size << " bytes, interface "
+                    << std::hex << pImage->m_IfIdH << ':' << pImage->m_IfIdL << std::dec << ')' << std::endl);
+   return ali_errnumOK;
+}
+
+/// @brief Drop the image cached under AFUId.
+///
+AAL::ali_errnum_e CALIPRCache::prCacheEvict( btcString AFUId )
+{
+   if ( NULL == AFUId ) {
+      return ali_errnumBadParameter;
+   }
+
+   Image *pOld = NULL;
+   {
+      AutoLock(this);
+
+      std::vector<Image *>::size_type i;
+      for ( i = 0 ; i < m_Images.size() ; ++i ) {
+         if ( m_Images[i]->m_AFUId == AFUId ) {
+            break;
+         }
+      }
+      if ( i == m_Images.size() ) {
+         return ali_errnumBadParameter;
+      }
+      pOld = Retire(i);
+   }
+
+   if ( NULL != pOld ) {
+      FreeImage(pOld);
+   }
+   return ali_errnumOK;
+}
+
+/// @brief Obtain the cache statistics.
+///
+btBool CALIPRCache::prCacheGetStats( INamedValueSet &rResult )
+{
+   ALI_PRCACHE_STAT_DATATYPE bytes  = 0;
+   ALI_PRCACHE_STAT_DATATYPE locked = 0;
+   ALI_PRCACHE_STAT_DATATYPE hits;
+   ALI_PRCACHE_STAT_DATATYPE misses;
+   ALI_PRCACHE_STAT_DATATYPE images;
+
+   {
+      AutoLock(this);
+
+      std::vector<Image *>::const_iterator iter;
+      for ( iter = m_Images.begin() ; iter != m_Images.end() ; ++iter ) {
+         bytes += (*iter)->m_Size;
+         if ( (*iter)->m_bLocked ) {
+            locked += (*iter)->m_Size;
+         }
+      }
+      hits   = m_Hits;
+      misses = m_Misses;
+      images = m_Images.size();
+   }
+
+   rResult.Add(ALI_PRCACHE_STAT_HITS,         hits);
+   rResult.Add(ALI_PRCACHE_STAT_MISSES,       misses);
+   rResult.Add(ALI_PRCACHE_STAT_IMAGES,       images);
+   rResult.Add(ALI_PRCACHE_STAT_BYTES,        bytes);
+   rResult.Add(ALI_PRCACHE_STAT_BYTES_LOCKED, locked);
+   return true;
+}
+
+//
+// LoadAll. Loads the AFU ID / file pairs of rImages, e.g. from ALIAFU_NVS_KEY_PRCACHE_IMAGES.
+//
+btUnsignedInt CALIPRCache::LoadAll(INamedValueSet const &rImages)
+{
+   btUnsignedInt num    = 0;
+   btUnsignedInt loaded = 0;
+   btUnsignedInt i;
+
+   rImages.GetNumNames(&num);
+   for ( i = 0 ; i < num ; ++i ) {
+      btStringKey afuid    = NULL;
+      btcString   filename = NULL;
+      eBasicTypes type;
+
+      if ( ( ENamedValuesOK != rImages.GetName(i, &afuid) ) ||
+           ( ENamedValuesOK != rImages.Type(afuid, &type) ) ||
+           ( btString_t != type ) ) {
+         AAL_ERR(LM_ALI, "PR cache: image " << i << " is not an AFU ID / file pair" << std::endl);
+         continue;
+      }
+      rImages.Get(afuid, &filename);
+
+      if ( ali_errnumOK == prCacheLoad(afuid, filename) ) {
+         ++loaded;
+      }
+   }
+   return loaded;
+}
+
+//
+// Acquire. Finds an image for reconfConfigure(). Does not allocate.
+//
+CALIPRCache::Image const * CALIPRCache::Acquire(btcString AFUId, btUnsigned64bitInt Handle, btcString Filename)
+{
+   AutoLock(this);
+
+   Image *pImage = NULL;
+   std::vector<Image *>::iterator iter;
+
+   for ( iter = m_Images.begin() ; ( NULL == pImage ) && ( iter != m_Images.end() ) ; ++iter ) {
+      if ( NULL != AFUId ) {
+         if ( (*iter)->m_AFUId == AFUId ) {
+            pImage = *iter;
+         }
+      } else if ( 0 != Handle ) {
+         if ( (*iter)->m_Handle == Handle ) {
+            pImage = *iter;
+         }
+      } else if ( ( NULL != Filename ) && ( (*iter)->m_File == Filename ) ) {
+         pImage = *iter;
+      }
+   }
+
+   if ( NULL == pImage ) {
+      ++m_Misses;
+      return NULL;
+   }
+
+   ++m_Hits;
+   ++pImage->m_Refs;
+   return pImage;
+}
+
+//
+// Release. Releases an image from Acquire(), freeing it if it has been retired.
+//
+void CALIPRCache::Release(Image const *pImage)
+{
+   Image *p = const_cast<Image *>(pImage);
+   {
+      AutoLock(this);
+      if ( 0 != --p->m_Refs ) {
+         return;
+      }
+   }
+   FreeImage(p);
+}
+
+/// @}
+
+END_NAMESPACE(AAL)
+
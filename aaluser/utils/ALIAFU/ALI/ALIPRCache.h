@@ -0,0 +1,125 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file ALIPRCache.h
+/// @brief Cache of validated PR images for the reconfigure ALI.
+/// @ingroup ALI
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// CALIPRCache implements IALIPRCache. Each image is read from its green
+/// bitstream file and validated once, then kept in page-aligned memory that is
+/// locked with mlock() where the limits allow it. CHWALIReconf looks images up
+/// by AFU ID, handle or file and pushes them in stream mode, so the driver pins
+/// the cached pages instead of copying them.
+///
+/// Images are reference counted. A replaced or evicted image is freed when the
+/// last configure pushing it releases it.@endverbatim
+//****************************************************************************
+#ifndef __ALIPRCACHE_H__
+#define __ALIPRCACHE_H__
+#include <aalsdk/service/IALIAFU.h>
+
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup ALI
+/// @{
+
+// Bitstream File extension
+#define BITSTREAM_FILE_EXTENSION ".gbs"
+
+// FIXME: Placeholder for proper metadata handling (Alpha+)
+#define GBS_HEADER_MAGIC 0x1d1f8680
+#define GBS_HEADER_LEN   20
+
+class CALIPRCache : public CriticalSection,
+                    public IALIPRCache
+{
+public:
+   /// A cached, validated PR image.
+   struct Image
+   {
+      std::string         m_AFUId;
+      std::string         m_File;
+      btUnsigned64bitInt  m_Handle;
+      btByte             *m_pData;     ///< Whole file, GBS header included.
+      btWSSize            m_Size;
+      btWSSize            m_MapSize;   ///< m_Size rounded up to pages.
+      btUnsigned64bitInt  m_IfIdL;     ///< PR interface ID from the GBS header.
+      btUnsigned64bitInt  m_IfIdH;
+      btBool              m_bLocked;
+      btUnsignedInt       m_Refs;      ///< The cache's own reference plus one per Acquire().
+
+      btByte *   Bitstream() const { return m_pData + GBS_HEADER_LEN; }
+      btWSSize BitstreamLen() const { return m_Size - GBS_HEADER_LEN; }
+   };
+
+   CALIPRCache();
+   virtual ~CALIPRCache();
+
+   // <IALIPRCache>
+   virtual AAL::ali_errnum_e prCacheLoad( btcString           AFUId,
+                                          btcString           Filename,
+                                          btUnsigned64bitInt *pHandle = NULL );
+   virtual AAL::ali_errnum_e prCacheEvict( btcString AFUId );
+   virtual btBool prCacheGetStats( INamedValueSet &rResult );
+   // </IALIPRCache>
+
+   /// Load each AFU ID / file pair of rImages. Returns the number loaded.
+   btUnsignedInt LoadAll(INamedValueSet const &rImages);
+
+   /// Find an image by AFU ID, else by handle, else by file, and count a hit or a miss.
+   /// NULL and 0 select nothing. A non-NULL result must be passed to Release().
+   Image const * Acquire(btcString AFUId, btUnsigned64bitInt Handle, btcString Filename);
+   void          Release(Image const *pImage);
+
+   /// Check that Filename names a green bitstream file.
+   static btBool IsBitstreamFile(btcString Filename);
+
+protected:
+   static Image * ReadImage(btcString AFUId, btcString Filename);
+   static void     FreeImage(Image *pImage);
+
+   // Drop the cache's reference to m_Images[i]. Returns the image if it is now unreferenced.
+   Image * Retire(std::vector<Image *>::size_type i);
+
+   // Protected by the cache lock.
+   std::vector<Image *>  m_Images;
+   btUnsigned64bitInt    m_NextHandle;
+   btUnsigned64bitInt    m_Hits;
+   btUnsigned64bitInt    m_Misses;
+};
+
+/// @}
+
+END_NAMESPACE(AAL)
+
+#endif // __ALIPRCACHE_H__
+
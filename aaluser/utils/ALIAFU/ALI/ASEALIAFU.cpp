@@ -70,11 +70,12 @@ CASEALIAFU::CASEALIAFU( IBase *pSvcClient,
                         IServiceBase *pServiceBase,
                         TransactionID transID):
                         CALIBase(pSvcClient,pServiceBase,transID),
-                        m_mapWkSpc(),
                         m_MMIORmap(NULL),
                         m_MMIORsize(0),
                         m_Last3c4(0xffffffff),
-                        m_Last3cc(0xffffffff)
+                        m_Last3cc(0xffffffff),
+                        m_WkSpcIndex(),
+                        m_BufferPool(this)
 {
 
 }
@@ -84,6 +85,14 @@ CASEALIAFU::CASEALIAFU( IBase *pSvcClient,
 //
 btBool CASEALIAFU::ASERelease()
 {
+   // The slabs go back to the simulator through deallocate_buffer(), which needs
+   //  the session that session_deinit() tears down.
+   m_BufferPool.Release();
+   if ( !m_BufferPool.IsEmpty() ) {
+      AAL_ERR(LM_ALI, "Buffer pool not empty at ASE session teardown" << std::endl);
+   }
+   ASSERT(m_BufferPool.IsEmpty());
+
    session_deinit();
    return true;
 }
@@ -339,6 +348,62 @@ btBool CASEALIAFU::mmioWrite64(const btCSROffset Offset, const btUnsigned64bitIn
   return true;
 }
 
+//
+// mmioWriteBatch. Validate a batch of CSR writes, then send them to the simulator
+//                 MMIO_MAX_BATCH at a time.
+//
+btBool CASEALIAFU::mmioWriteBatch(ali_mmio_access_t const *pAccesses, btUnsignedInt Count)
+{
+   if ( (NULL == m_MMIORmap) || !mmioBatchIsValid(pAccesses, Count, m_MMIORsize) ) {
+      return false;
+   }
+
+   struct mmio_access_t chunk[MMIO_MAX_BATCH];
+   btUnsignedInt        i = 0;
+
+   while ( i < Count ) {
+      btUnsignedInt n = 0;
+      for ( ; ( n < MMIO_MAX_BATCH ) && ( i < Count ) ; ++n, ++i ) {
+         chunk[n].offset = (int)pAccesses[i].offset;
+         chunk[n].width  = (int)pAccesses[i].width;
+         chunk[n].data   = pAccesses[i].value;
+      }
+      mmio_request_batch(MMIO_WRITE_REQ, chunk, (int)n);
+   }
+
+   return true;
+}
+
+//
+// mmioReadBatch. Validate a batch of CSR reads, then send them to the simulator
+//                MMIO_MAX_BATCH at a time.
+//
+btBool CASEALIAFU::mmioReadBatch(ali_mmio_access_t *pAccesses, btUnsignedInt Count)
+{
+   if ( (NULL == m_MMIORmap) || !mmioBatchIsValid(pAccesses, Count, m_MMIORsize) ) {
+      return false;
+   }
+
+   struct mmio_access_t chunk[MMIO_MAX_BATCH];
+   btUnsignedInt        i = 0;
+
+   while ( i < Count ) {
+      btUnsignedInt first = i;
+      btUnsignedInt n     = 0;
+      for ( ; ( n < MMIO_MAX_BATCH ) && ( i < Count ) ; ++n, ++i ) {
+         chunk[n].offset = (int)pAccesses[i].offset;
+         chunk[n].width  = (int)pAccesses[i].width;
+         chunk[n].data   = 0;
+      }
+      mmio_request_batch(MMIO_READ_REQ, chunk, (int)n);
+      for ( n = 0 ; first + n < i ; ++n ) {
+         pAccesses[first + n].value = chunk[n].data;
+      }
+   }
+
+   return true;
+}
+
 //
 // mmioGetFeature. Get pointer to feature's DFH, if found.
 //
@@ -521,7 +586,12 @@ AAL::ali_errnum_e CASEALIAFU::bufferAllocate( btWSSize             Length,
   wsParms.physptr = buf->fake_paddr;
   wsParms.size = buf->memsize;
 
-  m_mapWkSpc[(btVirtAddr)buf->vbase] = wsParms;
+  if ( !m_WkSpcIndex.Add(wsParms) ) {
+     AAL_ERR(LM_ALI, "Buffer already recorded at " << (void *)wsParms.ptr << std::endl);
+     deallocate_buffer_by_index((int)wsParms.wsid);
+     *pBufferptr = NULL;
+     return ali_errnumSystem;
+  }
 
   return ali_errnumOK;
 }
@@ -529,15 +599,12 @@ AAL::ali_errnum_e CASEALIAFU::bufferAllocate( btWSSize             Length,
 
 AAL::ali_errnum_e CASEALIAFU::bufferFree( btVirtAddr Address)
 {
-  // Find in map and remove
-   mapWkSpc_t::iterator i = m_mapWkSpc.find(Address);
-   if (i == m_mapWkSpc.end()) {  // not found
-      AAL_ERR(LM_ALI, "Tried to free non-existent Buffer");
-      return ali_errnumBadParameter;
-   }
-
+  // Find in index and remove
   struct aalui_WSMParms wsParms;
-  wsParms = i->second;
+  if ( !m_WkSpcIndex.Remove(Address, &wsParms) ) {  // not found
+     AAL_ERR(LM_ALI, "Tried to free non-existent Buffer");
+     return ali_errnumBadParameter;
+  }
 
   // Call ase_common:deallocate_buffer_by_index
   deallocate_buffer_by_index((int)wsParms.wsid);
@@ -549,20 +616,7 @@ AAL::ali_errnum_e CASEALIAFU::bufferFree( btVirtAddr Address)
 // Exactly the same as HWALIAFU::bufferGetIOVA
 btPhysAddr CASEALIAFU::bufferGetIOVA( btVirtAddr Address)
 {
-   mapWkSpc_t::iterator i = m_mapWkSpc.find(Address);
-   if (i != m_mapWkSpc.end()) {
-      return i->second.physptr;
-   }
-
-   for (mapWkSpc_t::iterator i = m_mapWkSpc.begin(); i != m_mapWkSpc.end(); i++)
-     {
-       if (Address < i->second.ptr + i->second.size) {
-         return i->second.physptr + (Address - i->second.ptr);
-       }
-     }
-
-   // not found
-   return 0;
+   return m_WkSpcIndex.GetIOVA(Address);
 }
 
 
@@ -46,6 +46,8 @@
 #define __ASEALIAFU1000_H__
 
 #include "ALIBase.h"
+#include "ALIBufferIndex.h"
+#include "ALIBufferPool.h"
 #include "aalsdk/kernel/ccip_defs.h"
 //#include <aalsdk/ase/ase_common.h>
 
@@ -82,6 +84,7 @@ BEGIN_NAMESPACE(AAL)
 class  CASEALIAFU : public CALIBase,
                     public IALIMMIO,
                     public IALIBuffer,
+                    public IALIBufferPool,
                     public IALIUMsg,
                     public IALIReset
 {
@@ -92,19 +95,23 @@ public :
                TransactionID transID);
 
 
-   ~CASEALIAFU()  { };
+   // ASERelease() has already drained the pool; this only catches a CASEALIAFU that was never released.
+   ~CASEALIAFU()  { m_BufferPool.Release(); }
 
    btBool ASEInit();
    btBool ASERelease();
 
    // <IALIMMIO>
    virtual btVirtAddr   mmioGetAddress( void );
+   virtual btBool       mmioIsDirect( void ) { return false; }
    virtual btCSROffset  mmioGetLength( void );
 
    virtual btBool  mmioRead32( const btCSROffset Offset,       btUnsigned32bitInt * const pValue);
    virtual btBool  mmioWrite32( const btCSROffset Offset, const btUnsigned32bitInt Value);
    virtual btBool  mmioRead64( const btCSROffset Offset,       btUnsigned64bitInt * const pValue);
    virtual btBool  mmioWrite64( const btCSROffset Offset, const btUnsigned64bitInt Value);
+   virtual btBool  mmioWriteBatch( ali_mmio_access_t const *pAccesses, btUnsignedInt Count );
+   virtual btBool  mmioReadBatch( ali_mmio_access_t *pAccesses, btUnsignedInt Count );
    virtual btBool  mmioGetFeatureAddress( btVirtAddr          *pFeatureAddress,
                                           NamedValueSet const &rInputArgs,
                                           NamedValueSet       &rOutputArgs );
@@ -137,6 +144,14 @@ public :
    virtual btPhysAddr bufferGetIOVA( btVirtAddr Address);
    // </IALIBuffer>
 
+   // <IALIBufferPool>
+   virtual AAL::ali_errnum_e bufferPoolAllocate( btWSSize    Length,
+                                                 btVirtAddr *pBufferptr,
+                                                 btPhysAddr *pIOVA = NULL ) { return m_BufferPool.bufferPoolAllocate(Length, pBufferptr, pIOVA); }
+   virtual AAL::ali_errnum_e bufferPoolFree( btVirtAddr Address )           { return m_BufferPool.bufferPoolFree(Address);                     }
+   virtual btBool bufferPoolGetStats( INamedValueSet &rResult )             { return m_BufferPool.bufferPoolGetStats(rResult);                 }
+   // </IALIBufferPool>
+
    // <IALIUMsg>
    virtual btUnsignedInt umsgGetNumber( void );
    virtual btVirtAddr   umsgGetAddress( const btUnsignedInt UMsgNumber );
@@ -168,9 +183,9 @@ protected:
    btCSRValue             m_Last3cc;
    map_t                  m_WkspcMap;
 
-   // Map to store workspace parameters
-   typedef std::map<btVirtAddr, struct aalui_WSMParms> mapWkSpc_t;
-   mapWkSpc_t m_mapWkSpc;
+   // Index of workspace parameters, sorted by virtual address
+   CALIBufferIndex        m_WkSpcIndex;
+   CALIBufferPool         m_BufferPool;
 
    // List to cache device feature metadata
    typedef struct {
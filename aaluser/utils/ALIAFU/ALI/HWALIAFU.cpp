@@ -66,7 +66,8 @@ CHWALIAFU::CHWALIAFU( IBase *pSvcClient,
                       TransactionID transID,
                       IAFUProxy *pAFUProxy): CHWALIBase(pSvcClient,pServiceBase,transID,pAFUProxy),
                       m_uMSGmap(NULL),
-                      m_uMSGsize(0)
+                      m_uMSGsize(0),
+                      m_BufferPool(this)
 {
 
 }
@@ -110,8 +111,16 @@ AAL::ali_errnum_e CHWALIAFU::bufferAllocate( btWSSize             Length,
       AAL_ERR( LM_ALI, "FATAL: MapWSID failed"<< std::endl);
       return ali_errnumSystem;
    }
-   // store entire aalui_WSParms struct in map
-   m_mapWkSpc[wsevt.wsParms.ptr] = wsevt.wsParms;
+   // store entire aalui_WSParms struct in index
+   if ( !m_WkSpcIndex.Add(wsevt.wsParms) ) {
+      AAL_ERR( LM_ALI, "FATAL: Buffer already recorded at " << (void *)wsevt.wsParms.ptr << std::endl);
+      m_pAFUProxy->UnMapWSID(wsevt.wsParms.ptr, wsevt.wsParms.size);
+      BufferFreeTransaction freeTransaction(wsevt.wsParms.wsid);
+      if ( freeTransaction.IsOK() ) {
+         m_pAFUProxy->SendTransaction(&freeTransaction);
+      }
+      return ali_errnumSystem;
+   }
 
    *pBufferptr = wsevt.wsParms.ptr;
    return ali_errnumOK;
@@ -128,29 +137,30 @@ AAL::ali_errnum_e CHWALIAFU::bufferFree( btVirtAddr           Address)
 //    TransactionID tid(new(std::nothrow) TransactionID(TranID));
 
    // Find workspace id
-   mapWkSpc_t::iterator i = m_mapWkSpc.find(Address);
-   if (i == m_mapWkSpc.end()) {  // not found
+   struct aalui_WSMParms wsParms;
+   if ( !m_WkSpcIndex.Find(Address, &wsParms) ) {  // not found
       AAL_ERR(LM_ALI, "Tried to free non-existent Buffer"<< std::endl);
       return ali_errnumBadParameter;
    }
-   // workspace id is in i->second.wsid
+   // workspace id is in wsParms.wsid
 
    // Create the Transaction
-   BufferFreeTransaction transaction(i->second.wsid);
+   BufferFreeTransaction transaction(wsParms.wsid);
 
    // Check the parameters
    if ( transaction.IsOK() ) {
 
+      // Forget workspace parameters before the mapping goes away, so that a
+      //  concurrent bufferGetIOVA() can no longer translate into it.
+      m_WkSpcIndex.Remove(Address);
+
       // Unmap buffer
-      m_pAFUProxy->UnMapWSID(i->second.ptr, i->second.size);
+      m_pAFUProxy->UnMapWSID(wsParms.ptr, wsParms.size);
 
       // Send transaction
       // Will eventually trigger AFUEvent(), below.
       m_pAFUProxy->SendTransaction(&transaction);
 
-      // Forget workspace parameters
-      m_mapWkSpc.erase(i);
-
    } else {
       return ali_errnumSystem;
    }
@@ -160,27 +170,12 @@ AAL::ali_errnum_e CHWALIAFU::bufferFree( btVirtAddr           Address)
 //
 // bufferGetIOVA. Retrieve IO Virtual Address for a virtual address.
 //
+// Lock-free, O(log n) in the number of workspaces. Returns 0 if not found.
+//
 btPhysAddr CHWALIAFU::bufferGetIOVA( btVirtAddr Address)
 {
    // TODO Return actual IOVA instead of physptr
-
-   // try to find exact match
-   mapWkSpc_t::iterator i = m_mapWkSpc.find(Address);
-   if (i != m_mapWkSpc.end()) {
-      return i->second.physptr;
-   }
-
-   // look through all workspaces to see if Address is in one of them
-   // TODO: there might be a more efficient way
-   // TODO: this loop works only if map keeps keys in increasing order -- does it?
-   for (mapWkSpc_t::iterator i = m_mapWkSpc.begin(); i != m_mapWkSpc.end(); i++ ) {
-      if (Address < i->second.ptr + i->second.size) {
-         return i->second.physptr + (Address - i->second.ptr);
-      }
-   }
-
-   // not found
-   return 0;
+   return m_WkSpcIndex.GetIOVA(Address);
 }
 
 // ---------------------------------------------------------------------------
@@ -218,14 +213,15 @@ btVirtAddr CHWALIAFU::umsgGetAddress( const btUnsignedInt UMsgNumber )
          AAL_ERR( LM_ALI,"FATAL: MapWSID failed"<< std::endl);
          return NULL;
       }
-      else
-      {
-        m_uMSGsize = wsevt.wsParms.size;
-        m_uMSGmap = wsevt.wsParms.ptr;
-        // store entire aalui_WSParms struct in map
-        // to enable bufferGetIOVA()
-        m_mapWkSpc[wsevt.wsParms.ptr] = wsevt.wsParms;
+      // store entire aalui_WSParms struct in index
+      // to enable bufferGetIOVA()
+      if ( !m_WkSpcIndex.Add(wsevt.wsParms) ) {
+         AAL_ERR( LM_ALI,"FATAL: UMsg area already recorded at " << (void *)wsevt.wsParms.ptr << std::endl);
+         m_pAFUProxy->UnMapWSID(wsevt.wsParms.ptr, wsevt.wsParms.size);
+         return NULL;
       }
+      m_uMSGsize = wsevt.wsParms.size;
+      m_uMSGmap = wsevt.wsParms.ptr;
    }
    // Umsgs are separated by 1 Page + 1 CL
    // Malicious call could overflow and cause wrap to invalid address.
@@ -46,6 +46,7 @@
 
 #include <aalsdk/service/IALIAFU.h>
 #include "HWALIBase.h"
+#include "ALIBufferPool.h"
 
 
 BEGIN_NAMESPACE(AAL)
@@ -60,6 +61,7 @@ BEGIN_NAMESPACE(AAL)
 
 class  CHWALIAFU : public CHWALIBase,
                    public IALIBuffer,
+                   public IALIBufferPool,
                    public IALIUMsg,
                    public IALIReset
 
@@ -72,7 +74,7 @@ public :
               TransactionID transID,
               IAFUProxy *pAFUProxy);
 
-   ~CHWALIAFU()  { };
+   ~CHWALIAFU()  { m_BufferPool.Release(); }
 
    // <IALIBuffer>
    virtual AAL::ali_errnum_e bufferAllocate( btWSSize             Length,
@@ -93,6 +95,14 @@ public :
    virtual btPhysAddr bufferGetIOVA( btVirtAddr Address);
    // </IALIBuffer>
 
+   // <IALIBufferPool>
+   virtual AAL::ali_errnum_e bufferPoolAllocate( btWSSize    Length,
+                                                 btVirtAddr *pBufferptr,
+                                                 btPhysAddr *pIOVA = NULL ) { return m_BufferPool.bufferPoolAllocate(Length, pBufferptr, pIOVA); }
+   virtual AAL::ali_errnum_e bufferPoolFree( btVirtAddr Address )           { return m_BufferPool.bufferPoolFree(Address);                     }
+   virtual btBool bufferPoolGetStats( INamedValueSet &rResult )             { return m_BufferPool.bufferPoolGetStats(rResult);                 }
+   // </IALIBufferPool>
+
    // <IALIUMsg>
    virtual btUnsignedInt umsgGetNumber( void );
    virtual btVirtAddr   umsgGetAddress( const btUnsignedInt UMsgNumber );
@@ -117,6 +127,7 @@ private:
 
    btVirtAddr              m_uMSGmap;
    btUnsigned32bitInt      m_uMSGsize;
+   CALIBufferPool          m_BufferPool;
 
 };
 
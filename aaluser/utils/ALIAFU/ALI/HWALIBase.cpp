@@ -67,9 +67,9 @@ CHWALIBase::CHWALIBase( IBase *pSvcClient,
                         IAFUProxy *pAFUProxy):
                         CALIBase(pSvcClient,pServiceBase,transID),
                         m_pAFUProxy(pAFUProxy),
-                        m_mapWkSpc(),
                         m_MMIORmap(NULL),
-                        m_MMIORsize(0)
+                        m_MMIORsize(0),
+                        m_WkSpcIndex()
 
 {
 
@@ -161,6 +161,49 @@ btBool CHWALIBase::mmioWrite64(const btCSROffset Offset, const btUnsigned64bitIn
    return true;
 }
 
+//
+// mmioWriteBatch. Validate a batch of CSR writes, then perform them in order.
+//
+btBool CHWALIBase::mmioWriteBatch(ali_mmio_access_t const *pAccesses, btUnsignedInt Count)
+{
+   if ( (NULL == m_MMIORmap) || !mmioBatchIsValid(pAccesses, Count, m_MMIORsize) ) {
+      return false;
+   }
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < Count ; ++i ) {
+      if ( ali_mmio_width64 == pAccesses[i].width ) {
+         *( reinterpret_cast<volatile btUnsigned64bitInt *>(m_MMIORmap + pAccesses[i].offset) ) = pAccesses[i].value;
+      } else {
+         *( reinterpret_cast<volatile btUnsigned32bitInt *>(m_MMIORmap + pAccesses[i].offset) ) =
+            static_cast<btUnsigned32bitInt>(pAccesses[i].value);
+      }
+   }
+
+   return true;
+}
+
+//
+// mmioReadBatch. Validate a batch of CSR reads, then perform them in order.
+//
+btBool CHWALIBase::mmioReadBatch(ali_mmio_access_t *pAccesses, btUnsignedInt Count)
+{
+   if ( (NULL == m_MMIORmap) || !mmioBatchIsValid(pAccesses, Count, m_MMIORsize) ) {
+      return false;
+   }
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < Count ; ++i ) {
+      if ( ali_mmio_width64 == pAccesses[i].width ) {
+         pAccesses[i].value = *( reinterpret_cast<volatile btUnsigned64bitInt *>(m_MMIORmap + pAccesses[i].offset) );
+      } else {
+         pAccesses[i].value = *( reinterpret_cast<volatile btUnsigned32bitInt *>(m_MMIORmap + pAccesses[i].offset) );
+      }
+   }
+
+   return true;
+}
+
 
 //
 // mmioGetFeature. Get pointer to feature's DFH, if found.
@@ -327,7 +370,7 @@ btBool CHWALIBase:: mapMMIO()
          }
 
          // Remember workspace parameters associated with virtual ptr (if we ever need it)
-         if (m_mapWkSpc.find(wsevt.wsParms.ptr) != m_mapWkSpc.end()) {
+         if ( !m_WkSpcIndex.Add(wsevt.wsParms) ) {
             AAL_ERR( LM_ALI, "FATAL: WSID already exists in m_mapWSID"<< std::endl);
             m_pServiceBase->initFailed(new CExceptionTransactionEvent( NULL,
                                                                        m_tidSaved,
@@ -335,9 +378,6 @@ btBool CHWALIBase:: mapMMIO()
                                                                        reasUnknown,
                                                                        "Error: Duplicate WSID."));
             return false;
-         } else {
-            // store entire aalui_WSParms struct in map
-            m_mapWkSpc[wsevt.wsParms.ptr] = wsevt.wsParms;
          }
 
          m_MMIORmap = wsevt.wsParms.ptr;
@@ -45,6 +45,7 @@
 #define __HWALIBASE_H__
 
 #include "ALIBase.h"
+#include "ALIBufferIndex.h"
 #include "aalsdk/kernel/ccip_defs.h"
 
 class IAFUProxy;
@@ -73,12 +74,15 @@ public :
 
    // <IALIMMIO>
    virtual btVirtAddr   mmioGetAddress( void );
+   virtual btBool       mmioIsDirect( void ) { return true; }
    virtual btCSROffset  mmioGetLength( void );
 
    virtual btBool  mmioRead32( const btCSROffset Offset,       btUnsigned32bitInt * const pValue);
    virtual btBool  mmioWrite32( const btCSROffset Offset, const btUnsigned32bitInt Value);
    virtual btBool  mmioRead64( const btCSROffset Offset,       btUnsigned64bitInt * const pValue);
    virtual btBool  mmioWrite64( const btCSROffset Offset, const btUnsigned64bitInt Value);
+   virtual btBool  mmioWriteBatch( ali_mmio_access_t const *pAccesses, btUnsignedInt Count );
+   virtual btBool  mmioReadBatch( ali_mmio_access_t *pAccesses, btUnsignedInt Count );
    virtual btBool  mmioGetFeatureAddress( btVirtAddr          *pFeatureAddress,
                                           NamedValueSet const &rInputArgs,
                                           NamedValueSet       &rOutputArgs );
@@ -105,9 +109,8 @@ protected:
    btVirtAddr              m_MMIORmap;
    btUnsigned32bitInt      m_MMIORsize;
 
-   // Map to store workspace parameters
-   typedef std::map<btVirtAddr, struct aalui_WSMParms> mapWkSpc_t;
-   mapWkSpc_t m_mapWkSpc;
+   // Index of workspace parameters, sorted by virtual address
+   CALIBufferIndex         m_WkSpcIndex;
 
    // List to cache device feature metadata
    typedef struct {
@@ -51,6 +51,7 @@
 #include <aalsdk/utils/ResMgrUtilities.h>
 #include "ALIAIATransactions.h"
 #include "aalsdk/aas/Dispatchables.h"
+#include "aalsdk/osal/Timer.h"
 #include "HWALIReconf.h"
 
 BEGIN_NAMESPACE(AAL)
@@ -58,13 +59,6 @@ BEGIN_NAMESPACE(AAL)
 /// @addtogroup ALI
 /// @{
 
-// Bitstream File extension
-#define BITSTREAM_FILE_EXTENSION ".gbs"
-
-// FIXME: Placeholder for proper metadata handling (Alpha+)
-#define GBS_HEADER_MAGIC 0x1d1f8680
-#define GBS_HEADER_LEN   20
-
 //
 // ctor. CHWALIFME class constructor
 //
@@ -72,9 +66,11 @@ CHWALIReconf::CHWALIReconf( IBase *pSvcClient,
                             IServiceBase *pServiceBase,
                             TransactionID transID,
                             IAFUProxy *pAFUProxy): CHWALIBase(pSvcClient,pServiceBase,transID,pAFUProxy),
-                            m_pReconClient(NULL)
+                            m_pReconClient(NULL),
+                            m_LoadNs(0),
+                            m_bTimings(false)
 {
-
+   memset(&m_Timings, 0, sizeof(m_Timings));
 }
 
 //
@@ -133,7 +129,7 @@ void CHWALIReconf::reconfDeactivate( TransactionID const &rTranID,
      }
 
    // Send transaction
-   m_pAFUProxy->SendTransaction(&deactivatetrans);
+   m_pAFUProxy->SendPolledTransaction(&deactivatetrans);
    if(deactivatetrans.getErrno() != uid_errnumOK){
       AAL_ERR( LM_ALI,"Deactivate failed"<< std::endl);
 
@@ -154,6 +150,14 @@ void CHWALIReconf::reconfDeactivate( TransactionID const &rTranID,
 ///    parameter is an NVS. It is also possible in the NVS to specify a PR number
 ///    if that is relevant, e.g. for the PF driver.
 ///
+/// With AALCONF_STREAM_BITSTREAM the file is mapped instead of read, and the
+///    driver pushes from the pinned mapping instead of its own copy.
+///
+/// AALCONF_AFUIDKEY or AALCONF_CACHE_HANDLE select an image from m_PRCache,
+///    as does an AALCONF_FILENAMEKEY naming a cached file. A cached image is
+///    always streamed. An AFU ID or handle that misses falls back to
+///    AALCONF_FILENAMEKEY if given.
+///
 /// TODO: Implementation needs to be via driver transaction
 ///
 /// @param[in]  pNVS Pointer to Optional Arguments. Initially need a bitstream.
@@ -162,16 +166,51 @@ void CHWALIReconf::reconfDeactivate( TransactionID const &rTranID,
 void CHWALIReconf::reconfConfigure( TransactionID const &rTranID,
                                 NamedValueSet const &rInputArgs)
 {
-   btByte *bufptr                = NULL;
+   btByte *bufptr                = NULL;   // Bitstream read into a buffer
+   btByte *mapptr                = NULL;   // Bitstream file mapping, when streaming
    std::streampos filesize       = 0;
+   btByte *bufptr_skip           = NULL;   // Bitstream without its GBS header
+   btWSSize filesize_skip        = 0;
+   Timer loadStart;
 
+   btcString afuid               = NULL;
+   btUnsigned64bitInt handle     = 0;
+   btcString filename            = NULL;
+
+   if(rInputArgs.Has(AALCONF_AFUIDKEY)){
+      rInputArgs.Get(AALCONF_AFUIDKEY, &afuid);
+   }
+   if(rInputArgs.Has(AALCONF_CACHE_HANDLE)){
+      rInputArgs.Get(AALCONF_CACHE_HANDLE, &handle);
+   }
    if(rInputArgs.Has(AALCONF_FILENAMEKEY)){
-      btcString filename;
       rInputArgs.Get(AALCONF_FILENAMEKEY, &filename);
+   }
+
+   CALIPRCache::Image const *pImage = m_PRCache.Acquire(afuid, handle, filename);
+
+   if(NULL != pImage){
+      // Validated when cached.
+      bufptr_skip   = pImage->Bitstream();
+      filesize_skip = pImage->BitstreamLen();
+
+   }else if((NULL != afuid || 0 != handle) && (NULL == filename)){
+      AAL_ERR( LM_ALI,"PR image not cached"<< std::endl);
+      getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
+                                                                                                               rTranID,
+                                                                                                               errBadParameter,
+                                                                                                               reasParameterValueInvalid,
+                                                                                                               "Error: PR image not cached.")));
+      return;
+
+   }else if(NULL != filename){
+      btBool bStream = false;
+      if(rInputArgs.Has(AALCONF_STREAM_BITSTREAM)){
+         rInputArgs.Get(AALCONF_STREAM_BITSTREAM, &bStream);
+      }
 
       // File extension is not .gbs , Dispatch error Message "Wrong bitstream file extension"
-      std::string bitfilename(filename);
-      if(BITSTREAM_FILE_EXTENSION != (bitfilename.substr(bitfilename.find_last_of("."))))  {
+      if(!CALIPRCache::IsBitstreamFile(filename))  {
          // file extension invalid
          AAL_ERR( LM_ALI, "Wrong bitstream file extension "<< std::endl);
          getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
@@ -183,52 +222,109 @@ void CHWALIReconf::reconfConfigure( TransactionID const &rTranID,
          return ;
       }
 
-      std::ifstream bitfile(filename, std::ios::binary );
-
-      if(!bitfile.good()) {
-         // file is invalid, Dispatch error Message "Wrong bitstream file path"
-         AAL_ERR( LM_ALI, "Wrong bitstream file path " << std::endl);
-         getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
-                                                                                                                  rTranID,
-                                                                                                                  errFileError,
-                                                                                                                  reasParameterNameInvalid,
-                                                                                                                  "Error: Wrong bitstream file path.")));
-
-         return ;
+#if defined( __AAL_LINUX__ )
+      if(bStream) {
+         // Map the file; the driver pins the mapped pages and pushes from them.
+         struct stat st;
+         int fd = open(filename, O_RDONLY);
+
+         if((fd < 0) || (0 != fstat(fd, &st))) {
+            if(fd >= 0) {
+               close(fd);
+            }
+            AAL_ERR( LM_ALI, "Wrong bitstream file path " << std::endl);
+            getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
+                                                                                                                     rTranID,
+                                                                                                                     errFileError,
+                                                                                                                     reasParameterNameInvalid,
+                                                                                                                     "Error: Wrong bitstream file path.")));
+
+            return ;
+         }
+
+         filesize = st.st_size;
+
+         if(0 == filesize) {
+            close(fd);
+            AAL_ERR( LM_ALI, "Zero bitstream file size "<< std::endl);
+            getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
+                                                                                                                     rTranID,
+                                                                                                                     errFileError,
+                                                                                                                     reasParameterValueInvalid,
+                                                                                                                     "Error: Zero bitstream file size.")));
+
+            return ;
+         }
+
+         void *p = mmap(NULL, (size_t)filesize, PROT_READ, MAP_PRIVATE, fd, 0);
+         close(fd);
+
+         if(MAP_FAILED == p) {
+            AAL_ERR( LM_ALI, "Failed to map bitstream file "<< std::endl);
+            getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
+                                                                                                                     rTranID,
+                                                                                                                     errAllocationFailure,
+                                                                                                                     reasUnknown,
+                                                                                                                     "Error: Failed to map bitstream file.")));
+            return ;
+         }
+
+         // Start readahead of the whole file before the driver walks it.
+         madvise(p, (size_t)filesize, MADV_SEQUENTIAL);
+         madvise(p, (size_t)filesize, MADV_WILLNEED);
+
+         mapptr = reinterpret_cast<btByte *>(p);
       }
-
-      bitfile.seekg( 0, std::ios::end );
-      filesize = bitfile.tellg();
-
-      if(0 == filesize) {
-         // file size is 0, Dispatch error Message "Zero bitstream file size"
-         AAL_ERR( LM_ALI, "Zero bitstream file size "<< std::endl);
-         getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
-                                                                                                                  rTranID,
-                                                                                                                  errFileError,
-                                                                                                                  reasParameterValueInvalid,
-                                                                                                                  "Error: Zero bitstream file size.")));
-
-         return ;
+#endif // __AAL_LINUX__
+
+      if(NULL == mapptr) {
+         std::ifstream bitfile(filename, std::ios::binary );
+
+         if(!bitfile.good()) {
+            // file is invalid, Dispatch error Message "Wrong bitstream file path"
+            AAL_ERR( LM_ALI, "Wrong bitstream file path " << std::endl);
+            getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
+                                                                                                                     rTranID,
+                                                                                                                     errFileError,
+                                                                                                                     reasParameterNameInvalid,
+                                                                                                                     "Error: Wrong bitstream file path.")));
+
+            return ;
+         }
+
+         bitfile.seekg( 0, std::ios::end );
+         filesize = bitfile.tellg();
+
+         if(0 == filesize) {
+            // file size is 0, Dispatch error Message "Zero bitstream file size"
+            AAL_ERR( LM_ALI, "Zero bitstream file size "<< std::endl);
+            getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
+                                                                                                                     rTranID,
+                                                                                                                     errFileError,
+                                                                                                                     reasParameterValueInvalid,
+                                                                                                                     "Error: Zero bitstream file size.")));
+
+            return ;
+         }
+
+
+         bitfile.seekg( 0, std::ios::beg );
+         bufptr = new(std::nothrow) btByte[filesize];
+
+         if(NULL == bufptr) {
+            // Memory  allocation failed  error Message "Failed to allocate file buffer"
+            AAL_ERR( LM_ALI, "Failed to allocate bitstream file buffer "<< std::endl);
+            getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
+                                                                                                                     rTranID,
+                                                                                                                     errAllocationFailure,
+                                                                                                                     reasUnknown,
+                                                                                                                     "Error: Failed to allocate file buffer.")));
+            return ;
+         }
+
+         bitfile.read(reinterpret_cast<char *>(bufptr), filesize);
       }
 
-
-      bitfile.seekg( 0, std::ios::beg );
-      bufptr = new(std::nothrow) btByte[filesize];
-
-      if(NULL == bufptr) {
-         // Memory  allocation failed  error Message "Failed to allocate file buffer"
-         AAL_ERR( LM_ALI, "Failed to allocate bitstream file buffer "<< std::endl);
-         getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
-                                                                                                                  rTranID,
-                                                                                                                  errAllocationFailure,
-                                                                                                                  reasUnknown,
-                                                                                                                  "Error: Failed to allocate file buffer.")));
-         return ;
-      }
-
-      bitfile.read(reinterpret_cast<char *>(bufptr), filesize);
-
    }else{
       AAL_ERR( LM_ALI,"No bitstream file source"<< std::endl);
       getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
@@ -251,26 +347,44 @@ void CHWALIReconf::reconfConfigure( TransactionID const &rTranID,
    //
    // FIXME: Placeholder for proper metadata handling (Alpha+)
    //
-   btByte *bufptr_skip = bufptr;
-   btWSSize filesize_skip = filesize;
-   if (*((btUnsigned32bitInt *)bufptr) == GBS_HEADER_MAGIC) {    // Alpha+ magic sequence
-      ASSERT( filesize > GBS_HEADER_LEN );
-      bufptr_skip = bufptr + GBS_HEADER_LEN;
-      filesize_skip = ((btWSSize)filesize) - GBS_HEADER_LEN;
-   } else {
-      AAL_ERR( LM_ALI, "Invalid green bitstream header" << std::endl);
-      getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
-                  rTranID,
-                  errFileError,
-                  reasUnknown,
-                  "Error: Invalid green bitstream header.")));
-      return;
+   if(NULL == pImage){
+      btByte *bitstream = (NULL != mapptr) ? mapptr : bufptr;
+      if ((filesize > GBS_HEADER_LEN) &&
+          (*((btUnsigned32bitInt *)bitstream) == GBS_HEADER_MAGIC)) {    // Alpha+ magic sequence
+         bufptr_skip = bitstream + GBS_HEADER_LEN;
+         filesize_skip = ((btWSSize)filesize) - GBS_HEADER_LEN;
+      } else {
+         AAL_ERR( LM_ALI, "Invalid green bitstream header" << std::endl);
+         getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
+                     rTranID,
+                     errFileError,
+                     reasUnknown,
+                     "Error: Invalid green bitstream header.")));
+         releaseBitstream(bufptr, mapptr, filesize);
+         return;
+      }
    }
 
+   {
+      AutoLock(this);
+      (Timer() - loadStart).AsNanoSeconds(m_LoadNs);
+   }
 
-   AFUConfigureTransaction configuretrans(reinterpret_cast<btVirtAddr>(bufptr_skip), filesize_skip, rTranID,rInputArgs);
+   AFUConfigureTransaction configuretrans(reinterpret_cast<btVirtAddr>(bufptr_skip),
+                                          filesize_skip,
+                                          rTranID,
+                                          rInputArgs,
+                                          (NULL != mapptr) || (NULL != pImage));
    // Send transaction
-   m_pAFUProxy->SendTransaction(&configuretrans);
+   m_pAFUProxy->SendPolledTransaction(&configuretrans);
+
+   // The driver has copied or pinned the bitstream by now.
+   if(NULL != pImage){
+      m_PRCache.Release(pImage);
+   }else{
+      releaseBitstream(bufptr, mapptr, filesize);
+   }
+
    if(configuretrans.getErrno() != uid_errnumOK){
       AAL_ERR( LM_ALI,"Reconfigure failed"<< std::endl);
       getRuntime()->schedDispatchable(new AFUReconfigureFailed( m_pReconClient,new CExceptionTransactionEvent( NULL,
@@ -278,12 +392,23 @@ void CHWALIReconf::reconfConfigure( TransactionID const &rTranID,
                                                                                                                errCauseUnknown,
                                                                                                                reasUnknown,
                                                                                                                "Error: Failed transaction")));
-      if(bufptr)
-         delete[] bufptr;
       return;
    }
-   if(bufptr)
+}
+
+//
+// releaseBitstream. Frees the bitstream buffer or unmaps the bitstream file.
+//
+void CHWALIReconf::releaseBitstream(btByte *bufptr, btByte *mapptr, std::streampos filesize)
+{
+   if(NULL != bufptr) {
       delete[] bufptr;
+   }
+#if defined( __AAL_LINUX__ )
+   if(NULL != mapptr) {
+      munmap(mapptr, (size_t)filesize);
+   }
+#endif // __AAL_LINUX__
 }
 
 /// @brief Activate an AFU after it has been reconfigured.
@@ -302,7 +427,7 @@ void CHWALIReconf::reconfActivate( TransactionID const &rTranID,
 {
    AFUActivateTransaction activatetrans(rTranID);
    // Send transaction
-   m_pAFUProxy->SendTransaction(&activatetrans);
+   m_pAFUProxy->SendPolledTransaction(&activatetrans);
    if(activatetrans.getErrno() != uid_errnumOK){
       AAL_ERR( LM_ALI,"Activate failed"<< std::endl);
 
@@ -316,6 +441,42 @@ void CHWALIReconf::reconfActivate( TransactionID const &rTranID,
 
 }
 
+/// @brief Per-phase timings of the most recent successful reconfConfigure().
+///
+/// @param[out] rTimings Receives the AALCONF_TIMING_* keys.
+/// @return     false if no reconfConfigure() has completed yet.
+///
+btBool CHWALIReconf::reconfGetTimings( NamedValueSet &rTimings )
+{
+   AutoLock(this);
+
+   if(!m_bTimings){
+      return false;
+   }
+
+   rTimings.Add(AALCONF_TIMING_LOAD_NS, m_Timings.load_ns);
+   rTimings.Add(AALCONF_TIMING_PUSH_NS, m_Timings.push_ns);
+   rTimings.Add(AALCONF_TIMING_WAIT_NS, m_Timings.wait_ns);
+   rTimings.Add(AALCONF_TIMING_BYTES,   m_Timings.bytes);
+   return true;
+}
+
+//
+// recordTimings. Keeps the driver's PR phase timings of a successful configure,
+// adding the user-space load time to the driver's.
+//
+void CHWALIReconf::recordTimings(struct aalui_PRTimings const &rTimings)
+{
+   AutoLock(this);
+
+   m_Timings          = rTimings;
+   m_Timings.load_ns += m_LoadNs;
+   m_bTimings         = true;
+
+   AAL_INFO(LM_ALI, "PR of " << m_Timings.bytes << " bytes: load " << m_Timings.load_ns
+                    << " ns, push " << m_Timings.push_ns << " ns, wait " << m_Timings.wait_ns << " ns" << std::endl);
+}
+
 //
 // AFUEvent,AFU Event Handler.
 //
@@ -376,6 +537,9 @@ void CHWALIReconf::AFUEvent(AAL::IEvent const &theEvent)
                                                                                                                             reasUnknown,
                                                                                                                             "Error: Configure failed. Check Exception number against uid_errnum_e codes")));
                   }else{
+                     if( presp->payloadsize >= sizeof(struct aalui_PRTimings) ){
+                        recordTimings(*reinterpret_cast<struct aalui_PRTimings *>(aalui_AFURespPayload(presp)));
+                     }
                      getRuntime()->schedDispatchable(new AFUReconfigured(m_pReconClient, TransactionID(puidEvent->msgTranID())));
                   }
                  return;
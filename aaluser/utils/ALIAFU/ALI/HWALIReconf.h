@@ -44,6 +44,7 @@
 #define __HWALIRECONF_H__
 
 #include "HWALIBase.h"
+#include "ALIPRCache.h"
 
 BEGIN_NAMESPACE(AAL)
 
@@ -72,16 +73,31 @@ public :
                                  NamedValueSet const &rInputArgs );
    virtual void reconfActivate( TransactionID const &rTranID,
                                 NamedValueSet const &rInputArgs );
+   virtual btBool reconfGetTimings( NamedValueSet &rTimings );
    // </ALIReconfigure>
 
    // sets Reconfigure  Client interface
    btBool setReconfClientInterface();
 
+   // PR images kept for reconfConfigure()
+   CALIPRCache & PRCache() { return m_PRCache; }
+
    // AFU Event Handler
    virtual void AFUEvent(AAL::IEvent const &theEvent);
 
 private:
+   // Frees the bitstream buffer or unmaps the bitstream file
+   void releaseBitstream(btByte *bufptr, btByte *mapptr, std::streampos filesize);
+   // Keeps the PR phase timings reported with a configure response
+   void recordTimings(struct aalui_PRTimings const &rTimings);
+
    IALIReconfigure_Client *m_pReconClient;
+
+   btUnsigned64bitInt      m_LoadNs;      // User-space load time of the configure in flight
+   btBool                  m_bTimings;    // m_Timings holds a completed configure
+   struct aalui_PRTimings  m_Timings;
+
+   CALIPRCache             m_PRCache;
 };
 
 // ===========================================================================
@@ -102,6 +118,7 @@ public:
       m_pSvcClient->deactivateSucceeded(m_TranID);
    }
 
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcClient); }
 
 protected:
    IALIReconfigure_Client      *m_pSvcClient;
@@ -121,6 +138,7 @@ public:
       m_pSvcClient->deactivateFailed(*m_pEvent);
    }
 
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcClient); }
 
 protected:
    IALIReconfigure_Client        *m_pSvcClient;
@@ -140,6 +158,7 @@ public:
       m_pSvcClient->activateSucceeded(m_TranID);
    }
 
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcClient); }
 
 protected:
    IALIReconfigure_Client      *m_pSvcClient;
@@ -159,6 +178,7 @@ public:
       m_pSvcClient->activateFailed(*m_pEvent);
    }
 
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcClient); }
 
 protected:
    IALIReconfigure_Client        *m_pSvcClient;
@@ -178,6 +198,7 @@ public:
       m_pSvcClient->configureSucceeded(m_TranID);
    }
 
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcClient); }
 
 protected:
    IALIReconfigure_Client      *m_pSvcClient;
@@ -198,6 +219,7 @@ public:
       m_pSvcClient->configureFailed(*m_pEvent);
    }
 
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcClient); }
 
 protected:
    IALIReconfigure_Client        *m_pSvcClient;
@@ -0,0 +1,107 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file SWSimAFU.h
+/// @brief Interface between the software simulation ALI and its AFU models.
+/// @ingroup ALI
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// CSWSimALIAFU stands in for the FPGA: it owns the AFU's MMIO register file,
+/// the shared buffers and the UMsg pages, all in ordinary process memory. An
+/// AFU model derived from CSWSimAFU supplies the behaviour. Host MMIO writes
+/// land in the register file and are then handed to CSRWrite(); host reads
+/// return the register file as the model last left it. The model reaches host
+/// memory by IOVA through ISWSimHost::Translate(), exactly as the FPGA would
+/// through the IOMMU.
+///
+/// SWSimCreateAFU() picks the model for an AFU ID. There is only the NLB
+/// model so far, and it serves every AFU ID; add new models there.@endverbatim
+//****************************************************************************
+#ifndef __SWSIMAFU_H__
+#define __SWSIMAFU_H__
+#include <aalsdk/AALTypes.h>
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup ALI
+/// @{
+
+/// The host side of the simulated FPGA, as seen by an AFU model.
+class ISWSimHost
+{
+public:
+   virtual ~ISWSimHost() {}
+
+   /// Host address of Length bytes at IOVA, or NULL unless they lie within one shared buffer.
+   virtual btVirtAddr Translate(btPhysAddr IOVA, btWSSize Length) = 0;
+   /// Host address of UMsg UMsgNumber, or NULL.
+   virtual btVirtAddr UMsg(btUnsignedInt UMsgNumber) = 0;
+   /// The AFU's MMIO register file.
+   virtual btVirtAddr CSRBase() = 0;
+};
+
+/// Base of the software AFU models.
+class CSWSimAFU
+{
+public:
+   CSWSimAFU(ISWSimHost *pHost) :
+      m_pHost(pHost)
+   {}
+   /// Models that run threads must stop them here.
+   virtual ~CSWSimAFU() {}
+
+   /// Return to the power-on state, abandoning any operation in flight.
+   virtual void Reset() = 0;
+   /// Act on a host MMIO write. Value is already in the register file.
+   virtual void CSRWrite(btCSROffset Offset, btUnsignedInt Width, btUnsigned64bitInt Value) = 0;
+
+protected:
+   btUnsigned32bitInt CSR32(btCSROffset Offset) const
+   {
+      return *reinterpret_cast<volatile btUnsigned32bitInt *>(m_pHost->CSRBase() + Offset);
+   }
+   btUnsigned64bitInt CSR64(btCSROffset Offset) const
+   {
+      return *reinterpret_cast<volatile btUnsigned64bitInt *>(m_pHost->CSRBase() + Offset);
+   }
+   void SetCSR64(btCSROffset Offset, btUnsigned64bitInt Value)
+   {
+      *reinterpret_cast<volatile btUnsigned64bitInt *>(m_pHost->CSRBase() + Offset) = Value;
+   }
+
+   ISWSimHost *m_pHost;
+};
+
+/// Create the model for AFUId (NULL for the default), or return NULL on failure.
+CSWSimAFU * SWSimCreateAFU(btcString AFUId, ISWSimHost *pHost);
+
+/// @}
+
+END_NAMESPACE(AAL)
+
+#endif // __SWSIMAFU_H__
@@ -0,0 +1,587 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file SWSimALIAFU.cpp
+/// @brief Software simulation delegate of the ALI Service.
+/// @ingroup ALI
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// See SWSimALIAFU.h.@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include <aalsdk/utils/ResMgrUtilities.h>
+#include <aalsdk/AALLoggerExtern.h>
+#include <aalsdk/service/IALIAFU.h>
+#include <aalsdk/aas/AALService.h>
+#include "SWSimALIAFU.h"
+#include "SWSimNLB.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup ALI
+/// @{
+
+// AFU ID reported when none is requested: NLB mode 0.
+#define SWSIM_DEFAULT_AFUID_H 0xD8424DC4A4A3C413ULL
+#define SWSIM_DEFAULT_AFUID_L 0xF89E433683F9040BULL
+
+// Spacing of the simulated IOVAs. Every buffer starts on a fresh 2MB boundary.
+#define SWSIM_IOVA_ALIGN      ( 2 * 1024 * 1024 )
+
+// UMsgs are separated by 1 Page + 1 CL
+#define SWSIM_UMSG_STRIDE     ( 4096 + 64 )
+
+//
+// SWSimParseAFUId. Split an AFU ID string into the values of its AFU ID CSRs.
+//
+static btBool SWSimParseAFUId(btcString AFUId, btUnsigned64bitInt *pHigh, btUnsigned64bitInt *pLow)
+{
+   btUnsigned64bitInt half[2] = { 0, 0 };
+   btUnsignedInt      digits  = 0;
+
+   for ( ; '\0' != *AFUId ; ++AFUId ) {
+      btInt c = *AFUId;
+      btUnsigned64bitInt v;
+
+      if ( '-' == c ) {
+         continue;
+      } else if ( ( c >= '0' ) && ( c <= '9' ) ) {
+         v = c - '0';
+      } else if ( ( c >= 'a' ) && ( c <= 'f' ) ) {
+         v = c - 'a' + 10;
+      } else if ( ( c >= 'A' ) && ( c <= 'F' ) ) {
+         v = c - 'A' + 10;
+      } else {
+         return false;
+      }
+
+      if ( digits >= 32 ) {
+         return false;
+      }
+      half[digits / 16] = ( half[digits / 16] << 4 ) | v;
+      ++digits;
+   }
+
+   if ( 32 != digits ) {
+      return false;
+   }
+   *pHigh = half[0];
+   *pLow  = half[1];
+   return true;
+}
+
+CSWSimAFU * SWSimCreateAFU(btcString AFUId, ISWSimHost *pHost)
+{
+   btUnsigned64bitInt high = SWSIM_DEFAULT_AFUID_H;
+   btUnsigned64bitInt low  = SWSIM_DEFAULT_AFUID_L;
+
+   if ( ( NULL != AFUId ) && !SWSimParseAFUId(AFUId, &high, &low) ) {
+      AAL_ERR(LM_ALI, "SWSim: malformed AFU ID " << AFUId << std::endl);
+      return NULL;
+   }
+
+   return new(std::nothrow) CSWSimNLB(pHost, high, low);
+}
+
+//
+// ctor. SWSimInit() does the work.
+//
+CSWSimALIAFU::CSWSimALIAFU( IBase *pSvcClient,
+                            IServiceBase *pServiceBase,
+                            TransactionID transID ) :
+   CALIBase(pSvcClient, pServiceBase, transID),
+   m_MMIORmap(NULL),
+   m_MMIORsize(0),
+   m_uMSGmap(NULL),
+   m_uMSGsize(0),
+   m_UMsgHint(0),
+   m_pAFU(NULL),
+   m_WkSpcIndex(),
+   m_IOVAIndex(),
+   m_NextIOVA(SWSIM_IOVA_BASE),
+   m_NextWSID(1),
+   m_BufferPool(this)
+{}
+
+CSWSimALIAFU::~CSWSimALIAFU()
+{
+   m_BufferPool.Release();
+
+   // Stop the model before the memory it may be using goes away.
+   delete m_pAFU;
+   m_pAFU = NULL;
+
+   std::vector<struct aalui_WSMParms> buffers;
+   m_WkSpcIndex.Snapshot(buffers);
+
+   std::vector<struct aalui_WSMParms>::const_iterator iter;
+   for ( iter = buffers.begin() ; iter != buffers.end() ; ++iter ) {
+      ::munmap((*iter).ptr, (*iter).size);
+   }
+
+   delete[] reinterpret_cast<btUnsigned64bitInt *>(m_MMIORmap);
+   m_MMIORmap = NULL;
+}
+
+//
+// SWSimInit. Create the register file, UMsg pages and AFU model.
+//
+btBool CSWSimALIAFU::SWSimInit( btcString AFUId )
+{
+   btVirtAddr pCSRs = reinterpret_cast<btVirtAddr>(new(std::nothrow) btUnsigned64bitInt[SWSIM_MMIO_LENGTH / sizeof(btUnsigned64bitInt)]());
+   if ( NULL == pCSRs ) {
+      AAL_ERR( LM_ALI, "No Memory to allocate SWSim MMIO space"<< std::endl);
+      m_pServiceBase->initFailed(new CExceptionTransactionEvent( NULL,
+                                                                 m_tidSaved,
+                                                                 errMemory,
+                                                                 reasUnknown,
+                                                                 "Error: Failed to allocate SWSim MMIO space."));
+      return false;
+   }
+   m_MMIORmap  = pCSRs;
+   m_MMIORsize = SWSIM_MMIO_LENGTH;
+
+   // The UMsg pages are a buffer like any other, so that bufferGetIOVA() covers them.
+   m_uMSGsize = SWSIM_NUM_UMSG * SWSIM_UMSG_STRIDE;
+   if ( ali_errnumOK != bufferAllocate(m_uMSGsize, &m_uMSGmap) ) {
+      m_uMSGmap = NULL;
+      m_pServiceBase->initFailed(new CExceptionTransactionEvent( NULL,
+                                                                 m_tidSaved,
+                                                                 errMemory,
+                                                                 reasUnknown,
+                                                                 "Error: Failed to allocate SWSim UMsg space."));
+      return false;
+   }
+
+   m_pAFU = SWSimCreateAFU(AFUId, this);
+   if ( NULL == m_pAFU ) {
+      m_pServiceBase->initFailed(new CExceptionTransactionEvent( NULL,
+                                                                 m_tidSaved,
+                                                                 errCreationFailure,
+                                                                 reasUnknown,
+                                                                 "Error: No SWSim model for the AFU."));
+      return false;
+   }
+
+   if ( !_discoverFeatures() ) {
+      m_pServiceBase->initFailed(new CExceptionTransactionEvent( NULL,
+                                                                 m_tidSaved,
+                                                                 errBadParameter,
+                                                                 reasMissingInterface,
+                                                                 "Failed to discover features."));
+      return false;
+   }
+
+   return true;
+}
+
+//
+// Translate. Host address of Length bytes at IOVA, within a single buffer.
+//
+btVirtAddr CSWSimALIAFU::Translate( btPhysAddr IOVA, btWSSize Length )
+{
+   struct aalui_WSMParms parms;
+   if ( !m_IOVAIndex.FindContaining(reinterpret_cast<btVirtAddr>(IOVA), &parms) ) {
+      return NULL;
+   }
+
+   btWSSize offset = (btWSSize)( reinterpret_cast<btVirtAddr>(IOVA) - parms.ptr );
+   if ( Length > parms.size - offset ) {
+      return NULL;
+   }
+   return reinterpret_cast<btVirtAddr>(parms.physptr) + offset;
+}
+
+btBool CSWSimALIAFU::_discoverFeatures()
+{
+   // Walk the DFH list the model put in the register file.
+   FeatureDefinition  feat;
+   btUnsigned32bitInt offset = 0;
+
+   do {
+      feat.offset = offset;
+      mmioRead64(offset, (btUnsigned64bitInt *)&feat.dfh);
+      if ( ( 0 == offset ) || ( ALI_DFH_TYPE_BBB == feat.dfh.Type ) ) {
+         mmioRead64(offset +  8, &feat.guid[0]);
+         mmioRead64(offset + 16, &feat.guid[1]);
+      } else {
+         feat.guid[0] = feat.guid[1] = 0;
+      }
+      m_featureList.push_back(feat);
+
+      offset += feat.dfh.next_DFH_offset;
+   } while ( ( 0 == feat.dfh.eol ) && ( 0 != feat.dfh.next_DFH_offset ) && ( offset < m_MMIORsize ) );
+
+   return true;
+}
+
+
+// ---------------------------------------------------------
+// MMIO actions
+// ---------------------------------------------------------
+
+void CSWSimALIAFU::mmioStore( btCSROffset Offset, btUnsignedInt Width, btUnsigned64bitInt Value )
+{
+   if ( ali_mmio_width32 == Width ) {
+      *reinterpret_cast<volatile btUnsigned32bitInt *>(m_MMIORmap + Offset) = (btUnsigned32bitInt)Value;
+   } else {
+      *reinterpret_cast<volatile btUnsigned64bitInt *>(m_MMIORmap + Offset) = Value;
+   }
+   m_pAFU->CSRWrite(Offset, Width, Value);
+}
+
+//
+// mmioRead32. Read 32bit CSR. Offset given in bytes.
+//
+btBool CSWSimALIAFU::mmioRead32(const btCSROffset Offset, btUnsigned32bitInt * const pValue)
+{
+   if ( !mmioIsValid(Offset, sizeof(btUnsigned32bitInt)) ) {
+      return false;
+   }
+   *pValue = *reinterpret_cast<volatile btUnsigned32bitInt *>(m_MMIORmap + Offset);
+   return true;
+}
+
+//
+// mmioWrite32. Write 32bit CSR. Offset given in bytes.
+//
+btBool CSWSimALIAFU::mmioWrite32(const btCSROffset Offset, const btUnsigned32bitInt Value)
+{
+   if ( !mmioIsValid(Offset, sizeof(btUnsigned32bitInt)) ) {
+      return false;
+   }
+   mmioStore(Offset, ali_mmio_width32, Value);
+   return true;
+}
+
+//
+// mmioRead64. Read 64bit CSR. Offset given in bytes.
+//
+btBool CSWSimALIAFU::mmioRead64(const btCSROffset Offset, btUnsigned64bitInt * const pValue)
+{
+   if ( !mmioIsValid(Offset, sizeof(btUnsigned64bitInt)) ) {
+      return false;
+   }
+   *pValue = *reinterpret_cast<volatile btUnsigned64bitInt *>(m_MMIORmap + Offset);
+   return true;
+}
+
+//
+// mmioWrite64. Write 64bit CSR. Offset given in bytes.
+//
+btBool CSWSimALIAFU::mmioWrite64(const btCSROffset Offset, const btUnsigned64bitInt Value)
+{
+   if ( !mmioIsValid(Offset, sizeof(btUnsigned64bitInt)) ) {
+      return false;
+   }
+   mmioStore(Offset, ali_mmio_width64, Value);
+   return true;
+}
+
+//
+// mmioWriteBatch. Validate a batch of CSR writes, then perform them in order.
+//
+btBool CSWSimALIAFU::mmioWriteBatch(ali_mmio_access_t const *pAccesses, btUnsignedInt Count)
+{
+   if ( ( NULL == m_MMIORmap ) || !mmioBatchIsValid(pAccesses, Count, m_MMIORsize) ) {
+      return false;
+   }
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < Count ; ++i ) {
+      mmioStore(pAccesses[i].offset, pAccesses[i].width, pAccesses[i].value);
+   }
+   return true;
+}
+
+//
+// mmioReadBatch. Validate a batch of CSR reads, then perform them in order.
+//
+btBool CSWSimALIAFU::mmioReadBatch(ali_mmio_access_t *pAccesses, btUnsignedInt Count)
+{
+   if ( ( NULL == m_MMIORmap ) || !mmioBatchIsValid(pAccesses, Count, m_MMIORsize) ) {
+      return false;
+   }
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < Count ; ++i ) {
+      if ( ali_mmio_width32 == pAccesses[i].width ) {
+         pAccesses[i].value = *reinterpret_cast<volatile btUnsigned32bitInt *>(m_MMIORmap + pAccesses[i].offset);
+      } else {
+         pAccesses[i].value = *reinterpret_cast<volatile btUnsigned64bitInt *>(m_MMIORmap + pAccesses[i].offset);
+      }
+   }
+   return true;
+}
+
+//
+// mmioGetFeatureAddress. Get pointer to feature's DFH, if found.
+//
+btBool CSWSimALIAFU::mmioGetFeatureAddress( btVirtAddr          *pFeatureAddress,
+                                            NamedValueSet const &rInputArgs,
+                                            NamedValueSet       &rOutputArgs )
+{
+   btBool             filterByID   = rInputArgs.Has(ALI_GETFEATURE_ID_KEY);
+   btUnsigned64bitInt filterID     = 0;
+   btBool             filterByType = rInputArgs.Has(ALI_GETFEATURE_TYPE_KEY);
+   btUnsigned64bitInt filterType   = 0;
+   btBool             filterByGUID = rInputArgs.Has(ALI_GETFEATURE_GUID_KEY);
+   btcString          filterGUID   = NULL;
+
+   if ( ( filterByID   && ( ENamedValuesOK != rInputArgs.Get(ALI_GETFEATURE_ID_KEY,   &filterID)   ) ) ||
+        ( filterByType && ( ENamedValuesOK != rInputArgs.Get(ALI_GETFEATURE_TYPE_KEY, &filterType) ) ) ||
+        ( filterByGUID && ( ENamedValuesOK != rInputArgs.Get(ALI_GETFEATURE_GUID_KEY, &filterGUID) ) ) ) {
+      AAL_ERR(LM_ALI, "rInputArgs.Get() failed -- wrong datatype?" << std::endl);
+      return false;
+   }
+
+   // Can't search for GUID in private features
+   if ( filterByGUID && filterByType && ( filterType == ALI_DFH_TYPE_PRIVATE ) ) {
+      AAL_ERR(LM_AFU, "Can't search for GUIDs in private features." << std::endl);
+      return false;
+   }
+
+   for ( FeatureList::iterator iter = m_featureList.begin();
+         iter != m_featureList.end(); ++iter ) {
+      FeatureDefinition &feat = *iter;
+      std::string guid = GUIDStringFromStruct(GUIDStructFrom2xU64(feat.guid[1], feat.guid[0]));
+
+      // return first matching feature
+      if ( ( !filterByID   || ( feat.dfh.Feature_ID == filterID   ) ) &&
+           ( !filterByType || ( feat.dfh.Type       == filterType ) ) &&
+           ( !filterByGUID || ( ( feat.dfh.Type != ALI_DFH_TYPE_PRIVATE ) &&
+                                ( 0 == strncmp(filterGUID, guid.c_str(), 16) ) ) ) ) {
+
+         *pFeatureAddress = m_MMIORmap + feat.offset;
+         rOutputArgs.Add(ALI_GETFEATURE_ID_KEY, feat.dfh.Feature_ID);
+         rOutputArgs.Add(ALI_GETFEATURE_TYPE_KEY, feat.dfh.Type);
+         if ( feat.dfh.Type != ALI_DFH_TYPE_PRIVATE ) {
+            rOutputArgs.Add(ALI_GETFEATURE_GUID_KEY, guid.c_str());
+         }
+         return true;
+      }
+   }
+
+   // if not found, do not modify ppFeature, return false.
+   AAL_INFO(LM_AFU, "No matching feature found." << std::endl);
+   return false;
+}
+
+btBool CSWSimALIAFU::mmioGetFeatureAddress( btVirtAddr          *pFeatureAddress,
+                                            NamedValueSet const &rInputArgs )
+{
+   NamedValueSet temp;
+   return mmioGetFeatureAddress(pFeatureAddress, rInputArgs, temp);
+}
+
+btBool CSWSimALIAFU::mmioGetFeatureOffset( btCSROffset         *pFeatureOffset,
+                                           NamedValueSet const &rInputArgs,
+                                           NamedValueSet       &rOutputArgs )
+{
+   btVirtAddr pFeatAddr;
+   if ( true == mmioGetFeatureAddress(&pFeatAddr, rInputArgs, rOutputArgs) ) {
+      *pFeatureOffset = pFeatAddr - m_MMIORmap;
+      return true;
+   }
+   return false;
+}
+
+btBool CSWSimALIAFU::mmioGetFeatureOffset( btCSROffset         *pFeatureOffset,
+                                           NamedValueSet const &rInputArgs )
+{
+   NamedValueSet temp;
+   return mmioGetFeatureOffset(pFeatureOffset, rInputArgs, temp);
+}
+
+
+// -----------------------------------------------------
+// Buffer allocation API
+// -----------------------------------------------------
+
+//
+// bufferAllocate. Map anonymous shared memory and give it the next IOVA.
+//
+AAL::ali_errnum_e CSWSimALIAFU::bufferAllocate( btWSSize             Length,
+                                                btVirtAddr          *pBufferptr,
+                                                NamedValueSet const &rInputArgs,
+                                                NamedValueSet       &rOutputArgs )
+{
+   AutoLock(this);
+   *pBufferptr = NULL;
+
+   if ( 0 == Length ) {
+      return ali_errnumBadParameter;
+   }
+
+   ALI_MMAP_TARGET_VADDR_DATATYPE pTargetVirtAddr;       // requested virtual address for the mapping
+   if ( ENamedValuesOK != rInputArgs.Get(ALI_MMAP_TARGET_VADDR_KEY, &pTargetVirtAddr) ) {
+      pTargetVirtAddr = NULL;    // no mapping requested
+   }
+
+   const btWSSize PageSize = (btWSSize)::sysconf(_SC_PAGESIZE);
+   const btWSSize Size     = ( Length + PageSize - 1 ) & ~( PageSize - 1 );
+
+   int flags = MAP_SHARED | MAP_ANONYMOUS;
+   if ( NULL != pTargetVirtAddr ) {
+      flags |= MAP_FIXED;
+   }
+
+   void *p = ::mmap(pTargetVirtAddr, Size, PROT_READ | PROT_WRITE, flags, -1, 0);
+   if ( MAP_FAILED == p ) {
+      AAL_ERR(LM_ALI, "SWSim: could not map a buffer of " << Length << " bytes" << std::endl);
+      return ali_errnumNoMem;
+   }
+
+   struct aalui_WSMParms wsParms;
+   ::memset(&wsParms, 0, sizeof(wsParms));
+   wsParms.wsid    = m_NextWSID++;
+   wsParms.ptr     = reinterpret_cast<btVirtAddr>(p);
+   wsParms.physptr = m_NextIOVA;
+   wsParms.size    = Size;
+
+   m_NextIOVA += ( Size + SWSIM_IOVA_ALIGN - 1 ) & ~( (btWSSize)SWSIM_IOVA_ALIGN - 1 );
+
+   struct aalui_WSMParms ioParms = wsParms;
+   ioParms.ptr     = reinterpret_cast<btVirtAddr>(wsParms.physptr);
+   ioParms.physptr = reinterpret_cast<btPhysAddr>(wsParms.ptr);
+
+   if ( !m_WkSpcIndex.Add(wsParms) ) {
+      AAL_ERR(LM_ALI, "SWSim: buffer already recorded at " << p << std::endl);
+      ::munmap(p, Size);
+      return ali_errnumSystem;
+   }
+   if ( !m_IOVAIndex.Add(ioParms) ) {
+      AAL_ERR(LM_ALI, "SWSim: IOVA already recorded at " << (void *)ioParms.ptr << std::endl);
+      m_WkSpcIndex.Remove(wsParms.ptr);
+      ::munmap(p, Size);
+      return ali_errnumSystem;
+   }
+
+   *pBufferptr = wsParms.ptr;
+   return ali_errnumOK;
+}
+
+//
+// bufferFree. Release previously allocated buffer.
+//
+AAL::ali_errnum_e CSWSimALIAFU::bufferFree( btVirtAddr Address)
+{
+   AutoLock(this);
+
+   struct aalui_WSMParms wsParms;
+   if ( !m_WkSpcIndex.Remove(Address, &wsParms) ) {  // not found
+      AAL_ERR(LM_ALI, "Tried to free non-existent Buffer"<< std::endl);
+      return ali_errnumBadParameter;
+   }
+   m_IOVAIndex.Remove(reinterpret_cast<btVirtAddr>(wsParms.physptr));
+
+   ::munmap(wsParms.ptr, wsParms.size);
+   return ali_errnumOK;
+}
+
+
+// ---------------------------------------------------------------------------
+// IALIUMsg interface implementation
+// ---------------------------------------------------------------------------
+
+//
+// umsgGetAddress. Get address of specific UMSG.
+//
+btVirtAddr CSWSimALIAFU::umsgGetAddress( const btUnsignedInt UMsgNumber )
+{
+   if ( ( NULL == m_uMSGmap ) || ( UMsgNumber >= SWSIM_NUM_UMSG ) ) {
+      return NULL;
+   }
+   return m_uMSGmap + UMsgNumber * SWSIM_UMSG_STRIDE;
+}
+
+void CSWSimALIAFU::umsgTrigger64( const btVirtAddr pUMsg,
+                                  const btUnsigned64bitInt Value )
+{
+   if ( ( NULL == m_uMSGmap ) ||
+        ( pUMsg < m_uMSGmap ) ||
+        ( pUMsg + sizeof(btUnsigned64bitInt) > m_uMSGmap + m_uMSGsize ) ) {
+      return;
+   }
+   *reinterpret_cast<volatile btUnsigned64bitInt *>(pUMsg) = Value;
+}  // umsgTrigger64
+
+//
+// umsgSetAttributes. Set UMSG attributes.
+//
+bool CSWSimALIAFU::umsgSetAttributes( NamedValueSet const &nvsArgs)
+{
+   eBasicTypes nvsType;
+
+   if ( ( true != nvsArgs.Has(UMSG_HINT_MASK_KEY) ) ||
+        ( ENamedValuesOK != nvsArgs.Type(UMSG_HINT_MASK_KEY, &nvsType) ) ||
+        ( btUnsigned64bitInt_t != nvsType ) ) {
+      AAL_ERR( LM_All,"Missing Parameter or Key");
+      return false;
+   }
+
+   return ENamedValuesOK == nvsArgs.Get(UMSG_HINT_MASK_KEY, &m_UMsgHint);
+}
+
+
+// ---------------------------------------------------------------------------
+// IALIReset interface implementation
+// ---------------------------------------------------------------------------
+
+IALIReset::e_Reset CSWSimALIAFU::afuQuiesceAndHalt( NamedValueSet const &rInputArgs )
+{
+   if ( NULL == m_pAFU ) {
+      return e_Internal;
+   }
+   m_pAFU->Reset();
+   return e_OK;
+}
+
+IALIReset::e_Reset CSWSimALIAFU::afuEnable( NamedValueSet const &rInputArgs)
+{
+   return ( NULL == m_pAFU ) ? e_Internal : e_OK;
+}
+
+IALIReset::e_Reset CSWSimALIAFU::afuReset( NamedValueSet const &rInputArgs )
+{
+   if ( NULL == m_pAFU ) {
+      return e_Internal;
+   }
+   m_pAFU->Reset();
+   return e_OK;
+}
+
+/// @} group ALI
+
+END_NAMESPACE(AAL)
@@ -0,0 +1,200 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file SWSimALIAFU.h
+/// @brief Software simulation delegate of the ALI Service.
+/// @ingroup ALI
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// CSWSimALIAFU implements the AFU interfaces of ALI entirely in process
+/// memory, with the AFU's behaviour supplied by a model from SWSimAFU.h. It
+/// needs no driver, Resource Manager or simulator, so host software can be run
+/// and benchmarked against it on any Linux machine. It is selected with
+/// ALIAFU_NVS_KEY_TARGET = ali_afu_swswim in the allocation manifest.
+///
+/// Shared buffers are anonymous mappings with IOVAs drawn from a private,
+/// never reused range, so a model only reaches memory the host allocated.
+/// mmioGetAddress() returns the register file: reads through it see what the
+/// model last stored, but the model only sees writes made with mmioWrite32(),
+/// mmioWrite64() and mmioWriteBatch().@endverbatim
+//****************************************************************************
+#ifndef __SWSIMALIAFU_H__
+#define __SWSIMALIAFU_H__
+
+#include "ALIBase.h"
+#include "ALIBufferIndex.h"
+#include "ALIBufferPool.h"
+#include "SWSimAFU.h"
+#include "aalsdk/kernel/ccip_defs.h"
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup ALI
+/// @{
+
+/// Size of the simulated AFU's MMIO space.
+#define SWSIM_MMIO_LENGTH  (256 * 1024)
+/// Number of simulated UMsgs. Each occupies a page and a cache line, as in ASE.
+#define SWSIM_NUM_UMSG     8
+/// IOVA of the first simulated shared buffer.
+#define SWSIM_IOVA_BASE    0x100000000ULL
+
+class  CSWSimALIAFU : public CALIBase,
+                      public ISWSimHost,
+                      public IALIMMIO,
+                      public IALIBuffer,
+                      public IALIBufferPool,
+                      public IALIUMsg,
+                      public IALIReset
+{
+public :
+
+   CSWSimALIAFU( IBase *pSvcClient,
+                 IServiceBase *pServiceBase,
+                 TransactionID transID );
+
+   ~CSWSimALIAFU();
+
+   /// Create the register file, UMsg pages and the model for AFUId (NULL for the default).
+   btBool SWSimInit( btcString AFUId );
+
+   // <ISWSimHost>
+   virtual btVirtAddr Translate( btPhysAddr IOVA, btWSSize Length );
+   virtual btVirtAddr UMsg( btUnsignedInt UMsgNumber ) { return umsgGetAddress(UMsgNumber); }
+   virtual btVirtAddr CSRBase() { return m_MMIORmap; }
+   // </ISWSimHost>
+
+   // <IALIMMIO>
+   virtual btVirtAddr   mmioGetAddress( void ) { return m_MMIORmap;  }
+   virtual btCSROffset  mmioGetLength( void )  { return m_MMIORsize; }
+   virtual btBool       mmioIsDirect( void )   { return false;       }
+
+   virtual btBool  mmioRead32( const btCSROffset Offset,       btUnsigned32bitInt * const pValue);
+   virtual btBool  mmioWrite32( const btCSROffset Offset, const btUnsigned32bitInt Value);
+   virtual btBool  mmioRead64( const btCSROffset Offset,       btUnsigned64bitInt * const pValue);
+   virtual btBool  mmioWrite64( const btCSROffset Offset, const btUnsigned64bitInt Value);
+   virtual btBool  mmioWriteBatch( ali_mmio_access_t const *pAccesses, btUnsignedInt Count );
+   virtual btBool  mmioReadBatch( ali_mmio_access_t *pAccesses, btUnsignedInt Count );
+   virtual btBool  mmioGetFeatureAddress( btVirtAddr          *pFeatureAddress,
+                                          NamedValueSet const &rInputArgs,
+                                          NamedValueSet       &rOutputArgs );
+   // overloaded version without rOutputArgs
+   virtual btBool  mmioGetFeatureAddress( btVirtAddr          *pFeatureAddress,
+                                          NamedValueSet const &rInputArgs );
+   virtual btBool  mmioGetFeatureOffset( btCSROffset         *pFeatureOffset,
+                                         NamedValueSet const &rInputArgs,
+                                         NamedValueSet       &rOutputArgs );
+   // overloaded version without rOutputArgs
+   virtual btBool  mmioGetFeatureOffset( btCSROffset         *pFeatureOffset,
+                                         NamedValueSet const &rInputArgs );
+   // </IALIMMIO>
+
+   // <IALIBuffer>
+   virtual AAL::ali_errnum_e bufferAllocate( btWSSize             Length,
+                                             btVirtAddr          *pBufferptr ) { return bufferAllocate(Length, pBufferptr, AAL::NamedValueSet()); }
+   virtual AAL::ali_errnum_e bufferAllocate( btWSSize             Length,
+                                             btVirtAddr          *pBufferptr,
+                                             NamedValueSet const &rInputArgs )
+   {
+      NamedValueSet temp = NamedValueSet();
+      return bufferAllocate(Length, pBufferptr, rInputArgs, temp);
+   }
+   virtual AAL::ali_errnum_e bufferAllocate( btWSSize             Length,
+                                             btVirtAddr          *pBufferptr,
+                                             NamedValueSet const &rInputArgs,
+                                             NamedValueSet       &rOutputArgs );
+   virtual AAL::ali_errnum_e bufferFree( btVirtAddr           Address);
+   virtual btPhysAddr bufferGetIOVA( btVirtAddr Address) { return m_WkSpcIndex.GetIOVA(Address); }
+   // </IALIBuffer>
+
+   // <IALIBufferPool>
+   virtual AAL::ali_errnum_e bufferPoolAllocate( btWSSize    Length,
+                                                 btVirtAddr *pBufferptr,
+                                                 btPhysAddr *pIOVA = NULL ) { return m_BufferPool.bufferPoolAllocate(Length, pBufferptr, pIOVA); }
+   virtual AAL::ali_errnum_e bufferPoolFree( btVirtAddr Address )           { return m_BufferPool.bufferPoolFree(Address);                     }
+   virtual btBool bufferPoolGetStats( INamedValueSet &rResult )             { return m_BufferPool.bufferPoolGetStats(rResult);                 }
+   // </IALIBufferPool>
+
+   // <IALIUMsg>
+   virtual btUnsignedInt umsgGetNumber( void ) { return SWSIM_NUM_UMSG; }
+   virtual btVirtAddr   umsgGetAddress( const btUnsignedInt UMsgNumber );
+   virtual void          umsgTrigger64( const btVirtAddr pUMsg,
+                                        const btUnsigned64bitInt Value );
+   virtual bool      umsgSetAttributes( NamedValueSet const &nvsArgs);
+   // </IALIUMsg>
+
+   // <IALIReset>
+   virtual e_Reset afuQuiesceAndHalt( void ) { return afuQuiesceAndHalt(NamedValueSet()); }
+   virtual e_Reset afuQuiesceAndHalt( NamedValueSet const &rInputArgs );
+   virtual e_Reset afuEnable( void ) { return afuEnable(NamedValueSet()); }
+   virtual e_Reset afuEnable( NamedValueSet const &rInputArgs);
+   virtual e_Reset afuReset( void ) { return afuReset(NamedValueSet()); }
+   virtual e_Reset afuReset( NamedValueSet const &rInputArgs );
+   // </IALIReset>
+
+protected:
+   btBool mmioIsValid( btCSROffset Offset, btCSROffset Bytes ) const
+   {
+      return ( NULL != m_MMIORmap ) && ( Offset <= m_MMIORsize - Bytes ) && ( 0 == ( Offset % Bytes ) );
+   }
+   void   mmioStore( btCSROffset Offset, btUnsignedInt Width, btUnsigned64bitInt Value );
+
+   btVirtAddr           m_MMIORmap;
+   btCSROffset          m_MMIORsize;
+   btVirtAddr           m_uMSGmap;
+   btWSSize             m_uMSGsize;
+   btUnsigned64bitInt   m_UMsgHint;
+
+   CSWSimAFU           *m_pAFU;
+
+   // Shared buffers by virtual address, and the same buffers by IOVA (ptr is the IOVA and
+   // physptr the virtual address).
+   CALIBufferIndex      m_WkSpcIndex;
+   CALIBufferIndex      m_IOVAIndex;
+   btPhysAddr           m_NextIOVA;
+   btWSID               m_NextWSID;
+   CALIBufferPool       m_BufferPool;
+
+   // List to cache device feature metadata
+   typedef struct {
+      btCSROffset        offset;    //< MMIO offset of feature
+      struct CCIP_DFH    dfh;       //< Associated device feature header
+      btUnsigned64bitInt guid[2];   //< GUID (for BBBs/private features)
+   } FeatureDefinition;
+   typedef std::vector<FeatureDefinition> FeatureList;
+   FeatureList m_featureList;
+
+private:
+   btBool _discoverFeatures();
+};
+
+/// @}
+
+END_NAMESPACE(AAL)
+
+#endif // __SWSIMALIAFU_H__
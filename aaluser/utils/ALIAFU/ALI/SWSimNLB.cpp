@@ -0,0 +1,371 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file SWSimNLB.cpp
+/// @brief Native Loopback (NLB) model for the software simulation ALI.
+/// @ingroup ALI
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// See SWSimNLB.h.@endverbatim
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+
+#include <aalsdk/AALLoggerExtern.h>
+#include <aalsdk/kernel/ccip_defs.h>
+#include <aalsdk/osal/Sleep.h>
+#include <aalsdk/osal/Timer.h>
+#include <aalsdk/service/IALIAFU.h>
+#include "SWSimNLB.h"
+
+#include <cstring>
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup ALI
+/// @{
+
+// CSR_CTL bits
+#define NLB_CTL_RUN   0x1   // Out of reset
+#define NLB_CTL_START 0x2
+#define NLB_CTL_STOP  0x4
+
+// DSM test_error bits
+#define NLB_ERR_RESPONSE 0x1   // Unexpected read or write response
+#define NLB_ERR_READBACK 0x8   // SW mode: data read back not as written
+
+#define NLB_TEST_MODE_NOTICE_MASK 0xc000000
+
+CSWSimNLB::CSWSimNLB(ISWSimHost *pHost, btUnsigned64bitInt AFUIdH, btUnsigned64bitInt AFUIdL) :
+   CSWSimAFU(pHost),
+   m_AFUIdH(AFUIdH),
+   m_AFUIdL(AFUIdL),
+   m_DSM(0),
+   m_pThread(NULL),
+   m_bRunning(false),
+   m_bStop(false),
+   m_bAbort(false),
+   m_bNotice(false)
+{
+   Reset();
+}
+
+CSWSimNLB::~CSWSimNLB()
+{
+   AutoLock(this);
+   Abort();
+}
+
+//
+// Reset. Abandon any test and return the CSRs to their power-on values.
+//
+void CSWSimNLB::Reset()
+{
+   AutoLock(this);
+   Abort();
+
+   struct CCIP_DFH dfh;
+   dfh.csr             = 0;
+   dfh.Type            = ALI_DFH_TYPE_AFU;
+   dfh.eol             = 1;
+
+   btCSROffset offset;
+   for ( offset = 0 ; offset < CSR_UMSG_MODE + sizeof(btUnsigned64bitInt) ; offset += sizeof(btUnsigned64bitInt) ) {
+      SetCSR64(offset, 0);
+   }
+   SetCSR64(0x00, dfh.csr);
+   SetCSR64(0x08, m_AFUIdL);
+   SetCSR64(0x10, m_AFUIdH);
+
+   m_DSM = 0;
+}
+
+//
+// CSRWrite. The DSM base, CSR_CTL and CSR_SW_NOTICE have side effects.
+//
+void CSWSimNLB::CSRWrite(btCSROffset Offset, btUnsignedInt Width, btUnsigned64bitInt Value)
+{
+   switch ( Offset ) {
+      case CSR_AFU_DSM_BASEL : {
+         // Written high half first, then low, or as one 64-bit write. The AFU ID goes to the DSM.
+         AutoLock(this);
+         m_DSM = CSR64(CSR_AFU_DSM_BASEL);
+
+         nlb_vafu_dsm *pDSM = reinterpret_cast<nlb_vafu_dsm *>(m_pHost->Translate(m_DSM, sizeof(nlb_vafu_dsm)));
+         if ( NULL == pDSM ) {
+            AAL_ERR(LM_ALI, "SWSim NLB: DSM base 0x" << std::hex << m_DSM << std::dec << " is not in a shared buffer" << std::endl);
+            return;
+         }
+         pDSM->afuid[0] = (btUnsigned32bitInt)m_AFUIdL;
+         pDSM->afuid[1] = (btUnsigned32bitInt)( m_AFUIdL >> 32 );
+         pDSM->afuid[2] = (btUnsigned32bitInt)m_AFUIdH;
+         pDSM->afuid[3] = (btUnsigned32bitInt)( m_AFUIdH >> 32 );
+      } break;
+
+      case CSR_CTL :
+         Control((btUnsigned32bitInt)Value);
+      break;
+
+      case CSR_SW_NOTICE :
+         m_bNotice = true;
+      break;
+
+      default : break;
+   }
+}
+
+//
+// Control. Reset, start or stop the test.
+//
+void CSWSimNLB::Control(btUnsigned32bitInt Ctl)
+{
+   AutoLock(this);
+
+   if ( 0 == ( Ctl & NLB_CTL_RUN ) ) {
+      Abort();
+      return;
+   }
+
+   if ( Ctl & NLB_CTL_STOP ) {
+      m_bStop = true;
+      return;
+   }
+
+   if ( 0 == ( Ctl & NLB_CTL_START ) ) {
+      return;
+   }
+
+   if ( NULL != m_pThread ) {
+      if ( m_bRunning ) {
+         return;   // already started
+      }
+      m_pThread->Join();
+      delete m_pThread;
+      m_pThread = NULL;
+   }
+
+   m_bStop    = false;
+   m_bAbort   = false;
+   m_bNotice  = false;
+   m_bRunning = true;
+   m_pThread  = new(std::nothrow) OSLThread(CSWSimNLB::TestThread, OSLThread::THREADPRIORITY_NORMAL, this);
+   if ( NULL == m_pThread ) {
+      m_bRunning = false;
+      AAL_ERR(LM_ALI, "SWSim NLB: could not start the test thread" << std::endl);
+   }
+}
+
+//
+// Abort. Stop the test thread without reporting. Caller holds the lock.
+//
+void CSWSimNLB::Abort()
+{
+   if ( NULL == m_pThread ) {
+      return;
+   }
+   m_bAbort = true;
+   m_pThread->Join();
+   delete m_pThread;
+   m_pThread = NULL;
+   m_bAbort  = false;
+}
+
+void CSWSimNLB::TestThread(OSLThread * /*pThread*/, void *pContext)
+{
+   CSWSimNLB *pThis = reinterpret_cast<CSWSimNLB *>(pContext);
+   pThis->Run();
+   pThis->m_bRunning = false;
+}
+
+//
+// Run. Perform the configured test and report it in the DSM.
+//
+void CSWSimNLB::Run()
+{
+   Timer start;
+
+   volatile nlb_vafu_dsm *pDSM = reinterpret_cast<volatile nlb_vafu_dsm *>(m_pHost->Translate(m_DSM, sizeof(nlb_vafu_dsm)));
+   if ( NULL == pDSM ) {
+      AAL_ERR(LM_ALI, "SWSim NLB: test started without a valid DSM base" << std::endl);
+      return;
+   }
+
+   const btUnsigned32bitInt Cfg   = CSR32(CSR_CFG);
+   const btUnsigned32bitInt Lines = CSR32(CSR_NUM_LINES);
+   const btWSSize           Bytes = (btWSSize)Lines * CL(1);
+   const btBool             Cont  = 0 != ( Cfg & NLB_TEST_MODE_CONT );
+   const btUnsigned32bitInt Mode  = Cfg & NLB_TEST_MODE_MASK;
+
+   // The SW mode also uses the line after the last for its flags.
+   const btWSSize Span = ( NLB_TEST_MODE_SW == Mode ) ? Bytes + CL(1) : Bytes;
+   btVirtAddr pSrc = m_pHost->Translate(CSR64(CSR_SRC_ADDR) << 6, Span);
+   btVirtAddr pDst = m_pHost->Translate(CSR64(CSR_DST_ADDR) << 6, Span);
+
+   btUnsigned32bitInt Reads  = 0;
+   btUnsigned32bitInt Writes = 0;
+   btUnsigned32bitInt Error  = 0;
+
+   btBool NeedSrc = ( NLB_TEST_MODE_WRITE != Mode );
+   btBool NeedDst = ( NLB_TEST_MODE_READ  != Mode );
+
+   if ( ( NeedSrc && ( NULL == pSrc ) ) || ( NeedDst && ( NULL == pDst ) ) ) {
+      AAL_ERR(LM_ALI, "SWSim NLB: source or destination is not in a shared buffer" << std::endl);
+      Error = NLB_ERR_RESPONSE;
+   } else {
+      volatile btUnsigned64bitInt sink = 0;
+      btUnsigned32bitInt          line;
+
+      switch ( Mode ) {
+         case NLB_TEST_MODE_LPBK1 :
+            do {
+               ::memcpy(pDst, pSrc, Bytes);
+               Reads  += Lines;
+               Writes += Lines;
+            } while ( Cont && !Halted() );
+         break;
+
+         case NLB_TEST_MODE_READ :
+            do {
+               btUnsigned64bitInt sum = 0;
+               btUnsigned64bitInt *p  = reinterpret_cast<btUnsigned64bitInt *>(pSrc);
+               btUnsigned64bitInt *e  = reinterpret_cast<btUnsigned64bitInt *>(pSrc + Bytes);
+               while ( p < e ) {
+                  sum += *p++;
+               }
+               sink   = sum;
+               Reads += Lines;
+            } while ( Cont && !Halted() );
+         break;
+
+         case NLB_TEST_MODE_WRITE :
+            do {
+               for ( line = 0 ; line < Lines ; ++line ) {
+                  ::memset(pDst + CL(line), (int)( line & 0xff ), CL(1));
+               }
+               Writes += Lines;
+            } while ( Cont && !Halted() );
+         break;
+
+         case NLB_TEST_MODE_TRPUT :
+            do {
+               ::memcpy(pDst, pSrc, Bytes);
+               Reads  += Lines;
+               Writes += Lines;
+            } while ( Cont && !Halted() );
+         break;
+
+         case NLB_TEST_MODE_SW :
+            Error = RunSW(pSrc, pDst, Bytes, Cfg, Reads, Writes);
+         break;
+
+         default :
+            AAL_ERR(LM_ALI, "SWSim NLB: test mode 0x" << std::hex << Mode << std::dec << " is not modelled" << std::endl);
+            Error = NLB_ERR_RESPONSE;
+         break;
+      }
+      (void)sink;
+   }
+
+   if ( m_bAbort ) {
+      return;
+   }
+
+   btUnsigned64bitInt ns = 0;
+   ( Timer() - start ).AsNanoSeconds(ns);
+   btUnsigned64bitInt clocks = ( ns * SWSIM_NLB_CLOCK_MHZ ) / 1000;
+
+   pDSM->num_reads      = Reads;
+   pDSM->num_writes     = Writes;
+   pDSM->num_clocks     = ( 0 == clocks ) ? 1 : clocks;
+   pDSM->start_overhead = 0;
+   pDSM->end_overhead   = 0;
+   pDSM->test_error     = Error;
+   __sync_synchronize();
+   pDSM->test_complete  = 1;
+}
+
+//
+// RunSW. Copy the lines, raise the flag at line N, wait for the host's notice,
+//        then read the lines back and check them.
+//
+btUnsigned32bitInt CSWSimNLB::RunSW(btVirtAddr          pSrc,
+                                    btVirtAddr          pDst,
+                                    btWSSize            Bytes,
+                                    btUnsigned32bitInt  Cfg,
+                                    btUnsigned32bitInt &Reads,
+                                    btUnsigned32bitInt &Writes)
+{
+   const btUnsigned32bitInt Lines = (btUnsigned32bitInt)( Bytes / CL(1) );
+
+   ::memcpy(pDst, pSrc, Bytes);
+   Reads  += Lines;
+   Writes += Lines;
+
+   __sync_synchronize();
+   *reinterpret_cast<volatile btUnsigned32bitInt *>(pDst + Bytes) = 0xffffffff;
+   ++Writes;
+
+   // Poll mode watches the first word of line N of the source for all ones, the UMsg modes
+   // watch UMsg 0 for any write.
+   const btUnsigned32bitInt     Notice = Cfg & NLB_TEST_MODE_NOTICE_MASK;
+   volatile btUnsigned32bitInt *pFlag  = NULL;
+
+   if ( NLB_TEST_MODE_UMSG_POLL == Notice ) {
+      pFlag = reinterpret_cast<volatile btUnsigned32bitInt *>(pSrc + Bytes);
+   } else if ( NLB_TEST_MODE_CSR_WRITE != Notice ) {
+      pFlag = reinterpret_cast<volatile btUnsigned32bitInt *>(m_pHost->UMsg(0));
+      if ( NULL == pFlag ) {
+         return NLB_ERR_RESPONSE;
+      }
+   }
+
+   while ( !Halted() ) {
+      if ( NLB_TEST_MODE_CSR_WRITE == Notice ) {
+         if ( m_bNotice ) {
+            break;
+         }
+      } else if ( NLB_TEST_MODE_UMSG_POLL == Notice ) {
+         if ( 0xffffffff == *pFlag ) {
+            ++Reads;
+            break;
+         }
+      } else if ( 0 != *pFlag ) {
+         break;
+      }
+      SleepZero();
+   }
+
+   __sync_synchronize();
+   Reads += Lines;
+   return ( 0 == ::memcmp(pSrc, pDst, Bytes) ) ? 0 : NLB_ERR_READBACK;
+}
+
+/// @} group ALI
+
+END_NAMESPACE(AAL)
@@ -0,0 +1,95 @@
+// Copyright(c) 2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+//****************************************************************************
+/// @file SWSimNLB.h
+/// @brief Native Loopback (NLB) model for the software simulation ALI.
+/// @ingroup ALI
+/// @verbatim
+/// Accelerator Abstraction Layer
+///
+/// CSWSimNLB follows the NLB CSR map and DSM layout of aalsdk/utils/NLBVAFU.h
+/// and runs the LPBK1, READ, WRITE, TRPUT and SW test modes against host
+/// memory at memory speed. A test runs on its own thread, started by writing
+/// 3 to CSR_CTL, so that continuous mode and the SW mode handshake behave as
+/// on the FPGA. num_clocks in the DSM counts the test's wall-clock time at
+/// SWSIM_NLB_CLOCK_MHZ, so bandwidths computed from it are those the model
+/// actually achieved.
+///
+/// Data written by WRITE and TRPUT differs from the RTL's, which fpgadiag does
+/// not check. Unsupported modes complete with test_error bit 0 set.@endverbatim
+//****************************************************************************
+#ifndef __SWSIMNLB_H__
+#define __SWSIMNLB_H__
+#include <aalsdk/osal/CriticalSection.h>
+#include <aalsdk/osal/Thread.h>
+#include <aalsdk/utils/NLBVAFU.h>
+
+#include "SWSimAFU.h"
+
+BEGIN_NAMESPACE(AAL)
+
+/// @addtogroup ALI
+/// @{
+
+/// Clock rate against which CSWSimNLB reports num_clocks.
+#define SWSIM_NLB_CLOCK_MHZ 400
+
+class CSWSimNLB : public CSWSimAFU,
+                  public CriticalSection
+{
+public:
+   CSWSimNLB(ISWSimHost *pHost, btUnsigned64bitInt AFUIdH, btUnsigned64bitInt AFUIdL);
+   virtual ~CSWSimNLB();
+
+   virtual void Reset();
+   virtual void CSRWrite(btCSROffset Offset, btUnsignedInt Width, btUnsigned64bitInt Value);
+
+protected:
+   void    Control(btUnsigned32bitInt Ctl);
+   void      Abort();
+   void        Run();
+   btBool   Halted() const { return m_bStop || m_bAbort; }
+   btUnsigned32bitInt RunSW(btVirtAddr pSrc, btVirtAddr pDst, btWSSize Bytes,
+                            btUnsigned32bitInt Cfg, btUnsigned32bitInt &Reads, btUnsigned32bitInt &Writes);
+
+   static void TestThread(OSLThread *pThread, void *pContext);
+
+   btUnsigned64bitInt m_AFUIdH;
+   btUnsigned64bitInt m_AFUIdL;
+   btPhysAddr         m_DSM;        // IOVA of the DSM, from CSR_AFU_DSM_BASEL/H
+   OSLThread         *m_pThread;    // The test in progress or last completed, until joined
+   volatile btBool    m_bRunning;   // m_pThread has not yet finished
+   volatile btBool    m_bStop;      // CSR_CTL stop: finish and report
+   volatile btBool    m_bAbort;     // Reset: finish without reporting
+   volatile btBool    m_bNotice;    // CSR_SW_NOTICE written
+};
+
+/// @}
+
+END_NAMESPACE(AAL)
+
+#endif // __SWSIMNLB_H__
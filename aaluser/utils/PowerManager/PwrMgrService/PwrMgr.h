@@ -165,6 +165,8 @@ public:
 
    }
 
+   virtual btObjectType Target() const { return dynamic_cast<btObjectType>(m_pSvcClient); }
+
 protected:
    IPwrMgr_Client                *m_pSvcClient;
    const IEvent                  *m_pEvent;
@@ -0,0 +1,212 @@
+// Copyright(c) 2014-2016, Intel Corporation
+//
+// Redistribution  and  use  in source  and  binary  forms,  with  or  without
+// modification, are permitted provided that the following conditions are met:
+//
+// * Redistributions of  source code  must retain the  above copyright notice,
+//   this list of conditions and the following disclaimer.
+// * Redistributions in binary form must reproduce the above copyright notice,
+//   this list of conditions and the following disclaimer in the documentation
+//   and/or other materials provided with the distribution.
+// * Neither the name  of Intel Corporation  nor the names of its contributors
+//   may be used to  endorse or promote  products derived  from this  software
+//   without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING,  BUT NOT LIMITED TO,  THE
+// IMPLIED WARRANTIES OF  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT  SHALL THE COPYRIGHT OWNER  OR CONTRIBUTORS BE
+// LIABLE  FOR  ANY  DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY,  OR
+// CONSEQUENTIAL  DAMAGES  (INCLUDING,  BUT  NOT LIMITED  TO,  PROCUREMENT  OF
+// SUBSTITUTE GOODS OR SERVICES;  LOSS OF USE,  DATA, OR PROFITS;  OR BUSINESS
+// INTERRUPTION)  HOWEVER CAUSED  AND ON ANY THEORY  OF LIABILITY,  WHETHER IN
+// CONTRACT,  STRICT LIABILITY,  OR TORT  (INCLUDING NEGLIGENCE  OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,  EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//****************************************************************************
+/// @file aallogdecode.cpp
+/// @brief Render a binary AAL log file as text.
+/// @ingroup aallogdecode
+/// @verbatim
+/// Accelerator Abstraction Layer Utility
+///
+/// AUTHORS: Intel Corporation.@endverbatim
+/**
+@addtogroup aallogdecode
+@{
+
+Decode a log file written by a CLogger whose destination is ILogger::BINFILE.
+
+@verbatim
+$ aallogdecode [--source] aal.bin@endverbatim
+
+Each message is printed with the same prepend string, level, [pid:tid] and
+timestamp decorations that the text destinations would have used, as selected
+by the logger settings in effect when the message was written. --source appends
+the file and line of the AAL_LOG() statement that logged the message.
+
+@}
+*/
+//****************************************************************************
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "aalsdk/AALTypes.h"
+#include "aalsdk/AALLogRecord.h"
+USING_NAMESPACE(AAL)
+
+static const char *LevelToString[] = {  // syslog levels 0-8, as CLogger prints them.
+   "EMERG ",
+   "ALERT ",
+   "CRITL ",
+   "ERROR ",
+   "WARNG ",
+   "NOTIC ",
+   "INFO  ",
+   "DEBUG ",
+   "VBOSE "
+};
+
+int main(int argc, char *argv[])
+{
+   btBool      bSource = false;
+   const char *pFile    = NULL;
+   int         i;
+
+   for ( i = 1 ; i < argc ; ++i ) {
+      if ( 0 == strcmp(argv[i], "--source") ) {
+         bSource = true;
+      } else if ( ( 0 == strcmp(argv[i], "--help") ) || ( NULL != pFile ) ) {
+         pFile = NULL;
+         break;
+      } else {
+         pFile = argv[i];
+      }
+   }
+
+   if ( NULL == pFile ) {
+      std::cerr << "Usage: " << argv[0] << " [--source] FILE" << std::endl;
+      return 1;
+   }
+
+   std::ifstream in(pFile, std::ios_base::in | std::ios_base::binary);
+   if ( !in.good() ) {
+      std::cerr << argv[0] << ": could not open " << pFile << std::endl;
+      return 1;
+   }
+
+   struct aal_log_file_header                hdr;
+   std::map<btUnsigned32bitInt, std::string> files;
+   std::string                               prepend;
+   btUnsigned16bitInt                        flags = 0;
+   std::vector<char>                         payload;
+   int                                       res   = 0;
+
+   memset(&hdr, 0, sizeof(hdr));
+
+   for ( ; ; ) {
+      union
+      {
+         struct aal_log_file_header hdr;
+         struct aal_log_record      rec;
+      } u;
+
+      // Records and file headers both start with a 32-bit word, and no record
+      //  starts with AAL_LOG_FILE_MAGIC. The logger appends, so a file may hold
+      //  the output of several runs, each starting with its own header.
+      if ( !in.read(reinterpret_cast<char *>(&u), sizeof(btUnsigned32bitInt)) ) {
+         break;
+      }
+
+      if ( AAL_LOG_FILE_MAGIC == u.hdr.magic ) {
+         if ( !in.read(reinterpret_cast<char *>(&u) + sizeof(btUnsigned32bitInt),
+                       sizeof(u.hdr) - sizeof(btUnsigned32bitInt)) ||
+              ( AAL_LOG_FILE_VERSION != u.hdr.version ) ) {
+            std::cerr << argv[0] << ": bad file header" << std::endl;
+            return 1;
+         }
+         hdr     = u.hdr;
+         files.clear();
+         prepend.clear();
+         flags   = AAL_LOG_CFG_PID | AAL_LOG_CFG_TIMESTAMP | AAL_LOG_CFG_LEVEL;
+         continue;
+      }
+
+      if ( AAL_LOG_FILE_MAGIC != hdr.magic ) {
+         std::cerr << argv[0] << ": " << pFile << " is not an AAL binary log" << std::endl;
+         return 1;
+      }
+
+      if ( !in.read(reinterpret_cast<char *>(&u) + sizeof(btUnsigned32bitInt),
+                    sizeof(u.rec) - sizeof(btUnsigned32bitInt)) ) {
+         std::cerr << argv[0] << ": truncated record" << std::endl;
+         return 1;
+      }
+
+      const struct aal_log_record &rec    = u.rec;
+      const size_t                 padded = AAL_LOG_REC_SIZE(rec.len) - sizeof(rec);
+
+      payload.resize(padded + 1);
+      if ( ( padded > 0 ) && !in.read(&payload[0], padded) ) {
+         std::cerr << argv[0] << ": truncated record" << std::endl;
+         return 1;
+      }
+      std::string text(&payload[0], rec.len);
+
+      switch ( rec.type ) {
+         case AAL_LOG_REC_CONFIG : {
+            flags   = rec.level;
+            prepend = text;
+         } break;
+
+         case AAL_LOG_REC_FILE : {
+            files[rec.fileid] = text;
+         } break;
+
+         case AAL_LOG_REC_MESSAGE : {
+            std::cout << prepend;
+            if ( ( flags & AAL_LOG_CFG_LEVEL ) &&
+                 ( rec.level < sizeof(LevelToString) / sizeof(LevelToString[0]) ) ) {
+               std::cout << LevelToString[rec.level];
+            }
+            if ( flags & AAL_LOG_CFG_PID ) {
+               std::cout << "[" << std::dec << hdr.pid << ":" << std::hex << std::showbase
+                         << std::setfill('0') << std::setw(10) << rec.tid
+                         << std::noshowbase << std::dec << std::setfill(' ') << "] ";
+            }
+            if ( flags & AAL_LOG_CFG_TIMESTAMP ) {
+               std::cout << std::setfill('0') << std::setw(4) << (rec.usec / 1000000) << ":"
+                         << std::setw(6) << (rec.usec % 1000000) << std::setfill(' ') << " ";
+            }
+            if ( bSource && ( 0 != rec.fileid ) ) {
+               btBool nl = false;
+               while ( !text.empty() && ( '\n' == text[text.length() - 1] ) ) {
+                  text.erase(text.length() - 1);
+                  nl = true;
+               }
+               std::cout << text << " (" << files[rec.fileid] << ":" << std::dec << rec.line << ")";
+               if ( nl ) {
+                  std::cout << std::endl;
+               }
+            } else {
+               std::cout << text;
+            }
+         } break;
+
+         default : {
+            std::cerr << argv[0] << ": unknown record type " << rec.type << std::endl;
+            res = 1;
+         } break;
+      }
+   }
+
+   return res;
+}
@@ -84,6 +84,7 @@ using namespace AAL;
 ////////////////////////////////////////////////////////////////////////////////
 
 #define AFU_RESET_FAIL 100
+#define CSR_SETUP_FAIL 101
 
 // CMyApp
 // Ugly hack so that Doxygen produces the correct class diagrams.
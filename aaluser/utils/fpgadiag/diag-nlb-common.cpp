@@ -49,7 +49,7 @@ BEGIN_C_DECLS
 
 struct option longopts[] = {
       {"help",                no_argument,       NULL, 'h'},
-      {"target",              required_argument, NULL, 't'}, //one of { fpga ase }
+      {"target",              required_argument, NULL, 't'}, //one of { fpga ase swsim }
       {"mode",                required_argument, NULL, 'm'}, //one of { lpbk1 read write trput sw }
       {"begin",               required_argument, NULL, 'b'},
       {"end",                 required_argument, NULL, 'e'},
@@ -116,6 +116,8 @@ int ParseCmds(struct NLBCmdLine *nlbcl, int argc, char *argv[])
                nlbcl->AFUTarget = std::string(ALIAFU_NVS_VAL_TARGET_FPGA);
             } else if ( 0 == strcasecmp("ase", tmp_optarg) ) {
                nlbcl->AFUTarget = std::string(ALIAFU_NVS_VAL_TARGET_ASE);
+            } else if ( 0 == strcasecmp("swsim", tmp_optarg) ) {
+               nlbcl->AFUTarget = std::string(ALIAFU_NVS_VAL_TARGET_SWSIM);
             } else {
                cout << "Invalid value for --target : " << tmp_optarg << endl;
                return CMD_PARSE_ERR;
@@ -434,7 +436,7 @@ void NLBShowHelp( struct NLBCmdLine *nlbcl ) {
 
    cout << endl << endl;
 
-   cout << "      <TARGET>        = --target=one of { fpga ase }  OR  -t=one of { fpga ase },                                  ";
+   cout << "      <TARGET>        = --target=one of { fpga ase swsim }  OR  -t=one of { fpga ase swsim },                            ";
    cout << "Default=fpga\n";
 
    cout << "      <BEGIN>         = --begin=B              OR  -b=B,    ";
@@ -100,23 +100,25 @@ btInt CNLBSW::RunTest(const NLBCmdLine &cmd)
     	m_pVTPService->vtpReset();
     }
 
-    //Set DSM base, high then low
-    m_pALIMMIOService->mmioWrite64(CSR_AFU_DSM_BASEL, m_pMyApp->DSMPhys());
-
-    // Assert Device Reset
-    m_pALIMMIOService->mmioWrite32(CSR_CTL, 0);
-
-    // De-assert Device Reset
-    m_pALIMMIOService->mmioWrite32(CSR_CTL, 1);
-
-    // Set input workspace address
-    m_pALIMMIOService->mmioWrite64(CSR_SRC_ADDR, CACHELINE_ALIGNED_ADDR(m_pMyApp->InputPhys()));
-
-    // Set output workspace address
-    m_pALIMMIOService->mmioWrite64(CSR_DST_ADDR, CACHELINE_ALIGNED_ADDR(m_pMyApp->OutputPhys()));
-
-    // Set the test mode
-    m_pALIMMIOService->mmioWrite32(CSR_CFG, 0);
+    const ali_mmio_access_t setup[] = {
+       //Set DSM base, high then low
+       { CSR_AFU_DSM_BASEL, ali_mmio_width64, m_pMyApp->DSMPhys()                                },
+       // Assert Device Reset
+       { CSR_CTL,           ali_mmio_width32, 0                                                  },
+       // De-assert Device Reset
+       { CSR_CTL,           ali_mmio_width32, 1                                                  },
+       // Set input workspace address
+       { CSR_SRC_ADDR,      ali_mmio_width64, CACHELINE_ALIGNED_ADDR(m_pMyApp->InputPhys())  },
+       // Set output workspace address
+       { CSR_DST_ADDR,      ali_mmio_width64, CACHELINE_ALIGNED_ADDR(m_pMyApp->OutputPhys()) },
+       // Set the test mode
+       { CSR_CFG,           ali_mmio_width32, 0                                                  }
+    };
+
+    if ( !m_pALIMMIOService->mmioWriteBatch(setup, sizeof(setup) / sizeof(setup[0])) ) {
+       ERR("CSR setup failed. Exiting test.");
+       return CSR_SETUP_FAIL;
+    }
     csr_type cfg = (csr_type)NLB_TEST_MODE_SW;
 
     if ( flag_is_set(cmd.cmdflags, NLB_CMD_FLAG_RDI)){
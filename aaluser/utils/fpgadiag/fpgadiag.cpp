@@ -408,13 +408,12 @@ void CMyApp::runtimeStarted(IRuntime            *pRT,
      ConfigRecord.Add(AAL_FACTORY_CREATE_CONFIGRECORD_FULL_SERVICE_NAME, "libALI");
      ConfigRecord.Add(AAL_FACTORY_CREATE_SOFTWARE_SERVICE,true);
 
-   }else if ( 0 == strcasecmp(AFUTarget().c_str(), "ALIAFUTarget_SWSIM") ) {
+   }else if ( 0 == strcasecmp(AFUTarget().c_str(), "ALIAFUTarget_SWSIM") ) {   // Use the in-process software model
 
-//      ConfigRecord.Add(AAL_FACTORY_CREATE_CONFIGRECORD_FULL_SERVICE_NAME, "libSWSimALIAFU");
-//      ConfigRecord.Add(AAL_FACTORY_CREATE_SOFTWARE_SERVICE,true);
+     Manifest.Add(ALIAFU_NVS_KEY_TARGET, ali_afu_swswim);
 
-      ERR("--target=swsim is unsupported in this release. Please choose one of 'ase' or 'fpga'.");
-      exit(1);
+     ConfigRecord.Add(AAL_FACTORY_CREATE_CONFIGRECORD_FULL_SERVICE_NAME, "libALI");
+     ConfigRecord.Add(AAL_FACTORY_CREATE_SOFTWARE_SERVICE,true);
    }
 
   	Manifest.Add(AAL_FACTORY_CREATE_CONFIGRECORD_INCLUDED, &ConfigRecord);
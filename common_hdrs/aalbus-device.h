@@ -226,14 +226,29 @@ ownerSess_Init(struct aaldev_ownerSession *pSess, btAny ownerContext)
 //=============================================================================
 // Name: ownerSess_Copy
 // Description: Copies an ownerSess object
+// Comments: The workspaces move to destSess. Each is tagged with the UI
+//           session of the owner session it is on (see aalsess_add_ws()),
+//           so the tags are refreshed from destSess.
 //=============================================================================
 static inline
 void
 ownerSess_Copy(struct aaldev_ownerSession *destSess,
                struct aaldev_ownerSession *srcSess)
 {
+   struct aal_wsid *pwsid;
+
    *destSess = *srcSess;
+
+   // Replacing an empty head would leave destSess pointing at srcSess.
+   if ( kosal_list_is_empty(&srcSess->m_wshead) ) {
+      kosal_list_init(&destSess->m_wshead);
+      return;
+   }
    kosal_list_replace_init(&srcSess->m_wshead, &destSess->m_wshead);
+
+   kosal_list_for_each_entry(pwsid, &destSess->m_wshead, m_list, struct aal_wsid) {
+      pwsid->m_UIHandle = aalsess_uiHandle(destSess);
+   }
 }
 
 //=============================================================================
@@ -130,6 +130,7 @@ struct aal_wsid
    enum wstype        m_type;       // Type of allocation
    btWSSize           m_size;       // Size of workspace
    kosal_list_head    m_list;       // Device owner list it is on
+   btObjectType       m_UIHandle;   // UI session of the owner list it is on
    /* chain of allocated workspace IDs; head is in ui_driver */
    kosal_list_head    m_alloc_list;
 };
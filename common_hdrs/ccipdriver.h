@@ -217,6 +217,7 @@ struct aalui_CCIdrvMessage
 # define AALUID_IOCTL_BINDDEV       _IOWR('x', 0x03, struct ccipui_ioctlreq)
 # define AALUID_IOCTL_ACTIVATEDEV   _IOWR('x', 0x04, struct ccipui_ioctlreq)
 # define AALUID_IOCTL_DEACTIVATEDEV _IOWR('x', 0x05, struct ccipui_ioctlreq)
+# define AALUID_IOCTL_GETMSGS       _IOWR('x', 0x08, struct ccipui_ioctlreq)
 #elif defined( __AAL_WINDOWS__ )
 # ifdef __AAL_USER__
 #    include <winioctl.h>
@@ -251,6 +252,7 @@ struct aalui_CCIdrvMessage
 # define AALUID_IOCTL_DEACTIVATEDEV   UAIA_IOCTL(0x05)
 # define AALUID_IOCTL_POLL            UAIA_IOCTL(0x06)
 # define AALUID_IOCTL_MMAP            UAIA_IOCTL(0x07)
+# define AALUID_IOCTL_GETMSGS         UAIA_IOCTL(0x08)
 
 #endif // OS
 
@@ -275,6 +277,25 @@ struct ccipui_ioctlreq
 #define aalui_ioctlPayload(i)    ((void *)(i->payload))
 #define aalui_ioctlPayloadSize(i)   ((i)->size)
 
+//=============================================================================
+// Name: ccipui_msgbatch
+// Description: AALUID_IOCTL_GETMSGS response payload. Followed by as many
+//              queued messages as fit in the caller's payload buffer, each a
+//              ccipui_ioctlreq header followed by its payload. The first
+//              starts sizeof(struct ccipui_msgbatch) bytes in, each next one
+//              on a ccipui_msgrec_size() boundary.
+//=============================================================================
+struct ccipui_msgbatch
+{
+   btUnsigned32bitInt count;        // Number of message records that follow [OUT]
+   btUnsigned32bitInt rsvd;
+   btWSSize           needed;       // When count is 0, buffer payload size needed for the next message [OUT]
+};
+
+// Space taken after ccipui_msgbatch by a message with the given payload size.
+#define ccipui_msgrec_size(__payloadsize) \
+   ((sizeof(struct ccipui_ioctlreq) + (btWSSize)(__payloadsize) + 7) & ~((btWSSize)7))
+
 
 struct ahm_req
 {
@@ -344,12 +365,14 @@ typedef enum
 {
    ReConf_Action_Honor_request  =0x0,
    ReConf_Action_Honor_Owner    =0x1,
+   ReConf_Action_Stream         =0x40,    // Push from the caller's pinned pages instead of a kernel copy
    ReConf_Action_InActive       =0x80
 }aalconf_reconfig_action_e;
 
-// Mask off Inactive Flag
-#define RECONF_ACTION_HONOR_PARAMETER(p)    (p & (btUnsigned64bitInt)~(ReConf_Action_InActive))
+// Mask off Inactive and Stream Flags
+#define RECONF_ACTION_HONOR_PARAMETER(p)    (p & (btUnsigned64bitInt)~(ReConf_Action_InActive | ReConf_Action_Stream))
 #define RECONF_ACTION_ACTIVATE_PARAMETER(p) (p & ReConf_Action_InActive)
+#define RECONF_ACTION_STREAM_PARAMETER(p)   (p & ReConf_Action_Stream)
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
@@ -403,6 +426,19 @@ struct aalui_AFUResponse
 };
 #define aalui_AFURespPayload(__ptr) ( ((btVirtAddr)(__ptr)) + sizeof(struct aalui_AFUResponse) )
 
+//=============================================================================
+// Name: aalui_PRTimings
+// Description: Payload of a uid_afurespConfigureComplete response. Time spent
+//              in each phase of the partial reconfiguration, in nanoseconds.
+//=============================================================================
+struct aalui_PRTimings
+{
+   btUnsigned64bitInt  load_ns;     // Bringing the bitstream into the kernel (copy or pin)
+   btUnsigned64bitInt  push_ns;     // Pushing the bitstream to FME_PR_DATA
+   btUnsigned64bitInt  wait_ns;     // Waiting for the PR engine to complete
+   btUnsigned64bitInt  bytes;       // Bitstream bytes pushed
+};
+
 
 //=============================================================================
 // Name: aalui_PREvent
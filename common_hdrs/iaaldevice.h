@@ -375,7 +375,12 @@ struct aaldev_ownerSession {
 #define aalsess_aalpipp(os)         (aaldev_pipp( aalsess_aaldevicep(os) ) )
 #define aalsess_pipHandle(os)       ((os)->m_PIPHandle)
 #define aalsess_uiHandle(os)        ((os)->m_UIHandle)
-#define aalsess_add_ws(os,ih)       kosal_list_add_head(&ih, &(os)->m_wshead);
+#define aalsess_add_ws(os,pwsid)    do { (pwsid)->m_UIHandle = (os)->m_UIHandle;                \
+                                         kosal_list_add_head(&(pwsid)->m_list, &(os)->m_wshead); \
+                                    } while(0)
+#define aalsess_del_ws(pwsid)       do { kosal_list_del_init(&(pwsid)->m_list);                 \
+                                         (pwsid)->m_UIHandle = NULL;                            \
+                                    } while(0)
 
 //=============================================================================
 // Name: aaldevice_interface
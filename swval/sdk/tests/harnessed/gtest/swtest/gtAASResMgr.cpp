@@ -6,12 +6,125 @@
 
 #include <aalsdk/rm/InstanceRecord.h>
 
-TEST(AASResMgr, coverage_placeholder)
+// Builds configuration update events for InstRecMap tests.
+static aalrms_configUpDateEvent MakeConfigUpdate(btUnsigned64bitInt AFUIDl,
+                                                 btUnsigned32bitInt Bus,
+                                                 btUnsigned16bitInt Function,
+                                                 btUnsigned16bitInt SubDev,
+                                                 aal_device_type_e  Type=aal_devtypeAFU,
+                                                 btUnsignedInt      MaxOwners=1)
 {
-   // This test ensures that some .gcda file is generated in aas/AASResourceManager/.libs
-   // to appease the coverage analysis scripts. When proper ULT's are added, this
-   // test can be replaced.
+   aalrms_configUpDateEvent e;
+   memset(&e, 0, sizeof(e));
+   e.id                                        = krms_ccfgUpdate_DevAdded;
+   e.devattrs.Handle                           = reinterpret_cast<void *>(0x1000 + SubDev);
+   e.devattrs.maxOwners                        = MaxOwners;
+   e.devattrs.devid.m_devicetype               = Type;
+   e.devattrs.devid.m_afuGUIDh                 = 0x1122334455667788ULL;
+   e.devattrs.devid.m_afuGUIDl                 = AFUIDl;
+   e.devattrs.devid.m_devaddr.m_bustype        = aal_bustype_PCIe;
+   e.devattrs.devid.m_devaddr.m_busnum         = Bus;
+   e.devattrs.devid.m_devaddr.m_functnum       = Function;
+   e.devattrs.devid.m_devaddr.m_subdevnum      = SubDev;
+   return e;
+}
+
+TEST(AASResMgr, aal0861)
+{
+   // InstRecMap keeps its AFU_ID, bus/device/function and state indices current
+   // through Add(), ReplaceStruct(), Increment/DecrementAllocations() and Delete().
 
    InstRecMap m;
+
+   aalrms_configUpDateEvent a0  = MakeConfigUpdate(0xa, 0x5e, 0, 0);
+   aalrms_configUpDateEvent a1  = MakeConfigUpdate(0xa, 0x5e, 0, 1);
+   aalrms_configUpDateEvent b   = MakeConfigUpdate(0xb, 0x5e, 1, 2);
+   aalrms_configUpDateEvent dev = MakeConfigUpdate(0xc, 0x5f, 0, 3, aal_devtypeAHM);
+
+   InstRec ra0(&a0);
+   InstRec ra1(&a1);
+   InstRec rb(&b);
+   InstRec rdev(&dev);
+
+   EXPECT_TRUE(m.Add(ra0));
+   EXPECT_TRUE(m.Add(ra1));
+   EXPECT_TRUE(m.Add(rb));
+   EXPECT_TRUE(m.Add(rdev));
+   EXPECT_FALSE(m.Add(ra0));
+
+   const std::string idA = AFU_IDNameFromConfigStruct(a0);
+   const std::string idB = AFU_IDNameFromConfigStruct(b);
+   EXPECT_EQ(idA, ra0.AFU_ID());
+
+   EXPECT_EQ(2, m.ByAFU_ID(idA).size());
+   EXPECT_EQ(1, m.ByAFU_ID(idB).size());
+   EXPECT_TRUE(m.ByAFU_ID("no-such-afu").empty());
+
+   EXPECT_EQ(2, m.ByPCIAddress(0x5e, 0, 0).size());
+   EXPECT_EQ(1, m.ByPCIAddress(0x5e, 0, 1).count(rb.InstanceIndex()));
+   EXPECT_TRUE(m.ByPCIAddress(0x5e, 0, 7).empty());
+
+   // Only AFUs with room for another allocation are allocatable.
+   EXPECT_EQ(3, m.Allocatable().size());
+   EXPECT_EQ(0, m.Allocatable().count(rdev.InstanceIndex()));
+
+   EXPECT_TRUE(m.IncrementAllocations(ra0.InstanceIndex()));
+   EXPECT_EQ(0, m.Allocatable().count(ra0.InstanceIndex()));
+   EXPECT_FALSE(m.IncrementAllocations(ra0.InstanceIndex()));
+   EXPECT_TRUE(m.DecrementAllocations(ra0.InstanceIndex()));
+   EXPECT_EQ(1, m.Allocatable().count(ra0.InstanceIndex()));
+   EXPECT_FALSE(m.IncrementAllocations(0xdeadbeef));
+
+   // Reconfiguring a1 to AFU B moves it between the AFU_ID sets and drops its cached NVS.
+   pInstRec_t p = NULL;
+   ASSERT_TRUE(m.Get(ra1.InstanceIndex(), &p));
+   NamedValueSet nvs;
+   nvs.Add("cached", true);
+   p->InstRecNVS(nvs);
+   EXPECT_TRUE(p->HasInstRecNVS());
+
+   aalrms_configUpDateEvent a1b = a1;
+   a1b.devattrs.devid.m_afuGUIDl = 0xb;
+   EXPECT_TRUE(m.ReplaceStruct(ra1.InstanceIndex(), &a1b));
+   EXPECT_FALSE(p->HasInstRecNVS());
+   EXPECT_EQ(idB, p->AFU_ID());
+   EXPECT_EQ(1, m.ByAFU_ID(idA).size());
+   EXPECT_EQ(2, m.ByAFU_ID(idB).size());
+
+   // A record with another device address is not replaced.
+   EXPECT_FALSE(m.ReplaceStruct(ra1.InstanceIndex(), &b));
+   EXPECT_EQ(2, m.ByAFU_ID(idB).size());
+
+   m.Delete(rb.InstanceIndex());
+   EXPECT_EQ(1, m.ByAFU_ID(idB).size());
+   EXPECT_TRUE(m.ByPCIAddress(0x5e, 0, 1).empty());
+   EXPECT_EQ(2, m.Allocatable().size());
+
+   m.Delete(ra0.InstanceIndex());
+   EXPECT_TRUE(m.ByAFU_ID(idA).empty());
 }
 
+TEST(AASResMgr, aal0862)
+{
+   // A NamedValueSet built from a payload buffer accepts the binary form sent by
+   // the Resource Manager client and the text form sent by older clients.
+
+   NamedValueSet config;
+   config.Add(keyRegAFU_ID, "C000C966-0D82-4272-9AEF-FE5F84570612");
+   config.Add(keyRegBusNumber, (btUnsigned32bitInt)0x5e);
+
+   NamedValueSet manifest;
+   manifest.Add(AAL_FACTORY_CREATE_CONFIGRECORD_INCLUDED, &config);
+   manifest.Add(keyRegHandle, reinterpret_cast<btObjectType>(0x1234));
+
+   std::string bin;
+   EXPECT_EQ(ENamedValuesOK, manifest.WriteBinary(bin));
+   std::string txt(manifest);
+
+   NamedValueSet fromBin(const_cast<char *>(bin.data()), bin.length());
+   NamedValueSet fromTxt(const_cast<char *>(txt.data()), txt.length());
+
+   EXPECT_TRUE(manifest == fromBin);
+   EXPECT_TRUE(manifest == fromTxt);
+   EXPECT_LT(bin.length(), txt.length());
+}
@@ -0,0 +1,258 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/osal/Timer.h"
+#include "ALIBufferIndex.h"
+#include <iomanip>
+
+// Workspaces are 2MB, placed on a 4MB stride so that every other 2MB range is a hole.
+#define BUFIDX_WS_SIZE   (2 * 1024 * 1024)
+#define BUFIDX_WS_STRIDE (2 * BUFIDX_WS_SIZE)
+#define BUFIDX_VA_BASE   ((btUnsigned64bitInt)0x7f0000000000ULL)
+#define BUFIDX_PA_BASE   ((btUnsigned64bitInt)0x0000100000000ULL)
+
+// Exposes the number of replaced tables not yet freed, and lets a test hold a read open.
+class CALIBufferIndexPeek : public CALIBufferIndex
+{
+public:
+   btUnsignedInt Unreclaimed()
+   {
+      AutoLock(this);
+      return (btUnsignedInt)( m_Retired.size() + m_Waiting.size() );
+   }
+
+   void *  BeginRead()          { return new ReadGuard(this);                 }
+   void      EndRead(void *pRd) { delete reinterpret_cast<ReadGuard *>(pRd); }
+};
+
+class ALIBufferIndex_f : public ::testing::Test
+{
+public:
+   ALIBufferIndex_f() {}
+
+   virtual void SetUp()
+   {
+      m_pIndex = new CALIBufferIndexPeek();
+      m_Stop   = false;
+      m_Errors = 0;
+   }
+
+   virtual void TearDown()
+   {
+      delete m_pIndex;
+   }
+
+   static btVirtAddr VA(btUnsignedInt i) { return (btVirtAddr)(BUFIDX_VA_BASE + (btUnsigned64bitInt)i * BUFIDX_WS_STRIDE); }
+   static btPhysAddr PA(btUnsignedInt i) { return (btPhysAddr)(BUFIDX_PA_BASE + (btUnsigned64bitInt)i * BUFIDX_WS_SIZE);   }
+
+   void AddWkSpc(btUnsignedInt i)
+   {
+      struct aalui_WSMParms parms;
+      memset(&parms, 0, sizeof(parms));
+      parms.wsid    = (btWSID)i + 1;
+      parms.ptr     = VA(i);
+      parms.physptr = PA(i);
+      parms.size    = BUFIDX_WS_SIZE;
+      EXPECT_TRUE(m_pIndex->Add(parms));
+   }
+
+   // Translates random addresses in workspaces [0, m_StableCount) until told to stop.
+   static void Reader(OSLThread *pThread, void *pContext)
+   {
+      ALIBufferIndex_f *pFixture = reinterpret_cast<ALIBufferIndex_f *>(pContext);
+      ASSERT_NONNULL(pFixture);
+
+      btUnsignedInt seed = 1;
+      while ( !pFixture->m_Stop ) {
+         seed = seed * 1103515245 + 12345;
+         btUnsignedInt i   = (seed >> 8) % pFixture->m_StableCount;
+         btUnsignedInt off = seed % BUFIDX_WS_SIZE;
+
+         if ( pFixture->m_pIndex->GetIOVA(VA(i) + off) != PA(i) + off ) {
+            ++pFixture->m_Errors;
+         }
+      }
+   }
+
+   CALIBufferIndexPeek *m_pIndex;
+   volatile btBool      m_Stop;
+   volatile btInt       m_Errors;
+   btUnsignedInt        m_StableCount;
+};
+
+TEST_F(ALIBufferIndex_f, aal0822)
+{
+   // CALIBufferIndex::GetIOVA() translates any address within a recorded workspace, including
+   // its first and last bytes, and returns 0 for addresses before, between and after workspaces.
+
+   const btUnsignedInt N = 64;
+   btUnsignedInt i;
+
+   EXPECT_EQ(0, m_pIndex->GetIOVA(VA(0)));
+
+   // Add out of order to exercise the sorted insert.
+   for ( i = 0 ; i < N ; i += 2 ) {
+      AddWkSpc(i);
+   }
+   for ( i = 1 ; i < N ; i += 2 ) {
+      AddWkSpc(i);
+   }
+   EXPECT_EQ(N, m_pIndex->Size());
+
+   for ( i = 0 ; i < N ; ++i ) {
+      EXPECT_EQ(PA(i),                        m_pIndex->GetIOVA(VA(i)));
+      EXPECT_EQ(PA(i) + 0x1234,               m_pIndex->GetIOVA(VA(i) + 0x1234));
+      EXPECT_EQ(PA(i) + BUFIDX_WS_SIZE - 1,   m_pIndex->GetIOVA(VA(i) + BUFIDX_WS_SIZE - 1));
+      EXPECT_EQ(0,                            m_pIndex->GetIOVA(VA(i) + BUFIDX_WS_SIZE));
+   }
+
+   EXPECT_EQ(0, m_pIndex->GetIOVA(VA(0) - 1));
+   EXPECT_EQ(0, m_pIndex->GetIOVA(VA(N)));
+}
+
+TEST_F(ALIBufferIndex_f, aal0823)
+{
+   // CALIBufferIndex::Add() rejects a duplicate start address. Remove() and Find() operate on
+   // exact start addresses only, and a removed workspace no longer translates.
+
+   struct aalui_WSMParms parms;
+
+   AddWkSpc(0);
+   AddWkSpc(1);
+
+   memset(&parms, 0, sizeof(parms));
+   parms.ptr  = VA(1);
+   parms.size = 4096;
+   EXPECT_FALSE(m_pIndex->Add(parms));
+
+   EXPECT_FALSE(m_pIndex->Find(VA(1) + 1, &parms));
+   EXPECT_TRUE(m_pIndex->Find(VA(1), &parms));
+   EXPECT_EQ(2, parms.wsid);
+
+   EXPECT_FALSE(m_pIndex->Remove(VA(1) + 1));
+   memset(&parms, 0, sizeof(parms));
+   EXPECT_TRUE(m_pIndex->Remove(VA(1), &parms));
+   EXPECT_EQ(PA(1), parms.physptr);
+   EXPECT_FALSE(m_pIndex->Remove(VA(1)));
+
+   EXPECT_EQ(0,     m_pIndex->GetIOVA(VA(1) + 8));
+   EXPECT_EQ(PA(0), m_pIndex->GetIOVA(VA(0)));
+   EXPECT_EQ(1,     m_pIndex->Size());
+}
+
+TEST_F(ALIBufferIndex_f, aal0824)
+{
+   // Lock-free readers translating a stable set of workspaces always see correct results
+   // while a writer concurrently adds and removes other workspaces.
+
+   const btUnsignedInt Readers = 4;
+   const btUnsignedInt Churn   = 256;
+   btUnsignedInt i;
+   btUnsignedInt r;
+
+   m_StableCount = 32;
+   for ( i = 0 ; i < m_StableCount ; ++i ) {
+      AddWkSpc(i);
+   }
+
+   OSLThread *pThrs[Readers];
+   for ( r = 0 ; r < Readers ; ++r ) {
+      pThrs[r] = new OSLThread(ALIBufferIndex_f::Reader, OSLThread::THREADPRIORITY_NORMAL, this);
+      EXPECT_TRUE(pThrs[r]->IsOK());
+   }
+
+   for ( r = 0 ; r < 20 ; ++r ) {
+      for ( i = m_StableCount ; i < m_StableCount + Churn ; ++i ) {
+         AddWkSpc(i);
+      }
+      for ( i = m_StableCount ; i < m_StableCount + Churn ; ++i ) {
+         EXPECT_TRUE(m_pIndex->Remove(VA(i)));
+      }
+   }
+
+   m_Stop = true;
+   for ( r = 0 ; r < Readers ; ++r ) {
+      pThrs[r]->Join();
+      delete pThrs[r];
+   }
+
+   EXPECT_EQ(0, m_Errors);
+   EXPECT_EQ(m_StableCount, m_pIndex->Size());
+}
+
+TEST_F(ALIBufferIndex_f, aal0825)
+{
+   // Microbenchmark: single-thread CALIBufferIndex::GetIOVA() translations/sec vs. workspace count.
+   // Lookups use interior addresses, the case that previously fell back to a linear walk.
+
+   const btUnsignedInt Counts[] = { 1, 16, 128, 512, 2048 };
+   const btUnsignedInt Lookups  = 1000000;
+
+   btUnsignedInt c;
+   btUnsignedInt i;
+   btUnsignedInt added = 0;
+
+   for ( c = 0 ; c < sizeof(Counts) / sizeof(Counts[0]) ; ++c ) {
+
+      for ( ; added < Counts[c] ; ++added ) {
+         AddWkSpc(added);
+      }
+
+      btUnsignedInt  seed = 1;
+      btPhysAddr     sum  = 0;
+      Timer          start;
+
+      for ( i = 0 ; i < Lookups ; ++i ) {
+         seed = seed * 1103515245 + 12345;
+         sum += m_pIndex->GetIOVA(VA((seed >> 8) % added) + (seed % BUFIDX_WS_SIZE));
+      }
+
+      Timer  elapsed = Timer() - start;
+      double secs    = 0.0;
+      elapsed.AsSeconds(secs);
+
+      EXPECT_NE(0, sum);
+      std::cout << "[ BENCHMARK] " << std::setw(5) << added << " buffers : "
+                << std::fixed << std::setprecision(0)
+                << ( (secs > 0.0) ? ((double)Lookups / secs) : 0.0 )
+                << " translations/sec" << std::endl;
+   }
+}
+
+
+TEST_F(ALIBufferIndex_f, aal0871)
+{
+   // Replaced tables are reclaimed while lock-free reads are continuously in flight, not only
+   // when the writer happens to find no read at all, and none are left once reads stop.
+
+   const btUnsignedInt Churn = 1024;
+   btUnsignedInt i;
+   btUnsignedInt most = 0;
+
+   // Each read starts before the previous one ends, so every write sees one in flight.
+   void *pRead = m_pIndex->BeginRead();
+   for ( i = 0 ; i < Churn ; ++i ) {
+      void *pNext = m_pIndex->BeginRead();
+      m_pIndex->EndRead(pRead);
+      pRead = pNext;
+
+      AddWkSpc(i);
+      most = std::max(most, m_pIndex->Unreclaimed());
+   }
+
+   // A read that stays open holds back reclamation until it ends.
+   const btUnsignedInt held = m_pIndex->Unreclaimed();
+   for ( i = 0 ; i < Churn ; ++i ) {
+      EXPECT_TRUE(m_pIndex->Remove(VA(i)));
+   }
+   EXPECT_GT(m_pIndex->Unreclaimed(), held);
+   m_pIndex->EndRead(pRead);
+
+   EXPECT_LE(most, 4);
+
+   AddWkSpc(0);
+   EXPECT_EQ(0, m_pIndex->Unreclaimed());
+   EXPECT_EQ(PA(0) + 8, m_pIndex->GetIOVA(VA(0) + 8));
+}
@@ -0,0 +1,298 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/osal/Timer.h"
+#include "ALIBufferPool.h"
+#include <iomanip>
+
+// IALIBuffer backend that hands out page-aligned heap memory with a fake IOVA,
+//  counting the (expensive, in real life) bufferAllocate() calls.
+class FakeALIBuffer : public IALIBuffer
+{
+public:
+   FakeALIBuffer() :
+      m_Allocs(0),
+      m_Frees(0),
+      m_NextIOVA(0x100000000ULL)
+   {}
+
+   virtual AAL::ali_errnum_e bufferAllocate( btWSSize Length, btVirtAddr *pBufferptr )
+   {
+      void *p = NULL;
+      if ( 0 != posix_memalign(&p, 4096, Length) ) {
+         return ali_errnumNoMem;
+      }
+
+      struct aalui_WSMParms parms;
+      memset(&parms, 0, sizeof(parms));
+      parms.ptr     = (btVirtAddr)p;
+      parms.physptr = m_NextIOVA;
+      parms.size    = Length;
+      m_NextIOVA   += (Length + 4095) & ~4095ULL;
+      m_Index.Add(parms);
+
+      ++m_Allocs;
+      *pBufferptr = (btVirtAddr)p;
+      return ali_errnumOK;
+   }
+   virtual AAL::ali_errnum_e bufferAllocate( btWSSize Length, btVirtAddr *pBufferptr, NamedValueSet const & )
+   { return bufferAllocate(Length, pBufferptr); }
+   virtual AAL::ali_errnum_e bufferAllocate( btWSSize Length, btVirtAddr *pBufferptr, NamedValueSet const & , NamedValueSet & )
+   { return bufferAllocate(Length, pBufferptr); }
+
+   virtual AAL::ali_errnum_e bufferFree( btVirtAddr Address )
+   {
+      if ( !m_Index.Remove(Address) ) {
+         return ali_errnumBadParameter;
+      }
+      ++m_Frees;
+      free(Address);
+      return ali_errnumOK;
+   }
+
+   virtual btPhysAddr bufferGetIOVA( btVirtAddr Address ) { return m_Index.GetIOVA(Address); }
+
+   btUnsignedInt      m_Allocs;
+   btUnsignedInt      m_Frees;
+   btPhysAddr         m_NextIOVA;
+   CALIBufferIndex    m_Index;
+};
+
+class ALIBufferPool_f : public ::testing::Test
+{
+public:
+   ALIBufferPool_f() {}
+
+   virtual void SetUp()
+   {
+      m_pBackend = new FakeALIBuffer();
+      m_pPool    = new CALIBufferPool(m_pBackend);
+      m_Errors   = 0;
+   }
+
+   virtual void TearDown()
+   {
+      delete m_pPool;
+      EXPECT_EQ(m_pBackend->m_Allocs, m_pBackend->m_Frees);
+      delete m_pBackend;
+   }
+
+   btUnsigned64bitInt Stat(btcString Key)
+   {
+      NamedValueSet      nvs;
+      btUnsigned64bitInt val = 0;
+      EXPECT_TRUE(m_pPool->bufferPoolGetStats(nvs));
+      EXPECT_EQ(ENamedValuesOK, nvs.Get(Key, &val));
+      return val;
+   }
+
+   // Allocate / touch / free loop, run concurrently from several threads.
+   static void Churn(OSLThread *pThread, void *pContext)
+   {
+      ALIBufferPool_f *pFixture = reinterpret_cast<ALIBufferPool_f *>(pContext);
+      ASSERT_NONNULL(pFixture);
+
+      btVirtAddr    bufs[16];
+      btUnsignedInt i;
+      btUnsignedInt j;
+
+      for ( i = 0 ; i < 2000 ; ++i ) {
+         for ( j = 0 ; j < 16 ; ++j ) {
+            btPhysAddr iova = 0;
+            if ( ali_errnumOK != pFixture->m_pPool->bufferPoolAllocate(64 << (j % 8), &bufs[j], &iova) ) {
+               ++pFixture->m_Errors;
+               bufs[j] = NULL;
+               continue;
+            }
+            memset(bufs[j], (int)j, 64);
+            if ( iova != pFixture->m_pBackend->bufferGetIOVA(bufs[j]) ) {
+               ++pFixture->m_Errors;
+            }
+         }
+         for ( j = 0 ; j < 16 ; ++j ) {
+            if ( ( NULL != bufs[j] ) && ( (btUnsignedInt)(btByte)bufs[j][0] != j ) ) {
+               ++pFixture->m_Errors;
+            }
+            if ( ( NULL != bufs[j] ) && ( ali_errnumOK != pFixture->m_pPool->bufferPoolFree(bufs[j]) ) ) {
+               ++pFixture->m_Errors;
+            }
+         }
+      }
+   }
+
+   FakeALIBuffer     *m_pBackend;
+   CALIBufferPool    *m_pPool;
+   volatile btInt     m_Errors;
+};
+
+TEST_F(ALIBufferPool_f, aal0826)
+{
+   // CALIBufferPool::bufferPoolAllocate() rounds up to a cache-line aligned size class, returns the
+   // chunk's IOVA, and reuses freed chunks without going back to the backend.
+
+   btVirtAddr a = NULL;
+   btVirtAddr b = NULL;
+   btPhysAddr iova = 0;
+
+   EXPECT_EQ(ali_errnumBadParameter, m_pPool->bufferPoolAllocate(0, &a));
+   EXPECT_EQ(ali_errnumBadParameter, m_pPool->bufferPoolAllocate(64, NULL));
+
+   ASSERT_EQ(ali_errnumOK, m_pPool->bufferPoolAllocate(100, &a, &iova));
+   EXPECT_EQ(0, (btUnsigned64bitInt)a % 64);
+   EXPECT_EQ(m_pBackend->bufferGetIOVA(a), iova);
+   EXPECT_EQ(1, m_pBackend->m_Allocs);
+
+   ASSERT_EQ(ali_errnumOK, m_pPool->bufferPoolAllocate(128, &b));
+   EXPECT_NE(a, b);
+   EXPECT_EQ(0, (btUnsigned64bitInt)(b - a) % 128);  // Same 128-byte class, carved from the same slab.
+   EXPECT_EQ(1, m_pBackend->m_Allocs);
+
+   EXPECT_EQ(ali_errnumOK, m_pPool->bufferPoolFree(b));
+   EXPECT_EQ(ali_errnumOK, m_pPool->bufferPoolFree(a));
+
+   btVirtAddr c = NULL;
+   ASSERT_EQ(ali_errnumOK, m_pPool->bufferPoolAllocate(120, &c));
+   EXPECT_EQ(a, c);        // LIFO reuse of the calling thread's free list.
+   EXPECT_EQ(ali_errnumOK, m_pPool->bufferPoolFree(c));
+
+   EXPECT_EQ(1, m_pBackend->m_Allocs);
+   EXPECT_EQ(1, Stat(ALI_BUFFPOOL_STAT_MISSES));
+   EXPECT_EQ(2, Stat(ALI_BUFFPOOL_STAT_HITS));
+   EXPECT_EQ(0, Stat(ALI_BUFFPOOL_STAT_BYTES_INUSE));
+   EXPECT_EQ((28 + 0 + 8), Stat(ALI_BUFFPOOL_STAT_ROUNDING_WASTE));
+   EXPECT_EQ(100, Stat(ALI_BUFFPOOL_STAT_FRAGMENTATION));
+}
+
+TEST_F(ALIBufferPool_f, aal0827)
+{
+   // Requests larger than the largest size class pass through to the backend, and are
+   // returned to it by bufferPoolFree(). Foreign and misaligned addresses are rejected.
+
+   btVirtAddr big   = NULL;
+   btVirtAddr small = NULL;
+   btWSSize   len   = (((btWSSize)1) << CALIBufferPool::MaxClassShift) + 1;
+
+   ASSERT_EQ(ali_errnumOK, m_pPool->bufferPoolAllocate(len, &big));
+   EXPECT_EQ(1, m_pBackend->m_Allocs);
+   EXPECT_EQ(len, Stat(ALI_BUFFPOOL_STAT_BYTES_INUSE));
+
+   ASSERT_EQ(ali_errnumOK, m_pPool->bufferPoolAllocate(4096, &small));
+   EXPECT_EQ(ali_errnumBadParameter, m_pPool->bufferPoolFree(small + 64));
+   EXPECT_EQ(ali_errnumBadParameter, m_pPool->bufferPoolFree(big + 64));
+
+   char foreign[64];
+   EXPECT_EQ(ali_errnumBadParameter, m_pPool->bufferPoolFree((btVirtAddr)foreign));
+
+   EXPECT_EQ(ali_errnumOK, m_pPool->bufferPoolFree(big));
+   EXPECT_EQ(1, m_pBackend->m_Frees);
+   EXPECT_EQ(ali_errnumOK, m_pPool->bufferPoolFree(small));
+}
+
+TEST_F(ALIBufferPool_f, aal0828)
+{
+   // Concurrent allocate / free from several threads hands out distinct, correctly
+   // translated chunks, and steady-state churn is served without new slabs.
+
+   const btUnsignedInt Threads = 4;
+   btUnsignedInt t;
+   OSLThread *pThrs[Threads];
+
+   for ( t = 0 ; t < Threads ; ++t ) {
+      pThrs[t] = new OSLThread(ALIBufferPool_f::Churn, OSLThread::THREADPRIORITY_NORMAL, this);
+      EXPECT_TRUE(pThrs[t]->IsOK());
+   }
+   for ( t = 0 ; t < Threads ; ++t ) {
+      pThrs[t]->Join();
+      delete pThrs[t];
+   }
+
+   EXPECT_EQ(0, m_Errors);
+   EXPECT_EQ(0, Stat(ALI_BUFFPOOL_STAT_BYTES_INUSE));
+   // One slab per size class used is enough.
+   EXPECT_GE(8, m_pBackend->m_Allocs);
+}
+
+TEST_F(ALIBufferPool_f, aal0829)
+{
+   // Microbenchmark: pooled allocate + free pairs/sec for a range of request sizes.
+
+   const btWSSize      Sizes[] = { 64, 256, 4096, 65536 };
+   const btUnsignedInt Iters   = 1000000;
+   btUnsignedInt s;
+   btUnsignedInt i;
+
+   for ( s = 0 ; s < sizeof(Sizes) / sizeof(Sizes[0]) ; ++s ) {
+      btVirtAddr p = NULL;
+      Timer      start;
+
+      for ( i = 0 ; i < Iters ; ++i ) {
+         m_pPool->bufferPoolAllocate(Sizes[s], &p);
+         m_pPool->bufferPoolFree(p);
+      }
+
+      Timer  elapsed = Timer() - start;
+      double secs    = 0.0;
+      elapsed.AsSeconds(secs);
+
+      std::cout << "[ BENCHMARK] " << std::setw(6) << Sizes[s] << " bytes : "
+                << std::fixed << std::setprecision(0)
+                << ( (secs > 0.0) ? ((double)Iters / secs) : 0.0 )
+                << " allocate/free pairs/sec" << std::endl;
+   }
+}
+
+
+TEST_F(ALIBufferPool_f, aal0869)
+{
+   // A chunk freed twice is rejected the second time, and is then handed out to one
+   // owner only. A live chunk whose contents are anything at all can still be freed.
+
+   btVirtAddr a = NULL;
+   btVirtAddr b = NULL;
+   btVirtAddr c = NULL;
+
+   ASSERT_EQ(ali_errnumOK, m_pPool->bufferPoolAllocate(64, &a));
+   EXPECT_EQ(ali_errnumOK, m_pPool->bufferPoolFree(a));
+   EXPECT_EQ(ali_errnumBadParameter, m_pPool->bufferPoolFree(a));
+
+   ASSERT_EQ(ali_errnumOK, m_pPool->bufferPoolAllocate(64, &b));
+   ASSERT_EQ(ali_errnumOK, m_pPool->bufferPoolAllocate(64, &c));
+   EXPECT_NE(b, c);
+
+   // Leave b looking exactly like a free chunk.
+   memset(b, 0, 64);
+   EXPECT_EQ(ali_errnumOK, m_pPool->bufferPoolFree(c));
+   memcpy(b, c, 64);
+   EXPECT_EQ(ali_errnumOK, m_pPool->bufferPoolFree(b));
+
+   EXPECT_EQ(0, Stat(ALI_BUFFPOOL_STAT_BYTES_INUSE));
+}
+
+TEST_F(ALIBufferPool_f, aal0872)
+{
+   // Release() hands every slab and pass-through buffer back to the backend at once, so the
+   // owner can drain the pool while the backend still works. The pool is then empty, and the
+   // Release() in the destructor frees nothing more.
+
+   btVirtAddr a = NULL;
+   btVirtAddr b = NULL;
+
+   EXPECT_TRUE(m_pPool->IsEmpty());
+
+   ASSERT_EQ(ali_errnumOK, m_pPool->bufferPoolAllocate(64, &a));
+   ASSERT_EQ(ali_errnumOK, m_pPool->bufferPoolAllocate(MB(4), &b));
+   EXPECT_EQ(ali_errnumOK, m_pPool->bufferPoolFree(a));
+   EXPECT_FALSE(m_pPool->IsEmpty());
+   EXPECT_LT(m_pBackend->m_Frees, m_pBackend->m_Allocs);
+
+   m_pPool->Release();
+
+   EXPECT_TRUE(m_pPool->IsEmpty());
+   EXPECT_EQ(m_pBackend->m_Allocs, m_pBackend->m_Frees);
+
+   const btUnsignedInt Frees = m_pBackend->m_Frees;
+   m_pPool->Release();
+   EXPECT_EQ(Frees, m_pBackend->m_Frees);
+}
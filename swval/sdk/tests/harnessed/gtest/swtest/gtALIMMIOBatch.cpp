@@ -0,0 +1,63 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "ALIBase.h"
+
+// Exposes the batch validation shared by the HW and ASE ALI delegates.
+class ALIMMIOBatchCheck : public CALIBase
+{
+public:
+   using CALIBase::mmioBatchIsValid;
+};
+
+TEST(ALIMMIOBatch, aal0830)
+{
+   // CALIBase::mmioBatchIsValid() accepts naturally aligned 32- and 64-bit accesses that lie
+   // entirely within the MMIO region, and rejects the whole batch if any element does not.
+
+   const btCSROffset Len = 0x1000;
+
+   ali_mmio_access_t ok[] = {
+      { 0x000,      ali_mmio_width64, 0 },
+      { 0x008,      ali_mmio_width32, 0 },
+      { 0x00c,      ali_mmio_width32, 0 },
+      { Len - 8,    ali_mmio_width64, 0 },
+      { Len - 4,    ali_mmio_width32, 0 }
+   };
+   const btUnsignedInt N = sizeof(ok) / sizeof(ok[0]);
+
+   EXPECT_TRUE(ALIMMIOBatchCheck::mmioBatchIsValid(ok, N, Len));
+   EXPECT_TRUE(ALIMMIOBatchCheck::mmioBatchIsValid(ok, 0, Len));
+   EXPECT_FALSE(ALIMMIOBatchCheck::mmioBatchIsValid(NULL, 0, Len));
+
+   // Runs off the end of the region.
+   ok[N - 1].offset = Len;
+   EXPECT_FALSE(ALIMMIOBatchCheck::mmioBatchIsValid(ok, N, Len));
+   ok[N - 1].offset = Len - 4;
+
+   ok[N - 2].offset = Len - 4;
+   EXPECT_FALSE(ALIMMIOBatchCheck::mmioBatchIsValid(ok, N, Len));
+   ok[N - 2].offset = Len - 8;
+
+   // Misaligned.
+   ok[1].offset = 0x00a;
+   EXPECT_FALSE(ALIMMIOBatchCheck::mmioBatchIsValid(ok, N, Len));
+   ok[1].offset = 0x008;
+
+   ok[0].offset = 0x004;
+   EXPECT_FALSE(ALIMMIOBatchCheck::mmioBatchIsValid(ok, N, Len));
+   ok[0].offset = 0x000;
+
+   // Unsupported width.
+   ok[2].width = (ali_mmio_width_e)16;
+   EXPECT_FALSE(ALIMMIOBatchCheck::mmioBatchIsValid(ok, N, Len));
+   ok[2].width = ali_mmio_width32;
+
+   // Region too small for any access.
+   EXPECT_FALSE(ALIMMIOBatchCheck::mmioBatchIsValid(ok, 1, 4));
+
+   EXPECT_TRUE(ALIMMIOBatchCheck::mmioBatchIsValid(ok, N, Len));
+}
+
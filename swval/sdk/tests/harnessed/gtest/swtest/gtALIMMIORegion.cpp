@@ -0,0 +1,122 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/service/ALIMMIORegion.h"
+#include "aalsdk/kernel/ccip_defs.h"
+#include <cstddef>
+
+// IALIMMIO over a plain memory buffer.
+class MemALIMMIO : public IALIMMIO
+{
+public:
+   MemALIMMIO(btVirtAddr pBase, btCSROffset Length, btBool Direct=true) :
+      m_pBase(pBase),
+      m_Length(Length),
+      m_Direct(Direct)
+   {}
+
+   virtual btVirtAddr  mmioGetAddress( void ) { return m_pBase;  }
+   virtual btCSROffset mmioGetLength( void )  { return m_Length; }
+   virtual btBool      mmioIsDirect( void )   { return m_Direct; }
+
+   virtual btBool mmioRead32( const btCSROffset Offset, btUnsigned32bitInt * const pValue)
+   { *pValue = *(btUnsigned32bitInt *)(m_pBase + Offset); return true; }
+   virtual btBool mmioWrite32( const btCSROffset Offset, const btUnsigned32bitInt Value)
+   { *(btUnsigned32bitInt *)(m_pBase + Offset) = Value; return true; }
+   virtual btBool mmioRead64( const btCSROffset Offset, btUnsigned64bitInt * const pValue)
+   { *pValue = *(btUnsigned64bitInt *)(m_pBase + Offset); return true; }
+   virtual btBool mmioWrite64( const btCSROffset Offset, const btUnsigned64bitInt Value)
+   { *(btUnsigned64bitInt *)(m_pBase + Offset) = Value; return true; }
+   virtual btBool mmioWriteBatch( ali_mmio_access_t const * , btUnsignedInt ) { return false; }
+   virtual btBool mmioReadBatch( ali_mmio_access_t * , btUnsignedInt )        { return false; }
+   virtual btBool mmioGetFeatureAddress( btVirtAddr * , NamedValueSet const & , NamedValueSet & ) { return false; }
+   virtual btBool mmioGetFeatureAddress( btVirtAddr * , NamedValueSet const & )                   { return false; }
+   virtual btBool mmioGetFeatureOffset( btCSROffset * , NamedValueSet const & , NamedValueSet & ) { return false; }
+   virtual btBool mmioGetFeatureOffset( btCSROffset * , NamedValueSet const & )                   { return false; }
+
+protected:
+   btVirtAddr  m_pBase;
+   btCSROffset m_Length;
+   btBool      m_Direct;
+};
+
+TEST(ALIMMIORegion, aal0831)
+{
+   // ALIMMIORegion<Layout>::Attach() succeeds only for a directly mapped region at least
+   // sizeof(Layout) long.
+
+   btUnsigned64bitInt mem[8];
+
+   MemALIMMIO mapped(reinterpret_cast<btVirtAddr>(mem), sizeof(mem));
+   MemALIMMIO unmapped(NULL, sizeof(mem));
+   MemALIMMIO small(reinterpret_cast<btVirtAddr>(mem), sizeof(struct CCIP_AFU_Header) - 8);
+   MemALIMMIO shadow(reinterpret_cast<btVirtAddr>(mem), sizeof(mem), false);  // As on ASE / SW simulation.
+
+   ALIMMIORegion<struct CCIP_AFU_Header> afu;
+   EXPECT_FALSE(afu.IsOK());
+
+   EXPECT_FALSE(afu.Attach(NULL));
+   EXPECT_FALSE(afu.Attach(&unmapped));
+   EXPECT_FALSE(afu.Attach(&small));
+   EXPECT_FALSE(afu.Attach(&shadow));
+   EXPECT_FALSE(afu.IsOK());
+
+   EXPECT_TRUE(afu.Attach(&mapped));
+   EXPECT_TRUE(afu.IsOK());
+   EXPECT_EQ(reinterpret_cast<btVirtAddr>(mem), afu.Address());
+
+   ALIMMIORegion< ALIMMIOSpan<sizeof(mem) + 8> > span(&mapped);
+   EXPECT_FALSE(span.IsOK());
+}
+
+TEST(ALIMMIORegion, aal0832)
+{
+   // read<>() and write<>() access the same registers as the IALIMMIO methods, with
+   // integer and ccip_defs.h register struct widths.
+
+   btUnsigned64bitInt mem[8];
+   memset(mem, 0, sizeof(mem));
+
+   MemALIMMIO mmio(reinterpret_cast<btVirtAddr>(mem), sizeof(mem));
+   ALIMMIORegion< ALIMMIOSpan<sizeof(mem)> > r(&mmio);
+   ASSERT_TRUE(r.IsOK());
+
+   r.write<0x08>((btUnsigned64bitInt)0x0123456789abcdefULL);
+   btUnsigned64bitInt v64 = 0;
+   EXPECT_TRUE(mmio.mmioRead64(0x08, &v64));
+   EXPECT_EQ(0x0123456789abcdefULL, v64);
+
+   r.write<0x14>((btUnsigned32bitInt)0xdeadbeef);
+   btUnsigned32bitInt v32 = 0;
+   EXPECT_TRUE(mmio.mmioRead32(0x14, &v32));
+   EXPECT_EQ(0xdeadbeef, v32);
+
+   EXPECT_TRUE(mmio.mmioWrite64(0x38, 0xfeedfacecafef00dULL));
+   EXPECT_EQ(0xfeedfacecafef00dULL, (r.read<0x38, btUnsigned64bitInt>()));
+   EXPECT_EQ(0xcafef00d,            (r.read<0x38, btUnsigned32bitInt>()));
+
+   // Register structs.
+   struct CCIP_DFH dfh;
+   dfh.csr             = 0;
+   dfh.Feature_ID      = 0x123;
+   dfh.next_DFH_offset = 0x1000;
+   dfh.Type            = 1;
+
+   ALIMMIORegion<struct CCIP_AFU_Header> afu(&mmio);
+   ASSERT_TRUE(afu.IsOK());
+
+   afu.write<offsetof(struct CCIP_AFU_Header, ccip_dfh)>(dfh);
+   EXPECT_EQ(dfh.csr, mem[0]);
+
+   mem[2] = 0x5555aaaa5555aaaaULL;
+   struct CCIP_AFU_ID_H idh = afu.read<offsetof(struct CCIP_AFU_Header, ccip_afu_id_h), struct CCIP_AFU_ID_H>();
+   EXPECT_EQ(0x5555aaaa5555aaaaULL, idh.csr);
+
+   struct CCIP_DFH rd = afu.read<0, struct CCIP_DFH>();
+   EXPECT_EQ(0x123,  rd.Feature_ID);
+   EXPECT_EQ(0x1000, rd.next_DFH_offset);
+   EXPECT_EQ(1,      rd.Type);
+}
+
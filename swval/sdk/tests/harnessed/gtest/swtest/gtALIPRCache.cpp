@@ -0,0 +1,167 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "ALIPRCache.h"
+#include <cstdio>
+#include <fstream>
+
+class ALIPRCache_f : public ::testing::Test
+{
+public:
+   ALIPRCache_f() {}
+
+   virtual void TearDown()
+   {
+      std::vector<std::string>::const_iterator iter;
+      for ( iter = m_Files.begin() ; iter != m_Files.end() ; ++iter ) {
+         remove(iter->c_str());
+      }
+   }
+
+   // Write a green bitstream file: GBS header, then Words 32-bit words of Fill.
+   std::string WriteGBS(btcString Name, btUnsignedInt Words, btUnsigned32bitInt Fill, btUnsigned32bitInt Magic=GBS_HEADER_MAGIC)
+   {
+      std::string path("/tmp/");
+      path += Name;
+      std::ofstream f(path.c_str(), std::ios::binary);
+
+      btUnsigned64bitInt ifid[2] = { 0x0123456789abcdefULL, 0xfedcba9876543210ULL };
+      f.write(reinterpret_cast<const char *>(&Magic), sizeof(Magic));
+      f.write(reinterpret_cast<const char *>(ifid), sizeof(ifid));
+
+      btUnsignedInt i;
+      for ( i = 0 ; i < Words ; ++i ) {
+         f.write(reinterpret_cast<const char *>(&Fill), sizeof(Fill));
+      }
+
+      m_Files.push_back(path);
+      return path;
+   }
+
+   btUnsigned64bitInt Stat(btcString Key)
+   {
+      NamedValueSet nvs;
+      EXPECT_TRUE(m_Cache.prCacheGetStats(nvs));
+      ALI_PRCACHE_STAT_DATATYPE v = 0;
+      EXPECT_EQ(ENamedValuesOK, nvs.Get(Key, &v));
+      return v;
+   }
+
+   CALIPRCache              m_Cache;
+   std::vector<std::string> m_Files;
+};
+
+TEST_F(ALIPRCache_f, aal0858)
+{
+   // Cached images are found by AFU ID, handle or file, validated and without the
+   //  GBS header, and each lookup counts as a hit or a miss.
+
+   std::string a = WriteGBS("aal0858a.gbs", 1024, 0xaaaaaaaa);
+   std::string b = WriteGBS("aal0858b.gbs", 100,  0xbbbbbbbb);
+
+   btUnsigned64bitInt ha = 0;
+   btUnsigned64bitInt hb = 0;
+   EXPECT_EQ(ali_errnumOK, m_Cache.prCacheLoad("AFU-A", a.c_str(), &ha));
+   EXPECT_EQ(ali_errnumOK, m_Cache.prCacheLoad("AFU-B", b.c_str(), &hb));
+   EXPECT_NE(0, ha);
+   EXPECT_NE(ha, hb);
+
+   EXPECT_EQ(2, Stat(ALI_PRCACHE_STAT_IMAGES));
+   EXPECT_EQ(2 * GBS_HEADER_LEN + 4 * (1024 + 100), Stat(ALI_PRCACHE_STAT_BYTES));
+
+   CALIPRCache::Image const *p = m_Cache.Acquire("AFU-A", 0, NULL);
+   ASSERT_NONNULL(p);
+   EXPECT_EQ(4 * 1024, p->BitstreamLen());
+   EXPECT_EQ(0xaaaaaaaa, *reinterpret_cast<btUnsigned32bitInt *>(p->Bitstream()));
+   EXPECT_EQ(0x0123456789abcdefULL, p->m_IfIdL);
+   EXPECT_EQ(0xfedcba9876543210ULL, p->m_IfIdH);
+   m_Cache.Release(p);
+
+   p = m_Cache.Acquire(NULL, hb, NULL);
+   ASSERT_NONNULL(p);
+   EXPECT_EQ(std::string("AFU-B"), p->m_AFUId);
+   m_Cache.Release(p);
+
+   p = m_Cache.Acquire(NULL, 0, b.c_str());
+   ASSERT_NONNULL(p);
+   EXPECT_EQ(hb, p->m_Handle);
+   m_Cache.Release(p);
+
+   EXPECT_NULL(m_Cache.Acquire("AFU-C", 0, NULL));
+   EXPECT_NULL(m_Cache.Acquire(NULL, ha + hb, NULL));
+   EXPECT_NULL(m_Cache.Acquire(NULL, 0, "/tmp/aal0858c.gbs"));
+
+   EXPECT_EQ(3, Stat(ALI_PRCACHE_STAT_HITS));
+   EXPECT_EQ(3, Stat(ALI_PRCACHE_STAT_MISSES));
+}
+
+TEST_F(ALIPRCache_f, aal0859)
+{
+   // Files that are not valid green bitstreams are not cached.
+
+   std::string badmagic = WriteGBS("aal0859a.gbs", 16, 0, 0x12345678);
+   std::string empty    = WriteGBS("aal0859b.gbs", 0,  0);
+   std::string wrongext = WriteGBS("aal0859c.rbf", 16, 0);
+
+   std::string ragged("/tmp/aal0859d.gbs");
+   {
+      std::ofstream f(ragged.c_str(), std::ios::binary);
+      btUnsigned32bitInt magic = GBS_HEADER_MAGIC;
+      f.write(reinterpret_cast<const char *>(&magic), sizeof(magic));
+      f.write("0123456789abcdef" "xyz", 19);
+      m_Files.push_back(ragged);
+   }
+
+   EXPECT_EQ(ali_errnumBadParameter, m_Cache.prCacheLoad("AFU", badmagic.c_str()));
+   EXPECT_EQ(ali_errnumBadParameter, m_Cache.prCacheLoad("AFU", empty.c_str()));
+   EXPECT_EQ(ali_errnumBadParameter, m_Cache.prCacheLoad("AFU", wrongext.c_str()));
+   EXPECT_EQ(ali_errnumBadParameter, m_Cache.prCacheLoad("AFU", ragged.c_str()));
+   EXPECT_EQ(ali_errnumBadParameter, m_Cache.prCacheLoad("AFU", "/tmp/aal0859-does-not-exist.gbs"));
+   EXPECT_EQ(ali_errnumBadParameter, m_Cache.prCacheLoad("AFU", "noextension"));
+   EXPECT_EQ(ali_errnumBadParameter, m_Cache.prCacheLoad(NULL, badmagic.c_str()));
+
+   EXPECT_EQ(0, Stat(ALI_PRCACHE_STAT_IMAGES));
+   EXPECT_EQ(ali_errnumBadParameter, m_Cache.prCacheEvict("AFU"));
+}
+
+TEST_F(ALIPRCache_f, aal0860)
+{
+   // A replaced or evicted image stays valid until the configure holding it
+   //  releases it. LoadAll() takes AFU ID / file pairs.
+
+   std::string v1 = WriteGBS("aal0860a.gbs", 64, 0x11111111);
+   std::string v2 = WriteGBS("aal0860b.gbs", 32, 0x22222222);
+
+   NamedValueSet images;
+   images.Add("AFU", v1.c_str());
+   images.Add("Bad", 5);
+   EXPECT_EQ(1, m_Cache.LoadAll(images));
+
+   CALIPRCache::Image const *pOld = m_Cache.Acquire("AFU", 0, NULL);
+   ASSERT_NONNULL(pOld);
+
+   btUnsigned64bitInt h2 = 0;
+   EXPECT_EQ(ali_errnumOK, m_Cache.prCacheLoad("AFU", v2.c_str(), &h2));
+   EXPECT_EQ(1, Stat(ALI_PRCACHE_STAT_IMAGES));
+   EXPECT_NE(pOld->m_Handle, h2);
+
+   // The old image is still intact.
+   EXPECT_EQ(0x11111111, *reinterpret_cast<btUnsigned32bitInt *>(pOld->Bitstream() + pOld->BitstreamLen() - 4));
+
+   CALIPRCache::Image const *pNew = m_Cache.Acquire("AFU", 0, NULL);
+   ASSERT_NONNULL(pNew);
+   EXPECT_EQ(h2, pNew->m_Handle);
+   EXPECT_EQ(0x22222222, *reinterpret_cast<btUnsigned32bitInt *>(pNew->Bitstream()));
+
+   m_Cache.Release(pOld);
+
+   EXPECT_EQ(ali_errnumOK, m_Cache.prCacheEvict("AFU"));
+   EXPECT_EQ(0, Stat(ALI_PRCACHE_STAT_IMAGES));
+   EXPECT_EQ(0x22222222, *reinterpret_cast<btUnsigned32bitInt *>(pNew->Bitstream()));
+   m_Cache.Release(pNew);
+
+   EXPECT_NULL(m_Cache.Acquire("AFU", 0, NULL));
+}
+
@@ -0,0 +1,276 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/aas/Dispatchables.h"
+#include "aalsdk/osal/Timer.h"
+#include <iomanip>
+
+class EventPool_f : public ::testing::Test
+{
+public:
+   EventPool_f() {}
+
+   // Counts the events it receives.
+   class Client : public CAASBase,
+                  public IServiceClient
+   {
+   public:
+      Client() :
+         m_Events(0)
+      {
+         SetInterface(iidServiceClient, dynamic_cast<IServiceClient *>(this));
+      }
+
+      void      serviceAllocated(IBase * , TransactionID const & ) {}
+      void serviceAllocateFailed(const IEvent & )                  {}
+      void       serviceReleased(TransactionID const & )           {}
+      void serviceReleaseRequest(IBase * , const IEvent & )        {}
+      void  serviceReleaseFailed(const IEvent & )                  {}
+      void          serviceEvent(const IEvent & )                  { ++m_Events; }
+
+      btUnsignedInt m_Events;
+   };
+
+   // A CAALEvent that can live on the stack and set any interface.
+   class Event : public CAALEvent
+   {
+   public:
+      Event(IBase *pObject) :
+         CAALEvent(pObject)
+      {}
+      ~Event() {}
+
+      EOBJECT CallSetInterface(btIID ID, btGenericInterface pIfc) { return SetInterface(ID, pIfc); }
+   };
+
+   struct Churn
+   {
+      CAASBase     *m_pBase;
+      btUnsignedInt m_Count;
+      btUnsignedInt m_Errors;
+   };
+
+   // Creates and destroys transaction events, checking that each one reads back what it was given.
+   static void ChurnThread(OSLThread *pThread, void *pContext)
+   {
+      Churn *p = reinterpret_cast<Churn *>(pContext);
+      btUnsignedInt i;
+      for ( i = 0 ; i < p->m_Count ; ++i ) {
+         TransactionID tid((btID)i);
+         CTransactionEvent *pEvent = new CTransactionEvent(p->m_pBase, tid);
+         if ( !pEvent->IsOK() || ( (btID)i != pEvent->TranID().ID() ) || !pEvent->Has(iidTranEvent) ) {
+            ++p->m_Errors;
+         }
+         pEvent->Delete();
+      }
+   }
+
+   static double Seconds(const Timer &start)
+   {
+      Timer  elapsed = Timer() - start;
+      double secs    = 0.0;
+      elapsed.AsSeconds(secs);
+      return secs;
+   }
+
+   CAASBase m_Base;
+};
+
+TEST_F(EventPool_f, aal0853)
+{
+   // Deleted events return to CAALEvent::EventPool(), and later events of the same size reuse
+   // them without going to the heap.
+
+   CObjectPool::Stats before;
+   CObjectPool::Stats after;
+
+   CAALEvent::EventPool().GetStats(before);
+
+   CTransactionEvent *pEvent = new CTransactionEvent(&m_Base, TransactionID());
+   CAALEvent::EventPool().GetStats(after);
+   EXPECT_EQ(before.Live + 1, after.Live);
+   pEvent->Delete();
+
+   CAALEvent::EventPool().GetStats(before);
+   EXPECT_EQ(after.Live - 1, before.Live);
+   EXPECT_LE(1, before.Pooled);
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < 100 ; ++i ) {
+      pEvent = new CTransactionEvent(&m_Base, TransactionID());
+      delete pEvent;
+   }
+
+   CAALEvent::EventPool().GetStats(after);
+   EXPECT_EQ(before.HeapAllocs, after.HeapAllocs);
+   EXPECT_EQ(before.Reuses + 100, after.Reuses);
+   EXPECT_EQ(before.Live, after.Live);
+
+   // nothrow new and Clone() draw from the same pool.
+   CExceptionTransactionEvent *pEx = new(std::nothrow) CExceptionTransactionEvent(&m_Base,
+                                                                                  TransactionID(),
+                                                                                  errCreationFailure,
+                                                                                  reasUnknown,
+                                                                                  "desc");
+   ASSERT_NONNULL(pEx);
+   IEvent *pClone = pEx->Clone();
+   ASSERT_NONNULL(pClone);
+   EXPECT_TRUE(*pEx == *pClone);
+
+   CAALEvent::EventPool().GetStats(before);
+   EXPECT_EQ(after.Live + 2, before.Live);
+
+   delete pClone;
+   pEx->Delete();
+
+   CAALEvent::EventPool().GetStats(after);
+   EXPECT_EQ(before.Live - 2, after.Live);
+
+   // Trim() hands the pooled blocks back to the heap.
+   CAALEvent::EventPool().Trim();
+   CAALEvent::EventPool().GetStats(after);
+   EXPECT_EQ(0, after.Pooled);
+}
+
+TEST_F(EventPool_f, aal0854)
+{
+   // Interfaces beyond the inline ones are kept in an overflow map, and are copied, compared
+   // and found like the others.
+
+   Event a(&m_Base);
+   Event b(&m_Base);
+
+   const btIID First = 0x7000;
+   const btIID Count = 12;
+   btIID id;
+
+   // The same interfaces, set in opposite orders, with the same subclass.
+   for ( id = First ; id < First + Count ; ++id ) {
+      EXPECT_EQ(EObjOK, a.CallSetInterface(id, (btGenericInterface)(id + 1)));
+   }
+   for ( id = First + Count ; id > First ; --id ) {
+      EXPECT_EQ(EObjOK, b.CallSetInterface(id - 1, (btGenericInterface)id));
+   }
+   EXPECT_EQ(EObjOK, a.SetSubClassInterface(First + Count, (btGenericInterface)1));
+   EXPECT_EQ(EObjOK, b.SetSubClassInterface(First + Count, (btGenericInterface)1));
+
+   EXPECT_EQ(EObjDuplicateName, a.CallSetInterface(First + Count - 1, (btGenericInterface)1));
+
+   for ( id = First ; id < First + Count ; ++id ) {
+      EXPECT_TRUE(a.Has(id));
+      EXPECT_EQ((btGenericInterface)(id + 1), a.Interface(id));
+   }
+   EXPECT_FALSE(a.Has(First + Count + 1));
+
+   EXPECT_TRUE(a == b);
+   EXPECT_EQ(EObjOK, b.CallSetInterface(First - 1, (btGenericInterface)1));
+   EXPECT_FALSE(a == b);
+
+   IEvent *pClone = a.Clone();
+   ASSERT_NONNULL(pClone);
+   EXPECT_TRUE(a == *pClone);
+   for ( id = First ; id < First + Count ; ++id ) {
+      EXPECT_EQ((btGenericInterface)(id + 1), pClone->Interface(id));
+   }
+   delete pClone;
+}
+
+TEST_F(EventPool_f, aal0855)
+{
+   // Dispatchables from aas/Dispatchables.h are allocated from and recycled to
+   // PooledDispatchable::DispatchablePool(), as is the event they carry.
+
+   Client client;
+
+   CObjectPool::Stats before;
+   CObjectPool::Stats after;
+
+   // Warm both pools.
+   (new ServiceEvent(&client, new CAALEvent(&m_Base)))->operator()();
+
+   CAALEvent::EventPool().GetStats(before);
+   PooledDispatchable::DispatchablePool().GetStats(after);
+
+   btUnsignedInt i;
+   for ( i = 0 ; i < 50 ; ++i ) {
+      IDispatchable *pDisp = new ServiceEvent(&client, new CAALEvent(&m_Base));
+      (*pDisp)();
+   }
+   EXPECT_EQ(51, client.m_Events);
+
+   CObjectPool::Stats ev;
+   CObjectPool::Stats disp;
+   CAALEvent::EventPool().GetStats(ev);
+   PooledDispatchable::DispatchablePool().GetStats(disp);
+
+   EXPECT_EQ(before.Live, ev.Live);
+   EXPECT_EQ(before.HeapAllocs, ev.HeapAllocs);
+   EXPECT_EQ(before.Reuses + 50, ev.Reuses);
+
+   EXPECT_EQ(after.Live, disp.Live);
+   EXPECT_EQ(after.HeapAllocs, disp.HeapAllocs);
+   EXPECT_EQ(after.Reuses + 50, disp.Reuses);
+}
+
+TEST_F(EventPool_f, aal0856)
+{
+   // Threads creating and deleting events concurrently share the pool safely.
+
+   const btUnsignedInt Threads = 4;
+   const btUnsignedInt Count   = 50000;
+
+   CObjectPool::Stats before;
+   CObjectPool::Stats after;
+   CAALEvent::EventPool().GetStats(before);
+
+   Churn      ctx[Threads];
+   OSLThread *pThrs[Threads];
+   btUnsignedInt t;
+
+   for ( t = 0 ; t < Threads ; ++t ) {
+      ctx[t].m_pBase  = &m_Base;
+      ctx[t].m_Count  = Count;
+      ctx[t].m_Errors = 0;
+      pThrs[t] = new OSLThread(EventPool_f::ChurnThread, OSLThread::THREADPRIORITY_NORMAL, &ctx[t]);
+   }
+   for ( t = 0 ; t < Threads ; ++t ) {
+      pThrs[t]->Join();
+      delete pThrs[t];
+      EXPECT_EQ(0, ctx[t].m_Errors) << "thread " << t;
+   }
+
+   CAALEvent::EventPool().GetStats(after);
+   EXPECT_EQ(before.Live, after.Live);
+   EXPECT_LE(after.HeapAllocs, before.HeapAllocs + Threads);
+}
+
+TEST_F(EventPool_f, aal0857)
+{
+   // Microbenchmark: cost of creating and deleting a CTransactionEvent, and of a
+   // ServiceEvent dispatchable carrying a CAALEvent.
+
+   const btUnsignedInt Iters = 500000;
+   btUnsignedInt i;
+
+   Timer start;
+   for ( i = 0 ; i < Iters ; ++i ) {
+      CTransactionEvent *pEvent = new CTransactionEvent(&m_Base, TransactionID());
+      pEvent->Delete();
+   }
+   double secs = Seconds(start);
+   std::cout << "[ BENCHMARK] " << std::setw(30) << std::left << "CTransactionEvent new + Delete" << std::right
+             << " : " << std::fixed << std::setprecision(1) << ( (secs * 1.0e9) / (double)Iters ) << " ns/op" << std::endl;
+
+   Client client;
+   start = Timer();
+   for ( i = 0 ; i < Iters ; ++i ) {
+      (new ServiceEvent(&client, new CAALEvent(&m_Base)))->operator()();
+   }
+   secs = Seconds(start);
+   std::cout << "[ BENCHMARK] " << std::setw(30) << std::left << "ServiceEvent + CAALEvent" << std::right
+             << " : " << std::fixed << std::setprecision(1) << ( (secs * 1.0e9) / (double)Iters ) << " ns/op" << std::endl;
+   EXPECT_EQ(Iters, client.m_Events);
+}
+
@@ -0,0 +1,239 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/AALLogRecord.h"
+#include "aalsdk/osal/Timer.h"
+#include <iomanip>
+#include <unistd.h>
+
+class Logger_f : public ::testing::Test
+{
+public:
+   Logger_f() :
+      m_pLogger(NULL)
+   {}
+
+   virtual void SetUp()
+   {
+      std::ostringstream oss;
+      oss << "/tmp/gtLogger." << getpid() << "." << ::testing::UnitTest::GetInstance()->current_test_info()->name();
+      m_File = oss.str();
+      unlink(m_File.c_str());
+
+      m_pLogger = ILoggerFactory();
+      ASSERT_NONNULL(m_pLogger);
+      m_pLogger->SetLogPID(false);
+      m_pLogger->SetLogTimeStamp(false);
+   }
+
+   virtual void TearDown()
+   {
+      delete m_pLogger;
+      unlink(m_File.c_str());
+   }
+
+   std::string Contents() const
+   {
+      std::ifstream in(m_File.c_str(), std::ios_base::in | std::ios_base::binary);
+      std::ostringstream oss;
+      oss << in.rdbuf();
+      return oss.str();
+   }
+
+   struct LogThr
+   {
+      ILogger      *m_pLogger;
+      btUnsignedInt m_Id;
+      btUnsignedInt m_Count;
+   };
+
+   static void LogThread(OSLThread *pThread, void *pContext)
+   {
+      LogThr *p = reinterpret_cast<LogThr *>(pContext);
+      btUnsignedInt i;
+      for ( i = 0 ; i < p->m_Count ; ++i ) {
+         MY_LOG(p->m_pLogger, LOG_ERR, LM_Any, "thr " << p->m_Id << " msg " << i << std::endl);
+      }
+   }
+
+   ILogger    *m_pLogger;
+   std::string m_File;
+};
+
+TEST_F(Logger_f, aal0840)
+{
+   // ILogger::SetAsync(true) hands messages to the drain thread, which writes them to the
+   // text destination in order, with the same decorations as synchronous logging.
+
+   m_pLogger->SetDestination(ILogger::FILE, m_File);
+   m_pLogger->SetAsync(true);
+   EXPECT_TRUE(m_pLogger->GetAsync());
+
+   btUnsignedInt i;
+   std::ostringstream expect;
+   for ( i = 0 ; i < 1000 ; ++i ) {
+      MY_LOG(m_pLogger, LOG_ERR, LM_Any, "message " << i << std::endl);
+      expect << "ERROR message " << i << std::endl;
+   }
+   m_pLogger->Log(LOG_WARNING, "text\n");
+   expect << "WARNG text\n";
+
+   m_pLogger->Flush();
+   EXPECT_EQ(expect.str(), Contents());
+
+   // Filtered messages are never queued.
+   MY_LOG(m_pLogger, LOG_DEBUG, LM_Any, "not logged" << std::endl);
+
+   m_pLogger->SetAsync(false);
+   EXPECT_FALSE(m_pLogger->GetAsync());
+
+   MY_LOG(m_pLogger, LOG_ERR, LM_Any, "sync" << std::endl);
+   expect << "ERROR sync" << std::endl;
+   m_pLogger->Flush();
+   EXPECT_EQ(expect.str(), Contents());
+}
+
+TEST_F(Logger_f, aal0841)
+{
+   // Concurrent asynchronous loggers lose no messages, and each thread's messages stay in order.
+
+   const btUnsignedInt Threads = 4;
+   const btUnsignedInt Count   = 20000;
+
+   m_pLogger->SetDestination(ILogger::FILE, m_File);
+   m_pLogger->SetAsync(true);
+
+   LogThr     ctx[Threads];
+   OSLThread *pThrs[Threads];
+   btUnsignedInt t;
+
+   for ( t = 0 ; t < Threads ; ++t ) {
+      ctx[t].m_pLogger = m_pLogger;
+      ctx[t].m_Id      = t;
+      ctx[t].m_Count   = Count;
+      pThrs[t] = new OSLThread(Logger_f::LogThread, OSLThread::THREADPRIORITY_NORMAL, &ctx[t]);
+   }
+   for ( t = 0 ; t < Threads ; ++t ) {
+      pThrs[t]->Join();
+      delete pThrs[t];
+   }
+
+   m_pLogger->SetAsync(false);
+
+   std::istringstream in(Contents());
+   std::string        line;
+   btUnsignedInt      next[Threads] = { 0 };
+   btUnsignedInt      errors = 0;
+
+   while ( std::getline(in, line) ) {
+      unsigned id  = 0;
+      unsigned msg = 0;
+      if ( ( 2 != sscanf(line.c_str(), "ERROR thr %u msg %u", &id, &msg) ) ||
+           ( id >= Threads ) || ( msg != next[id] ) ) {
+         ++errors;
+         continue;
+      }
+      ++next[id];
+   }
+
+   EXPECT_EQ(0, errors);
+   for ( t = 0 ; t < Threads ; ++t ) {
+      EXPECT_EQ(Count, next[t]) << "thread " << t;
+   }
+}
+
+TEST_F(Logger_f, aal0842)
+{
+   // The BINFILE destination writes a file header, then decoration settings, source file
+   // definitions and message records carrying level, line and the formatted text.
+
+   m_pLogger->AddToMask(LM_AAS, LOG_ERR);
+   m_pLogger->SetLogPrepend("pre ");
+   m_pLogger->SetDestination(ILogger::BINFILE, m_File);
+   EXPECT_TRUE(m_pLogger->GetAsync());
+
+   const btInt line = __LINE__; MY_LOG(m_pLogger, LOG_ERR, LM_AAS, "first " << 1 << std::endl);
+   m_pLogger->Log(LOG_CRIT, "second\n");
+
+   m_pLogger->Flush();
+
+   const std::string s = Contents();
+   const char *p   = s.data();
+   const char *end = s.data() + s.length();
+
+   ASSERT_LE(sizeof(struct aal_log_file_header), s.length());
+   const struct aal_log_file_header *hdr = reinterpret_cast<const struct aal_log_file_header *>(p);
+   EXPECT_EQ(AAL_LOG_FILE_MAGIC, hdr->magic);
+   EXPECT_EQ(AAL_LOG_FILE_VERSION, hdr->version);
+   EXPECT_EQ((btUnsigned64bitInt)GetProcessID(), hdr->pid);
+   p += sizeof(*hdr);
+
+   std::vector<const struct aal_log_record *> recs;
+   while ( p < end ) {
+      const struct aal_log_record *r = reinterpret_cast<const struct aal_log_record *>(p);
+      ASSERT_LE(p + AAL_LOG_REC_SIZE(r->len), end);
+      recs.push_back(r);
+      p += AAL_LOG_REC_SIZE(r->len);
+   }
+
+   ASSERT_EQ(4, recs.size());
+
+   EXPECT_EQ(AAL_LOG_REC_CONFIG, recs[0]->type);
+   EXPECT_EQ(AAL_LOG_CFG_LEVEL, recs[0]->level);
+   EXPECT_EQ(std::string("pre "), std::string(reinterpret_cast<const char *>(recs[0] + 1), recs[0]->len));
+
+   EXPECT_EQ(AAL_LOG_REC_FILE, recs[1]->type);
+   EXPECT_EQ(1, recs[1]->fileid);
+   EXPECT_EQ(std::string(__FILE__), std::string(reinterpret_cast<const char *>(recs[1] + 1), recs[1]->len));
+
+   EXPECT_EQ(AAL_LOG_REC_MESSAGE, recs[2]->type);
+   EXPECT_EQ(LOG_ERR, recs[2]->level);
+   EXPECT_EQ(1, recs[2]->fileid);
+   EXPECT_EQ(line, (btInt)recs[2]->line);
+   EXPECT_EQ(FindLowestBitSet64(LM_AAS), recs[2]->maskbit);
+   EXPECT_EQ((btUnsigned64bitInt)GetThreadID(), recs[2]->tid);
+   EXPECT_EQ(std::string("first 1\n"), std::string(reinterpret_cast<const char *>(recs[2] + 1), recs[2]->len));
+
+   EXPECT_EQ(AAL_LOG_REC_MESSAGE, recs[3]->type);
+   EXPECT_EQ(LOG_CRIT, recs[3]->level);
+   EXPECT_EQ(0, recs[3]->fileid);
+   EXPECT_LE(recs[2]->usec, recs[3]->usec);
+   EXPECT_EQ(std::string("second\n"), std::string(reinterpret_cast<const char *>(recs[3] + 1), recs[3]->len));
+}
+
+TEST_F(Logger_f, aal0843)
+{
+   // Microbenchmark: messages/sec logged to a file, synchronously and asynchronously.
+
+   const btUnsignedInt Iters = 200000;
+   btUnsignedInt a;
+   btUnsignedInt i;
+
+   m_pLogger->SetDestination(ILogger::FILE, m_File);
+
+   for ( a = 0 ; a < 2 ; ++a ) {
+      m_pLogger->SetAsync(1 == a);
+
+      Timer start;
+
+      for ( i = 0 ; i < Iters ; ++i ) {
+         MY_LOG(m_pLogger, LOG_ERR, LM_Any, "benchmark message " << i << std::endl);
+      }
+
+      Timer  elapsed = Timer() - start;
+      double secs    = 0.0;
+      elapsed.AsSeconds(secs);
+
+      m_pLogger->Flush();
+
+      std::cout << "[ BENCHMARK] " << std::setw(5) << ( a ? "async" : "sync" ) << " : "
+                << std::fixed << std::setprecision(0)
+                << ( (secs > 0.0) ? ((double)Iters / secs) : 0.0 )
+                << " messages/sec" << std::endl;
+   }
+
+   m_pLogger->SetAsync(false);
+}
+
@@ -6,6 +6,7 @@
 #include "gtThreadGroup.h"
 
 #include <_MessageDelivery.h>
+#include <algorithm>
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -94,3 +95,188 @@ TEST_F(MessageDelivery_f, aal0708)
    YIELD_WHILE(1 == i);
 }
 
+// Records its sequence number under its target, optionally blocking until released.
+class TargetSeqD : public IDispatchable
+{
+public:
+   TargetSeqD(btObjectType Target, CriticalSection &cs, std::vector<btInt> &log, btInt seq, volatile btBool *pGate=NULL) :
+      m_Target(Target),
+      m_CS(cs),
+      m_Log(log),
+      m_Seq(seq),
+      m_pGate(pGate)
+   {}
+
+   virtual void operator() ()
+   {
+      if ( NULL != m_pGate ) {
+         YIELD_WHILE(!*m_pGate);
+      }
+      AutoLock(&m_CS);
+      m_Log.push_back(m_Seq);
+   }
+
+   virtual btObjectType Target() const { return m_Target; }
+
+protected:
+   btObjectType        m_Target;
+   CriticalSection    &m_CS;
+   std::vector<btInt> &m_Log;
+   btInt               m_Seq;
+   volatile btBool    *m_pGate;
+};
+
+TEST_F(MessageDelivery_f, aal0838)
+{
+   // With AALRUNTIME_MDS_ORDER_TARGET, messages for one IDispatchable::Target() are delivered
+   // in the order they were scheduled, and a blocked target does not hold up another target.
+
+   ASSERT_TRUE(m_pMDS->Configure(2, 0, AALRUNTIME_MDS_ORDER_TARGET));
+
+   int                objA = 0;
+   int                objB = 0;
+   CriticalSection    csA;
+   CriticalSection    csB;
+   std::vector<btInt> logA;
+   std::vector<btInt> logB;
+   volatile btBool    gate = false;
+
+   const btInt N = 200;
+   std::vector<TargetSeqD *> disps;
+   btInt i;
+
+   disps.push_back(new TargetSeqD(&objA, csA, logA, 0, &gate));
+   for ( i = 1 ; i < N ; ++i ) {
+      disps.push_back(new TargetSeqD(&objA, csA, logA, i));
+   }
+   for ( i = 0 ; i < N ; ++i ) {
+      disps.push_back(new TargetSeqD(&objB, csB, logB, i));
+   }
+
+   std::vector<TargetSeqD *>::iterator iter;
+   for ( iter = disps.begin() ; disps.end() != iter ; ++iter ) {
+      EXPECT_TRUE(scheduleMessage(*iter));
+   }
+
+   // B completes while A's first message is still blocked.
+   YIELD_WHILE( (btInt)logB.size() < N );
+   {
+      AutoLock(&csA);
+      EXPECT_TRUE(logA.empty());
+   }
+
+   gate = true;
+   StopMessageDelivery();
+
+   ASSERT_EQ(N, (btInt)logA.size());
+   for ( i = 0 ; i < N ; ++i ) {
+      EXPECT_EQ(i, logA[i]);
+      EXPECT_EQ(i, logB[i]);
+   }
+
+   for ( iter = disps.begin() ; disps.end() != iter ; ++iter ) {
+      delete *iter;
+   }
+}
+
+TEST_F(MessageDelivery_f, aal0839)
+{
+   // _MessageDelivery::Configure() rejects an unknown ordering, and AALRUNTIME_MDS_ORDER_GLOBAL
+   // with more than one thread, keeping the current dispatcher.
+   // With AALRUNTIME_MDS_ORDER_NONE and a CPU mask, every message is still delivered once.
+
+   EXPECT_FALSE(m_pMDS->Configure(4, 0, AALRUNTIME_MDS_ORDER_NONE + 1));
+   EXPECT_FALSE(m_pMDS->Configure(4, 0, AALRUNTIME_MDS_ORDER_GLOBAL));
+
+   ASSERT_TRUE(m_pMDS->Configure(4, 1, AALRUNTIME_MDS_ORDER_NONE));
+
+   const btInt     N = 1000;
+   CriticalSection cs;
+   btInt           count = 0;
+   btInt           i;
+   std::vector<btInt> log;
+   std::vector<TargetSeqD *> disps;
+
+   for ( i = 0 ; i < N ; ++i ) {
+      disps.push_back(new TargetSeqD(NULL, cs, log, i));
+      EXPECT_TRUE(scheduleMessage(disps.back()));
+   }
+
+   StopMessageDelivery();
+   EXPECT_EQ(N, (btInt)log.size());
+
+   std::sort(log.begin(), log.end());
+   for ( i = 0 ; i < N ; ++i ) {
+      count += ( i == log[i] ) ? 1 : 0;
+      delete disps[i];
+   }
+   EXPECT_EQ(N, count);
+
+   StartMessageDelivery();
+   btInt j = 0;
+   UnsafeCountUpD d(j);
+   EXPECT_TRUE(scheduleMessage(&d));
+   YIELD_WHILE(0 == j);
+}
+
+// Stops message delivery from within a callback, as _runtime::serviceReleased() does.
+class StopMDSD : public IDispatchable
+{
+public:
+   StopMDSD(_MessageDelivery *pMDS, btObjectType Target, volatile btBool &Done) :
+      m_pMDS(pMDS),
+      m_Target(Target),
+      m_Done(Done)
+   {}
+
+   virtual void operator() ()
+   {
+      m_pMDS->StopMessageDelivery();
+      m_Done = true;
+   }
+
+   virtual btObjectType Target() const { return m_Target; }
+
+protected:
+   _MessageDelivery *m_pMDS;
+   btObjectType      m_Target;
+   volatile btBool  &m_Done;
+};
+
+TEST_F(MessageDelivery_f, aal0868)
+{
+   // With AALRUNTIME_MDS_ORDER_TARGET, a callback may call StopMessageDelivery(). It returns
+   // without waiting for the callback's own Strand, and the rest of that target's messages are
+   // still delivered in order.
+
+   ASSERT_TRUE(m_pMDS->Configure(2, 0, AALRUNTIME_MDS_ORDER_TARGET));
+
+   int                obj  = 0;
+   volatile btBool    gate = false;
+   volatile btBool    done = false;
+   CriticalSection    cs;
+   std::vector<btInt> log;
+
+   // The first message holds the Strand until the others are queued behind it.
+   TargetSeqD before(&obj, cs, log, 0, &gate);
+   StopMDSD   stop(m_pMDS, &obj, done);
+   TargetSeqD after(&obj, cs, log, 1);
+
+   EXPECT_TRUE(scheduleMessage(&before));
+   EXPECT_TRUE(scheduleMessage(&stop));
+   EXPECT_TRUE(scheduleMessage(&after));
+
+   gate = true;
+   YIELD_WHILE(!done);
+   YIELD_WHILE(log.size() < 2);
+
+   // The callback's StopMessageDelivery() stopped the dispatcher.
+   btInt i = 0;
+   UnsafeCountUpD d(i);
+   EXPECT_FALSE(scheduleMessage(&d));
+
+   StopMessageDelivery();
+   ASSERT_EQ(2, (btInt)log.size());
+   EXPECT_EQ(0, log[0]);
+   EXPECT_EQ(1, log[1]);
+}
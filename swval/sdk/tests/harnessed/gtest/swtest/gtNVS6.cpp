@@ -0,0 +1,420 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/AALNamedValueSet.h"
+#include "aalsdk/AALNVSMarshaller.h"
+#include "aalsdk/osal/Timer.h"
+#include <iomanip>
+
+class NVSBinary_f : public ::testing::Test
+{
+public:
+   // One value of every type, under both key types, plus an embedded NVS.
+   static void Fill(NamedValueSet &nvs)
+   {
+      btByte                  bytes[] = { 0, 1, 0x7f, (btByte)0xff };
+      bt32bitInt              i32[]   = { -1, 0, 1, 0x7fffffff };
+      btUnsigned32bitInt      u32[]   = { 0, 1, 0xffffffff };
+      bt64bitInt              i64[]   = { -1, 0, 0x7fffffffffffffffLL };
+      btUnsigned64bitInt      u64[]   = { 0, 0xffffffffffffffffULL };
+      btFloat                 flt[]   = { 0.0, -1.5, 3.25 };
+      btString                strs[]  = { (btString)"", (btString)"one", (btString)"two words" };
+      btObjectType            objs[]  = { NULL, &nvs };
+
+      nvs.Add((btNumberKey)0, true);
+      nvs.Add((btNumberKey)1, (btByte)'x');
+      nvs.Add((btNumberKey)2, (bt32bitInt)-42);
+      nvs.Add((btNumberKey)3, (btUnsigned32bitInt)42);
+      nvs.Add((btNumberKey)4, (bt64bitInt)-0x123456789LL);
+      nvs.Add((btNumberKey)5, (btUnsigned64bitInt)0xfedcba9876543210ULL);
+      nvs.Add((btNumberKey)6, (btFloat)2.5);
+      nvs.Add((btNumberKey)7, "number key string");
+      nvs.Add((btNumberKey)8, (btObjectType)&nvs);
+      nvs.Add((btNumberKey)0xffffffffffffffffULL, bytes, sizeof(bytes) / sizeof(bytes[0]));
+
+      nvs.Add("bool",   false);
+      nvs.Add("string", "string key string");
+      nvs.Add("bytes",  bytes, sizeof(bytes) / sizeof(bytes[0]));
+      nvs.Add("i32",    i32,   sizeof(i32)   / sizeof(i32[0]));
+      nvs.Add("u32",    u32,   sizeof(u32)   / sizeof(u32[0]));
+      nvs.Add("i64",    i64,   sizeof(i64)   / sizeof(i64[0]));
+      nvs.Add("u64",    u64,   sizeof(u64)   / sizeof(u64[0]));
+      nvs.Add("flt",    flt,   sizeof(flt)   / sizeof(flt[0]));
+      nvs.Add("strs",   strs,  sizeof(strs)  / sizeof(strs[0]));
+      nvs.Add("objs",   objs,  sizeof(objs)  / sizeof(objs[0]));
+
+      NamedValueSet inner;
+      NamedValueSet innermost;
+      innermost.Add("depth", (btUnsigned32bitInt)2);
+      inner.Add("depth", (btUnsigned32bitInt)1);
+      inner.Add((btNumberKey)7, &innermost);
+      nvs.Add("nvs", &inner);
+   }
+
+   // Messages with a typical shape, for the benchmark.
+   static void FillMessage(NamedValueSet &nvs, btUnsignedInt i)
+   {
+      NamedValueSet sub;
+      sub.Add("AAL_keyRegAFU_ID", "00000000-0000-0000-0000-000011100181");
+      sub.Add("AIAExecutable",    "libaia");
+      sub.Add("ServiceName",      "ALI");
+
+      nvs.Add("AAL_keyRegHandle",  (btUnsigned64bitInt)i);
+      nvs.Add("AAL_keyRegDevType", (btUnsigned32bitInt)5);
+      nvs.Add("AAL_keyRegBus",     (btUnsigned32bitInt)(i & 0xff));
+      nvs.Add("AAL_keyRegDevice",  (btUnsigned32bitInt)0);
+      nvs.Add("AAL_keyRegFunction",(btUnsigned32bitInt)1);
+      nvs.Add("AAL_keyRegSubDeviceNumber", (btUnsigned32bitInt)0);
+      nvs.Add("ServiceExecutable", "libALI");
+      nvs.Add("ConfigRecord",      &sub);
+      nvs.Add((btNumberKey)1,      (btUnsigned64bitInt)i * 3);
+      nvs.Add((btNumberKey)2,      "tag");
+   }
+
+   static void Report(const char *what, btUnsignedInt Iters, const Timer &start)
+   {
+      Timer  elapsed = Timer() - start;
+      double secs    = 0.0;
+      elapsed.AsSeconds(secs);
+
+      std::cout << "[ BENCHMARK] " << std::setw(24) << std::left << what << std::right << " : "
+                << std::fixed << std::setprecision(0)
+                << ( (secs > 0.0) ? ((double)Iters / secs) : 0.0 )
+                << " ops/sec" << std::endl;
+   }
+};
+
+TEST_F(NVSBinary_f, aal0844)
+{
+   // WriteBinary() / ReadBinary() round-trip every value type under both key types,
+   // including string arrays and embedded NVS's, and produce the same NVS the text
+   // form does.
+
+   NamedValueSet nvs;
+   Fill(nvs);
+
+   std::string bin;
+   EXPECT_EQ(ENamedValuesOK, nvs.WriteBinary(bin));
+   EXPECT_EQ(0, bin.compare(0, 4, "NVSB"));
+
+   NamedValueSet fromBin;
+   EXPECT_EQ(ENamedValuesOK, fromBin.ReadBinary(bin.data(), bin.length()));
+   EXPECT_TRUE(nvs == fromBin);
+
+   // The text form of both is identical, name order included.
+   EXPECT_EQ(nvs.ToStr(), fromBin.ToStr());
+
+   INamedValueSet const *pInner = NULL;
+   INamedValueSet const *pInnermost = NULL;
+   btUnsigned32bitInt    depth = 0;
+   ASSERT_EQ(ENamedValuesOK, fromBin.Get("nvs", &pInner));
+   ASSERT_EQ(ENamedValuesOK, pInner->Get((btNumberKey)7, &pInnermost));
+   EXPECT_EQ(ENamedValuesOK, pInnermost->Get("depth", &depth));
+   EXPECT_EQ(2, depth);
+
+   btStringArray strs = NULL;
+   btWSSize      n    = 0;
+   ASSERT_EQ(ENamedValuesOK, fromBin.Get("strs", &strs));
+   EXPECT_EQ(ENamedValuesOK, fromBin.GetSize("strs", &n));
+   ASSERT_EQ(3, n);
+   EXPECT_STREQ("",          strs[0]);
+   EXPECT_STREQ("one",       strs[1]);
+   EXPECT_STREQ("two words", strs[2]);
+
+   // Reading into a non-empty NVS keeps the existing values.
+   NamedValueSet existing;
+   existing.Add("bool",  true);
+   existing.Add("extra", (btUnsigned32bitInt)7);
+   EXPECT_EQ(ENamedValuesOK, existing.ReadBinary(bin.data(), bin.length()));
+   btBool b = false;
+   EXPECT_EQ(ENamedValuesOK, existing.Get("bool", &b));
+   EXPECT_TRUE(b);
+   EXPECT_TRUE(existing.Has("extra"));
+   EXPECT_TRUE(existing.Has("nvs"));
+   EXPECT_TRUE(existing.Has((btNumberKey)0xffffffffffffffffULL));
+}
+
+TEST_F(NVSBinary_f, aal0845)
+{
+   // ReadBinary() rejects buffers that are not, or are truncated, binary NVS's.
+
+   NamedValueSet nvs;
+   Fill(nvs);
+
+   std::string bin;
+   nvs.WriteBinary(bin);
+
+   NamedValueSet out;
+   std::string   text = nvs.ToStr();
+   EXPECT_EQ(ENamedValuesBadType, out.ReadBinary(text.data(), text.length()));
+   EXPECT_EQ(ENamedValuesBadType, out.ReadBinary(bin.data(), 3));
+
+   std::string::size_type len;
+   for ( len = 4 ; len < bin.length() ; ++len ) {
+      NamedValueSet partial;
+      EXPECT_NE(ENamedValuesOK, partial.ReadBinary(bin.data(), len)) << len;
+   }
+
+   std::string badver(bin);
+   badver[4] ^= 0x80;
+   EXPECT_EQ(ENamedValuesNotSupported, out.ReadBinary(badver.data(), badver.length()));
+}
+
+TEST_F(NVSBinary_f, aal0846)
+{
+   // NVSMarshaller produces the binary form, and NVSUnMarshaller accepts both the
+   // binary and the text form.
+
+   NVSMarshaller m;
+   m.Add("name",  "value");
+   m.Add((btNumberKey)3, (btUnsigned64bitInt)0x1122334455667788ULL);
+
+   btWSSize  len  = 0;
+   btcString pmsg = m.pmsgp(&len);
+   ASSERT_NONNULL(pmsg);
+   ASSERT_LT(4, len);
+   EXPECT_EQ(0, memcmp(pmsg, "NVSB", 4));
+
+   NVSUnMarshaller u;
+   u.importmsg(pmsg, len);
+
+   btcString          s = NULL;
+   btUnsigned64bitInt v = 0;
+   EXPECT_EQ(ENamedValuesOK, u.Get("name", &s));
+   EXPECT_STREQ("value", s);
+   EXPECT_EQ(ENamedValuesOK, u.Get((btNumberKey)3, &v));
+   EXPECT_EQ(0x1122334455667788ULL, v);
+
+   // Text form, as sent by older peers.
+   NamedValueSet text;
+   text.Add("legacy", (btUnsigned32bitInt)9);
+   std::string str = text.ToStr();
+
+   u.importmsg(str.data(), str.length());
+   btUnsigned32bitInt u32 = 0;
+   EXPECT_EQ(ENamedValuesOK, u.Get("legacy", &u32));
+   EXPECT_EQ(9, u32);
+   EXPECT_FALSE(u.Has("name"));
+}
+
+TEST_F(NVSBinary_f, aal0847)
+{
+   // Merge() copies the entries whose names are not already present, leaving existing
+   // values alone, and the result is the same as the text-based merge.
+
+   NamedValueSet a;
+   a.Add("b", (btUnsigned32bitInt)1);
+   a.Add("d", (btUnsigned32bitInt)1);
+   a.Add((btNumberKey)5, "a5");
+
+   NamedValueSet b;
+   b.Add("a", (btUnsigned32bitInt)2);
+   b.Add("b", (btUnsigned32bitInt)2);
+   b.Add("c", "c");
+   b.Add("e", (btUnsigned32bitInt)2);
+   b.Add((btNumberKey)1, "b1");
+   b.Add((btNumberKey)5, "b5");
+   b.Add((btNumberKey)9, &a);
+
+   NamedValueSet viaText(a);
+   std::stringstream ss;
+   ss << b;
+   ss >> viaText;
+
+   EXPECT_EQ(ENamedValuesOK, a.Merge(b));
+   EXPECT_TRUE(a == viaText);
+
+   btUnsignedInt num = 0;
+   a.GetNumNames(&num);
+   EXPECT_EQ(8, num);
+
+   btUnsigned32bitInt u = 0;
+   btcString          s = NULL;
+   EXPECT_EQ(ENamedValuesOK, a.Get("b", &u));
+   EXPECT_EQ(1, u);
+   EXPECT_EQ(ENamedValuesOK, a.Get((btNumberKey)5, &s));
+   EXPECT_STREQ("a5", s);
+   EXPECT_EQ(ENamedValuesOK, a.Get("a", &u));
+   EXPECT_EQ(2, u);
+
+   // Names stay in key order: number keys first, then string keys.
+   btNumberKey nk = 0;
+   btStringKey sk = NULL;
+   EXPECT_EQ(ENamedValuesOK, a.GetName(0, &nk));
+   EXPECT_EQ(1, nk);
+   EXPECT_EQ(ENamedValuesOK, a.GetName(2, &nk));
+   EXPECT_EQ(9, nk);
+   EXPECT_EQ(ENamedValuesOK, a.GetName(3, &sk));
+   EXPECT_STREQ("a", sk);
+   EXPECT_EQ(ENamedValuesOK, a.GetName(7, &sk));
+   EXPECT_STREQ("e", sk);
+   EXPECT_NE(ENamedValuesOK, a.GetName(8, &sk));
+
+   // Deleting and re-adding keeps the order.
+   EXPECT_EQ(ENamedValuesOK, a.Delete("c"));
+   EXPECT_EQ(ENamedValuesOK, a.GetName(5, &sk));
+   EXPECT_STREQ("d", sk);
+   EXPECT_EQ(ENamedValuesOK, a.Add("c", (btUnsigned32bitInt)3));
+   EXPECT_EQ(ENamedValuesOK, a.GetName(5, &sk));
+   EXPECT_STREQ("c", sk);
+
+   // Self-merge is a no-op.
+   EXPECT_EQ(ENamedValuesOK, a.Merge(a));
+   a.GetNumNames(&num);
+   EXPECT_EQ(8, num);
+}
+
+TEST_F(NVSBinary_f, aal0848)
+{
+   // Microbenchmark: add, get, copy, merge and serialize throughput, with the text
+   // form and the text-based merge for comparison.
+
+   const btUnsignedInt Iters = 20000;
+   btUnsignedInt       i;
+
+   std::vector<NamedValueSet> msgs(Iters);
+
+   {
+      Timer start;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         FillMessage(msgs[i], i);
+      }
+      Report("add", Iters, start);
+   }
+
+   {
+      btUnsigned64bitInt sum = 0;
+      Timer start;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         btUnsigned64bitInt h = 0;
+         btUnsigned32bitInt b = 0;
+         btcString          s = NULL;
+         msgs[i].Get("AAL_keyRegHandle", &h);
+         msgs[i].Get("AAL_keyRegBus", &b);
+         msgs[i].Get("ServiceExecutable", &s);
+         sum += h + b + (NULL != s);
+      }
+      Report("get (x3)", Iters, start);
+      EXPECT_LT(0, sum);
+   }
+
+   {
+      Timer start;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         NamedValueSet copy(msgs[i]);
+      }
+      Report("copy", Iters, start);
+   }
+
+   NamedValueSet extra;
+   extra.Add("Extra1", (btUnsigned32bitInt)1);
+   extra.Add("Extra2", "two");
+   extra.Add("AAL_keyRegBus", (btUnsigned32bitInt)99);
+
+   {
+      Timer start;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         NamedValueSet m(msgs[i]);
+         m.Merge(extra);
+      }
+      Report("copy + merge", Iters, start);
+   }
+
+   {
+      Timer start;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         NamedValueSet m(msgs[i]);
+         std::stringstream ss;
+         ss << extra;
+         ss >> m;
+      }
+      Report("copy + merge (text)", Iters, start);
+   }
+
+   {
+      std::string bin;
+      Timer start;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         bin.clear();
+         msgs[i].WriteBinary(bin);
+         NamedValueSet out;
+         out.ReadBinary(bin.data(), bin.length());
+      }
+      Report("serialize (binary)", Iters, start);
+   }
+
+   {
+      Timer start;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         std::string s = msgs[i].ToStr();
+         NamedValueSet out;
+         out.FromStr(s);
+      }
+      Report("serialize (text)", Iters, start);
+   }
+
+   {
+      std::string bin;
+      msgs[0].WriteBinary(bin);
+      std::string text = msgs[0].ToStr();
+      std::cout << "[ BENCHMARK] message size : " << bin.length() << " bytes binary, "
+                << text.length() << " bytes text" << std::endl;
+   }
+}
+
+TEST_F(NVSBinary_f, aal0870)
+{
+   // ReadBinary() accepts embedded NVS's up to the nesting limit and rejects deeper
+   // ones. Interned string keys outlive the NVS they were added to for as long as
+   // another NVS holds them.
+
+   NamedValueSet nested;
+   NamedValueSet deeper;
+   std::string   bin;
+   btUnsignedInt i;
+
+   for ( i = 0 ; i < 64 ; ++i ) {
+      NamedValueSet outer;
+      outer.Add("nested", &nested);
+      nested = outer;
+   }
+
+   EXPECT_EQ(ENamedValuesOK, nested.WriteBinary(bin));
+   NamedValueSet ok;
+   EXPECT_EQ(ENamedValuesOK, ok.ReadBinary(bin.data(), bin.length()));
+   EXPECT_TRUE(nested == ok);
+
+   deeper.Add("nested", &nested);
+   bin.clear();
+   EXPECT_EQ(ENamedValuesOK, deeper.WriteBinary(bin));
+   NamedValueSet tooDeep;
+   EXPECT_EQ(ENamedValuesNotSupported, tooDeep.ReadBinary(bin.data(), bin.length()));
+
+   NamedValueSet *pSrc = new NamedValueSet();
+   pSrc->Add("aal0870 transient key", (btUnsigned32bitInt)1);
+   pSrc->Add("aal0870 other key",     (btUnsigned32bitInt)2);
+
+   NamedValueSet copy(*pSrc);
+   NamedValueSet merged;
+   merged.Merge(*pSrc);
+   delete pSrc;
+
+   btStringKey sk = NULL;
+   EXPECT_EQ(ENamedValuesOK, copy.GetName(1, &sk));
+   EXPECT_STREQ("aal0870 transient key", sk);
+
+   EXPECT_EQ(ENamedValuesOK, copy.Delete("aal0870 transient key"));
+   copy.Empty();
+   EXPECT_TRUE(merged.Has("aal0870 transient key"));
+   EXPECT_EQ(ENamedValuesOK, merged.GetName(0, &sk));
+   EXPECT_STREQ("aal0870 other key", sk);
+
+   // Re-adding a key after its last holder has gone interns it afresh.
+   merged.Empty();
+   NamedValueSet again;
+   EXPECT_EQ(ENamedValuesOK, again.Add("aal0870 transient key", (btUnsigned32bitInt)3));
+   EXPECT_EQ(ENamedValuesOK, again.GetName(0, &sk));
+   EXPECT_STREQ("aal0870 transient key", sk);
+}
@@ -4,6 +4,10 @@
 #endif // HAVE_CONFIG_H
 #include "gtCommon.h"
 
+#include <aalsdk/service/ALIOpen.h>
+#include <aalsdk/utils/NLBVAFU.h>
+#include <fstream>
+
 template <typename RTClient,  // EmptyIRuntimeClient, CallTrackingIRuntimeClient
           typename RT=Runtime>
 class TRuntime_Int_f_0 : public ::testing::Test
@@ -804,6 +808,333 @@ TEST_F(Runtime_Int_f_4, aal0799)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+
+// Starts the Runtime with a configuration record of the test's choosing.
+class Runtime_Int_f_5 : public TRuntime_Int_f_1<SynchronizingIRuntimeClient, SynchronizingSwvalSvcClient>
+{
+protected:
+   void Start(const NamedValueSet &ConfigRecord)
+   {
+      NamedValueSet args;
+      args.Add(AALRUNTIME_CONFIG_RECORD, &ConfigRecord);
+
+      EXPECT_TRUE(start(args));
+      m_RuntimeClient.Wait(); // for runtimeStarted()
+
+      ASSERT_EQ(1, m_RuntimeClient.LogEntries()) << m_RuntimeClient;
+      EXPECT_STREQ("IRuntimeClient::runtimeStarted", m_RuntimeClient.Entry(0).MethodName());
+      m_RuntimeClient.ClearLog();
+   }
+
+   void Stop()
+   {
+      stop();
+      m_RuntimeClient.Wait(); // for runtimeStopped()
+      m_RuntimeClient.ClearLog();
+   }
+
+   // Allocates libswvalsvcmod, returning its IBase *.
+   IBase * AllocSwvalSvc()
+   {
+      NamedValueSet manifest;
+      NamedValueSet configrec;
+
+      configrec.Add(AAL_FACTORY_CREATE_CONFIGRECORD_FULL_SERVICE_NAME, "libswvalsvcmod");
+      manifest.Add(AAL_FACTORY_CREATE_CONFIGRECORD_INCLUDED, &configrec);
+
+      allocService(&m_ServiceClient, manifest);
+
+      m_ServiceClient.Wait();
+      m_RuntimeClient.Wait();
+
+      btObjectType x = NULL;
+      EXPECT_EQ(1, m_ServiceClient.LogEntries());
+      EXPECT_STREQ("IServiceClient::serviceAllocated", m_ServiceClient.Entry(0).MethodName());
+      m_ServiceClient.Entry(0).GetParam("pBase", &x);
+
+      m_ServiceClient.ClearLog();
+      m_RuntimeClient.ClearLog();
+      return reinterpret_cast<IBase *>(x);
+   }
+
+   void Release(IBase *pServiceBase)
+   {
+      EXPECT_TRUE(dynamic_ptr<IAALService>(iidService, pServiceBase)->Release(TransactionID()));
+      m_ServiceClient.Wait();
+      m_ServiceClient.ClearLog();
+   }
+
+   // Whether a library whose path contains sName is mapped into this process.
+   static btBool IsMapped(btcString sName)
+   {
+#if defined( __AAL_LINUX__ )
+      std::ifstream maps("/proc/self/maps");
+      std::string   line;
+      while ( std::getline(maps, line) ) {
+         if ( std::string::npos != line.find(sName) ) {
+            return true;
+         }
+      }
+#endif // __AAL_LINUX__
+      return false;
+   }
+};
+
+TEST_F(Runtime_Int_f_5, aal0863)
+{
+   // When AALRUNTIME_CONFIG_PRELOAD_SERVICES names Service libraries, Runtime::start() loads
+   // them before IRuntimeClient::runtimeStarted(). Names that fail to load do not fail the start,
+   // and the preloaded library serves later allocations.
+
+   btcString     Names[] = { "libswvalsvcmod", "libaal0863_no_such_service" };
+   NamedValueSet ConfigRecord;
+   ConfigRecord.Add(AALRUNTIME_CONFIG_PRELOAD_SERVICES, const_cast<btStringArray>(Names), 2);
+
+   Start(ConfigRecord);
+
+#if defined( __AAL_LINUX__ )
+   EXPECT_TRUE(IsMapped("libswvalsvcmod"));
+#endif // __AAL_LINUX__
+
+   IBase *pServiceBase = AllocSwvalSvc();
+   ASSERT_NONNULL(pServiceBase);
+   EXPECT_NONNULL(dynamic_ptr<ISwvalSvcMod>(iidSwvalSvc, pServiceBase));
+   Release(pServiceBase);
+
+   // A second allocation reuses the same ServiceHost.
+   pServiceBase = AllocSwvalSvc();
+   ASSERT_NONNULL(pServiceBase);
+   Release(pServiceBase);
+
+   Stop();
+}
+
+TEST_F(Runtime_Int_f_5, aal0865)
+{
+   // ALIOpen() fails cleanly, returning NULL and leaving the Runtime usable, when given no
+   // AFU ID or an AFU ID that no device has. ALIClose(NULL) is a no-op.
+
+   EXPECT_EQ(0x0000, ALIOPEN_BDF(0, 0, 0));
+   EXPECT_EQ(0x5e0b, ALIOPEN_BDF(0x5e, 1, 3));
+   EXPECT_EQ(0xfffc, ALIOPEN_BDF(0x1ff, 0x3f, 0x0c));
+
+   ALIClose(NULL);
+
+   NamedValueSet ConfigRecord;
+   Start(ConfigRecord);
+
+   EXPECT_NULL(ALIOpen(NULL, ALIOPEN_ANY_BDF, 0, m_pRuntime));
+   EXPECT_NULL(ALIOpen("00000000-0000-0000-0000-00000AAL0865", ALIOPEN_BDF(0xff, 0x1f, 7), 0, m_pRuntime));
+
+   // The failed allocation is also reported to the Runtime's client. Consume it, or Stop() would
+   //  return before runtimeStopped().
+   m_RuntimeClient.Wait();
+   ASSERT_EQ(1, m_RuntimeClient.LogEntries()) << m_RuntimeClient;
+   EXPECT_STREQ("IRuntimeClient::runtimeAllocateServiceFailed", m_RuntimeClient.Entry(0).MethodName());
+   m_RuntimeClient.ClearLog();
+
+   IBase *pServiceBase = AllocSwvalSvc();
+   ASSERT_NONNULL(pServiceBase);
+   Release(pServiceBase);
+
+   Stop();
+}
+
+
+TEST_F(Runtime_Int_f_5, aal0866)
+{
+   // ALIOPEN_FLAG_SWSIM opens the AFU in the in-process software model, which needs no driver or
+   // simulator. The NLB model reports the AFU ID it was opened for, in its header, in the feature
+   // list and in the DSM, and in loopback mode copies src to dst and reports in the DSM.
+
+   btcString AFUId = "C000C966-0D82-4272-9AEF-FE5F84570612";
+
+   NamedValueSet ConfigRecord;
+   Start(ConfigRecord);
+
+   ALIDevice *pDev = ALIOpen(AFUId, ALIOPEN_ANY_BDF, ALIOPEN_FLAG_SWSIM, m_pRuntime);
+   ASSERT_NONNULL(pDev);
+   m_RuntimeClient.Wait(); // for runtimeAllocateServiceSucceeded()
+   m_RuntimeClient.ClearLog();
+
+   IALIMMIO   *pMMIO = pDev->MMIO();
+   IALIBuffer *pBuf  = pDev->Buffer();
+   ASSERT_NONNULL(pDev->Reset());
+   ASSERT_NONNULL(pDev->UMsg());
+
+   EXPECT_EQ(ALI_DFH_TYPE_AFU, ( pDev->DFH() >> 60 ) & 0xf);
+
+   btUnsigned64bitInt lo = 0;
+   btUnsigned64bitInt hi = 0;
+   EXPECT_TRUE(pMMIO->mmioRead64(8,    &lo));
+   EXPECT_TRUE(pMMIO->mmioRead64(0x10, &hi));
+   EXPECT_EQ(0x9AEFFE5F84570612ULL, lo);
+   EXPECT_EQ(0xC000C9660D824272ULL, hi);
+   EXPECT_FALSE(pMMIO->mmioRead64(pMMIO->mmioGetLength(), &lo));
+
+   NamedValueSet Filter;
+   NamedValueSet Out;
+   btCSROffset   Offset = 1;
+   btcString     GUID   = NULL;
+   Filter.Add(ALI_GETFEATURE_TYPE_KEY, static_cast<ALI_GETFEATURE_TYPE_DATATYPE>(ALI_DFH_TYPE_AFU));
+   EXPECT_TRUE(pMMIO->mmioGetFeatureOffset(&Offset, Filter, Out));
+   EXPECT_EQ(0, Offset);
+   EXPECT_EQ(ENamedValuesOK, Out.Get(ALI_GETFEATURE_GUID_KEY, &GUID));
+   EXPECT_STRCASEEQ(AFUId, GUID);
+
+   btVirtAddr pDSM = NULL;
+   btVirtAddr pSrc = NULL;
+   btVirtAddr pDst = NULL;
+   const btWSSize Lines = 1024;
+   ASSERT_EQ(ali_errnumOK, pBuf->bufferAllocate(NLB_DSM_SIZE, &pDSM));
+   ASSERT_EQ(ali_errnumOK, pBuf->bufferAllocate(CL(Lines), &pSrc));
+   ASSERT_EQ(ali_errnumOK, pBuf->bufferAllocate(CL(Lines), &pDst));
+
+   // IOVAs are not virtual addresses, and cover the whole of each buffer.
+   EXPECT_NE((btPhysAddr)pSrc, pBuf->bufferGetIOVA(pSrc));
+   EXPECT_EQ(pBuf->bufferGetIOVA(pSrc) + CL(1), pBuf->bufferGetIOVA(pSrc + CL(1)));
+
+   btWSSize i;
+   for ( i = 0 ; i < CL(Lines) ; ++i ) {
+      pSrc[i] = (btByte)( i * 7 + 3 );
+   }
+
+   volatile nlb_vafu_dsm *pAFUDSM = (volatile nlb_vafu_dsm *)pDSM;
+
+   EXPECT_EQ(IALIReset::e_OK, pDev->Reset()->afuReset());
+   EXPECT_TRUE(pMMIO->mmioWrite64(CSR_AFU_DSM_BASEL, pBuf->bufferGetIOVA(pDSM)));
+   EXPECT_EQ(0x84570612, pAFUDSM->afuid[0]);
+   EXPECT_EQ(0xC000C966, pAFUDSM->afuid[3]);
+
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 0));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 1));
+   EXPECT_TRUE(pMMIO->mmioWrite64(CSR_SRC_ADDR, CACHELINE_ALIGNED_ADDR(pBuf->bufferGetIOVA(pSrc))));
+   EXPECT_TRUE(pMMIO->mmioWrite64(CSR_DST_ADDR, CACHELINE_ALIGNED_ADDR(pBuf->bufferGetIOVA(pDst))));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_NUM_LINES, (btUnsigned32bitInt)Lines));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CFG, NLB_TEST_MODE_LPBK1));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 3));
+
+   btUnsignedInt polls = 0;
+   while ( ( 0 == pAFUDSM->test_complete ) && ( polls++ < 5000 ) ) {
+      SleepMilli(1);
+   }
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 7));
+
+   ASSERT_NE(0, pAFUDSM->test_complete);
+   EXPECT_EQ(0, pAFUDSM->test_error);
+   EXPECT_EQ(Lines, pAFUDSM->num_reads);
+   EXPECT_EQ(Lines, pAFUDSM->num_writes);
+   EXPECT_LT(0, pAFUDSM->num_clocks);
+   EXPECT_EQ(0, ::memcmp(pSrc, pDst, CL(Lines)));
+
+   // A source address outside every buffer is a response error, not a fault.
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 0));
+   ::memset((void *)pAFUDSM, 0, sizeof(nlb_vafu_dsm));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 1));
+   EXPECT_TRUE(pMMIO->mmioWrite64(CSR_SRC_ADDR, CACHELINE_ALIGNED_ADDR(pBuf->bufferGetIOVA(pDst) + CL(Lines) + MB(64))));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 3));
+
+   polls = 0;
+   while ( ( 0 == pAFUDSM->test_complete ) && ( polls++ < 5000 ) ) {
+      SleepMilli(1);
+   }
+   EXPECT_NE(0, pAFUDSM->test_complete);
+   EXPECT_NE(0, pAFUDSM->test_error);
+
+   EXPECT_EQ(ali_errnumOK, pBuf->bufferFree(pDst));
+   EXPECT_EQ(ali_errnumOK, pBuf->bufferFree(pSrc));
+   EXPECT_EQ(ali_errnumOK, pBuf->bufferFree(pDSM));
+   EXPECT_EQ(ali_errnumBadParameter, pBuf->bufferFree(pDSM));
+
+   ALIClose(pDev);
+
+   Stop();
+}
+
+TEST_F(Runtime_Int_f_5, aal0867)
+{
+   // The NLB model's SW mode copies src to dst, flags dst, then waits for the host's notice
+   // before checking that the host copied dst back to src. With CSR-write notice, the notice is
+   // a write to CSR_SW_NOTICE.
+
+   NamedValueSet ConfigRecord;
+   Start(ConfigRecord);
+
+   ALIDevice *pDev = ALIOpen(NULL, ALIOPEN_ANY_BDF, ALIOPEN_FLAG_SWSIM, m_pRuntime);
+   ASSERT_NONNULL(pDev);
+   m_RuntimeClient.Wait(); // for runtimeAllocateServiceSucceeded()
+   m_RuntimeClient.ClearLog();
+
+   IALIMMIO   *pMMIO = pDev->MMIO();
+   IALIBuffer *pBuf  = pDev->Buffer();
+
+   btVirtAddr pDSM = NULL;
+   btVirtAddr pSrc = NULL;
+   btVirtAddr pDst = NULL;
+   const btWSSize Lines = 64;
+   ASSERT_EQ(ali_errnumOK, pBuf->bufferAllocate(NLB_DSM_SIZE, &pDSM));
+   ASSERT_EQ(ali_errnumOK, pBuf->bufferAllocate(CL(Lines + 1), &pSrc));
+   ASSERT_EQ(ali_errnumOK, pBuf->bufferAllocate(CL(Lines + 1), &pDst));
+
+   ::memset(pSrc, 0xa5, CL(Lines));
+   ::memset(pSrc + CL(Lines), 0, CL(1));
+   ::memset(pDst, 0, CL(Lines + 1));
+
+   volatile nlb_vafu_dsm *pAFUDSM = (volatile nlb_vafu_dsm *)pDSM;
+
+   EXPECT_EQ(IALIReset::e_OK, pDev->Reset()->afuReset());
+   EXPECT_TRUE(pMMIO->mmioWrite64(CSR_AFU_DSM_BASEL, pBuf->bufferGetIOVA(pDSM)));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 0));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 1));
+   EXPECT_TRUE(pMMIO->mmioWrite64(CSR_SRC_ADDR, CACHELINE_ALIGNED_ADDR(pBuf->bufferGetIOVA(pSrc))));
+   EXPECT_TRUE(pMMIO->mmioWrite64(CSR_DST_ADDR, CACHELINE_ALIGNED_ADDR(pBuf->bufferGetIOVA(pDst))));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_NUM_LINES, (btUnsigned32bitInt)Lines));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CFG, NLB_TEST_MODE_SW | NLB_TEST_MODE_CSR_WRITE));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 3));
+
+   volatile btUnsigned32bitInt *pFlag = (volatile btUnsigned32bitInt *)( pDst + CL(Lines) );
+   btUnsignedInt polls = 0;
+   while ( ( 0 == *pFlag ) && ( polls++ < 5000 ) ) {
+      SleepMilli(1);
+   }
+   ASSERT_NE(0, *pFlag);
+   EXPECT_EQ(0, ::memcmp(pSrc, pDst, CL(Lines)));
+
+   // Not complete until the host gives notice.
+   SleepMilli(10);
+   EXPECT_EQ(0, pAFUDSM->test_complete);
+
+   ::memcpy(pSrc, pDst, CL(Lines));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_SW_NOTICE, 0x10101010));
+
+   polls = 0;
+   while ( ( 0 == pAFUDSM->test_complete ) && ( polls++ < 5000 ) ) {
+      SleepMilli(1);
+   }
+   EXPECT_NE(0, pAFUDSM->test_complete);
+   EXPECT_EQ(0, pAFUDSM->test_error);
+
+   // Reset aborts a test that is waiting for notice.
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 0));
+   ::memset((void *)pAFUDSM, 0, sizeof(nlb_vafu_dsm));
+   *pFlag = 0;
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 1));
+   EXPECT_TRUE(pMMIO->mmioWrite32(CSR_CTL, 3));
+
+   polls = 0;
+   while ( ( 0 == *pFlag ) && ( polls++ < 5000 ) ) {
+      SleepMilli(1);
+   }
+   ASSERT_NE(0, *pFlag);
+   EXPECT_EQ(IALIReset::e_OK, pDev->Reset()->afuReset());
+   EXPECT_EQ(0, pAFUDSM->test_complete);
+
+   ALIClose(pDev);
+
+   Stop();
+}
+
 
 
 /*
@@ -21,7 +21,7 @@ public:
       _ServiceBroker(pSvcMod, pRuntime, pTransport, pMarshaller, pUnMarshaller)
    {}
 
-   ServiceHost * Host(std::string const &sName) { return findServiceHost(sName); }
+   ServiceHost * Host(std::string const &sName) { return findServiceHost(sName.c_str()); }
 };
 
 ////////////////////////////////////////////////////////////////////////////////
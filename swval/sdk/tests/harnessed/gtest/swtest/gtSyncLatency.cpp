@@ -0,0 +1,266 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtCommon.h"
+#include "aalsdk/osal/Timer.h"
+#include <iomanip>
+
+class SyncLatency_f : public ::testing::Test
+{
+public:
+   SyncLatency_f() {}
+
+   virtual void SetUp()
+   {
+      m_Errors = 0;
+   }
+
+   // CriticalSection::Lock() is protected; AutoLock() reaches it through a subclass.
+   class Locked : public CriticalSection
+   {
+   public:
+      Locked() : m_n(0) {}
+      void Inc() { AutoLock(this); ++m_n; }
+      btUnsigned64bitInt m_n;
+   };
+
+   struct PingPong
+   {
+      CSemaphore    m_Ping;
+      CSemaphore    m_Pong;
+      btUnsignedInt m_Iters;
+   };
+
+   static void PongThread(OSLThread *pThread, void *pContext)
+   {
+      PingPong *p = reinterpret_cast<PingPong *>(pContext);
+      btUnsignedInt i;
+      for ( i = 0 ; i < p->m_Iters ; ++i ) {
+         p->m_Ping.Wait();
+         p->m_Pong.Post(1);
+      }
+   }
+
+   struct Producer
+   {
+      CSemaphore   *m_pSem;
+      btUnsignedInt m_Count;
+   };
+
+   static void PostThread(OSLThread *pThread, void *pContext)
+   {
+      Producer *p = reinterpret_cast<Producer *>(pContext);
+      btUnsignedInt i;
+      for ( i = 0 ; i < p->m_Count ; ) {
+         if ( p->m_pSem->Post(1) ) {
+            ++i;
+         } else {
+            cpu_yield();
+         }
+      }
+   }
+
+   static void WaitThread(OSLThread *pThread, void *pContext)
+   {
+      Producer *p = reinterpret_cast<Producer *>(pContext);
+      btUnsignedInt i;
+      for ( i = 0 ; i < p->m_Count ; ++i ) {
+         p->m_pSem->Wait();
+      }
+   }
+
+   static double Seconds(const Timer &start)
+   {
+      Timer  elapsed = Timer() - start;
+      double secs    = 0.0;
+      elapsed.AsSeconds(secs);
+      return secs;
+   }
+
+   static void Report(const char *what, double secs, btUnsignedInt Iters)
+   {
+      std::cout << "[ BENCHMARK] " << std::setw(34) << std::left << what << std::right << " : "
+                << std::fixed << std::setprecision(1)
+                << ( (Iters > 0) ? ((secs * 1.0e9) / (double)Iters) : 0.0 )
+                << " ns/op" << std::endl;
+   }
+
+   btUnsignedInt m_Errors;
+};
+
+TEST_F(SyncLatency_f, aal0849)
+{
+   // The lock-free CSemaphore Post() / Wait() paths keep the max count and count-up
+   // semantics, and a timed Wait() that expires waits at least its timeout.
+
+   CSemaphore sem;
+   ASSERT_TRUE(sem.Create(0, 2));
+
+   EXPECT_EQ(0, sem.SpinCount());
+   sem.SpinCount(100);
+   EXPECT_EQ(100, sem.SpinCount());
+
+   EXPECT_TRUE(sem.Post(1));
+   EXPECT_TRUE(sem.Post(1));
+   EXPECT_FALSE(sem.Post(1)); // would exceed max count
+
+   btInt cur = 0;
+   btInt max = 0;
+   EXPECT_TRUE(sem.CurrCounts(cur, max));
+   EXPECT_EQ(2, cur);
+   EXPECT_EQ(2, max);
+
+   EXPECT_TRUE(sem.Wait());
+   EXPECT_TRUE(sem.Wait(0));
+
+   Timer start;
+   EXPECT_FALSE(sem.Wait(50));
+   EXPECT_LE(0.049, Seconds(start));
+   EXPECT_EQ(0, sem.NumWaiters());
+
+   // Count up: -3 needs three Posts before a Wait succeeds.
+   CSemaphore up;
+   ASSERT_TRUE(up.Create(-3));
+   EXPECT_TRUE(up.Post(1));
+   EXPECT_TRUE(up.Post(1));
+   EXPECT_FALSE(up.Wait(10));
+   EXPECT_TRUE(up.Post(1));
+   EXPECT_TRUE(up.Wait(10));
+
+   // Several producers and consumers hand over every count exactly once.
+   const btUnsignedInt Threads = 3;
+   const btUnsignedInt Count   = 20000;
+
+   CSemaphore shared;
+   ASSERT_TRUE(shared.Create(0, 8));
+   shared.SpinCount(50);
+
+   Producer   ctx = { &shared, Count };
+   OSLThread *pThrs[2 * Threads];
+   btUnsignedInt t;
+
+   for ( t = 0 ; t < Threads ; ++t ) {
+      pThrs[t]           = new OSLThread(SyncLatency_f::WaitThread, OSLThread::THREADPRIORITY_NORMAL, &ctx);
+      pThrs[Threads + t] = new OSLThread(SyncLatency_f::PostThread, OSLThread::THREADPRIORITY_NORMAL, &ctx);
+   }
+   for ( t = 0 ; t < 2 * Threads ; ++t ) {
+      pThrs[t]->Join();
+      delete pThrs[t];
+   }
+
+   EXPECT_TRUE(shared.CurrCounts(cur, max));
+   EXPECT_EQ(0, cur);
+   EXPECT_EQ(0, shared.NumWaiters());
+}
+
+TEST_F(SyncLatency_f, aal0850)
+{
+   // Wait() on an open manual-reset Barrier returns true without blocking, UnblockAll()
+   // still fails later waiters, and a timed Wait() that expires waits at least its timeout.
+
+   Barrier b;
+   ASSERT_TRUE(b.Create(2, false));
+
+   EXPECT_EQ(0, b.SpinCount());
+   b.SpinCount(10);
+   EXPECT_EQ(10, b.SpinCount());
+
+   Timer start;
+   EXPECT_FALSE(b.Wait(50));
+   EXPECT_LE(0.049, Seconds(start));
+
+   EXPECT_TRUE(b.Post(2));
+   EXPECT_TRUE(b.Wait());
+   EXPECT_TRUE(b.Wait(0));
+   EXPECT_EQ(0, b.NumWaiters());
+
+   EXPECT_TRUE(b.Reset());
+   EXPECT_FALSE(b.Wait(10));
+
+   EXPECT_TRUE(b.Destroy());
+   EXPECT_FALSE(b.Wait());
+
+   // An auto-reset Barrier closes again once its waiters resume.
+   Barrier a;
+   ASSERT_TRUE(a.Create(1, true));
+   EXPECT_TRUE(a.Post(1));
+   EXPECT_FALSE(a.Wait(10));
+}
+
+TEST_F(SyncLatency_f, aal0851)
+{
+   // Microbenchmark: uncontended acquire cost of CriticalSection, CSemaphore and Barrier.
+
+   const btUnsignedInt Iters = 2000000;
+   btUnsignedInt i;
+
+   Locked cs;
+   Timer  start;
+   for ( i = 0 ; i < Iters ; ++i ) {
+      cs.Inc();
+   }
+   Report("CriticalSection lock/unlock", Seconds(start), Iters);
+   EXPECT_EQ(Iters, cs.m_n);
+
+   CSemaphore sem;
+   ASSERT_TRUE(sem.Create(0, 1));
+   start = Timer();
+   for ( i = 0 ; i < Iters ; ++i ) {
+      sem.Post(1);
+      sem.Wait();
+   }
+   Report("CSemaphore Post + Wait", Seconds(start), Iters);
+
+   start = Timer();
+   for ( i = 0 ; i < Iters ; ++i ) {
+      sem.Wait(0);
+   }
+   Report("CSemaphore Wait(0) on zero count", Seconds(start), Iters);
+
+   Barrier b;
+   ASSERT_TRUE(b.Create(1, false));
+   ASSERT_TRUE(b.Post(1));
+   start = Timer();
+   for ( i = 0 ; i < Iters ; ++i ) {
+      b.Wait();
+   }
+   Report("Barrier Wait (open)", Seconds(start), Iters);
+}
+
+TEST_F(SyncLatency_f, aal0852)
+{
+   // Microbenchmark: CSemaphore wake-up latency, as half of a two-thread ping-pong round
+   // trip, with and without a spin phase before sleeping.
+
+   const btUnsignedInt Iters = 20000;
+   const btUnsignedInt Spins[] = { 0, 2000 };
+   btUnsignedInt s;
+   btUnsignedInt i;
+
+   for ( s = 0 ; s < sizeof(Spins) / sizeof(Spins[0]) ; ++s ) {
+      PingPong pp;
+      ASSERT_TRUE(pp.m_Ping.Create(0, 1));
+      ASSERT_TRUE(pp.m_Pong.Create(0, 1));
+      pp.m_Ping.SpinCount(Spins[s]);
+      pp.m_Pong.SpinCount(Spins[s]);
+      pp.m_Iters = Iters;
+
+      OSLThread *pThr = new OSLThread(SyncLatency_f::PongThread, OSLThread::THREADPRIORITY_NORMAL, &pp);
+
+      Timer start;
+      for ( i = 0 ; i < Iters ; ++i ) {
+         EXPECT_TRUE(pp.m_Ping.Post(1));
+         EXPECT_TRUE(pp.m_Pong.Wait());
+      }
+      double secs = Seconds(start);
+
+      pThr->Join();
+      delete pThr;
+
+      std::ostringstream oss;
+      oss << "CSemaphore wake-up, spin " << Spins[s];
+      Report(oss.str().c_str(), secs, 2 * Iters);
+   }
+}
+
@@ -0,0 +1,361 @@
+// INTEL CONFIDENTIAL - For Intel Internal Use Only
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif // HAVE_CONFIG_H
+#include "gtThreadGroup.h"
+#include "aalsdk/osal/Timer.h"
+#include <iomanip>
+
+static AAL::btInt AtomicInc(volatile AAL::btInt *p)
+{
+#if   defined( __AAL_WINDOWS__ )
+   return (AAL::btInt) InterlockedIncrement((volatile LONG *)p);
+#elif defined( __AAL_LINUX__ )
+   return __sync_add_and_fetch(p, 1);
+#endif // OS
+}
+
+// Counts its execution, and deletes itself.
+class SelfDelCountD : public IDispatchable
+{
+public:
+   SelfDelCountD(volatile AAL::btInt *pCount) :
+      m_pCount(pCount)
+   {}
+   virtual void operator() ()
+   {
+      AtomicInc(m_pCount);
+      delete this;
+   }
+protected:
+   volatile AAL::btInt *m_pCount;
+};
+
+// Counts its destruction, whether or not it was executed.
+class CountDtorD : public IDispatchable
+{
+public:
+   CountDtorD(volatile AAL::btInt *pRan, volatile AAL::btInt *pDeleted) :
+      m_pRan(pRan),
+      m_pDeleted(pDeleted)
+   {}
+   virtual ~CountDtorD() { AtomicInc(m_pDeleted); }
+   virtual void operator() ()
+   {
+      AtomicInc(m_pRan);
+      delete this;
+   }
+protected:
+   volatile AAL::btInt *m_pRan;
+   volatile AAL::btInt *m_pDeleted;
+};
+
+// Adds work items to the thread group from within a worker, then Drain()'s it.
+// Add() is refused while another Drain() is in progress.
+class AddThenDrainD : public IDispatchable
+{
+public:
+   AddThenDrainD(OSLThreadGroup      *pTG,
+                 AAL::btUnsignedInt   NumToAdd,
+                 volatile AAL::btInt *pCount,
+                 volatile AAL::btInt *pDone) :
+      m_pTG(pTG),
+      m_NumToAdd(NumToAdd),
+      m_pCount(pCount),
+      m_pDone(pDone)
+   {}
+   virtual void operator() ()
+   {
+      AAL::btUnsignedInt i;
+      for ( i = 0 ; i < m_NumToAdd ; ++i ) {
+         IDispatchable *pDisp = new SelfDelCountD(m_pCount);
+         if ( !m_pTG->Add(pDisp) ) {
+            delete pDisp;
+         }
+      }
+      EXPECT_TRUE(m_pTG->Drain());
+      AtomicInc(m_pDone);
+      delete this;
+   }
+protected:
+   OSLThreadGroup      *m_pTG;
+   AAL::btUnsignedInt   m_NumToAdd;
+   volatile AAL::btInt *m_pCount;
+   volatile AAL::btInt *m_pDone;
+};
+
+class OSAL_ThreadGroupPolicy_vp : public ::testing::TestWithParam< OSLThreadGroup::Policy >
+{
+protected:
+   OSAL_ThreadGroupPolicy_vp() :
+      m_pGroup(NULL),
+      m_Count(0),
+      m_Deleted(0)
+   {}
+
+   virtual void SetUp()
+   {
+      m_Count   = 0;
+      m_Deleted = 0;
+   }
+
+   virtual void TearDown()
+   {
+      if ( NULL != m_pGroup ) {
+         delete m_pGroup;
+         m_pGroup = NULL;
+      }
+
+      YIELD_WHILE(CurrentThreads() > 0);
+
+      m_Sems[0].Destroy();
+      m_Sems[1].Destroy();
+   }
+
+   OSLThreadGroup * Create(AAL::btUnsignedInt Thrs)
+   {
+      return m_pGroup = new OSLThreadGroup(Thrs,
+                                           0,
+                                           OSLThread::THREADPRIORITY_NORMAL,
+                                           AAL_INFINITE_WAIT,
+                                           GetParam());
+   }
+
+   AAL::btUnsignedInt CurrentThreads() const { return (AAL::btUnsignedInt) GlobalTestConfig::GetInstance().CurrentThreads(); }
+
+   OSLThreadGroup     *m_pGroup;
+   volatile AAL::btInt m_Count;
+   volatile AAL::btInt m_Deleted;
+   CSemaphore          m_Sems[2];
+};
+
+TEST_P(OSAL_ThreadGroupPolicy_vp, aal0833)
+{
+   // With either policy, Drain() returns only after every queued work item has executed
+   // exactly once, and Join() then retires all workers.
+
+   const AAL::btUnsignedInt Thrs  = 8;
+   const AAL::btInt         Items = 10000;
+
+   OSLThreadGroup *g = Create(Thrs);
+   ASSERT_NONNULL(g);
+   ASSERT_TRUE(g->IsOK());
+   EXPECT_EQ(Thrs, g->GetNumThreads());
+
+   AAL::btInt i;
+   for ( i = 0 ; i < Items ; ++i ) {
+      EXPECT_TRUE(g->Add( new SelfDelCountD(&m_Count) ));
+   }
+
+   EXPECT_TRUE(g->Drain());
+   EXPECT_EQ(Items, m_Count);
+   EXPECT_EQ(0, g->GetNumWorkItems());
+
+   EXPECT_TRUE(g->Join(AAL_INFINITE_WAIT));
+   EXPECT_EQ(0, g->GetNumThreads());
+}
+
+TEST_P(OSAL_ThreadGroupPolicy_vp, aal0834)
+{
+   // With either policy, Stop() deletes the queued work items without executing them and
+   // refuses new ones until Start(), after which work is dispatched again.
+
+   const AAL::btUnsignedInt Thrs   = 4;
+   const AAL::btInt         Queued = 100;
+
+   OSLThreadGroup *g = Create(Thrs);
+   ASSERT_NONNULL(g);
+   ASSERT_TRUE(g->IsOK());
+
+   // Occupy every worker.
+   ASSERT_TRUE(m_Sems[0].Create(-(AAL::btInt)Thrs, 1));
+   ASSERT_TRUE(m_Sems[1].Create(0, INT_MAX));
+
+   std::list<IDispatchable *> blockers;
+   AAL::btUnsignedInt t;
+   for ( t = 0 ; t < Thrs ; ++t ) {
+      blockers.push_back(new PostThenWaitD(m_Sems[0], m_Sems[1]));
+      EXPECT_TRUE(g->Add(blockers.back()));
+   }
+   EXPECT_TRUE(m_Sems[0].Wait());
+
+   AAL::btInt i;
+   for ( i = 0 ; i < Queued ; ++i ) {
+      EXPECT_TRUE(g->Add( new CountDtorD(&m_Count, &m_Deleted) ));
+   }
+   EXPECT_EQ(Queued, g->GetNumWorkItems());
+
+   g->Stop();
+   EXPECT_EQ(0, g->GetNumWorkItems());
+   EXPECT_EQ(Queued, m_Deleted);
+   EXPECT_EQ(0, m_Count);
+
+   IDispatchable *pRefused = new CountDtorD(&m_Count, &m_Deleted);
+   EXPECT_FALSE(g->Add(pRefused));
+   delete pRefused;
+
+   EXPECT_TRUE(g->Start());
+   EXPECT_TRUE(m_Sems[1].Post(Thrs));
+
+   EXPECT_TRUE(g->Add( new CountDtorD(&m_Count, &m_Deleted) ));
+   EXPECT_TRUE(g->Drain());
+   YIELD_WHILE(m_Count < 1);
+   EXPECT_EQ(1, m_Count);
+
+   EXPECT_TRUE(g->Join(AAL_INFINITE_WAIT));
+
+   std::list<IDispatchable *>::iterator iter;
+   for ( iter = blockers.begin() ; blockers.end() != iter ; ++iter ) {
+      delete *iter;
+   }
+}
+
+TEST_P(OSAL_ThreadGroupPolicy_vp, aal0835)
+{
+   // With either policy, workers may Add() work and then Drain() the thread group from within
+   // a work item (self-referential, nested Drain()), concurrently with an external Drain().
+
+   const AAL::btUnsignedInt Thrs     = 4;
+   const AAL::btUnsignedInt Drainers = 8;
+   const AAL::btUnsignedInt PerItem  = 100;
+
+   OSLThreadGroup *g = Create(Thrs);
+   ASSERT_NONNULL(g);
+   ASSERT_TRUE(g->IsOK());
+
+   AAL::btUnsignedInt i;
+   for ( i = 0 ; i < Drainers ; ++i ) {
+      EXPECT_TRUE(g->Add( new AddThenDrainD(g, PerItem, &m_Count, &m_Deleted) ));
+   }
+
+   EXPECT_TRUE(g->Drain());
+   YIELD_WHILE(m_Deleted < (AAL::btInt)Drainers);
+   EXPECT_TRUE(g->Drain());
+   EXPECT_EQ(0, g->GetNumWorkItems());
+
+   // Work items refused while a Drain() was in progress never ran.
+   EXPECT_GE(Drainers * PerItem, (AAL::btUnsignedInt)m_Count);
+
+   EXPECT_TRUE(g->Join(AAL_INFINITE_WAIT));
+}
+
+TEST_P(OSAL_ThreadGroupPolicy_vp, aal0836)
+{
+   // A work item that blocks until a later work item runs does not deadlock the thread group,
+   // regardless of which worker's queue the later item lands on.
+
+   const AAL::btUnsignedInt Thrs   = 2;
+   const AAL::btInt         Rounds = 500;
+
+   OSLThreadGroup *g = Create(Thrs);
+   ASSERT_NONNULL(g);
+   ASSERT_TRUE(g->IsOK());
+
+   ASSERT_TRUE(m_Sems[0].Create(0, INT_MAX));
+   ASSERT_TRUE(m_Sems[1].Create(0, INT_MAX));
+
+   WaitD waiter(m_Sems[0]);
+   PostD poster(m_Sems[0]);
+   PostD done(m_Sems[1]);
+
+   AAL::btInt r;
+   for ( r = 0 ; r < Rounds ; ++r ) {
+      EXPECT_TRUE(g->Add(&waiter));
+      EXPECT_TRUE(g->Add(&poster));
+      EXPECT_TRUE(g->Add(&done));
+      ASSERT_TRUE(m_Sems[1].Wait(5000));
+   }
+
+   EXPECT_TRUE(g->Drain());
+   EXPECT_TRUE(g->Join(AAL_INFINITE_WAIT));
+}
+
+INSTANTIATE_TEST_CASE_P(MyThrGrPolicy, OSAL_ThreadGroupPolicy_vp,
+                        ::testing::Values(OSLThreadGroup::SharedQueue, OSLThreadGroup::WorkStealing));
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Adds tiny work items to a thread group as fast as possible.
+class ThrGrpProducer
+{
+public:
+   ThrGrpProducer(OSLThreadGroup *pTG, AAL::btInt Items, volatile AAL::btInt *pCount) :
+      m_pTG(pTG),
+      m_Items(Items),
+      m_pCount(pCount),
+      m_pThread(NULL)
+   {}
+
+   void Start() { m_pThread = new OSLThread(ThrGrpProducer::Thread, OSLThread::THREADPRIORITY_NORMAL, this); }
+   void Join()  { m_pThread->Join(); delete m_pThread; m_pThread = NULL; }
+
+protected:
+   static void Thread(OSLThread *pThread, void *pContext)
+   {
+      ThrGrpProducer *p = reinterpret_cast<ThrGrpProducer *>(pContext);
+      AAL::btInt i;
+      for ( i = 0 ; i < p->m_Items ; ++i ) {
+         p->m_pTG->Add( new SelfDelCountD(p->m_pCount) );
+      }
+   }
+
+   OSLThreadGroup      *m_pTG;
+   AAL::btInt           m_Items;
+   volatile AAL::btInt *m_pCount;
+   OSLThread           *m_pThread;
+};
+
+TEST(OSAL_ThreadGroupPolicy, aal0837)
+{
+   // Microbenchmark: work items/sec through OSLThreadGroup with 4 external producers,
+   // SharedQueue vs. WorkStealing, for increasing worker counts.
+
+   const AAL::btUnsignedInt Workers[]  = { 1, 2, 4, 8, 16 };
+   const AAL::btUnsignedInt Producers  = 4;
+   const AAL::btInt         PerProducer = 50000;
+
+   const OSLThreadGroup::Policy Policies[] = { OSLThreadGroup::SharedQueue, OSLThreadGroup::WorkStealing };
+   const char                  *Names[]    = { "SharedQueue ", "WorkStealing" };
+
+   AAL::btUnsignedInt w;
+   AAL::btUnsignedInt p;
+   AAL::btUnsignedInt i;
+
+   for ( w = 0 ; w < sizeof(Workers) / sizeof(Workers[0]) ; ++w ) {
+      for ( p = 0 ; p < sizeof(Policies) / sizeof(Policies[0]) ; ++p ) {
+
+         volatile AAL::btInt count = 0;
+         OSLThreadGroup      g(Workers[w], 0, OSLThread::THREADPRIORITY_NORMAL, AAL_INFINITE_WAIT, Policies[p]);
+         ASSERT_TRUE(g.IsOK());
+
+         std::vector<ThrGrpProducer *> producers;
+         for ( i = 0 ; i < Producers ; ++i ) {
+            producers.push_back(new ThrGrpProducer(&g, PerProducer, &count));
+         }
+
+         Timer start;
+
+         for ( i = 0 ; i < Producers ; ++i ) {
+            producers[i]->Start();
+         }
+         for ( i = 0 ; i < Producers ; ++i ) {
+            producers[i]->Join();
+            delete producers[i];
+         }
+
+         const AAL::btInt total = (AAL::btInt)Producers * PerProducer;
+         YIELD_WHILE(count < total);
+
+         Timer  elapsed = Timer() - start;
+         double secs    = 0.0;
+         elapsed.AsSeconds(secs);
+
+         EXPECT_EQ(total, count);
+         std::cout << "[ BENCHMARK] " << Names[p] << " " << std::setw(2) << Workers[w] << " workers : "
+                   << std::fixed << std::setprecision(0)
+                   << ( (secs > 0.0) ? ((double)total / secs) : 0.0 )
+                   << " items/sec" << std::endl;
+      }
+   }
+}
+
@@ -15,6 +15,7 @@ int main(int argc, char* argv[])
     argparse("bitstream",   'b', optional_argument);
     argparse("config",      'C', optional_argument);
     argparse("ase",         'A', no_argument);
+    argparse("swsim",       'W', no_argument);
     argparse("perfc",       'P', no_argument);
     argparse("stats",       'S', optional_argument);
 
@@ -29,7 +30,8 @@ int main(int argc, char* argv[])
     auto test_mode = argparse.get_string("mode", "loopback");
     auto stats = argparse.get_string("stats", "stdout");
 
-    auto env = argparse.have("ase") ? service_manager::hwenv_t::ase : service_manager::hwenv_t::hw;
+    auto env = argparse.have("ase")   ? service_manager::hwenv_t::ase :
+               argparse.have("swsim") ? service_manager::hwenv_t::swsim : service_manager::hwenv_t::hw;
 
     auto sm = service_manager::instance(env);
     sm->define_services(services);
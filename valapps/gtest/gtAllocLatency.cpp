@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <vector>
+#include "test_context.h"
+#include "afu_client.h"
+#include "service_manager.h"
+
+using namespace std;
+using namespace AAL;
+
+class alloc_latency_f : public test_context, public ::testing::Test
+{
+    protected:
+        alloc_latency_f()
+        {
+        }
+
+        virtual ~alloc_latency_f()
+        {
+        }
+
+        virtual void SetUp()
+        {
+        }
+
+        virtual void TearDown()
+        {
+        }
+
+        // Number of allocate/release cycles, from AAL_ALLOC_ITERATIONS (default 100)
+        static size_t iterations()
+        {
+            const char *env = getenv("AAL_ALLOC_ITERATIONS");
+            size_t n = env ? strtoul(env, nullptr, 0) : 0;
+            return n ? n : 100;
+        }
+
+        // Nearest-rank percentile of sorted samples, in microseconds
+        static double percentile(const vector<double> &sorted, double p)
+        {
+            size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.5);
+            rank = std::max<size_t>(rank, 1);
+            return sorted[std::min(rank, sorted.size()) - 1];
+        }
+
+        static void report(const char *what, vector<double> &samples)
+        {
+            sort(samples.begin(), samples.end());
+            cout << "[ BENCHMARK] " << setw(12) << left << what << right << fixed << setprecision(1)
+                 << " n=" << samples.size()
+                 << " p50=" << percentile(samples, 50.0) << "us"
+                 << " p99=" << percentile(samples, 99.0) << "us"
+                 << " max=" << samples.back() << "us" << endl;
+        }
+};
+
+TEST_F(alloc_latency_f, alloc_release_latency_01)
+{
+    // Allocate and release the NLB0 ALI service in a loop, reporting the
+    // latency of each half of the cycle.
+    using clock = chrono::steady_clock;
+
+    const size_t count = iterations();
+    vector<double> alloc_us;
+    vector<double> release_us;
+    alloc_us.reserve(count);
+    release_us.reserve(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto start = clock::now();
+        auto nlb0 = get_service<afu_client>("NLB0");
+        ASSERT_NE(nullptr, nlb0) << "Could not get NLB0 on iteration " << i << endl;
+        ASSERT_EQ(service_client::status_t::allocated, nlb0->status()) << "NLB0 not allocated on iteration " << i << endl;
+        auto allocated = clock::now();
+
+        nlb0->release();
+        ASSERT_EQ(service_client::status_t::released, nlb0->status()) << "NLB0 not released on iteration " << i << endl;
+        auto released = clock::now();
+
+        alloc_us.push_back(chrono::duration<double, micro>(allocated - start).count());
+        release_us.push_back(chrono::duration<double, micro>(released - allocated).count());
+    }
+
+    report("allocate", alloc_us);
+    report("release", release_us);
+}
+
+TEST_F(alloc_latency_f, startup_latency_01)
+{
+    // Restart the runtime with and without AALRUNTIME_CONFIG_PRELOAD_SERVICES,
+    // reporting the time from runtime start to the first allocation of NLB0.
+    using clock = chrono::steady_clock;
+
+    auto sm = service_manager::instance();
+    auto env = sm->env();
+
+    // librrmbroker is loaded as the broker on hardware; the Services it
+    // brokers are the ones worth preloading.
+    vector<string> preload = { "libALI" };
+    if (env == service_manager::hwenv_t::hw)
+    {
+        preload.push_back("libaia");
+    }
+
+    const size_t count = iterations();
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        vector<double> start_us;
+        vector<double> alloc_us;
+        start_us.reserve(count);
+        alloc_us.reserve(count);
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            sm->shutdown();
+
+            auto start = clock::now();
+            sm->start(env, mode ? preload : vector<string>());
+            auto started = clock::now();
+
+            auto nlb0 = sm->get_service("NLB0", true);
+            ASSERT_NE(nullptr, nlb0) << "Could not get NLB0 on iteration " << i << endl;
+            ASSERT_EQ(service_client::status_t::allocated, nlb0->status()) << "NLB0 not allocated on iteration " << i << endl;
+            auto allocated = clock::now();
+
+            nlb0->release();
+            ASSERT_EQ(service_client::status_t::released, nlb0->status()) << "NLB0 not released on iteration " << i << endl;
+
+            start_us.push_back(chrono::duration<double, micro>(started - start).count());
+            alloc_us.push_back(chrono::duration<double, micro>(allocated - started).count());
+        }
+
+        report(mode ? "start (pre)" : "start", start_us);
+        report(mode ? "first (pre)" : "first", alloc_us);
+    }
+
+    // Leave the runtime as the other tests expect it.
+    sm->shutdown();
+    sm->start(env);
+}
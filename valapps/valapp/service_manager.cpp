@@ -39,7 +39,7 @@ service_manager::instance(hwenv_t env)
 }
 
 void
-service_manager::start(hwenv_t env)
+service_manager::start(hwenv_t env, const std::vector<std::string> &preload)
 {
     if (0 == runtime_)
     {
@@ -51,6 +51,23 @@ service_manager::start(hwenv_t env)
         if (env == hwenv_t::hw)
         {
             configRecord.Add(AALRUNTIME_CONFIG_BROKER_SERVICE, "librrmbroker");
+        }
+
+        std::vector<btcString> names;
+        for (auto &name : preload)
+        {
+            names.push_back(name.c_str());
+        }
+        if (!names.empty())
+        {
+            configRecord.Add(AALRUNTIME_CONFIG_PRELOAD_SERVICES,
+                             const_cast<btStringArray>(names.data()),
+                             names.size());
+        }
+
+        btUnsignedInt count = 0;
+        if (ENamedValuesOK == configRecord.GetNumNames(&count) && count > 0)
+        {
             configArgs.Add(AALRUNTIME_CONFIG_RECORD, &configRecord);
         }
 
@@ -106,6 +123,11 @@ void service_manager::define_services(const string &configFile)
             else
             {
                 configRecord.Add(AAL_FACTORY_CREATE_SOFTWARE_SERVICE, true);
+                if (env_ == hwenv_t::swsim && !afuid.empty())
+                {
+                    // the software model reports the AFU ID it is allocated for
+                    configRecord.Add(keyRegAFU_ID, afuid.c_str());
+                }
             }
 
 
@@ -241,6 +263,9 @@ service_manager::allocate_service(const std::string &serviceAlias, NamedValueSet
             manifest.Add(keyRegHandle, 20);
             manifest.Add(ALIAFU_NVS_KEY_TARGET, ali_afu_ase);
             break;
+        case hwenv_t::swsim:
+            manifest.Add(ALIAFU_NVS_KEY_TARGET, ali_afu_swswim);
+            break;
         default:
             break;
     }
@@ -14,6 +14,7 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include "Loggable.h"
 #include "service_client.h"
@@ -30,7 +31,8 @@ public:
     enum hwenv_t
     {
         hw = 0,
-        ase = 1
+        ase = 1,
+        swsim = 2
     };
 
     /// @brief Get the instance to service_manager 
@@ -39,7 +41,13 @@ public:
     ~service_manager();
 
     /// @brief Starts the service_manager by starting the AAL runtime
-    void start(hwenv_t env = hw);
+    /// @param[in] env The target the services run on.
+    /// @param[in] preload Service libraries to load during runtime start
+    ///            (AALRUNTIME_CONFIG_PRELOAD_SERVICES).
+    void start(hwenv_t env = hw, const std::vector<std::string> &preload = std::vector<std::string>());
+
+    /// @brief The target given to start.
+    hwenv_t env() const { return env_; }
 
     /// @brief Shutsdown the service_manager by shutting down any service_client
     /// instances created by the service_manager and by shutting down the AAL runtime